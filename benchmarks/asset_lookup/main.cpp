@@ -0,0 +1,165 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares resolving and loading assets from loose files spread over
+// several asset directories, the way BaseApplication::GetAssetPath() probes
+// them, against the same files packed into a mounted asset archive.
+//
+// Usage: asset_lookup [file-count] [file-size] [work-dir]
+//
+// Loose files are read back right after being written so they're in the
+// page cache, this measures lookup and copy overhead rather than disk speed.
+
+#include "ppx/asset_archive.h"
+#include "ppx/fs.h"
+#include "ppx/timer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ppx;
+
+static const uint32_t kAssetDirCount = 4;
+
+// Same search as BaseApplication::GetAssetPath()
+static std::filesystem::path Resolve(const std::vector<std::filesystem::path>& assetDirs, const std::string& name)
+{
+    for (const auto& assetDir : assetDirs) {
+        std::filesystem::path path = assetDir / name;
+        if (fs::path_exists(path)) {
+            return path;
+        }
+    }
+    return {};
+}
+
+struct RunResult
+{
+    double resolveMillis = 0;
+    double loadMillis    = 0;
+    size_t loadedBytes   = 0;
+};
+
+static RunResult Run(const std::vector<std::filesystem::path>& assetDirs, const std::vector<std::string>& names)
+{
+    RunResult result = {};
+
+    Timer timer;
+    timer.Start();
+    std::vector<std::filesystem::path> paths;
+    for (const auto& name : names) {
+        paths.push_back(Resolve(assetDirs, name));
+    }
+    result.resolveMillis = timer.MillisSinceStart();
+
+    timer.Start();
+    for (const auto& path : paths) {
+        fs::File file;
+        if (!file.Open(path)) {
+            std::cerr << "failed opening " << path << std::endl;
+            continue;
+        }
+        // Touch the content the way a decoder would
+        if (file.IsMapped()) {
+            const char* pData = static_cast<const char*>(file.GetMappedData());
+            for (size_t i = 0; i < file.GetLength(); i += 4096) {
+                result.loadedBytes += static_cast<unsigned char>(pData[i]) ? 1 : 0;
+            }
+        }
+        else {
+            std::vector<char> data(file.GetLength());
+            file.Read(data.data(), data.size());
+        }
+        result.loadedBytes += file.GetLength();
+    }
+    result.loadMillis = timer.MillisSinceStart();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t        fileCount = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 2000;
+    const size_t          fileSize  = (argc > 2) ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 64 * 1024;
+    std::filesystem::path workDir   = (argc > 3) ? std::filesystem::path(argv[3]) : std::filesystem::temp_directory_path() / "ppx_asset_lookup";
+
+    if (Timer::InitializeStaticData() != TIMER_RESULT_SUCCESS) {
+        std::cerr << "failed initializing timer" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Files are spread evenly over the asset directories, so lookups probe
+    // (kAssetDirCount + 1) / 2 directories on average.
+    std::filesystem::remove_all(workDir);
+    std::vector<std::filesystem::path> looseDirs;
+    for (uint32_t i = 0; i < kAssetDirCount; ++i) {
+        looseDirs.push_back(workDir / ("assets" + std::to_string(i)));
+    }
+
+    AssetArchiveWriter       writer;
+    std::vector<std::string> names;
+    std::vector<char>        content(fileSize);
+    for (uint32_t i = 0; i < fileCount; ++i) {
+        const std::string name = "textures/set" + std::to_string(i % 16) + "/texture" + std::to_string(i) + ".bin";
+        for (size_t j = 0; j < content.size(); ++j) {
+            content[j] = static_cast<char>((i * 31 + j) & 0xFF);
+        }
+
+        const std::filesystem::path path = looseDirs[i % kAssetDirCount] / name;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream os(path, std::ios::binary);
+        os.write(content.data(), static_cast<std::streamsize>(content.size()));
+
+        writer.AddEntry(name, content.data(), content.size());
+        names.push_back(name);
+    }
+
+    const std::filesystem::path archivePath = workDir / "assets.pak";
+    if (Failed(writer.Write(archivePath))) {
+        std::cerr << "failed writing " << archivePath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Warm the page cache for both layouts
+    Run(looseDirs, names);
+
+    Timer timer;
+    timer.Start();
+    if (!fs::MountArchive(archivePath)) {
+        std::cerr << "failed mounting " << archivePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double mountMillis = timer.MillisSinceStart();
+    Run({archivePath}, names);
+
+    RunResult loose   = Run(looseDirs, names);
+    RunResult archive = Run({archivePath}, names);
+
+    std::cout << fileCount << " files of " << fileSize << " bytes in " << kAssetDirCount << " asset dirs" << std::endl;
+    std::cout << "loose files:" << std::endl;
+    std::cout << "   resolve: " << loose.resolveMillis << " ms (" << (loose.resolveMillis * 1000.0 / fileCount) << " us/file)" << std::endl;
+    std::cout << "   load   : " << loose.loadMillis << " ms" << std::endl;
+    std::cout << "archive:" << std::endl;
+    std::cout << "   mount  : " << mountMillis << " ms" << std::endl;
+    std::cout << "   resolve: " << archive.resolveMillis << " ms (" << (archive.resolveMillis * 1000.0 / fileCount) << " us/file)" << std::endl;
+    std::cout << "   load   : " << archive.loadMillis << " ms" << std::endl;
+
+    fs::UnmountArchive(archivePath);
+    std::filesystem::remove_all(workDir);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares building a Geometry from a TriMesh vertex by vertex, the way
+// code did it with Geometry::AppendVertexData(), against the bulk path in
+// Geometry::Create(createInfo, mesh). Uses the sphere LODs and vertex
+// layouts of the graphics_pipeline benchmark.
+//
+// Usage: geometry_build [iterations]
+
+#include "ppx/geometry.h"
+#include "ppx/timer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ppx;
+
+struct SphereLOD
+{
+    const char* name;
+    uint32_t    longitudeSegments;
+    uint32_t    latitudeSegments;
+};
+
+// Same as kAvailableLODs in the graphics_pipeline benchmark
+static const SphereLOD kLODs[] = {
+    {"LOD_0", 50, 50},
+    {"LOD_1", 20, 20},
+    {"LOD_2", 10, 10},
+};
+
+struct Variant
+{
+    const char*     name;
+    bool            lowPrecision;
+    GeometryOptions options;
+};
+
+// Same layouts as SphereMesh in the graphics_pipeline benchmark
+static std::vector<Variant> GetVariants()
+{
+    return {
+        {"low precision interleaved", true, GeometryOptions::InterleavedU32(grfx::FORMAT_R16G16B16A16_FLOAT).AddTexCoord(grfx::FORMAT_R16G16_FLOAT).AddNormal(grfx::FORMAT_R8G8B8A8_SNORM).AddTangent(grfx::FORMAT_R8G8B8A8_SNORM)},
+        {"low precision position planar", true, GeometryOptions::PositionPlanarU32(grfx::FORMAT_R16G16B16A16_FLOAT).AddTexCoord(grfx::FORMAT_R16G16_FLOAT).AddNormal(grfx::FORMAT_R8G8B8A8_SNORM).AddTangent(grfx::FORMAT_R8G8B8A8_SNORM)},
+        {"high precision interleaved", false, GeometryOptions::InterleavedU32(grfx::FORMAT_R32G32B32_FLOAT).AddTexCoord(grfx::FORMAT_R32G32_FLOAT).AddNormal(grfx::FORMAT_R32G32B32_FLOAT).AddTangent(grfx::FORMAT_R32G32B32A32_FLOAT)},
+        {"high precision position planar", false, GeometryOptions::PositionPlanarU32(grfx::FORMAT_R32G32B32_FLOAT).AddTexCoord(grfx::FORMAT_R32G32_FLOAT).AddNormal(grfx::FORMAT_R32G32B32_FLOAT).AddTangent(grfx::FORMAT_R32G32B32A32_FLOAT)},
+    };
+}
+
+static int8_t PackSnorm8(float value)
+{
+    return static_cast<int8_t>(glm::packSnorm1x8(value));
+}
+
+// Scalar compression the way SphereMesh used to do it
+static TriMeshVertexDataCompressed Compress(const TriMeshVertexData& vertexData)
+{
+    TriMeshVertexDataCompressed compressed = {};
+    compressed.position                    = half4(glm::packHalf1x16(vertexData.position.x), glm::packHalf1x16(vertexData.position.y), glm::packHalf1x16(vertexData.position.z), glm::packHalf1x16(0.0f));
+    compressed.texCoord                    = half2(glm::packHalf1x16(vertexData.texCoord.x), glm::packHalf1x16(vertexData.texCoord.y));
+    compressed.normal                      = i8vec4(PackSnorm8(vertexData.normal.x), PackSnorm8(vertexData.normal.y), PackSnorm8(vertexData.normal.z), 0);
+    compressed.tangent                     = i8vec4(PackSnorm8(vertexData.tangent.x), PackSnorm8(vertexData.tangent.y), PackSnorm8(vertexData.tangent.z), PackSnorm8(vertexData.tangent.w));
+    return compressed;
+}
+
+static void BuildPerVertex(const Variant& variant, const TriMesh& mesh, Geometry* pGeometry)
+{
+    PPX_CHECKED_CALL(Geometry::Create(variant.options, pGeometry));
+
+    const uint32_t triangleCount = mesh.GetCountTriangles();
+    for (uint32_t triIndex = 0; triIndex < triangleCount; ++triIndex) {
+        uint32_t v0 = PPX_VALUE_IGNORED;
+        uint32_t v1 = PPX_VALUE_IGNORED;
+        uint32_t v2 = PPX_VALUE_IGNORED;
+        mesh.GetTriangle(triIndex, v0, v1, v2);
+        pGeometry->AppendIndicesTriangle(v0, v1, v2);
+    }
+
+    const uint32_t vertexCount = mesh.GetCountPositions();
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex) {
+        TriMeshVertexData vertexData = {};
+        mesh.GetVertexData(vertexIndex, &vertexData);
+        if (variant.lowPrecision) {
+            pGeometry->AppendVertexData(Compress(vertexData));
+        }
+        else {
+            pGeometry->AppendVertexData(vertexData);
+        }
+    }
+}
+
+static void BuildBulk(const Variant& variant, const TriMesh& mesh, Geometry* pGeometry)
+{
+    PPX_CHECKED_CALL(Geometry::Create(variant.options, mesh, pGeometry));
+}
+
+static bool SameBuffers(const Geometry& a, const Geometry& b)
+{
+    if ((a.GetVertexBufferCount() != b.GetVertexBufferCount()) || (a.GetIndexBuffer()->GetSize() != b.GetIndexBuffer()->GetSize())) {
+        return false;
+    }
+    if (memcmp(a.GetIndexBuffer()->GetData(), b.GetIndexBuffer()->GetData(), a.GetIndexBuffer()->GetSize()) != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a.GetVertexBufferCount(); ++i) {
+        const Geometry::Buffer* pA = a.GetVertexBuffer(i);
+        const Geometry::Buffer* pB = b.GetVertexBuffer(i);
+        if ((pA->GetSize() != pB->GetSize()) || (memcmp(pA->GetData(), pB->GetData(), pA->GetSize()) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename BuildFn>
+static double TimeBuild(uint32_t iterations, const Variant& variant, const TriMesh& mesh, BuildFn build, Geometry* pGeometry)
+{
+    Timer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        build(variant, mesh, pGeometry);
+    }
+    return timer.MillisSinceStart() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t iterations = (argc > 1) ? std::max<uint32_t>(1, static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10))) : 100;
+
+    if (Timer::InitializeStaticData() != TIMER_RESULT_SUCCESS) {
+        std::cerr << "failed initializing timer" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Variant> variants = GetVariants();
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << iterations << " iterations, times are per geometry" << std::endl;
+    for (const auto& lod : kLODs) {
+        const TriMesh mesh = TriMesh::CreateSphere(1, lod.longitudeSegments, lod.latitudeSegments, TriMeshOptions().Indices().TexCoords().Normals().Tangents());
+        std::cout << lod.name << ": " << mesh.GetCountPositions() << " vertices, " << mesh.GetCountTriangles() << " triangles" << std::endl;
+
+        for (const auto& variant : variants) {
+            Geometry perVertex;
+            Geometry bulk;
+            // Warm up and check that both paths agree. Snorm rounding of
+            // exact halves differs between glm and the bulk path, so only
+            // high precision is compared byte for byte.
+            BuildPerVertex(variant, mesh, &perVertex);
+            BuildBulk(variant, mesh, &bulk);
+            if (!variant.lowPrecision && !SameBuffers(perVertex, bulk)) {
+                std::cerr << "   " << variant.name << ": per vertex and bulk geometries differ" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            const double perVertexMillis = TimeBuild(iterations, variant, mesh, BuildPerVertex, &perVertex);
+            const double bulkMillis      = TimeBuild(iterations, variant, mesh, BuildBulk, &bulk);
+
+            std::cout << "   " << std::left << std::setw(32) << variant.name << std::right
+                      << " per vertex: " << perVertexMillis << " ms"
+                      << " | bulk: " << bulkMillis << " ms"
+                      << " | " << std::setprecision(1) << (perVertexMillis / bulkMillis) << "x" << std::setprecision(4) << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
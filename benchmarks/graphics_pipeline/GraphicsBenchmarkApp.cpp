@@ -91,6 +91,11 @@ void GraphicsBenchmarkApp::InitKnobs()
     pKnobVertexAttrLayout->SetFlagDescription("Select the Vertex Attribute Layout for the graphics pipeline.");
     pKnobVertexAttrLayout->SetIndent(1);
 
+    GetKnobManager().InitKnob(&pOptimizeSphereMesh, "optimize-sphere-mesh", false);
+    pOptimizeSphereMesh->SetDisplayName("Optimize Sphere Mesh");
+    pOptimizeSphereMesh->SetFlagDescription("Reorder the sphere mesh's triangles and vertices for vertex cache and overdraw efficiency.");
+    pOptimizeSphereMesh->SetIndent(1);
+
     GetKnobManager().InitKnob(&pSphereInstanceCount, "sphere-count", /* defaultValue = */ kDefaultSphereInstanceCount, /* minValue = */ 1, kMaxSphereInstanceCount);
     pSphereInstanceCount->SetDisplayName("Sphere Count");
     pSphereInstanceCount->SetFlagDescription("Select the number of spheres to draw on the screen.");
@@ -101,6 +106,9 @@ void GraphicsBenchmarkApp::InitKnobs()
     pDrawCallCount->SetFlagDescription("Select the number of draw calls to be used to draw the `--sphere-count` spheres.");
     pDrawCallCount->SetIndent(1);
 
+    GetKnobManager().InitKnob(&pRecordThreads, "record-threads", /* defaultValue = */ 1, /* minValue = */ 1, kMaxRecordThreads);
+    pRecordThreads->SetFlagDescription("Select the number of threads recording the skybox and sphere draw calls into secondary command buffers. Only supported on Vulkan. See also `--drawcall-count`.");
+
     GetKnobManager().InitKnob(&pAlphaBlend, "alpha-blend", false);
     pAlphaBlend->SetDisplayName("Alpha Blend");
     pAlphaBlend->SetFlagDescription("Set blend mode of the spheres to alpha blending.");
@@ -290,6 +298,22 @@ void GraphicsBenchmarkApp::Setup()
         mPerFrame.push_back(frame);
     }
 
+    // =====================================================================
+    // PARALLEL RECORDING
+    // =====================================================================
+    if (pRecordThreads->GetValue() > 1) {
+        if (grfx::IsDx12(kApi)) {
+            PPX_LOG_WARN("--record-threads requires secondary command buffers, which are not supported on D3D12: recording on one thread");
+        }
+        else {
+            grfx::ParallelCommandRecorderCreateInfo createInfo = {};
+            createInfo.pQueue                                  = GetGraphicsQueue();
+            createInfo.workerCount                             = static_cast<uint32_t>(pRecordThreads->GetValue());
+            createInfo.frameCount                              = GetNumFramesInFlight();
+            PPX_CHECKED_CALL(GetDevice()->CreateParallelCommandRecorder(&createInfo, &mParallelRecorder));
+        }
+    }
+
     {
         OffscreenFrame frame = {};
         PPX_CHECKED_CALL(CreateOffscreenFrame(frame, RenderFormat(), GetSwapchain()->GetDepthFormat(), GetSwapchain()->GetWidth(), GetSwapchain()->GetHeight()));
@@ -305,6 +329,10 @@ void GraphicsBenchmarkApp::SetupMetrics()
         mMetricsData.metrics[MetricsData::kTypeCPUSubmissionTime] = AddMetric(metadata);
         PPX_ASSERT_MSG(mMetricsData.metrics[MetricsData::kTypeCPUSubmissionTime] != ppx::metrics::kInvalidMetricID, "Failed to add CPU Submission Time metric");
 
+        metadata                                                 = {ppx::metrics::MetricType::GAUGE, "CPU Recording Time", "ms", ppx::metrics::MetricInterpretation::LOWER_IS_BETTER, {0.f, 10000.f}};
+        mMetricsData.metrics[MetricsData::kTypeCPURecordingTime] = AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetricsData.metrics[MetricsData::kTypeCPURecordingTime] != ppx::metrics::kInvalidMetricID, "Failed to add CPU Recording Time metric");
+
         metadata                                          = {ppx::metrics::MetricType::GAUGE, "Bandwidth", "GB/s", ppx::metrics::MetricInterpretation::HIGHER_IS_BETTER, {0.f, 10000.f}};
         mMetricsData.metrics[MetricsData::kTypeBandwidth] = AddMetric(metadata);
         PPX_ASSERT_MSG(mMetricsData.metrics[MetricsData::kTypeBandwidth] != ppx::metrics::kInvalidMetricID, "Failed to add Bandwidth metric");
@@ -325,6 +353,9 @@ void GraphicsBenchmarkApp::UpdateMetrics()
     data.gauge.value              = mCPUSubmissionTime;
     RecordMetricData(mMetricsData.metrics[MetricsData::kTypeCPUSubmissionTime], data);
 
+    data.gauge.value = mCPURecordingTime;
+    RecordMetricData(mMetricsData.metrics[MetricsData::kTypeCPURecordingTime], data);
+
     const float        gpuWorkDurationInSec = static_cast<float>(mGpuWorkDuration / static_cast<double>(frequency));
     const grfx::Format swapchainColorFormat = GetSwapchain()->GetColorFormat();
     const uint32_t     swapchainWidth       = GetSwapchain()->GetWidth();
@@ -564,7 +595,7 @@ void GraphicsBenchmarkApp::SetupSphereMeshes()
     uint32_t    meshIndex = 0;
     for (const auto& lod : kAvailableLODs) {
         PPX_LOG_INFO("LOD: " << lod.name);
-        SphereMesh sphereMesh(/* radius = */ 1, lod.value.longitudeSegments, lod.value.latitudeSegments);
+        SphereMesh sphereMesh(/* radius = */ 1, lod.value.longitudeSegments, lod.value.latitudeSegments, pOptimizeSphereMesh->GetValue());
         sphereMesh.ApplyGrid(grid);
         // Create a giant vertex buffer for each vb type to accommodate all copies of the sphere mesh
         PPX_CHECKED_CALL(grfx_util::CreateMeshFromGeometry(GetGraphicsQueue(), sphereMesh.GetLowPrecisionInterleaved(), &mSphereMeshes[meshIndex++]));
@@ -901,6 +932,7 @@ void GraphicsBenchmarkApp::ProcessKnobs()
     const bool depthTestWriteKnobChanged      = pDepthTestWrite->DigestUpdate();
     const bool enableSpheresKnobChanged       = pEnableSpheres->DigestUpdate();
     const bool sphereInstanceCountKnobChanged = pSphereInstanceCount->DigestUpdate();
+    const bool optimizeSphereMeshKnobChanged  = pOptimizeSphereMesh->DigestUpdate();
 
     // TODO: Ideally, the `maxValue` of the drawcall-count slider knob should be changed at runtime.
     // Currently, the value of the drawcall-count is adjusted to the sphere-count in case the
@@ -922,6 +954,7 @@ void GraphicsBenchmarkApp::ProcessKnobs()
         pKnobLOD->SetVisible(enableSpheres);
         pKnobVbFormat->SetVisible(enableSpheres);
         pKnobVertexAttrLayout->SetVisible(enableSpheres);
+        pOptimizeSphereMesh->SetVisible(enableSpheres);
         pSphereInstanceCount->SetVisible(enableSpheres);
         pDrawCallCount->SetVisible(enableSpheres);
         pAlphaBlend->SetVisible(enableSpheres);
@@ -939,7 +972,7 @@ void GraphicsBenchmarkApp::ProcessKnobs()
         else {
             const uint32_t initializedCount   = static_cast<uint32_t>(pSphereInstanceCount->GetValue());
             const bool     requireMoreSpheres = sphereInstanceCountKnobChanged && (initializedCount > mInitializedSpheres);
-            if (requireMoreSpheres) {
+            if (requireMoreSpheres || optimizeSphereMeshKnobChanged) {
                 SetupSphereMeshes();
             }
             // Update descriptors
@@ -1094,7 +1127,10 @@ void GraphicsBenchmarkApp::Render()
         }
     }
 
+    Timer timerRecord;
+    PPX_ASSERT_MSG(timerRecord.Start() == TIMER_RESULT_SUCCESS, "Error starting the Timer");
     RecordCommandBuffer(frame, renderPasses, imageIndex);
+    mCPURecordingTime = timerRecord.MillisSinceStart();
 
     grfx::SubmitInfo submitInfo   = {};
     submitInfo.commandBufferCount = 1;
@@ -1187,6 +1223,23 @@ void GraphicsBenchmarkApp::DrawExtraInfo()
         ImGui::NextColumn();
         ImGui::Text("%.2f ms", cpuSubmissionTime.max);
         ImGui::NextColumn();
+
+        const auto cpuRecordingTime = GetGaugeBasicStatistics(mMetricsData.metrics[MetricsData::kTypeCPURecordingTime]);
+
+        ImGui::Text("CPU Average Recording Time");
+        ImGui::NextColumn();
+        ImGui::Text("%.2f ms", cpuRecordingTime.average);
+        ImGui::NextColumn();
+
+        ImGui::Text("CPU Min Recording Time");
+        ImGui::NextColumn();
+        ImGui::Text("%.2f ms", cpuRecordingTime.min);
+        ImGui::NextColumn();
+
+        ImGui::Text("CPU Max Recording Time");
+        ImGui::NextColumn();
+        ImGui::Text("%.2f ms", cpuRecordingTime.max);
+        ImGui::NextColumn();
     }
 
     if (mInitializedSpheres) {
@@ -1470,16 +1523,16 @@ void GraphicsBenchmarkApp::RecordCommandBuffer(PerFrame& frame, const RenderPass
 
     // Write start timestamp
     frame.cmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_TOP_OF_PIPE_BIT, /* queryIndex = */ 0);
-    if (!pRenderOffscreen->GetValue()) {
-        frame.cmd->SetScissors(GetScissor());
-        frame.cmd->SetViewports(GetViewport());
-    }
-    else {
+    grfx::Rect     scissor  = GetScissor();
+    grfx::Viewport viewport = GetViewport();
+    if (pRenderOffscreen->GetValue()) {
         uint32_t width  = mOffscreenFrame.back().width;
         uint32_t height = mOffscreenFrame.back().height;
-        frame.cmd->SetScissors({0, 0, width, height});
-        frame.cmd->SetViewports({0, 0, static_cast<float>(width), static_cast<float>(height), 0.0, 1.0});
+        scissor         = {0, 0, width, height};
+        viewport        = {0, 0, static_cast<float>(width), static_cast<float>(height), 0.0, 1.0};
     }
+    frame.cmd->SetScissors(scissor);
+    frame.cmd->SetViewports(viewport);
 
     grfx::RenderPassPtr currentRenderPass = renderpasses.clearRenderPass;
     PPX_ASSERT_MSG(!currentRenderPass.IsNull(), "render pass object is null");
@@ -1501,12 +1554,18 @@ void GraphicsBenchmarkApp::RecordCommandBuffer(PerFrame& frame, const RenderPass
     bool renderScene = pEnableSkyBox->GetValue() || pEnableSpheres->GetValue();
     if (renderScene) {
         // Record commands for the scene using one renderpass
-        frame.cmd->BeginRenderPass(currentRenderPass);
-        if (pEnableSkyBox->GetValue()) {
-            RecordCommandBufferSkyBox(frame);
+        if (mParallelRecorder) {
+            frame.cmd->BeginRenderPass(currentRenderPass, grfx::RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            RecordCommandBufferSceneParallel(frame, currentRenderPass, viewport, scissor);
         }
-        if (pEnableSpheres->GetValue() && mInitializedSpheres > 0) {
-            RecordCommandBufferSpheres(frame);
+        else {
+            frame.cmd->BeginRenderPass(currentRenderPass);
+            if (pEnableSkyBox->GetValue()) {
+                RecordCommandBufferSkyBox(frame, frame.cmd);
+            }
+            if (pEnableSpheres->GetValue() && mInitializedSpheres > 0) {
+                RecordCommandBufferSpheres(frame);
+            }
         }
         frame.cmd->EndRenderPass();
     }
@@ -1605,42 +1664,85 @@ void GraphicsBenchmarkApp::RecordCommandBuffer(PerFrame& frame, const RenderPass
     PPX_CHECKED_CALL(frame.cmd->End());
 }
 
-void GraphicsBenchmarkApp::RecordCommandBufferSkyBox(PerFrame& frame)
+void GraphicsBenchmarkApp::RecordCommandBufferSkyBox(PerFrame& frame, grfx::CommandBuffer* pCmd)
 {
     // Bind resources
-    frame.cmd->BindGraphicsPipeline(GetSkyBoxPipeline());
-    frame.cmd->BindIndexBuffer(mSkyBox.mesh);
-    frame.cmd->BindVertexBuffers(mSkyBox.mesh);
+    pCmd->BindGraphicsPipeline(GetSkyBoxPipeline());
+    pCmd->BindIndexBuffer(mSkyBox.mesh);
+    pCmd->BindVertexBuffers(mSkyBox.mesh);
 
-    frame.cmd->BindGraphicsDescriptorSets(mSkyBox.pipelineInterface, 1, &mSkyBox.descriptorSets.at(GetInFlightFrameIndex()));
+    pCmd->BindGraphicsDescriptorSets(mSkyBox.pipelineInterface, 1, &mSkyBox.descriptorSets.at(GetInFlightFrameIndex()));
 
     // Update uniform buffer with current view data
     SkyBoxData data = {};
     data.MVP        = frame.sceneData.viewProjectionMatrix * glm::scale(float3(500.0f, 500.0f, 500.0f));
     mSkyBox.uniformBuffer->CopyFromSource(sizeof(data), &data);
 
-    frame.cmd->DrawIndexed(mSkyBox.mesh->GetIndexCount());
+    pCmd->DrawIndexed(mSkyBox.mesh->GetIndexCount());
 }
 
 void GraphicsBenchmarkApp::RecordCommandBufferSpheres(PerFrame& frame)
 {
-    // Bind resources
-    frame.cmd->BindGraphicsPipeline(GetSpherePipeline());
-    const size_t meshIndex = mMeshesIndexer.GetIndex({pKnobLOD->GetIndex(), pKnobVbFormat->GetIndex(), pKnobVertexAttrLayout->GetIndex()});
-    frame.cmd->BindIndexBuffer(mSphereMeshes[meshIndex]);
-    frame.cmd->BindVertexBuffers(mSphereMeshes[meshIndex]);
+    const SphereDrawList drawList = PrepareSphereDrawList(frame);
+    BindSphereResources(frame.cmd, drawList);
+    RecordSphereDrawCalls(frame.cmd, drawList, 0, drawList.drawCallCount);
+}
 
-    frame.cmd->BindGraphicsDescriptorSets(mSphere.pipelineInterface, 1, &mSphere.descriptorSets.at(GetInFlightFrameIndex()));
+void GraphicsBenchmarkApp::RecordCommandBufferSceneParallel(PerFrame& frame, const grfx::RenderPass* pRenderPass, const grfx::Viewport& viewport, const grfx::Rect& scissor)
+{
+    const bool     drawSkyBox  = pEnableSkyBox->GetValue();
+    const bool     drawSpheres = pEnableSpheres->GetValue() && (mInitializedSpheres > 0);
+    SphereDrawList drawList    = {};
+    if (drawSpheres) {
+        drawList = PrepareSphereDrawList(frame);
+    }
+    if (drawSkyBox) {
+        // Pipelines are compiled on first use, workers must only look them up
+        GetSkyBoxPipeline();
+    }
+
+    // Spheres are split by draw call, the skybox is recorded first by the
+    // worker that records the first range to keep the serial draw order.
+    const uint32_t itemCount = std::max<uint32_t>(drawList.drawCallCount, 1);
+    PPX_CHECKED_CALL(mParallelRecorder->Record(
+        GetInFlightFrameIndex(),
+        frame.cmd,
+        pRenderPass,
+        itemCount,
+        [&](grfx::CommandBuffer* pCmd, uint32_t begin, uint32_t end, uint32_t workerIndex) {
+            // Secondary command buffers don't inherit any state
+            pCmd->SetScissors(scissor);
+            pCmd->SetViewports(viewport);
+
+            if (drawSkyBox && (begin == 0)) {
+                RecordCommandBufferSkyBox(frame, pCmd);
+            }
+            if (drawSpheres) {
+                BindSphereResources(pCmd, drawList);
+                RecordSphereDrawCalls(pCmd, drawList, begin, end);
+            }
+        }));
+}
+
+GraphicsBenchmarkApp::SphereDrawList GraphicsBenchmarkApp::PrepareSphereDrawList(PerFrame& frame)
+{
+    SphereDrawList drawList = {};
+    drawList.pipeline       = GetSpherePipeline();
+    drawList.meshIndex      = mMeshesIndexer.GetIndex({pKnobLOD->GetIndex(), pKnobVbFormat->GetIndex(), pKnobVertexAttrLayout->GetIndex()});
 
     // Snapshot some scene-related values for the current frame
     uint32_t currentSphereCount   = std::min<uint32_t>(pSphereInstanceCount->GetValue(), mInitializedSpheres);
     uint32_t currentDrawCallCount = pDrawCallCount->GetValue();
-    uint32_t mSphereIndexCount    = mSphereMeshes[meshIndex]->GetIndexCount() / mInitializedSpheres;
+    uint32_t mSphereIndexCount    = mSphereMeshes[drawList.meshIndex]->GetIndexCount() / mInitializedSpheres;
     uint32_t indicesPerDrawCall   = (currentSphereCount * mSphereIndexCount) / currentDrawCallCount;
 
     // Make `indicesPerDrawCall` multiple of 3 given that each consecutive three vertices (3*i + 0, 3*i + 1, 3*i + 2)
     // defines a single triangle primitive (PRIMITIVE_TOPOLOGY_TRIANGLE_LIST).
     indicesPerDrawCall -= indicesPerDrawCall % 3;
+    drawList.drawCallCount      = currentDrawCallCount;
+    drawList.indicesPerDrawCall = indicesPerDrawCall;
+    drawList.indexCount         = currentSphereCount * mSphereIndexCount;
+
     SphereData data                 = {};
     data.modelMatrix                = float4x4(1.0f);
     data.ITModelMatrix              = glm::inverse(glm::transpose(data.modelMatrix));
@@ -1649,20 +1751,35 @@ void GraphicsBenchmarkApp::RecordCommandBufferSpheres(PerFrame& frame)
     data.lightPosition              = float4(mLightPosition, 0.0f);
     data.eyePosition                = float4(mCamera.GetEyePosition(), 0.0f);
     mSphere.uniformBuffer->CopyFromSource(sizeof(data), &data);
-    frame.cmd->PushGraphicsConstants(mSphere.pipelineInterface, kDebugColorPushConstantCount, &kDefaultDrawCallColor);
 
-    for (uint32_t i = 0; i < currentDrawCallCount; i++) {
-        if (pDebugViews->GetIndex() == static_cast<size_t>(DebugView::SHOW_DRAWCALLS)) {
-            frame.cmd->PushGraphicsConstants(mSphere.pipelineInterface, kDebugColorPushConstantCount, &mColorsForDrawCalls[i]);
+    return drawList;
+}
+
+void GraphicsBenchmarkApp::BindSphereResources(grfx::CommandBuffer* pCmd, const SphereDrawList& drawList)
+{
+    pCmd->BindGraphicsPipeline(drawList.pipeline);
+    pCmd->BindIndexBuffer(mSphereMeshes[drawList.meshIndex]);
+    pCmd->BindVertexBuffers(mSphereMeshes[drawList.meshIndex]);
+
+    pCmd->BindGraphicsDescriptorSets(mSphere.pipelineInterface, 1, &mSphere.descriptorSets.at(GetInFlightFrameIndex()));
+    pCmd->PushGraphicsConstants(mSphere.pipelineInterface, kDebugColorPushConstantCount, &kDefaultDrawCallColor);
+}
+
+void GraphicsBenchmarkApp::RecordSphereDrawCalls(grfx::CommandBuffer* pCmd, const SphereDrawList& drawList, uint32_t begin, uint32_t end)
+{
+    const bool showDrawCalls = (pDebugViews->GetIndex() == static_cast<size_t>(DebugView::SHOW_DRAWCALLS));
+    for (uint32_t i = begin; i < end; i++) {
+        if (showDrawCalls) {
+            pCmd->PushGraphicsConstants(mSphere.pipelineInterface, kDebugColorPushConstantCount, &mColorsForDrawCalls[i]);
         }
 
-        uint32_t indexCount = indicesPerDrawCall;
+        uint32_t indexCount = drawList.indicesPerDrawCall;
         // Add the remaining indices to the last drawcall
-        if (i == (currentDrawCallCount - 1)) {
-            indexCount += (currentSphereCount * mSphereIndexCount - currentDrawCallCount * indicesPerDrawCall);
+        if (i == (drawList.drawCallCount - 1)) {
+            indexCount += (drawList.indexCount - drawList.drawCallCount * drawList.indicesPerDrawCall);
         }
-        uint32_t firstIndex = i * indicesPerDrawCall;
-        frame.cmd->DrawIndexed(indexCount, /* instanceCount = */ 1, firstIndex);
+        uint32_t firstIndex = i * drawList.indicesPerDrawCall;
+        pCmd->DrawIndexed(indexCount, /* instanceCount = */ 1, firstIndex);
     }
 }
 
@@ -33,6 +33,7 @@ static constexpr uint32_t kMaxSphereInstanceCount     = 3000;
 static constexpr uint32_t kDefaultSphereInstanceCount = 50;
 static constexpr uint32_t kSeed                       = 89977;
 static constexpr uint32_t kMaxFullscreenQuadsCount    = 1000;
+static constexpr uint32_t kMaxRecordThreads           = 64;
 
 static constexpr float4   kDefaultDrawCallColor        = float4(1.0f, 0.175f, 0.365f, 0.5f);
 static constexpr uint32_t kDebugColorPushConstantCount = sizeof(float4) / sizeof(uint32_t);
@@ -268,6 +269,16 @@ private:
         SceneData sceneData;
     };
 
+    // Sphere draw calls of the current frame, see PrepareSphereDrawList()
+    struct SphereDrawList
+    {
+        grfx::GraphicsPipelinePtr pipeline;
+        size_t                    meshIndex          = 0;
+        uint32_t                  drawCallCount      = 0;
+        uint32_t                  indicesPerDrawCall = 0;
+        uint32_t                  indexCount         = 0; // Total for all draw calls
+    };
+
     struct Entity
     {
         grfx::MeshPtr                       mesh;
@@ -441,6 +452,8 @@ private:
     grfx::DescriptorPoolPtr           mDescriptorPool;
     std::vector<OffscreenFrame>       mOffscreenFrame;
     double                            mCPUSubmissionTime = 0.0;
+    double                            mCPURecordingTime  = 0.0;
+    grfx::ParallelCommandRecorderPtr  mParallelRecorder; // Null when recording on one thread
 
     // SkyBox resources
     Entity                mSkyBox;
@@ -481,6 +494,7 @@ private:
         enum MetricsType : size_t
         {
             kTypeCPUSubmissionTime = 0,
+            kTypeCPURecordingTime,
             kTypeBandwidth,
             kCount
         };
@@ -500,8 +514,10 @@ private:
     std::shared_ptr<KnobDropdown<SphereLOD>>   pKnobLOD;
     std::shared_ptr<KnobDropdown<std::string>> pKnobVbFormat;
     std::shared_ptr<KnobDropdown<std::string>> pKnobVertexAttrLayout;
+    std::shared_ptr<KnobCheckbox>              pOptimizeSphereMesh;
     std::shared_ptr<KnobSlider<int>>           pSphereInstanceCount;
     std::shared_ptr<KnobSlider<int>>           pDrawCallCount;
+    std::shared_ptr<KnobFlag<int>>             pRecordThreads;
     std::shared_ptr<KnobCheckbox>              pAlphaBlend;
     std::shared_ptr<KnobCheckbox>              pDepthTestWrite;
     std::shared_ptr<KnobCheckbox>              pAllTexturesTo1x1;
@@ -581,10 +597,19 @@ private:
     void RecordCommandBuffer(PerFrame& frame, const RenderPasses& renderPasses, uint32_t imageIndex);
 
     // Records commands to render * in this frame's command buffer, with the current renderpass
-    void RecordCommandBufferSkyBox(PerFrame& frame);
+    void RecordCommandBufferSkyBox(PerFrame& frame, grfx::CommandBuffer* pCmd);
     void RecordCommandBufferSpheres(PerFrame& frame);
     void RecordCommandBufferFullscreenQuad(PerFrame& frame, size_t seed);
 
+    // Records the skybox and spheres into secondary command buffers on `--record-threads` threads,
+    // pRenderPass must have been begun with RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+    void RecordCommandBufferSceneParallel(PerFrame& frame, const grfx::RenderPass* pRenderPass, const grfx::Viewport& viewport, const grfx::Rect& scissor);
+
+    // Sphere recording split so draw calls can be recorded in ranges
+    SphereDrawList PrepareSphereDrawList(PerFrame& frame);
+    void           BindSphereResources(grfx::CommandBuffer* pCmd, const SphereDrawList& drawList);
+    void           RecordSphereDrawCalls(grfx::CommandBuffer* pCmd, const SphereDrawList& drawList, uint32_t begin, uint32_t end);
+
 #if defined(PPX_BUILD_XR)
     // Records and submits commands for UI for XR
     void RecordAndSubmitCommandBufferGUIXR(PerFrame& frame);
@@ -83,25 +83,21 @@ void SphereMesh::ApplyGrid(const OrderedGrid& grid)
 void SphereMesh::CreateAllGeometries()
 {
     // vertexBinding[0] = {stride = 18, attributeCount = 4} // position, texCoord, normal, tangent
-    CreateSphereGeometry(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED, &mLowInterleavedSingleSphere);
     CreateSphereGeometry(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED, &mLowInterleaved);
 
     // vertexBinding[0] = {stride =  6, attributeCount = 1} // position
     // vertexBinding[1] = {stride = 12, attributeCount = 3} // texCoord, normal, tangent
-    CreateSphereGeometry(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR, &mLowPlanarSingleSphere);
     CreateSphereGeometry(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR, &mLowPlanar);
 
     // vertexBinding[0] = {stride = 48, attributeCount = 4} // position, texCoord, normal, tangent
-    CreateSphereGeometry(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED, &mHighInterleavedSingleSphere);
     CreateSphereGeometry(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED, &mHighInterleaved);
 
     // vertexBinding[0] = {stride = 12, attributeCount = 1} // position
     // vertexBinding[1] = {stride = 36, attributeCount = 3} // texCoord, normal, tangent
-    CreateSphereGeometry(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR, &mHighPlanarSingleSphere);
     CreateSphereGeometry(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR, &mHighPlanar);
 }
 
-void SphereMesh::CreateSphereGeometry(PrecisionType precisionType, VertexLayoutType vertexLayoutType, Geometry* geometryPtr)
+GeometryOptions SphereMesh::GetSphereGeometryOptions(PrecisionType precisionType, VertexLayoutType vertexLayoutType)
 {
     // Defaults used for all the following:
     // - indexType = INDEX_TYPE_UINT32
@@ -138,21 +134,21 @@ void SphereMesh::CreateSphereGeometry(PrecisionType precisionType, VertexLayoutT
         }
     }
     PPX_ASSERT_MSG(geoOpts.vertexBindingCount != 0, "Invalid precisionType and/or vertexLayoutType");
-    PPX_CHECKED_CALL(Geometry::Create(geoOpts, geometryPtr));
+    return geoOpts;
+}
+
+void SphereMesh::CreateSphereGeometry(PrecisionType precisionType, VertexLayoutType vertexLayoutType, Geometry* geometryPtr)
+{
+    PPX_CHECKED_CALL(Geometry::Create(GetSphereGeometryOptions(precisionType, vertexLayoutType), geometryPtr));
 }
 
 void SphereMesh::PopulateSingleSpheres()
 {
-    for (uint32_t vertexIndex = 0; vertexIndex < mSingleSphereVertexCount; ++vertexIndex) {
-        TriMeshVertexData vertexData = {};
-        mSingleSphereMesh.GetVertexData(vertexIndex, &vertexData);
-        mHighInterleavedSingleSphere.AppendVertexData(vertexData);
-        mHighPlanarSingleSphere.AppendVertexData(vertexData);
-
-        TriMeshVertexDataCompressed vertexDataCompressed = CompressVertexData(vertexData);
-        mLowInterleavedSingleSphere.AppendVertexData(vertexDataCompressed);
-        mLowPlanarSingleSphere.AppendVertexData(vertexDataCompressed);
-    }
+    // Geometry::Create() converts the mesh to the low precision formats in bulk
+    PPX_CHECKED_CALL(Geometry::Create(GetSphereGeometryOptions(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED), mSingleSphereMesh, &mLowInterleavedSingleSphere));
+    PPX_CHECKED_CALL(Geometry::Create(GetSphereGeometryOptions(PrecisionType::PRECISION_TYPE_LOW_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR), mSingleSphereMesh, &mLowPlanarSingleSphere));
+    PPX_CHECKED_CALL(Geometry::Create(GetSphereGeometryOptions(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_INTERLEAVED), mSingleSphereMesh, &mHighInterleavedSingleSphere));
+    PPX_CHECKED_CALL(Geometry::Create(GetSphereGeometryOptions(PrecisionType::PRECISION_TYPE_HIGH_PRECISION, VertexLayoutType::VERTEX_LAYOUT_TYPE_POSITION_PLANAR), mSingleSphereMesh, &mHighPlanarSingleSphere));
 }
 
 void SphereMesh::PrepareFullGeometries()
@@ -202,21 +198,26 @@ void SphereMesh::RepeatGeometryNonPositionVertexData(const Geometry& srcGeom, Ve
 
 void SphereMesh::WriteSpherePosition(const OrderedGrid& grid, uint32_t sphereIndex)
 {
-    float4x4 modelMatrix = grid.GetModelMatrix(sphereIndex);
+    float4x4      modelMatrix = grid.GetModelMatrix(sphereIndex);
+    const float3* pPositions  = mSingleSphereMesh.GetDataPositions();
+
+    // Low precision positions are half4 with w = 0
+    mSpherePositions.resize(mSingleSphereVertexCount);
+    mSpherePositionsCompressed.resize(mSingleSphereVertexCount);
 
+    size_t firstElementIndex = static_cast<size_t>(sphereIndex) * mSingleSphereVertexCount;
     for (uint32_t j = 0; j < mSingleSphereVertexCount; ++j) {
-        TriMeshVertexData vertexData = {};
-        mSingleSphereMesh.GetVertexData(j, &vertexData);
-        vertexData.position = modelMatrix * float4(vertexData.position, 1);
-
-        TriMeshVertexDataCompressed vertexDataCompressed;
-        vertexDataCompressed.position = half4(glm::packHalf1x16(vertexData.position.x), glm::packHalf1x16(vertexData.position.y), glm::packHalf1x16(vertexData.position.z), glm::packHalf1x16(0.0f));
-
-        size_t elementIndex = sphereIndex * mSingleSphereVertexCount + j;
-        OverwritePositionData(mLowInterleaved.GetVertexBuffer(0), vertexDataCompressed, elementIndex);
-        OverwritePositionData(mLowPlanar.GetVertexBuffer(0), vertexDataCompressed, elementIndex);
-        OverwritePositionData(mHighInterleaved.GetVertexBuffer(0), vertexData, elementIndex);
-        OverwritePositionData(mHighPlanar.GetVertexBuffer(0), vertexData, elementIndex);
+        float3 position     = modelMatrix * float4(pPositions[j], 1);
+        mSpherePositions[j] = float4(position, 0);
+
+        OverwritePositionData(mHighInterleaved.GetVertexBuffer(0), position, firstElementIndex + j);
+        OverwritePositionData(mHighPlanar.GetVertexBuffer(0), position, firstElementIndex + j);
+    }
+
+    ConvertToHalf(4 * mSingleSphereVertexCount, &mSpherePositions[0].x, &mSpherePositionsCompressed[0].x);
+    for (uint32_t j = 0; j < mSingleSphereVertexCount; ++j) {
+        OverwritePositionData(mLowInterleaved.GetVertexBuffer(0), mSpherePositionsCompressed[j], firstElementIndex + j);
+        OverwritePositionData(mLowPlanar.GetVertexBuffer(0), mSpherePositionsCompressed[j], firstElementIndex + j);
     }
 }
 
@@ -235,21 +236,3 @@ void SphereMesh::AppendSphereIndicesToInterleaved(uint32_t sphereIndex)
         mHighInterleaved.AppendIndicesTriangle(offset + v0, offset + v1, offset + v2);
     }
 }
-
-TriMeshVertexDataCompressed SphereMesh::CompressVertexData(const TriMeshVertexData& vertexData)
-{
-    TriMeshVertexDataCompressed vertexDataCompressed;
-
-    vertexDataCompressed.position = half4(glm::packHalf1x16(vertexData.position.x), glm::packHalf1x16(vertexData.position.y), glm::packHalf1x16(vertexData.position.z), glm::packHalf1x16(0.0f));
-    vertexDataCompressed.texCoord = half2(glm::packHalf1x16(vertexData.texCoord.x), glm::packHalf1x16(vertexData.texCoord.y));
-    vertexDataCompressed.normal   = i8vec4(MapFloatToInt8(vertexData.normal.x), MapFloatToInt8(vertexData.normal.y), MapFloatToInt8(vertexData.normal.z), MapFloatToInt8(1.0f));
-    vertexDataCompressed.tangent  = i8vec4(MapFloatToInt8(vertexData.tangent.x), MapFloatToInt8(vertexData.tangent.y), MapFloatToInt8(vertexData.tangent.z), MapFloatToInt8(vertexData.tangent.a));
-
-    return vertexDataCompressed;
-}
-
-int8_t MapFloatToInt8(float x)
-{
-    PPX_ASSERT_MSG(-1.0f <= x && x <= 1.0f, "The value must be between -1.0 and 1.0");
-    return static_cast<int8_t>((x + 1.0f) * 127.5f - 128.0f);
-}
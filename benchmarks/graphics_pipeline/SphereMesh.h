@@ -16,6 +16,7 @@
 #define BENCHMARKS_GRAPHICS_PIPELINE_SPHERE_MESH_H
 
 #include "ppx/graphics_util.h"
+#include "ppx/mesh_optimize.h"
 
 using namespace ppx;
 
@@ -83,9 +84,13 @@ public:
     };
 
     // Creates a SphereMesh and populates info for one sphere
-    SphereMesh(float radius, uint32_t longitudeSegments, uint32_t latitudeSegments)
+    // If `optimize` is true, the sphere's triangles and vertices are reordered for vertex cache and overdraw efficiency
+    SphereMesh(float radius, uint32_t longitudeSegments, uint32_t latitudeSegments, bool optimize = false)
     {
-        mSingleSphereMesh        = TriMesh::CreateSphere(radius, longitudeSegments, latitudeSegments, TriMeshOptions().Indices().TexCoords().Normals().Tangents());
+        mSingleSphereMesh = TriMesh::CreateSphere(radius, longitudeSegments, latitudeSegments, TriMeshOptions().Indices().TexCoords().Normals().Tangents());
+        if (optimize) {
+            PPX_CHECKED_CALL(OptimizeMesh(&mSingleSphereMesh));
+        }
         mSingleSphereVertexCount = mSingleSphereMesh.GetCountPositions();
         mSingleSphereTriCount    = mSingleSphereMesh.GetCountTriangles();
 
@@ -106,10 +111,13 @@ private:
     // Create all single sphere and full geometries
     void CreateAllGeometries();
 
-    // Create sphere geometry based on specified type
+    // Geometry options for the specified type
+    GeometryOptions GetSphereGeometryOptions(PrecisionType precisionType, VertexLayoutType vertexLayoutType);
+
+    // Create empty sphere geometry based on specified type
     void CreateSphereGeometry(PrecisionType precisionType, VertexLayoutType vertexLayoutType, Geometry* geometryPtr);
 
-    // Populate vertex buffers for single sphere geometries
+    // Create single sphere geometries from the sphere mesh
     void PopulateSingleSpheres();
 
     // Repeat necessary data from single sphere geometries to the full geometries
@@ -125,9 +133,6 @@ private:
     // For a sphere, append all its triangles' three vertex indices to only the interleaved full index buffers
     void AppendSphereIndicesToInterleaved(uint32_t sphereIndex);
 
-    // Compress all high precision data within vertexData to a size suitable for low precision
-    TriMeshVertexDataCompressed CompressVertexData(const TriMeshVertexData& vertexData);
-
 private:
     TriMesh  mSingleSphereMesh;
     uint32_t mSingleSphereVertexCount;
@@ -143,23 +148,24 @@ private:
     Geometry mLowPlanar;
     Geometry mHighInterleaved;
     Geometry mHighPlanar;
+
+    // Scratch space for WriteSpherePosition()
+    std::vector<float4> mSpherePositions;
+    std::vector<half4>  mSpherePositionsCompressed;
 };
 
-// Overwrite the position data within a position buffer with vtx.position, at vertex elementIndex only
+// Overwrite the position data within a position buffer with position, at vertex elementIndex only
 template <class T>
-void OverwritePositionData(Geometry::Buffer* positionBufferPtr, const T& vtx, size_t elementIndex)
+void OverwritePositionData(Geometry::Buffer* positionBufferPtr, const T& position, size_t elementIndex)
 {
     size_t elementSize = positionBufferPtr->GetElementSize();
     size_t offset      = elementSize * elementIndex;
 
-    const void* pSrc = &(vtx.position);
+    const void* pSrc = &position;
     void*       pDst = positionBufferPtr->GetData() + offset;
-    memcpy(pDst, pSrc, sizeof(vtx.position));
+    memcpy(pDst, pSrc, sizeof(position));
 }
 
-// Maps a float between [-1, 1] to [-128, 127]
-int8_t MapFloatToInt8(float x);
-
 // Shuffles [`begin`, `end`) using function `f`.
 template <class Iter, class F>
 void Shuffle(Iter begin, Iter end, F&& f)
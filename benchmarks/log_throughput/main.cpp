@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures PPX_LOG_* throughput with 1, 4 and 16 logging threads in
+// synchronous mode and in async mode with both overflow policies. Records
+// are written to a file so console speed doesn't dominate the timings.
+//
+// Usage: log_throughput [records-per-thread] [log-file]
+//
+// "submit" is the rate seen by the logging threads, "total" includes
+// writing everything to the file.
+
+#include "ppx/log.h"
+#include "ppx/timer.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ppx;
+
+struct RunResult
+{
+    double   submitMillis = 0;
+    double   totalMillis  = 0;
+    uint64_t droppedCount = 0;
+};
+
+static RunResult Run(const char* logPath, bool async, LogOverflowPolicy policy, uint32_t threadCount, uint32_t recordCount)
+{
+    Log::Shutdown();
+    Log::Initialize(LOG_MODE_FILE, logPath);
+    if (async) {
+        LogAsyncSettings settings = {};
+        settings.overflowPolicy   = policy;
+        Log::SetAsync(true, settings);
+    }
+
+    Timer timer;
+    timer.Start();
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([t, recordCount]() {
+            for (uint32_t i = 0; i < recordCount; ++i) {
+                PPX_LOG_INFO("thread " << t << " record " << i << " value " << (i * 0.5f));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    RunResult result    = {};
+    result.submitMillis = timer.MillisSinceStart();
+    result.droppedCount = Log::GetDroppedRecordCount();
+    Log::Shutdown();
+    result.totalMillis = timer.MillisSinceStart();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t recordCount = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    const char*    logPath     = (argc > 2) ? argv[2] : "log_throughput.log";
+
+    if (Timer::InitializeStaticData() != TIMER_RESULT_SUCCESS) {
+        std::cerr << "failed initializing timer" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    struct Mode
+    {
+        const char*       name;
+        bool              async;
+        LogOverflowPolicy policy;
+    };
+    const Mode kModes[] = {
+        {"sync", false, LOG_OVERFLOW_POLICY_DROP},
+        {"async drop", true, LOG_OVERFLOW_POLICY_DROP},
+        {"async block", true, LOG_OVERFLOW_POLICY_BLOCK},
+    };
+    const uint32_t kThreadCounts[] = {1, 4, 16};
+
+    std::cout << "records per thread: " << recordCount << std::endl;
+    for (const Mode& mode : kModes) {
+        for (uint32_t threadCount : kThreadCounts) {
+            RunResult      result       = Run(logPath, mode.async, mode.policy, threadCount, recordCount);
+            const uint64_t totalRecords = static_cast<uint64_t>(threadCount) * recordCount;
+            std::cout << mode.name << ", " << threadCount << " threads:" << std::endl;
+            std::cout << "   submit : " << (totalRecords / result.submitMillis) * 1000.0 << " records/s" << std::endl;
+            std::cout << "   total  : " << (totalRecords / result.totalMillis) * 1000.0 << " records/s" << std::endl;
+            std::cout << "   dropped: " << result.droppedCount << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
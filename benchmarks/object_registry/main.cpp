@@ -0,0 +1,109 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures grfx::Device create/destroy throughput with a large number of
+// live objects. Semaphores are used since they're the cheapest objects to
+// create on both APIs, so the device's bookkeeping shows up in the timings.
+
+#include "ppx/ppx.h"
+#include "ppx/timer.h"
+
+#include <random>
+
+using namespace ppx;
+
+#if defined(USE_DX12)
+const grfx::Api kApi = grfx::API_DX_12_0;
+#elif defined(USE_VK)
+const grfx::Api kApi = grfx::API_VK_1_1;
+#endif
+
+class ProjApp
+    : public ppx::Application
+{
+public:
+    virtual void Config(ppx::ApplicationSettings& settings) override;
+    virtual void Setup() override;
+    virtual void Render() override;
+
+private:
+    void RunChurn(uint32_t liveCount, uint32_t churnCount);
+};
+
+void ProjApp::Config(ppx::ApplicationSettings& settings)
+{
+    settings.appName                        = "object_registry";
+    settings.headless                       = true;
+    settings.enableImGui                    = false;
+    settings.grfx.api                       = kApi;
+    settings.grfx.enableDebug               = false;
+    settings.grfx.device.graphicsQueueCount = 1;
+    settings.grfx.numFramesInFlight         = 1;
+}
+
+void ProjApp::RunChurn(uint32_t liveCount, uint32_t churnCount)
+{
+    std::vector<grfx::SemaphorePtr> semaphores(liveCount);
+
+    grfx::SemaphoreCreateInfo createInfo = {};
+
+    Timer timer;
+    timer.Start();
+    for (auto& semaphore : semaphores) {
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&createInfo, &semaphore));
+    }
+    const double createMillis = timer.MillisSinceStart();
+
+    // Destroy a random live object and create a replacement, random
+    // victims avoid favoring either end of the device's containers.
+    std::mt19937 rng(liveCount);
+    timer.Start();
+    for (uint32_t i = 0; i < churnCount; ++i) {
+        grfx::SemaphorePtr& semaphore = semaphores[rng() % liveCount];
+        GetDevice()->DestroySemaphore(semaphore);
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&createInfo, &semaphore));
+    }
+    const double churnMillis = timer.MillisSinceStart();
+
+    timer.Start();
+    for (auto& semaphore : semaphores) {
+        GetDevice()->DestroySemaphore(semaphore);
+    }
+    const double destroyMillis = timer.MillisSinceStart();
+
+    PPX_LOG_INFO("live objects: " << liveCount);
+    PPX_LOG_INFO("   create : " << (liveCount / createMillis) * 1000.0 << " objects/s");
+    PPX_LOG_INFO("   churn  : " << (churnCount / churnMillis) * 1000.0 << " destroy+create/s");
+    PPX_LOG_INFO("   destroy: " << (liveCount / destroyMillis) * 1000.0 << " objects/s");
+}
+
+void ProjApp::Setup()
+{
+    auto cl_options = GetExtraOptions();
+
+    const uint32_t churnCount = cl_options.GetExtraOptionValueOrDefault<uint32_t>("churn-count", 10000);
+
+    const uint32_t kLiveCounts[] = {1000, 10000, 100000};
+    for (uint32_t liveCount : kLiveCounts) {
+        RunChurn(liveCount, churnCount);
+    }
+}
+
+void ProjApp::Render()
+{
+    Quit();
+}
+
+SETUP_APPLICATION(ProjApp)
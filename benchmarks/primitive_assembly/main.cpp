@@ -17,6 +17,7 @@
 
 #include "ppx/ppx.h"
 #include "ppx/csv_file_log.h"
+#include "ppx/mesh_optimize.h"
 
 using namespace ppx;
 
@@ -53,12 +54,17 @@ private:
     ppx::grfx::PipelineInterfacePtr mPipelineInterface;
     ppx::grfx::GraphicsPipelinePtr  mPipeline;
     ppx::grfx::BufferPtr            mVertexBuffer;
+    ppx::grfx::BufferPtr            mIndexBuffer;
     grfx::DrawPassPtr               mDrawPass;
     grfx::Viewport                  mViewport;
     grfx::Rect                      mScissorRect;
     grfx::VertexBinding             mVertexBinding;
     uint2                           mRenderTargetSize;
     uint32_t                        mNumTriangles;
+    uint32_t                        mSphereSegments     = 0;
+    bool                            mOptimizeMesh       = false;
+    uint32_t                        mIndexCount         = 0;
+    uint32_t                        mInstanceCount      = 0;
     std::string                     mCSVFileName;
     uint64_t                        mGpuWorkDuration    = 0;
     bool                            mUsePipelineQuery   = false;
@@ -129,6 +135,16 @@ void ProjApp::SetupTestParameters()
 
     // Whether to use pipeline statistics queries.
     mUsePipelineQuery = cl_options.HasExtraOption("use-pipeline-query");
+
+    // Number of longitude and latitude segments of an indexed sphere mesh
+    // to draw instead of single triangles. 0 draws single triangles.
+    mSphereSegments = cl_options.GetExtraOptionValueOrDefault<uint32_t>("sphere-segments", 0);
+
+    // Whether to optimize the sphere mesh for vertex cache and overdraw efficiency
+    mOptimizeMesh = cl_options.HasExtraOption("optimize-mesh");
+    if (mOptimizeMesh && (mSphereSegments == 0)) {
+        PPX_LOG_WARN("--optimize-mesh has no effect without --sphere-segments");
+    }
 }
 
 void ProjApp::Setup()
@@ -232,14 +248,37 @@ void ProjApp::Setup()
 
     // Buffer and geometry data
     {
-        // clang-format off
-        std::vector<float> vertexData = {
-            // position           
-             0.0f,  0.5f, 0.0f, 1.0f,
-            -0.5f, -0.5f, 0.0f, 1.0f,
-             0.5f, -0.5f, 0.0f, 1.0f,
-        };
-        // clang-format on
+        std::vector<float>    vertexData;
+        std::vector<uint32_t> indexData;
+        if (mSphereSegments == 0) {
+            // clang-format off
+            vertexData = {
+                // position           
+                 0.0f,  0.5f, 0.0f, 1.0f,
+                -0.5f, -0.5f, 0.0f, 1.0f,
+                 0.5f, -0.5f, 0.0f, 1.0f,
+            };
+            // clang-format on
+            mIndexCount    = 0;
+            mInstanceCount = mNumTriangles;
+        }
+        else {
+            TriMesh mesh = TriMesh::CreateSphere(0.5f, mSphereSegments, mSphereSegments, TriMeshOptions().Indices());
+            if (mOptimizeMesh) {
+                PPX_CHECKED_CALL(OptimizeMesh(&mesh));
+            }
+
+            for (uint32_t i = 0; i < mesh.GetCountPositions(); ++i) {
+                const float3& position = *mesh.GetDataPositions(i);
+                vertexData.insert(vertexData.end(), {position.x, position.y, position.z, 1.0f});
+            }
+            indexData.assign(mesh.GetDataIndicesU32(), mesh.GetDataIndicesU32() + mesh.GetCountIndices());
+
+            // Draw enough sphere instances to get close to the requested triangle count
+            mIndexCount    = mesh.GetCountIndices();
+            mInstanceCount = std::max<uint32_t>(1, mNumTriangles / mesh.GetCountTriangles());
+            PPX_LOG_INFO("Sphere triangle count: " << mesh.GetCountTriangles() << " | instance count: " << mInstanceCount);
+        }
         uint32_t dataSize = ppx::SizeInBytesU32(vertexData);
 
         grfx::BufferCreateInfo bufferCreateInfo       = {};
@@ -254,6 +293,22 @@ void ProjApp::Setup()
         PPX_CHECKED_CALL(mVertexBuffer->MapMemory(0, &pAddr));
         memcpy(pAddr, vertexData.data(), dataSize);
         mVertexBuffer->UnmapMemory();
+
+        if (!indexData.empty()) {
+            dataSize = ppx::SizeInBytesU32(indexData);
+
+            bufferCreateInfo                             = {};
+            bufferCreateInfo.size                        = dataSize;
+            bufferCreateInfo.usageFlags.bits.indexBuffer = true;
+            bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+            bufferCreateInfo.initialState                = grfx::RESOURCE_STATE_INDEX_BUFFER;
+
+            PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mIndexBuffer));
+
+            PPX_CHECKED_CALL(mIndexBuffer->MapMemory(0, &pAddr));
+            memcpy(pAddr, indexData.data(), dataSize);
+            mIndexBuffer->UnmapMemory();
+        }
     }
 
     mViewport    = {0, 0, float(mRenderTargetSize.x), float(mRenderTargetSize.y), 0, 1};
@@ -305,7 +360,13 @@ void ProjApp::Render()
             if (mUsePipelineQuery) {
                 frame.cmd->BeginQuery(frame.pipelineStatsQuery, 0);
             }
-            frame.cmd->Draw(3, mNumTriangles, 0, 0);
+            if (mIndexBuffer) {
+                frame.cmd->BindIndexBuffer(mIndexBuffer, grfx::INDEX_TYPE_UINT32);
+                frame.cmd->DrawIndexed(mIndexCount, mInstanceCount);
+            }
+            else {
+                frame.cmd->Draw(3, mInstanceCount, 0, 0);
+            }
             if (mUsePipelineQuery) {
                 frame.cmd->EndQuery(frame.pipelineStatsQuery, 0);
             }
@@ -22,6 +22,7 @@
 #include "ppx/log.h"
 #include "ppx/ppx.h"
 #include "ppx/csv_file_log.h"
+#include "ppx/thread_pool.h"
 
 using namespace ppx;
 
@@ -42,6 +43,10 @@ public:
     void SaveResultsToFile();
 
 private:
+    void RecordTextureLoadMetrics(const grfx_util::BatchLoadStats& stats);
+    void RecordLoadTimeMetric(const char* name, double valueMs);
+    void UpdateStreamedImages();
+
     struct PerFrame
     {
         ppx::grfx::CommandBufferPtr cmd;
@@ -70,9 +75,17 @@ private:
 
     // Textures
     uint32_t                                    mNumImages;
+    uint32_t                                    mNumThreads;
     std::vector<ppx::grfx::ImagePtr>            mImages;
     std::vector<ppx::grfx::SampledImageViewPtr> mSampledImageViews;
 
+    // Streamed compressed textures
+    std::string                 mCompressedTexture;
+    ppx::grfx::UploadQueuePtr   mUploadQueue;
+    ppx::grfx::ImageStreamerPtr mImageStreamer;
+    std::vector<uint32_t>       mViewMipLevels;
+    Timer                       mStreamTimer;
+
     // Stats
     uint64_t    mGpuWorkDuration = 0;
     std::string mCSVFileName;
@@ -104,6 +117,78 @@ void ProjApp::SaveResultsToFile()
     }
 }
 
+void ProjApp::RecordTextureLoadMetrics(const grfx_util::BatchLoadStats& stats)
+{
+    if (!HasActiveMetricsRun()) {
+        return;
+    }
+
+    const std::pair<const char*, double> stages[] = {
+        {"Texture Decode Time", stats.decodeMs},
+        {"Texture Mip Time", stats.mipMs},
+        {"Texture Upload Time", stats.uploadMs},
+    };
+    for (const auto& [name, value] : stages) {
+        RecordLoadTimeMetric(name, value);
+    }
+}
+
+void ProjApp::RecordLoadTimeMetric(const char* name, double valueMs)
+{
+    if (!HasActiveMetricsRun()) {
+        return;
+    }
+
+    metrics::MetricMetadata metadata = {metrics::MetricType::GAUGE, name, "ms", metrics::MetricInterpretation::LOWER_IS_BETTER, {0.f, 100000.f}};
+    metrics::MetricID       id       = AddMetric(metadata);
+    PPX_ASSERT_MSG(id != metrics::kInvalidMetricID, "Failed to add " << name << " metric");
+
+    metrics::MetricData data = {metrics::MetricType::GAUGE};
+    data.gauge.seconds       = GetElapsedSeconds();
+    data.gauge.value         = valueMs;
+    RecordMetricData(id, data);
+}
+
+void ProjApp::UpdateStreamedImages()
+{
+    PPX_CHECKED_CALL(mImageStreamer->Update());
+
+    // The previous frame is done, so views can be replaced
+    std::vector<grfx::WriteDescriptor> writes;
+    for (uint32_t i = 0; i < mNumImages; ++i) {
+        const uint32_t mipLevel = mImageStreamer->GetResidentMipLevel(mImages[i]);
+        if (mipLevel == mViewMipLevels[i]) {
+            continue;
+        }
+
+        GetDevice()->DestroySampledImageView(mSampledImageViews[i]);
+
+        grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(mImages[i]);
+        viewCreateInfo.mipLevel                         = mipLevel;
+        viewCreateInfo.mipLevelCount                    = mImages[i]->GetMipLevelCount() - mipLevel;
+        PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &mSampledImageViews[i]));
+        mViewMipLevels[i] = mipLevel;
+
+        grfx::WriteDescriptor write;
+        write.binding    = i;
+        write.arrayIndex = 0;
+        write.type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.pImageView = mSampledImageViews[i];
+        writes.push_back(write);
+    }
+    if (!writes.empty()) {
+        PPX_CHECKED_CALL(mDescriptorSet->UpdateDescriptors(CountU32(writes), writes.data()));
+    }
+
+    if (mImageStreamer->GetStreamingImageCount() == 0) {
+        // Include the GPU copies of the last levels
+        PPX_CHECKED_CALL(mUploadQueue->WaitIdle());
+        const double residentMs = mStreamTimer.MillisSinceStart();
+        PPX_LOG_INFO("Compressed textures fully resident after " << residentMs << " ms");
+        RecordLoadTimeMetric("Texture Time To Resident", residentMs);
+    }
+}
+
 void ProjApp::Setup()
 {
     auto cl_options = GetExtraOptions();
@@ -115,6 +200,13 @@ void ProjApp::Setup()
         mNumImages = 1;
     }
 
+    // Number of threads decoding images and generating mips, counting the loading thread
+    // which works alongside the pool. 1 loads serially, 0 uses the default thread pool.
+    mNumThreads = cl_options.GetExtraOptionValueOrDefault<uint32_t>("threads", 0);
+
+    // DDS, KTX or KTX2 asset streamed in smallest level first instead of the PNG, e.g. basic/textures/altimeter/altimeter_albedo.dds
+    mCompressedTexture = cl_options.GetExtraOptionValueOrDefault<std::string>("compressed-texture", "");
+
     // Name of the CSV output file
     mCSVFileName = cl_options.GetExtraOptionValueOrDefault<std::string>("stats-file", "stats.csv");
     if (mCSVFileName.empty()) {
@@ -196,8 +288,40 @@ void ProjApp::Setup()
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mDescriptorSetLayout));
     }
 
-    // Texture image and view
-    {
+    // Compressed texture image and view
+    if (!mCompressedTexture.empty()) {
+        grfx::UploadQueueCreateInfo uploadQueueCreateInfo = {};
+        uploadQueueCreateInfo.pQueue                      = GetGraphicsQueue();
+        PPX_CHECKED_CALL(GetDevice()->CreateUploadQueue(&uploadQueueCreateInfo, &mUploadQueue));
+
+        grfx::ImageStreamerCreateInfo streamerCreateInfo = {};
+        streamerCreateInfo.pUploadQueue                  = mUploadQueue;
+        PPX_CHECKED_CALL(GetDevice()->CreateImageStreamer(&streamerCreateInfo, &mImageStreamer));
+
+        mStreamTimer.Start();
+        for (uint32_t i = 0; i < mNumImages; ++i) {
+            grfx::ImagePtr image;
+            PPX_CHECKED_CALL(mImageStreamer->CreateImageFromFile(GetAssetPath(mCompressedTexture), &image));
+            mImages.push_back(image);
+
+            const uint32_t mipLevel = mImageStreamer->GetResidentMipLevel(image);
+            mViewMipLevels.push_back(mipLevel);
+
+            grfx::SampledImageViewPtr        imageView;
+            grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(image);
+            viewCreateInfo.mipLevel                         = mipLevel;
+            viewCreateInfo.mipLevelCount                    = image->GetMipLevelCount() - mipLevel;
+            PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &imageView));
+            mSampledImageViews.push_back(imageView);
+        }
+        // CreateImageFromFile() waits for the initial levels, so the time
+        // includes the GPU copies
+        const double firstUsableMs = mStreamTimer.MillisSinceStart();
+        PPX_LOG_INFO("Compressed texture load: first usable after " << firstUsableMs << " ms, " << mImageStreamer->GetPendingBytes() << " bytes left to stream");
+        RecordLoadTimeMetric("Texture Time To First Usable", firstUsableMs);
+    }
+    else {
+        // PNG decoded on the thread pool
         std::string res = "1080p";
         if (mRenderTargetSize == uint2{3840, 2160}) {
             res = "4k";
@@ -205,11 +329,22 @@ void ProjApp::Setup()
 
         grfx_util::ImageOptions options = grfx_util::ImageOptions().MipLevelCount(1);
 
-        for (uint32_t i = 0; i < mNumImages; ++i) {
-            grfx::ImagePtr image;
-            PPX_CHECKED_CALL(grfx_util::CreateImageFromFile(GetDevice()->GetGraphicsQueue(), GetAssetPath("benchmarks/textures/bricks_" + res + ".png"), &image, options, false));
-            mImages.push_back(image);
+        std::vector<std::filesystem::path> paths(mNumImages, GetAssetPath("benchmarks/textures/bricks_" + res + ".png"));
 
+        std::unique_ptr<ThreadPool> threadPool;
+        if (mNumThreads == 1) {
+            threadPool = ThreadPool::CreateSerial();
+        }
+        else if (mNumThreads > 1) {
+            threadPool = std::make_unique<ThreadPool>(mNumThreads - 1);
+        }
+
+        grfx_util::BatchLoadStats stats = {};
+        PPX_CHECKED_CALL(grfx_util::CreateImagesFromFiles(GetDevice()->GetGraphicsQueue(), paths, &mImages, options, threadPool.get(), &stats));
+        PPX_LOG_INFO("Texture load with " << stats.threadCount << " threads: decode " << stats.decodeMs << " ms, mip " << stats.mipMs << " ms, upload " << stats.uploadMs << " ms");
+        RecordTextureLoadMetrics(stats);
+
+        for (const auto& image : mImages) {
             grfx::SampledImageViewPtr        imageView;
             grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(image);
             PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &imageView));
@@ -301,6 +436,10 @@ void ProjApp::Render()
     // Reset queries
     frame.timestampQuery->Reset(0, 2);
 
+    if (mImageStreamer && (mImageStreamer->GetStreamingImageCount() > 0)) {
+        UpdateStreamedImages();
+    }
+
     // Build command buffer
     PPX_CHECKED_CALL(frame.cmd->Begin());
     {
@@ -17,11 +17,13 @@
 
 #include "ppx/base_application.h"
 #include "ppx/command_line_parser.h"
+#include "ppx/frame_pacer.h"
 #include "ppx/fs.h"
 #include "ppx/imgui_impl.h"
 #include "ppx/knob.h"
 #include "ppx/math_config.h"
 #include "ppx/metrics.h"
+#include "ppx/profiler.h"
 #include "ppx/timer.h"
 #include "ppx/window.h"
 #include "ppx/xr_component.h"
@@ -228,23 +230,29 @@ struct StandardOptions
 {
     // Flags
     std::shared_ptr<KnobFlag<bool>> pListGpus;
+    std::shared_ptr<KnobFlag<bool>> pLogAsync;
     std::shared_ptr<KnobFlag<bool>> pUseSoftwareRenderer;
 #if !defined(PPX_LINUX_HEADLESS)
     std::shared_ptr<KnobFlag<bool>> pHeadless;
 #endif
     std::shared_ptr<KnobFlag<bool>> pDeterministic;
     std::shared_ptr<KnobFlag<bool>> pEnableMetrics;
+    std::shared_ptr<KnobFlag<bool>> pMetricsStreaming;
     std::shared_ptr<KnobFlag<bool>> pOverwriteMetricsFile;
 
     // Options
     std::shared_ptr<KnobFlag<uint32_t>> pGpuIndex;
     std::shared_ptr<KnobFlag<uint64_t>> pFrameCount;
+    std::shared_ptr<KnobFlag<uint32_t>> pHeadlessRefreshRate;
+    std::shared_ptr<KnobFlag<uint32_t>> pPacedFrameRate;
     std::shared_ptr<KnobFlag<uint32_t>> pRunTimeMs;
     std::shared_ptr<KnobFlag<int>>      pStatsFrameWindow;
+    std::shared_ptr<KnobFlag<int>>      pScreenshotFrameInterval;
     std::shared_ptr<KnobFlag<int>>      pScreenshotFrameNumber;
 
     std::shared_ptr<KnobFlag<std::string>> pScreenshotPath;
     std::shared_ptr<KnobFlag<std::string>> pMetricsFilename;
+    std::shared_ptr<KnobFlag<std::string>> pTraceFilename;
 
     std::shared_ptr<KnobFlag<std::pair<int, int>>> pResolution;
 #if defined(PPX_BUILD_XR)
@@ -256,6 +264,8 @@ struct StandardOptions
     std::shared_ptr<KnobFlag<std::vector<std::string>>> pConfigJsonPaths;
 
     std::shared_ptr<KnobFlag<std::string>> pShadingRateMode;
+    std::shared_ptr<KnobFlag<std::string>> pHeadlessPresentMode;
+    std::shared_ptr<KnobFlag<std::string>> pFramePacingPolicy;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -310,7 +320,7 @@ struct ApplicationSettings
 #endif
 
         uint32_t numFramesInFlight = 1;
-        uint32_t pacedFrameRate    = 60;
+        uint32_t pacedFrameRate    = 60; // See FramePacer, 0 disables pacing
 
         struct
         {
@@ -323,6 +333,10 @@ struct ApplicationSettings
             // The application must not use FDM or VRS without setting this to
             // the corresponding shading rate mode.
             grfx::ShadingRateMode supportShadingRateMode = grfx::SHADING_RATE_NONE;
+
+            // Pipeline cache data is loaded from and saved to this file in
+            // the default output directory. Set to empty to disable.
+            std::string pipelineCacheFile = "pipeline_cache_vk.bin";
         } device;
 
         struct
@@ -337,6 +351,11 @@ struct ApplicationSettings
 #endif
             grfx::Format depthFormat = grfx::FORMAT_UNDEFINED;
             uint32_t     imageCount  = 2;
+
+            // Present mode emulated by the headless swapchain and its
+            // refresh rate in Hz, see grfx::internal::HeadlessPresentQueue.
+            grfx::PresentMode headlessPresentMode = grfx::PRESENT_MODE_IMMEDIATE;
+            uint32_t          headlessRefreshRate = 60;
         } swapchain;
 
         // imGuiDynamicRendering controls whether ImGui window is
@@ -358,15 +377,21 @@ struct ApplicationSettings
 #if !defined(PPX_LINUX_HEADLESS)
         bool headless = false;
 #endif
-        bool                listGpus              = false;
-        std::string         metricsFilename       = "report_@.json";
-        bool                overwriteMetricsFile  = false;
-        std::pair<int, int> resolution            = std::make_pair(0, 0);
-        uint32_t            runTimeMs             = 0;
-        int                 screenshotFrameNumber = -1;
-        std::string         screenshotPath        = "screenshot_frame_#.ppm";
-        int                 statsFrameWindow      = -1;
-        bool                useSoftwareRenderer   = false;
+        std::string         headlessPresentMode     = "immediate";
+        uint32_t            headlessRefreshRate     = 60;
+        bool                listGpus                = false;
+        bool                logAsync                = false;
+        std::string         metricsFilename         = "report_@.json";
+        bool                metricsStreaming        = false;
+        bool                overwriteMetricsFile    = false;
+        std::pair<int, int> resolution              = std::make_pair(0, 0);
+        uint32_t            runTimeMs               = 0;
+        int                 screenshotFrameInterval = 0;
+        int                 screenshotFrameNumber   = -1;
+        std::string         screenshotPath          = "screenshot_frame_#.ppm";
+        int                 statsFrameWindow        = -1;
+        std::string         traceFilename           = "";
+        bool                useSoftwareRenderer     = false;
 #if defined(PPX_BUILD_XR)
         std::pair<int, int>      xrUiResolution       = std::make_pair(0, 0);
         std::vector<std::string> xrRequiredExtensions = {};
@@ -434,6 +459,8 @@ protected:
 
     virtual metrics::GaugeBasicStatistics GetGaugeBasicStatistics(metrics::MetricID id) const;
 
+    // Queues a capture of the current swapchain image, it's written to
+    // disk by a worker thread once the copy has completed.
     void TakeScreenshot();
 
     void DrawImGui(grfx::CommandBuffer* pCommandBuffer);
@@ -583,6 +610,9 @@ private:
 
     // Updates the shared, app-level metrics.
     void UpdateAppMetrics();
+    void RecordFramePacingMetrics(const FramePacerFrameStats& stats);
+    // Gauge mode selected by --metrics-streaming.
+    metrics::GaugeMode GetGaugeMode() const;
     // Saves the metrics data to a file on disk.
     void SaveMetricsReportToDisk();
 
@@ -598,6 +628,10 @@ private:
     // Render the frame, handles both XR and non-XR cases
     void RenderFrame();
 
+    // True if the current frame is selected by --screenshot-frame-number
+    // and --screenshot-frame-interval
+    bool IsScreenshotFrame() const;
+
     void MainLoop();
 
 #if defined(PPX_BUILD_XR)
@@ -641,6 +675,7 @@ private:
     grfx::SurfacePtr                mSurface                    = nullptr; // Requires enableDisplay
     std::vector<grfx::SwapchainPtr> mSwapchains;                           // Requires enableDisplay
     std::unique_ptr<ImGuiImpl>      mImGui;
+    grfx::FrameCapturePtr           mFrameCapture               = nullptr; // Created on first screenshot
     KnobManager                     mKnobManager;
 
     uint64_t          mFrameCount        = 0;
@@ -650,9 +685,11 @@ private:
     float             mFrameEndTime      = 0;
     float             mPreviousFrameTime = 0;
     float             mAverageFrameTime  = 0;
-    double            mFirstFrameTime    = 0;
+    FramePacer        mFramePacer;
     std::deque<float> mFrameTimesMs;
 
+    ProfilerEventToken mRenderEventToken = 0;
+
     // Metrics
     struct
     {
@@ -661,6 +698,23 @@ private:
         metrics::MetricID framerateId    = metrics::kInvalidMetricID;
         metrics::MetricID frameCountId   = metrics::kInvalidMetricID;
 
+        metrics::MetricID        pipelineCacheHitsId   = metrics::kInvalidMetricID;
+        metrics::MetricID        pipelineCacheMissesId = metrics::kInvalidMetricID;
+        grfx::PipelineCacheStats pipelineCacheStats    = {}; // Last recorded stats
+
+        // Default staging ring of the device
+        metrics::MetricID      stagingBytesId     = metrics::kInvalidMetricID;
+        metrics::MetricID      stagingStallsId    = metrics::kInvalidMetricID;
+        metrics::MetricID      stagingStallTimeId = metrics::kInvalidMetricID;
+        metrics::MetricID      stagingGrowsId     = metrics::kInvalidMetricID;
+        grfx::StagingRingStats stagingRingStats   = {}; // Last recorded stats
+
+        // Frame pacing, only added if pacing is enabled
+        metrics::MetricID framePacingErrorId  = metrics::kInvalidMetricID;
+        metrics::MetricID framePacingIdleId   = metrics::kInvalidMetricID;
+        metrics::MetricID framePacingSpinId   = metrics::kInvalidMetricID;
+        metrics::MetricID framePacingMissesId = metrics::kInvalidMetricID;
+
         double   framerateRecordTimer   = 0.0;
         uint64_t framerateFrameCount    = 0;
         bool     resetFramerateTracking = true;
@@ -0,0 +1,187 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_asset_archive_h
+#define ppx_asset_archive_h
+
+#include "ppx/config.h"
+#include "ppx/fs.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ppx {
+
+// Packed asset archive
+//
+// Layout, all integers are little endian:
+//
+//   AssetArchiveHeader
+//   Entry data, each entry starts on a kAssetArchiveAlignment boundary
+//   AssetArchiveEntry[entryCount], sorted by (nameHash, name)
+//   Entry names, not null terminated
+//
+// Entry names are relative paths with '/' separators, see
+// AssetArchive::NormalizeName(). nameHash is XXH64 of the name with seed 0.
+// The index is searched in place so opening an archive doesn't parse or
+// allocate per entry.
+//
+// tools/pack_assets.py builds archives from a directory.
+//
+constexpr char     kAssetArchiveMagic[8]  = {'P', 'P', 'X', 'A', 'R', 'C', 'H', '\0'};
+constexpr uint32_t kAssetArchiveVersion   = 1;
+constexpr uint32_t kAssetArchiveAlignment = 4096;
+
+enum AssetCompression : uint32_t
+{
+    ASSET_COMPRESSION_NONE = 0,
+    // LZ4 block format, without a frame or size prefix
+    ASSET_COMPRESSION_LZ4 = 1,
+};
+
+struct AssetArchiveHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t indexOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint32_t alignment;
+    uint32_t reserved;
+};
+static_assert(sizeof(AssetArchiveHeader) == 48, "AssetArchiveHeader is an on-disk structure");
+
+struct AssetArchiveEntry
+{
+    uint64_t nameHash;
+    uint64_t dataOffset;
+    uint64_t storedSize; // Size in the archive
+    uint64_t size;       // Size once decompressed
+    uint32_t nameOffset; // Relative to namesOffset
+    uint32_t nameLength;
+    uint32_t compression; // AssetCompression
+    uint32_t reserved;
+};
+static_assert(sizeof(AssetArchiveEntry) == 48, "AssetArchiveEntry is an on-disk structure");
+
+//! @class AssetArchive
+//!
+//! Read-only view of a packed asset archive. The archive is memory-mapped
+//! when fs::File supports it, otherwise it's read into memory.
+//!
+//! Archives mounted with fs::MountArchive() are served transparently by
+//! fs::File and fs::path_exists(), see fs.h.
+//!
+class AssetArchive
+{
+public:
+    AssetArchive() {}
+    ~AssetArchive() {}
+
+    AssetArchive(const AssetArchive&)            = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    Result Open(const std::filesystem::path& path);
+
+    const std::filesystem::path& GetPath() const { return mPath; }
+    uint32_t                     GetEntryCount() const { return mEntryCount; }
+    const AssetArchiveEntry&     GetEntry(uint32_t index) const { return mEntries[index]; }
+    std::string_view             GetEntryName(const AssetArchiveEntry& entry) const;
+
+    //! Returns nullptr if there's no entry called name. name doesn't need
+    //! to be normalized.
+    const AssetArchiveEntry* FindEntry(const std::filesystem::path& name) const;
+    const AssetArchiveEntry* FindEntry(std::string_view normalizedName) const;
+
+    //! Returns true if any entry's name starts with normalizedName + "/".
+    bool ContainsDirectory(std::string_view normalizedName) const;
+
+    //! Entry data as stored in the archive, compressed if the entry is.
+    const void* GetStoredData(const AssetArchiveEntry& entry) const;
+
+    //! Copies, or decompresses, the entry's data into pData.
+    Result ReadEntry(const AssetArchiveEntry& entry, std::vector<char>* pData) const;
+
+    //! Returns true if path is a regular file that starts with the archive magic.
+    static bool IsArchive(const std::filesystem::path& path);
+
+    //! Lexically normalized relative path with '/' separators, e.g.
+    //! "./textures\\..\\shaders/a.spv" becomes "shaders/a.spv".
+    static std::string NormalizeName(const std::filesystem::path& name);
+
+    //! True if path has no '.' or '..' components, no repeated or trailing
+    //! '/' and no '\\', i.e. lexically_normal() wouldn't change it.
+    static bool IsLexicallyNormal(std::string_view path);
+
+    static uint64_t HashName(std::string_view normalizedName);
+
+private:
+    Result Validate();
+
+private:
+    std::filesystem::path    mPath;
+    fs::File                 mFile;
+    std::vector<char>        mStorage; // File content if mFile isn't mapped
+    const char*              mpData      = nullptr;
+    size_t                   mDataSize   = 0;
+    const AssetArchiveEntry* mEntries    = nullptr;
+    uint32_t                 mEntryCount = 0;
+    const char*              mpNames     = nullptr;
+    uint64_t                 mNamesSize  = 0;
+};
+
+//! @class AssetArchiveWriter
+//!
+//! Builds an archive in memory and writes it with Write(). Entries that
+//! don't get smaller when compressed are stored uncompressed.
+//!
+class AssetArchiveWriter
+{
+public:
+    AssetArchiveWriter() {}
+    ~AssetArchiveWriter() {}
+
+    Result AddEntry(const std::filesystem::path& name, const void* pData, size_t size, AssetCompression compression = ASSET_COMPRESSION_NONE);
+    Result AddFile(const std::filesystem::path& name, const std::filesystem::path& sourcePath, AssetCompression compression = ASSET_COMPRESSION_NONE);
+
+    Result Write(const std::filesystem::path& path) const;
+
+private:
+    struct PendingEntry
+    {
+        std::string       name;
+        uint64_t          nameHash    = 0;
+        uint64_t          size        = 0;
+        AssetCompression  compression = ASSET_COMPRESSION_NONE;
+        std::vector<char> data;
+    };
+
+    std::vector<PendingEntry> mEntries;
+};
+
+//! LZ4 block compression, exposed for tools and tests. Returns the number
+//! of bytes written to pDst.
+size_t Lz4CompressBlock(const void* pSrc, size_t srcSize, std::vector<char>* pDst);
+
+//! Returns false if pSrc isn't a valid block that decompresses to exactly
+//! dstSize bytes.
+bool Lz4DecompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize);
+
+} // namespace ppx
+
+#endif // ppx_asset_archive_h
@@ -39,6 +39,8 @@ public:
     uint32_t        GetProcessId() const;
     std::filesystem::path GetApplicationPath() const;
 
+    // path can be a directory or an asset archive built with tools/pack_assets.py.
+    // Archives are mounted with fs::MountArchive() and searched like directories.
     const std::vector<std::filesystem::path>& GetAssetDirs() const { return mAssetDirs; }
     void                                      AddAssetDir(const std::filesystem::path& path, bool insertAtFront = false);
 
@@ -61,6 +61,7 @@
             << "Condition : " << #COND << " " << PPX_ENDL                    \
             << "Function  : " << __FUNCTION__ << PPX_ENDL                    \
             << "Location  : " << __FILE__ << " : " << PPX_LINE << PPX_ENDL); \
+        PPX_LOG_FLUSH();                                                     \
         assert(false);                                                       \
     }
 
@@ -71,6 +72,7 @@
             << "Argument  : " << #ARG << " " << PPX_ENDL                     \
             << "Function  : " << __FUNCTION__ << PPX_ENDL                    \
             << "Location  : " << __FILE__ << " : " << PPX_LINE << PPX_ENDL); \
+        PPX_LOG_FLUSH();                                                     \
         assert(false);                                                       \
     }
 
@@ -84,6 +86,7 @@
                 << "Expression : " << #EXPR << " " << PPX_ENDL                         \
                 << "Function   : " << __FUNCTION__ << PPX_ENDL                         \
                 << "Location   : " << __FILE__ << " : " << PPX_LINE << PPX_ENDL);      \
+            PPX_LOG_FLUSH();                                                           \
             assert(false);                                                             \
         }                                                                              \
     }
@@ -170,6 +173,21 @@ enum Result
     ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED = -5000,
     ERROR_PPM_EXPORT_INVALID_SIZE         = -5001,
 
+    ERROR_ASSET_ARCHIVE_OPEN_FAILED       = -5100,
+    ERROR_ASSET_ARCHIVE_INVALID_FORMAT    = -5101,
+    ERROR_ASSET_ARCHIVE_DUPLICATE_ENTRY   = -5102,
+    ERROR_ASSET_ARCHIVE_DECOMPRESS_FAILED = -5103,
+    ERROR_ASSET_ARCHIVE_WRITE_FAILED      = -5104,
+
+    ERROR_MESH_CACHE_OPEN_FAILED     = -5200,
+    ERROR_MESH_CACHE_INVALID_FORMAT  = -5201,
+    ERROR_MESH_CACHE_SOURCE_MISMATCH = -5202,
+    ERROR_MESH_CACHE_WRITE_FAILED    = -5203,
+
+    ERROR_RENDER_GRAPH_INVALID_RESOURCE   = -5300,
+    ERROR_RENDER_GRAPH_CONFLICTING_ACCESS = -5301,
+    ERROR_RENDER_GRAPH_NOT_COMPILED       = -5302,
+
     ERROR_SCENE_UNSUPPORTED_FILE_TYPE               = -6001,
     ERROR_SCENE_UNSUPPORTED_NODE_TYPE               = -6002,
     ERROR_SCENE_UNSUPPORTED_CAMERA_TYPE             = -6003,
@@ -269,6 +287,21 @@ inline const char* ToString(ppx::Result value)
 
         case Result::ERROR_FONT_PARSE_FAILED                          : return "ERROR_FONT_PARSE_FAILED";
         case Result::ERROR_INVALID_UTF8_STRING                        : return "ERROR_INVALID_UTF8_STRING";
+
+        case Result::ERROR_ASSET_ARCHIVE_OPEN_FAILED                  : return "ERROR_ASSET_ARCHIVE_OPEN_FAILED";
+        case Result::ERROR_ASSET_ARCHIVE_INVALID_FORMAT               : return "ERROR_ASSET_ARCHIVE_INVALID_FORMAT";
+        case Result::ERROR_ASSET_ARCHIVE_DUPLICATE_ENTRY              : return "ERROR_ASSET_ARCHIVE_DUPLICATE_ENTRY";
+        case Result::ERROR_ASSET_ARCHIVE_DECOMPRESS_FAILED            : return "ERROR_ASSET_ARCHIVE_DECOMPRESS_FAILED";
+        case Result::ERROR_ASSET_ARCHIVE_WRITE_FAILED                 : return "ERROR_ASSET_ARCHIVE_WRITE_FAILED";
+
+        case Result::ERROR_MESH_CACHE_OPEN_FAILED                     : return "ERROR_MESH_CACHE_OPEN_FAILED";
+        case Result::ERROR_MESH_CACHE_INVALID_FORMAT                  : return "ERROR_MESH_CACHE_INVALID_FORMAT";
+        case Result::ERROR_MESH_CACHE_SOURCE_MISMATCH                 : return "ERROR_MESH_CACHE_SOURCE_MISMATCH";
+        case Result::ERROR_MESH_CACHE_WRITE_FAILED                    : return "ERROR_MESH_CACHE_WRITE_FAILED";
+
+        case Result::ERROR_RENDER_GRAPH_INVALID_RESOURCE              : return "ERROR_RENDER_GRAPH_INVALID_RESOURCE";
+        case Result::ERROR_RENDER_GRAPH_CONFLICTING_ACCESS            : return "ERROR_RENDER_GRAPH_CONFLICTING_ACCESS";
+        case Result::ERROR_RENDER_GRAPH_NOT_COMPILED                  : return "ERROR_RENDER_GRAPH_NOT_COMPILED";
     }
     // clang-format on
     return "<unknown ppx::Result value>";
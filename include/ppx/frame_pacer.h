@@ -0,0 +1,109 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_frame_pacer_h
+#define ppx_frame_pacer_h
+
+#include <cstdint>
+
+namespace ppx {
+
+enum FramePacerMissPolicy
+{
+    // Deadlines stay on the fixed schedule started by the first frame.
+    // Frames after a stall run back to back until they catch up, so the
+    // average rate over the run is the target rate.
+    FRAME_PACER_MISS_POLICY_CATCH_UP = 0,
+
+    // A missed deadline moves the schedule to the next slot after the
+    // frame end, the same as a display dropping a frame.
+    FRAME_PACER_MISS_POLICY_SKIP = 1,
+};
+
+struct FramePacerCreateInfo
+{
+    // Frames per second, 0 disables pacing.
+    double               frameRate  = 60;
+    FramePacerMissPolicy missPolicy = FRAME_PACER_MISS_POLICY_CATCH_UP;
+
+    // Minimum time before the deadline at which the pacer stops sleeping
+    // and spins. It grows when the OS oversleeps by more than this.
+    double spinSeconds = 0.002;
+};
+
+//! Result of one FramePacer::Wait(), times are in seconds.
+struct FramePacerFrameStats
+{
+    uint64_t frameIndex   = 0;
+    double   deadline     = 0; // When the frame was due
+    double   frameEnd     = 0; // When Wait() was called
+    double   wakeTime     = 0; // When Wait() returned
+    double   sleepSeconds = 0; // Time given up to the OS
+    double   spinSeconds  = 0; // Time spent spinning
+    bool     missed       = false;
+
+    // Distance from the deadline at wake up, how precise the pacing is.
+    // A missed frame's error is how late it was.
+    double GetPacingError() const { return wakeTime - deadline; }
+    double GetIdleSeconds() const { return sleepSeconds + spinSeconds; }
+};
+
+//! @class FramePacer
+//!
+//! Holds frames to a fixed rate. Wait() is called at the end of every
+//! frame and returns at the frame's deadline: it sleeps until
+//! spinSeconds before the deadline and spins for the rest, which avoids
+//! the millisecond of oversleep a plain sleep has. Times come from Timer,
+//! which is CLOCK_MONOTONIC_RAW on Linux.
+//!
+//! Every Wait() reports how the frame did against its deadline, see
+//! FramePacerFrameStats.
+//!
+class FramePacer
+{
+public:
+    FramePacer() {}
+    virtual ~FramePacer() {}
+
+    void Reset(const FramePacerCreateInfo& createInfo);
+
+    bool IsEnabled() const { return mPeriod > 0; }
+
+    // Waits for the deadline of the current frame and moves to the next.
+    // The first call after Reset() doesn't wait, it starts the schedule.
+    FramePacerFrameStats Wait();
+
+    uint64_t GetFrameCount() const { return mFrameIndex; }
+    uint64_t GetMissCount() const { return mMissCount; }
+    double   GetSpinSeconds() const { return mSpinSeconds; }
+
+protected:
+    // Virtual for unit testing purposes.
+    virtual double GetTime() const;
+    virtual void   Sleep(double seconds);
+    virtual void   Spin();
+
+private:
+    FramePacerCreateInfo mCreateInfo  = {};
+    bool                 mStarted     = false;
+    double               mPeriod      = 0;
+    double               mDeadline    = 0;
+    double               mSpinSeconds = 0;
+    uint64_t             mFrameIndex  = 0;
+    uint64_t             mMissCount   = 0;
+};
+
+} // namespace ppx
+
+#endif // ppx_frame_pacer_h
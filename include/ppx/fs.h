@@ -35,17 +35,34 @@
 #include <vector>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 
 #if defined(PPX_ANDROID)
 #include <android_native_app_glue.h>
 #endif
 
+namespace ppx {
+class AssetArchive;
+} // namespace ppx
+
 namespace ppx::fs {
 
 #if defined(PPX_ANDROID)
 void set_android_context(android_app* androidContext);
 #endif
 
+// How a file is going to be read. Passed to the kernel with madvise() when
+// the file is memory-mapped, ignored otherwise.
+enum FileAccessHint
+{
+    // The file is read front to back once, e.g. decoding an image or parsing an OBJ.
+    FILE_ACCESS_HINT_SEQUENTIAL = 0,
+    // The file is read in no particular order, e.g. looking up entries in an archive.
+    FILE_ACCESS_HINT_RANDOM = 1,
+    // The whole file will be needed soon, start reading it in now.
+    FILE_ACCESS_HINT_WILL_NEED = 2,
+};
+
 // Abstract a static, regular file on all platforms.
 // This class doesn't handle sockets, or file which content is not constant
 // for the lifetime of this class.
@@ -60,6 +77,10 @@ class File
         STREAM_HANDLE = 1,
         // The file is accessible through an Android asset handle.
         ASSET_HANDLE = 2,
+        // The file is memory-mapped with mmap().
+        MAPPED_HANDLE = 3,
+        // The file is an entry of a mounted asset archive.
+        ARCHIVE_HANDLE = 4,
     };
 
 public:
@@ -70,14 +91,18 @@ public:
 
     // Opens a file given a specific path.
     // path: the path of the file to open.
-    //  - On desktop, loads the regular file at `path`. (memory-mapping availability is implementation defined).
+    // hint: how the file is going to be read, see FileAccessHint.
+    //  - On Linux, regular files are memory-mapped. Empty files, or files that can't be mapped, are read through a stream.
+    //  - On Windows, loads the regular file at `path` through a stream.
     //  - On Android, relative path are assumed to be loaded from the APK, those are memory mapped.
-    //                absolute path are loaded as regular files (mapping availability is implementation defined).
+    //                absolute path are loaded like on Linux.
+    //  - On all platforms, paths inside an archive mounted with MountArchive() are served from the archive.
+    //    Those are always mapped, compressed entries are decompressed into memory owned by the File.
     //
     // - This API only supports regular files.
     // - This API expects the file not to change size or content while this handle is open.
     // - This class supports RAII. File will be closed on destroy.
-    bool Open(const std::filesystem::path& path);
+    bool Open(const std::filesystem::path& path, FileAccessHint hint = FILE_ACCESS_HINT_SEQUENTIAL);
 
     // Reads `size` bytes from the file into `buffer`.
     // buffer: a pointer to a buffer with at least `count` writable bytes.
@@ -103,20 +128,33 @@ private:
     typedef void AAsset;
 #endif
 
+    // Returns false if the file should be read through a stream instead.
+    bool OpenMapped(const std::filesystem::path& path, FileAccessHint hint);
+    // Returns false if path isn't inside a mounted archive, IsValid() tells if the entry was found.
+    bool OpenArchiveEntry(const std::filesystem::path& path);
+
     FileHandleType mHandleType = BAD_HANDLE;
     AAsset*        mAsset      = nullptr;
     const void*    mBuffer     = nullptr;
+    int            mFd         = -1;
     std::ifstream  mStream;
     size_t         mFileSize   = 0;
     size_t         mFileOffset = 0;
+
+    std::shared_ptr<const AssetArchive> mArchive;     // Keeps the mapping alive
+    std::vector<char>                   mArchiveData; // Decompressed entry
 };
 
+// Read-only std::streambuf over a file's content. Reads directly from the
+// mapping if the file is memory-mapped, otherwise the file is loaded into
+// memory first.
 class FileStream : public std::streambuf
 {
 public:
     bool Open(const char* path);
 
 private:
+    File              mFile;
     std::vector<char> mBuffer;
 };
 
@@ -127,6 +165,15 @@ private:
 //  - android: relative paths are assumed to be in APK's storage (Asset API). Absolute are loaded from disk.
 std::optional<std::vector<char>> load_file(const std::filesystem::path& path);
 
+// Mounts the asset archive at `path`, see asset_archive.h. Paths starting with `path` are then
+// resolved inside the archive by File, FileStream, load_file() and path_exists(), as if the archive
+// was a directory. Mounting an archive that's already mounted does nothing.
+// Returns false if the archive can't be opened.
+bool MountArchive(const std::filesystem::path& path);
+
+// Unmounts an archive mounted with MountArchive(). Files that are open keep the archive alive.
+void UnmountArchive(const std::filesystem::path& path);
+
 // Returns true if a given path exists (file or directory).
 // `path`: the path to check.
 // The path is handled differently depending on the platform:
@@ -24,6 +24,13 @@ namespace ppx {
 template <typename T>
 class VertexDataProcessorBase;
 
+//! Converts count floats to half floats, rounding to nearest even.
+void ConvertToHalf(uint32_t count, const float* pSrc, half* pDst);
+
+//! Converts count floats to 8 bit snorm. Values are clamped to [-1, 1]
+//! and rounded to nearest.
+void ConvertToSnorm8(uint32_t count, const float* pSrc, int8_t* pDst);
+
 enum GeometryVertexAttributeLayout
 {
     GEOMETRY_VERTEX_ATTRIBUTE_LAYOUT_INTERLEAVED     = 1,
@@ -204,11 +211,20 @@ public:
 private:
     Result InternalCtor();
 
+    // Fills an empty geometry from mesh one attribute at a time. Returns
+    // false without changing the geometry if an attribute has a format or
+    // semantic that needs the per vertex path.
+    bool AppendTriMeshData(const TriMesh& mesh);
+
 public:
     // Create object using parameters from createInfo
     static Result Create(const GeometryOptions& createInfo, Geometry* pGeometry);
 
     // Create object using parameters from createInfo using data from mesh
+    //
+    // Attributes with 32 bit float, 16 bit float or 8 bit snorm formats are
+    // converted from the mesh data in bulk. Missing components are zero.
+    //
     static Result Create(
         const GeometryOptions& createInfo,
         const TriMesh&         mesh,
@@ -18,6 +18,7 @@
 #include "ppx/grfx/grfx_image.h"
 #include "ppx/grfx/grfx_queue.h"
 #include "ppx/grfx/grfx_texture.h"
+#include "ppx/grfx/grfx_upload_queue.h"
 #include "ppx/bitmap.h"
 #include "ppx/geometry.h"
 #include "ppx/mipmap.h"
@@ -26,10 +27,30 @@
 #include <array>
 #include <filesystem>
 #include <type_traits>
+#include <vector>
 
 namespace ppx {
+
+class MeshCacheFile;
+class ThreadPool;
+
 namespace grfx_util {
 
+//! @struct BatchLoadStats
+//!
+//! Wall clock time spent in each stage of CreateImagesFromFiles() or
+//! CreateTexturesFromFiles(). Decode and mip generation run on the thread
+//! pool, upload runs on the calling thread. threadCount counts the calling
+//! thread, which works alongside the pool.
+//!
+struct BatchLoadStats
+{
+    double   decodeMs    = 0;
+    double   mipMs       = 0;
+    double   uploadMs    = 0;
+    uint32_t threadCount = 0;
+};
+
 class ImageOptions
 {
 public:
@@ -39,11 +60,15 @@ public:
     // clang-format off
     ImageOptions& AdditionalUsage(grfx::ImageUsageFlags flags) { mAdditionalUsage = flags; return *this; }
     ImageOptions& MipLevelCount(uint32_t levelCount) { mMipLevelCount = levelCount; return *this; }
+    // Records the copies into pUploadQueue and returns without waiting for
+    // them. Flush pUploadQueue before submitting work that uses the image.
+    ImageOptions& UploadQueue(grfx::UploadQueue* pUploadQueue) { mUploadQueue = pUploadQueue; return *this; }
     // clang-format on
 
 private:
     grfx::ImageUsageFlags mAdditionalUsage = grfx::ImageUsageFlags();
     uint32_t              mMipLevelCount   = PPX_REMAINING_MIP_LEVELS;
+    grfx::UploadQueue*    mUploadQueue     = nullptr;
 
     friend Result CreateImageFromBitmap(
         grfx::Queue*        pQueue,
@@ -69,6 +94,20 @@ private:
         const Bitmap*       pBitmap,
         grfx::Image**       ppImage,
         const ImageOptions& options);
+
+    friend Result CreateImageFromMipmap(
+        grfx::Queue*        pQueue,
+        const Mipmap*       pMipmap,
+        grfx::Image**       ppImage,
+        const ImageOptions& options);
+
+    friend Result CreateImagesFromFiles(
+        grfx::Queue*                              pQueue,
+        const std::vector<std::filesystem::path>& paths,
+        std::vector<grfx::ImagePtr>*              pImages,
+        const ImageOptions&                       options,
+        ThreadPool*                               pThreadPool,
+        BatchLoadStats*                           pStats);
 };
 
 //! @fn CopyBitmapToImage
@@ -83,6 +122,20 @@ Result CopyBitmapToImage(
     grfx::ResourceState stateBefore,
     grfx::ResourceState stateAfter);
 
+//! @fn CopyBitmapToImage
+//!
+//! Records the copy into pUploadQueue, the copy isn't submitted until
+//! pUploadQueue is flushed.
+//!
+Result CopyBitmapToImage(
+    grfx::UploadQueue*  pUploadQueue,
+    const Bitmap*       pBitmap,
+    grfx::Image*        pImage,
+    uint32_t            mipLevel,
+    uint32_t            arrayLayer,
+    grfx::ResourceState stateBefore,
+    grfx::ResourceState stateAfter);
+
 //! @fn CreateImageFromBitmap
 //!
 //!
@@ -111,6 +164,40 @@ Result CreateImageFromBitmapGpu(
     grfx::Image**       ppImage,
     const ImageOptions& options = ImageOptions());
 
+//! @fn CreateImageFromMipmap
+//!
+//! Uploads every level of pMipmap. The mip level count in options is
+//! ignored, the level count of pMipmap is used instead.
+//!
+Result CreateImageFromMipmap(
+    grfx::Queue*        pQueue,
+    const Mipmap*       pMipmap,
+    grfx::Image**       ppImage,
+    const ImageOptions& options = ImageOptions());
+
+//! @fn CreateImagesFromFiles
+//!
+//! Batched CreateImageFromFile() for bitmap files, see Bitmap::IsBitmapFile().
+//! Files are decoded and their mip levels generated on pThreadPool, or on
+//! ThreadPool::GetDefault() if pThreadPool is null. Images are then created
+//! on the calling thread and every copy is recorded into one upload queue:
+//! the one in options if set, otherwise a transient queue that's waited on
+//! before returning.
+//!
+//! pImages receives one image per path, in order. If any file fails to
+//! load no images are created. If creating an image fails, the images
+//! created before it are destroyed once the upload queue is idle. With an
+//! upload queue in options that also waits for copies recorded into it
+//! before this call.
+//!
+Result CreateImagesFromFiles(
+    grfx::Queue*                              pQueue,
+    const std::vector<std::filesystem::path>& paths,
+    std::vector<grfx::ImagePtr>*              pImages,
+    const ImageOptions&                       options     = ImageOptions(),
+    ThreadPool*                               pThreadPool = nullptr,
+    BatchLoadStats*                           pStats      = nullptr);
+
 // -------------------------------------------------------------------------------------------------
 
 class TextureOptions
@@ -123,12 +210,16 @@ public:
     TextureOptions& AdditionalUsage(grfx::ImageUsageFlags flags) { mAdditionalUsage = flags; return *this; }
     TextureOptions& InitialState(grfx::ResourceState state) { mInitialState = state; return *this; }
     TextureOptions& MipLevelCount(uint32_t levelCount) { mMipLevelCount = levelCount; return *this; }
+    // Records the copies into pUploadQueue and returns without waiting for
+    // them. Flush pUploadQueue before submitting work that uses the texture.
+    TextureOptions& UploadQueue(grfx::UploadQueue* pUploadQueue) { mUploadQueue = pUploadQueue; return *this; }
     // clang-format on
 
 private:
     grfx::ImageUsageFlags mAdditionalUsage = grfx::ImageUsageFlags();
     grfx::ResourceState   mInitialState    = grfx::ResourceState::RESOURCE_STATE_SHADER_RESOURCE;
     uint32_t              mMipLevelCount   = 1;
+    grfx::UploadQueue*    mUploadQueue     = nullptr;
 
     friend Result CreateTextureFromBitmap(
         grfx::Queue*          pQueue,
@@ -147,6 +238,14 @@ private:
         const std::filesystem::path& path,
         grfx::Texture**              ppTexture,
         const TextureOptions&        options);
+
+    friend Result CreateTexturesFromFiles(
+        grfx::Queue*                              pQueue,
+        const std::vector<std::filesystem::path>& paths,
+        std::vector<grfx::TexturePtr>*            pTextures,
+        const TextureOptions&                     options,
+        ThreadPool*                               pThreadPool,
+        BatchLoadStats*                           pStats);
 };
 
 //! @fn CreateTextureFromBitmap
@@ -189,6 +288,18 @@ Result CreateTextureFromFile(
     grfx::Texture**              ppTexture,
     const TextureOptions&        options = TextureOptions());
 
+//! @fn CreateTexturesFromFiles
+//!
+//! Texture version of CreateImagesFromFiles().
+//!
+Result CreateTexturesFromFiles(
+    grfx::Queue*                              pQueue,
+    const std::vector<std::filesystem::path>& paths,
+    std::vector<grfx::TexturePtr>*            pTextures,
+    const TextureOptions&                     options     = TextureOptions(),
+    ThreadPool*                               pThreadPool = nullptr,
+    BatchLoadStats*                           pStats      = nullptr);
+
 // Create a 1x1 texture with the specified pixel data. The format
 // for the texture is derived from the pixel data type, which
 // can be one of uint8, uint16, uint32 or float.
@@ -405,12 +516,34 @@ Result CreateCubeMapFromFile(
 
 //! @fn CreateMeshFromGeometry
 //!
+//! All buffers are copied in a single submission.
 //!
 Result CreateMeshFromGeometry(
     grfx::Queue*    pQueue,
     const Geometry* pGeometry,
     grfx::Mesh**    ppMesh);
 
+//! @fn CreateMeshFromGeometry
+//!
+//! Records the copies into pUploadQueue and returns without waiting for
+//! them. Flush pUploadQueue before submitting work that uses the mesh.
+//!
+Result CreateMeshFromGeometry(
+    grfx::UploadQueue* pUploadQueue,
+    const Geometry*    pGeometry,
+    grfx::Mesh**       ppMesh);
+
+//! @fn CreateMeshFromMeshCache
+//!
+//! Uploads the buffers straight from the cache file, which must stay open
+//! until pUploadQueue is flushed. See the upload queue overload of
+//! CreateMeshFromGeometry().
+//!
+Result CreateMeshFromMeshCache(
+    grfx::UploadQueue*   pUploadQueue,
+    const MeshCacheFile* pMeshCache,
+    grfx::Mesh**         ppMesh);
+
 //! @fn CreateMeshFromTriMesh
 //!
 //!
@@ -429,12 +562,18 @@ Result CreateMeshFromWireMesh(
 
 //! @fn CreateModelFromFile
 //!
+//! With useMeshCache, the geometry built from the OBJ file is cached in
+//! the mesh_cache folder of fs::GetDefaultOutputDirectory(), see
+//! MeshCacheFile. Later loads of the same file with the same options map
+//! the cache and upload it without parsing the OBJ file. The cache is
+//! opt-in since it writes to the output directory.
 //!
 Result CreateMeshFromFile(
     grfx::Queue*                 pQueue,
     const std::filesystem::path& path,
     grfx::Mesh**                 ppMesh,
-    const TriMeshOptions&        options = TriMeshOptions());
+    const TriMeshOptions&        options      = TriMeshOptions(),
+    bool                         useMeshCache = false);
 
 // -------------------------------------------------------------------------------------------------
 
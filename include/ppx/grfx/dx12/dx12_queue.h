@@ -35,6 +35,8 @@ public:
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) override;
 
+    virtual void DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores) override;
+
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const override;
 
 protected:
@@ -36,6 +36,7 @@ public:
 
     virtual Result Wait(uint64_t timeout = UINT64_MAX) override;
     virtual Result Reset() override;
+    virtual Result SignalOnHost() override;
 
 protected:
     virtual Result CreateApiObjects(const grfx::FenceCreateInfo* pCreateInfo) override;
@@ -61,6 +62,8 @@ public:
     UINT64 GetNextSignalValue();
     UINT64 GetWaitForValue() const;
 
+    virtual Result SignalOnHost() override;
+
 protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
@@ -55,7 +55,7 @@ struct BufferToBufferCopyInfo
 
     struct
     {
-        uint32_t offset = 0;
+        uint64_t offset = 0;
     } dstBuffer;
 };
 
@@ -170,11 +170,15 @@ struct RenderPassBeginInfo
     // The value of RTVClearCount cannot be less than the number
     // of RTVs in pRenderPass.
     //
+    // With RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the only
+    // command allowed in the render pass is ExecuteCommands.
+    //
     const grfx::RenderPass*      pRenderPass                            = nullptr;
     grfx::Rect                   renderArea                             = {};
     uint32_t                     RTVClearCount                          = 0;
     grfx::RenderTargetClearValue RTVClearValues[PPX_MAX_RENDER_TARGETS] = {0.0f, 0.0f, 0.0f, 0.0f};
     grfx::DepthStencilClearValue DSVClearValue                          = {1.0f, 0xFF};
+    grfx::RenderPassContents     contents                               = grfx::RENDER_PASS_CONTENTS_INLINE;
 };
 
 // RenderingInfo is used to start dynamic render passes.
@@ -240,11 +244,16 @@ namespace internal {
 //!
 //! Vulkan does not use 'samplerDescriptorCount' or 'samplerDescriptorCount'.
 //!
+//! Secondary command buffers are only supported on Vulkan. D3D12 bundles
+//! must use the descriptor heaps of the command list that executes them,
+//! which doesn't fit the per command buffer heaps described above.
+//!
 struct CommandBufferCreateInfo
 {
     const grfx::CommandPool* pPool                   = nullptr;
     uint32_t                 resourceDescriptorCount = PPX_DEFAULT_RESOURCE_DESCRIPTOR_COUNT;
     uint32_t                 samplerDescriptorCount  = PPX_DEFAULT_SAMPLE_DESCRIPTOR_COUNT;
+    grfx::CommandBufferLevel level                   = grfx::COMMAND_BUFFER_LEVEL_PRIMARY;
 };
 
 } // namespace internal
@@ -260,10 +269,28 @@ public:
     virtual ~CommandBuffer() {}
 
     grfx::CommandType GetCommandType() const { return mCreateInfo.pPool->GetCommandType(); }
+    bool              IsSecondary() const { return mCreateInfo.level == grfx::COMMAND_BUFFER_LEVEL_SECONDARY; }
 
     virtual Result Begin() = 0;
     virtual Result End()   = 0;
 
+    //! @fn BeginSecondary
+    //!
+    //! Begins a secondary command buffer that continues \b pRenderPass,
+    //! the primary must begin \b pRenderPass with
+    //! RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS before executing it.
+    //! Use a null \b pRenderPass for commands outside of a render pass.
+    //!
+    //! Secondary command buffers don't inherit state from the primary:
+    //! pipelines, descriptor sets, viewports and scissors must be set
+    //! again.
+    //!
+    Result BeginSecondary(const grfx::RenderPass* pRenderPass);
+
+    //! Executes secondary command buffers in order. Inside a render pass
+    //! it must have been begun with RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+    void ExecuteCommands(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers);
+
     void BeginRenderPass(const grfx::RenderPassBeginInfo* pBeginInfo);
     void EndRenderPass();
 
@@ -320,6 +347,22 @@ public:
         const grfx::Queue*  pSrcQueue = nullptr,
         const grfx::Queue*  pDstQueue = nullptr) = 0;
 
+    //! @fn ImageMemoryBarrier
+    //!
+    //! Orders accesses to a resource in \b state before the barrier with
+    //! accesses in the same state after it, e.g. two dispatches writing
+    //! the same storage image or a resource taking over aliased memory.
+    //! TransitionImageLayout() and BufferResourceBarrier() record nothing
+    //! if the before and after states match.
+    //!
+    virtual void ImageMemoryBarrier(
+        const grfx::Image*  pImage,
+        grfx::ResourceState state) = 0;
+
+    virtual void BufferMemoryBarrier(
+        const grfx::Buffer* pBuffer,
+        grfx::ResourceState state) = 0;
+
     virtual void SetViewports(
         uint32_t              viewportCount,
         const grfx::Viewport* pViewports) = 0;
@@ -519,11 +562,14 @@ public:
     // ---------------------------------------------------------------------------------------------
     // Convenience functions
     // ---------------------------------------------------------------------------------------------
-    void BeginRenderPass(const grfx::RenderPass* pRenderPass);
+    void BeginRenderPass(
+        const grfx::RenderPass*  pRenderPass,
+        grfx::RenderPassContents contents = grfx::RENDER_PASS_CONTENTS_INLINE);
 
     void BeginRenderPass(
         const grfx::DrawPass*           pDrawPass,
-        const grfx::DrawPassClearFlags& clearFlags = grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_ALL);
+        const grfx::DrawPassClearFlags& clearFlags = grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_ALL,
+        grfx::RenderPassContents        contents   = grfx::RENDER_PASS_CONTENTS_INLINE);
 
     virtual void TransitionImageLayout(
         const grfx::Texture* pTexture,
@@ -589,6 +635,9 @@ private:
     virtual void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo) = 0;
     virtual void EndRenderingImpl()                                            = 0;
 
+    virtual Result BeginSecondaryImpl(const grfx::RenderPass* pRenderPass)                                              = 0;
+    virtual void   ExecuteCommandsImpl(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers) = 0;
+
     virtual void PushDescriptorImpl(
         grfx::CommandType              pipelineBindPoint,
         const grfx::PipelineInterface* pInterface,
@@ -603,8 +652,9 @@ private:
 
     bool HasActiveRenderPass() const;
 
-    const grfx::RenderPass* mCurrentRenderPass = nullptr;
-    bool                    mDynamicRenderPassActive = false;
+    const grfx::RenderPass*  mCurrentRenderPass         = nullptr;
+    grfx::RenderPassContents mCurrentRenderPassContents = grfx::RENDER_PASS_CONTENTS_INLINE;
+    bool                     mDynamicRenderPassActive   = false;
 };
 
 } // namespace grfx
@@ -16,6 +16,7 @@
 #define ppx_grfx_config_h
 
 #include "ppx/config.h"
+#include "ppx/slot_map.h"
 #include "ppx/grfx/grfx_constants.h"
 #include "ppx/grfx/grfx_enums.h"
 #include "ppx/grfx/grfx_format.h"
@@ -30,20 +31,24 @@ class CommandBuffer;
 class CommandPool;
 class ComputePipeline;
 class DescriptorPool;
+class DescriptorSetAllocator;
 class DescriptorSet;
 class DescriptorSet;
 class DescriptorSetLayout;
 class Device;
 class DrawPass;
 class Fence;
+class FrameCapture;
 class ShadingRatePattern;
 class FullscreenQuad;
 class Gpu;
 class GraphicsPipeline;
 class Image;
+class ImageStreamer;
 class ImageView;
 class Instance;
 class Mesh;
+class ParallelCommandRecorder;
 class PipelineInterface;
 class Queue;
 class Query;
@@ -53,10 +58,12 @@ class Semaphore;
 class ShaderModule;
 class ShaderProgram;
 class Surface;
+class StagingRing;
 class Swapchain;
 class TextDraw;
 class Texture;
 class TextureFont;
+class UploadQueue;
 
 class DepthStencilView;
 class RenderTargetView;
@@ -74,36 +81,42 @@ class ImageResourceView;
 
 // -------------------------------------------------------------------------------------------------
 
-using BufferPtr              = ObjPtr<Buffer>;
-using CommandBufferPtr       = ObjPtr<CommandBuffer>;
-using CommandPoolPtr         = ObjPtr<CommandPool>;
-using ComputePipelinePtr     = ObjPtr<ComputePipeline>;
-using DescriptorPoolPtr      = ObjPtr<DescriptorPool>;
-using DescriptorSetPtr       = ObjPtr<DescriptorSet>;
-using DescriptorSetLayoutPtr = ObjPtr<DescriptorSetLayout>;
-using DevicePtr              = ObjPtr<Device>;
-using DrawPassPtr            = ObjPtr<DrawPass>;
-using FencePtr               = ObjPtr<Fence>;
-using ShadingRatePatternPtr  = ObjPtr<ShadingRatePattern>;
-using FullscreenQuadPtr      = ObjPtr<FullscreenQuad>;
-using GraphicsPipelinePtr    = ObjPtr<GraphicsPipeline>;
-using GpuPtr                 = ObjPtr<Gpu>;
-using ImagePtr               = ObjPtr<Image>;
-using InstancePtr            = ObjPtr<Instance>;
-using MeshPtr                = ObjPtr<Mesh>;
-using PipelineInterfacePtr   = ObjPtr<PipelineInterface>;
-using QueuePtr               = ObjPtr<Queue>;
-using QueryPtr               = ObjPtr<Query>;
-using RenderPassPtr          = ObjPtr<RenderPass>;
-using SamplerPtr             = ObjPtr<Sampler>;
-using SemaphorePtr           = ObjPtr<Semaphore>;
-using ShaderModulePtr        = ObjPtr<ShaderModule>;
-using ShaderProgramPtr       = ObjPtr<ShaderProgram>;
-using SurfacePtr             = ObjPtr<Surface>;
-using SwapchainPtr           = ObjPtr<Swapchain>;
-using TextDrawPtr            = ObjPtr<TextDraw>;
-using TexturePtr             = ObjPtr<Texture>;
-using TextureFontPtr         = ObjPtr<TextureFont>;
+using BufferPtr                  = ObjPtr<Buffer>;
+using CommandBufferPtr           = ObjPtr<CommandBuffer>;
+using CommandPoolPtr             = ObjPtr<CommandPool>;
+using ComputePipelinePtr         = ObjPtr<ComputePipeline>;
+using DescriptorPoolPtr          = ObjPtr<DescriptorPool>;
+using DescriptorSetAllocatorPtr  = ObjPtr<DescriptorSetAllocator>;
+using DescriptorSetPtr           = ObjPtr<DescriptorSet>;
+using DescriptorSetLayoutPtr     = ObjPtr<DescriptorSetLayout>;
+using DevicePtr                  = ObjPtr<Device>;
+using DrawPassPtr                = ObjPtr<DrawPass>;
+using FencePtr                   = ObjPtr<Fence>;
+using FrameCapturePtr            = ObjPtr<FrameCapture>;
+using ShadingRatePatternPtr      = ObjPtr<ShadingRatePattern>;
+using FullscreenQuadPtr          = ObjPtr<FullscreenQuad>;
+using GraphicsPipelinePtr        = ObjPtr<GraphicsPipeline>;
+using GpuPtr                     = ObjPtr<Gpu>;
+using ImagePtr                   = ObjPtr<Image>;
+using ImageStreamerPtr           = ObjPtr<ImageStreamer>;
+using InstancePtr                = ObjPtr<Instance>;
+using MeshPtr                    = ObjPtr<Mesh>;
+using ParallelCommandRecorderPtr = ObjPtr<ParallelCommandRecorder>;
+using PipelineInterfacePtr       = ObjPtr<PipelineInterface>;
+using QueuePtr                   = ObjPtr<Queue>;
+using QueryPtr                   = ObjPtr<Query>;
+using RenderPassPtr              = ObjPtr<RenderPass>;
+using SamplerPtr                 = ObjPtr<Sampler>;
+using SemaphorePtr               = ObjPtr<Semaphore>;
+using ShaderModulePtr            = ObjPtr<ShaderModule>;
+using ShaderProgramPtr           = ObjPtr<ShaderProgram>;
+using StagingRingPtr             = ObjPtr<StagingRing>;
+using SurfacePtr                 = ObjPtr<Surface>;
+using SwapchainPtr               = ObjPtr<Swapchain>;
+using TextDrawPtr                = ObjPtr<TextDraw>;
+using TexturePtr                 = ObjPtr<Texture>;
+using TextureFontPtr             = ObjPtr<TextureFont>;
+using UploadQueuePtr             = ObjPtr<UploadQueue>;
 
 using DepthStencilViewPtr = ObjPtr<DepthStencilView>;
 using RenderTargetViewPtr = ObjPtr<RenderTargetView>;
@@ -309,6 +322,10 @@ public:
         return ptr;
     }
 
+    // Slot in the device's object registry, 0 if the object wasn't created
+    // by a device. Handles of destroyed objects never match a live object.
+    ppx::SlotHandle GetRegistryHandle() const { return mRegistryHandle; }
+
 private:
     void SetParent(grfx::Device* pDevice)
     {
@@ -318,6 +335,7 @@ private:
 
 private:
     grfx::DevicePtr mDevice;
+    ppx::SlotHandle mRegistryHandle = 0; // Slot in the device's object registry
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -0,0 +1,178 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_descriptor_allocator_h
+#define ppx_grfx_descriptor_allocator_h
+
+#include "ppx/grfx/grfx_descriptor.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct DescriptorSetAllocatorCreateInfo
+//!
+//! frameCount
+//!   - number of frames in flight, each frame allocates from its own pools
+//!     so a frame never rewrites sets the GPU may still be reading
+//!
+//! setsPerPool
+//!   - number of sets of a layout each pool holds, a frame creates more
+//!     pools when it runs out. Clamped to PPX_MAX_SETS_PER_POOL.
+//!
+struct DescriptorSetAllocatorCreateInfo
+{
+    uint32_t frameCount  = 2;
+    uint32_t setsPerPool = 64;
+};
+
+//! @struct DescriptorSetAllocatorStats
+//!
+//! requestCount
+//!   - number of Allocate() calls
+//!
+//! cacheHitCount
+//!   - requests served by a set already written with the same descriptors,
+//!     these skip UpdateDescriptors()
+//!
+//! updateCount
+//!   - requests that wrote their descriptors, with one UpdateDescriptors()
+//!     call each
+//!
+//! allocationCount
+//!   - sets allocated from pools, the other updates rewrite stale sets
+//!
+//! poolCount
+//!   - pools created
+//!
+//! poolResetCount
+//!   - frames reset by BeginFrame()
+//!
+struct DescriptorSetAllocatorStats
+{
+    uint64_t requestCount    = 0;
+    uint64_t cacheHitCount   = 0;
+    uint64_t updateCount     = 0;
+    uint64_t allocationCount = 0;
+    uint64_t poolCount       = 0;
+    uint64_t poolResetCount  = 0;
+};
+
+//! @class DescriptorSetAllocator
+//!
+//! Hands out descriptor sets for transient use within a frame, instead of
+//! allocating and freeing them one at a time.
+//!
+//! Each frame in flight owns a linear list of pools per layout, sets are
+//! never freed back to them. BeginFrame() releases every set the frame
+//! handed out the last time it was used as a block.
+//!
+//! Released sets keep their descriptors. A request whose layout and
+//! writes match a set the frame wrote before gets that set back without
+//! an update, so sets that are the same every frame are only written once
+//! per frame in flight. To keep those sets cached, a miss only rewrites a
+//! stale set, one the frame didn't hand out the last time it was used
+//! either, and allocates a new set if there's none.
+//!
+//! Cached sets are matched by the registry handles of the resources they
+//! reference. A resource created after another one was destroyed never
+//! gets its handle, so sets written with destroyed resources are never
+//! handed out again, they're rewritten once they go stale. Resources must
+//! be created by the allocator's device. Layouts must outlive the
+//! allocator.
+//!
+//! Allocate() and BeginFrame() can be called from multiple threads.
+//!
+class DescriptorSetAllocator
+    : public grfx::DeviceObject<grfx::DescriptorSetAllocatorCreateInfo>
+{
+public:
+    DescriptorSetAllocator() {}
+    virtual ~DescriptorSetAllocator() {}
+
+    //! Starts using the pools of frameIndex % frameCount and releases the
+    //! sets they handed out. The GPU must be done with the frame that last
+    //! used them.
+    void BeginFrame(uint32_t frameIndex);
+
+    //! Returns a set of pLayout with pWrites written to it. The set belongs
+    //! to the current frame: it's valid until the frame's next BeginFrame()
+    //! and must not be updated by the caller.
+    //!
+    //! A reused set keeps the descriptors it had for bindings pWrites
+    //! doesn't cover, so pWrites should cover every binding the shaders
+    //! read.
+    Result Allocate(
+        const grfx::DescriptorSetLayout* pLayout,
+        uint32_t                         writeCount,
+        const grfx::WriteDescriptor*     pWrites,
+        grfx::DescriptorSet**            ppSet);
+
+    //! Forgets the descriptors of every set, the sets stay allocated.
+    void ClearCache();
+
+    DescriptorSetAllocatorStats GetStats() const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::DescriptorSetAllocatorCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+    //! Pools and sets are created through these, overridden by tests to
+    //! run without a device.
+    virtual Result CreatePool(const grfx::DescriptorPoolCreateInfo* pCreateInfo, grfx::DescriptorPool** ppPool);
+    virtual void   DestroyPool(grfx::DescriptorPool* pPool);
+    virtual Result AllocateSet(grfx::DescriptorPool* pPool, const grfx::DescriptorSetLayout* pLayout, grfx::DescriptorSet** ppSet);
+    virtual void   FreeSet(grfx::DescriptorSet* pSet);
+
+private:
+    struct Entry
+    {
+        grfx::DescriptorSetPtr set;
+        uint64_t               hash  = 0;
+        uint64_t               epoch = 0; // Epoch of the frame the set was last handed out in
+        std::vector<uint64_t>  key;       // Writes the set holds, empty if unknown
+    };
+
+    struct LayoutPools
+    {
+        grfx::DescriptorPoolCreateInfo         poolCreateInfo;
+        std::vector<grfx::DescriptorPoolPtr>   pools;
+        uint32_t                               lastPoolSetCount = 0;
+        std::vector<Entry>                     entries;
+        std::unordered_map<uint64_t, uint32_t> cache;      // Hash of the writes to entry index
+        uint32_t                               cursor = 0; // First entry that may be stale this epoch
+    };
+
+    struct Frame
+    {
+        uint64_t                                                          epoch = 1;
+        std::unordered_map<const grfx::DescriptorSetLayout*, LayoutPools> layouts;
+    };
+
+    Result AllocateEntry(const grfx::DescriptorSetLayout* pLayout, LayoutPools& layoutPools, uint32_t* pIndex);
+
+private:
+    uint32_t                    mSetsPerPool = 0;
+    std::vector<Frame>          mFrames;
+    uint32_t                    mFrameIndex = 0;
+    DescriptorSetAllocatorStats mStats      = {};
+    mutable std::mutex          mMutex;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_descriptor_allocator_h
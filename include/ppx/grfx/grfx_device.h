@@ -19,26 +19,45 @@
 #include "ppx/grfx/grfx_buffer.h"
 #include "ppx/grfx/grfx_command.h"
 #include "ppx/grfx/grfx_descriptor.h"
+#include "ppx/grfx/grfx_descriptor_allocator.h"
 #include "ppx/grfx/grfx_draw_pass.h"
+#include "ppx/grfx/grfx_frame_capture.h"
 #include "ppx/grfx/grfx_fullscreen_quad.h"
 #include "ppx/grfx/grfx_image.h"
+#include "ppx/grfx/grfx_image_streamer.h"
 #include "ppx/grfx/grfx_mesh.h"
+#include "ppx/grfx/grfx_parallel_command_recorder.h"
 #include "ppx/grfx/grfx_pipeline.h"
 #include "ppx/grfx/grfx_queue.h"
 #include "ppx/grfx/grfx_query.h"
 #include "ppx/grfx/grfx_render_pass.h"
 #include "ppx/grfx/grfx_shader.h"
 #include "ppx/grfx/grfx_shading_rate.h"
+#include "ppx/grfx/grfx_staging_ring.h"
 #include "ppx/grfx/grfx_swapchain.h"
 #include "ppx/grfx/grfx_sync.h"
 #include "ppx/grfx/grfx_text_draw.h"
 #include "ppx/grfx/grfx_texture.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
 
 namespace ppx {
 namespace grfx {
 
 //! @struct DeviceCreateInfo
 //!
+//! sharePipelines
+//!   - compute and graphics pipelines created with identical create infos
+//!     are the same object, the pipeline is destroyed once every creator
+//!     has destroyed it
+//!
+//! pipelineCachePath
+//!   - VK: the pipeline cache is loaded from this file when the device is
+//!     created and saved back to it when the device is destroyed, an empty
+//!     path disables persistence
 //!
 struct DeviceCreateInfo
 {
@@ -49,6 +68,8 @@ struct DeviceCreateInfo
     std::vector<std::string> vulkanExtensions       = {};      // [OPTIONAL] Additional device extensions
     const void*              pVulkanDeviceFeatures  = nullptr; // [OPTIONAL] Pointer to custom VkPhysicalDeviceFeatures
     ShadingRateMode          supportShadingRateMode = SHADING_RATE_NONE;
+    bool                     sharePipelines         = true;
+    std::filesystem::path    pipelineCachePath      = {};
 #if defined(PPX_BUILD_XR)
     XrComponent* pXrComponent = nullptr;
 #endif
@@ -73,6 +94,8 @@ public:
     const char*    GetDeviceName() const;
     grfx::VendorId GetDeviceVendorId() const;
 
+    grfx::PipelineCacheStats GetPipelineCacheStats() const { return mPipelineCacheStats; }
+
     Result CreateBuffer(const grfx::BufferCreateInfo* pCreateInfo, grfx::Buffer** ppBuffer);
     void   DestroyBuffer(const grfx::Buffer* pBuffer);
 
@@ -88,6 +111,9 @@ public:
     Result CreateDescriptorPool(const grfx::DescriptorPoolCreateInfo* pCreateInfo, grfx::DescriptorPool** ppDescriptorPool);
     void   DestroyDescriptorPool(const grfx::DescriptorPool* pDescriptorPool);
 
+    Result CreateDescriptorSetAllocator(const grfx::DescriptorSetAllocatorCreateInfo* pCreateInfo, grfx::DescriptorSetAllocator** ppDescriptorSetAllocator);
+    void   DestroyDescriptorSetAllocator(const grfx::DescriptorSetAllocator* pDescriptorSetAllocator);
+
     Result CreateDescriptorSetLayout(const grfx::DescriptorSetLayoutCreateInfo* pCreateInfo, grfx::DescriptorSetLayout** ppDescriptorSetLayout);
     void   DestroyDescriptorSetLayout(const grfx::DescriptorSetLayout* pDescriptorSetLayout);
 
@@ -102,6 +128,9 @@ public:
     Result CreateShadingRatePattern(const grfx::ShadingRatePatternCreateInfo* pCreateInfo, grfx::ShadingRatePattern** ppShadingRatePattern);
     void   DestroyShadingRatePattern(const grfx::ShadingRatePattern* pShadingRatePattern);
 
+    Result CreateFrameCapture(const grfx::FrameCaptureCreateInfo* pCreateInfo, grfx::FrameCapture** ppFrameCapture);
+    void   DestroyFrameCapture(const grfx::FrameCapture* pFrameCapture);
+
     Result CreateFullscreenQuad(const grfx::FullscreenQuadCreateInfo* pCreateInfo, grfx::FullscreenQuad** ppFullscreenQuad);
     void   DestroyFullscreenQuad(const grfx::FullscreenQuad* pFullscreenQuad);
 
@@ -111,10 +140,17 @@ public:
 
     Result CreateImage(const grfx::ImageCreateInfo* pCreateInfo, grfx::Image** ppImage);
     void   DestroyImage(const grfx::Image* pImage);
+    bool   HasImage(ppx::SlotHandle handle) const;
+
+    Result CreateImageStreamer(const grfx::ImageStreamerCreateInfo* pCreateInfo, grfx::ImageStreamer** ppImageStreamer);
+    void   DestroyImageStreamer(const grfx::ImageStreamer* pImageStreamer);
 
     Result CreateMesh(const grfx::MeshCreateInfo* pCreateInfo, grfx::Mesh** ppMesh);
     void   DestroyMesh(const grfx::Mesh* pMesh);
 
+    Result CreateParallelCommandRecorder(const grfx::ParallelCommandRecorderCreateInfo* pCreateInfo, grfx::ParallelCommandRecorder** ppParallelCommandRecorder);
+    void   DestroyParallelCommandRecorder(const grfx::ParallelCommandRecorder* pParallelCommandRecorder);
+
     Result CreatePipelineInterface(const grfx::PipelineInterfaceCreateInfo* pCreateInfo, grfx::PipelineInterface** ppPipelineInterface);
     void   DestroyPipelineInterface(const grfx::PipelineInterface* pPipelineInterface);
 
@@ -141,6 +177,9 @@ public:
     Result CreateShaderModule(const grfx::ShaderModuleCreateInfo* pCreateInfo, grfx::ShaderModule** ppShaderModule);
     void   DestroyShaderModule(const grfx::ShaderModule* pShaderModule);
 
+    Result CreateStagingRing(const grfx::StagingRingCreateInfo* pCreateInfo, grfx::StagingRing** ppStagingRing);
+    void   DestroyStagingRing(const grfx::StagingRing* pStagingRing);
+
     Result CreateStorageImageView(const grfx::StorageImageViewCreateInfo* pCreateInfo, grfx::StorageImageView** ppStorageImageView);
     void   DestroyStorageImageView(const grfx::StorageImageView* pStorageImageView);
 
@@ -156,6 +195,9 @@ public:
     Result CreateTextureFont(const grfx::TextureFontCreateInfo* pCreateInfo, grfx::TextureFont** ppTextureFont);
     void   DestroyTextureFont(const grfx::TextureFont* pTextureFont);
 
+    Result CreateUploadQueue(const grfx::UploadQueueCreateInfo* pCreateInfo, grfx::UploadQueue** ppUploadQueue);
+    void   DestroyUploadQueue(const grfx::UploadQueue* pUploadQueue);
+
     // See comment section for grfx::internal::CommandBufferCreateInfo for
     // details about 'resourceDescriptorCount' and 'samplerDescriptorCount'.
     //
@@ -163,7 +205,8 @@ public:
         const grfx::CommandPool* pPool,
         grfx::CommandBuffer**    ppCommandBuffer,
         uint32_t                 resourceDescriptorCount = PPX_DEFAULT_RESOURCE_DESCRIPTOR_COUNT,
-        uint32_t                 samplerDescriptorCount  = PPX_DEFAULT_SAMPLE_DESCRIPTOR_COUNT);
+        uint32_t                 samplerDescriptorCount  = PPX_DEFAULT_SAMPLE_DESCRIPTOR_COUNT,
+        grfx::CommandBufferLevel level                   = grfx::COMMAND_BUFFER_LEVEL_PRIMARY);
     void FreeCommandBuffer(const grfx::CommandBuffer* pCommandBuffer);
 
     Result AllocateDescriptorSet(grfx::DescriptorPool* pPool, const grfx::DescriptorSetLayout* pLayout, grfx::DescriptorSet** ppSet);
@@ -183,6 +226,13 @@ public:
 
     grfx::QueuePtr GetAnyAvailableQueue() const;
 
+    //! Returns the device's default staging ring, it's created on first use
+    //! and shared by the grfx_util helpers and upload queues.
+    Result GetStagingRing(grfx::StagingRing** ppStagingRing);
+
+    //! Stats of the default staging ring, all zero until it's created.
+    grfx::StagingRingStats GetStagingRingStats();
+
     const grfx::ShadingRateCapabilities& GetShadingRateCapabilities() const { return mShadingRateCapabilities; }
 
     virtual Result WaitIdle() = 0;
@@ -222,12 +272,18 @@ protected:
     virtual Result AllocateObject(grfx::StorageImageView** ppObject)    = 0;
     virtual Result AllocateObject(grfx::Swapchain** ppObject)           = 0;
 
+    virtual Result AllocateObject(grfx::DescriptorSetAllocator** ppObject);
     virtual Result AllocateObject(grfx::DrawPass** ppObject);
+    virtual Result AllocateObject(grfx::FrameCapture** ppObject);
     virtual Result AllocateObject(grfx::FullscreenQuad** ppObject);
+    virtual Result AllocateObject(grfx::ImageStreamer** ppObject);
     virtual Result AllocateObject(grfx::Mesh** ppObject);
+    virtual Result AllocateObject(grfx::ParallelCommandRecorder** ppObject);
+    virtual Result AllocateObject(grfx::StagingRing** ppObject);
     virtual Result AllocateObject(grfx::TextDraw** ppObject);
     virtual Result AllocateObject(grfx::Texture** ppObject);
     virtual Result AllocateObject(grfx::TextureFont** ppObject);
+    virtual Result AllocateObject(grfx::UploadQueue** ppObject);
 
     template <
         typename ObjectT,
@@ -235,53 +291,87 @@ protected:
         typename ContainerT = std::vector<ObjPtr<ObjectT>>>
     Result CreateObject(const CreateInfoT* pCreateInfo, ContainerT& container, ObjectT** ppObject);
 
-    template <
-        typename ObjectT,
-        typename ContainerT = std::vector<ObjPtr<ObjectT>>>
-    void DestroyObject(ContainerT& container, const ObjectT* pObject);
+    template <typename ObjectT>
+    void DestroyObject(ppx::SlotMap<ObjPtr<ObjectT>>& container, const ObjectT* pObject);
 
     template <typename ObjectT>
     void DestroyAllObjects(std::vector<ObjPtr<ObjectT>>& container);
 
+    template <typename ObjectT>
+    void DestroyAllObjects(ppx::SlotMap<ObjPtr<ObjectT>>& container);
+
+    template <typename ObjectT>
+    void StoreObject(std::vector<ObjPtr<ObjectT>>& container, ObjectT* pObject);
+
+    template <typename ObjectT>
+    void StoreObject(ppx::SlotMap<ObjPtr<ObjectT>>& container, ObjectT* pObject);
+
+    template <typename ObjectT, typename CreateInfoT>
+    Result CreateSharedPipeline(const CreateInfoT* pCreateInfo, ppx::SlotMap<ObjPtr<ObjectT>>& container, ObjectT** ppObject);
+
+    template <typename ObjectT>
+    void DestroySharedPipeline(ppx::SlotMap<ObjPtr<ObjectT>>& container, const ObjectT* pObject);
+
+    std::string GetPipelineKey(const grfx::ComputePipelineCreateInfo* pCreateInfo) const;
+    std::string GetPipelineKey(const grfx::GraphicsPipelineCreateInfo* pCreateInfo) const;
+
     Result CreateGraphicsQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
     Result CreateComputeQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
     Result CreateTransferQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
 
 protected:
-    grfx::InstancePtr                         mInstance;
-    std::vector<grfx::BufferPtr>              mBuffers;
-    std::vector<grfx::CommandBufferPtr>       mCommandBuffers;
-    std::vector<grfx::CommandPoolPtr>         mCommandPools;
-    std::vector<grfx::ComputePipelinePtr>     mComputePipelines;
-    std::vector<grfx::DepthStencilViewPtr>    mDepthStencilViews;
-    std::vector<grfx::DescriptorPoolPtr>      mDescriptorPools;
-    std::vector<grfx::DescriptorSetPtr>       mDescriptorSets;
-    std::vector<grfx::DescriptorSetLayoutPtr> mDescriptorSetLayouts;
-    std::vector<grfx::DrawPassPtr>            mDrawPasses;
-    std::vector<grfx::FencePtr>               mFences;
-    std::vector<grfx::ShadingRatePatternPtr>  mShadingRatePatterns;
-    std::vector<grfx::FullscreenQuadPtr>      mFullscreenQuads;
-    std::vector<grfx::GraphicsPipelinePtr>    mGraphicsPipelines;
-    std::vector<grfx::ImagePtr>               mImages;
-    std::vector<grfx::MeshPtr>                mMeshes;
-    std::vector<grfx::PipelineInterfacePtr>   mPipelineInterfaces;
-    std::vector<grfx::QueryPtr>               mQuerys;
-    std::vector<grfx::RenderPassPtr>          mRenderPasses;
-    std::vector<grfx::RenderTargetViewPtr>    mRenderTargetViews;
-    std::vector<grfx::SampledImageViewPtr>    mSampledImageViews;
-    std::vector<grfx::SamplerPtr>             mSamplers;
-    std::vector<grfx::SemaphorePtr>           mSemaphores;
-    std::vector<grfx::ShaderModulePtr>        mShaderModules;
-    std::vector<grfx::ShaderProgramPtr>       mShaderPrograms;
-    std::vector<grfx::StorageImageViewPtr>    mStorageImageViews;
-    std::vector<grfx::SwapchainPtr>           mSwapchains;
-    std::vector<grfx::TextDrawPtr>            mTextDraws;
-    std::vector<grfx::TexturePtr>             mTextures;
-    std::vector<grfx::TextureFontPtr>         mTextureFonts;
-    std::vector<grfx::QueuePtr>               mGraphicsQueues;
-    std::vector<grfx::QueuePtr>               mComputeQueues;
-    std::vector<grfx::QueuePtr>               mTransferQueues;
-    grfx::ShadingRateCapabilities             mShadingRateCapabilities;
+    grfx::InstancePtr                              mInstance;
+    ppx::SlotMap<grfx::BufferPtr>                  mBuffers;
+    ppx::SlotMap<grfx::CommandBufferPtr>           mCommandBuffers;
+    ppx::SlotMap<grfx::CommandPoolPtr>             mCommandPools;
+    ppx::SlotMap<grfx::ComputePipelinePtr>         mComputePipelines;
+    ppx::SlotMap<grfx::DepthStencilViewPtr>        mDepthStencilViews;
+    ppx::SlotMap<grfx::DescriptorPoolPtr>          mDescriptorPools;
+    ppx::SlotMap<grfx::DescriptorSetPtr>           mDescriptorSets;
+    ppx::SlotMap<grfx::DescriptorSetAllocatorPtr>  mDescriptorSetAllocators;
+    ppx::SlotMap<grfx::DescriptorSetLayoutPtr>     mDescriptorSetLayouts;
+    ppx::SlotMap<grfx::DrawPassPtr>                mDrawPasses;
+    ppx::SlotMap<grfx::FencePtr>                   mFences;
+    ppx::SlotMap<grfx::FrameCapturePtr>            mFrameCaptures;
+    ppx::SlotMap<grfx::ShadingRatePatternPtr>      mShadingRatePatterns;
+    ppx::SlotMap<grfx::FullscreenQuadPtr>          mFullscreenQuads;
+    ppx::SlotMap<grfx::GraphicsPipelinePtr>        mGraphicsPipelines;
+    ppx::SlotMap<grfx::ImagePtr>                   mImages;
+    ppx::SlotMap<grfx::ImageStreamerPtr>           mImageStreamers;
+    ppx::SlotMap<grfx::MeshPtr>                    mMeshes;
+    ppx::SlotMap<grfx::ParallelCommandRecorderPtr> mParallelCommandRecorders;
+    ppx::SlotMap<grfx::PipelineInterfacePtr>       mPipelineInterfaces;
+    ppx::SlotMap<grfx::QueryPtr>                   mQuerys;
+    ppx::SlotMap<grfx::RenderPassPtr>              mRenderPasses;
+    ppx::SlotMap<grfx::RenderTargetViewPtr>        mRenderTargetViews;
+    ppx::SlotMap<grfx::SampledImageViewPtr>        mSampledImageViews;
+    ppx::SlotMap<grfx::SamplerPtr>                 mSamplers;
+    ppx::SlotMap<grfx::SemaphorePtr>               mSemaphores;
+    ppx::SlotMap<grfx::ShaderModulePtr>            mShaderModules;
+    ppx::SlotMap<grfx::ShaderProgramPtr>           mShaderPrograms;
+    ppx::SlotMap<grfx::StagingRingPtr>             mStagingRings;
+    ppx::SlotMap<grfx::StorageImageViewPtr>        mStorageImageViews;
+    ppx::SlotMap<grfx::SwapchainPtr>               mSwapchains;
+    ppx::SlotMap<grfx::TextDrawPtr>                mTextDraws;
+    ppx::SlotMap<grfx::TexturePtr>                 mTextures;
+    ppx::SlotMap<grfx::TextureFontPtr>             mTextureFonts;
+    ppx::SlotMap<grfx::UploadQueuePtr>             mUploadQueues;
+    std::vector<grfx::QueuePtr>                    mGraphicsQueues;
+    std::vector<grfx::QueuePtr>                    mComputeQueues;
+    std::vector<grfx::QueuePtr>                    mTransferQueues;
+    grfx::ShadingRateCapabilities                  mShadingRateCapabilities;
+    std::mutex                                     mStagingRingMutex;
+    grfx::StagingRingPtr                           mStagingRing; // Default ring, see GetStagingRing()
+
+    struct SharedPipeline
+    {
+        const void* pPipeline = nullptr;
+        uint32_t    refCount  = 0;
+    };
+
+    std::unordered_map<std::string, SharedPipeline> mSharedPipelines;    // Keyed by serialized create info
+    std::unordered_map<const void*, std::string>    mSharedPipelineKeys; // Pipeline to serialized create info
+    grfx::PipelineCacheStats                        mPipelineCacheStats;
 };
 
 } // namespace grfx
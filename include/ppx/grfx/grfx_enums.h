@@ -184,6 +184,12 @@ enum CompareOp
     COMPARE_OP_ALWAYS           = 7,
 };
 
+enum CommandBufferLevel
+{
+    COMMAND_BUFFER_LEVEL_PRIMARY   = 0,
+    COMMAND_BUFFER_LEVEL_SECONDARY = 1,
+};
+
 enum CommandType
 {
     COMMAND_TYPE_UNDEFINED = 0,
@@ -387,6 +393,12 @@ enum QueryType
     QUERY_TYPE_TIMESTAMP           = 3,
 };
 
+enum RenderPassContents
+{
+    RENDER_PASS_CONTENTS_INLINE                    = 0,
+    RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS = 1,
+};
+
 enum ResourceState
 {
     RESOURCE_STATE_UNDEFINED = 0,
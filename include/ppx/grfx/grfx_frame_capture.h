@@ -0,0 +1,132 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_frame_capture_h
+#define ppx_grfx_frame_capture_h
+
+#include "ppx/grfx/grfx_config.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct FrameCaptureCreateInfo
+//!
+//! pQueue
+//!   - queue that the copies are submitted to, must be the queue that
+//!     rendered the captured images so the copies are ordered after it
+//!
+//! slotCount
+//!   - depth of the readback ring, each slot has its own readback buffer,
+//!     command buffer and fence. Capture() only blocks when every slot is
+//!     still being copied or written.
+//!
+struct FrameCaptureCreateInfo
+{
+    grfx::Queue* pQueue    = nullptr;
+    uint32_t     slotCount = 3;
+};
+
+//! @class FrameCapture
+//!
+//! Copies images to the CPU and writes them to disk without stalling the
+//! frame loop. Each capture is submitted with its slot's fence right after
+//! the frame's own work on the same queue. Once the fence has signaled
+//! the readback is encoded and written by a task on the default
+//! ThreadPool, the file format is picked from the extension the same way
+//! as ExportToFile().
+//!
+//! Capture(), Poll() and WaitIdle() must be called from the thread that
+//! submits to the queue.
+//!
+class FrameCapture
+    : public grfx::DeviceObject<grfx::FrameCaptureCreateInfo>
+{
+public:
+    FrameCapture() {}
+    virtual ~FrameCapture() {}
+
+    //! Records and submits a copy of mip 0, array layer 0 of pImage.
+    //! pImage must be in imageState and is returned to it. The image is
+    //! written to path once the copy has completed. Writes run
+    //! concurrently, so captures in flight must not share a path.
+    Result Capture(grfx::Image* pImage, grfx::ResourceState imageState, const std::string& path);
+
+    //! Starts writing the captures whose copies have completed. Never
+    //! blocks, call it once per frame.
+    void Poll();
+
+    //! Waits until every capture has been written.
+    Result WaitIdle();
+
+    //! Number of captures written to disk so far and number that failed
+    //! to be written.
+    uint64_t GetWrittenCount() const { return mWrittenCount; }
+    uint64_t GetFailedCount() const { return mFailedCount; }
+
+protected:
+    virtual Result CreateApiObjects(const grfx::FrameCaptureCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    enum SlotState
+    {
+        SLOT_STATE_IDLE    = 0,
+        SLOT_STATE_COPYING = 1, // Copy submitted, waiting on the fence
+        SLOT_STATE_WRITING = 2, // Being encoded and written by a worker
+    };
+
+    struct Slot
+    {
+        grfx::BufferPtr        buffer;
+        grfx::CommandBufferPtr commandBuffer;
+        grfx::FencePtr         fence;
+        void*                  pMappedAddress = nullptr;
+        uint64_t               bufferSize     = 0;
+        SlotState              state          = SLOT_STATE_IDLE;
+        grfx::Format           format         = grfx::FORMAT_UNDEFINED;
+        uint32_t               width          = 0;
+        uint32_t               height         = 0;
+        uint32_t               rowPitch       = 0;
+        std::string            path;
+    };
+
+    Result PrepareBuffer(Slot& slot, uint64_t size);
+    Result WaitSlot(Slot& slot);
+    void   StartWrite(Slot& slot);
+
+private:
+    std::vector<Slot>       mSlots;
+    uint32_t                mNextSlot = 0;
+    std::mutex              mWriteMutex; // Guards slot state while writing
+    std::condition_variable mWriteDone;
+    std::atomic<uint64_t>   mWrittenCount = 0;
+    std::atomic<uint64_t>   mFailedCount  = 0;
+};
+
+namespace internal {
+
+//! Registers FrameCapture's profiler events. Called once by
+//! Instance::Create() so no thread records them while they're registered.
+void RegisterFrameCaptureProfilerEvents();
+
+} // namespace internal
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_frame_capture_h
@@ -126,6 +126,10 @@ public:
 
     const grfx::internal::ImageResourceView* GetResourceView() const { return mResourceView.get(); }
 
+    // Registry handle of the view, see DeviceObject::GetRegistryHandle().
+    // Each kind of view has its own registry.
+    virtual ppx::SlotHandle GetViewRegistryHandle() const = 0;
+
 protected:
     void SetResourceView(std::unique_ptr<internal::ImageResourceView>&& view)
     {
@@ -206,6 +210,8 @@ public:
     DepthStencilView() {}
     virtual ~DepthStencilView() {}
 
+    ppx::SlotHandle GetViewRegistryHandle() const override { return GetRegistryHandle(); }
+
     grfx::ImagePtr          GetImage() const { return mCreateInfo.pImage; }
     grfx::Format            GetFormat() const { return mCreateInfo.format; }
     uint32_t                GetMipLevel() const { return mCreateInfo.mipLevel; }
@@ -250,6 +256,8 @@ public:
     RenderTargetView() {}
     virtual ~RenderTargetView() {}
 
+    ppx::SlotHandle GetViewRegistryHandle() const override { return GetRegistryHandle(); }
+
     grfx::ImagePtr          GetImage() const { return mCreateInfo.pImage; }
     grfx::Format            GetFormat() const { return mCreateInfo.format; }
     grfx::SampleCount       GetSampleCount() const { return mCreateInfo.sampleCount; }
@@ -291,6 +299,8 @@ public:
     SampledImageView() {}
     virtual ~SampledImageView() {}
 
+    ppx::SlotHandle GetViewRegistryHandle() const override { return GetRegistryHandle(); }
+
     grfx::ImagePtr                GetImage() const { return mCreateInfo.pImage; }
     grfx::ImageViewType           GetImageViewType() const { return mCreateInfo.imageViewType; }
     grfx::Format                  GetFormat() const { return mCreateInfo.format; }
@@ -334,6 +344,8 @@ public:
     StorageImageView() {}
     virtual ~StorageImageView() {}
 
+    ppx::SlotHandle GetViewRegistryHandle() const override { return GetRegistryHandle(); }
+
     grfx::ImagePtr      GetImage() const { return mCreateInfo.pImage; }
     grfx::ImageViewType GetImageViewType() const { return mCreateInfo.imageViewType; }
     grfx::Format        GetFormat() const { return mCreateInfo.format; }
@@ -0,0 +1,142 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_image_streamer_h
+#define ppx_grfx_image_streamer_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+#include "ppx/texture_file.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct ImageStreamerCreateInfo
+//!
+//! pUploadQueue
+//!   - upload queue the level copies are recorded into. Levels only become
+//!     resident once the batch that copied them has completed.
+//!
+//! initialBytes
+//!   - bytes uploaded by CreateImageFromFile() before it returns, smallest
+//!     levels first. At least the smallest level is always uploaded.
+//!
+//! bytesPerUpdate
+//!   - budget for each call to Update(). Levels larger than the budget are
+//!     split into bands of block rows, a level only becomes resident once
+//!     all of its rows have been uploaded.
+//!
+struct ImageStreamerCreateInfo
+{
+    grfx::UploadQueue* pUploadQueue   = nullptr;
+    uint64_t           initialBytes   = 64 * 1024;
+    uint64_t           bytesPerUpdate = 4 * 1024 * 1024;
+};
+
+//! @class ImageStreamer
+//!
+//! Creates images from DDS, KTX and KTX2 files, see ppx::TextureFile, and
+//! uploads their levels smallest first. An image is usable as soon as
+//! CreateImageFromFile() returns, as long as it's sampled through a view
+//! that starts at GetResidentMipLevel(). Larger levels are streamed in by
+//! Update() under a per call byte budget.
+//!
+//! Levels are read from the file as they're uploaded, so a memory-mapped
+//! file is only paged in as needed.
+//!
+//! All functions must be called from the thread that submits to the
+//! upload queue's queue.
+//!
+class ImageStreamer
+    : public grfx::DeviceObject<grfx::ImageStreamerCreateInfo>
+{
+public:
+    ImageStreamer() {}
+    virtual ~ImageStreamer() {}
+
+    //! Creates a 2D image with every level of the file and uploads the
+    //! smallest levels. The copies are flushed and waited on before
+    //! returning, so they're resident right away.
+    Result CreateImageFromFile(
+        const std::filesystem::path& path,
+        grfx::Image**                ppImage,
+        grfx::ImageUsageFlags        additionalUsage = grfx::ImageUsageFlags());
+
+    //! Uploads up to bytesPerUpdate bytes of pending levels, across images
+    //! smallest level first, and flushes them. Levels flushed by earlier
+    //! calls become resident once their copies have completed. Call it
+    //! once per frame before recording work that samples the images.
+    Result Update();
+
+    //! Most detailed level of pImage that can be sampled. Returns 0 if
+    //! pImage is fully resident or isn't being streamed.
+    uint32_t GetResidentMipLevel(const grfx::Image* pImage) const;
+
+    //! Stops streaming pImage and waits for its copies. Call it before
+    //! destroying an image that's still being streamed.
+    Result Remove(const grfx::Image* pImage);
+
+    //! Number of images with levels that aren't resident yet, and the bytes
+    //! left to upload.
+    uint32_t GetStreamingImageCount() const { return CountU32(mStreams); }
+    uint64_t GetPendingBytes() const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::ImageStreamerCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    struct Stream
+    {
+        grfx::ImagePtr               image;
+        std::unique_ptr<TextureFile> file;
+        uint32_t                     residentLevel = 0; // Levels >= residentLevel have been copied
+        uint32_t                     flushedLevel  = 0; // Levels >= flushedLevel are copied once flushedTicket completes
+        uint32_t                     recordedLevel = 0; // Levels >= recordedLevel are recorded
+        uint32_t                     recordedRows  = 0; // Block rows recorded of level recordedLevel - 1
+        grfx::UploadTicket           flushedTicket = 0;
+        grfx::UploadTicket           lastTicket    = 0; // Last flush, covers every recorded copy
+    };
+
+    // Records copies of up to budget bytes, but at least one block row,
+    // of the next level of stream. *pRecordedBytes receives the number of
+    // bytes recorded.
+    Result RecordNextLevel(Stream& stream, uint64_t budget, uint64_t* pRecordedBytes);
+
+    // Flushes the upload queue, pTicket receives the flush's ticket.
+    Result Flush(grfx::UploadTicket* pTicket = nullptr);
+
+    // Marks the levels whose copies have completed as resident and drops
+    // the streams of fully resident images.
+    void UpdateResidentLevels();
+
+private:
+    std::vector<Stream> mStreams;
+};
+
+namespace internal {
+
+//! Registers ImageStreamer's profiler events. Called once by
+//! Instance::Create() so no thread records them while they're registered.
+void RegisterImageStreamerProfilerEvents();
+
+} // namespace internal
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_image_streamer_h
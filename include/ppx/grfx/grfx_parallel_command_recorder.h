@@ -0,0 +1,125 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_parallel_command_recorder_h
+#define ppx_grfx_parallel_command_recorder_h
+
+#include "ppx/grfx/grfx_config.h"
+
+#include <functional>
+
+namespace ppx {
+
+class ThreadPool;
+
+namespace grfx {
+
+//! @struct ParallelCommandRecorderCreateInfo
+//!
+//! pQueue
+//!   - queue the primary command buffers are submitted to
+//!
+//! workerCount
+//!   - maximum number of secondary command buffers a Record() call splits
+//!     the work into, 0 uses the thread count of the pool plus the calling
+//!     thread
+//!
+//! frameCount
+//!   - number of frames in flight, each frame records into its own
+//!     command buffers so a frame never touches command buffers the GPU
+//!     may still be executing
+//!
+//! pThreadPool
+//!   - pool the secondary command buffers are recorded on,
+//!     ThreadPool::GetDefault() if null
+//!
+//! 'resourceDescriptorCount' and 'samplerDescriptorCount' are passed to
+//! every secondary command buffer, see grfx::internal::CommandBufferCreateInfo.
+//!
+struct ParallelCommandRecorderCreateInfo
+{
+    const grfx::Queue* pQueue                  = nullptr;
+    uint32_t           workerCount             = 0;
+    uint32_t           frameCount              = 2;
+    ppx::ThreadPool*   pThreadPool             = nullptr;
+    uint32_t           resourceDescriptorCount = PPX_DEFAULT_RESOURCE_DESCRIPTOR_COUNT;
+    uint32_t           samplerDescriptorCount  = PPX_DEFAULT_SAMPLE_DESCRIPTOR_COUNT;
+};
+
+//! Records items [begin, end) into pCommandBuffer. Called concurrently
+//! from multiple threads, once per worker with disjoint ranges.
+using ParallelRecordFn = std::function<void(grfx::CommandBuffer* pCommandBuffer, uint32_t begin, uint32_t end, uint32_t workerIndex)>;
+
+//! Splits itemCount items into rangeCount contiguous ranges whose sizes
+//! differ by at most one, and returns range rangeIndex.
+void GetParallelRecordRange(uint32_t itemCount, uint32_t rangeCount, uint32_t rangeIndex, uint32_t* pBegin, uint32_t* pEnd);
+
+//! @class ParallelCommandRecorder
+//!
+//! Records a draw list on multiple threads. Every (frame, worker) pair
+//! owns a command pool and a secondary command buffer, so workers never
+//! share a pool and never need to lock.
+//!
+//! Record() splits the items into contiguous ranges, records each range
+//! into a secondary command buffer on the thread pool and executes the
+//! secondary command buffers from the primary in range order, so the
+//! draw order is the same as recording the items serially.
+//!
+//! Secondary command buffers are only supported on Vulkan, creating a
+//! recorder on D3D12 fails with ERROR_REQUIRED_FEATURE_UNAVAILABLE.
+//!
+class ParallelCommandRecorder
+    : public grfx::DeviceObject<grfx::ParallelCommandRecorderCreateInfo>
+{
+public:
+    ParallelCommandRecorder() {}
+    virtual ~ParallelCommandRecorder() {}
+
+    uint32_t GetWorkerCount() const { return mWorkerCount; }
+
+    //! Records itemCount items with fn and executes the result from
+    //! pPrimary. If pRenderPass isn't null the secondary command buffers
+    //! continue it: pPrimary must have begun pRenderPass with
+    //! RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+    //!
+    //! The command buffers of frameIndex % frameCount are reused, the GPU
+    //! must be done with the frame that last used them.
+    Result Record(
+        uint32_t                frameIndex,
+        grfx::CommandBuffer*    pPrimary,
+        const grfx::RenderPass* pRenderPass,
+        uint32_t                itemCount,
+        const ParallelRecordFn& fn);
+
+protected:
+    virtual Result CreateApiObjects(const grfx::ParallelCommandRecorderCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    struct Worker
+    {
+        grfx::CommandPoolPtr   commandPool;
+        grfx::CommandBufferPtr commandBuffer;
+    };
+
+private:
+    ppx::ThreadPool*                 mThreadPool  = nullptr;
+    uint32_t                         mWorkerCount = 0;
+    std::vector<std::vector<Worker>> mFrames;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_parallel_command_recorder_h
@@ -28,6 +28,23 @@ struct ShaderStageInfo
 
 // -------------------------------------------------------------------------------------------------
 
+//! @struct PipelineCacheStats
+//!
+//! hitCount
+//!   - number of pipeline creations that returned an existing pipeline
+//!     with an identical create info
+//!
+//! missCount
+//!   - number of pipeline creations that created a new pipeline
+//!
+struct PipelineCacheStats
+{
+    uint64_t hitCount  = 0;
+    uint64_t missCount = 0;
+};
+
+// -------------------------------------------------------------------------------------------------
+
 //! @struct ComputePipelineCreateInfo
 //!
 //!
@@ -63,6 +63,12 @@ public:
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) = 0;
 
+    // Adds waits on the semaphores to the next Submit() instead of
+    // submitting them on their own. Used by headless swapchains at present
+    // so the semaphores are unsignaled before the application signals them
+    // again.
+    virtual void DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores) = 0;
+
     // GPU timestamp frequency counter in ticks per second
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const = 0;
 
@@ -249,7 +249,9 @@ protected:
     grfx::DepthStencilViewPtr              mDepthStencilView;
     std::vector<grfx::ImagePtr>            mRenderTargetImages;
     grfx::ImagePtr                         mDepthStencilImage;
-    bool                                   mHasLoadOpClear = false;
+    std::vector<ppx::SlotHandle>           mRenderTargetImageHandles;
+    ppx::SlotHandle                        mDepthStencilImageHandle = 0;
+    bool                                   mHasLoadOpClear          = false;
 };
 
 } // namespace grfx
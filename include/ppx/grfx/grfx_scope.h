@@ -32,6 +32,8 @@ public:
     Result AddObject(grfx::Texture* pObject);
     Result AddObject(grfx::Sampler* pObject);
     Result AddObject(grfx::SampledImageView* pObject);
+    Result AddObject(grfx::Fence* pObject);
+    Result AddObject(grfx::UploadQueue* pObject);
     Result AddObject(grfx::Queue* pParent, grfx::CommandBuffer* pObject);
 
     // Releases all objects without destroying them
@@ -45,6 +47,8 @@ private:
     std::vector<grfx::TexturePtr>                                  mTextures;
     std::vector<grfx::SamplerPtr>                                  mSamplers;
     std::vector<grfx::SampledImageViewPtr>                         mSampledImageViews;
+    std::vector<grfx::FencePtr>                                    mFences;
+    std::vector<grfx::UploadQueuePtr>                              mUploadQueues;
     std::vector<std::pair<grfx::QueuePtr, grfx::CommandBufferPtr>> mTransientCommandBuffers;
 };
 
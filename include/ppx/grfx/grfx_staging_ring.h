@@ -0,0 +1,174 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_staging_ring_h
+#define ppx_grfx_staging_ring_h
+
+#include "ppx/grfx/grfx_config.h"
+
+#include <deque>
+#include <mutex>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct StagingRingCreateInfo
+//!
+//! initialSize
+//!   - size of the first ring buffer
+//!
+//! maxSize
+//!   - the ring doubles in size when it runs out of space until it
+//!     reaches maxSize, after that allocations wait on the oldest
+//!     fence retired allocation instead
+//!
+struct StagingRingCreateInfo
+{
+    uint64_t initialSize = 16 * 1024 * 1024;
+    uint64_t maxSize     = 256 * 1024 * 1024;
+};
+
+//! @struct StagingAllocation
+//!
+//! pMappedAddress stays valid until the allocation is released.
+//!
+struct StagingAllocation
+{
+    grfx::Buffer* pBuffer        = nullptr;
+    uint64_t      offset         = 0;
+    uint64_t      size           = 0;
+    void*         pMappedAddress = nullptr;
+    uint64_t      id             = 0;
+};
+
+//! @struct StagingRingStats
+//!
+//! bytesStaged
+//!   - total bytes handed out, including alignment padding
+//!
+//! stallCount / stallMillis
+//!   - number of allocations that had to wait on the GPU and the total
+//!     time spent waiting
+//!
+//! growCount
+//!   - number of times a bigger ring buffer was created
+//!
+struct StagingRingStats
+{
+    uint64_t bytesStaged     = 0;
+    uint64_t allocationCount = 0;
+    uint64_t stallCount      = 0;
+    double   stallMillis     = 0;
+    uint64_t growCount       = 0;
+    uint64_t capacity        = 0;
+    uint64_t bytesInUse      = 0;
+    uint64_t peakBytesInUse  = 0;
+};
+
+//! @class StagingRing
+//!
+//! Persistently mapped MEMORY_USAGE_CPU_TO_GPU ring buffer that hands out
+//! staging sub-allocations. Every allocation must be released with one of:
+//!   - Free() once the owner knows the GPU is done with it
+//!   - Retire(fence), released once the fence is seen signaled. Owners
+//!     that recycle fences must Free() the allocation before resetting
+//!     the fence. Only fence retired allocations can be waited on once
+//!     the ring reached maxSize.
+//!   - Retire(frameNumber), released once ReleaseFrames() is called with
+//!     a frame number at least as large
+//!
+//! Space is reclaimed in allocation order, an allocation that's never
+//! released holds back everything allocated after it.
+//!
+//! All functions are safe to call from multiple threads.
+//!
+class StagingRing
+    : public grfx::DeviceObject<grfx::StagingRingCreateInfo>
+{
+public:
+    StagingRing() {}
+    virtual ~StagingRing() {}
+
+    //! Alignment doesn't need to be a power of two so it can be a multiple
+    //! of a texel size.
+    Result Allocate(uint64_t size, uint64_t alignment, grfx::StagingAllocation* pAllocation);
+
+    //! Free() on an allocation that was already released is a no-op.
+    void Free(const grfx::StagingAllocation& allocation);
+    void Retire(const grfx::StagingAllocation& allocation, grfx::Fence* pFence);
+    void Retire(const grfx::StagingAllocation& allocation, uint64_t frameNumber);
+
+    void ReleaseFrames(uint64_t completedFrameNumber);
+
+    grfx::StagingRingStats GetStats() const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::StagingRingCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+    //! Creates and maps the buffer of a ring, overridden by tests to run
+    //! without a device.
+    virtual Result CreateRingBuffer(uint64_t size, grfx::Buffer** ppBuffer, void** ppMappedAddress);
+    virtual void   DestroyRingBuffer(grfx::Buffer* pBuffer);
+
+private:
+    enum RegionState
+    {
+        REGION_STATE_PENDING = 0,
+        REGION_STATE_FREE    = 1,
+        REGION_STATE_FENCE   = 2,
+        REGION_STATE_FRAME   = 3,
+    };
+
+    struct Region
+    {
+        uint64_t     id          = 0;
+        uint64_t     end         = 0;
+        RegionState  state       = REGION_STATE_PENDING;
+        grfx::Fence* pFence      = nullptr;
+        uint64_t     frameNumber = 0;
+    };
+
+    struct Chunk
+    {
+        grfx::BufferPtr    buffer;
+        char*              pAddress = nullptr;
+        uint64_t           size     = 0;
+        uint64_t           head     = 0; // Running byte count, offset is head % size
+        uint64_t           tail     = 0;
+        std::deque<Region> regions;
+    };
+
+    Result   CreateChunk(uint64_t size, Chunk* pChunk);
+    void     DestroyChunk(Chunk& chunk);
+    Result   Grow(uint64_t requiredSize);
+    bool     TryAllocate(Chunk& chunk, uint64_t size, uint64_t alignment, uint64_t* pOffset);
+    void     ReleaseRegions(Chunk& chunk);
+    void     ReleaseAll();
+    Region*  FindRegion(uint64_t id);
+    uint64_t GetBytesInUse() const;
+
+private:
+    mutable std::mutex     mMutex;
+    Chunk                  mChunk;
+    std::vector<Chunk>     mRetiredChunks; // Replaced by a bigger chunk, destroyed once empty
+    uint64_t               mNextId         = 1;
+    uint64_t               mCompletedFrame = 0;
+    grfx::StagingRingStats mStats;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_staging_ring_h
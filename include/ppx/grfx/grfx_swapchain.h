@@ -15,6 +15,8 @@
 #ifndef ppx_grfx_swapchain_h
 #define ppx_grfx_swapchain_h
 
+#include <chrono>
+#include <deque>
 #include <limits>
 
 #include "ppx/grfx/grfx_config.h"
@@ -89,12 +91,73 @@ public:
 
 // -------------------------------------------------------------------------------------------------
 
+namespace internal {
+
+//! @class HeadlessPresentQueue
+//!
+//! Emulates the presentation engine for the virtual images of a headless
+//! swapchain. With PRESENT_MODE_FIFO presented images are displayed one
+//! per refresh in order, with PRESENT_MODE_MAILBOX a newly presented image
+//! replaces the one waiting for the next refresh. An image is free for
+//! rendering again once another image is displayed in its place, so
+//! acquiring blocks the same way it does on a real swapchain.
+//!
+//! PRESENT_MODE_IMMEDIATE, or a refresh period of 0, doesn't pace: images
+//! are acquired in order and are always free.
+//!
+//! Times are in seconds on any monotonic clock.
+//!
+class HeadlessPresentQueue
+{
+public:
+    HeadlessPresentQueue() {}
+    ~HeadlessPresentQueue() {}
+
+    void Reset(uint32_t imageCount, grfx::PresentMode presentMode, double refreshPeriod, double startTime);
+
+    //! Returns false if no image is free at time now, *pRetryTime is the
+    //! next refresh, which might free one.
+    bool Acquire(double now, uint32_t* pImageIndex, double* pRetryTime);
+    void Present(double now, uint32_t imageIndex);
+
+    bool     IsPaced() const { return mPaced; }
+    uint64_t GetRefreshCount() const { return mRefreshCount; }
+    uint32_t GetDisplayedImageIndex() const { return mDisplayedImageIndex; }
+
+private:
+    void Refresh(double now);
+
+    enum ImageState
+    {
+        IMAGE_STATE_FREE,
+        IMAGE_STATE_ACQUIRED,
+        IMAGE_STATE_QUEUED,
+        IMAGE_STATE_DISPLAYED,
+    };
+
+    std::vector<ImageState> mImageStates;
+    std::deque<uint32_t>    mQueuedImages;
+    grfx::PresentMode       mPresentMode         = grfx::PRESENT_MODE_IMMEDIATE;
+    bool                    mPaced               = false;
+    double                  mRefreshPeriod       = 0;
+    double                  mStartTime           = 0;
+    uint64_t                mRefreshCount        = 0;
+    uint32_t                mNextImageIndex      = 0;
+    uint32_t                mDisplayedImageIndex = UINT32_MAX;
+};
+
+} // namespace internal
+
 //! @struct SwapchainCreateInfo
 //!
 //! NOTE: The member \b imageCount is the minimum image count.
 //!       On Vulkan, the actual number of images created by
 //!       the swapchain may be greater than this value.
 //!
+//! NOTE: Headless swapchains (no \b pSurface) emulate \b presentMode
+//!       with \b imageCount virtual images refreshed at
+//!       \b headlessRefreshRate, see internal::HeadlessPresentQueue.
+//!
 struct SwapchainCreateInfo
 {
     grfx::Queue*              pQueue              = nullptr;
@@ -106,6 +169,7 @@ struct SwapchainCreateInfo
     grfx::Format              depthFormat         = grfx::FORMAT_UNDEFINED;
     uint32_t                  imageCount          = 0;
     grfx::PresentMode         presentMode         = grfx::PRESENT_MODE_IMMEDIATE;
+    uint32_t                  headlessRefreshRate = 60; // Hz
 #if defined(PPX_BUILD_XR)
     XrComponent* pXrComponent = nullptr;
 #endif
@@ -198,6 +262,9 @@ private:
         uint32_t                      waitSemaphoreCount,
         const grfx::Semaphore* const* ppWaitSemaphores) = 0;
 
+    // Headless acquire and present don't submit anything to the queue:
+    // the acquire semaphore and fence are signaled on the host and the
+    // present wait semaphores are folded into the next queue submission.
     Result AcquireNextImageHeadless(
         uint64_t         timeout,
         grfx::Semaphore* pSemaphore,
@@ -209,7 +276,10 @@ private:
         uint32_t                      waitSemaphoreCount,
         const grfx::Semaphore* const* ppWaitSemaphores);
 
-    std::vector<grfx::CommandBufferPtr> mHeadlessCommandBuffers;
+    double GetHeadlessTime() const;
+
+    grfx::internal::HeadlessPresentQueue  mHeadlessPresentQueue;
+    std::chrono::steady_clock::time_point mHeadlessStartTime;
 
 protected:
     grfx::QueuePtr                         mQueue;
@@ -38,9 +38,15 @@ public:
     Fence() {}
     virtual ~Fence() {}
 
+    // Timeout is in nanoseconds. Returns ERROR_WAIT_TIMED_OUT if the fence
+    // isn't signaled in time, a timeout of 0 polls without blocking.
     virtual Result Wait(uint64_t timeout = UINT64_MAX) = 0;
     virtual Result Reset()                             = 0;
 
+    // Signals the fence from the CPU without a queue submission. Used by
+    // headless swapchains, which have no presentation engine to do it.
+    virtual Result SignalOnHost() = 0;
+
     Result WaitAndReset(uint64_t timeout = UINT64_MAX);
 
 protected:
@@ -68,6 +74,11 @@ public:
     Semaphore() {}
     virtual ~Semaphore() {}
 
+    // Signals the semaphore from the CPU without a queue submission, the
+    // next queue submission that waits on it doesn't block. Used by
+    // headless swapchains, which have no presentation engine to do it.
+    virtual Result SignalOnHost() = 0;
+
 protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) = 0;
     virtual void   DestroyApiObjects()                                            = 0;
@@ -21,6 +21,9 @@
 #include "ppx/font.h"
 #include "xxhash.h"
 
+#include <array>
+#include <unordered_map>
+
 namespace ppx {
 namespace grfx {
 
@@ -47,6 +50,34 @@ struct TextureFontCreateInfo
     std::string characters = ""; // Default characters if empty
 };
 
+namespace internal {
+
+//! @class GlyphLookup
+//!
+//! Maps codepoints to glyph indices. ASCII codepoints index a table
+//! directly, everything else goes through a hash map.
+//!
+class GlyphLookup
+{
+public:
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    GlyphLookup() { mAsciiIndices.fill(kInvalidIndex); }
+
+    // The first glyph wins if a codepoint is repeated
+    void     Build(const std::vector<grfx::TextureFontGlyphMetrics>& glyphs);
+    uint32_t Find(uint32_t codepoint) const;
+    uint32_t GetMappedCount() const { return static_cast<uint32_t>(mIndices.size()); }
+
+private:
+    static constexpr uint32_t kAsciiCount = 128;
+
+    std::array<uint32_t, kAsciiCount>      mAsciiIndices = {};
+    std::unordered_map<uint32_t, uint32_t> mIndices;
+};
+
+} // namespace internal
+
 class TextureFont
     : public grfx::DeviceObject<grfx::TextureFontCreateInfo>
 {
@@ -74,14 +105,23 @@ private:
     FontMetrics                                mFontMetrics;
     std::vector<grfx::TextureFontGlyphMetrics> mGlyphMetrics;
     grfx::TexturePtr                           mTexture;
+    internal::GlyphLookup                      mGlyphLookup; // Index into mGlyphMetrics
 };
 
 // -------------------------------------------------------------------------------------------------
 
+//! @struct TextDrawCreateInfo
+//!
+//! maxCachedLayouts
+//!   - number of string layouts kept between frames so that strings that
+//!     don't change skip glyph lookup, 0 disables the cache. Layouts not
+//!     used since the previous Clear() are evicted.
+//!
 struct TextDrawCreateInfo
 {
     grfx::TextureFont*    pFont              = nullptr;
     uint32_t              maxTextLength      = 4096;
+    uint32_t              maxCachedLayouts   = 1024;
     grfx::ShaderStageInfo VS                 = {}; // Use basic/shaders/TextDraw.hlsl (vsmain) for now
     grfx::ShaderStageInfo PS                 = {}; // Use basic/shaders/TextDraw.hlsl (psmain) for now
     grfx::BlendMode       blendMode          = grfx::BLEND_MODE_PREMULT_ALPHA;
@@ -89,6 +129,78 @@ struct TextDrawCreateInfo
     grfx::Format          depthStencilFormat = grfx::FORMAT_UNDEFINED;
 };
 
+//! @struct TextDrawString
+//!
+//! Arguments of TextDraw::AddString() for TextDraw::AddStrings().
+//!
+struct TextDrawString
+{
+    float2      position    = float2(0, 0);
+    std::string string      = "";
+    float       tabSpacing  = 3.0f;
+    float       lineSpacing = 1.0f;
+    float3      color       = float3(1, 1, 1);
+    float       opacity     = 1.0f;
+};
+
+namespace internal {
+
+//! @class TextLayoutCache
+//!
+//! Layouts of the strings drawn by a TextDraw, keyed by a hash of the
+//! string and its spacing. Lookups compare the whole key, so a string
+//! whose hash collides with a cached one is laid out every time instead
+//! of drawing the other string.
+//!
+class TextLayoutCache
+{
+public:
+    struct Quad
+    {
+        float2                  position = {}; // Relative to the string's position
+        float2                  size     = {};
+        grfx::TextureFontUVRect uvRect   = {};
+    };
+
+    struct Layout
+    {
+        std::string       string;
+        float             tabSpacing    = 0;
+        float             lineSpacing   = 0;
+        uint64_t          lastUsedFrame = 0;
+        std::vector<Quad> quads;
+    };
+
+    static uint64_t Hash(const std::string& string, float tabSpacing, float lineSpacing);
+
+    void     SetMaxLayouts(uint32_t maxLayouts) { mMaxLayouts = maxLayouts; }
+    uint32_t GetCount() const { return static_cast<uint32_t>(mLayouts.size()); }
+
+    // Cached layout of the string, nullptr if there isn't one
+    Layout* Find(uint64_t hash, const std::string& string, float tabSpacing, float lineSpacing);
+
+    // Empty layout for the string to be laid out into, nullptr if the
+    // cache is full or another string has the same hash
+    Layout* Insert(uint64_t hash, const std::string& string, float tabSpacing, float lineSpacing);
+
+    // Evicts the layouts that weren't used since the previous call
+    void NextFrame();
+    void Clear() { mLayouts.clear(); }
+
+private:
+    uint32_t                             mMaxLayouts = 0;
+    uint64_t                             mFrameIndex = 0;
+    std::unordered_map<uint64_t, Layout> mLayouts;
+};
+
+} // namespace internal
+
+//! @class TextDraw
+//!
+//! The CPU vertex buffer is mapped by the first AddString() after an
+//! upload and stays mapped until the next UploadToGpu(), so adding many
+//! strings per frame maps once.
+//!
 class TextDraw
     : public grfx::DeviceObject<grfx::TextDrawCreateInfo>
 {
@@ -112,6 +224,11 @@ public:
         const float3&      color   = float3(1, 1, 1),
         float              opacity = 1.0f);
 
+    void AddStrings(const std::vector<grfx::TextDrawString>& strings);
+
+    uint32_t GetTextLength() const { return mTextLength; }
+    uint32_t GetCachedLayoutCount() const { return mLayoutCache.GetCount(); }
+
     // Use this if text is static
     ppx::Result UploadToGpu(grfx::Queue* pQueue);
 
@@ -126,7 +243,21 @@ protected:
     virtual void   DestroyApiObjects() override;
 
 private:
-    uint32_t                     mTextLength = 0;
+    using Layout     = internal::TextLayoutCache::Layout;
+    using LayoutQuad = internal::TextLayoutCache::Quad;
+
+    void*         MapVertices();
+    void          UnmapVertices();
+    const Layout* GetLayout(const std::string& string, float tabSpacing, float lineSpacing);
+    void          LayoutString(const std::string& string, float tabSpacing, float lineSpacing, Layout* pLayout) const;
+    void          WriteString(const float2& position, const Layout& layout, const float3& color, float opacity);
+
+private:
+    uint32_t                     mTextLength         = 0;
+    uint32_t                     mUploadedGlyphCount = 0; // Glyphs whose indices are in mGpuIndexBuffer
+    void*                        mMappedVertices     = nullptr;
+    internal::TextLayoutCache    mLayoutCache;
+    Layout                       mScratchLayout;
     grfx::BufferPtr              mCpuIndexBuffer;
     grfx::BufferPtr              mCpuVertexBuffer;
     grfx::BufferPtr              mGpuIndexBuffer;
@@ -93,6 +93,7 @@ private:
     grfx::RenderTargetViewPtr mRenderTargetView;
     grfx::DepthStencilViewPtr mDepthStencilView;
     grfx::StorageImageViewPtr mStorageImageView;
+    ppx::SlotHandle           mImageRegistryHandle = 0;
 };
 
 } // namespace grfx
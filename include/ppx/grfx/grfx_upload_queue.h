@@ -0,0 +1,183 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_upload_queue_h
+#define ppx_grfx_upload_queue_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_staging_ring.h"
+
+#include <mutex>
+
+namespace ppx {
+namespace grfx {
+
+//! @typedef UploadTicket
+//!
+//! Identifies a batch of copies submitted by an UploadQueue. Tickets
+//! increase monotonically, a ticket value of 0 is always complete.
+//!
+typedef uint64_t UploadTicket;
+
+//! @struct UploadQueueCreateInfo
+//!
+//! pQueue
+//!   - queue that copies are submitted to, usually the graphics queue so
+//!     that the resource state transitions are valid
+//!
+//! pStagingRing
+//!   - ring that staging memory is allocated from, the device's staging
+//!     ring is used if this is null
+//!
+//! batchCount
+//!   - maximum number of batches in flight, each batch has its own
+//!     command buffer and fence
+//!
+struct UploadQueueCreateInfo
+{
+    grfx::Queue*       pQueue       = nullptr;
+    grfx::StagingRing* pStagingRing = nullptr;
+    uint32_t           batchCount   = 4;
+};
+
+//! @class UploadQueue
+//!
+//! Records buffer and image copies into a batch and submits the batch
+//! with a fence instead of waiting for the queue to go idle. Staging
+//! memory comes from a grfx::StagingRing and is released once the batch
+//! that used it has completed.
+//!
+//! Typical use:
+//!   - AllocateStaging() and write the source data
+//!   - CopyBufferToBuffer() / CopyBufferToImage() from the allocation,
+//!     which hands the allocation to the batch that records the copy
+//!   - Flush() before submitting work that reads the destination
+//!     resources, work submitted to the same queue afterwards is
+//!     ordered after the copies
+//!   - Wait() or IsComplete() on the ticket before destroying or
+//!     re-uploading a destination resource
+//!
+//! All functions are safe to call from multiple threads.
+//!
+class UploadQueue
+    : public grfx::DeviceObject<grfx::UploadQueueCreateInfo>
+{
+public:
+    UploadQueue() {}
+    virtual ~UploadQueue() {}
+
+    grfx::Queue*       GetQueue() const { return mCreateInfo.pQueue; }
+    grfx::StagingRing* GetStagingRing() const { return mStagingRing; }
+
+    //! Allocates staging memory. The caller owns the allocation until it's
+    //! passed to CopyBufferToBuffer() or CopyBufferToImage(), or released
+    //! with FreeStaging() if it's never copied from.
+    Result AllocateStaging(uint64_t size, uint64_t alignment, grfx::StagingAllocation* pAllocation);
+    void   FreeStaging(const grfx::StagingAllocation& allocation);
+
+    //! The copy functions take ownership of staging, even when they fail.
+    //! It's released once the batch that records the copy completes, so a
+    //! Flush() from another thread between AllocateStaging() and the copy
+    //! can't release it early. An allocation can be copied from several
+    //! times, but not after the batch holding it was flushed. Source
+    //! offsets in the copy infos are offsets into staging.pBuffer.
+    Result CopyBufferToBuffer(
+        const grfx::BufferToBufferCopyInfo* pCopyInfo,
+        const grfx::StagingAllocation&      staging,
+        grfx::Buffer*                       pDstBuffer,
+        grfx::ResourceState                 stateBefore,
+        grfx::ResourceState                 stateAfter);
+
+    Result CopyBufferToImage(
+        const std::vector<grfx::BufferToImageCopyInfo>& copyInfos,
+        const grfx::StagingAllocation&                  staging,
+        grfx::Image*                                    pDstImage,
+        uint32_t                                        mipLevel,
+        uint32_t                                        mipLevelCount,
+        uint32_t                                        arrayLayer,
+        uint32_t                                        arrayLayerCount,
+        grfx::ResourceState                             stateBefore,
+        grfx::ResourceState                             stateAfter);
+
+    //! Copies size bytes from pData into staging memory and records a copy
+    //! to pDstBuffer at dstOffset.
+    Result UploadToBuffer(
+        uint64_t            size,
+        const void*         pData,
+        grfx::Buffer*       pDstBuffer,
+        uint64_t            dstOffset,
+        grfx::ResourceState stateBefore,
+        grfx::ResourceState stateAfter);
+
+    //! Submits the batch that's currently being recorded. pTicket receives
+    //! the batch's ticket, or the ticket of the last submitted batch if
+    //! nothing was recorded.
+    Result Flush(grfx::UploadTicket* pTicket = nullptr);
+
+    //! Returns true if the batch identified by ticket has completed on
+    //! the GPU. Never blocks.
+    bool IsComplete(grfx::UploadTicket ticket);
+
+    //! Flushes if ticket belongs to the batch being recorded and waits
+    //! until the batch has completed.
+    Result Wait(grfx::UploadTicket ticket);
+
+    //! Flushes and waits for every submitted batch.
+    Result WaitIdle();
+
+protected:
+    virtual Result CreateApiObjects(const grfx::UploadQueueCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    struct Batch
+    {
+        grfx::CommandBufferPtr               commandBuffer;
+        grfx::FencePtr                       fence;
+        grfx::UploadTicket                   ticket    = 0;
+        bool                                 recording = false;
+        std::vector<grfx::StagingAllocation> allocations;
+    };
+
+    Result BeginBatch();
+    void   AddAllocation(const grfx::StagingAllocation& allocation);
+    Result FlushLocked(grfx::UploadTicket* pTicket);
+    Result WaitLocked(grfx::UploadTicket ticket);
+    Result WaitOldestBatch();
+    void   RetireCompletedBatches();
+    void   RetireBatch(Batch& batch);
+
+private:
+    std::mutex         mMutex;
+    grfx::StagingRing* mStagingRing = nullptr;
+    std::vector<Batch> mBatches;
+    uint32_t           mCurrentBatch    = 0;
+    grfx::UploadTicket mNextTicket      = 1;
+    grfx::UploadTicket mSubmittedTicket = 0;
+    grfx::UploadTicket mCompletedTicket = 0;
+};
+
+namespace internal {
+
+//! Registers UploadQueue's profiler events. Called once by
+//! Instance::Create() so no thread records them while they're registered.
+void RegisterUploadQueueProfilerEvents();
+
+} // namespace internal
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_upload_queue_h
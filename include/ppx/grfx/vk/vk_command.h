@@ -41,6 +41,9 @@ private:
     virtual void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo) override;
     virtual void EndRenderingImpl() override;
 
+    virtual Result BeginSecondaryImpl(const grfx::RenderPass* pRenderPass) override;
+    virtual void   ExecuteCommandsImpl(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers) override;
+
     virtual void PushDescriptorImpl(
         grfx::CommandType              pipelineBindPoint,
         const grfx::PipelineInterface* pInterface,
@@ -80,6 +83,14 @@ public:
         const grfx::Queue*  pSrcQueue = nullptr,
         const grfx::Queue*  pDstQueue = nullptr) override;
 
+    virtual void ImageMemoryBarrier(
+        const grfx::Image*  pImage,
+        grfx::ResourceState state) override;
+
+    virtual void BufferMemoryBarrier(
+        const grfx::Buffer* pBuffer,
+        grfx::ResourceState state) override;
+
     virtual void SetViewports(
         uint32_t              viewportCount,
         const grfx::Viewport* pViewports) override;
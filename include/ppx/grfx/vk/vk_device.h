@@ -29,8 +29,9 @@ public:
     Device() {}
     virtual ~Device() {}
 
-    VkDevicePtr     GetVkDevice() const { return mDevice; }
-    VmaAllocatorPtr GetVmaAllocator() const { return mVmaAllocator; }
+    VkDevicePtr        GetVkDevice() const { return mDevice; }
+    VmaAllocatorPtr    GetVmaAllocator() const { return mVmaAllocator; }
+    VkPipelineCachePtr GetVkPipelineCache() const { return mPipelineCache; }
 
     const VkPhysicalDeviceFeatures& GetDeviceFeatures() const { return mDeviceFeatures; }
 
@@ -101,6 +102,8 @@ private:
         VkPhysicalDevice               physicalDevice,
         grfx::ShadingRateCapabilities* pShadingRateCapabilities);
     Result CreateQueues(const grfx::DeviceCreateInfo* pCreateInfo);
+    Result CreatePipelineCache(const grfx::DeviceCreateInfo* pCreateInfo);
+    void   DestroyPipelineCache();
 
 private:
     std::vector<std::string>                       mFoundExtensions;
@@ -108,6 +111,7 @@ private:
     VkDevicePtr                                    mDevice;
     VkPhysicalDeviceFeatures                       mDeviceFeatures = {};
     VmaAllocatorPtr                                mVmaAllocator;
+    VkPipelineCachePtr                             mPipelineCache;
     bool                                           mHasTimelineSemaphore                       = false;
     bool                                           mHasExtendedDynamicState                    = false;
     bool                                           mHasUnrestrictedDepthRange                  = false;
@@ -37,6 +37,12 @@ public:
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) override;
 
+    virtual void DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores) override;
+
+    // Submits the deferred waits on their own, for when there's no next
+    // submission to fold them into
+    Result SubmitDeferredWaits();
+
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const override;
 
     VkResult TransitionImageLayout(
@@ -55,8 +61,10 @@ protected:
     virtual void   DestroyApiObjects() override;
 
 private:
-    VkQueuePtr       mQueue;
-    VkCommandPoolPtr mTransientPool;
+    VkQueuePtr               mQueue;
+    VkCommandPoolPtr         mTransientPool;
+    std::mutex               mDeferredWaitMutex;
+    std::vector<VkSemaphore> mDeferredWaitSemaphores;
 };
 
 } // namespace vk
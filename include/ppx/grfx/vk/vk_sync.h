@@ -36,6 +36,7 @@ public:
 
     virtual Result Wait(uint64_t timeout = UINT64_MAX) override;
     virtual Result Reset() override;
+    virtual Result SignalOnHost() override;
 
 protected:
     virtual Result CreateApiObjects(const grfx::FenceCreateInfo* pCreateInfo) override;
@@ -43,6 +44,9 @@ protected:
 
 private:
     VkFencePtr mFence;
+    // Vulkan fences can't be signaled from the host, Wait() checks this
+    // until the next Reset()
+    bool mSignaledOnHost = false;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -59,12 +63,21 @@ public:
 
     VkSemaphorePtr GetVkSemaphore() const { return mSemaphore; }
 
+    virtual Result SignalOnHost() override;
+
+    // Returns true and clears the host signal if SignalOnHost() was called
+    // since the last wait. Queue::Submit() drops the wait in that case.
+    bool ConsumeHostSignal() const;
+
 protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
 private:
     VkSemaphorePtr mSemaphore;
+    // Binary semaphores can't be signaled from the host. Mutable since
+    // submissions only see const semaphores.
+    mutable bool mSignaledOnHost = false;
 };
 
 } // namespace vk
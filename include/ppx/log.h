@@ -17,12 +17,17 @@
 
 #include "math_config.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #define PPX_LOG_DEFAULT_PATH "ppx.log"
 
@@ -39,6 +44,7 @@ enum LogMode
     LOG_MODE_OFF     = 0x0,
     LOG_MODE_CONSOLE = 0x1,
     LOG_MODE_FILE    = 0x2,
+    LOG_MODE_ASYNC   = 0x4,
 };
 
 enum LogLevel
@@ -51,6 +57,37 @@ enum LogLevel
     LOG_LEVEL_FATAL   = 0x5,
 };
 
+enum LogOverflowPolicy
+{
+    LOG_OVERFLOW_POLICY_DROP  = 0x0,
+    LOG_OVERFLOW_POLICY_BLOCK = 0x1,
+};
+
+//! @struct LogAsyncSettings
+//!
+//! queueCapacity
+//!   - number of records each logging thread can have queued, rounded up
+//!     to a power of two
+//!
+//! maxRecordSize
+//!   - records longer than this many bytes are truncated, together with
+//!     queueCapacity this bounds the memory used per logging thread
+//!
+//! overflowPolicy
+//!   - what a logging thread does when its queue is full. DROP discards
+//!     the record and reports the number of dropped records in the log,
+//!     BLOCK waits for the writer thread. Error and fatal records are
+//!     never dropped.
+//!
+struct LogAsyncSettings
+{
+    uint32_t          queueCapacity  = 1024;
+    uint32_t          maxRecordSize  = 4096;
+    LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_POLICY_DROP;
+};
+
+class LogRecordQueue;
+
 #if defined(PPX_ANDROID)
 #define PPX_LOG_ENDL ""
 #else
@@ -59,6 +96,12 @@ enum LogLevel
 
 //! @class Log
 //!
+//! In synchronous mode each record is written and flushed on the calling
+//! thread. In async mode (LOG_MODE_ASYNC) records are pushed to a lock-free
+//! queue owned by the calling thread and a writer thread drains all queues
+//! in the order the records were submitted. Fatal records are written and
+//! flushed, together with everything queued before them, before
+//! PPX_LOG_FATAL returns.
 //!
 class Log
 {
@@ -74,10 +117,31 @@ public:
     static bool IsActive();
     static bool IsModeActive(LogMode mode);
 
+    //! Switches between synchronous and async mode. Queued records are
+    //! written before returning when async mode is turned off.
+    static void SetAsync(bool enable, const LogAsyncSettings& settings = LogAsyncSettings());
+
+    //! Number of records dropped by LOG_OVERFLOW_POLICY_DROP since
+    //! Initialize().
+    static uint64_t GetDroppedRecordCount();
+
     void Lock();
     void Unlock();
+
+    //! Writes the contents of the buffer filled with operator<<. Must be
+    //! called between Lock() and Unlock(). In async mode queued records
+    //! are written first.
     void Flush(LogLevel level);
 
+    //! Writes every queued record and flushes the outputs.
+    void Drain();
+
+    //! Used by the PPX_LOG_* macros: BeginRecord() returns a per-thread
+    //! stream that the message is formatted into and EndRecord() writes or
+    //! queues it. Formatting doesn't take any locks.
+    std::ostream& BeginRecord();
+    void          EndRecord(LogLevel level);
+
     template <typename T>
     Log& operator<<(const T& value)
     {
@@ -96,6 +160,13 @@ private:
     void DestroyObjects();
 
     void Write(const char* msg, LogLevel level);
+    void FlushStreams();
+
+    void StartAsync(const LogAsyncSettings& settings);
+    void StopAsync();
+    void PushRecord(const std::string& text, LogLevel level);
+    void DrainLocked();
+    void WriterThreadFunc();
 
 private:
     uint32_t          mModes = LOG_MODE_OFF;
@@ -103,70 +174,74 @@ private:
     std::ofstream     mFileStream;
     std::ostream*     mConsoleStream = nullptr;
     std::stringstream mBuffer;
-    std::mutex        mWriteMutex;
+    std::mutex        mWriteMutex; // Also held by whoever drains the queues
+
+    // Async mode
+    std::atomic<bool>                            mAsync = false;
+    LogAsyncSettings                             mAsyncSettings;
+    uint64_t                                     mAsyncSession = 0;
+    std::atomic<uint64_t>                        mNextSequence = 0;
+    std::mutex                                   mQueuesMutex;
+    std::vector<std::shared_ptr<LogRecordQueue>> mQueues;
+    uint64_t                                     mDroppedRecordCount = 0;
+    std::thread                                  mWriterThread;
+    std::mutex                                   mWriterMutex;
+    std::condition_variable                      mWriterCondition;
+    bool                                         mStopWriter = false;
 };
 
 } // namespace ppx
 
 // clang-format off
-#define PPX_LOG_RAW(MSG)                                \
-    if (ppx::Log::IsActive()) {                         \
-        ppx::Log::Get()->Lock();                        \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;      \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_DEFAULT); \
-        ppx::Log::Get()->Unlock();                      \
+#define PPX_LOG_RECORD(LEVEL, MSG)                                   \
+    {                                                                \
+        std::ostream& ppxLogStream = ppx::Log::Get()->BeginRecord(); \
+        ppxLogStream << MSG << PPX_LOG_ENDL;                         \
+        ppx::Log::Get()->EndRecord(LEVEL);                           \
     }
 
-#define PPX_LOG_INFO(MSG)                            \
+#define PPX_LOG_RAW(MSG)                             \
     if (ppx::Log::IsActive()) {                      \
-        ppx::Log::Get()->Lock();                     \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;   \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_INFO); \
-        ppx::Log::Get()->Unlock();                   \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_DEFAULT, MSG); \
     }
 
-#define PPX_LOG_WARN(MSG)                            \
-    if (ppx::Log::IsActive()) {                      \
-        ppx::Log::Get()->Lock();                     \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;   \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_WARN); \
-        ppx::Log::Get()->Unlock();                   \
+#define PPX_LOG_INFO(MSG)                         \
+    if (ppx::Log::IsActive()) {                   \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_INFO, MSG); \
+    }
+
+#define PPX_LOG_WARN(MSG)                         \
+    if (ppx::Log::IsActive()) {                   \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_WARN, MSG); \
+    }
+
+#define PPX_LOG_WARN_ONCE(MSG)                           \
+    if (ppx::Log::IsActive()) {                          \
+        static std::atomic<bool> ppxLogWarnOnce = false; \
+        if (!ppxLogWarnOnce.exchange(true)) {            \
+            PPX_LOG_RECORD(ppx::LOG_LEVEL_WARN, MSG);    \
+        }                                                \
     }
 
-#define PPX_LOG_WARN_ONCE(MSG)                         \
-    if (ppx::Log::IsActive()) {                        \
-        ppx::Log::Get()->Lock();                       \
-        static bool ppxLogWarnOnce = false;            \
-        if(!ppxLogWarnOnce) {                          \
-            (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL; \
-        }                                              \
-        ppxLogWarnOnce = true;                         \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_WARN);   \
-        ppx::Log::Get()->Unlock();                     \
+#define PPX_LOG_DEBUG(MSG)                         \
+    if (ppx::Log::IsActive()) {                    \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_DEBUG, MSG); \
     }
 
-#define PPX_LOG_DEBUG(MSG)                            \
-    if (ppx::Log::IsActive()) {                       \
-        ppx::Log::Get()->Lock();                      \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;    \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_DEBUG); \
-        ppx::Log::Get()->Unlock();                    \
+#define PPX_LOG_ERROR(MSG)                         \
+    if (ppx::Log::IsActive()) {                    \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_ERROR, MSG); \
     }
 
-#define PPX_LOG_ERROR(MSG)                            \
-    if (ppx::Log::IsActive()) {                       \
-        ppx::Log::Get()->Lock();                      \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;    \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_ERROR); \
-        ppx::Log::Get()->Unlock();                    \
+#define PPX_LOG_FATAL(MSG)                         \
+    if (ppx::Log::IsActive()) {                    \
+        PPX_LOG_RECORD(ppx::LOG_LEVEL_FATAL, MSG); \
     }
 
-#define PPX_LOG_FATAL(MSG)                            \
-    if (ppx::Log::IsActive()) {                       \
-        ppx::Log::Get()->Lock();                      \
-        (*ppx::Log::Get()) << MSG << PPX_LOG_ENDL;    \
-        ppx::Log::Get()->Flush(ppx::LOG_LEVEL_FATAL); \
-        ppx::Log::Get()->Unlock();                    \
+// Writes everything that's queued in async mode, use before aborting
+#define PPX_LOG_FLUSH()           \
+    if (ppx::Log::IsActive()) {   \
+        ppx::Log::Get()->Drain(); \
     }
 // clang-format on
 
@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_mesh_cache_h
+#define ppx_mesh_cache_h
+
+#include "ppx/config.h"
+#include "ppx/fs.h"
+#include "ppx/geometry.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace ppx {
+
+// Binary mesh cache
+//
+// Layout, all integers are little endian:
+//
+//   MeshCacheHeader
+//   MeshCacheBinding[bindingCount]
+//   MeshCacheAttribute[attributeCount], grouped by binding
+//   Index data, then one vertex buffer per binding, each buffer starts on
+//   a kMeshCacheAlignment boundary
+//
+// The buffers are the Geometry buffers as is, so they're uploaded straight
+// from the mapped file. sourceHash identifies what the cache was built
+// from, see MeshCacheFile::HashSource(). A cache whose hash doesn't match
+// is stale and gets rebuilt.
+//
+constexpr char     kMeshCacheMagic[8]  = {'P', 'P', 'X', 'M', 'E', 'S', 'H', '\0'};
+constexpr uint32_t kMeshCacheVersion   = 1;
+constexpr uint32_t kMeshCacheAlignment = 16;
+
+struct MeshCacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t indexType; // grfx::IndexType
+    uint64_t sourceHash;
+    uint32_t vertexAttributeLayout; // GeometryVertexAttributeLayout
+    uint32_t primitiveTopology;     // grfx::PrimitiveTopology
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    uint32_t bindingCount;
+    uint32_t attributeCount;
+    float    boundingBoxMin[3];
+    float    boundingBoxMax[3];
+    uint64_t indexDataOffset;
+    uint64_t indexDataSize;
+};
+static_assert(sizeof(MeshCacheHeader) == 88, "MeshCacheHeader is an on-disk structure");
+
+struct MeshCacheBinding
+{
+    uint32_t binding;
+    uint32_t stride;
+    uint32_t inputRate; // grfx::VertexInputRate
+    uint32_t attributeCount;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+static_assert(sizeof(MeshCacheBinding) == 32, "MeshCacheBinding is an on-disk structure");
+
+struct MeshCacheAttribute
+{
+    uint32_t location;
+    uint32_t format; // grfx::Format
+    uint32_t binding;
+    uint32_t offset;
+    uint32_t inputRate; // grfx::VertexInputRate
+    uint32_t semantic;  // grfx::VertexSemantic
+};
+static_assert(sizeof(MeshCacheAttribute) == 24, "MeshCacheAttribute is an on-disk structure");
+
+//! @class MeshCacheFile
+//!
+//! Read-only view of a mesh cache file. The file is memory-mapped when
+//! fs::File supports it, otherwise it's read into memory. Vertex and index
+//! data are read in place, nothing is copied until the data is uploaded
+//! or CreateGeometry() is called.
+//!
+//! Attribute semantic names aren't stored, they're restored with
+//! grfx::ToString() the same way GeometryOptions names them.
+//!
+class MeshCacheFile
+{
+public:
+    MeshCacheFile() {}
+    ~MeshCacheFile() {}
+
+    MeshCacheFile(const MeshCacheFile&)            = delete;
+    MeshCacheFile& operator=(const MeshCacheFile&) = delete;
+
+    //! Fails with ERROR_MESH_CACHE_SOURCE_MISMATCH if the file was built
+    //! from a different source than sourceHash.
+    Result Open(const std::filesystem::path& path, uint64_t sourceHash);
+
+    //! pData must outlive the MeshCacheFile.
+    Result OpenFromMemory(const void* pData, size_t size, uint64_t sourceHash);
+
+    const GeometryOptions& GetGeometryOptions() const { return mOptions; }
+    grfx::IndexType        GetIndexType() const { return mOptions.indexType; }
+    uint32_t               GetIndexCount() const { return mIndexCount; }
+    uint32_t               GetVertexCount() const { return mVertexCount; }
+    uint32_t               GetVertexBufferCount() const { return mOptions.vertexBindingCount; }
+    const float3&          GetBoundingBoxMin() const { return mBoundingBoxMin; }
+    const float3&          GetBoundingBoxMax() const { return mBoundingBoxMax; }
+
+    const char* GetIndexData() const { return mpData + mIndexDataOffset; }
+    uint32_t    GetIndexDataSize() const { return mIndexDataSize; }
+    const char* GetVertexData(uint32_t index) const { return mpData + mBindings[index].dataOffset; }
+    uint32_t    GetVertexDataSize(uint32_t index) const { return static_cast<uint32_t>(mBindings[index].dataSize); }
+
+    //! Copies the cached buffers into pGeometry.
+    Result CreateGeometry(Geometry* pGeometry) const;
+
+    //! Writes geometry and its bounding box to path. The directory must exist.
+    static Result Write(
+        const std::filesystem::path& path,
+        uint64_t                     sourceHash,
+        const Geometry&              geometry,
+        const float3&                boundingBoxMin,
+        const float3&                boundingBoxMax);
+
+    //! XXH64 of the content of sourcePath, seeded with options and the cache
+    //! version, so a cache is rebuilt if any of them changes.
+    static Result HashSource(const std::filesystem::path& sourcePath, const TriMeshOptions& options, uint64_t* pHash);
+
+    //! Cache file for sourcePath in directory. The name only depends on
+    //! sourcePath, so a stale cache is overwritten instead of left behind.
+    static std::filesystem::path GetCachePath(const std::filesystem::path& directory, const std::filesystem::path& sourcePath);
+
+private:
+    Result Parse(uint64_t sourceHash);
+
+private:
+    fs::File                      mFile;
+    std::vector<char>             mStorage; // File content if mFile isn't mapped
+    const char*                   mpData           = nullptr;
+    size_t                        mDataSize        = 0;
+    GeometryOptions               mOptions         = {};
+    uint32_t                      mIndexCount      = 0;
+    uint32_t                      mVertexCount     = 0;
+    float3                        mBoundingBoxMin  = float3(0);
+    float3                        mBoundingBoxMax  = float3(0);
+    uint64_t                      mIndexDataOffset = 0;
+    uint32_t                      mIndexDataSize   = 0;
+    std::vector<MeshCacheBinding> mBindings;
+};
+
+} // namespace ppx
+
+#endif // ppx_mesh_cache_h
@@ -0,0 +1,174 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_mesh_optimize_h
+#define ppx_mesh_optimize_h
+
+#include "ppx/config.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ppx {
+
+class Geometry;
+class TriMesh;
+
+//! @struct VertexCacheStatistics
+//!
+//! Results of simulating a FIFO post-transform vertex cache.
+//!
+//! acmr
+//!   - average cache miss ratio, transformed vertices per triangle
+//!   - 3.0 is the worst case, ~0.5 is the lower bound for large regular meshes
+//!
+//! atvr
+//!   - average transform to vertex ratio, transformed vertices per referenced vertex
+//!   - 1.0 is optimal
+//!
+struct VertexCacheStatistics
+{
+    uint32_t transformCount = 0;
+    float    acmr           = 0;
+    float    atvr           = 0;
+};
+
+//! @struct MeshOptimizeOptions
+//!
+//! vertexCache
+//!   - reorders triangles for the post-transform vertex cache (Tipsify)
+//!
+//! overdraw
+//!   - splits the vertex cache order into clusters and sorts the clusters
+//!     front to back by their occlusion potential
+//!   - the vertex cache order is used as input so vertexCache should
+//!     normally be enabled as well
+//!
+//! vertexFetch
+//!   - reorders vertices by first use in the index buffer and drops
+//!     vertices that aren't referenced
+//!
+//! cacheSize
+//!   - size of the simulated FIFO cache in vertices
+//!
+//! overdrawThreshold
+//!   - how much the ACMR may degrade when splitting clusters for overdraw
+//!     ordering, 1.05 allows 5% more vertex transforms
+//!
+struct MeshOptimizeOptions
+{
+    bool     vertexCache       = true;
+    bool     overdraw          = true;
+    bool     vertexFetch       = true;
+    uint32_t cacheSize         = 16;
+    float    overdrawThreshold = 1.05f;
+};
+
+//! @struct MeshOptimizeResult
+//!
+//! before
+//!   - vertex cache statistics of the input index order
+//!
+//! after
+//!   - vertex cache statistics of the optimized index order, over the
+//!     vertices left after vertexFetch drops unreferenced ones
+//!
+struct MeshOptimizeResult
+{
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+};
+
+//! @fn AnalyzeVertexCache
+//!
+//! Simulates a FIFO cache with cacheSize entries over a triangle list.
+//! Like the other passes below, every index must be less than vertexCount,
+//! OptimizeMesh checks this before running any of them.
+//!
+VertexCacheStatistics AnalyzeVertexCache(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    uint32_t        vertexCount,
+    uint32_t        cacheSize);
+
+//! @fn OptimizeVertexCache
+//!
+//! Reorders triangles using Tipsify [Sander et al. 2007]. pDstIndices must
+//! have room for indexCount indices and must not alias pIndices. Indices
+//! past the last whole triangle are copied through unchanged.
+//!
+void OptimizeVertexCache(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    uint32_t        vertexCount,
+    uint32_t        cacheSize,
+    uint32_t*       pDstIndices);
+
+//! @fn OptimizeOverdraw
+//!
+//! Splits pIndices into clusters at vertex cache dead ends and wherever a
+//! cluster's ACMR stays under threshold times the ACMR of the enclosing
+//! cluster. Clusters are then sorted so that the ones most likely to
+//! occlude the rest of the mesh come first. pPositions points to the first
+//! position, positions are 3 floats each positionStride bytes apart.
+//! pDstIndices must not alias pIndices. Indices past the last whole
+//! triangle are copied through unchanged.
+//!
+void OptimizeOverdraw(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    const float*    pPositions,
+    uint32_t        vertexCount,
+    uint32_t        positionStride,
+    uint32_t        cacheSize,
+    float           threshold,
+    uint32_t*       pDstIndices);
+
+//! @fn OptimizeVertexFetch
+//!
+//! Rewrites pIndices so vertices are numbered in the order they're first
+//! referenced. pRemap must have room for vertexCount entries and receives
+//! the new index of each old vertex, or UINT32_MAX if the vertex isn't
+//! referenced. Returns the number of referenced vertices.
+//!
+uint32_t OptimizeVertexFetch(
+    uint32_t* pIndices,
+    uint32_t  indexCount,
+    uint32_t  vertexCount,
+    uint32_t* pRemap);
+
+//! @fn OptimizeMesh
+//!
+//! Runs the passes enabled in options on an indexed triangle mesh. Vertex
+//! data is reordered to match when options.vertexFetch is enabled. Returns
+//! ERROR_GEOMETRY_NO_INDEX_DATA if the mesh doesn't have indices,
+//! ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION if the index count isn't a
+//! multiple of 3, or if vertexFetch is enabled and a vertex buffer of the
+//! geometry doesn't hold one element per vertex, and
+//! ERROR_OUT_OF_RANGE if an index references a vertex that doesn't exist.
+//! The mesh is left untouched when an error is returned.
+//!
+Result OptimizeMesh(
+    TriMesh*                   pMesh,
+    const MeshOptimizeOptions& options = MeshOptimizeOptions(),
+    MeshOptimizeResult*        pResult = nullptr);
+
+Result OptimizeMesh(
+    Geometry*                  pGeometry,
+    const MeshOptimizeOptions& options = MeshOptimizeOptions(),
+    MeshOptimizeResult*        pResult = nullptr);
+
+} // namespace ppx
+
+#endif // ppx_mesh_optimize_h
@@ -52,6 +52,17 @@ enum class MetricInterpretation
     LOWER_IS_BETTER,
 };
 
+// How a gauge stores its entries.
+enum class GaugeMode
+{
+    // Every entry is kept, statistics are exact.
+    EXACT,
+    // Memory is bounded regardless of the entry count: percentiles are
+    // estimated with a t-digest and the exported time series is
+    // downsampled. Intended for long runs.
+    STREAMING,
+};
+
 struct Range
 {
     double lowerBound = std::numeric_limits<double>::min();
@@ -66,6 +77,13 @@ struct MetricMetadata
     MetricInterpretation interpretation = MetricInterpretation::NONE;
     Range                expectedRange;
 
+    // Gauges only, not exported.
+    GaugeMode gaugeMode = GaugeMode::EXACT;
+    // Gauges only, STREAMING: maximum number of entries in the exported
+    // time series. Adjacent entries are averaged together as the run grows.
+    // If 0, no time series is exported.
+    size_t timeSeriesCapacity = 4096;
+
     nlohmann::json Export() const;
 };
 
@@ -134,6 +152,45 @@ struct GaugeComplexStatistics
     double percentile99      = 0.0;
 };
 
+// Streaming quantile estimator (merging t-digest). Values are clustered
+// into centroids that are small near the tails and large near the median,
+// so extreme quantiles stay accurate while memory is bounded by the
+// compression factor rather than the number of values.
+class TDigest
+{
+public:
+    TDigest(double compression = 200.0);
+
+    void Add(double value);
+
+    // q is in [0, 1]. Returns 0 if no values were added.
+    double Quantile(double q) const;
+
+    uint64_t GetCount() const { return mCount; }
+    size_t   GetCentroidCount() const;
+
+private:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    void Merge() const;
+
+private:
+    double   mCompression = 200.0;
+    double   mMin         = std::numeric_limits<double>::max();
+    double   mMax         = std::numeric_limits<double>::lowest();
+    uint64_t mCount       = 0;
+
+    // Merged lazily so that Quantile() can be called on a const digest
+    mutable std::vector<Centroid> mCentroids;
+    mutable std::vector<double>   mUnmerged;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class MetricGauge final : public Metric
 {
     friend class Run;
@@ -177,11 +234,27 @@ private:
 
     GaugeComplexStatistics ComputeComplexStats() const;
 
+    void RecordStreamingEntry(const TimeSeriesEntry& entry);
+
+    // Time series including the partially filled downsampling bucket
+    std::vector<TimeSeriesEntry> GetExportedTimeSeries() const;
+
 private:
     MetricMetadata               mMetadata;
     std::vector<TimeSeriesEntry> mTimeSeries;
     GaugeBasicStatistics         mBasicStats;
     double                       mAccumulatedValue = 0.0;
+    size_t                       mEntryCount       = 0;
+    double                       mFirstSeconds     = 0.0;
+    double                       mLastSeconds      = 0.0;
+
+    // GaugeMode::STREAMING
+    TDigest         mDigest;
+    double          mWelfordMean = 0.0; // Welford's running mean and sum of squared differences
+    double          mWelfordM2   = 0.0;
+    size_t          mBucketSize  = 1; // Entries averaged into each time series entry
+    TimeSeriesEntry mBucketSum   = {0.0, 0.0};
+    size_t          mBucketCount = 0;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
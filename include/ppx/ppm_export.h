@@ -19,6 +19,8 @@
 #include "ppx/grfx/grfx_format.h"
 
 #include <ostream>
+#include <string>
+#include <vector>
 
 namespace ppx {
 
@@ -40,6 +42,78 @@ Result ExportToPPM(const std::string& outputFilename, grfx::Format inputFormat,
 //! @param rowStride The row stride, in bytes.
 Result ExportToPPM(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
 
+//! @brief Converts a 1D or 2D image to tightly packed 8-bit RGB.
+//!
+//! Supports 8-bit color formats, 16-bit float color formats and
+//! R10G10B10A2_UNORM. Missing color channels are written as 0, alpha is
+//! dropped and float values are clamped to [0, 1]. Large images are
+//! converted in bands on the default ThreadPool.
+//!
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+//! @param pOutput Receives \b width * \b height * 3 bytes.
+Result ConvertToRGB8(grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride, std::vector<uint8_t>* pOutput);
+
+//! @brief Exports a 1D or 2D image to a QOI file.
+//!
+//! QOI (https://qoiformat.org) compresses about as well as PNG at a small
+//! fraction of the cost. Bands of rows are encoded in parallel, which
+//! costs a few bytes per band. Supports the same formats as ConvertToRGB8().
+//!
+//! @param outputFilename The name of the QOI file to be written.
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+Result ExportToQOI(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
+
+//! @brief Exports a 1D or 2D image as a QOI stream.
+//! @param outputStream The output stream where the QOI data will be written.
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+Result ExportToQOI(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
+
+//! @brief Exports a 1D or 2D image to an 8-bit RGB PNG file.
+//!
+//! Bands of rows are filtered and deflated in parallel, each band ends
+//! with a sync flush so the bands concatenate into one zlib stream. Only
+//! fixed Huffman codes are used, which is the same trade off
+//! stb_image_write makes. Supports the same formats as ConvertToRGB8().
+//!
+//! @param outputFilename The name of the PNG file to be written.
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+Result ExportToPNG(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
+
+//! @brief Exports a 1D or 2D image as a PNG stream.
+//! @param outputStream The output stream where the PNG data will be written.
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+Result ExportToPNG(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
+
+//! @brief Exports a 1D or 2D image to a file, picking the file format
+//!        from the extension: .png, .qoi or PPM for anything else.
+//! @param outputFilename The name of the file to be written.
+//! @param inputFormat The input image format.
+//! @param texels An array of texels of size \b rowStride * \b height.
+//! @param width The width of the input image.
+//! @param height The height of the input image.
+//! @param rowStride The row stride, in bytes.
+Result ExportToFile(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride);
+
 } // namespace ppx
 
 #endif // ppm_export_h
@@ -18,12 +18,17 @@
 #include "ppx/config.h"
 #include "xxhash.h"
 
+#include <atomic>
+#include <filesystem>
+#include <unordered_map>
+
 namespace ppx {
 
 enum ProfilerEventType
 {
     PROFILER_EVENT_TYPE_UNDEFINED   = 0,
     PROFILER_EVENT_TYPE_GRFX_API_FN = 1,
+    PROFILER_EVENT_TYPE_CPU         = 2,
 };
 
 enum ProfileEventRecordAction
@@ -46,6 +51,62 @@ struct ProfilerEventSample
 
 // -------------------------------------------------------------------------------------------------
 
+//! @class ProfilerSampleRing
+//!
+//! Fixed capacity single producer, single consumer ring of samples. The
+//! owning thread pushes and a single draining thread pops, neither side
+//! takes a lock. Push() drops the sample instead of blocking when the
+//! ring is full.
+//!
+class ProfilerSampleRing
+{
+public:
+    struct Entry
+    {
+        ProfilerEventToken  token;
+        ProfilerEventSample sample;
+    };
+
+    static constexpr uint32_t kDefaultCapacity = 16384;
+
+    // capacity is rounded up to a power of two, the entries are allocated
+    // by the first Push()
+    ProfilerSampleRing(uint32_t capacity = kDefaultCapacity);
+    ~ProfilerSampleRing();
+
+    uint64_t GetCapacity() const { return mMask + 1; }
+    uint64_t GetDroppedCount() const { return mDroppedCount.load(std::memory_order_relaxed); }
+
+    // Producer thread only. Returns false if the ring is full.
+    bool Push(const ProfilerEventToken& token, const ProfilerEventSample& sample);
+
+    // Consumer thread only. Calls fn for every entry pushed so far and
+    // returns the number of entries drained.
+    template <typename Fn>
+    size_t Drain(Fn fn)
+    {
+        const uint64_t tail = mTail.load(std::memory_order_relaxed);
+        const uint64_t head = mHead.load(std::memory_order_acquire);
+        if (head == tail) {
+            return 0;
+        }
+        for (uint64_t i = tail; i < head; ++i) {
+            fn(mEntries[i & mMask]);
+        }
+        mTail.store(head, std::memory_order_release);
+        return static_cast<size_t>(head - tail);
+    }
+
+private:
+    std::unique_ptr<Entry[]>          mEntries;
+    uint64_t                          mMask = 0;
+    alignas(64) std::atomic<uint64_t> mHead{0};
+    alignas(64) std::atomic<uint64_t> mTail{0};
+    std::atomic<uint64_t>             mDroppedCount{0};
+};
+
+// -------------------------------------------------------------------------------------------------
+
 class ProfilerScopedEventSample
 {
 public:
@@ -68,12 +129,16 @@ public:
     ProfilerEventType                GetType() const { return mType; }
     const std::string&               GetName() const { return mName; }
     const ProfilerEventToken&        GetToken() const { return mToken; }
-    std::vector<ProfilerEventSample> GetSamples() const { return mSamples; }
+    std::vector<ProfilerEventSample> GetSamples() const;
     uint64_t                         GetSampleCount() const { return mSampleCount; }
     uint64_t                         GetSampleTotal() const { return mSampleTotal; }
     uint64_t                         GetSampleMin() const { return mSampleMin; }
     uint64_t                         GetSampleMax() const { return mSampleMax; }
 
+    // PROFILER_EVENT_RECORD_ACTION_INSERT keeps at most this many of the
+    // most recent samples.
+    static constexpr uint32_t kMaxInsertSamples = 4096;
+
     void RecordSample(const ProfilerEventSample& sample);
 
 private:
@@ -85,6 +150,7 @@ private:
     ProfileEventRecordAction         mAction;
     ProfilerEventToken               mToken = 0;
     std::vector<ProfilerEventSample> mSamples;                  // PROFILER_EVENT_RECORD_ACTION_INSERT
+    size_t                           mNextSample  = 0;          // PROFILER_EVENT_RECORD_ACTION_INSERT
     uint64_t                         mSampleCount = 0;          // PROFILER_EVENT_RECORD_ACTION_AVERAGE
     uint64_t                         mSampleTotal = 0;          // PROFILER_EVENT_RECORD_ACTION_AVERAGE
     uint64_t                         mSampleMin   = UINT64_MAX; // PROFILER_EVENT_RECORD_ACTION_AVERAGE
@@ -93,10 +159,30 @@ private:
 
 // -------------------------------------------------------------------------------------------------
 
+//! @class Profiler
+//!
+//! Each thread records into its own Profiler, so recording a sample never
+//! takes a lock. Events are registered for every thread's profiler, at
+//! most kMaxEventCount of them. Registration can happen while other
+//! threads record: a profiler's events never move and are published to
+//! its lookup table with atomic stores, so RecordSample() either finds a
+//! fully constructed event or drops the sample.
+//!
+//! A thread's profiler is handed to the next new thread once the thread
+//! exits, so GetProfilerForThread() may return a profiler with the same
+//! thread index as an exited thread.
+//!
+//! While a trace is active, every sample is also pushed into the
+//! thread's ProfilerSampleRing. A background thread drains the rings and
+//! writes the samples to a Chrome trace event JSON file, which can be
+//! opened in chrome://tracing or Perfetto.
+//!
 class Profiler
 {
 public:
-    Profiler();
+    static constexpr uint32_t kMaxEventCount = 1024;
+
+    Profiler(uint32_t threadIndex = 0);
     virtual ~Profiler();
 
     static void      ReinitializeGlobalVariables();
@@ -105,19 +191,47 @@ public:
     static Result RegisterEvent(ProfilerEventType type, const std::string& name, ProfileEventRecordAction recordAction, ProfilerEventToken* pToken);
     static Result RegisterGrfxApiFnEvent(const std::string& name, ProfilerEventToken* pToken);
 
+    // Unlike RegisterEvent, registering a name that's already registered
+    // returns the existing event's token.
+    static Result RegisterCpuEvent(const std::string& name, ProfilerEventToken* pToken);
+
+    // Starts writing samples from every thread to a Chrome trace event
+    // JSON file at path. Samples recorded while a ring is full are dropped
+    // and counted in the trace's metadata.
+    static Result StartTrace(const std::filesystem::path& path);
+    static void   StopTrace();
+    static bool   IsTracing();
+
     void RecordSample(const ProfilerEventToken& token, const ProfilerEventSample& sample);
 
     // Removed all previously registered events. It is not safe to call this function while
     // running code recording samples.
     void RemoveAllEvents();
 
+    uint32_t                          GetThreadIndex() const { return mThreadIndex; }
     const std::vector<ProfilerEvent>& GetEvents() const { return mEvents; }
+    ProfilerSampleRing&               GetSampleRing() { return mSampleRing; }
 
 private:
-    Result RegisterEventInternal(ProfilerEventType type, const std::string& name, ProfileEventRecordAction recordAction, ProfilerEventToken token);
+    Result         RegisterEventInternal(ProfilerEventType type, const std::string& name, ProfileEventRecordAction recordAction, ProfilerEventToken token);
+    ProfilerEvent* FindEvent(const ProfilerEventToken& token);
+    void           RemoveAllEventsLocked();
+
+    // Open addressing slot of the lookup table, empty while token is 0.
+    // index is written before token is published.
+    struct EventSlot
+    {
+        std::atomic<ProfilerEventToken> token{0};
+        uint32_t                        index = 0;
+    };
+
+    static constexpr uint32_t kEventSlotCount = 2 * kMaxEventCount;
 
 private:
-    std::vector<ProfilerEvent> mEvents;
+    uint32_t                     mThreadIndex = 0;
+    std::vector<ProfilerEvent>   mEvents; // Capacity reserved up front so events never move
+    std::unique_ptr<EventSlot[]> mEventSlots;
+    ProfilerSampleRing           mSampleRing;
 };
 
 } // namespace ppx
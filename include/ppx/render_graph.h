@@ -0,0 +1,327 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_render_graph_h
+#define ppx_render_graph_h
+
+#include "nlohmann/json.hpp"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_image.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ppx {
+
+class RenderGraph;
+
+typedef uint32_t                       RenderGraphResourceID;
+static constexpr RenderGraphResourceID kInvalidRenderGraphResourceID = UINT32_MAX;
+
+enum RenderGraphResourceType
+{
+    RENDER_GRAPH_RESOURCE_TYPE_IMAGE  = 0,
+    RENDER_GRAPH_RESOURCE_TYPE_BUFFER = 1,
+};
+
+//! @class RenderGraphContext
+//!
+//! Handed to a pass's execute function. Resources are only valid for
+//! the duration of the call: transient resources share memory with
+//! other transient resources outside of their lifetime.
+//!
+class RenderGraphContext
+{
+public:
+    grfx::CommandBuffer* GetCommandBuffer() const { return mCommandBuffer; }
+
+    // Null for passes without render targets or depth stencil
+    grfx::DrawPass* GetDrawPass() const { return mDrawPass; }
+
+    grfx::Image*  GetImage(RenderGraphResourceID id) const;
+    grfx::Buffer* GetBuffer(RenderGraphResourceID id) const;
+
+private:
+    friend class RenderGraph;
+
+    const RenderGraph*   mGraph         = nullptr;
+    grfx::CommandBuffer* mCommandBuffer = nullptr;
+    grfx::DrawPass*      mDrawPass      = nullptr;
+};
+
+using RenderGraphExecuteFn = std::function<void(const RenderGraphContext&)>;
+
+//! @class RenderGraphPassBuilder
+//!
+//! Declares what a pass accesses, returned by RenderGraph::AddPass().
+//! The state of an access is the state the resource must be in while
+//! the pass executes.
+//!
+class RenderGraphPassBuilder
+{
+public:
+    RenderGraphPassBuilder& Read(RenderGraphResourceID id, grfx::ResourceState state = grfx::RESOURCE_STATE_SHADER_RESOURCE);
+    RenderGraphPassBuilder& Write(RenderGraphResourceID id, grfx::ResourceState state = grfx::RESOURCE_STATE_UNORDERED_ACCESS);
+
+    // Render targets are bound in the order they're added. Passes with
+    // render targets or a depth stencil are recorded inside a render pass.
+    RenderGraphPassBuilder& AddRenderTarget(RenderGraphResourceID id, bool clear = false);
+
+    // A read only depth state makes the depth stencil a read.
+    RenderGraphPassBuilder& SetDepthStencil(RenderGraphResourceID id, bool clear = false, grfx::ResourceState state = grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE);
+
+    // Passes with side effects are never culled, e.g. passes that write
+    // to memory the graph doesn't know about or that read back queries.
+    RenderGraphPassBuilder& SetSideEffects();
+
+private:
+    friend class RenderGraph;
+
+    RenderGraphPassBuilder(RenderGraph* pGraph, uint32_t passIndex)
+        : mGraph(pGraph), mPassIndex(passIndex) {}
+
+    RenderGraph* mGraph     = nullptr;
+    uint32_t     mPassIndex = 0;
+};
+
+//! @struct RenderGraphBarrier
+//!
+//! A barrier Execute() records before a pass. Barriers whose states
+//! differ are recorded as transitions. Barriers whose states match only
+//! order memory accesses, e.g. between two writes in the same state or
+//! when a resource takes over aliased memory, and are recorded with
+//! ImageMemoryBarrier() or BufferMemoryBarrier().
+//!
+struct RenderGraphBarrier
+{
+    RenderGraphResourceID id          = kInvalidRenderGraphResourceID;
+    grfx::ResourceState   beforeState = grfx::RESOURCE_STATE_UNDEFINED;
+    grfx::ResourceState   afterState  = grfx::RESOURCE_STATE_UNDEFINED;
+
+    bool IsMemoryBarrier() const { return beforeState == afterState; }
+};
+
+//! @struct RenderGraphStats
+//!
+//! Memory sizes are estimates from the resource descriptions, drivers
+//! add alignment and metadata on top.
+//!
+//! transientBytes
+//!   - memory the transient resources would take with one allocation each
+//!
+//! allocatedBytes
+//!   - memory taken by the physical resources backing them
+//!
+struct RenderGraphStats
+{
+    uint32_t passCount              = 0;
+    uint32_t culledPassCount        = 0;
+    uint32_t barrierCount           = 0;
+    uint32_t transientResourceCount = 0;
+    uint32_t physicalResourceCount  = 0;
+    uint64_t transientBytes         = 0;
+    uint64_t allocatedBytes         = 0;
+
+    uint64_t GetAliasedBytes() const { return transientBytes - allocatedBytes; }
+};
+
+//! @class RenderGraph
+//!
+//! Records a frame from passes that declare the resources they read and
+//! write instead of hand written barriers and render pass begin/end.
+//!
+//! Usage:
+//!   1. Declare resources with CreateImage()/CreateBuffer() for resources
+//!      that only live within the graph, ImportImage()/ImportBuffer()
+//!      for resources that live outside of it (e.g. swapchain images).
+//!   2. Declare passes with AddPass() in submission order.
+//!   3. Compile() once, then Execute() every frame. Imported resources
+//!      that change every frame are rebound with SetImportedImage() or
+//!      SetImportedBuffer() before Execute().
+//!
+//! Compile() does the following:
+//!   - Culls passes that don't contribute to an imported resource or
+//!     to a pass with side effects.
+//!   - Computes the barriers each pass needs from the states of the
+//!     accesses declared before it.
+//!   - Aliases transient resources: resources whose lifetimes don't
+//!     overlap share one physical grfx::Image or grfx::Buffer. Images
+//!     alias when their descriptions only differ by usage, buffers when
+//!     their memory usage matches, the physical buffer takes the largest
+//!     size.
+//!
+//! Execute() leaves transient resources in the state they were created
+//! in and imported resources in their final state, so the compiled
+//! graph can be executed again the next frame. Transient resources also
+//! get a memory barrier at the end when their last or first access writes.
+//!
+//! A graph compiled without a device can't be executed, but can still be
+//! inspected with GetStats() and Export().
+//!
+//! Draw passes are cached per set of bound attachments, so a graph that
+//! renders into the swapchain keeps one draw pass per swapchain image and
+//! shares its transient images between all of them. The cache is keyed on
+//! the images' registry handles, so a recreated image never picks up a
+//! draw pass built over the one it replaced, and draw passes over images
+//! that have been destroyed are dropped the next time a pass misses.
+//!
+//! The passes themselves are fixed at Compile(): apps that switch
+//! techniques at runtime, like oit_demo, need one graph per technique.
+//! None of the samples are ported yet.
+//!
+//! The graph holds device objects: it must be Reset() before the device
+//! is destroyed.
+//!
+class RenderGraph
+{
+public:
+    RenderGraph() {}
+    virtual ~RenderGraph();
+
+    // Destroys device objects and clears all resources and passes.
+    void Reset();
+
+    RenderGraphResourceID CreateImage(const std::string& name, const grfx::ImageCreateInfo& createInfo);
+    RenderGraphResourceID CreateBuffer(const std::string& name, const grfx::BufferCreateInfo& createInfo);
+
+    // finalState is the state the resource is left in after Execute().
+    RenderGraphResourceID ImportImage(const std::string& name, grfx::Image* pImage, grfx::ResourceState initialState, grfx::ResourceState finalState);
+    RenderGraphResourceID ImportBuffer(const std::string& name, grfx::Buffer* pBuffer, grfx::ResourceState initialState, grfx::ResourceState finalState);
+
+    //! Binds another resource to an imported resource without compiling
+    //! again, e.g. the swapchain image acquired this frame. The resource
+    //! must have the same description as the one it was imported with and
+    //! be in the same initial state when Execute() is called.
+    Result SetImportedImage(RenderGraphResourceID id, grfx::Image* pImage);
+    Result SetImportedBuffer(RenderGraphResourceID id, grfx::Buffer* pBuffer);
+
+    RenderGraphPassBuilder AddPass(const std::string& name, RenderGraphExecuteFn fn);
+
+    //! Passing a null device only compiles the graph for inspection.
+    Result Compile(grfx::Device* pDevice);
+    bool   IsCompiled() const { return mCompiled; }
+
+    Result Execute(grfx::CommandBuffer* pCommandBuffer);
+
+    grfx::Image*  GetImage(RenderGraphResourceID id) const;
+    grfx::Buffer* GetBuffer(RenderGraphResourceID id) const;
+
+    const RenderGraphStats& GetStats() const { return mStats; }
+
+    // Results of Compile(), for tests and tools
+    bool                                   IsPassCulled(uint32_t passIndex) const;
+    uint32_t                               GetPhysicalResourceIndex(RenderGraphResourceID id) const;
+    const std::vector<RenderGraphBarrier>& GetPassBarriers(uint32_t passIndex) const;
+    const std::vector<RenderGraphBarrier>& GetFinalBarriers() const { return mFinalBarriers; }
+
+    //! Exports the compiled graph: resources with their lifetimes and
+    //! physical resource, passes with their accesses and barriers.
+    nlohmann::json Export() const;
+    Result         ExportToFile(const std::filesystem::path& path) const;
+
+private:
+    friend class RenderGraphPassBuilder;
+
+    struct Access
+    {
+        RenderGraphResourceID id    = kInvalidRenderGraphResourceID;
+        grfx::ResourceState   state = grfx::RESOURCE_STATE_UNDEFINED;
+        bool                  write = false;
+    };
+
+    using Barrier = RenderGraphBarrier;
+
+    struct Resource
+    {
+        std::string             name;
+        RenderGraphResourceType type = RENDER_GRAPH_RESOURCE_TYPE_IMAGE;
+        grfx::ImageCreateInfo   imageCreateInfo;
+        grfx::BufferCreateInfo  bufferCreateInfo;
+        uint64_t                size            = 0;
+        grfx::Image*            pImportedImage  = nullptr;
+        grfx::Buffer*           pImportedBuffer = nullptr;
+        grfx::ResourceState     initialState    = grfx::RESOURCE_STATE_UNDEFINED;
+        grfx::ResourceState     finalState      = grfx::RESOURCE_STATE_UNDEFINED;
+
+        // Compile results
+        uint32_t firstPass     = UINT32_MAX;
+        uint32_t lastPass      = 0;
+        uint32_t physicalIndex = UINT32_MAX;
+
+        bool IsImported() const { return (pImportedImage != nullptr) || (pImportedBuffer != nullptr); }
+        bool IsUsed() const { return firstPass != UINT32_MAX; }
+    };
+
+    // Draw pass over one set of bound attachment images
+    struct DrawPassEntry
+    {
+        std::vector<ppx::SlotHandle> attachments; // Registry handles of the images
+        grfx::DrawPassPtr            drawPass;
+    };
+
+    struct Pass
+    {
+        std::string                        name;
+        RenderGraphExecuteFn               fn;
+        std::vector<Access>                accesses;
+        std::vector<RenderGraphResourceID> renderTargets;
+        RenderGraphResourceID              depthStencil   = kInvalidRenderGraphResourceID;
+        grfx::DrawPassClearFlags           clearFlags     = 0;
+        bool                               hasSideEffects = false;
+        bool                               culled         = false;
+        std::vector<Barrier>               barriers;
+        std::vector<DrawPassEntry>         drawPasses;
+    };
+
+    // Transient resources aliased to the same memory
+    struct PhysicalResource
+    {
+        RenderGraphResourceType type = RENDER_GRAPH_RESOURCE_TYPE_IMAGE;
+        grfx::ImageCreateInfo   imageCreateInfo;
+        grfx::BufferCreateInfo  bufferCreateInfo;
+        grfx::ResourceState     initialState = grfx::RESOURCE_STATE_UNDEFINED;
+        uint64_t                size         = 0;
+        uint32_t                lastPass     = 0;
+        grfx::ImagePtr          image;
+        grfx::BufferPtr         buffer;
+    };
+
+    bool                  IsValidResource(RenderGraphResourceID id) const { return id < static_cast<RenderGraphResourceID>(mResources.size()); }
+    bool                  HasAttachments(const Pass& pass) const { return !pass.renderTargets.empty() || (pass.depthStencil != kInvalidRenderGraphResourceID); }
+    RenderGraphResourceID AddResource(Resource&& resource);
+    void                  AddAccess(uint32_t passIndex, RenderGraphResourceID id, grfx::ResourceState state, bool write);
+
+    void   CullPasses();
+    void   ComputeBarriers();
+    void   AliasResources();
+    Result CreateDeviceObjects(grfx::Device* pDevice);
+    Result GetDrawPass(Pass& pass, grfx::DrawPass** ppDrawPass);
+    void   DestroyDeviceObjects();
+    void   RecordBarriers(grfx::CommandBuffer* pCommandBuffer, const std::vector<Barrier>& barriers) const;
+
+private:
+    std::vector<Resource>         mResources;
+    std::vector<Pass>             mPasses;
+    std::vector<PhysicalResource> mPhysicalResources;
+    std::vector<Barrier>          mFinalBarriers;
+    grfx::Device*                 mDevice   = nullptr;
+    bool                          mCompiled = false;
+    RenderGraphStats              mStats    = {};
+};
+
+} // namespace ppx
+
+#endif // ppx_render_graph_h
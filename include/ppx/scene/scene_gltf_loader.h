@@ -0,0 +1,174 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_scene_gltf_loader_h
+#define ppx_scene_gltf_loader_h
+
+#include "ppx/scene/scene_config.h"
+#include "ppx/scene/scene_material.h"
+#include "ppx/scene/scene_mesh.h"
+#include "ppx/scene/scene_node.h"
+#include "ppx/scene/scene_resource_manager.h"
+#include "ppx/scene/scene_scene.h"
+
+struct cgltf_data;
+struct cgltf_image;
+struct cgltf_material;
+struct cgltf_mesh;
+struct cgltf_node;
+struct cgltf_sampler;
+struct cgltf_texture;
+struct cgltf_texture_view;
+
+namespace ppx {
+
+class ThreadPool;
+
+namespace scene {
+
+struct GltfLoadOptions
+{
+    // Number of worker threads used for image decoding, mesh building and
+    // node setup. If 0, std::thread::hardware_concurrency() is used.
+    uint32_t workerThreadCount = 0;
+
+    // Number of mip levels to generate for each image. Clamped to the
+    // maximum number of levels for the image's dimensions.
+    uint32_t mipLevelCount = PPX_REMAINING_MIP_LEVELS;
+
+    // Vertex attributes that every mesh must provide in addition to
+    // the ones required by its materials. Attributes missing from the
+    // source data are filled with default values.
+    scene::VertexAttributeFlags requiredVertexAttributes = scene::VertexAttributeFlags::None();
+
+    // Material factory used to create materials. If NULL, a default
+    // scene::MaterialFactory is used.
+    const scene::MaterialFactory* pMaterialFactory = nullptr;
+
+    // Upload queue that mesh and image copies are recorded into. If set,
+    // LoadScene() returns without waiting for the copies: flush
+    // pUploadQueue before submitting work that uses the scene. If NULL, a
+    // transient upload queue on the graphics queue is used and waited on
+    // before LoadScene() returns.
+    grfx::UploadQueue* pUploadQueue = nullptr;
+};
+
+// GLTF Loader
+//
+// Loads a scene::Scene from a GLTF or GLB file using cgltf.
+//
+// Loading is split in two phases:
+//   - CPU phase: images are decoded and mip mapped, mesh vertex and index
+//     data is built and nodes are created and transformed. This phase runs
+//     on a pool of worker threads.
+//   - GPU phase: grfx objects are created and data is uploaded. This phase
+//     runs on the calling thread since grfx::Device isn't thread safe.
+//     Mesh and image copies are recorded into a grfx::UploadQueue so they
+//     are submitted in batches instead of one blocking copy per object.
+//
+// Shared objects (images, samplers, textures, materials, mesh data and
+// meshes) are deduplicated through the scene's scene::ResourceManager
+// using the index of the source cgltf object as the object id.
+//
+class GltfLoader
+{
+public:
+    virtual ~GltfLoader();
+
+    // Parses filePath and loads its buffers. Caller owns *ppLoader and
+    // must delete it when done.
+    static ppx::Result Create(
+        const std::filesystem::path& filePath,
+        scene::GltfLoader**          ppLoader);
+
+    uint32_t GetSceneCount() const;
+    // Returns the GLTF default scene index or 0 if there isn't one.
+    uint32_t GetDefaultSceneIndex() const;
+
+    // Loads scene at sceneIndex. Caller owns *ppTargetScene.
+    ppx::Result LoadScene(
+        grfx::Device*                 pDevice,
+        uint32_t                      sceneIndex,
+        scene::Scene**                ppTargetScene,
+        const scene::GltfLoadOptions& loadOptions = scene::GltfLoadOptions());
+
+private:
+    GltfLoader(
+        const std::filesystem::path& filePath,
+        cgltf_data*                  pGltfData);
+
+    struct ImageData;
+    struct MeshDataBuild;
+    struct LoadContext;
+
+    uint64_t GetObjectId(const cgltf_image* pObject) const;
+    uint64_t GetObjectId(const cgltf_sampler* pObject) const;
+    uint64_t GetObjectId(const cgltf_texture* pObject) const;
+    uint64_t GetObjectId(const cgltf_material* pObject) const;
+    uint64_t GetObjectId(const cgltf_mesh* pObject) const;
+
+    // CPU phase
+    ppx::Result DecodeImage(
+        const cgltf_image* pGltfImage,
+        uint32_t           mipLevelCount,
+        ImageData*         pImageData) const;
+
+    ppx::Result BuildMeshData(
+        const cgltf_mesh*                  pGltfMesh,
+        const scene::VertexAttributeFlags& vertexAttributes,
+        MeshDataBuild*                     pBuild) const;
+
+    ppx::Result CreateNode(
+        const cgltf_node* pGltfNode,
+        scene::Scene*     pScene,
+        scene::NodeRef*   pNode) const;
+
+    // GPU phase
+    ppx::Result LoadSampler(
+        LoadContext&         context,
+        const cgltf_sampler* pGltfSampler,
+        scene::SamplerRef*   pSampler);
+
+    ppx::Result LoadTexture(
+        LoadContext&         context,
+        const cgltf_texture* pGltfTexture,
+        scene::TextureRef*   pTexture);
+
+    ppx::Result LoadTextureView(
+        LoadContext&              context,
+        const cgltf_texture_view& gltfTextureView,
+        scene::TextureView*       pTextureView);
+
+    ppx::Result LoadMaterial(
+        LoadContext&          context,
+        const cgltf_material* pGltfMaterial,
+        scene::MaterialRef*   pMaterial);
+
+    ppx::Result LoadMesh(
+        LoadContext&      context,
+        const cgltf_mesh* pGltfMesh,
+        scene::MeshRef*   pMesh);
+
+    std::string GetMaterialIdent(const cgltf_material* pGltfMaterial) const;
+
+private:
+    std::filesystem::path mFilePath;
+    std::filesystem::path mGltfFolder;
+    cgltf_data*           mGltfData = nullptr;
+};
+
+} // namespace scene
+} // namespace ppx
+
+#endif // ppx_scene_gltf_loader_h
@@ -0,0 +1,197 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_slot_map_h
+#define ppx_slot_map_h
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ppx {
+
+//! @typedef SlotHandle
+//!
+//! Identifies an element of a SlotMap. The low 32 bits are the slot index
+//! and the high 32 bits are the slot's generation. Generations start at 1
+//! so a handle of 0 is never valid.
+//!
+typedef uint64_t SlotHandle;
+
+//! @class SlotMap
+//!
+//! Unordered container with O(1) insert, erase and lookup by handle.
+//! Handles stay valid until their element is erased, after which they
+//! never match another element since erasing bumps the slot's generation.
+//!
+//! Elements are stored contiguously, erasing moves the last element into
+//! the erased element's place so iteration order isn't insertion order
+//! and iterators are invalidated by Insert() and Erase().
+//!
+template <typename T>
+class SlotMap
+{
+public:
+    using iterator       = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotMap() {}
+    ~SlotMap() {}
+
+    SlotHandle Insert(const T& value)
+    {
+        uint32_t index = 0;
+        if (mFreeHead != kInvalidIndex) {
+            index     = mFreeHead;
+            mFreeHead = mSlots[index].denseIndex;
+        }
+        else {
+            index = static_cast<uint32_t>(mSlots.size());
+            mSlots.push_back(Slot());
+        }
+
+        Slot& slot      = mSlots[index];
+        slot.denseIndex = static_cast<uint32_t>(mValues.size());
+        mValues.push_back(value);
+        mValueSlots.push_back(index);
+
+        return MakeHandle(index, slot.generation);
+    }
+
+    //! Returns false if handle doesn't refer to an element.
+    bool Erase(SlotHandle handle)
+    {
+        Slot* pSlot = FindSlot(handle);
+        if (pSlot == nullptr) {
+            return false;
+        }
+
+        // Move the last element into the erased element's place
+        const uint32_t denseIndex = pSlot->denseIndex;
+        const uint32_t lastIndex  = static_cast<uint32_t>(mValues.size() - 1);
+        if (denseIndex != lastIndex) {
+            mValues[denseIndex]                        = std::move(mValues[lastIndex]);
+            mValueSlots[denseIndex]                    = mValueSlots[lastIndex];
+            mSlots[mValueSlots[denseIndex]].denseIndex = denseIndex;
+        }
+        mValues.pop_back();
+        mValueSlots.pop_back();
+
+        // Skip 0 when the generation wraps so handles are never 0
+        pSlot->generation += 1;
+        if (pSlot->generation == 0) {
+            pSlot->generation = 1;
+        }
+        pSlot->denseIndex = mFreeHead;
+        mFreeHead         = GetIndex(handle);
+
+        return true;
+    }
+
+    //! Returns nullptr if handle doesn't refer to an element.
+    T* Get(SlotHandle handle)
+    {
+        Slot* pSlot = FindSlot(handle);
+        return (pSlot != nullptr) ? &mValues[pSlot->denseIndex] : nullptr;
+    }
+
+    const T* Get(SlotHandle handle) const
+    {
+        const Slot* pSlot = FindSlot(handle);
+        return (pSlot != nullptr) ? &mValues[pSlot->denseIndex] : nullptr;
+    }
+
+    bool Contains(SlotHandle handle) const { return FindSlot(handle) != nullptr; }
+
+    void clear()
+    {
+        // Erase one by one so that outstanding handles are invalidated
+        while (!mValueSlots.empty()) {
+            const uint32_t index = mValueSlots.back();
+            Erase(MakeHandle(index, mSlots[index].generation));
+        }
+    }
+
+    size_t size() const { return mValues.size(); }
+    bool   empty() const { return mValues.empty(); }
+
+    T&       operator[](size_t i) { return mValues[i]; }
+    const T& operator[](size_t i) const { return mValues[i]; }
+
+    T&       back() { return mValues.back(); }
+    const T& back() const { return mValues.back(); }
+
+    //! Handle of the i-th element in iteration order.
+    SlotHandle GetHandle(size_t i) const
+    {
+        const uint32_t index = mValueSlots[i];
+        return MakeHandle(index, mSlots[index].generation);
+    }
+
+    iterator       begin() { return mValues.begin(); }
+    iterator       end() { return mValues.end(); }
+    const_iterator begin() const { return mValues.begin(); }
+    const_iterator end() const { return mValues.end(); }
+
+private:
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    struct Slot
+    {
+        uint32_t denseIndex = kInvalidIndex; // Next free slot while the slot is free
+        uint32_t generation = 1;
+    };
+
+    static SlotHandle MakeHandle(uint32_t index, uint32_t generation)
+    {
+        return (static_cast<SlotHandle>(generation) << 32) | static_cast<SlotHandle>(index);
+    }
+
+    static uint32_t GetIndex(SlotHandle handle) { return static_cast<uint32_t>(handle & 0xFFFFFFFF); }
+    static uint32_t GetGeneration(SlotHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+
+    const Slot* FindSlot(SlotHandle handle) const
+    {
+        const uint32_t index = GetIndex(handle);
+        if (index >= mSlots.size()) {
+            return nullptr;
+        }
+        const Slot& slot = mSlots[index];
+        if ((slot.generation != GetGeneration(handle)) || (slot.denseIndex >= mValues.size())) {
+            return nullptr;
+        }
+        // A free slot's denseIndex is a slot index, make sure it points back
+        if (mValueSlots[slot.denseIndex] != index) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    Slot* FindSlot(SlotHandle handle)
+    {
+        return const_cast<Slot*>(static_cast<const SlotMap*>(this)->FindSlot(handle));
+    }
+
+private:
+    std::vector<T>        mValues;
+    std::vector<uint32_t> mValueSlots; // Slot index of each element in mValues
+    std::vector<Slot>     mSlots;
+    uint32_t              mFreeHead = kInvalidIndex;
+};
+
+} // namespace ppx
+
+#endif // ppx_slot_map_h
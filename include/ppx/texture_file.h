@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_texture_file_h
+#define ppx_texture_file_h
+
+#include "ppx/config.h"
+#include "ppx/fs.h"
+#include "ppx/grfx/grfx_format.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace ppx {
+
+enum TextureFileType
+{
+    TEXTURE_FILE_TYPE_UNKNOWN = 0,
+    TEXTURE_FILE_TYPE_DDS     = 1,
+    TEXTURE_FILE_TYPE_KTX     = 2,
+    TEXTURE_FILE_TYPE_KTX2    = 3,
+};
+
+//! @struct TextureFileLevel
+//!
+//! Location of one mip level in a texture file. Rows are rows of blocks
+//! for compressed formats and rows of texels otherwise.
+//!
+struct TextureFileLevel
+{
+    uint32_t width    = 0;
+    uint32_t height   = 0;
+    uint32_t rowCount = 0;
+    uint32_t rowSize  = 0; // [bytes]
+    uint64_t offset   = 0; // [bytes] from the start of the file
+    uint64_t size     = 0; // [bytes] rowCount * rowSize
+};
+
+//! @class TextureFile
+//!
+//! Reads the header and level layout of a DDS, KTX or KTX2 file without
+//! decoding it, so that levels can be uploaded in any order. Only 2D
+//! textures with a single array layer and face are supported, in the BC
+//! and 8-bit RGBA/BGRA formats. Supercompressed KTX2 files, which includes
+//! Basis Universal, are rejected.
+//!
+//! The file stays open, memory-mapped when fs::File supports it, until
+//! the TextureFile is destroyed. Level data is only read when it's
+//! accessed with GetLevelData().
+//!
+//! Level 0 must be a whole number of blocks. Smaller levels stop at the
+//! first one that isn't, the same way CreateImageFromCompressedImage() in
+//! graphics_util.cpp drops them.
+//!
+class TextureFile
+{
+public:
+    TextureFile() {}
+    ~TextureFile() {}
+
+    TextureFile(const TextureFile&)            = delete;
+    TextureFile& operator=(const TextureFile&) = delete;
+
+    Result Open(const std::filesystem::path& path);
+
+    //! pData must outlive the TextureFile.
+    Result OpenFromMemory(const void* pData, size_t size);
+
+    TextureFileType         GetType() const { return mType; }
+    grfx::Format            GetFormat() const { return mFormat; }
+    uint32_t                GetWidth() const { return mLevels.empty() ? 0 : mLevels[0].width; }
+    uint32_t                GetHeight() const { return mLevels.empty() ? 0 : mLevels[0].height; }
+    uint32_t                GetLevelCount() const { return CountU32(mLevels); }
+    const TextureFileLevel& GetLevel(uint32_t level) const { return mLevels[level]; }
+    const char*             GetLevelData(uint32_t level) const { return mpData + mLevels[level].offset; }
+
+    //! Returns true if path has a .dds, .ktx or .ktx2 extension.
+    static bool IsTextureFile(const std::filesystem::path& path);
+
+private:
+    Result Parse();
+    Result ParseDDS();
+    Result ParseKTX();
+    Result ParseKTX2();
+    Result AddLevel(uint32_t width, uint32_t height, uint64_t offset);
+
+private:
+    fs::File                      mFile;
+    std::vector<char>             mStorage; // File content if mFile isn't mapped
+    const char*                   mpData    = nullptr;
+    size_t                        mDataSize = 0;
+    TextureFileType               mType     = TEXTURE_FILE_TYPE_UNKNOWN;
+    grfx::Format                  mFormat   = grfx::FORMAT_UNDEFINED;
+    std::vector<TextureFileLevel> mLevels;
+};
+
+} // namespace ppx
+
+#endif // ppx_texture_file_h
@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_thread_pool_h
+#define ppx_thread_pool_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ppx {
+
+//! @class ThreadPool
+//!
+//! Fixed size pool of worker threads for CPU side work such as image
+//! decoding, mip generation and mesh building.
+//!
+//! Work can be queued as individual tasks with Submit() or split over
+//! an index range with ParallelFor(). The thread calling ParallelFor()
+//! also executes work items, so it's safe to call ParallelFor() from a
+//! task that is already running on the pool.
+//!
+//! ThreadPool knows nothing about grfx objects. Callers that create
+//! device objects must keep that part on a single thread.
+//!
+class ThreadPool
+{
+public:
+    // If threadCount is 0, std::thread::hardware_concurrency() is used.
+    ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+    // Queues task for execution on one of the worker threads.
+    void Submit(std::function<void()>&& task);
+
+    // Blocks until every task queued with Submit() has finished.
+    void WaitIdle();
+
+    // Calls fn(index) for every index in [0, count) and returns after
+    // all of the calls have finished.
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& fn);
+
+    // Returns a process wide pool sized to the hardware concurrency. The
+    // pool is created on first use.
+    static ThreadPool& GetDefault();
+
+    // Returns a pool without worker threads, Submit() and ParallelFor()
+    // run all of their work on the calling thread.
+    static std::unique_ptr<ThreadPool> CreateSerial();
+
+private:
+    struct SerialTag
+    {
+    };
+
+    explicit ThreadPool(SerialTag) {}
+
+    void WorkerMain();
+
+private:
+    std::vector<std::thread>          mWorkers;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex                        mMutex;
+    std::condition_variable           mTaskAvailable;
+    std::condition_variable           mIdle;
+    uint32_t                          mPendingCount = 0;
+    bool                              mStopping     = false;
+};
+
+} // namespace ppx
+
+#endif // ppx_thread_pool_h
@@ -106,6 +106,8 @@ public:
     TriMeshOptions& InvertTexCoordsV() { mInvertTexCoordsV = true; return *this; }
     //! Inverts winding order of ONLY indices
     TriMeshOptions& InvertWinding() { mInvertWinding = true; return *this; }
+    //! Enable/disable vertex welding for OBJ files, implies indices. Index type is picked from the welded vertex count.
+    TriMeshOptions& WeldVertices(bool value = true) { mWeldVertices = value; return *this; }
     // clang-format on
 private:
     bool   mEnableIndices      = false;
@@ -116,11 +118,13 @@ private:
     bool   mEnableObjectColor  = false;
     bool   mInvertTexCoordsV   = false;
     bool   mInvertWinding      = false;
+    bool   mWeldVertices       = false;
     float3 mObjectColor        = float3(0.7f);
     float3 mTranslate          = float3(0, 0, 0);
     float3 mScale              = float3(1, 1, 1);
     float2 mTexCoordScale      = float2(1, 1);
     friend class TriMesh;
+    friend class MeshCacheFile;
 };
 
 //! @class TriMesh
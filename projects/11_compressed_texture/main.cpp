@@ -65,9 +65,12 @@ private:
         ppx::grfx::ImagePtr            image;
         ppx::grfx::SamplerPtr          sampler;
         ppx::grfx::SampledImageViewPtr sampledImageView;
+        uint32_t                       viewMipLevel;
         float3                         homeLoc;
     };
 
+    void UpdateStreamedViews();
+
     std::vector<PerFrame>             mPerFrame;
     ppx::grfx::ShaderModulePtr        mVS;
     ppx::grfx::ShaderModulePtr        mPS;
@@ -78,6 +81,8 @@ private:
     ppx::grfx::DescriptorSetLayoutPtr mDescriptorSetLayout;
     grfx::VertexBinding               mVertexBinding;
     std::vector<TexturedShape>        mShapes;
+    ppx::grfx::UploadQueuePtr         mUploadQueue;
+    ppx::grfx::ImageStreamerPtr       mImageStreamer;
 };
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
@@ -91,6 +96,20 @@ void ProjApp::Config(ppx::ApplicationSettings& settings)
 
 void ProjApp::Setup()
 {
+    // Texture streaming
+    {
+        grfx::UploadQueueCreateInfo uploadQueueCreateInfo = {};
+        uploadQueueCreateInfo.pQueue                      = GetGraphicsQueue();
+        PPX_CHECKED_CALL(GetDevice()->CreateUploadQueue(&uploadQueueCreateInfo, &mUploadQueue));
+
+        grfx::ImageStreamerCreateInfo streamerCreateInfo = {};
+        streamerCreateInfo.pUploadQueue                  = mUploadQueue;
+        PPX_CHECKED_CALL(GetDevice()->CreateImageStreamer(&streamerCreateInfo, &mImageStreamer));
+    }
+
+    Timer timerTextureLoading;
+    timerTextureLoading.Start();
+
     // Uniform buffer
     int id = 1;
     for (const auto& texture : textures) {
@@ -105,10 +124,15 @@ void ProjApp::Setup()
 
         // Texture image, view, and sampler
         {
-            grfx_util::ImageOptions options = grfx_util::ImageOptions().MipLevelCount(PPX_REMAINING_MIP_LEVELS);
-            PPX_CHECKED_CALL(grfx_util::CreateImageFromFile(GetDevice()->GetGraphicsQueue(), GetAssetPath(texture.texturePath), &shape.image));
+            // The smallest levels are uploaded before this returns, the
+            // rest are streamed in by Render()
+            PPX_CHECKED_CALL(mImageStreamer->CreateImageFromFile(GetAssetPath(texture.texturePath), &shape.image));
+
+            shape.viewMipLevel = mImageStreamer->GetResidentMipLevel(shape.image);
 
             grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(shape.image);
+            viewCreateInfo.mipLevel                         = shape.viewMipLevel;
+            viewCreateInfo.mipLevelCount                    = shape.image->GetMipLevelCount() - shape.viewMipLevel;
             PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &shape.sampledImageView));
 
             grfx::SamplerCreateInfo samplerCreateInfo = {};
@@ -124,6 +148,8 @@ void ProjApp::Setup()
         shape.id      = id++;
         mShapes.push_back(shape);
     }
+    PPX_LOG_INFO("Time to first usable textures: " << timerTextureLoading.MillisSinceStart() << " ms, "
+                                                   << mImageStreamer->GetPendingBytes() << " bytes left to stream");
 
     // Descriptor
     {
@@ -287,6 +313,35 @@ void ProjApp::Setup()
     }
 }
 
+void ProjApp::UpdateStreamedViews()
+{
+    for (auto& shape : mShapes) {
+        const uint32_t mipLevel = mImageStreamer->GetResidentMipLevel(shape.image);
+        if (mipLevel == shape.viewMipLevel) {
+            continue;
+        }
+
+        GetDevice()->DestroySampledImageView(shape.sampledImageView);
+
+        grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(shape.image);
+        viewCreateInfo.mipLevel                         = mipLevel;
+        viewCreateInfo.mipLevelCount                    = shape.image->GetMipLevelCount() - mipLevel;
+        PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &shape.sampledImageView));
+
+        grfx::WriteDescriptor write = {};
+        write.binding               = 1;
+        write.type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.pImageView            = shape.sampledImageView;
+        PPX_CHECKED_CALL(shape.descriptorSet->UpdateDescriptors(1, &write));
+
+        shape.viewMipLevel = mipLevel;
+    }
+
+    if (mImageStreamer->GetStreamingImageCount() == 0) {
+        PPX_LOG_INFO("Textures fully resident after " << GetElapsedSeconds() << " s");
+    }
+}
+
 void ProjApp::Render()
 {
     PerFrame& frame = mPerFrame[0];
@@ -302,6 +357,12 @@ void ProjApp::Render()
     // Wait for and reset render complete fence
     PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
 
+    // Stream in more levels, the previous frame is done with the views
+    if (mImageStreamer->GetStreamingImageCount() > 0) {
+        PPX_CHECKED_CALL(mImageStreamer->Update());
+        UpdateStreamedViews();
+    }
+
     // Update uniform buffers.
     for (auto& shape : mShapes) {
         float    t   = GetElapsedSeconds();
@@ -49,15 +49,15 @@ private:
         grfx::QueryPtr         timestampQuery;
     };
 
-    std::vector<PerFrame>      mPerFrame;
-    grfx::DescriptorPoolPtr    mDescriptorPool;
-    grfx::ShaderModulePtr      mVS;
-    grfx::ShaderModulePtr      mPS;
-    grfx::PipelineInterfacePtr mPipelineInterface;
-    grfx::GraphicsPipelinePtr  mPipeline;
-    grfx::BufferPtr            mVertexBuffer;
-    grfx::BufferPtr            mUniformBuffer;
-    grfx::VertexBinding        mVertexBinding;
+    std::vector<PerFrame>           mPerFrame;
+    grfx::DescriptorSetAllocatorPtr mDescriptorAllocator;
+    grfx::ShaderModulePtr           mVS;
+    grfx::ShaderModulePtr           mPS;
+    grfx::PipelineInterfacePtr      mPipelineInterface;
+    grfx::GraphicsPipelinePtr       mPipeline;
+    grfx::BufferPtr                 mVertexBuffer;
+    grfx::BufferPtr                 mUniformBuffer;
+    grfx::VertexBinding             mVertexBinding;
 
     // Compute shader
     std::string                  mShaderFile;
@@ -94,7 +94,7 @@ private:
     void SetupComputeShaderPass();
 
     float4x4 calculateTransform(float2 imgSize);
-    void     changeImages();
+    void     allocateDescriptorSets();
 };
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
@@ -109,15 +109,13 @@ void ProjApp::Config(ppx::ApplicationSettings& settings)
 
 void ProjApp::Setup()
 {
-    // Create descriptor pool (for both pipelines)
+    // Descriptor sets are allocated every frame, for both pipelines
     {
-        grfx::DescriptorPoolCreateInfo createInfo = {};
-        createInfo.sampler                        = 2;
-        createInfo.sampledImage                   = 2;
-        createInfo.uniformBuffer                  = 2;
-        createInfo.storageImage                   = 1;
+        grfx::DescriptorSetAllocatorCreateInfo createInfo = {};
+        createInfo.frameCount                             = GetNumFramesInFlight();
+        createInfo.setsPerPool                            = 8;
 
-        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorPool(&createInfo, &mDescriptorPool));
+        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetAllocator(&createInfo, &mDescriptorAllocator));
     }
 
     // To filter the image
@@ -227,34 +225,6 @@ void ProjApp::SetupComputeShaderPass()
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(3, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE));
 
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mComputeDescriptorSetLayout));
-
-        PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mComputeDescriptorSetLayout, &mComputeDescriptorSet));
-
-        grfx::WriteDescriptor write = {};
-        write.binding               = 0;
-        write.type                  = grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        write.pImageView            = mStorageImageViews[mImageOption];
-        PPX_CHECKED_CALL(mComputeDescriptorSet->UpdateDescriptors(1, &write));
-
-        write              = {};
-        write.binding      = 1;
-        write.type         = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write.bufferOffset = 0;
-        write.bufferRange  = PPX_WHOLE_SIZE;
-        write.pBuffer      = mComputeUniformBuffer;
-        PPX_CHECKED_CALL(mComputeDescriptorSet->UpdateDescriptors(1, &write));
-
-        write          = {};
-        write.binding  = 2;
-        write.type     = grfx::DESCRIPTOR_TYPE_SAMPLER;
-        write.pSampler = mComputeSampler;
-        PPX_CHECKED_CALL(mComputeDescriptorSet->UpdateDescriptors(1, &write));
-
-        write            = {};
-        write.binding    = 3;
-        write.type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        write.pImageView = mSampledImageViews[mImageOption];
-        PPX_CHECKED_CALL(mComputeDescriptorSet->UpdateDescriptors(1, &write));
     }
 
     // Compute pipeline
@@ -307,35 +277,13 @@ void ProjApp::SetupDrawToSwapchain()
         PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mUniformBuffer));
     }
 
-    // Descriptors
+    // Descriptor set layout
     {
-        // Descriptor set layout
         grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(0, grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER));
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(1, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE));
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(2, grfx::DESCRIPTOR_TYPE_SAMPLER));
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mDrawToSwapchainLayout));
-
-        // Allocate descriptor set
-        PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mDrawToSwapchainLayout, &mDrawToSwapchainSet));
-
-        grfx::WriteDescriptor writes[3] = {};
-        writes[0].binding               = 0;
-        writes[0].type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writes[0].bufferOffset          = 0;
-        writes[0].bufferRange           = PPX_WHOLE_SIZE;
-        writes[0].pBuffer               = mUniformBuffer;
-
-        writes[1].binding    = 1;
-        writes[1].arrayIndex = 0;
-        writes[1].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[1].pImageView = mPresentImageViews[mImageOption];
-
-        writes[2].binding  = 2;
-        writes[2].type     = grfx::DESCRIPTOR_TYPE_SAMPLER;
-        writes[2].pSampler = mSampler;
-
-        PPX_CHECKED_CALL(mDrawToSwapchainSet->UpdateDescriptors(3, writes));
     }
 
     // Pipeline
@@ -434,7 +382,9 @@ void ProjApp::Render()
     // Reset queries
     frame.timestampQuery->Reset(0, 2);
 
-    changeImages();
+    // The GPU is done with the sets this frame used last time
+    mDescriptorAllocator->BeginFrame(GetInFlightFrameIndex());
+    allocateDescriptorSets();
 
     // Update Compute uniform buffer
     {
@@ -564,33 +514,51 @@ float4x4 ProjApp::calculateTransform(float2 imgSize)
     return P * V * M;
 }
 
-void ProjApp::changeImages()
+void ProjApp::allocateDescriptorSets()
 {
-    // Update compute descriptors
+    // Sets are only written when the selected image changes, otherwise the
+    // allocator hands back the set it wrote for that image before
     {
-        grfx::WriteDescriptor writes[2] = {};
+        grfx::WriteDescriptor writes[4] = {};
+        writes[0].binding               = 0;
+        writes[0].type                  = grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[0].pImageView            = mStorageImageViews[mImageOption];
 
-        writes[0].binding    = 0;
-        writes[0].type       = grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        writes[0].pImageView = mStorageImageViews[mImageOption];
+        writes[1].binding      = 1;
+        writes[1].type         = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[1].bufferOffset = 0;
+        writes[1].bufferRange  = PPX_WHOLE_SIZE;
+        writes[1].pBuffer      = mComputeUniformBuffer;
 
-        writes[1]            = {};
-        writes[1].binding    = 3;
-        writes[1].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[1].pImageView = mSampledImageViews[mImageOption];
+        writes[2].binding  = 2;
+        writes[2].type     = grfx::DESCRIPTOR_TYPE_SAMPLER;
+        writes[2].pSampler = mComputeSampler;
 
-        PPX_CHECKED_CALL(mComputeDescriptorSet->UpdateDescriptors(2, writes));
+        writes[3].binding    = 3;
+        writes[3].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        writes[3].pImageView = mSampledImageViews[mImageOption];
+
+        PPX_CHECKED_CALL(mDescriptorAllocator->Allocate(mComputeDescriptorSetLayout, 4, writes, &mComputeDescriptorSet));
     }
 
-    // Update present descriptor
     {
-        grfx::WriteDescriptor write = {};
-        write.binding               = 1;
-        write.arrayIndex            = 0;
-        write.type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        write.pImageView            = mPresentImageViews[mImageOption];
+        grfx::WriteDescriptor writes[3] = {};
+        writes[0].binding               = 0;
+        writes[0].type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[0].bufferOffset          = 0;
+        writes[0].bufferRange           = PPX_WHOLE_SIZE;
+        writes[0].pBuffer               = mUniformBuffer;
+
+        writes[1].binding    = 1;
+        writes[1].arrayIndex = 0;
+        writes[1].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        writes[1].pImageView = mPresentImageViews[mImageOption];
+
+        writes[2].binding  = 2;
+        writes[2].type     = grfx::DESCRIPTOR_TYPE_SAMPLER;
+        writes[2].pSampler = mSampler;
 
-        PPX_CHECKED_CALL(mDrawToSwapchainSet->UpdateDescriptors(1, &write));
+        PPX_CHECKED_CALL(mDescriptorAllocator->Allocate(mDrawToSwapchainLayout, 3, writes, &mDrawToSwapchainSet));
     }
 }
 
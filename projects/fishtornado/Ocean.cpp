@@ -63,7 +63,7 @@ void Ocean::Setup(uint32_t numFramesInFlight)
         mFloorForwardPipeline = pApp->CreateForwardPipeline("fishtornado/shaders", "OceanFloor.vs", "OceanFloor.ps");
 
         TriMeshOptions options = TriMeshOptions().Indices().AllAttributes().TexCoordScale(float2(25.0f));
-        PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/ocean/floor_lowRes.obj"), &mFloorMesh, options));
+        PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/ocean/floor_lowRes.obj"), &mFloorMesh, options, /* useMeshCache= */ true));
 
         grfx_util::TextureOptions textureOptions = grfx_util::TextureOptions().MipLevelCount(PPX_REMAINING_MIP_LEVELS);
         PPX_CHECKED_CALL(grfx_util::CreateTextureFromFile(queue, pApp->GetAssetPath("fishtornado/textures/ocean/floorDiffuse.png"), &mFloorAlbedoTexture, textureOptions));
@@ -146,7 +146,7 @@ void Ocean::Setup(uint32_t numFramesInFlight)
         }
 
         TriMeshOptions options = TriMeshOptions().Indices().Normals().TexCoords();
-        PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/ocean/beams.obj"), &mBeamMesh, options));
+        PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/ocean/beams.obj"), &mBeamMesh, options, /* useMeshCache= */ true));
     }
 }
 
@@ -287,7 +287,7 @@ void Flocking::Setup(uint32_t numFramesInFlight, const FishTornadoSettings& sett
 
     // Create model
     TriMeshOptions options = TriMeshOptions().Indices().AllAttributes().InvertTexCoordsV().InvertWinding();
-    PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/trevallie/trevallie.obj"), &mMesh, options));
+    PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/trevallie/trevallie.obj"), &mMesh, options, /* useMeshCache= */ true));
 
     // Create textures
 #if defined(PPX_D3D12)
@@ -50,7 +50,7 @@ void Shark::Setup(uint32_t numFramesInFlight)
     mShadowPipeline  = pApp->CreateShadowPipeline("fishtornado/shaders", "SharkShadow.vs");
 
     TriMeshOptions options = TriMeshOptions().Indices().AllAttributes().InvertTexCoordsV().InvertWinding();
-    PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/shark/shark.obj"), &mMesh, options));
+    PPX_CHECKED_CALL(grfx_util::CreateMeshFromFile(queue, pApp->GetAssetPath("fishtornado/models/shark/shark.obj"), &mMesh, options, /* useMeshCache= */ true));
 
     grfx_util::TextureOptions textureOptions = grfx_util::TextureOptions().MipLevelCount(PPX_REMAINING_MIP_LEVELS);
     PPX_CHECKED_CALL(grfx_util::CreateTextureFromFile(queue, pApp->GetAssetPath("fishtornado/textures/shark/sharkDiffuse.png"), &mAlbedoTexture, textureOptions));
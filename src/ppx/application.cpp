@@ -352,6 +352,9 @@ Result Application::InitializeGrfxDevice()
         ci.vulkanExtensions       = {};
         ci.pVulkanDeviceFeatures  = nullptr;
         ci.supportShadingRateMode = mSettings.grfx.device.supportShadingRateMode;
+        if (!mSettings.grfx.device.pipelineCacheFile.empty()) {
+            ci.pipelineCachePath = fs::GetDefaultOutputDirectory() / mSettings.grfx.device.pipelineCacheFile;
+        }
 #if defined(PPX_BUILD_XR)
         ci.pXrComponent = mSettings.xr.enable ? &mXrComponent : nullptr;
 #endif
@@ -496,7 +499,8 @@ Result Application::CreateSwapchains()
         ci.colorFormat               = mSettings.grfx.swapchain.colorFormat;
         ci.depthFormat               = mSettings.grfx.swapchain.depthFormat;
         ci.imageCount                = mSettings.grfx.swapchain.imageCount;
-        ci.presentMode               = grfx::PRESENT_MODE_IMMEDIATE;
+        ci.presentMode               = mSettings.headless ? mSettings.grfx.swapchain.headlessPresentMode : grfx::PRESENT_MODE_IMMEDIATE;
+        ci.headlessRefreshRate       = mSettings.grfx.swapchain.headlessRefreshRate;
 
         grfx::SwapchainPtr swapchain;
         Result             ppxres = mDevice->CreateSwapchain(&ci, &swapchain);
@@ -580,6 +584,12 @@ void Application::StopGrfx()
     if (mDevice) {
         mDevice->WaitIdle();
     }
+    // Finish writing screenshots before the device goes away
+    if (mFrameCapture) {
+        mFrameCapture->WaitIdle();
+        mDevice->DestroyFrameCapture(mFrameCapture);
+        mFrameCapture.Reset();
+    }
 }
 
 void Application::ShutdownGrfx()
@@ -705,6 +715,7 @@ void Application::DispatchScroll(float dx, float dy)
 
 void Application::DispatchRender()
 {
+    ProfilerScopedEventSample sample(mRenderEventToken);
     Render();
 }
 
@@ -796,6 +807,16 @@ void Application::InitStandardKnobs()
         "Shutdown the application after successfully rendering N frames. "
         "If 0, this is disabled.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pFramePacingPolicy, "frame-pacing-policy", "catch-up");
+    mStandardOpts.pFramePacingPolicy->SetFlagDescription(
+        "What frame pacing does after a frame misses its deadline. `catch-up` "
+        "keeps the schedule and runs the late frames back to back, `skip` "
+        "moves the schedule to the next frame slot. See also `--paced-frame-rate`.");
+    mStandardOpts.pFramePacingPolicy->SetFlagParameters("<catch-up|skip>");
+    mStandardOpts.pFramePacingPolicy->SetValidator([](const std::string& res) {
+        return res == "catch-up" || res == "skip";
+    });
+
     GetKnobManager().InitKnob(&mStandardOpts.pGpuIndex, "gpu", mSettings.standardKnobsDefaultValue.gpuIndex, 0, UINT_MAX);
     mStandardOpts.pGpuIndex->SetFlagDescription(
         "Select the gpu with the given index. To determine the set of valid "
@@ -807,11 +828,33 @@ void Application::InitStandardKnobs()
         "Run the sample without creating windows.");
 #endif
 
+    GetKnobManager().InitKnob(&mStandardOpts.pHeadlessPresentMode, "headless-present-mode", mSettings.standardKnobsDefaultValue.headlessPresentMode);
+    mStandardOpts.pHeadlessPresentMode->SetFlagDescription(
+        "Present mode emulated by the headless swapchain. `immediate` never "
+        "waits, `fifo` and `mailbox` pace acquiring images to the virtual "
+        "refresh rate set with `--headless-refresh-rate`, using the swapchain "
+        "image count as the number of virtual images.");
+    mStandardOpts.pHeadlessPresentMode->SetFlagParameters("<immediate|fifo|mailbox>");
+    mStandardOpts.pHeadlessPresentMode->SetValidator([](const std::string& res) {
+        return res == "immediate" || res == "fifo" || res == "mailbox";
+    });
+
+    GetKnobManager().InitKnob(&mStandardOpts.pHeadlessRefreshRate, "headless-refresh-rate", mSettings.standardKnobsDefaultValue.headlessRefreshRate, 1, 1000);
+    mStandardOpts.pHeadlessRefreshRate->SetFlagDescription(
+        "Virtual refresh rate in Hz of the headless swapchain for "
+        "`--headless-present-mode` fifo and mailbox.");
+
     GetKnobManager().InitKnob(&mStandardOpts.pListGpus, "list-gpus", mSettings.standardKnobsDefaultValue.listGpus);
     mStandardOpts.pListGpus->SetFlagDescription(
         "Prints a list of the available GPUs on the current system with their "
         "index and exits. See also `--gpu`.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pLogAsync, "log-async", mSettings.standardKnobsDefaultValue.logAsync);
+    mStandardOpts.pLogAsync->SetFlagDescription(
+        "Write log messages from a background thread instead of the logging "
+        "thread. Messages are dropped if a thread logs faster than they can be "
+        "written, errors are never dropped.");
+
     GetKnobManager().InitKnob(&mStandardOpts.pMetricsFilename, "metrics-filename", mSettings.standardKnobsDefaultValue.metricsFilename);
     mStandardOpts.pMetricsFilename->SetFlagDescription(
         "If metrics are enabled, save the metrics report to the "
@@ -820,12 +863,24 @@ void Application::InitStandardKnobs()
         "If not a full path, will be defined relative to the default "
         "output directory. See also `--enable-metrics` and `--overwrite-metrics-file`.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pMetricsStreaming, "metrics-streaming", mSettings.standardKnobsDefaultValue.metricsStreaming);
+    mStandardOpts.pMetricsStreaming->SetFlagDescription(
+        "Only applies if metrics are enabled with `--enable-metrics`. "
+        "Record gauges with bounded memory: percentiles are estimated and the "
+        "time series is downsampled. Recommended for long runs.");
+
     GetKnobManager().InitKnob(&mStandardOpts.pOverwriteMetricsFile, "overwrite-metrics-file", mSettings.standardKnobsDefaultValue.overwriteMetricsFile);
     mStandardOpts.pOverwriteMetricsFile->SetFlagDescription(
         "Only applies if metrics are enabled with `--enable-metrics`. "
         "If an existing file at the path set with `--metrics-filename` is found, it will be overwritten. "
         "See also: `--enable-metrics` and `--metrics-filename`.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pPacedFrameRate, "paced-frame-rate", mSettings.grfx.pacedFrameRate, 0, UINT_MAX);
+    mStandardOpts.pPacedFrameRate->SetFlagDescription(
+        "Hold the main loop to N frames per second, sleeping then spinning "
+        "until each frame's deadline. If metrics are enabled, deadline misses, "
+        "pacing error and idle time are recorded. If 0, this is disabled.");
+
     GetKnobManager().InitKnob(&mStandardOpts.pResolution, "resolution", mSettings.standardKnobsDefaultValue.resolution);
     mStandardOpts.pResolution->SetFlagDescription(
         "Specify the main window resolution in pixels. Width and Height must be "
@@ -846,9 +901,17 @@ void Application::InitStandardKnobs()
 
     GetKnobManager().InitKnob(&mStandardOpts.pScreenshotFrameNumber, "screenshot-frame-number", mSettings.standardKnobsDefaultValue.screenshotFrameNumber, -1, INT_MAX);
     mStandardOpts.pScreenshotFrameNumber->SetFlagDescription(
-        "Take a screenshot of frame number N and save it in PPM format. See also "
+        "Take a screenshot of frame number N and save it in PPM format, or in PNG "
+        "or QOI format if `--screenshot-path` ends in .png or .qoi. See also "
         "`--screenshot-path`.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pScreenshotFrameInterval, "screenshot-frame-interval", mSettings.standardKnobsDefaultValue.screenshotFrameInterval, 0, INT_MAX);
+    mStandardOpts.pScreenshotFrameInterval->SetFlagDescription(
+        "Take a screenshot every N frames, starting at `--screenshot-frame-number` "
+        "or at frame 0 if that isn't set. Screenshots are written by worker "
+        "threads, so the `--screenshot-path` filename must contain a `#`. "
+        "If 0, only `--screenshot-frame-number` is captured.");
+
     GetKnobManager().InitKnob(&mStandardOpts.pScreenshotPath, "screenshot-path", mSettings.standardKnobsDefaultValue.screenshotPath);
     mStandardOpts.pScreenshotPath->SetFlagDescription(
         "Save the screenshot to this path. If used, any `#` symbols in the filename "
@@ -862,6 +925,14 @@ void Application::InitStandardKnobs()
         "Calculate frame statistics over the last N frames only. If 0, "
         "all frames since the beginning of the application will be used.");
 
+    GetKnobManager().InitKnob(&mStandardOpts.pTraceFilename, "trace-file", mSettings.standardKnobsDefaultValue.traceFilename);
+    mStandardOpts.pTraceFilename->SetFlagDescription(
+        "Write a Chrome trace event JSON file of the profiled CPU scopes and "
+        "graphics API calls, which can be opened in chrome://tracing or Perfetto. "
+        "If not a full path, will be defined relative to the default output directory. "
+        "If empty, this is disabled.");
+    mStandardOpts.pTraceFilename->SetFlagParameters("<path>");
+
     GetKnobManager().InitKnob(&mStandardOpts.pUseSoftwareRenderer, "use-software-renderer", mSettings.standardKnobsDefaultValue.useSoftwareRenderer);
     mStandardOpts.pUseSoftwareRenderer->SetFlagDescription(
         "Use a software renderer instead of a hardware device, if available.");
@@ -902,68 +973,29 @@ void Application::TakeScreenshot()
     std::filesystem::path screenshotPath;
     screenshotPath = ppx::fs::GetFullPath(mStandardOpts.pScreenshotPath->GetValue(), ppx::fs::GetDefaultOutputDirectory(), "#", std::to_string(mFrameCount));
 
-    auto swapchainImg = GetSwapchain()->GetColorImage(GetSwapchain()->GetCurrentImageIndex());
-    auto queue        = mDevice->GetGraphicsQueue();
-
-    const grfx::FormatDesc* formatDesc = grfx::GetFormatDescription(swapchainImg->GetFormat());
-    const uint32_t          width      = swapchainImg->GetWidth();
-    const uint32_t          height     = swapchainImg->GetHeight();
-
-    // Create a buffer that will hold the swapchain image's texels.
-    // Increase its size by a factor of 2 to ensure that a larger-than-needed
-    // row pitch will not overflow the buffer.
-    uint64_t bufferSize = 2ull * formatDesc->bytesPerTexel * width * height;
-
-    grfx::BufferPtr        screenshotBuf = nullptr;
-    grfx::BufferCreateInfo bufferCi      = {};
-    bufferCi.size                        = bufferSize;
-    bufferCi.initialState                = grfx::RESOURCE_STATE_COPY_DST;
-    bufferCi.usageFlags.bits.transferDst = 1;
-    bufferCi.memoryUsage                 = grfx::MEMORY_USAGE_GPU_TO_CPU;
-    PPX_CHECKED_CALL(mDevice->CreateBuffer(&bufferCi, &screenshotBuf));
-
-    // We wait for idle so that we can avoid tracking swapchain fences.
-    // It's not ideal, but we won't be taking screenshots in
-    // performance-critical scenarios.
-    PPX_CHECKED_CALL(queue->WaitIdle());
-
-    // Copy the swapchain image into the buffer.
-    grfx::CommandBufferPtr cmdBuf;
-    PPX_CHECKED_CALL(queue->CreateCommandBuffer(&cmdBuf, 0, 0));
-
-    grfx::ImageToBufferOutputPitch outPitch;
-    cmdBuf->Begin();
-    {
-        cmdBuf->TransitionImageLayout(swapchainImg, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_COPY_SRC);
-
-        grfx::ImageToBufferCopyInfo bufCopyInfo = {};
-        bufCopyInfo.extent                      = {width, height, 0};
-        outPitch                                = cmdBuf->CopyImageToBuffer(&bufCopyInfo, swapchainImg, screenshotBuf);
-
-        cmdBuf->TransitionImageLayout(swapchainImg, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_COPY_SRC, grfx::RESOURCE_STATE_PRESENT);
+    // The copy is submitted after this frame's work on the graphics queue
+    // and tracked with a fence, so there's no need to wait for idle.
+    if (!mFrameCapture) {
+        grfx::FrameCaptureCreateInfo createInfo = {};
+        createInfo.pQueue                       = mDevice->GetGraphicsQueue();
+        createInfo.slotCount                    = mSettings.grfx.numFramesInFlight + 1;
+        PPX_CHECKED_CALL(mDevice->CreateFrameCapture(&createInfo, &mFrameCapture));
     }
-    cmdBuf->End();
-
-    grfx::SubmitInfo submitInfo   = {};
-    submitInfo.commandBufferCount = 1;
-    submitInfo.ppCommandBuffers   = &cmdBuf;
-    queue->Submit(&submitInfo);
-
-    // Wait for the copy to be finished.
-    queue->WaitIdle();
-
-    // Export to PPM.
-    unsigned char* texels = nullptr;
-    screenshotBuf->MapMemory(0, (void**)&texels);
-
-    PPX_CHECKED_CALL(ExportToPPM(screenshotPath.string(), swapchainImg->GetFormat(), texels, width, height, outPitch.rowPitch));
-    PPX_LOG_INFO("Screenshot of frame " << mFrameCount << " saved to: " << screenshotPath.string());
 
-    screenshotBuf->UnmapMemory();
+    auto swapchainImg = GetSwapchain()->GetColorImage(GetSwapchain()->GetCurrentImageIndex());
+    PPX_CHECKED_CALL(mFrameCapture->Capture(swapchainImg, grfx::RESOURCE_STATE_PRESENT, screenshotPath.string()));
+}
 
-    // Clean up temporary resources.
-    mDevice->DestroyBuffer(screenshotBuf);
-    queue->DestroyCommandBuffer(cmdBuf);
+bool Application::IsScreenshotFrame() const
+{
+    const int64_t frameNumber = mStandardOpts.pScreenshotFrameNumber->GetValue();
+    const int64_t interval    = mStandardOpts.pScreenshotFrameInterval->GetValue();
+    const int64_t frame       = static_cast<int64_t>(mFrameCount);
+    if (interval <= 0) {
+        return frame == frameNumber;
+    }
+    const int64_t firstFrame = std::max<int64_t>(frameNumber, 0);
+    return (frame >= firstFrame) && (((frame - firstFrame) % interval) == 0);
 }
 
 void Application::MoveCallback(int32_t x, int32_t y)
@@ -1144,6 +1176,18 @@ void Application::UpdateStandardSettings()
         PPX_LOG_WARN("Headless or deterministic mode: disabling ImGui");
     }
 
+    const std::string headlessPresentModeString = mStandardOpts.pHeadlessPresentMode->GetValue();
+    if (headlessPresentModeString == "fifo") {
+        mSettings.grfx.swapchain.headlessPresentMode = grfx::PRESENT_MODE_FIFO;
+    }
+    else if (headlessPresentModeString == "mailbox") {
+        mSettings.grfx.swapchain.headlessPresentMode = grfx::PRESENT_MODE_MAILBOX;
+    }
+    else {
+        mSettings.grfx.swapchain.headlessPresentMode = grfx::PRESENT_MODE_IMMEDIATE;
+    }
+    mSettings.grfx.swapchain.headlessRefreshRate = mStandardOpts.pHeadlessRefreshRate->GetValue();
+
     std::string shadingRateModeString = mStandardOpts.pShadingRateMode->GetValue();
     if (shadingRateModeString == "none") {
         mSettings.grfx.device.supportShadingRateMode = grfx::SHADING_RATE_NONE;
@@ -1356,10 +1400,13 @@ void Application::MainLoop()
         }
         RenderFrame();
 
-        // Take screenshot if this is the requested frame.
-        if (mFrameCount == static_cast<uint64_t>(mStandardOpts.pScreenshotFrameNumber->GetValue())) {
+        // Take screenshot if this is a requested frame.
+        if (IsScreenshotFrame()) {
             TakeScreenshot();
         }
+        if (mFrameCapture) {
+            mFrameCapture->Poll();
+        }
 
         // Frame end general metrics data, used for recorded metrics, display, screenshots, and pacing.
         double nowMs       = mTimer.MillisSinceStart();
@@ -1386,19 +1433,8 @@ void Application::MainLoop()
         DispatchUpdateMetrics();
 
         // Pace frames - if needed
-        if (mSettings.grfx.pacedFrameRate > 0) {
-            if (mFrameCount > 0) {
-                double currentTime  = nowMs / 1000.f;
-                double pacedFPS     = 1.0 / static_cast<double>(mSettings.grfx.pacedFrameRate);
-                double expectedTime = mFirstFrameTime + (mFrameCount * pacedFPS);
-                double diff         = expectedTime - currentTime;
-                if (diff > 0) {
-                    Timer::SleepSeconds(diff);
-                }
-            }
-            else {
-                mFirstFrameTime = nowMs / 1000.f;
-            }
+        if (mFramePacer.IsEnabled()) {
+            RecordFramePacingMetrics(mFramePacer.Wait());
         }
         // If we reach the maximum number of frames allowed
         if ((mStandardOpts.pFrameCount->GetValue() > 0 && mFrameCount >= mStandardOpts.pFrameCount->GetValue()) ||
@@ -1457,6 +1493,29 @@ int Application::Run(int argc, char** argv)
 
     mDecoratedApiName = ToString(mSettings.grfx.api);
 
+    if (mStandardOpts.pLogAsync->GetValue()) {
+        Log::SetAsync(true);
+    }
+
+    // Start tracing before the device is created so that startup shows up
+    Profiler::RegisterCpuEvent("Application::Render", &mRenderEventToken);
+    if (!mStandardOpts.pTraceFilename->GetValue().empty()) {
+        std::filesystem::path tracePath = ppx::fs::GetFullPath(mStandardOpts.pTraceFilename->GetValue(), ppx::fs::GetDefaultOutputDirectory());
+        if (Failed(Profiler::StartTrace(tracePath))) {
+            PPX_LOG_WARN("failed starting profiler trace: " << tracePath);
+        }
+    }
+
+    // Interval screenshots are written concurrently by worker threads, so
+    // each one needs its own file
+    if (mStandardOpts.pScreenshotFrameInterval->GetValue() > 0) {
+        const std::filesystem::path screenshotPath = mStandardOpts.pScreenshotPath->GetValue();
+        if (screenshotPath.filename().string().find('#') == std::string::npos) {
+            PPX_LOG_ERROR("--screenshot-frame-interval requires a # in the --screenshot-path filename: " << screenshotPath);
+            return EXIT_FAILURE;
+        }
+    }
+
     // Initialize the window
     Result ppxres = InitializeWindow();
     if (Failed(ppxres)) {
@@ -1468,6 +1527,13 @@ int Application::Run(int argc, char** argv)
         mRunTimeSeconds = std::numeric_limits<float>::max();
     }
 
+    {
+        FramePacerCreateInfo createInfo = {};
+        createInfo.frameRate            = mStandardOpts.pPacedFrameRate->GetValue();
+        createInfo.missPolicy           = (mStandardOpts.pFramePacingPolicy->GetValue() == "skip") ? FRAME_PACER_MISS_POLICY_SKIP : FRAME_PACER_MISS_POLICY_CATCH_UP;
+        mFramePacer.Reset(createInfo);
+    }
+
     // Initialize the platform
     ppxres = InitializePlatform();
     if (Failed(ppxres)) {
@@ -1571,6 +1637,9 @@ int Application::Run(int argc, char** argv)
     // Destroy window
     DestroyPlatformWindow();
 
+    Profiler::StopTrace();
+    Log::SetAsync(false);
+
     // Success
     return EXIT_SUCCESS;
 }
@@ -1675,6 +1744,24 @@ std::vector<char> Application::LoadShader(const std::filesystem::path& baseDir,
 
 Result Application::CreateShader(const std::filesystem::path& baseDir, const std::filesystem::path& baseName, grfx::ShaderModule** ppShaderModule) const
 {
+    // Create the module straight from the mapped file when possible, the
+    // bytecode is only read once so there's no need for a copy.
+    auto suffix = GetShaderPathSuffix(mSettings, baseName);
+    if (suffix.has_value()) {
+        const auto filePath = GetAssetPath(baseDir / suffix.value());
+        fs::File   file;
+        if (file.Open(filePath) && file.IsMapped()) {
+            grfx::ShaderModuleCreateInfo shaderCreateInfo = {static_cast<uint32_t>(file.GetLength()), static_cast<const char*>(file.GetMappedData())};
+            Result                       ppxres           = GetDevice()->CreateShaderModule(&shaderCreateInfo, ppShaderModule);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+
+            PPX_LOG_INFO("Loaded shader from " << filePath);
+            return ppx::SUCCESS;
+        }
+    }
+
     std::vector<char> bytecode = LoadShader(baseDir, baseName);
     if (bytecode.empty()) {
         return ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE;
@@ -1747,6 +1834,7 @@ void Application::StartMetricsRun(const std::string& name)
         metadata.name                    = "cpu_frame_time";
         metadata.unit                    = "ms";
         metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+        metadata.gaugeMode               = GetGaugeMode();
         mMetrics.cpuFrameTimeId          = mMetrics.manager.AddMetric(metadata);
         PPX_ASSERT_MSG(mMetrics.cpuFrameTimeId != metrics::kInvalidMetricID, "Failed to create frame time metric");
     }
@@ -1756,6 +1844,7 @@ void Application::StartMetricsRun(const std::string& name)
         metadata.name                    = "framerate";
         metadata.unit                    = "";
         metadata.interpretation          = metrics::MetricInterpretation::HIGHER_IS_BETTER;
+        metadata.gaugeMode               = GetGaugeMode();
         mMetrics.framerateId             = mMetrics.manager.AddMetric(metadata);
         PPX_ASSERT_MSG(mMetrics.framerateId != metrics::kInvalidMetricID, "Failed to create framerate metric");
     }
@@ -1768,6 +1857,107 @@ void Application::StartMetricsRun(const std::string& name)
         mMetrics.frameCountId            = mMetrics.manager.AddMetric(metadata);
         PPX_ASSERT_MSG(mMetrics.frameCountId != metrics::kInvalidMetricID, "Failed to create frame count metric");
     }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::COUNTER;
+        metadata.name                    = "pipeline_cache_hits";
+        metadata.unit                    = "";
+        metadata.interpretation          = metrics::MetricInterpretation::NONE;
+        mMetrics.pipelineCacheHitsId     = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.pipelineCacheHitsId != metrics::kInvalidMetricID, "Failed to create pipeline cache hits metric");
+    }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::COUNTER;
+        metadata.name                    = "pipeline_cache_misses";
+        metadata.unit                    = "";
+        metadata.interpretation          = metrics::MetricInterpretation::NONE;
+        mMetrics.pipelineCacheMissesId   = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.pipelineCacheMissesId != metrics::kInvalidMetricID, "Failed to create pipeline cache misses metric");
+    }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::COUNTER;
+        metadata.name                    = "staging_bytes";
+        metadata.unit                    = "bytes";
+        metadata.interpretation          = metrics::MetricInterpretation::NONE;
+        mMetrics.stagingBytesId          = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.stagingBytesId != metrics::kInvalidMetricID, "Failed to create staging bytes metric");
+    }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::COUNTER;
+        metadata.name                    = "staging_stalls";
+        metadata.unit                    = "";
+        metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+        mMetrics.stagingStallsId         = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.stagingStallsId != metrics::kInvalidMetricID, "Failed to create staging stalls metric");
+    }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::GAUGE;
+        metadata.name                    = "staging_stall_time";
+        metadata.unit                    = "ms";
+        metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+        metadata.gaugeMode               = GetGaugeMode();
+        mMetrics.stagingStallTimeId      = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.stagingStallTimeId != metrics::kInvalidMetricID, "Failed to create staging stall time metric");
+    }
+    {
+        metrics::MetricMetadata metadata = {};
+        metadata.type                    = metrics::MetricType::COUNTER;
+        metadata.name                    = "staging_ring_grows";
+        metadata.unit                    = "";
+        metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+        mMetrics.stagingGrowsId          = mMetrics.manager.AddMetric(metadata);
+        PPX_ASSERT_MSG(mMetrics.stagingGrowsId != metrics::kInvalidMetricID, "Failed to create staging ring grows metric");
+    }
+
+    if (mFramePacer.IsEnabled()) {
+        {
+            metrics::MetricMetadata metadata = {};
+            metadata.type                    = metrics::MetricType::GAUGE;
+            metadata.name                    = "frame_pacing_error";
+            metadata.unit                    = "ms";
+            metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+            metadata.gaugeMode               = GetGaugeMode();
+            mMetrics.framePacingErrorId      = mMetrics.manager.AddMetric(metadata);
+            PPX_ASSERT_MSG(mMetrics.framePacingErrorId != metrics::kInvalidMetricID, "Failed to create frame pacing error metric");
+        }
+        {
+            metrics::MetricMetadata metadata = {};
+            metadata.type                    = metrics::MetricType::GAUGE;
+            metadata.name                    = "frame_pacing_idle_time";
+            metadata.unit                    = "ms";
+            metadata.interpretation          = metrics::MetricInterpretation::NONE;
+            metadata.gaugeMode               = GetGaugeMode();
+            mMetrics.framePacingIdleId       = mMetrics.manager.AddMetric(metadata);
+            PPX_ASSERT_MSG(mMetrics.framePacingIdleId != metrics::kInvalidMetricID, "Failed to create frame pacing idle time metric");
+        }
+        {
+            metrics::MetricMetadata metadata = {};
+            metadata.type                    = metrics::MetricType::GAUGE;
+            metadata.name                    = "frame_pacing_spin_time";
+            metadata.unit                    = "ms";
+            metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+            metadata.gaugeMode               = GetGaugeMode();
+            mMetrics.framePacingSpinId       = mMetrics.manager.AddMetric(metadata);
+            PPX_ASSERT_MSG(mMetrics.framePacingSpinId != metrics::kInvalidMetricID, "Failed to create frame pacing spin time metric");
+        }
+        {
+            metrics::MetricMetadata metadata = {};
+            metadata.type                    = metrics::MetricType::COUNTER;
+            metadata.name                    = "frame_pacing_deadline_misses";
+            metadata.unit                    = "";
+            metadata.interpretation          = metrics::MetricInterpretation::LOWER_IS_BETTER;
+            mMetrics.framePacingMissesId     = mMetrics.manager.AddMetric(metadata);
+            PPX_ASSERT_MSG(mMetrics.framePacingMissesId != metrics::kInvalidMetricID, "Failed to create frame pacing deadline misses metric");
+        }
+    }
+
+    // Only count pipelines created during the run
+    mMetrics.pipelineCacheStats = mDevice ? mDevice->GetPipelineCacheStats() : grfx::PipelineCacheStats{};
+    mMetrics.stagingRingStats   = mDevice ? mDevice->GetStagingRingStats() : grfx::StagingRingStats{};
 
     mMetrics.resetFramerateTracking = true;
 }
@@ -1786,6 +1976,19 @@ void Application::StopMetricsRun()
     mMetrics.cpuFrameTimeId = metrics::kInvalidMetricID;
     mMetrics.framerateId    = metrics::kInvalidMetricID;
     mMetrics.frameCountId   = metrics::kInvalidMetricID;
+
+    mMetrics.pipelineCacheHitsId   = metrics::kInvalidMetricID;
+    mMetrics.pipelineCacheMissesId = metrics::kInvalidMetricID;
+
+    mMetrics.stagingBytesId     = metrics::kInvalidMetricID;
+    mMetrics.stagingStallsId    = metrics::kInvalidMetricID;
+    mMetrics.stagingStallTimeId = metrics::kInvalidMetricID;
+    mMetrics.stagingGrowsId     = metrics::kInvalidMetricID;
+
+    mMetrics.framePacingErrorId  = metrics::kInvalidMetricID;
+    mMetrics.framePacingIdleId   = metrics::kInvalidMetricID;
+    mMetrics.framePacingSpinId   = metrics::kInvalidMetricID;
+    mMetrics.framePacingMissesId = metrics::kInvalidMetricID;
 }
 
 bool Application::HasActiveMetricsRun() const
@@ -1800,10 +2003,22 @@ metrics::MetricID Application::AddMetric(const metrics::MetricMetadata& metadata
         return metrics::kInvalidMetricID;
     }
 
+    // --metrics-streaming only upgrades gauges, it never turns streaming off
+    if ((metadata.type == metrics::MetricType::GAUGE) && (metadata.gaugeMode == metrics::GaugeMode::EXACT)) {
+        metrics::MetricMetadata streamingMetadata = metadata;
+        streamingMetadata.gaugeMode               = GetGaugeMode();
+        return mMetrics.manager.AddMetric(streamingMetadata);
+    }
+
     // This function already covers all other cases.
     return mMetrics.manager.AddMetric(metadata);
 }
 
+metrics::GaugeMode Application::GetGaugeMode() const
+{
+    return mStandardOpts.pMetricsStreaming->GetValue() ? metrics::GaugeMode::STREAMING : metrics::GaugeMode::EXACT;
+}
+
 bool Application::RecordMetricData(metrics::MetricID id, const metrics::MetricData& data)
 {
     if (!mStandardOpts.pEnableMetrics->GetValue()) {
@@ -1863,6 +2078,50 @@ void Application::UpdateAppMetrics()
     mMetrics.manager.RecordMetricData(mMetrics.cpuFrameTimeId, frameTimeData);
     mMetrics.manager.RecordMetricData(mMetrics.frameCountId, frameCountData);
 
+    // Record pipelines created since the last update
+    if (mDevice) {
+        const grfx::PipelineCacheStats stats = mDevice->GetPipelineCacheStats();
+        if (stats.hitCount > mMetrics.pipelineCacheStats.hitCount) {
+            metrics::MetricData data = {metrics::MetricType::COUNTER};
+            data.counter.increment   = stats.hitCount - mMetrics.pipelineCacheStats.hitCount;
+            mMetrics.manager.RecordMetricData(mMetrics.pipelineCacheHitsId, data);
+        }
+        if (stats.missCount > mMetrics.pipelineCacheStats.missCount) {
+            metrics::MetricData data = {metrics::MetricType::COUNTER};
+            data.counter.increment   = stats.missCount - mMetrics.pipelineCacheStats.missCount;
+            mMetrics.manager.RecordMetricData(mMetrics.pipelineCacheMissesId, data);
+        }
+        mMetrics.pipelineCacheStats = stats;
+    }
+
+    // Record staging ring use since the last update
+    if (mDevice) {
+        const grfx::StagingRingStats  stats    = mDevice->GetStagingRingStats();
+        const grfx::StagingRingStats& previous = mMetrics.stagingRingStats;
+        if (stats.bytesStaged > previous.bytesStaged) {
+            metrics::MetricData data = {metrics::MetricType::COUNTER};
+            data.counter.increment   = stats.bytesStaged - previous.bytesStaged;
+            mMetrics.manager.RecordMetricData(mMetrics.stagingBytesId, data);
+        }
+        if (stats.stallCount > previous.stallCount) {
+            metrics::MetricData data = {metrics::MetricType::COUNTER};
+            data.counter.increment   = stats.stallCount - previous.stallCount;
+            mMetrics.manager.RecordMetricData(mMetrics.stagingStallsId, data);
+        }
+        if (stats.growCount > previous.growCount) {
+            metrics::MetricData data = {metrics::MetricType::COUNTER};
+            data.counter.increment   = stats.growCount - previous.growCount;
+            mMetrics.manager.RecordMetricData(mMetrics.stagingGrowsId, data);
+        }
+
+        metrics::MetricData stallTimeData = {metrics::MetricType::GAUGE};
+        stallTimeData.gauge.seconds       = seconds;
+        stallTimeData.gauge.value         = stats.stallMillis - previous.stallMillis;
+        mMetrics.manager.RecordMetricData(mMetrics.stagingStallTimeId, stallTimeData);
+
+        mMetrics.stagingRingStats = stats;
+    }
+
     // Record the average framerate over a given period of time
     if (mMetrics.resetFramerateTracking) {
         // Start tracking time
@@ -1887,6 +2146,37 @@ void Application::UpdateAppMetrics()
     }
 }
 
+void Application::RecordFramePacingMetrics(const FramePacerFrameStats& stats)
+{
+    // The first frame only starts the schedule
+    if (!HasActiveMetricsRun() || (stats.frameIndex == 0)) {
+        return;
+    }
+
+    const double seconds = GetElapsedSeconds();
+
+    metrics::MetricData errorData = {metrics::MetricType::GAUGE};
+    errorData.gauge.seconds       = seconds;
+    errorData.gauge.value         = std::abs(stats.GetPacingError()) * 1000.0;
+    mMetrics.manager.RecordMetricData(mMetrics.framePacingErrorId, errorData);
+
+    metrics::MetricData idleData = {metrics::MetricType::GAUGE};
+    idleData.gauge.seconds       = seconds;
+    idleData.gauge.value         = stats.sleepSeconds * 1000.0;
+    mMetrics.manager.RecordMetricData(mMetrics.framePacingIdleId, idleData);
+
+    metrics::MetricData spinData = {metrics::MetricType::GAUGE};
+    spinData.gauge.seconds       = seconds;
+    spinData.gauge.value         = stats.spinSeconds * 1000.0;
+    mMetrics.manager.RecordMetricData(mMetrics.framePacingSpinId, spinData);
+
+    if (stats.missed) {
+        metrics::MetricData missData = {metrics::MetricType::COUNTER};
+        missData.counter.increment   = 1;
+        mMetrics.manager.RecordMetricData(mMetrics.framePacingMissesId, missData);
+    }
+}
+
 void Application::DrawDebugInfo()
 {
     if (!mImGui) {
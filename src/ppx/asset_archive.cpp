@@ -0,0 +1,528 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/asset_archive.h"
+
+#include "xxhash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ppx {
+
+// -------------------------------------------------------------------------------------------------
+// LZ4 block format
+// -------------------------------------------------------------------------------------------------
+//
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// Greedy single-probe compressor: it's meant for packing assets offline,
+// the format only matters for decompression speed.
+//
+namespace {
+
+constexpr size_t   kLz4MinMatch     = 4;
+constexpr size_t   kLz4LastLiterals = 5;
+constexpr size_t   kLz4MatchLimit   = 12; // The last match must start at least this far from the end
+constexpr size_t   kLz4MaxOffset    = 65535;
+constexpr uint32_t kLz4HashLog      = 16;
+constexpr uint64_t kLz4MaxExpansion = 255; // Each stored byte decodes to at most this many bytes
+
+inline uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t Lz4Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kLz4HashLog);
+}
+
+void Lz4WriteLength(size_t length, std::vector<char>* pDst)
+{
+    while (length >= 255) {
+        pDst->push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    pDst->push_back(static_cast<char>(length));
+}
+
+void Lz4WriteSequence(const uint8_t* pLiterals, size_t literalCount, size_t offset, size_t matchLength, std::vector<char>* pDst)
+{
+    const size_t literalToken = std::min<size_t>(literalCount, 15);
+    const size_t matchToken   = (matchLength > 0) ? std::min<size_t>(matchLength - kLz4MinMatch, 15) : 0;
+    pDst->push_back(static_cast<char>((literalToken << 4) | matchToken));
+    if (literalToken == 15) {
+        Lz4WriteLength(literalCount - 15, pDst);
+    }
+    pDst->insert(pDst->end(), pLiterals, pLiterals + literalCount);
+
+    // The last sequence only has literals
+    if (matchLength == 0) {
+        return;
+    }
+    pDst->push_back(static_cast<char>(offset & 0xFF));
+    pDst->push_back(static_cast<char>(offset >> 8));
+    if (matchToken == 15) {
+        Lz4WriteLength(matchLength - kLz4MinMatch - 15, pDst);
+    }
+}
+
+} // namespace
+
+size_t Lz4CompressBlock(const void* pSrc, size_t srcSize, std::vector<char>* pDst)
+{
+    const uint8_t* src       = static_cast<const uint8_t*>(pSrc);
+    const size_t   startSize = pDst->size();
+
+    // Positions are stored + 1 so that 0 means empty
+    std::vector<uint32_t> table(size_t(1) << kLz4HashLog, 0);
+
+    size_t anchor = 0;
+    size_t pos    = 0;
+    if (srcSize > kLz4MatchLimit) {
+        const size_t matchStartLimit = srcSize - kLz4MatchLimit;
+        const size_t matchEndLimit   = srcSize - kLz4LastLiterals;
+        while (pos < matchStartLimit) {
+            const uint32_t sequence  = Read32(src + pos);
+            const uint32_t hash      = Lz4Hash(sequence);
+            const size_t   candidate = table[hash];
+            table[hash]              = static_cast<uint32_t>(pos + 1);
+
+            if ((candidate == 0) || ((pos - (candidate - 1)) > kLz4MaxOffset) || (Read32(src + candidate - 1) != sequence)) {
+                ++pos;
+                continue;
+            }
+
+            const size_t matchPos    = candidate - 1;
+            size_t       matchLength = kLz4MinMatch;
+            while (((pos + matchLength) < matchEndLimit) && (src[matchPos + matchLength] == src[pos + matchLength])) {
+                ++matchLength;
+            }
+
+            Lz4WriteSequence(src + anchor, pos - anchor, pos - matchPos, matchLength, pDst);
+            pos += matchLength;
+            anchor = pos;
+        }
+    }
+    Lz4WriteSequence(src + anchor, srcSize - anchor, 0, 0, pDst);
+
+    return pDst->size() - startSize;
+}
+
+bool Lz4DecompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize)
+{
+    const uint8_t* src    = static_cast<const uint8_t*>(pSrc);
+    const uint8_t* srcEnd = src + srcSize;
+    uint8_t*       dst    = static_cast<uint8_t*>(pDst);
+    size_t         out    = 0;
+
+    auto readLength = [&](size_t length, size_t* pLength) -> bool {
+        if (length != 15) {
+            *pLength = length;
+            return true;
+        }
+        uint8_t byte = 0;
+        do {
+            if (src == srcEnd) {
+                return false;
+            }
+            byte = *src++;
+            length += byte;
+        } while (byte == 255);
+        *pLength = length;
+        return true;
+    };
+
+    while (src < srcEnd) {
+        const uint8_t token = *src++;
+
+        size_t literalCount = 0;
+        if (!readLength(token >> 4, &literalCount)) {
+            return false;
+        }
+        if ((literalCount > static_cast<size_t>(srcEnd - src)) || (literalCount > (dstSize - out))) {
+            return false;
+        }
+        memcpy(dst + out, src, literalCount);
+        src += literalCount;
+        out += literalCount;
+
+        // Last sequence
+        if (src == srcEnd) {
+            break;
+        }
+
+        if ((srcEnd - src) < 2) {
+            return false;
+        }
+        const size_t offset = static_cast<size_t>(src[0]) | (static_cast<size_t>(src[1]) << 8);
+        src += 2;
+        if ((offset == 0) || (offset > out)) {
+            return false;
+        }
+
+        size_t matchLength = 0;
+        if (!readLength(token & 0xF, &matchLength)) {
+            return false;
+        }
+        matchLength += kLz4MinMatch;
+        if (matchLength > (dstSize - out)) {
+            return false;
+        }
+
+        // Matches may overlap the bytes they produce
+        const uint8_t* match = dst + out - offset;
+        if (offset >= matchLength) {
+            memcpy(dst + out, match, matchLength);
+        }
+        else {
+            for (size_t i = 0; i < matchLength; ++i) {
+                dst[out + i] = match[i];
+            }
+        }
+        out += matchLength;
+    }
+
+    return out == dstSize;
+}
+
+// -------------------------------------------------------------------------------------------------
+// AssetArchive
+// -------------------------------------------------------------------------------------------------
+namespace {
+
+bool EntryLess(const AssetArchiveEntry& entry, uint64_t hash)
+{
+    return entry.nameHash < hash;
+}
+
+} // namespace
+
+bool AssetArchive::IsLexicallyNormal(std::string_view path)
+{
+    if (path.empty() || (path.back() == '/') || (path.find('\\') != std::string_view::npos)) {
+        return false;
+    }
+    // Check each component
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        std::string_view component = path.substr(start, end - start);
+        // An empty first component is the root of an absolute path
+        if ((component.empty() && (start > 0)) || (component == ".") || (component == "..")) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+std::string AssetArchive::NormalizeName(const std::filesystem::path& name)
+{
+    // Backslashes aren't separators on POSIX, but names are shared across platforms
+    std::string generic = name.generic_string();
+    if (IsLexicallyNormal(generic) && (generic.front() != '/')) {
+        return generic;
+    }
+    std::replace(generic.begin(), generic.end(), '\\', '/');
+
+    std::string normalized = std::filesystem::path(generic).lexically_normal().generic_string();
+    while (!normalized.empty() && (normalized.front() == '/')) {
+        normalized.erase(0, 1);
+    }
+    while (!normalized.empty() && (normalized.back() == '/')) {
+        normalized.pop_back();
+    }
+    return (normalized == ".") ? std::string() : normalized;
+}
+
+uint64_t AssetArchive::HashName(std::string_view normalizedName)
+{
+    return XXH64(normalizedName.data(), normalizedName.size(), 0);
+}
+
+bool AssetArchive::IsArchive(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    std::ifstream is(path, std::ios::binary);
+    char          magic[sizeof(kAssetArchiveMagic)] = {};
+    if (!is.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return memcmp(magic, kAssetArchiveMagic, sizeof(magic)) == 0;
+}
+
+Result AssetArchive::Open(const std::filesystem::path& path)
+{
+    if (!mFile.Open(path, fs::FILE_ACCESS_HINT_RANDOM)) {
+        return ppx::ERROR_ASSET_ARCHIVE_OPEN_FAILED;
+    }
+
+    if (mFile.IsMapped()) {
+        mpData = static_cast<const char*>(mFile.GetMappedData());
+    }
+    else {
+        mStorage.resize(mFile.GetLength());
+        if (mFile.Read(mStorage.data(), mStorage.size()) != mStorage.size()) {
+            return ppx::ERROR_ASSET_ARCHIVE_OPEN_FAILED;
+        }
+        mpData = mStorage.data();
+    }
+    mDataSize = mFile.GetLength();
+    mPath     = path;
+
+    Result ppxres = Validate();
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("Invalid asset archive: " << path);
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result AssetArchive::Validate()
+{
+    if (mDataSize < sizeof(AssetArchiveHeader)) {
+        return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+    }
+
+    AssetArchiveHeader header = {};
+    memcpy(&header, mpData, sizeof(header));
+    if ((memcmp(header.magic, kAssetArchiveMagic, sizeof(header.magic)) != 0) || (header.version != kAssetArchiveVersion)) {
+        return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+    }
+
+    // The index is read in place so it needs to be aligned
+    const uint64_t indexSize = static_cast<uint64_t>(header.entryCount) * sizeof(AssetArchiveEntry);
+    if (((header.indexOffset % alignof(AssetArchiveEntry)) != 0) ||
+        (header.indexOffset > mDataSize) || (indexSize > (mDataSize - header.indexOffset)) ||
+        (header.namesOffset > mDataSize) || (header.namesSize > (mDataSize - header.namesOffset))) {
+        return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+    }
+
+    mEntries    = reinterpret_cast<const AssetArchiveEntry*>(mpData + header.indexOffset);
+    mEntryCount = header.entryCount;
+    mpNames     = mpData + header.namesOffset;
+    mNamesSize  = header.namesSize;
+
+    // Check every range once here so lookups don't have to
+    for (uint32_t i = 0; i < mEntryCount; ++i) {
+        const AssetArchiveEntry& entry = mEntries[i];
+        if ((entry.dataOffset > mDataSize) || (entry.storedSize > (mDataSize - entry.dataOffset)) ||
+            (entry.nameOffset > mNamesSize) || (entry.nameLength > (mNamesSize - entry.nameOffset))) {
+            return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+        }
+        if ((entry.compression == ASSET_COMPRESSION_NONE) && (entry.storedSize != entry.size)) {
+            return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+        }
+        if ((entry.compression != ASSET_COMPRESSION_NONE) && (entry.compression != ASSET_COMPRESSION_LZ4)) {
+            return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+        }
+        // ReadEntry() allocates the decompressed size up front, so don't
+        // trust one the stored data can't possibly expand to
+        if ((entry.compression == ASSET_COMPRESSION_LZ4) && (entry.size > (entry.storedSize * kLz4MaxExpansion))) {
+            return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+        }
+        if ((i > 0) && (mEntries[i - 1].nameHash > entry.nameHash)) {
+            return ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+std::string_view AssetArchive::GetEntryName(const AssetArchiveEntry& entry) const
+{
+    return std::string_view(mpNames + entry.nameOffset, entry.nameLength);
+}
+
+const AssetArchiveEntry* AssetArchive::FindEntry(const std::filesystem::path& name) const
+{
+    const std::string normalizedName = NormalizeName(name);
+    return FindEntry(std::string_view(normalizedName));
+}
+
+const AssetArchiveEntry* AssetArchive::FindEntry(std::string_view normalizedName) const
+{
+    const uint64_t           hash  = HashName(normalizedName);
+    const AssetArchiveEntry* pEnd  = mEntries + mEntryCount;
+    const AssetArchiveEntry* pIter = std::lower_bound(mEntries, pEnd, hash, EntryLess);
+    for (; (pIter != pEnd) && (pIter->nameHash == hash); ++pIter) {
+        if (GetEntryName(*pIter) == normalizedName) {
+            return pIter;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetArchive::ContainsDirectory(std::string_view normalizedName) const
+{
+    // The archive root
+    if (normalizedName.empty()) {
+        return true;
+    }
+
+    // Directories aren't indexed, they're only looked up for GetAssetPath("subdir")
+    for (uint32_t i = 0; i < mEntryCount; ++i) {
+        std::string_view name = GetEntryName(mEntries[i]);
+        if ((name.size() > normalizedName.size()) && (name[normalizedName.size()] == '/') && (name.compare(0, normalizedName.size(), normalizedName) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const void* AssetArchive::GetStoredData(const AssetArchiveEntry& entry) const
+{
+    return mpData + entry.dataOffset;
+}
+
+Result AssetArchive::ReadEntry(const AssetArchiveEntry& entry, std::vector<char>* pData) const
+{
+    PPX_ASSERT_NULL_ARG(pData);
+
+    pData->resize(static_cast<size_t>(entry.size));
+    if (entry.compression == ASSET_COMPRESSION_NONE) {
+        memcpy(pData->data(), GetStoredData(entry), pData->size());
+        return ppx::SUCCESS;
+    }
+
+    if (!Lz4DecompressBlock(GetStoredData(entry), static_cast<size_t>(entry.storedSize), pData->data(), pData->size())) {
+        PPX_LOG_ERROR("Failed decompressing " << GetEntryName(entry) << " from " << mPath);
+        return ppx::ERROR_ASSET_ARCHIVE_DECOMPRESS_FAILED;
+    }
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// AssetArchiveWriter
+// -------------------------------------------------------------------------------------------------
+Result AssetArchiveWriter::AddEntry(const std::filesystem::path& name, const void* pData, size_t size, AssetCompression compression)
+{
+    PendingEntry entry = {};
+    entry.name         = AssetArchive::NormalizeName(name);
+    entry.nameHash     = AssetArchive::HashName(entry.name);
+    entry.size         = size;
+
+    if (entry.name.empty() || (entry.name.compare(0, 3, "../") == 0) || (entry.name == "..")) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+    for (const auto& existing : mEntries) {
+        if ((existing.nameHash == entry.nameHash) && (existing.name == entry.name)) {
+            return ppx::ERROR_ASSET_ARCHIVE_DUPLICATE_ENTRY;
+        }
+    }
+
+    if ((compression == ASSET_COMPRESSION_LZ4) && (size > 0)) {
+        Lz4CompressBlock(pData, size, &entry.data);
+        if (entry.data.size() < size) {
+            entry.compression = ASSET_COMPRESSION_LZ4;
+        }
+    }
+    if (entry.compression == ASSET_COMPRESSION_NONE) {
+        const char* pBytes = static_cast<const char*>(pData);
+        entry.data.assign(pBytes, pBytes + size);
+    }
+
+    mEntries.push_back(std::move(entry));
+    return ppx::SUCCESS;
+}
+
+Result AssetArchiveWriter::AddFile(const std::filesystem::path& name, const std::filesystem::path& sourcePath, AssetCompression compression)
+{
+    auto data = fs::load_file(sourcePath);
+    if (!data.has_value()) {
+        return ppx::ERROR_ASSET_ARCHIVE_OPEN_FAILED;
+    }
+    return AddEntry(name, data.value().data(), data.value().size(), compression);
+}
+
+Result AssetArchiveWriter::Write(const std::filesystem::path& path) const
+{
+    auto alignUp = [](uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; };
+
+    // Sort by hash for the index, ties by name so the output is deterministic
+    std::vector<const PendingEntry*> sorted;
+    sorted.reserve(mEntries.size());
+    for (const auto& entry : mEntries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingEntry* a, const PendingEntry* b) {
+        return (a->nameHash != b->nameHash) ? (a->nameHash < b->nameHash) : (a->name < b->name);
+    });
+
+    std::vector<AssetArchiveEntry> index(sorted.size());
+    std::string                    names;
+    uint64_t                       offset = alignUp(sizeof(AssetArchiveHeader), kAssetArchiveAlignment);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const PendingEntry& pending = *sorted[i];
+        AssetArchiveEntry&  entry   = index[i];
+        entry.nameHash              = pending.nameHash;
+        entry.dataOffset            = offset;
+        entry.storedSize            = pending.data.size();
+        entry.size                  = pending.size;
+        entry.nameOffset            = static_cast<uint32_t>(names.size());
+        entry.nameLength            = static_cast<uint32_t>(pending.name.size());
+        entry.compression           = pending.compression;
+        names += pending.name;
+        offset = alignUp(offset + entry.storedSize, kAssetArchiveAlignment);
+    }
+
+    AssetArchiveHeader header = {};
+    memcpy(header.magic, kAssetArchiveMagic, sizeof(header.magic));
+    header.version     = kAssetArchiveVersion;
+    header.entryCount  = static_cast<uint32_t>(index.size());
+    header.indexOffset = offset;
+    header.namesOffset = offset + index.size() * sizeof(AssetArchiveEntry);
+    header.namesSize   = names.size();
+    header.alignment   = kAssetArchiveAlignment;
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os.good()) {
+        return ppx::ERROR_ASSET_ARCHIVE_WRITE_FAILED;
+    }
+
+    const std::vector<char> padding(kAssetArchiveAlignment, 0);
+    uint64_t                written = 0;
+    auto                    pad     = [&](uint64_t target) {
+        os.write(padding.data(), static_cast<std::streamsize>(target - written));
+        written = target;
+    };
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    written += sizeof(header);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        pad(index[i].dataOffset);
+        os.write(sorted[i]->data.data(), static_cast<std::streamsize>(sorted[i]->data.size()));
+        written += sorted[i]->data.size();
+    }
+    pad(header.indexOffset);
+    os.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(AssetArchiveEntry)));
+    os.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    return os.good() ? ppx::SUCCESS : ppx::ERROR_ASSET_ARCHIVE_WRITE_FAILED;
+}
+
+} // namespace ppx
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "ppx/base_application.h"
+#include "ppx/asset_archive.h"
 
 #if defined(__linux__) || defined(__MINGW32__)
 #include <unistd.h>
@@ -72,8 +73,15 @@ void BaseApplication::AddAssetDir(const std::filesystem::path& path, bool insert
         return;
     }
 
+    // Archives are mounted so that fs lookups under path are served from them
+    if (AssetArchive::IsArchive(path)) {
+        if (!fs::MountArchive(path)) {
+            PPX_LOG_ERROR("Failed mounting asset archive " << path);
+            return;
+        }
+    }
 #if !defined(PPX_ANDROID)
-    if (!std::filesystem::is_directory(path)) {
+    else if (!std::filesystem::is_directory(path)) {
         return;
     }
 #endif
@@ -24,12 +24,359 @@
 #include "stb_image_resize.h"
 
 #include "ppx/fs.h"
+#include "ppx/thread_pool.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PPX_BITMAP_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PPX_BITMAP_NEON
+#include <arm_neon.h>
+#endif
 
 namespace ppx {
 
 static const char*  kRadianceSig     = "#?RADIANCE";
 static const size_t kRadianceSigSize = 10;
 
+// -------------------------------------------------------------------------------------------------
+// 2x2 box filter
+// -------------------------------------------------------------------------------------------------
+//
+// Fast path for ScaleTo() with STBIR_FILTER_BOX when the target is exactly
+// half the size of the source, which is what mip generation does for even
+// dimensions.
+//
+// For an exact 2:1 reduction stb_image_resize's box filter weights are all
+// 0.5. It decodes to float, accumulates the horizontal and vertical passes
+// into zero initialized buffers and encodes back with round half up. The
+// functions below do the same operations in the same order so the output
+// matches stbir_resize() bit for bit.
+//
+namespace {
+
+// Destination rows per band when splitting work across threads
+constexpr uint32_t kBoxFilterRowsPerBand = 32;
+// Below this many destination pixels threading costs more than it saves
+constexpr uint64_t kBoxFilterMinThreadedPixels = 256 * 256;
+
+inline float BoxFilter(float p00, float p01, float p10, float p11)
+{
+    float h0 = 0.0f;
+    h0 += p00 * 0.5f;
+    h0 += p01 * 0.5f;
+
+    float h1 = 0.0f;
+    h1 += p10 * 0.5f;
+    h1 += p11 * 0.5f;
+
+    float v = 0.0f;
+    v += h0 * 0.5f;
+    v += h1 * 0.5f;
+    return v;
+}
+
+inline float Saturate(float x)
+{
+    if (x < 0.0f) {
+        return 0.0f;
+    }
+    if (x > 1.0f) {
+        return 1.0f;
+    }
+    return x;
+}
+
+// Same as stb_image_resize's (int)(x + 0.5) evaluated in double, for x >= 0
+inline uint32_t RoundHalfUp(float x)
+{
+    uint32_t t = static_cast<uint32_t>(x);
+    return t + (((x - static_cast<float>(t)) >= 0.5f) ? 1 : 0);
+}
+
+template <typename T>
+struct BoxFilterUnorm
+{
+    static constexpr float kMax = static_cast<float>(std::numeric_limits<T>::max());
+
+    static float Decode(T value) { return static_cast<float>(value) / kMax; }
+    static T     Encode(float value) { return static_cast<T>(RoundHalfUp(Saturate(value) * kMax)); }
+};
+
+struct BoxFilterFloat
+{
+    static float Decode(float value) { return value; }
+    static float Encode(float value) { return value; }
+};
+
+template <typename T, typename Codec>
+void BoxFilterRowsScalar(const Bitmap& src, Bitmap* pDst, uint32_t channelCount, uint32_t y0, uint32_t y1)
+{
+    const uint32_t dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const T* pRow0   = reinterpret_cast<const T*>(src.GetData() + (2 * y + 0) * src.GetRowStride());
+        const T* pRow1   = reinterpret_cast<const T*>(src.GetData() + (2 * y + 1) * src.GetRowStride());
+        T*       pDstRow = reinterpret_cast<T*>(pDst->GetData() + y * pDst->GetRowStride());
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            const uint32_t i0 = (2 * x + 0) * channelCount;
+            const uint32_t i1 = (2 * x + 1) * channelCount;
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                float p00                     = Codec::Decode(pRow0[i0 + c]);
+                float p01                     = Codec::Decode(pRow0[i1 + c]);
+                float p10                     = Codec::Decode(pRow1[i0 + c]);
+                float p11                     = Codec::Decode(pRow1[i1 + c]);
+                pDstRow[x * channelCount + c] = Codec::Encode(BoxFilter(p00, p01, p10, p11));
+            }
+        }
+    }
+}
+
+#if defined(PPX_BITMAP_SSE2)
+inline __m128 BoxFilterSSE2(__m128 p00, __m128 p01, __m128 p10, __m128 p11)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 h0 = _mm_add_ps(_mm_add_ps(zero, _mm_mul_ps(p00, half)), _mm_mul_ps(p01, half));
+    __m128 h1 = _mm_add_ps(_mm_add_ps(zero, _mm_mul_ps(p10, half)), _mm_mul_ps(p11, half));
+    return _mm_add_ps(_mm_add_ps(zero, _mm_mul_ps(h0, half)), _mm_mul_ps(h1, half));
+}
+
+inline __m128i EncodeUnormSSE2(__m128 value, __m128 maxValue)
+{
+    __m128  x    = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f)), maxValue);
+    __m128i t    = _mm_cvttps_epi32(x);
+    __m128  frac = _mm_sub_ps(x, _mm_cvtepi32_ps(t));
+    // Mask is all ones (-1) where the fraction rounds up
+    __m128i mask = _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f)));
+    return _mm_sub_epi32(t, mask);
+}
+
+void BoxFilterRowsRGBA8(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const __m128i  zero     = _mm_setzero_si128();
+    const __m128   maxValue = _mm_set1_ps(255.0f);
+    const uint32_t dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const char* pRow0   = src.GetData() + (2 * y + 0) * src.GetRowStride();
+        const char* pRow1   = src.GetData() + (2 * y + 1) * src.GetRowStride();
+        char*       pDstRow = pDst->GetData() + y * pDst->GetRowStride();
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            __m128i r0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pRow0 + 8 * x)), zero);
+            __m128i r1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pRow1 + 8 * x)), zero);
+
+            __m128 p00 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(r0, zero)), maxValue);
+            __m128 p01 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(r0, zero)), maxValue);
+            __m128 p10 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(r1, zero)), maxValue);
+            __m128 p11 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(r1, zero)), maxValue);
+
+            __m128i v = EncodeUnormSSE2(BoxFilterSSE2(p00, p01, p10, p11), maxValue);
+            v         = _mm_packus_epi16(_mm_packs_epi32(v, v), zero);
+
+            int32_t pixel = _mm_cvtsi128_si32(v);
+            memcpy(pDstRow + 4 * x, &pixel, 4);
+        }
+    }
+}
+
+void BoxFilterRowsRGBA16(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const __m128i  zero     = _mm_setzero_si128();
+    const __m128   maxValue = _mm_set1_ps(65535.0f);
+    const __m128i  bias     = _mm_set1_epi32(32768);
+    const __m128i  signBit  = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+    const uint32_t dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const char* pRow0   = src.GetData() + (2 * y + 0) * src.GetRowStride();
+        const char* pRow1   = src.GetData() + (2 * y + 1) * src.GetRowStride();
+        char*       pDstRow = pDst->GetData() + y * pDst->GetRowStride();
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + 16 * x));
+            __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + 16 * x));
+
+            __m128 p00 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(r0, zero)), maxValue);
+            __m128 p01 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(r0, zero)), maxValue);
+            __m128 p10 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(r1, zero)), maxValue);
+            __m128 p11 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(r1, zero)), maxValue);
+
+            // SSE2 only has a signed 32 to 16 bit pack, so bias into signed range and back
+            __m128i v = EncodeUnormSSE2(BoxFilterSSE2(p00, p01, p10, p11), maxValue);
+            v         = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(v, bias), zero), signBit);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pDstRow + 8 * x), v);
+        }
+    }
+}
+
+void BoxFilterRowsRGBA32F(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const uint32_t dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const float* pRow0   = reinterpret_cast<const float*>(src.GetData() + (2 * y + 0) * src.GetRowStride());
+        const float* pRow1   = reinterpret_cast<const float*>(src.GetData() + (2 * y + 1) * src.GetRowStride());
+        float*       pDstRow = reinterpret_cast<float*>(pDst->GetData() + y * pDst->GetRowStride());
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            __m128 p00 = _mm_loadu_ps(pRow0 + 8 * x + 0);
+            __m128 p01 = _mm_loadu_ps(pRow0 + 8 * x + 4);
+            __m128 p10 = _mm_loadu_ps(pRow1 + 8 * x + 0);
+            __m128 p11 = _mm_loadu_ps(pRow1 + 8 * x + 4);
+            _mm_storeu_ps(pDstRow + 4 * x, BoxFilterSSE2(p00, p01, p10, p11));
+        }
+    }
+}
+#elif defined(PPX_BITMAP_NEON)
+inline float32x4_t BoxFilterNEON(float32x4_t p00, float32x4_t p01, float32x4_t p10, float32x4_t p11)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    float32x4_t h0 = vaddq_f32(vaddq_f32(zero, vmulq_f32(p00, half)), vmulq_f32(p01, half));
+    float32x4_t h1 = vaddq_f32(vaddq_f32(zero, vmulq_f32(p10, half)), vmulq_f32(p11, half));
+    return vaddq_f32(vaddq_f32(zero, vmulq_f32(h0, half)), vmulq_f32(h1, half));
+}
+
+inline uint32x4_t EncodeUnormNEON(float32x4_t value, float32x4_t maxValue)
+{
+    float32x4_t x    = vmulq_f32(vminq_f32(vmaxq_f32(value, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f)), maxValue);
+    uint32x4_t  t    = vcvtq_u32_f32(x);
+    float32x4_t frac = vsubq_f32(x, vcvtq_f32_u32(t));
+    // Mask is all ones (-1) where the fraction rounds up
+    uint32x4_t mask = vcgeq_f32(frac, vdupq_n_f32(0.5f));
+    return vsubq_u32(t, mask);
+}
+
+void BoxFilterRowsRGBA8(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const float32x4_t maxValue = vdupq_n_f32(255.0f);
+    const uint32_t    dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const uint8_t* pRow0   = reinterpret_cast<const uint8_t*>(src.GetData() + (2 * y + 0) * src.GetRowStride());
+        const uint8_t* pRow1   = reinterpret_cast<const uint8_t*>(src.GetData() + (2 * y + 1) * src.GetRowStride());
+        char*          pDstRow = pDst->GetData() + y * pDst->GetRowStride();
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            uint16x8_t r0 = vmovl_u8(vld1_u8(pRow0 + 8 * x));
+            uint16x8_t r1 = vmovl_u8(vld1_u8(pRow1 + 8 * x));
+
+            float32x4_t p00 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(r0))), maxValue);
+            float32x4_t p01 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(r0))), maxValue);
+            float32x4_t p10 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(r1))), maxValue);
+            float32x4_t p11 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(r1))), maxValue);
+
+            uint16x4_t v     = vmovn_u32(EncodeUnormNEON(BoxFilterNEON(p00, p01, p10, p11), maxValue));
+            uint8x8_t  bytes = vmovn_u16(vcombine_u16(v, v));
+            vst1_lane_u32(reinterpret_cast<uint32_t*>(pDstRow + 4 * x), vreinterpret_u32_u8(bytes), 0);
+        }
+    }
+}
+
+void BoxFilterRowsRGBA16(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const float32x4_t maxValue = vdupq_n_f32(65535.0f);
+    const uint32_t    dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const uint16_t* pRow0   = reinterpret_cast<const uint16_t*>(src.GetData() + (2 * y + 0) * src.GetRowStride());
+        const uint16_t* pRow1   = reinterpret_cast<const uint16_t*>(src.GetData() + (2 * y + 1) * src.GetRowStride());
+        uint16_t*       pDstRow = reinterpret_cast<uint16_t*>(pDst->GetData() + y * pDst->GetRowStride());
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            uint16x8_t r0 = vld1q_u16(pRow0 + 8 * x);
+            uint16x8_t r1 = vld1q_u16(pRow1 + 8 * x);
+
+            float32x4_t p00 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(r0))), maxValue);
+            float32x4_t p01 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(r0))), maxValue);
+            float32x4_t p10 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(r1))), maxValue);
+            float32x4_t p11 = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(r1))), maxValue);
+
+            vst1_u16(pDstRow + 4 * x, vmovn_u32(EncodeUnormNEON(BoxFilterNEON(p00, p01, p10, p11), maxValue)));
+        }
+    }
+}
+
+void BoxFilterRowsRGBA32F(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const uint32_t dstWidth = pDst->GetWidth();
+    for (uint32_t y = y0; y < y1; ++y) {
+        const float* pRow0   = reinterpret_cast<const float*>(src.GetData() + (2 * y + 0) * src.GetRowStride());
+        const float* pRow1   = reinterpret_cast<const float*>(src.GetData() + (2 * y + 1) * src.GetRowStride());
+        float*       pDstRow = reinterpret_cast<float*>(pDst->GetData() + y * pDst->GetRowStride());
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            float32x4_t p00 = vld1q_f32(pRow0 + 8 * x + 0);
+            float32x4_t p01 = vld1q_f32(pRow0 + 8 * x + 4);
+            float32x4_t p10 = vld1q_f32(pRow1 + 8 * x + 0);
+            float32x4_t p11 = vld1q_f32(pRow1 + 8 * x + 4);
+            vst1q_f32(pDstRow + 4 * x, BoxFilterNEON(p00, p01, p10, p11));
+        }
+    }
+}
+#else
+void BoxFilterRowsRGBA8(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    BoxFilterRowsScalar<uint8_t, BoxFilterUnorm<uint8_t>>(src, pDst, 4, y0, y1);
+}
+
+void BoxFilterRowsRGBA16(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    BoxFilterRowsScalar<uint16_t, BoxFilterUnorm<uint16_t>>(src, pDst, 4, y0, y1);
+}
+
+void BoxFilterRowsRGBA32F(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    BoxFilterRowsScalar<float, BoxFilterFloat>(src, pDst, 4, y0, y1);
+}
+#endif
+
+// Filters destination rows [y0, y1)
+void BoxFilterRows(const Bitmap& src, Bitmap* pDst, uint32_t y0, uint32_t y1)
+{
+    const uint32_t channelCount = src.GetChannelCount();
+
+    // clang-format off
+    switch (src.GetFormat()) {
+        default: break;
+        case Bitmap::FORMAT_RGBA_UINT8  : BoxFilterRowsRGBA8(src, pDst, y0, y1); return;
+        case Bitmap::FORMAT_RGBA_UINT16 : BoxFilterRowsRGBA16(src, pDst, y0, y1); return;
+        case Bitmap::FORMAT_RGBA_FLOAT  : BoxFilterRowsRGBA32F(src, pDst, y0, y1); return;
+    }
+
+    switch (Bitmap::ChannelDataType(src.GetFormat())) {
+        default: PPX_ASSERT_MSG(false, "unsupported box filter format"); break;
+        case Bitmap::DATA_TYPE_UINT8  : BoxFilterRowsScalar<uint8_t, BoxFilterUnorm<uint8_t>>(src, pDst, channelCount, y0, y1); break;
+        case Bitmap::DATA_TYPE_UINT16 : BoxFilterRowsScalar<uint16_t, BoxFilterUnorm<uint16_t>>(src, pDst, channelCount, y0, y1); break;
+        case Bitmap::DATA_TYPE_FLOAT  : BoxFilterRowsScalar<float, BoxFilterFloat>(src, pDst, channelCount, y0, y1); break;
+    }
+    // clang-format on
+}
+
+bool CanUseBoxFilter2x2(const Bitmap& src, const Bitmap& dst)
+{
+    // 32-bit unorm is converted through double by stbir, leave it there
+    Bitmap::DataType dataType = Bitmap::ChannelDataType(src.GetFormat());
+    if ((dataType != Bitmap::DATA_TYPE_UINT8) && (dataType != Bitmap::DATA_TYPE_UINT16) && (dataType != Bitmap::DATA_TYPE_FLOAT)) {
+        return false;
+    }
+    return (dst.GetWidth() > 0) && (dst.GetHeight() > 0) && ((2 * dst.GetWidth()) == src.GetWidth()) && ((2 * dst.GetHeight()) == src.GetHeight());
+}
+
+void BoxFilter2x2(const Bitmap& src, Bitmap* pDst)
+{
+    const uint32_t height     = pDst->GetHeight();
+    const uint64_t pixelCount = static_cast<uint64_t>(pDst->GetWidth()) * height;
+    if (pixelCount < kBoxFilterMinThreadedPixels) {
+        BoxFilterRows(src, pDst, 0, height);
+        return;
+    }
+
+    const uint32_t bandCount = (height + kBoxFilterRowsPerBand - 1) / kBoxFilterRowsPerBand;
+    ThreadPool::GetDefault().ParallelFor(bandCount, [&src, pDst, height](uint32_t band) {
+        uint32_t y0 = band * kBoxFilterRowsPerBand;
+        uint32_t y1 = std::min(y0 + kBoxFilterRowsPerBand, height);
+        BoxFilterRows(src, pDst, y0, y1);
+    });
+}
+
+} // namespace
+
 // -------------------------------------------------------------------------------------------------
 // Bitmap
 // -------------------------------------------------------------------------------------------------
@@ -284,6 +631,11 @@ Result Bitmap::ScaleTo(Bitmap* pTargetBitmap, stbir_filter filterType) const
     }
     // clang-format on
 
+    if ((filterType == STBIR_FILTER_BOX) && CanUseBoxFilter2x2(*this, *pTargetBitmap)) {
+        BoxFilter2x2(*this, pTargetBitmap);
+        return ppx::SUCCESS;
+    }
+
     int res = stbir_resize(
         static_cast<const void*>(GetData()),
         static_cast<int>(GetWidth()),
@@ -645,6 +997,19 @@ Result Bitmap::LoadFile(const std::filesystem::path& path, Bitmap* pBitmap)
         return ppx::ERROR_PATH_DOES_NOT_EXIST;
     }
 
+    // Decode straight from the mapping when possible, this avoids reading
+    // the file twice and copying it into a temporary buffer.
+    {
+        ppx::fs::File file;
+        if (file.Open(path) && file.IsMapped()) {
+            Result ppxres = LoadFromMemory(file.GetLength(), file.GetMappedData(), pBitmap);
+            if (Failed(ppxres)) {
+                PPX_LOG_ERROR("Failed to open file '" + path.string() + "'");
+            }
+            return ppxres;
+        }
+    }
+
     bool   isRadiance = false;
     Result ppxres     = IsRadianceFile(path, isRadiance);
     if (Failed(ppxres)) {
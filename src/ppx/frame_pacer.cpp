@@ -0,0 +1,117 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/frame_pacer.h"
+#include "ppx/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace ppx {
+
+// The spin time decays by this factor every frame that woke up before the
+// deadline, so one long preemption doesn't keep the CPU spinning for the whole run.
+static constexpr double kSpinDecay = 0.99;
+
+void FramePacer::Reset(const FramePacerCreateInfo& createInfo)
+{
+    mCreateInfo  = createInfo;
+    mStarted     = false;
+    mPeriod      = (createInfo.frameRate > 0) ? (1.0 / createInfo.frameRate) : 0.0;
+    mDeadline    = 0;
+    mSpinSeconds = std::max(createInfo.spinSeconds, 0.0);
+    mFrameIndex  = 0;
+    mMissCount   = 0;
+}
+
+FramePacerFrameStats FramePacer::Wait()
+{
+    FramePacerFrameStats stats = {};
+    stats.frameIndex           = mFrameIndex++;
+    stats.frameEnd             = GetTime();
+    stats.deadline             = stats.frameEnd;
+    stats.wakeTime             = stats.frameEnd;
+    if (!IsEnabled()) {
+        return stats;
+    }
+
+    if (!mStarted) {
+        mStarted  = true;
+        mDeadline = stats.frameEnd + mPeriod;
+        return stats;
+    }
+
+    stats.deadline = mDeadline;
+    stats.missed   = (stats.frameEnd > mDeadline);
+    if (stats.missed) {
+        ++mMissCount;
+    }
+    else {
+        // Sleep through most of the wait, the OS wakes threads up late
+        const double spinStart = mDeadline - mSpinSeconds;
+        if (stats.frameEnd < spinStart) {
+            Sleep(spinStart - stats.frameEnd);
+
+            // Waking up late is expected, the spin time only has to grow
+            // when the wake up lands past the deadline
+            const double sleepEnd  = GetTime();
+            const double oversleep = sleepEnd - spinStart;
+            stats.sleepSeconds     = sleepEnd - stats.frameEnd;
+            if (oversleep > mSpinSeconds) {
+                mSpinSeconds = std::min(mSpinSeconds + oversleep, 0.5 * mPeriod);
+            }
+            else {
+                mSpinSeconds = std::max(mSpinSeconds * kSpinDecay, mCreateInfo.spinSeconds);
+            }
+        }
+
+        // Spin for the rest
+        const double spinBegin = GetTime();
+        double       now       = spinBegin;
+        while (now < mDeadline) {
+            Spin();
+            now = GetTime();
+        }
+        stats.spinSeconds = now - spinBegin;
+    }
+    stats.wakeTime = GetTime();
+
+    mDeadline += mPeriod;
+    if ((mCreateInfo.missPolicy == FRAME_PACER_MISS_POLICY_SKIP) && (mDeadline <= stats.wakeTime)) {
+        const double skipped = std::floor((stats.wakeTime - mDeadline) / mPeriod) + 1.0;
+        mDeadline += skipped * mPeriod;
+    }
+
+    return stats;
+}
+
+double FramePacer::GetTime() const
+{
+    uint64_t timestamp = 0;
+    Timer::Timestamp(&timestamp);
+    return Timer::TimestampToSeconds(timestamp);
+}
+
+void FramePacer::Sleep(double seconds)
+{
+    Timer::SleepSeconds(seconds);
+}
+
+void FramePacer::Spin()
+{
+    std::this_thread::yield();
+}
+
+} // namespace ppx
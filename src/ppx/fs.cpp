@@ -13,11 +13,14 @@
 // limitations under the License.
 
 #include "ppx/fs.h"
+#include "ppx/asset_archive.h"
 #include "ppx/config.h"
 
+#include <atomic>
 #include <filesystem>
 #include <regex>
 #include <optional>
+#include <shared_mutex>
 #include <vector>
 
 #if defined(PPX_ANDROID)
@@ -25,6 +28,14 @@
 android_app* gAndroidContext;
 #endif
 
+#if defined(PPX_LINUX) || defined(PPX_ANDROID)
+#define PPX_FS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace ppx::fs {
 
 #if defined(PPX_ANDROID)
@@ -34,6 +45,55 @@ void set_android_context(android_app* androidContext)
 }
 #endif
 
+namespace {
+
+struct MountedArchive
+{
+    std::string                         prefix; // Normalized archive path
+    std::shared_ptr<const AssetArchive> archive;
+};
+
+std::shared_mutex           gArchiveMutex;
+std::vector<MountedArchive> gArchives;
+std::atomic<bool>           gHasArchives = false;
+
+std::string NormalizeMountPath(const std::filesystem::path& path)
+{
+    // lexically_normal() is slow compared to the rest of a lookup, skip it when possible
+    std::string normalized = path.generic_string();
+    if (AssetArchive::IsLexicallyNormal(normalized)) {
+        return normalized;
+    }
+    normalized = path.lexically_normal().generic_string();
+    while ((normalized.size() > 1) && (normalized.back() == '/')) {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+// Returns the mounted archive that contains path and the name of the entry
+// within it, or nullptr if path isn't inside a mounted archive.
+std::shared_ptr<const AssetArchive> FindArchive(const std::filesystem::path& path, std::string* pEntryName)
+{
+    // Skip normalizing the path when nothing is mounted
+    if (!gHasArchives.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    const std::string                   normalized = NormalizeMountPath(path);
+    std::shared_lock<std::shared_mutex> lock(gArchiveMutex);
+    for (const auto& mounted : gArchives) {
+        const size_t n = mounted.prefix.size();
+        if ((normalized.size() > n) && (normalized[n] == '/') && (normalized.compare(0, n, mounted.prefix) == 0)) {
+            *pEntryName = AssetArchive::NormalizeName(normalized.substr(n + 1));
+            return mounted.archive;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 File::File()
     : mHandleType(BAD_HANDLE)
 {
@@ -52,13 +112,107 @@ File::~File()
         case STREAM_HANDLE:
             mStream.close();
             break;
+        case ARCHIVE_HANDLE:
+            // The archive is unmapped when the last reference goes away
+            break;
+        case MAPPED_HANDLE:
+#if defined(PPX_FS_MMAP)
+            munmap(const_cast<void*>(mBuffer), mFileSize);
+            close(mFd);
+#else
+            PPX_ASSERT_MSG(false, "Bad implem. This case should never be reached.");
+#endif
+            break;
         default:
             break;
     }
 }
 
-bool File::Open(const std::filesystem::path& path)
+bool File::OpenMapped(const std::filesystem::path& path, FileAccessHint hint)
+{
+#if defined(PPX_FS_MMAP)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // mmap() can't map empty files, and only regular files have a constant content
+    struct stat st = {};
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size <= 0)) {
+        close(fd);
+        return false;
+    }
+
+    const size_t size  = static_cast<size_t>(st.st_size);
+    void*        pData = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pData == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    // Hints are best effort, failures are harmless
+    switch (hint) {
+        case FILE_ACCESS_HINT_SEQUENTIAL:
+            madvise(pData, size, MADV_SEQUENTIAL);
+            break;
+        case FILE_ACCESS_HINT_RANDOM:
+            madvise(pData, size, MADV_RANDOM);
+            break;
+        case FILE_ACCESS_HINT_WILL_NEED:
+            madvise(pData, size, MADV_WILLNEED);
+            break;
+    }
+
+    mFd         = fd;
+    mBuffer     = pData;
+    mFileSize   = size;
+    mFileOffset = 0;
+    mHandleType = MAPPED_HANDLE;
+    return true;
+#else
+    (void)path;
+    (void)hint;
+    return false;
+#endif
+}
+
+bool File::OpenArchiveEntry(const std::filesystem::path& path)
 {
+    std::string                         entryName;
+    std::shared_ptr<const AssetArchive> archive = FindArchive(path, &entryName);
+    if (!archive) {
+        return false;
+    }
+
+    const AssetArchiveEntry* pEntry = archive->FindEntry(std::string_view(entryName));
+    if (IsNull(pEntry)) {
+        return true;
+    }
+
+    // Uncompressed entries are read straight from the archive's mapping
+    if (pEntry->compression == ASSET_COMPRESSION_NONE) {
+        mBuffer = archive->GetStoredData(*pEntry);
+    }
+    else {
+        if (Failed(archive->ReadEntry(*pEntry, &mArchiveData))) {
+            return true;
+        }
+        mBuffer = mArchiveData.data();
+    }
+
+    mArchive    = archive;
+    mFileSize   = static_cast<size_t>(pEntry->size);
+    mFileOffset = 0;
+    mHandleType = ARCHIVE_HANDLE;
+    return true;
+}
+
+bool File::Open(const std::filesystem::path& path, FileAccessHint hint)
+{
+    if (OpenArchiveEntry(path)) {
+        return IsValid();
+    }
+
 #if defined(PPX_ANDROID)
     if (!path.is_absolute()) {
         mAsset      = AAssetManager_open(gAndroidContext->activity->assetManager, path.c_str(), AASSET_MODE_BUFFER);
@@ -70,6 +224,10 @@ bool File::Open(const std::filesystem::path& path)
     }
 #endif
 
+    if (OpenMapped(path, hint)) {
+        return true;
+    }
+
     mStream.open(path, std::ios::binary);
     if (!mStream.good()) {
         return false;
@@ -88,6 +246,12 @@ bool File::IsValid() const
     if (mHandleType == STREAM_HANDLE) {
         return mStream.good();
     }
+    if (mHandleType == MAPPED_HANDLE) {
+        return mBuffer != nullptr;
+    }
+    if (mHandleType == ARCHIVE_HANDLE) {
+        return mArchive != nullptr;
+    }
     return mHandleType == ASSET_HANDLE && mAsset != nullptr;
 }
 
@@ -133,10 +297,21 @@ const void* File::GetMappedData() const
 
 bool FileStream::Open(const char* path)
 {
-    auto optional_buffer = load_file(path);
-    if (!optional_buffer.has_value())
+    if (!mFile.Open(path)) {
+        return false;
+    }
+
+    // The get area is only ever read from, so the mapping can be used as is
+    if (mFile.IsMapped()) {
+        char* pData = const_cast<char*>(static_cast<const char*>(mFile.GetMappedData()));
+        setg(pData, pData, pData + mFile.GetLength());
+        return true;
+    }
+
+    mBuffer.resize(mFile.GetLength());
+    if (mFile.Read(mBuffer.data(), mBuffer.size()) != mBuffer.size()) {
         return false;
-    mBuffer = optional_buffer.value();
+    }
     setg(mBuffer.data(), mBuffer.data(), mBuffer.data() + mBuffer.size());
     return true;
 }
@@ -156,8 +331,50 @@ std::optional<std::vector<char>> load_file(const std::filesystem::path& path)
     return buffer;
 }
 
+bool MountArchive(const std::filesystem::path& path)
+{
+    const std::string prefix = NormalizeMountPath(path);
+    {
+        std::shared_lock<std::shared_mutex> lock(gArchiveMutex);
+        for (const auto& mounted : gArchives) {
+            if (mounted.prefix == prefix) {
+                return true;
+            }
+        }
+    }
+
+    auto archive = std::make_shared<AssetArchive>();
+    if (Failed(archive->Open(path))) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(gArchiveMutex);
+    gArchives.push_back({prefix, archive});
+    gHasArchives.store(true, std::memory_order_release);
+
+    PPX_LOG_INFO("Mounted asset archive " << path << " (" << archive->GetEntryCount() << " entries)");
+    return true;
+}
+
+void UnmountArchive(const std::filesystem::path& path)
+{
+    const std::string prefix = NormalizeMountPath(path);
+
+    std::unique_lock<std::shared_mutex> lock(gArchiveMutex);
+    gArchives.erase(
+        std::remove_if(gArchives.begin(), gArchives.end(), [&prefix](const MountedArchive& mounted) { return mounted.prefix == prefix; }),
+        gArchives.end());
+    gHasArchives.store(!gArchives.empty(), std::memory_order_release);
+}
+
 bool path_exists(const std::filesystem::path& path)
 {
+    std::string                         entryName;
+    std::shared_ptr<const AssetArchive> archive = FindArchive(path, &entryName);
+    if (archive) {
+        return !IsNull(archive->FindEntry(std::string_view(entryName))) || archive->ContainsDirectory(entryName);
+    }
+
 #if defined(PPX_ANDROID)
     if (!path.is_absolute()) {
         AAsset* temp_file = AAssetManager_open(gAndroidContext->activity->assetManager, path.c_str(), AASSET_MODE_BUFFER);
@@ -14,6 +14,16 @@
 
 #include "ppx/geometry.h"
 #include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PPX_GEOMETRY_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PPX_GEOMETRY_NEON
+#include <arm_neon.h>
+#endif
 
 #define NOT_INTERLEAVED_MSG "cannot append interleaved data if attribute layout is not interleaved"
 #define NOT_PLANAR_MSG      "cannot append planar data if attribute layout is not planar"
@@ -410,6 +420,257 @@ static VertexDataProcessorInterleaved<TriMeshVertexDataCompressed>    sVDProcess
 static VertexDataProcessorPositionPlanar<TriMeshVertexData>           sVDProcessorPositionPlanar;
 static VertexDataProcessorPositionPlanar<TriMeshVertexDataCompressed> sVDProcessorPositionPlanarCompressed;
 
+// -------------------------------------------------------------------------------------------------
+// Vertex format conversion
+//     4 components at a time, which covers any single attribute
+// -------------------------------------------------------------------------------------------------
+namespace {
+
+#if defined(PPX_GEOMETRY_SSE2)
+// Branch free version of PackHalf() below
+inline void PackHalf4(const float* pSrc, uint16_t* pDst)
+{
+    const __m128i signMask    = _mm_set1_epi32(static_cast<int32_t>(0x80000000u));
+    const __m128i one         = _mm_set1_epi32(1);
+    const __m128i infinity    = _mm_set1_epi32(255 << 23);
+    const __m128i overflow    = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i normalMin   = _mm_set1_epi32(113 << 23);
+    const __m128i normalBias  = _mm_set1_epi32(0xFFF - (112 << 23));
+    const __m128i denormMagic = _mm_set1_epi32(126 << 23);
+
+    __m128i value = _mm_castps_si128(_mm_loadu_ps(pSrc));
+    __m128i sign  = _mm_and_si128(value, signMask);
+    value         = _mm_xor_si128(value, sign);
+
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(value), _mm_castsi128_ps(denormMagic))), denormMagic);
+    __m128i odd       = _mm_and_si128(_mm_srli_epi32(value, 13), one);
+    __m128i normal    = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(value, normalBias), odd), 13);
+    __m128i infNan    = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(_mm_cmpgt_epi32(value, infinity), _mm_set1_epi32(0x200)));
+
+    __m128i isSubnormal = _mm_cmplt_epi32(value, normalMin);
+    __m128i isInfNan    = _mm_cmpgt_epi32(value, _mm_sub_epi32(overflow, one));
+    __m128i result      = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    result              = _mm_or_si128(_mm_and_si128(isInfNan, infNan), _mm_andnot_si128(isInfNan, result));
+    result              = _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+
+    // SSE2 only has a signed 32 to 16 bit pack, so sign extend the 16 bit values first
+    result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst), _mm_packs_epi32(result, result));
+}
+
+inline void PackSnorm4(const float* pSrc, int8_t* pDst)
+{
+    __m128  value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    __m128i i32   = _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(127.0f)));
+    __m128i i16   = _mm_packs_epi32(i32, i32);
+    int32_t i8    = _mm_cvtsi128_si32(_mm_packs_epi16(i16, i16));
+    memcpy(pDst, &i8, sizeof(i8));
+}
+#elif defined(PPX_GEOMETRY_NEON)
+inline void PackHalf4(const float* pSrc, uint16_t* pDst)
+{
+    vst1_u16(pDst, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(pSrc))));
+}
+
+inline void PackSnorm4(const float* pSrc, int8_t* pDst)
+{
+    float32x4_t value = vminq_f32(vmaxq_f32(vld1q_f32(pSrc), vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+    int16x4_t   i16   = vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(value, 127.0f)));
+    int32_t     i8    = vget_lane_s32(vreinterpret_s32_s8(vqmovn_s16(vcombine_s16(i16, i16))), 0);
+    memcpy(pDst, &i8, sizeof(i8));
+}
+#else
+// Round to nearest even, overflow goes to infinity and NaN stays NaN
+inline uint16_t PackHalf(float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t result = 0;
+    if (bits >= ((127u + 16u) << 23)) {
+        result = (bits > (255u << 23)) ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < (113u << 23)) {
+        // Subnormal or zero, adding 0.5 lines the mantissa up with the
+        // half's and lets the float adder do the rounding
+        float f = 0;
+        memcpy(&f, &bits, sizeof(f));
+        f += 0.5f;
+        memcpy(&result, &f, sizeof(result));
+        result -= (126u << 23);
+    }
+    else {
+        // Rebias the exponent, rounding to nearest even
+        result = (bits + 0xFFFu - (112u << 23) + ((bits >> 13) & 1)) >> 13;
+    }
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+inline void PackHalf4(const float* pSrc, uint16_t* pDst)
+{
+    for (uint32_t i = 0; i < 4; ++i) {
+        pDst[i] = PackHalf(pSrc[i]);
+    }
+}
+
+inline void PackSnorm4(const float* pSrc, int8_t* pDst)
+{
+    for (uint32_t i = 0; i < 4; ++i) {
+        pDst[i] = static_cast<int8_t>(std::nearbyint(std::clamp(pSrc[i], -1.0f, 1.0f) * 127.0f));
+    }
+}
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// Bulk vertex copy
+//     Geometry::Create(createInfo, mesh) resolves where every attribute comes
+//     from and goes to once, then fills each attribute in a single loop
+// -------------------------------------------------------------------------------------------------
+enum VertexConversion
+{
+    VERTEX_CONVERSION_FLOAT  = 0,
+    VERTEX_CONVERSION_HALF   = 1,
+    VERTEX_CONVERSION_SNORM8 = 2,
+};
+
+struct VertexAttributeCopy
+{
+    const float*     pSrc          = nullptr; // Null if the mesh doesn't have the attribute
+    uint32_t         srcCount      = 0;
+    uint32_t         srcComponents = 0;
+    uint32_t         dstOffset     = 0;
+    uint32_t         dstComponents = 0;
+    VertexConversion conversion    = VERTEX_CONVERSION_FLOAT;
+};
+
+bool GetVertexConversion(grfx::Format format, VertexAttributeCopy* pCopy)
+{
+    const grfx::FormatDesc* pDesc = grfx::GetFormatDescription(format);
+    if (IsNull(pDesc) || (pDesc->layout != grfx::FORMAT_LAYOUT_LINEAR)) {
+        return false;
+    }
+
+    // The component size comes from the texel size instead of
+    // bytesPerComponent, which isn't set right for all 32-bit formats.
+    uint32_t componentCount = 0;
+    for (uint32_t bit : {grfx::FORMAT_COMPONENT_RED, grfx::FORMAT_COMPONENT_GREEN, grfx::FORMAT_COMPONENT_BLUE, grfx::FORMAT_COMPONENT_ALPHA}) {
+        componentCount += ((pDesc->componentBits & bit) != 0) ? 1 : 0;
+    }
+    if ((componentCount == 0) || (pDesc->componentBits & ~grfx::FORMAT_COMPONENT_RED_GREEN_BLUE_ALPHA) || ((pDesc->bytesPerTexel % componentCount) != 0)) {
+        return false;
+    }
+    const uint32_t bytesPerComponent = pDesc->bytesPerTexel / componentCount;
+
+    if ((pDesc->dataType == grfx::FORMAT_DATA_TYPE_FLOAT) && (bytesPerComponent == 4)) {
+        pCopy->conversion = VERTEX_CONVERSION_FLOAT;
+    }
+    else if ((pDesc->dataType == grfx::FORMAT_DATA_TYPE_FLOAT) && (bytesPerComponent == 2)) {
+        pCopy->conversion = VERTEX_CONVERSION_HALF;
+    }
+    else if ((pDesc->dataType == grfx::FORMAT_DATA_TYPE_SNORM) && (bytesPerComponent == 1)) {
+        pCopy->conversion = VERTEX_CONVERSION_SNORM8;
+    }
+    else {
+        return false;
+    }
+
+    pCopy->dstComponents = componentCount;
+    return true;
+}
+
+// Same sources as TriMesh::GetVertexData()
+bool GetMeshAttribute(const TriMesh& mesh, grfx::VertexSemantic semantic, VertexAttributeCopy* pCopy)
+{
+    // clang-format off
+    switch (semantic) {
+        default: return false;
+        case grfx::VERTEX_SEMANTIC_POSITION  : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataPositions()); pCopy->srcCount = mesh.GetCountPositions(); pCopy->srcComponents = 3; break;
+        case grfx::VERTEX_SEMANTIC_NORMAL    : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataNormalls()); pCopy->srcCount = mesh.GetCountNormals(); pCopy->srcComponents = 3; break;
+        case grfx::VERTEX_SEMANTIC_COLOR     : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataColors()); pCopy->srcCount = mesh.GetCountColors(); pCopy->srcComponents = 3; break;
+        case grfx::VERTEX_SEMANTIC_TANGENT   : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataTangents()); pCopy->srcCount = mesh.GetCountTangents(); pCopy->srcComponents = 4; break;
+        case grfx::VERTEX_SEMANTIC_BITANGENT : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataBitangents()); pCopy->srcCount = mesh.GetCountBitangents(); pCopy->srcComponents = 3; break;
+        case grfx::VERTEX_SEMANTIC_TEXCOORD  : pCopy->pSrc = reinterpret_cast<const float*>(mesh.GetDataTexCoords2()); pCopy->srcCount = mesh.GetCountTexCoords(); pCopy->srcComponents = 2; break;
+    }
+    // clang-format on
+
+    if (IsNull(pCopy->pSrc)) {
+        pCopy->srcCount = 0;
+    }
+    return true;
+}
+
+// Writes count vertices to pDst, vertex i comes from mesh vertex
+// pIndices[i], or from mesh vertex i if pIndices is null.
+template <VertexConversion Conversion>
+void CopyVertexAttribute(const VertexAttributeCopy& copy, uint32_t count, const uint32_t* pIndices, uint32_t stride, char* pDst)
+{
+    const size_t srcSize = copy.srcComponents * sizeof(float);
+    size_t       dstSize = copy.dstComponents * sizeof(float);
+    if (Conversion == VERTEX_CONVERSION_HALF) {
+        dstSize = copy.dstComponents * sizeof(uint16_t);
+    }
+    else if (Conversion == VERTEX_CONVERSION_SNORM8) {
+        dstSize = copy.dstComponents * sizeof(int8_t);
+    }
+
+    pDst += copy.dstOffset;
+    for (uint32_t i = 0; i < count; ++i, pDst += stride) {
+        const uint32_t index    = IsNull(pIndices) ? i : pIndices[i];
+        float          value[4] = {};
+        if (index < copy.srcCount) {
+            memcpy(value, copy.pSrc + static_cast<size_t>(index) * copy.srcComponents, srcSize);
+        }
+
+        if constexpr (Conversion == VERTEX_CONVERSION_FLOAT) {
+            memcpy(pDst, value, dstSize);
+        }
+        else if constexpr (Conversion == VERTEX_CONVERSION_HALF) {
+            uint16_t packed[4];
+            PackHalf4(value, packed);
+            memcpy(pDst, packed, dstSize);
+        }
+        else {
+            int8_t packed[4];
+            PackSnorm4(value, packed);
+            memcpy(pDst, packed, dstSize);
+        }
+    }
+}
+
+} // namespace
+
+void ConvertToHalf(uint32_t count, const float* pSrc, half* pDst)
+{
+    uint32_t i = 0;
+    for (; (i + 4) <= count; i += 4) {
+        PackHalf4(pSrc + i, pDst + i);
+    }
+    if (i < count) {
+        float    value[4] = {};
+        uint16_t packed[4];
+        memcpy(value, pSrc + i, (count - i) * sizeof(float));
+        PackHalf4(value, packed);
+        memcpy(pDst + i, packed, (count - i) * sizeof(uint16_t));
+    }
+}
+
+void ConvertToSnorm8(uint32_t count, const float* pSrc, int8_t* pDst)
+{
+    uint32_t i = 0;
+    for (; (i + 4) <= count; i += 4) {
+        PackSnorm4(pSrc + i, pDst + i);
+    }
+    if (i < count) {
+        float  value[4] = {};
+        int8_t packed[4];
+        memcpy(value, pSrc + i, (count - i) * sizeof(float));
+        PackSnorm4(value, packed);
+        memcpy(pDst + i, packed, (count - i) * sizeof(int8_t));
+    }
+}
+
 // -------------------------------------------------------------------------------------------------
 // GeometryOptions
 // -------------------------------------------------------------------------------------------------
@@ -719,6 +980,12 @@ Result Geometry::Create(
         return ppxres;
     }
 
+    if (pGeometry->AppendTriMeshData(mesh)) {
+        return ppx::SUCCESS;
+    }
+
+    // Per vertex path for layouts AppendTriMeshData() doesn't handle
+
     //
     // Target geometry WITHOUT index data
     //
@@ -851,6 +1118,95 @@ Result Geometry::Create(
     return ppx::SUCCESS;
 }
 
+bool Geometry::AppendTriMeshData(const TriMesh& mesh)
+{
+    // Resolve every attribute before touching the buffers
+    std::vector<VertexAttributeCopy> copies[PPX_MAX_VERTEX_BINDINGS];
+    for (uint32_t bindingIndex = 0; bindingIndex < mCreateInfo.vertexBindingCount; ++bindingIndex) {
+        const grfx::VertexBinding& binding = mCreateInfo.vertexBindings[bindingIndex];
+        for (uint32_t attrIndex = 0; attrIndex < binding.GetAttributeCount(); ++attrIndex) {
+            const grfx::VertexAttribute* pAttribute = nullptr;
+            binding.GetAttribute(attrIndex, &pAttribute);
+
+            VertexAttributeCopy copy = {};
+            copy.dstOffset           = pAttribute->offset;
+            if (!GetVertexConversion(pAttribute->format, &copy) || !GetMeshAttribute(mesh, pAttribute->semantic, &copy)) {
+                return false;
+            }
+            if ((copy.dstOffset + grfx::GetFormatDescription(pAttribute->format)->bytesPerTexel) > binding.GetStride()) {
+                return false;
+            }
+            copies[bindingIndex].push_back(copy);
+        }
+    }
+
+    const bool     meshIndexed     = (mesh.GetIndexType() != grfx::INDEX_TYPE_UNDEFINED);
+    const bool     geometryIndexed = (mCreateInfo.indexType != grfx::INDEX_TYPE_UNDEFINED);
+    const uint32_t triangleCount   = meshIndexed ? mesh.GetCountTriangles() : (mesh.GetCountPositions() / 3);
+
+    std::vector<uint32_t> meshIndices;
+    if (meshIndexed) {
+        meshIndices.resize(3 * triangleCount);
+        if (mesh.GetIndexType() == grfx::INDEX_TYPE_UINT16) {
+            const uint16_t* pMeshIndices = mesh.GetDataIndicesU16();
+            std::copy(pMeshIndices, pMeshIndices + meshIndices.size(), meshIndices.begin());
+        }
+        else {
+            memcpy(meshIndices.data(), mesh.GetDataIndicesU32(), meshIndices.size() * sizeof(uint32_t));
+        }
+    }
+
+    // Same vertex and index order as the per vertex path: a geometry without
+    // indices gets the triangle vertices of an indexed mesh, a geometry with
+    // indices gets every third vertex of a mesh without indices as a triangle.
+    uint32_t        vertexCount    = mesh.GetCountPositions();
+    const uint32_t* pVertexIndices = nullptr;
+    if (!geometryIndexed && meshIndexed) {
+        vertexCount    = CountU32(meshIndices);
+        pVertexIndices = meshIndices.data();
+    }
+    else if (geometryIndexed && !meshIndexed) {
+        vertexCount = 3 * triangleCount;
+        meshIndices.resize(vertexCount);
+        std::iota(meshIndices.begin(), meshIndices.end(), 0);
+    }
+
+    if (geometryIndexed) {
+        const uint32_t offset = mIndexBuffer.GetSize();
+        mIndexBuffer.SetSize(offset + CountU32(meshIndices) * mIndexBuffer.GetElementSize());
+        char* pDst = mIndexBuffer.GetData() + offset;
+        if (mCreateInfo.indexType == grfx::INDEX_TYPE_UINT16) {
+            uint16_t* pDstU16 = reinterpret_cast<uint16_t*>(pDst);
+            for (size_t i = 0; i < meshIndices.size(); ++i) {
+                pDstU16[i] = static_cast<uint16_t>(meshIndices[i]);
+            }
+        }
+        else {
+            memcpy(pDst, meshIndices.data(), meshIndices.size() * sizeof(uint32_t));
+        }
+    }
+
+    for (uint32_t bindingIndex = 0; bindingIndex < mCreateInfo.vertexBindingCount; ++bindingIndex) {
+        Geometry::Buffer& buffer = mVertexBuffers[bindingIndex];
+        const uint32_t    stride = buffer.GetElementSize();
+        const uint32_t    offset = buffer.GetSize();
+        buffer.SetSize(offset + vertexCount * stride);
+
+        char* pDst = buffer.GetData() + offset;
+        for (const VertexAttributeCopy& copy : copies[bindingIndex]) {
+            // clang-format off
+            switch (copy.conversion) {
+                case VERTEX_CONVERSION_FLOAT  : CopyVertexAttribute<VERTEX_CONVERSION_FLOAT>(copy, vertexCount, pVertexIndices, stride, pDst); break;
+                case VERTEX_CONVERSION_HALF   : CopyVertexAttribute<VERTEX_CONVERSION_HALF>(copy, vertexCount, pVertexIndices, stride, pDst); break;
+                case VERTEX_CONVERSION_SNORM8 : CopyVertexAttribute<VERTEX_CONVERSION_SNORM8>(copy, vertexCount, pVertexIndices, stride, pDst); break;
+            }
+            // clang-format on
+        }
+    }
+
+    return true;
+}
+
 Result Geometry::Create(
     const GeometryOptions& createInfo,
     const WireMesh&        mesh,
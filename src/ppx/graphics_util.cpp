@@ -17,7 +17,9 @@
 #include "ppx/graphics_util.h"
 #include "ppx/bitmap.h"
 #include "ppx/fs.h"
+#include "ppx/mesh_cache.h"
 #include "ppx/mipmap.h"
+#include "ppx/thread_pool.h"
 #include "ppx/timer.h"
 #include "ppx/grfx/grfx_buffer.h"
 #include "ppx/grfx/grfx_command.h"
@@ -26,8 +28,12 @@
 #include "ppx/grfx/grfx_queue.h"
 #include "ppx/grfx/grfx_util.h"
 #include "ppx/grfx/grfx_scope.h"
+#include "ppx/grfx/grfx_upload_queue.h"
 #include "gli/gli.hpp"
 
+#include <memory>
+#include <numeric>
+
 namespace ppx {
 namespace grfx_util {
 
@@ -85,6 +91,32 @@ grfx::Format ToGrfxFormat(gli::format value)
 
 // -------------------------------------------------------------------------------------------------
 
+namespace {
+
+// When copying from a buffer to a image/texture, D3D12 requires that the rows
+// stored in the source buffer (aka staging buffer) are aligned to 256 bytes.
+// Vulkan does not have this requirement. The alignment is based off the number
+// of bytes copied per row and not the bitmap's row stride, which may be padded
+// beyond width * pixel stride.
+uint32_t GetStagingRowStride(const grfx::Device* pDevice, const Bitmap* pBitmap)
+{
+    uint32_t rowCopySize           = pBitmap->GetWidth() * pBitmap->GetPixelStride();
+    uint32_t apiRowStrideAligement = grfx::IsDx12(pDevice->GetApi()) ? PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT : 1;
+    return RoundUp<uint32_t>(rowCopySize, apiRowStrideAligement);
+}
+
+// D3D12 requires copy footprints to start on a 512 byte boundary, Vulkan
+// requires a multiple of the texel size and of 4.
+uint64_t GetStagingAlignment(const grfx::Device* pDevice, const Bitmap* pBitmap)
+{
+    if (grfx::IsDx12(pDevice->GetApi())) {
+        return PPX_D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+    }
+    return std::lcm<uint64_t>(pBitmap->GetPixelStride(), 4);
+}
+
+} // namespace
+
 Result CopyBitmapToImage(
     grfx::Queue*        pQueue,
     const Bitmap*       pBitmap,
@@ -98,51 +130,188 @@ Result CopyBitmapToImage(
     PPX_ASSERT_NULL_ARG(pBitmap);
     PPX_ASSERT_NULL_ARG(pImage);
 
-    Result ppxres = ppx::ERROR_FAILED;
-
-    // Scoped destroy
-    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+    grfx::Device* pDevice = pQueue->GetDevice();
 
     // This is the number of bytes we're going to copy per row.
     uint32_t rowCopySize = pBitmap->GetWidth() * pBitmap->GetPixelStride();
 
-    // When copying from a buffer to a image/texture, D3D12 requires that the rows
-    // stored in the source buffer (aka staging buffer) are aligned to 256 bytes.
-    // Vulkan does not have this requirement. So for the staging buffer, we want
-    // to enforce the alignment for D3D12 but not for Vulkan.
-    //
-    uint32_t apiRowStrideAligement = grfx::IsDx12(pQueue->GetDevice()->GetApi()) ? PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT : 1;
-    // The staging buffer's row stride alignemnt needs to be based off the bitmap's
-    // width (i.e. the number of bytes we're going to copy) and not the bitmap's row
-    // stride. The bitmap's may be padded beyond width * pixel stride.
-    //
-    uint32_t stagingBufferRowStride = RoundUp<uint32_t>(rowCopySize, apiRowStrideAligement);
+    uint32_t stagingBufferRowStride = GetStagingRowStride(pDevice, pBitmap);
 
-    // Create staging buffer
-    grfx::BufferPtr stagingBuffer;
+    // Allocate staging memory from the device's staging ring
+    grfx::StagingRing* pStagingRing = nullptr;
+    Result             ppxres       = pDevice->GetStagingRing(&pStagingRing);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::StagingAllocation staging = {};
+    ppxres                          = pStagingRing->Allocate(
+        static_cast<uint64_t>(stagingBufferRowStride) * pBitmap->GetHeight(),
+        GetStagingAlignment(pDevice, pBitmap),
+        &staging);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Copy to staging memory
     {
-        uint64_t bufferSize = stagingBufferRowStride * pBitmap->GetHeight();
+        const char*    pSrc         = pBitmap->GetData();
+        char*          pDst         = static_cast<char*>(staging.pMappedAddress);
+        const uint32_t srcRowStride = pBitmap->GetRowStride();
+        const uint32_t dstRowStride = stagingBufferRowStride;
+        for (uint32_t y = 0; y < pBitmap->GetHeight(); ++y) {
+            memcpy(pDst, pSrc, rowCopySize);
+            pSrc += srcRowStride;
+            pDst += dstRowStride;
+        }
+    }
 
-        grfx::BufferCreateInfo ci      = {};
-        ci.size                        = bufferSize;
-        ci.usageFlags.bits.transferSrc = true;
-        ci.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+    // Copy info
+    grfx::BufferToImageCopyInfo copyInfo = {};
+    copyInfo.srcBuffer.imageWidth        = pBitmap->GetWidth();
+    copyInfo.srcBuffer.imageHeight       = pBitmap->GetHeight();
+    copyInfo.srcBuffer.imageRowStride    = stagingBufferRowStride;
+    copyInfo.srcBuffer.footprintOffset   = staging.offset;
+    copyInfo.srcBuffer.footprintWidth    = pBitmap->GetWidth();
+    copyInfo.srcBuffer.footprintHeight   = pBitmap->GetHeight();
+    copyInfo.srcBuffer.footprintDepth    = 1;
+    copyInfo.dstImage.mipLevel           = mipLevel;
+    copyInfo.dstImage.arrayLayer         = arrayLayer;
+    copyInfo.dstImage.arrayLayerCount    = 1;
+    copyInfo.dstImage.x                  = 0;
+    copyInfo.dstImage.y                  = 0;
+    copyInfo.dstImage.z                  = 0;
+    copyInfo.dstImage.width              = pBitmap->GetWidth();
+    copyInfo.dstImage.height             = pBitmap->GetHeight();
+    copyInfo.dstImage.depth              = 1;
 
-        ppxres = pQueue->GetDevice()->CreateBuffer(&ci, &stagingBuffer);
+    // Copy to GPU image, this waits for the copy to complete so the
+    // staging memory can be released right after.
+    ppxres = pQueue->CopyBufferToImage(
+        std::vector<grfx::BufferToImageCopyInfo>{copyInfo},
+        staging.pBuffer,
+        pImage,
+        mipLevel,
+        1,
+        arrayLayer,
+        1,
+        stateBefore,
+        stateAfter);
+    pStagingRing->Free(staging);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Called on error paths before pObject is destroyed, when copies into it
+// may already be recorded in pUploadQueue. If the copies can't be waited
+// on pObject is leaked instead, the device frees it when it's destroyed.
+template <typename ObjectT>
+void WaitForCopiesOrLeak(grfx::UploadQueue* pUploadQueue, ObjectT* pObject)
+{
+    Result ppxres = pUploadQueue->WaitIdle();
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("Failed to wait for upload queue, leaking the object it copies to: " << ToString(ppxres));
+        pObject->SetOwnership(grfx::OWNERSHIP_REFERENCE);
+    }
+}
+
+// Copies levelCount levels of pMipmap to pImage. If pUploadQueue is null a
+// transient upload queue is used and waited on before returning, so all
+// levels still go out in a single submission. On failure no copy into
+// pImage is pending, so the caller can destroy it unless its ownership
+// was changed to OWNERSHIP_REFERENCE.
+Result CopyMipmapToImage(
+    grfx::Queue*        pQueue,
+    grfx::UploadQueue*  pUploadQueue,
+    const Mipmap*       pMipmap,
+    uint32_t            levelCount,
+    grfx::Image*        pImage,
+    grfx::ResourceState state)
+{
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+    grfx::UploadQueuePtr transientUploadQueue;
+    if (IsNull(pUploadQueue)) {
+        grfx::UploadQueueCreateInfo ci = {};
+        ci.pQueue                      = pQueue;
+        ci.batchCount                  = 1;
+
+        Result ppxres = pQueue->GetDevice()->CreateUploadQueue(&ci, &transientUploadQueue);
         if (Failed(ppxres)) {
             return ppxres;
         }
-        SCOPED_DESTROYER.AddObject(stagingBuffer);
+        SCOPED_DESTROYER.AddObject(transientUploadQueue);
 
-        // Map and copy to staging buffer
-        void* pBufferAddress = nullptr;
-        ppxres               = stagingBuffer->MapMemory(0, &pBufferAddress);
+        pUploadQueue = transientUploadQueue;
+    }
+
+    for (uint32_t mipLevel = 0; mipLevel < levelCount; ++mipLevel) {
+        const Bitmap* pMip = pMipmap->GetMip(mipLevel);
+
+        Result ppxres = CopyBitmapToImage(
+            pUploadQueue,
+            pMip,
+            pImage,
+            mipLevel,
+            0,
+            state,
+            state);
         if (Failed(ppxres)) {
+            if (mipLevel > 0) {
+                WaitForCopiesOrLeak(pUploadQueue, pImage);
+            }
             return ppxres;
         }
+    }
 
+    if (transientUploadQueue) {
+        Result ppxres = transientUploadQueue->WaitIdle();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+} // namespace
+
+Result CopyBitmapToImage(
+    grfx::UploadQueue*  pUploadQueue,
+    const Bitmap*       pBitmap,
+    grfx::Image*        pImage,
+    uint32_t            mipLevel,
+    uint32_t            arrayLayer,
+    grfx::ResourceState stateBefore,
+    grfx::ResourceState stateAfter)
+{
+    PPX_ASSERT_NULL_ARG(pUploadQueue);
+    PPX_ASSERT_NULL_ARG(pBitmap);
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    const grfx::Device* pDevice                = pUploadQueue->GetDevice();
+    const uint32_t      rowCopySize            = pBitmap->GetWidth() * pBitmap->GetPixelStride();
+    const uint32_t      stagingBufferRowStride = GetStagingRowStride(pDevice, pBitmap);
+
+    // Copy rows to staging memory
+    grfx::StagingAllocation staging = {};
+    Result                  ppxres  = pUploadQueue->AllocateStaging(
+        static_cast<uint64_t>(stagingBufferRowStride) * pBitmap->GetHeight(),
+        GetStagingAlignment(pDevice, pBitmap),
+        &staging);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    {
         const char*    pSrc         = pBitmap->GetData();
-        char*          pDst         = static_cast<char*>(pBufferAddress);
+        char*          pDst         = static_cast<char*>(staging.pMappedAddress);
         const uint32_t srcRowStride = pBitmap->GetRowStride();
         const uint32_t dstRowStride = stagingBufferRowStride;
         for (uint32_t y = 0; y < pBitmap->GetHeight(); ++y) {
@@ -150,8 +319,6 @@ Result CopyBitmapToImage(
             pSrc += srcRowStride;
             pDst += dstRowStride;
         }
-
-        stagingBuffer->UnmapMemory();
     }
 
     // Copy info
@@ -159,7 +326,7 @@ Result CopyBitmapToImage(
     copyInfo.srcBuffer.imageWidth        = pBitmap->GetWidth();
     copyInfo.srcBuffer.imageHeight       = pBitmap->GetHeight();
     copyInfo.srcBuffer.imageRowStride    = stagingBufferRowStride;
-    copyInfo.srcBuffer.footprintOffset   = 0;
+    copyInfo.srcBuffer.footprintOffset   = staging.offset;
     copyInfo.srcBuffer.footprintWidth    = pBitmap->GetWidth();
     copyInfo.srcBuffer.footprintHeight   = pBitmap->GetHeight();
     copyInfo.srcBuffer.footprintDepth    = 1;
@@ -173,10 +340,10 @@ Result CopyBitmapToImage(
     copyInfo.dstImage.height             = pBitmap->GetHeight();
     copyInfo.dstImage.depth              = 1;
 
-    // Copy to GPU image
-    ppxres = pQueue->CopyBufferToImage(
+    // Record copy to GPU image
+    ppxres = pUploadQueue->CopyBufferToImage(
         std::vector<grfx::BufferToImageCopyInfo>{copyInfo},
-        stagingBuffer,
+        staging,
         pImage,
         mipLevel,
         1,
@@ -245,20 +412,9 @@ Result CreateImageFromBitmap(
     }
 
     // Copy mips to image
-    for (uint32_t mipLevel = 0; mipLevel < mipLevelCount; ++mipLevel) {
-        const Bitmap* pMip = mipmap.GetMip(mipLevel);
-
-        ppxres = CopyBitmapToImage(
-            pQueue,
-            pMip,
-            targetImage,
-            mipLevel,
-            0,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE);
-        if (Failed(ppxres)) {
-            return ppxres;
-        }
+    ppxres = CopyMipmapToImage(pQueue, options.mUploadQueue, &mipmap, mipLevelCount, targetImage, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+    if (Failed(ppxres)) {
+        return ppxres;
     }
 
     // Change ownership to reference so object doesn't get destroyed
@@ -575,6 +731,69 @@ Result CreateImageFromBitmapGpu(
     return ppx::SUCCESS;
 }
 
+Result CreateImageFromMipmap(
+    grfx::Queue*        pQueue,
+    const Mipmap*       pMipmap,
+    grfx::Image**       ppImage,
+    const ImageOptions& options)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(pMipmap);
+    PPX_ASSERT_NULL_ARG(ppImage);
+
+    if (!pMipmap->IsOk()) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    Result ppxres = ppx::ERROR_FAILED;
+
+    // Scoped destroy
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+    const Bitmap*  pMip0         = pMipmap->GetMip(0);
+    const uint32_t mipLevelCount = pMipmap->GetLevelCount();
+
+    // Create target image
+    grfx::ImagePtr targetImage;
+    {
+        grfx::ImageCreateInfo ci       = {};
+        ci.type                        = grfx::IMAGE_TYPE_2D;
+        ci.width                       = pMip0->GetWidth();
+        ci.height                      = pMip0->GetHeight();
+        ci.depth                       = 1;
+        ci.format                      = ToGrfxFormat(pMip0->GetFormat());
+        ci.sampleCount                 = grfx::SAMPLE_COUNT_1;
+        ci.mipLevelCount               = mipLevelCount;
+        ci.arrayLayerCount             = 1;
+        ci.usageFlags.bits.transferDst = true;
+        ci.usageFlags.bits.sampled     = true;
+        ci.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        ci.initialState                = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+        ci.usageFlags.flags |= options.mAdditionalUsage;
+
+        ppxres = pQueue->GetDevice()->CreateImage(&ci, &targetImage);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(targetImage);
+    }
+
+    // Copy mips to image
+    ppxres = CopyMipmapToImage(pQueue, options.mUploadQueue, pMipmap, mipLevelCount, targetImage, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Change ownership to reference so object doesn't get destroyed
+    targetImage->SetOwnership(grfx::OWNERSHIP_REFERENCE);
+
+    // Assign output
+    *ppImage = targetImage;
+
+    return ppx::SUCCESS;
+}
+
 bool IsDDSFile(const std::filesystem::path& path)
 {
     return (std::strstr(path.string().c_str(), ".dds") != nullptr || std::strstr(path.string().c_str(), ".ktx") != nullptr);
@@ -845,6 +1064,177 @@ Result CreateImageFromFile(
 
 // -------------------------------------------------------------------------------------------------
 
+namespace {
+
+// Decodes every file and generates up to maxLevelCount mip levels for each
+// on pThreadPool. The stages are split so their times can be reported
+// separately, each bitmap is released as soon as its mipmap is built.
+Result LoadMipmapsFromFiles(
+    const std::vector<std::filesystem::path>& paths,
+    uint32_t                                  maxLevelCount,
+    ThreadPool*                               pThreadPool,
+    std::vector<std::unique_ptr<Mipmap>>*     pMipmaps,
+    BatchLoadStats*                           pStats)
+{
+    ThreadPool&    pool  = IsNull(pThreadPool) ? ThreadPool::GetDefault() : *pThreadPool;
+    const uint32_t count = CountU32(paths);
+
+    std::vector<std::unique_ptr<Bitmap>> bitmaps(count);
+    std::vector<Result>                  results(count, ppx::SUCCESS);
+
+    Timer timer;
+    timer.Start();
+    pool.ParallelFor(count, [&](uint32_t i) {
+        if (!Bitmap::IsBitmapFile(paths[i])) {
+            results[i] = ppx::ERROR_IMAGE_FILE_LOAD_FAILED;
+            return;
+        }
+        bitmaps[i] = std::make_unique<Bitmap>();
+        results[i] = Bitmap::LoadFile(paths[i], bitmaps[i].get());
+    });
+    const double decodeMs = timer.MillisSinceStart();
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (Failed(results[i])) {
+            PPX_LOG_ERROR("Failed to load image file: " << paths[i]);
+            return results[i];
+        }
+    }
+
+    pMipmaps->clear();
+    pMipmaps->resize(count);
+
+    timer.Start();
+    pool.ParallelFor(count, [&](uint32_t i) {
+        const Bitmap&  bitmap     = *bitmaps[i];
+        const uint32_t levelCount = std::min<uint32_t>(maxLevelCount, Mipmap::CalculateLevelCount(bitmap.GetWidth(), bitmap.GetHeight()));
+
+        // Several mipmaps are alive at once so the static pool can't be used.
+        (*pMipmaps)[i] = std::make_unique<Mipmap>(bitmap, levelCount);
+        if (!(*pMipmaps)[i]->IsOk()) {
+            results[i] = ppx::ERROR_FAILED;
+        }
+        bitmaps[i].reset();
+    });
+    const double mipMs = timer.MillisSinceStart();
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (Failed(results[i])) {
+            PPX_LOG_ERROR("Failed to generate mip levels for image file: " << paths[i]);
+            return results[i];
+        }
+    }
+
+    if (!IsNull(pStats)) {
+        pStats->decodeMs    = decodeMs;
+        pStats->mipMs       = mipMs;
+        // ParallelFor() also runs work items on the calling thread
+        pStats->threadCount = pool.GetThreadCount() + 1;
+    }
+
+    return ppx::SUCCESS;
+}
+
+// Uploads the mipmaps of paths with one upload queue, a transient one if
+// pUploadQueue is null. createFn(pMipmap, pUploadQueue, object) creates
+// each object and records its copies. Either every object is created or
+// none are kept.
+template <typename ObjectPtrT, typename CreateFn>
+Result CreateObjectsFromFiles(
+    grfx::Queue*                              pQueue,
+    const std::vector<std::filesystem::path>& paths,
+    uint32_t                                  maxLevelCount,
+    grfx::UploadQueue*                        pUploadQueue,
+    ThreadPool*                               pThreadPool,
+    BatchLoadStats*                           pStats,
+    std::vector<ObjectPtrT>*                  pObjects,
+    CreateFn                                  createFn)
+{
+    std::vector<std::unique_ptr<Mipmap>> mipmaps;
+    Result                               ppxres = LoadMipmapsFromFiles(paths, maxLevelCount, pThreadPool, &mipmaps, pStats);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    Timer uploadTimer;
+    uploadTimer.Start();
+
+    // Scoped destroy
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+    grfx::UploadQueuePtr transientUploadQueue;
+    if (IsNull(pUploadQueue)) {
+        grfx::UploadQueueCreateInfo ci = {};
+        ci.pQueue                      = pQueue;
+        ci.batchCount                  = 1;
+
+        ppxres = pQueue->GetDevice()->CreateUploadQueue(&ci, &transientUploadQueue);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(transientUploadQueue);
+
+        pUploadQueue = transientUploadQueue;
+    }
+
+    std::vector<ObjectPtrT> objects(paths.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        ppxres = createFn(mipmaps[i].get(), pUploadQueue, objects[i]);
+        if (Failed(ppxres)) {
+            // Copies into the objects created so far may already be recorded,
+            // after the first wait the others return right away
+            for (size_t j = 0; j < i; ++j) {
+                SCOPED_DESTROYER.AddObject(objects[j]);
+                WaitForCopiesOrLeak(pUploadQueue, objects[j].Get());
+            }
+            return ppxres;
+        }
+        // Level data has been copied to staging memory
+        mipmaps[i].reset();
+    }
+
+    if (transientUploadQueue) {
+        ppxres = transientUploadQueue->WaitIdle();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    if (!IsNull(pStats)) {
+        pStats->uploadMs = uploadTimer.MillisSinceStart();
+    }
+
+    *pObjects = std::move(objects);
+
+    return ppx::SUCCESS;
+}
+
+} // namespace
+
+Result CreateImagesFromFiles(
+    grfx::Queue*                              pQueue,
+    const std::vector<std::filesystem::path>& paths,
+    std::vector<grfx::ImagePtr>*              pImages,
+    const ImageOptions&                       options,
+    ThreadPool*                               pThreadPool,
+    BatchLoadStats*                           pStats)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(pImages);
+
+    ScopedTimer timer("Image creation from " + std::to_string(paths.size()) + " files");
+
+    auto createImage = [pQueue, &options](const Mipmap* pMipmap, grfx::UploadQueue* pUploadQueue, grfx::ImagePtr& image) -> Result {
+        ImageOptions batchOptions = options;
+        batchOptions.UploadQueue(pUploadQueue);
+        return CreateImageFromMipmap(pQueue, pMipmap, &image, batchOptions);
+    };
+
+    return CreateObjectsFromFiles(pQueue, paths, options.mMipLevelCount, options.mUploadQueue, pThreadPool, pStats, pImages, createImage);
+}
+
+// -------------------------------------------------------------------------------------------------
+
 Result CopyBitmapToTexture(
     grfx::Queue*        pQueue,
     const Bitmap*       pBitmap,
@@ -936,20 +1326,9 @@ Result CreateTextureFromBitmap(
     }
 
     // Copy mips to texture
-    for (uint32_t mipLevel = 0; mipLevel < mipLevelCount; ++mipLevel) {
-        const Bitmap* pMip = mipmap.GetMip(mipLevel);
-
-        ppxres = CopyBitmapToTexture(
-            pQueue,
-            pMip,
-            targetTexture,
-            mipLevel,
-            0,
-            options.mInitialState,
-            options.mInitialState);
-        if (Failed(ppxres)) {
-            return ppxres;
-        }
+    ppxres = CopyMipmapToImage(pQueue, options.mUploadQueue, &mipmap, mipLevelCount, targetTexture->GetImage(), options.mInitialState);
+    if (Failed(ppxres)) {
+        return ppxres;
     }
 
     // Change ownership to reference so object doesn't get destroyed
@@ -1015,20 +1394,9 @@ Result CreateTextureFromMipmap(
     }
 
     // Copy mips to texture
-    for (uint32_t mipLevel = 0; mipLevel < pMipmap->GetLevelCount(); ++mipLevel) {
-        const Bitmap* pMip = pMipmap->GetMip(mipLevel);
-
-        ppxres = CopyBitmapToTexture(
-            pQueue,
-            pMip,
-            targetTexture,
-            mipLevel,
-            0,
-            options.mInitialState,
-            options.mInitialState);
-        if (Failed(ppxres)) {
-            return ppxres;
-        }
+    ppxres = CopyMipmapToImage(pQueue, options.mUploadQueue, pMipmap, pMipmap->GetLevelCount(), targetTexture->GetImage(), options.mInitialState);
+    if (Failed(ppxres)) {
+        return ppxres;
     }
 
     // Change ownership to reference so object doesn't get destroyed
@@ -1062,6 +1430,28 @@ Result CreateTextureFromFile(
     return CreateTextureFromBitmap(pQueue, &bitmap, ppTexture, options);
 }
 
+Result CreateTexturesFromFiles(
+    grfx::Queue*                              pQueue,
+    const std::vector<std::filesystem::path>& paths,
+    std::vector<grfx::TexturePtr>*            pTextures,
+    const TextureOptions&                     options,
+    ThreadPool*                               pThreadPool,
+    BatchLoadStats*                           pStats)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(pTextures);
+
+    ScopedTimer timer("Texture creation from " + std::to_string(paths.size()) + " image files");
+
+    auto createTexture = [pQueue, &options](const Mipmap* pMipmap, grfx::UploadQueue* pUploadQueue, grfx::TexturePtr& texture) -> Result {
+        TextureOptions batchOptions = options;
+        batchOptions.UploadQueue(pUploadQueue);
+        return CreateTextureFromMipmap(pQueue, pMipmap, &texture, batchOptions);
+    };
+
+    return CreateObjectsFromFiles(pQueue, paths, options.mMipLevelCount, options.mUploadQueue, pThreadPool, pStats, pTextures, createTexture);
+}
+
 // -------------------------------------------------------------------------------------------------
 
 struct SubImage
@@ -1333,104 +1723,229 @@ Result CreateCubeMapFromFile(
 
 // -------------------------------------------------------------------------------------------------
 
-Result CreateMeshFromGeometry(
-    grfx::Queue*    pQueue,
-    const Geometry* pGeometry,
-    grfx::Mesh**    ppMesh)
+namespace {
+
+// Mesh caches written by CreateMeshFromFile(), relative to the output directory
+const char* kMeshCacheDirectory = "mesh_cache";
+
+// Creates a mesh from createInfo and records the copies of its buffers into
+// pUploadQueue. ppVertexData and pVertexDataSizes have one element per
+// vertex buffer.
+Result CreateMeshFromBuffers(
+    grfx::UploadQueue*          pUploadQueue,
+    const grfx::MeshCreateInfo& createInfo,
+    const void*                 pIndexData,
+    uint32_t                    indexDataSize,
+    const void* const*          ppVertexData,
+    const uint32_t*             pVertexDataSizes,
+    grfx::Mesh**                ppMesh)
 {
-    PPX_ASSERT_NULL_ARG(pQueue);
-    PPX_ASSERT_NULL_ARG(pGeometry);
-    PPX_ASSERT_NULL_ARG(ppMesh);
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pUploadQueue->GetDevice());
 
-    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+    // Create target mesh
+    grfx::MeshPtr targetMesh;
+    {
+        Result ppxres = pUploadQueue->GetDevice()->CreateMesh(&createInfo, &targetMesh);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(targetMesh);
+    }
 
-    // Create staging buffer
-    grfx::BufferPtr stagingBuffer;
+    // Every buffer's data is staged before any copy is recorded, so running
+    // out of staging memory leaves no copy into the mesh in pUploadQueue
+    struct BufferUpload
     {
-        uint32_t biggestBufferSize = pGeometry->GetLargestBufferSize();
+        uint64_t                size    = 0;
+        const void*             pData   = nullptr;
+        grfx::Buffer*           pBuffer = nullptr;
+        grfx::ResourceState     state   = grfx::RESOURCE_STATE_UNDEFINED;
+        grfx::StagingAllocation staging = {};
+    };
 
-        grfx::BufferCreateInfo ci      = {};
-        ci.size                        = biggestBufferSize;
-        ci.usageFlags.bits.transferSrc = true;
-        ci.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+    std::vector<BufferUpload> uploads;
+    if ((createInfo.indexType != grfx::INDEX_TYPE_UNDEFINED) && (indexDataSize > 0)) {
+        uploads.push_back({indexDataSize, pIndexData, targetMesh->GetIndexBuffer(), grfx::RESOURCE_STATE_INDEX_BUFFER});
+    }
+    for (uint32_t i = 0; i < createInfo.vertexBufferCount; ++i) {
+        if (pVertexDataSizes[i] > 0) {
+            uploads.push_back({pVertexDataSizes[i], ppVertexData[i], targetMesh->GetVertexBuffer(i), grfx::RESOURCE_STATE_VERTEX_BUFFER});
+        }
+    }
 
-        Result ppxres = pQueue->GetDevice()->CreateBuffer(&ci, &stagingBuffer);
+    for (size_t i = 0; i < uploads.size(); ++i) {
+        Result ppxres = pUploadQueue->AllocateStaging(uploads[i].size, 4, &uploads[i].staging);
         if (Failed(ppxres)) {
+            for (size_t j = 0; j < i; ++j) {
+                pUploadQueue->FreeStaging(uploads[j].staging);
+            }
             return ppxres;
         }
-        SCOPED_DESTROYER.AddObject(stagingBuffer);
+        memcpy(uploads[i].staging.pMappedAddress, uploads[i].pData, static_cast<size_t>(uploads[i].size));
     }
 
-    // Create target mesh
-    grfx::MeshPtr targetMesh;
-    {
-        grfx::MeshCreateInfo ci = grfx::MeshCreateInfo(*pGeometry);
+    for (size_t i = 0; i < uploads.size(); ++i) {
+        grfx::BufferToBufferCopyInfo copyInfo = {};
+        copyInfo.size                         = uploads[i].size;
+        copyInfo.srcBuffer.offset             = uploads[i].staging.offset;
+        copyInfo.dstBuffer.offset             = 0;
 
-        Result ppxres = pQueue->GetDevice()->CreateMesh(&ci, &targetMesh);
+        Result ppxres = pUploadQueue->CopyBufferToBuffer(&copyInfo, uploads[i].staging, uploads[i].pBuffer, uploads[i].state, uploads[i].state);
         if (Failed(ppxres)) {
+            // The failed copy released its staging, the rest is still ours
+            for (size_t j = i + 1; j < uploads.size(); ++j) {
+                pUploadQueue->FreeStaging(uploads[j].staging);
+            }
+            if (i > 0) {
+                WaitForCopiesOrLeak(pUploadQueue, targetMesh.Get());
+            }
             return ppxres;
         }
-        SCOPED_DESTROYER.AddObject(targetMesh);
     }
 
-    // Copy geometry data to mesh
-    {
-        // Copy info
-        grfx::BufferToBufferCopyInfo copyInfo = {};
+    // Change ownership to reference so object doesn't get destroyed
+    targetMesh->SetOwnership(grfx::OWNERSHIP_REFERENCE);
 
-        // Index buffer
-        if (pGeometry->GetIndexType() != grfx::INDEX_TYPE_UNDEFINED) {
-            const Geometry::Buffer* pGeoBuffer = pGeometry->GetIndexBuffer();
-            PPX_ASSERT_NULL_ARG(pGeoBuffer);
+    // Assign output
+    *ppMesh = targetMesh;
 
-            uint32_t geoBufferSize = pGeoBuffer->GetSize();
+    return ppx::SUCCESS;
+}
 
-            Result ppxres = stagingBuffer->CopyFromSource(geoBufferSize, pGeoBuffer->GetData());
-            if (Failed(ppxres)) {
-                return ppxres;
-            }
+// Records the mesh's copies with a transient upload queue on pQueue and
+// waits for them.
+template <typename RecordFn>
+Result CreateMeshWithTransientUploadQueue(grfx::Queue* pQueue, grfx::Mesh** ppMesh, RecordFn record)
+{
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
 
-            copyInfo.size = geoBufferSize;
+    // Create upload queue, staging memory comes from the device's staging ring
+    grfx::UploadQueuePtr uploadQueue;
+    {
+        grfx::UploadQueueCreateInfo ci = {};
+        ci.pQueue                      = pQueue;
+        ci.batchCount                  = 1;
 
-            // Copy to GPU buffer
-            ppxres = pQueue->CopyBufferToBuffer(&copyInfo, stagingBuffer, targetMesh->GetIndexBuffer(), grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_INDEX_BUFFER);
-            if (Failed(ppxres)) {
-                return ppxres;
-            }
+        Result ppxres = pQueue->GetDevice()->CreateUploadQueue(&ci, &uploadQueue);
+        if (Failed(ppxres)) {
+            return ppxres;
         }
+        SCOPED_DESTROYER.AddObject(uploadQueue);
+    }
 
-        // Vertex buffers
-        uint32_t vertexBufferCount = pGeometry->GetVertexBufferCount();
-        for (uint32_t i = 0; i < vertexBufferCount; ++i) {
-            const Geometry::Buffer* pGeoBuffer = pGeometry->GetVertexBuffer(i);
-            PPX_ASSERT_NULL_ARG(pGeoBuffer);
+    Result ppxres = record(uploadQueue.Get());
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
 
-            uint32_t geoBufferSize = pGeoBuffer->GetSize();
+    ppxres = uploadQueue->WaitIdle();
+    if (Failed(ppxres)) {
+        // The copies may still be in flight, the mesh is only destroyed
+        // once the device is known to be idle and leaked otherwise
+        grfx::Mesh* pMesh = *ppMesh;
+        *ppMesh           = nullptr;
+        if (Success(pQueue->GetDevice()->WaitIdle())) {
+            pQueue->GetDevice()->DestroyMesh(pMesh);
+        }
+        return ppxres;
+    }
 
-            Result ppxres = stagingBuffer->CopyFromSource(geoBufferSize, pGeoBuffer->GetData());
-            if (Failed(ppxres)) {
-                return ppxres;
-            }
+    return ppx::SUCCESS;
+}
 
-            copyInfo.size = geoBufferSize;
+} // namespace
 
-            grfx::BufferPtr targetBuffer = targetMesh->GetVertexBuffer(i);
+Result CreateMeshFromGeometry(
+    grfx::Queue*    pQueue,
+    const Geometry* pGeometry,
+    grfx::Mesh**    ppMesh)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(pGeometry);
+    PPX_ASSERT_NULL_ARG(ppMesh);
 
-            // Copy to GPU buffer
-            ppxres = pQueue->CopyBufferToBuffer(&copyInfo, stagingBuffer, targetBuffer, grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_VERTEX_BUFFER);
-            if (Failed(ppxres)) {
-                return ppxres;
-            }
-        }
+    return CreateMeshWithTransientUploadQueue(pQueue, ppMesh, [pGeometry, ppMesh](grfx::UploadQueue* pUploadQueue) {
+        return CreateMeshFromGeometry(pUploadQueue, pGeometry, ppMesh);
+    });
+}
+
+Result CreateMeshFromGeometry(
+    grfx::UploadQueue* pUploadQueue,
+    const Geometry*    pGeometry,
+    grfx::Mesh**       ppMesh)
+{
+    PPX_ASSERT_NULL_ARG(pUploadQueue);
+    PPX_ASSERT_NULL_ARG(pGeometry);
+    PPX_ASSERT_NULL_ARG(ppMesh);
+
+    const grfx::MeshCreateInfo createInfo = grfx::MeshCreateInfo(*pGeometry);
+
+    const void* vertexData[PPX_MAX_VERTEX_BINDINGS]     = {};
+    uint32_t    vertexDataSizes[PPX_MAX_VERTEX_BINDINGS] = {};
+    for (uint32_t i = 0; i < pGeometry->GetVertexBufferCount(); ++i) {
+        const Geometry::Buffer* pGeoBuffer = pGeometry->GetVertexBuffer(i);
+        PPX_ASSERT_NULL_ARG(pGeoBuffer);
+        vertexData[i]      = pGeoBuffer->GetData();
+        vertexDataSizes[i] = pGeoBuffer->GetSize();
     }
 
-    // Change ownership to reference so object doesn't get destroyed
-    targetMesh->SetOwnership(grfx::OWNERSHIP_REFERENCE);
+    return CreateMeshFromBuffers(
+        pUploadQueue,
+        createInfo,
+        pGeometry->GetIndexBuffer()->GetData(),
+        pGeometry->GetIndexBuffer()->GetSize(),
+        vertexData,
+        vertexDataSizes,
+        ppMesh);
+}
 
-    // Assign output
-    *ppMesh = targetMesh;
+Result CreateMeshFromMeshCache(
+    grfx::UploadQueue*   pUploadQueue,
+    const MeshCacheFile* pMeshCache,
+    grfx::Mesh**         ppMesh)
+{
+    PPX_ASSERT_NULL_ARG(pUploadQueue);
+    PPX_ASSERT_NULL_ARG(pMeshCache);
+    PPX_ASSERT_NULL_ARG(ppMesh);
 
-    return ppx::SUCCESS;
+    // Same description grfx::MeshCreateInfo derives from a Geometry
+    const GeometryOptions& options    = pMeshCache->GetGeometryOptions();
+    grfx::MeshCreateInfo   createInfo = {};
+    createInfo.indexType              = pMeshCache->GetIndexType();
+    createInfo.indexCount             = pMeshCache->GetIndexCount();
+    createInfo.vertexCount            = pMeshCache->GetVertexCount();
+    createInfo.vertexBufferCount      = pMeshCache->GetVertexBufferCount();
+    createInfo.memoryUsage            = grfx::MEMORY_USAGE_GPU_ONLY;
+
+    const void* vertexData[PPX_MAX_VERTEX_BINDINGS]     = {};
+    uint32_t    vertexDataSizes[PPX_MAX_VERTEX_BINDINGS] = {};
+    for (uint32_t bindingIdx = 0; bindingIdx < options.vertexBindingCount; ++bindingIdx) {
+        const grfx::VertexBinding& binding   = options.vertexBindings[bindingIdx];
+        const uint32_t             attrCount = binding.GetAttributeCount();
+
+        createInfo.vertexBuffers[bindingIdx].attributeCount = attrCount;
+        for (uint32_t attrIdx = 0; attrIdx < attrCount; ++attrIdx) {
+            const grfx::VertexAttribute* pAttribute = nullptr;
+            binding.GetAttribute(attrIdx, &pAttribute);
+
+            createInfo.vertexBuffers[bindingIdx].attributes[attrIdx].format         = pAttribute->format;
+            createInfo.vertexBuffers[bindingIdx].attributes[attrIdx].stride         = 0; // Calculated by the mesh
+            createInfo.vertexBuffers[bindingIdx].attributes[attrIdx].vertexSemantic = pAttribute->semantic;
+        }
+        createInfo.vertexBuffers[bindingIdx].vertexInputRate = grfx::VERTEX_INPUT_RATE_VERTEX;
+
+        vertexData[bindingIdx]      = pMeshCache->GetVertexData(bindingIdx);
+        vertexDataSizes[bindingIdx] = pMeshCache->GetVertexDataSize(bindingIdx);
+    }
+
+    return CreateMeshFromBuffers(
+        pUploadQueue,
+        createInfo,
+        pMeshCache->GetIndexData(),
+        pMeshCache->GetIndexDataSize(),
+        vertexData,
+        vertexDataSizes,
+        ppMesh);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1493,14 +2008,59 @@ Result CreateMeshFromFile(
     grfx::Queue*                 pQueue,
     const std::filesystem::path& path,
     grfx::Mesh**                 ppMesh,
-    const TriMeshOptions&        options)
+    const TriMeshOptions&        options,
+    bool                         useMeshCache)
 {
     PPX_ASSERT_NULL_ARG(pQueue);
     PPX_ASSERT_NULL_ARG(ppMesh);
 
+    if (!useMeshCache) {
+        TriMesh mesh = TriMesh::CreateFromOBJ(path, options);
+
+        Result ppxres = CreateMeshFromTriMesh(pQueue, &mesh, ppMesh);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        return ppx::SUCCESS;
+    }
+
+    uint64_t sourceHash = 0;
+    Result   ppxres     = MeshCacheFile::HashSource(path, options, &sourceHash);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    const std::filesystem::path cacheDirectory = fs::GetDefaultOutputDirectory() / kMeshCacheDirectory;
+    const std::filesystem::path cachePath      = MeshCacheFile::GetCachePath(cacheDirectory, path);
+
+    // Upload straight from the mapped cache when it's up to date
+    {
+        MeshCacheFile cache;
+        if (Success(cache.Open(cachePath, sourceHash))) {
+            return CreateMeshWithTransientUploadQueue(pQueue, ppMesh, [&cache, ppMesh](grfx::UploadQueue* pUploadQueue) {
+                return CreateMeshFromMeshCache(pUploadQueue, &cache, ppMesh);
+            });
+        }
+    }
+
     TriMesh mesh = TriMesh::CreateFromOBJ(path, options);
 
-    Result ppxres = CreateMeshFromTriMesh(pQueue, &mesh, ppMesh);
+    Geometry geo;
+    ppxres = Geometry::Create(mesh, &geo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // A cache that can't be written only costs the next load a parse
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDirectory, ec);
+    ppxres = MeshCacheFile::Write(cachePath, sourceHash, geo, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax());
+    if (Failed(ppxres)) {
+        PPX_LOG_WARN("Failed to write mesh cache " << cachePath << ": " << ToString(ppxres));
+    }
+
+    ppxres = CreateMeshFromGeometry(pQueue, &geo, ppMesh);
     if (Failed(ppxres)) {
         return ppxres;
     }
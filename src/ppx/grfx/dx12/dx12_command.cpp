@@ -31,6 +31,12 @@ namespace dx12 {
 // -------------------------------------------------------------------------------------------------
 Result CommandBuffer::CreateApiObjects(const grfx::internal::CommandBufferCreateInfo* pCreateInfo)
 {
+    // Bundles use the descriptor heaps of the command list that executes
+    // them, see grfx::internal::CommandBufferCreateInfo.
+    if (pCreateInfo->level == grfx::COMMAND_BUFFER_LEVEL_SECONDARY) {
+        return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+    }
+
     D3D12DevicePtr device = ToApi(GetDevice())->GetDxDevice();
 
     UINT                     nodeMask = 0;
@@ -244,6 +250,18 @@ void CommandBuffer::EndRenderPassImpl()
     // Nothing to do here for now
 }
 
+Result CommandBuffer::BeginSecondaryImpl(const grfx::RenderPass* pRenderPass)
+{
+    // Secondary command buffers are never created, see CreateApiObjects
+    PPX_ASSERT_MSG(false, "secondary command buffers are not supported on D3D12");
+    return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+}
+
+void CommandBuffer::ExecuteCommandsImpl(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers)
+{
+    PPX_ASSERT_MSG(false, "secondary command buffers are not supported on D3D12");
+}
+
 D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE ToBeginningAccessType(grfx::AttachmentLoadOp loadOp)
 {
     D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE accessType;
@@ -608,6 +626,45 @@ void CommandBuffer::BufferResourceBarrier(
     mCommandList->ResourceBarrier(1, &barrier);
 }
 
+// D3D12 only has same state barriers for unordered access. For other
+// states an aliasing barrier with no before resource orders all earlier
+// work on the resource's memory with later work.
+static D3D12_RESOURCE_BARRIER ToD3D12MemoryBarrier(ID3D12Resource* pResource, grfx::ResourceState state)
+{
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    if (state == grfx::RESOURCE_STATE_UNORDERED_ACCESS) {
+        barrier.Type          = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+        barrier.UAV.pResource = pResource;
+    }
+    else {
+        barrier.Type                     = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        barrier.Aliasing.pResourceBefore = nullptr;
+        barrier.Aliasing.pResourceAfter  = pResource;
+    }
+    return barrier;
+}
+
+void CommandBuffer::ImageMemoryBarrier(
+    const grfx::Image*  pImage,
+    grfx::ResourceState state)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    D3D12_RESOURCE_BARRIER barrier = ToD3D12MemoryBarrier(ToApi(pImage)->GetDxResource(), state);
+    mCommandList->ResourceBarrier(1, &barrier);
+}
+
+void CommandBuffer::BufferMemoryBarrier(
+    const grfx::Buffer* pBuffer,
+    grfx::ResourceState state)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    D3D12_RESOURCE_BARRIER barrier = ToD3D12MemoryBarrier(ToApi(pBuffer)->GetDxResource(), state);
+    mCommandList->ResourceBarrier(1, &barrier);
+}
+
 void CommandBuffer::SetViewports(
     uint32_t              viewportCount,
     const grfx::Viewport* pViewports)
@@ -119,6 +119,12 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
     return ppx::SUCCESS;
 }
 
+void Queue::DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores)
+{
+    // D3D12 fences are signaled with increasing values, signaling one again
+    // without a wait in between is fine so there's nothing to defer.
+}
+
 Result Queue::GetTimestampFrequency(uint64_t* pFrequency) const
 {
     if (IsNull(pFrequency)) {
@@ -65,10 +65,18 @@ Result Fence::Wait(uint64_t timeout)
 {
     UINT64 completedValue = mFence->GetCompletedValue();
     if (completedValue < GetWaitForValue()) {
+        // Polling, don't leave an event pending that a later wait would consume
+        if (timeout == 0) {
+            return ppx::ERROR_WAIT_TIMED_OUT;
+        }
+
         mFence->SetEventOnCompletion(mValue, mFenceEventHandle);
 
         DWORD dwMillis = (timeout == UINT64_MAX) ? INFINITE : static_cast<DWORD>(timeout / 1000000ULL);
-        WaitForSingleObjectEx(mFenceEventHandle, dwMillis, false);
+        DWORD result   = WaitForSingleObjectEx(mFenceEventHandle, dwMillis, false);
+        if (result == WAIT_TIMEOUT) {
+            return ppx::ERROR_WAIT_TIMED_OUT;
+        }
     }
     return ppx::SUCCESS;
 }
@@ -78,6 +86,16 @@ Result Fence::Reset()
     return ppx::SUCCESS;
 }
 
+Result Fence::SignalOnHost()
+{
+    HRESULT hr = mFence->Signal(GetNextSignalValue());
+    if (FAILED(hr)) {
+        PPX_ASSERT_MSG(false, "ID3D12Fence::Signal failed");
+        return ppx::ERROR_API_FAILURE;
+    }
+    return ppx::SUCCESS;
+}
+
 // -------------------------------------------------------------------------------------------------
 // Semaphore
 // -------------------------------------------------------------------------------------------------
@@ -113,6 +131,16 @@ UINT64 Semaphore::GetWaitForValue() const
     return mValue;
 }
 
+Result Semaphore::SignalOnHost()
+{
+    HRESULT hr = mFence->Signal(GetNextSignalValue());
+    if (FAILED(hr)) {
+        PPX_ASSERT_MSG(false, "ID3D12Fence::Signal failed");
+        return ppx::ERROR_API_FAILURE;
+    }
+    return ppx::SUCCESS;
+}
+
 } // namespace dx12
 } // namespace grfx
 } // namespace ppx
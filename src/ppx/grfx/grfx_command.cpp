@@ -50,7 +50,8 @@ void CommandBuffer::BeginRenderPass(const grfx::RenderPassBeginInfo* pBeginInfo)
     }
 
     BeginRenderPassImpl(pBeginInfo);
-    mCurrentRenderPass = pBeginInfo->pRenderPass;
+    mCurrentRenderPass         = pBeginInfo->pRenderPass;
+    mCurrentRenderPassContents = pBeginInfo->contents;
 }
 
 void CommandBuffer::EndRenderPass()
@@ -61,7 +62,8 @@ void CommandBuffer::EndRenderPass()
     PPX_ASSERT_MSG(!mDynamicRenderPassActive, "Dynamic render pass active, use EndRendering instead");
 
     EndRenderPassImpl();
-    mCurrentRenderPass = nullptr;
+    mCurrentRenderPass         = nullptr;
+    mCurrentRenderPassContents = grfx::RENDER_PASS_CONTENTS_INLINE;
 }
 
 void CommandBuffer::BeginRendering(const grfx::RenderingInfo* pRenderingInfo)
@@ -82,13 +84,50 @@ void CommandBuffer::EndRendering()
     mDynamicRenderPassActive = false;
 }
 
-void CommandBuffer::BeginRenderPass(const grfx::RenderPass* pRenderPass)
+Result CommandBuffer::BeginSecondary(const grfx::RenderPass* pRenderPass)
+{
+    PPX_ASSERT_MSG(IsSecondary(), "BeginSecondary requires a secondary command buffer");
+
+    Result ppxres = BeginSecondaryImpl(pRenderPass);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Commands are recorded inside pRenderPass, but the render pass is
+    // begun and ended by the primary.
+    mCurrentRenderPass         = pRenderPass;
+    mCurrentRenderPassContents = grfx::RENDER_PASS_CONTENTS_INLINE;
+    mDynamicRenderPassActive   = false;
+
+    return ppx::SUCCESS;
+}
+
+void CommandBuffer::ExecuteCommands(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers)
+{
+    PPX_ASSERT_MSG(!IsSecondary(), "secondary command buffers cannot execute other command buffers");
+    PPX_ASSERT_MSG(IsNull(mCurrentRenderPass) || (mCurrentRenderPassContents == grfx::RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS), "render pass was not begun with RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS");
+
+    if (commandBufferCount == 0) {
+        return;
+    }
+    PPX_ASSERT_NULL_ARG(ppCommandBuffers);
+    for (uint32_t i = 0; i < commandBufferCount; ++i) {
+        PPX_ASSERT_MSG(ppCommandBuffers[i]->IsSecondary(), "only secondary command buffers can be executed");
+    }
+
+    ExecuteCommandsImpl(commandBufferCount, ppCommandBuffers);
+}
+
+void CommandBuffer::BeginRenderPass(
+    const grfx::RenderPass*  pRenderPass,
+    grfx::RenderPassContents contents)
 {
     PPX_ASSERT_NULL_ARG(pRenderPass);
 
     grfx::RenderPassBeginInfo beginInfo = {};
     beginInfo.pRenderPass               = pRenderPass;
     beginInfo.renderArea                = pRenderPass->GetRenderArea();
+    beginInfo.contents                  = contents;
 
     beginInfo.RTVClearCount = pRenderPass->GetRenderTargetCount();
     for (uint32_t i = 0; i < beginInfo.RTVClearCount; ++i) {
@@ -106,12 +145,14 @@ void CommandBuffer::BeginRenderPass(const grfx::RenderPass* pRenderPass)
 
 void CommandBuffer::BeginRenderPass(
     const grfx::DrawPass*           pDrawPass,
-    const grfx::DrawPassClearFlags& clearFlags)
+    const grfx::DrawPassClearFlags& clearFlags,
+    grfx::RenderPassContents        contents)
 {
     PPX_ASSERT_NULL_ARG(pDrawPass);
 
     grfx::RenderPassBeginInfo beginInfo = {};
     pDrawPass->PrepareRenderPassBeginInfo(clearFlags, &beginInfo);
+    beginInfo.contents = contents;
 
     BeginRenderPass(&beginInfo);
 }
@@ -0,0 +1,285 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_descriptor_allocator.h"
+#include "ppx/grfx/grfx_device.h"
+
+#include "xxhash.h"
+
+#include <algorithm>
+
+namespace ppx {
+namespace grfx {
+
+namespace {
+
+uint32_t* GetPoolCount(grfx::DescriptorPoolCreateInfo& createInfo, grfx::DescriptorType type)
+{
+    switch (type) {
+        default: break;
+        case grfx::DESCRIPTOR_TYPE_SAMPLER: return &createInfo.sampler;
+        case grfx::DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: return &createInfo.combinedImageSampler;
+        case grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE: return &createInfo.sampledImage;
+        case grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE: return &createInfo.storageImage;
+        case grfx::DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER: return &createInfo.uniformTexelBuffer;
+        case grfx::DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: return &createInfo.storageTexelBuffer;
+        case grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER: return &createInfo.uniformBuffer;
+        case grfx::DESCRIPTOR_TYPE_RAW_STORAGE_BUFFER: return &createInfo.rawStorageBuffer;
+        case grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER: return &createInfo.structuredBuffer;
+        case grfx::DESCRIPTOR_TYPE_RW_STRUCTURED_BUFFER: return &createInfo.structuredBuffer;
+        case grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC: return &createInfo.uniformBufferDynamic;
+        case grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: return &createInfo.storageBufferDynamic;
+        case grfx::DESCRIPTOR_TYPE_INPUT_ATTACHMENT: return &createInfo.inputAttachment;
+    }
+    return nullptr;
+}
+
+// Every field of the writes, in order, so two keys are equal exactly when
+// writing them produces the same set. Resources are identified by their
+// registry handle rather than their address since a destroyed resource's
+// address can be reused.
+void BuildWriteKey(uint32_t writeCount, const grfx::WriteDescriptor* pWrites, std::vector<uint64_t>& key)
+{
+    key.clear();
+    key.reserve(7 * writeCount);
+    for (uint32_t i = 0; i < writeCount; ++i) {
+        const grfx::WriteDescriptor& write = pWrites[i];
+        key.push_back((static_cast<uint64_t>(write.binding) << 32) | write.arrayIndex);
+        key.push_back((static_cast<uint64_t>(write.type) << 32) | write.structuredElementCount);
+        key.push_back(write.bufferOffset);
+        key.push_back(write.bufferRange);
+        key.push_back(IsNull(write.pBuffer) ? 0 : write.pBuffer->GetRegistryHandle());
+        key.push_back(IsNull(write.pImageView) ? 0 : write.pImageView->GetViewRegistryHandle());
+        key.push_back(IsNull(write.pSampler) ? 0 : write.pSampler->GetRegistryHandle());
+    }
+}
+
+} // namespace
+
+Result DescriptorSetAllocator::CreateApiObjects(const grfx::DescriptorSetAllocatorCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    if ((pCreateInfo->frameCount == 0) || (pCreateInfo->setsPerPool == 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    mSetsPerPool = std::min<uint32_t>(pCreateInfo->setsPerPool, PPX_MAX_SETS_PER_POOL);
+    mFrames.resize(pCreateInfo->frameCount);
+
+    return ppx::SUCCESS;
+}
+
+void DescriptorSetAllocator::DestroyApiObjects()
+{
+    for (auto& frame : mFrames) {
+        for (auto& it : frame.layouts) {
+            LayoutPools& layoutPools = it.second;
+            for (auto& entry : layoutPools.entries) {
+                FreeSet(entry.set);
+            }
+            for (auto& pool : layoutPools.pools) {
+                DestroyPool(pool);
+            }
+        }
+    }
+    mFrames.clear();
+}
+
+Result DescriptorSetAllocator::CreatePool(const grfx::DescriptorPoolCreateInfo* pCreateInfo, grfx::DescriptorPool** ppPool)
+{
+    return GetDevice()->CreateDescriptorPool(pCreateInfo, ppPool);
+}
+
+void DescriptorSetAllocator::DestroyPool(grfx::DescriptorPool* pPool)
+{
+    GetDevice()->DestroyDescriptorPool(pPool);
+}
+
+Result DescriptorSetAllocator::AllocateSet(grfx::DescriptorPool* pPool, const grfx::DescriptorSetLayout* pLayout, grfx::DescriptorSet** ppSet)
+{
+    return GetDevice()->AllocateDescriptorSet(pPool, pLayout, ppSet);
+}
+
+void DescriptorSetAllocator::FreeSet(grfx::DescriptorSet* pSet)
+{
+    GetDevice()->FreeDescriptorSet(pSet);
+}
+
+void DescriptorSetAllocator::BeginFrame(uint32_t frameIndex)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mFrameIndex  = frameIndex % CountU32(mFrames);
+    Frame& frame = mFrames[mFrameIndex];
+
+    // Sets handed out in an earlier epoch are released, so bumping the
+    // epoch releases all of them at once without touching the pools
+    frame.epoch += 1;
+    for (auto& it : frame.layouts) {
+        it.second.cursor = 0;
+    }
+
+    mStats.poolResetCount += 1;
+}
+
+Result DescriptorSetAllocator::AllocateEntry(const grfx::DescriptorSetLayout* pLayout, LayoutPools& layoutPools, uint32_t* pIndex)
+{
+    if (layoutPools.pools.empty() || (layoutPools.lastPoolSetCount == mSetsPerPool)) {
+        grfx::DescriptorPoolPtr pool;
+        Result                  ppxres = CreatePool(&layoutPools.poolCreateInfo, &pool);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        layoutPools.pools.push_back(pool);
+        layoutPools.lastPoolSetCount = 0;
+        mStats.poolCount += 1;
+    }
+
+    Entry  entry  = {};
+    Result ppxres = AllocateSet(layoutPools.pools.back(), pLayout, &entry.set);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    layoutPools.lastPoolSetCount += 1;
+    mStats.allocationCount += 1;
+
+    *pIndex = CountU32(layoutPools.entries);
+    layoutPools.entries.push_back(std::move(entry));
+
+    return ppx::SUCCESS;
+}
+
+Result DescriptorSetAllocator::Allocate(
+    const grfx::DescriptorSetLayout* pLayout,
+    uint32_t                         writeCount,
+    const grfx::WriteDescriptor*     pWrites,
+    grfx::DescriptorSet**            ppSet)
+{
+    PPX_ASSERT_NULL_ARG(pLayout);
+    PPX_ASSERT_NULL_ARG(ppSet);
+
+    if ((writeCount > 0) && IsNull(pWrites)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (pLayout->IsPushable()) {
+        return ppx::ERROR_GRFX_OPERATION_NOT_PERMITTED;
+    }
+
+    std::vector<uint64_t> key;
+    BuildWriteKey(writeCount, pWrites, key);
+    const uint64_t hash = XXH64(key.data(), key.size() * sizeof(uint64_t), 0);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mStats.requestCount += 1;
+
+    Frame& frame = mFrames[mFrameIndex];
+
+    auto layoutIt = frame.layouts.find(pLayout);
+    if (layoutIt == frame.layouts.end()) {
+        LayoutPools layoutPools = {};
+        for (const grfx::DescriptorBinding& binding : pLayout->GetBindings()) {
+            uint32_t* pCount = GetPoolCount(layoutPools.poolCreateInfo, binding.type);
+            if (IsNull(pCount)) {
+                return ppx::ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE;
+            }
+            *pCount += binding.arrayCount * mSetsPerPool;
+        }
+        layoutIt = frame.layouts.emplace(pLayout, std::move(layoutPools)).first;
+    }
+    LayoutPools& layoutPools = layoutIt->second;
+
+    // Sets still hold the writes they were last updated with, whether or
+    // not they've been handed out this epoch
+    auto cacheIt = layoutPools.cache.find(hash);
+    if (cacheIt != layoutPools.cache.end()) {
+        Entry& entry = layoutPools.entries[cacheIt->second];
+        if (entry.key == key) {
+            entry.epoch = frame.epoch;
+            *ppSet      = entry.set;
+            mStats.cacheHitCount += 1;
+            return ppx::SUCCESS;
+        }
+    }
+
+    // Rewrite the first stale set. Sets handed out in the previous epoch
+    // are likely to be requested again later in this one, rewriting them
+    // would evict descriptors that are about to be hits.
+    uint32_t index = CountU32(layoutPools.entries);
+    while (layoutPools.cursor < CountU32(layoutPools.entries)) {
+        uint32_t i = layoutPools.cursor++;
+        if (layoutPools.entries[i].epoch + 1 < frame.epoch) {
+            index = i;
+            break;
+        }
+    }
+    if (index == CountU32(layoutPools.entries)) {
+        Result ppxres = AllocateEntry(pLayout, layoutPools, &index);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        layoutPools.cursor = index + 1;
+    }
+
+    Entry& entry = layoutPools.entries[index];
+
+    // The set's previous writes are about to be overwritten
+    auto staleIt = layoutPools.cache.find(entry.hash);
+    if ((staleIt != layoutPools.cache.end()) && (staleIt->second == index)) {
+        layoutPools.cache.erase(staleIt);
+    }
+    entry.key.clear();
+
+    // All writes go to the driver in one call
+    if (writeCount > 0) {
+        Result ppxres = entry.set->UpdateDescriptors(writeCount, pWrites);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    mStats.updateCount += 1;
+
+    entry.hash              = hash;
+    entry.epoch             = frame.epoch;
+    entry.key               = std::move(key);
+    layoutPools.cache[hash] = index;
+
+    *ppSet = entry.set;
+
+    return ppx::SUCCESS;
+}
+
+void DescriptorSetAllocator::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto& frame : mFrames) {
+        for (auto& it : frame.layouts) {
+            it.second.cache.clear();
+            for (auto& entry : it.second.entries) {
+                entry.key.clear();
+            }
+        }
+    }
+}
+
+DescriptorSetAllocatorStats DescriptorSetAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+} // namespace grfx
+} // namespace ppx
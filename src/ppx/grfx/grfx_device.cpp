@@ -16,9 +16,41 @@
 #include "ppx/grfx/grfx_gpu.h"
 #include "ppx/grfx/grfx_instance.h"
 
+#include <type_traits>
+
 namespace ppx {
 namespace grfx {
 
+namespace {
+
+// Serializes create infos field by field, they have padding and strings
+// so their bytes can't be compared directly.
+class PipelineKeyWriter
+{
+public:
+    PipelineKeyWriter(uint64_t tag) { Add(tag); }
+
+    template <typename T>
+    void Add(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "only scalars can be written directly");
+        mKey.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void Add(const std::string& value)
+    {
+        Add(value.size());
+        mKey.append(value);
+    }
+
+    const std::string& GetKey() const { return mKey; }
+
+private:
+    std::string mKey;
+};
+
+} // namespace
+
 Result Device::Create(const grfx::DeviceCreateInfo* pCreateInfo)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo->pGpu);
@@ -32,6 +64,23 @@ Result Device::Create(const grfx::DeviceCreateInfo* pCreateInfo)
 
 void Device::Destroy()
 {
+    // Image streamers wait on their upload queues, upload queues flush
+    // and wait on their batches and frame captures wait on their writes,
+    // so they need the queues
+    DestroyAllObjects(mImageStreamers);
+    DestroyAllObjects(mUploadQueues);
+    DestroyAllObjects(mFrameCaptures);
+
+    // Staging rings unmap and destroy their buffers
+    mStagingRing.Reset();
+    DestroyAllObjects(mStagingRings);
+
+    // Parallel command recorders free their command buffers and pools
+    DestroyAllObjects(mParallelCommandRecorders);
+
+    // Descriptor set allocators free their sets and pools
+    DestroyAllObjects(mDescriptorSetAllocators);
+
     // Destroy queues first to clear any pending work
     DestroyAllObjects(mGraphicsQueues);
     DestroyAllObjects(mComputeQueues);
@@ -68,6 +117,9 @@ void Device::Destroy()
     DestroyAllObjects(mShaderModules);
     DestroyAllObjects(mSwapchains);
 
+    mSharedPipelines.clear();
+    mSharedPipelineKeys.clear();
+
     grfx::InstanceObject<grfx::DeviceCreateInfo>::Destroy();
     PPX_LOG_INFO("Destroyed device: " << mCreateInfo.pGpu->GetDeviceName());
 }
@@ -115,32 +167,27 @@ Result Device::CreateObject(const CreateInfoT* pCreateInfo, ContainerT& containe
         return ppxres;
     }
     // Store
-    container.push_back(ObjPtr<ObjectT>(pObject));
+    StoreObject(container, pObject);
     // Assign
     *ppObject = pObject;
     // Success
     return ppx::SUCCESS;
 }
 
-template <
-    typename ObjectT,
-    typename ContainerT>
-void Device::DestroyObject(ContainerT& container, const ObjectT* pObject)
-{
-    // Make sure object is in container
-    auto it = std::find_if(
-        std::begin(container),
-        std::end(container),
-        [pObject](const ObjPtr<ObjectT>& elem) -> bool {
-            bool res = (elem == pObject);
-            return res; });
-    if (it == std::end(container)) {
+template <typename ObjectT>
+void Device::DestroyObject(ppx::SlotMap<ObjPtr<ObjectT>>& container, const ObjectT* pObject)
+{
+    // Make sure object is in container, the handle can be stale or belong
+    // to another device's container.
+    ObjPtr<ObjectT>* pElem = container.Get(pObject->mRegistryHandle);
+    if (IsNull(pElem) || (pElem->Get() != pObject)) {
         return;
     }
     // Copy pointer
-    ObjPtr<ObjectT> object = *it;
+    ObjPtr<ObjectT> object = *pElem;
     // Remove object pointer from container
-    RemoveElement(object, container);
+    container.Erase(object->mRegistryHandle);
+    object->mRegistryHandle = 0;
     // Destroy internal objects
     object->Destroy();
     // Delete allocation
@@ -165,6 +212,213 @@ void Device::DestroyAllObjects(std::vector<ObjPtr<ObjectT>>& container)
     container.clear();
 }
 
+template <typename ObjectT>
+void Device::DestroyAllObjects(ppx::SlotMap<ObjPtr<ObjectT>>& container)
+{
+    // Objects are removed before they're destroyed, so it's safe for an
+    // object to destroy other objects in the same container.
+    while (!container.empty()) {
+        // Get object pointer
+        ObjPtr<ObjectT> object = container.back();
+        // Remove object pointer from container
+        container.Erase(object->mRegistryHandle);
+        object->mRegistryHandle = 0;
+        // Destroy internal objects
+        object->Destroy();
+        // Delete allocation
+        ObjectT* ptr = object.Get();
+        delete ptr;
+    }
+}
+
+template <typename ObjectT>
+void Device::StoreObject(std::vector<ObjPtr<ObjectT>>& container, ObjectT* pObject)
+{
+    container.push_back(ObjPtr<ObjectT>(pObject));
+}
+
+template <typename ObjectT>
+void Device::StoreObject(ppx::SlotMap<ObjPtr<ObjectT>>& container, ObjectT* pObject)
+{
+    pObject->mRegistryHandle = container.Insert(ObjPtr<ObjectT>(pObject));
+}
+
+std::string Device::GetPipelineKey(const grfx::ComputePipelineCreateInfo* pCreateInfo) const
+{
+    // Objects are identified by their registry handle rather than their
+    // address since a destroyed object's address can be reused.
+    PipelineKeyWriter writer(0x436F6D7075746550ULL);
+    writer.Add(IsNull(pCreateInfo->CS.pModule) ? 0 : pCreateInfo->CS.pModule->mRegistryHandle);
+    writer.Add(pCreateInfo->CS.entryPoint);
+    writer.Add(IsNull(pCreateInfo->pPipelineInterface) ? 0 : pCreateInfo->pPipelineInterface->mRegistryHandle);
+    return writer.GetKey();
+}
+
+std::string Device::GetPipelineKey(const grfx::GraphicsPipelineCreateInfo* pCreateInfo) const
+{
+    PipelineKeyWriter writer(0x4772617068696350ULL);
+
+    const grfx::ShaderStageInfo* stages[] = {&pCreateInfo->VS, &pCreateInfo->HS, &pCreateInfo->DS, &pCreateInfo->GS, &pCreateInfo->PS};
+    for (const grfx::ShaderStageInfo* pStage : stages) {
+        writer.Add(IsNull(pStage->pModule) ? 0 : pStage->pModule->mRegistryHandle);
+        writer.Add(pStage->entryPoint);
+    }
+
+    const grfx::VertexInputState& vertexInput = pCreateInfo->vertexInputState;
+    writer.Add(vertexInput.bindingCount);
+    for (uint32_t i = 0; i < vertexInput.bindingCount; ++i) {
+        const grfx::VertexBinding& binding = vertexInput.bindings[i];
+        writer.Add(binding.GetBinding());
+        writer.Add(binding.GetStride());
+        writer.Add(binding.GetInputRate());
+        writer.Add(binding.GetAttributeCount());
+        for (uint32_t j = 0; j < binding.GetAttributeCount(); ++j) {
+            const grfx::VertexAttribute* pAttribute = nullptr;
+            binding.GetAttribute(j, &pAttribute);
+            writer.Add(pAttribute->semanticName);
+            writer.Add(pAttribute->location);
+            writer.Add(pAttribute->format);
+            writer.Add(pAttribute->binding);
+            writer.Add(pAttribute->offset);
+            writer.Add(pAttribute->inputRate);
+            writer.Add(pAttribute->semantic);
+        }
+    }
+
+    writer.Add(pCreateInfo->inputAssemblyState.topology);
+    writer.Add(pCreateInfo->inputAssemblyState.primitiveRestartEnable);
+
+    writer.Add(pCreateInfo->tessellationState.patchControlPoints);
+    writer.Add(pCreateInfo->tessellationState.domainOrigin);
+
+    const grfx::RasterState& raster = pCreateInfo->rasterState;
+    writer.Add(raster.depthClampEnable);
+    writer.Add(raster.rasterizeDiscardEnable);
+    writer.Add(raster.polygonMode);
+    writer.Add(raster.cullMode);
+    writer.Add(raster.frontFace);
+    writer.Add(raster.depthBiasEnable);
+    writer.Add(raster.depthBiasConstantFactor);
+    writer.Add(raster.depthBiasClamp);
+    writer.Add(raster.depthBiasSlopeFactor);
+    writer.Add(raster.depthClipEnable);
+    writer.Add(raster.rasterizationSamples);
+
+    writer.Add(pCreateInfo->multisampleState.alphaToCoverageEnable);
+
+    const grfx::DepthStencilState& depthStencil = pCreateInfo->depthStencilState;
+    writer.Add(depthStencil.depthTestEnable);
+    writer.Add(depthStencil.depthWriteEnable);
+    writer.Add(depthStencil.depthCompareOp);
+    writer.Add(depthStencil.depthBoundsTestEnable);
+    writer.Add(depthStencil.minDepthBounds);
+    writer.Add(depthStencil.maxDepthBounds);
+    writer.Add(depthStencil.stencilTestEnable);
+    for (const grfx::StencilOpState* pOp : {&depthStencil.front, &depthStencil.back}) {
+        writer.Add(pOp->failOp);
+        writer.Add(pOp->passOp);
+        writer.Add(pOp->depthFailOp);
+        writer.Add(pOp->compareOp);
+        writer.Add(pOp->compareMask);
+        writer.Add(pOp->writeMask);
+        writer.Add(pOp->reference);
+    }
+
+    const grfx::ColorBlendState& colorBlend = pCreateInfo->colorBlendState;
+    writer.Add(colorBlend.logicOpEnable);
+    writer.Add(colorBlend.logicOp);
+    writer.Add(colorBlend.blendAttachmentCount);
+    for (uint32_t i = 0; i < colorBlend.blendAttachmentCount; ++i) {
+        const grfx::BlendAttachmentState& attachment = colorBlend.blendAttachments[i];
+        writer.Add(attachment.blendEnable);
+        writer.Add(attachment.srcColorBlendFactor);
+        writer.Add(attachment.dstColorBlendFactor);
+        writer.Add(attachment.colorBlendOp);
+        writer.Add(attachment.srcAlphaBlendFactor);
+        writer.Add(attachment.dstAlphaBlendFactor);
+        writer.Add(attachment.alphaBlendOp);
+        writer.Add(attachment.colorWriteMask.flags);
+    }
+    for (uint32_t i = 0; i < 4; ++i) {
+        writer.Add(colorBlend.blendConstants[i]);
+    }
+
+    const grfx::OutputState& output = pCreateInfo->outputState;
+    writer.Add(output.renderTargetCount);
+    for (uint32_t i = 0; i < output.renderTargetCount; ++i) {
+        writer.Add(output.renderTargetFormats[i]);
+    }
+    writer.Add(output.depthStencilFormat);
+
+    writer.Add(pCreateInfo->shadingRateMode);
+    writer.Add(IsNull(pCreateInfo->pPipelineInterface) ? 0 : pCreateInfo->pPipelineInterface->mRegistryHandle);
+    writer.Add(pCreateInfo->dynamicRenderPass);
+
+    return writer.GetKey();
+}
+
+template <typename ObjectT, typename CreateInfoT>
+Result Device::CreateSharedPipeline(const CreateInfoT* pCreateInfo, ppx::SlotMap<ObjPtr<ObjectT>>& container, ObjectT** ppObject)
+{
+    if (!mCreateInfo.sharePipelines) {
+        return CreateObject(pCreateInfo, container, ppObject);
+    }
+
+    // The whole key is compared, a hash collision must not hand out
+    // another pipeline
+    const std::string key = GetPipelineKey(pCreateInfo);
+
+    auto it = mSharedPipelines.find(key);
+    if (it != mSharedPipelines.end()) {
+        it->second.refCount += 1;
+        mPipelineCacheStats.hitCount += 1;
+        *ppObject = static_cast<ObjectT*>(const_cast<void*>(it->second.pPipeline));
+        return ppx::SUCCESS;
+    }
+
+    Result ppxres = CreateObject(pCreateInfo, container, ppObject);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    mPipelineCacheStats.missCount += 1;
+
+    SharedPipeline shared = {};
+    shared.pPipeline      = *ppObject;
+    shared.refCount       = 1;
+
+    mSharedPipelines[key]          = shared;
+    mSharedPipelineKeys[*ppObject] = key;
+
+    return ppx::SUCCESS;
+}
+
+template <typename ObjectT>
+void Device::DestroySharedPipeline(ppx::SlotMap<ObjPtr<ObjectT>>& container, const ObjectT* pObject)
+{
+    auto keyIt = mSharedPipelineKeys.find(pObject);
+    if (keyIt != mSharedPipelineKeys.end()) {
+        auto it = mSharedPipelines.find(keyIt->second);
+        PPX_ASSERT_MSG(it != mSharedPipelines.end(), "shared pipeline missing from cache");
+        it->second.refCount -= 1;
+        if (it->second.refCount > 0) {
+            return;
+        }
+        mSharedPipelines.erase(it);
+        mSharedPipelineKeys.erase(keyIt);
+    }
+    DestroyObject(container, pObject);
+}
+
+Result Device::AllocateObject(grfx::DescriptorSetAllocator** ppObject)
+{
+    grfx::DescriptorSetAllocator* pObject = new grfx::DescriptorSetAllocator();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::DrawPass** ppObject)
 {
     grfx::DrawPass* pObject = new grfx::DrawPass();
@@ -175,6 +429,16 @@ Result Device::AllocateObject(grfx::DrawPass** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::FrameCapture** ppObject)
+{
+    grfx::FrameCapture* pObject = new grfx::FrameCapture();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::FullscreenQuad** ppObject)
 {
     grfx::FullscreenQuad* pObject = new grfx::FullscreenQuad();
@@ -185,6 +449,16 @@ Result Device::AllocateObject(grfx::FullscreenQuad** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::ImageStreamer** ppObject)
+{
+    grfx::ImageStreamer* pObject = new grfx::ImageStreamer();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::Mesh** ppObject)
 {
     grfx::Mesh* pObject = new grfx::Mesh();
@@ -195,6 +469,26 @@ Result Device::AllocateObject(grfx::Mesh** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::ParallelCommandRecorder** ppObject)
+{
+    grfx::ParallelCommandRecorder* pObject = new grfx::ParallelCommandRecorder();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
+Result Device::AllocateObject(grfx::StagingRing** ppObject)
+{
+    grfx::StagingRing* pObject = new grfx::StagingRing();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::TextDraw** ppObject)
 {
     grfx::TextDraw* pObject = new grfx::TextDraw();
@@ -225,6 +519,16 @@ Result Device::AllocateObject(grfx::TextureFont** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::UploadQueue** ppObject)
+{
+    grfx::UploadQueue* pObject = new grfx::UploadQueue();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::CreateBuffer(const grfx::BufferCreateInfo* pCreateInfo, grfx::Buffer** ppBuffer)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -255,13 +559,13 @@ Result Device::CreateComputePipeline(const grfx::ComputePipelineCreateInfo* pCre
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppComputePipeline);
-    return CreateObject(pCreateInfo, mComputePipelines, ppComputePipeline);
+    return CreateSharedPipeline(pCreateInfo, mComputePipelines, ppComputePipeline);
 }
 
 void Device::DestroyComputePipeline(const grfx::ComputePipeline* pComputePipeline)
 {
     PPX_ASSERT_NULL_ARG(pComputePipeline);
-    DestroyObject(mComputePipelines, pComputePipeline);
+    DestroySharedPipeline(mComputePipelines, pComputePipeline);
 }
 
 Result Device::CreateDepthStencilView(const grfx::DepthStencilViewCreateInfo* pCreateInfo, grfx::DepthStencilView** ppDepthStencilView)
@@ -290,6 +594,19 @@ void Device::DestroyDescriptorPool(const grfx::DescriptorPool* pDescriptorPool)
     DestroyObject(mDescriptorPools, pDescriptorPool);
 }
 
+Result Device::CreateDescriptorSetAllocator(const grfx::DescriptorSetAllocatorCreateInfo* pCreateInfo, grfx::DescriptorSetAllocator** ppDescriptorSetAllocator)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppDescriptorSetAllocator);
+    return CreateObject(pCreateInfo, mDescriptorSetAllocators, ppDescriptorSetAllocator);
+}
+
+void Device::DestroyDescriptorSetAllocator(const grfx::DescriptorSetAllocator* pDescriptorSetAllocator)
+{
+    PPX_ASSERT_NULL_ARG(pDescriptorSetAllocator);
+    DestroyObject(mDescriptorSetAllocators, pDescriptorSetAllocator);
+}
+
 Result Device::CreateDescriptorSetLayout(const grfx::DescriptorSetLayoutCreateInfo* pCreateInfo, grfx::DescriptorSetLayout** ppDescriptorSetLayout)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -365,6 +682,19 @@ void Device::DestroyShadingRatePattern(const grfx::ShadingRatePattern* pShadingR
     DestroyObject(mShadingRatePatterns, pShadingRatePattern);
 }
 
+Result Device::CreateFrameCapture(const grfx::FrameCaptureCreateInfo* pCreateInfo, grfx::FrameCapture** ppFrameCapture)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppFrameCapture);
+    return CreateObject(pCreateInfo, mFrameCaptures, ppFrameCapture);
+}
+
+void Device::DestroyFrameCapture(const grfx::FrameCapture* pFrameCapture)
+{
+    PPX_ASSERT_NULL_ARG(pFrameCapture);
+    DestroyObject(mFrameCaptures, pFrameCapture);
+}
+
 Result Device::CreateFullscreenQuad(const grfx::FullscreenQuadCreateInfo* pCreateInfo, grfx::FullscreenQuad** ppFullscreenQuad)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -382,7 +712,7 @@ Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo* pC
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppGraphicsPipeline);
-    return CreateObject(pCreateInfo, mGraphicsPipelines, ppGraphicsPipeline);
+    return CreateSharedPipeline(pCreateInfo, mGraphicsPipelines, ppGraphicsPipeline);
 }
 
 Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline)
@@ -393,13 +723,13 @@ Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* p
     grfx::GraphicsPipelineCreateInfo createInfo = {};
     grfx::internal::FillOutGraphicsPipelineCreateInfo(pCreateInfo, &createInfo);
 
-    return CreateObject(&createInfo, mGraphicsPipelines, ppGraphicsPipeline);
+    return CreateSharedPipeline(&createInfo, mGraphicsPipelines, ppGraphicsPipeline);
 }
 
 void Device::DestroyGraphicsPipeline(const grfx::GraphicsPipeline* pGraphicsPipeline)
 {
     PPX_ASSERT_NULL_ARG(pGraphicsPipeline);
-    DestroyObject(mGraphicsPipelines, pGraphicsPipeline);
+    DestroySharedPipeline(mGraphicsPipelines, pGraphicsPipeline);
 }
 
 Result Device::CreateImage(const grfx::ImageCreateInfo* pCreateInfo, grfx::Image** ppImage)
@@ -415,6 +745,24 @@ void Device::DestroyImage(const grfx::Image* pImage)
     DestroyObject(mImages, pImage);
 }
 
+bool Device::HasImage(ppx::SlotHandle handle) const
+{
+    return mImages.Contains(handle);
+}
+
+Result Device::CreateImageStreamer(const grfx::ImageStreamerCreateInfo* pCreateInfo, grfx::ImageStreamer** ppImageStreamer)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppImageStreamer);
+    return CreateObject(pCreateInfo, mImageStreamers, ppImageStreamer);
+}
+
+void Device::DestroyImageStreamer(const grfx::ImageStreamer* pImageStreamer)
+{
+    PPX_ASSERT_NULL_ARG(pImageStreamer);
+    DestroyObject(mImageStreamers, pImageStreamer);
+}
+
 Result Device::CreateMesh(const grfx::MeshCreateInfo* pCreateInfo, grfx::Mesh** ppMesh)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -428,6 +776,19 @@ void Device::DestroyMesh(const grfx::Mesh* pMesh)
     DestroyObject(mMeshes, pMesh);
 }
 
+Result Device::CreateParallelCommandRecorder(const grfx::ParallelCommandRecorderCreateInfo* pCreateInfo, grfx::ParallelCommandRecorder** ppParallelCommandRecorder)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppParallelCommandRecorder);
+    return CreateObject(pCreateInfo, mParallelCommandRecorders, ppParallelCommandRecorder);
+}
+
+void Device::DestroyParallelCommandRecorder(const grfx::ParallelCommandRecorder* pParallelCommandRecorder)
+{
+    PPX_ASSERT_NULL_ARG(pParallelCommandRecorder);
+    DestroyObject(mParallelCommandRecorders, pParallelCommandRecorder);
+}
+
 Result Device::CreatePipelineInterface(const grfx::PipelineInterfaceCreateInfo* pCreateInfo, grfx::PipelineInterface** ppPipelineInterface)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -555,6 +916,22 @@ void Device::DestroyShaderModule(const grfx::ShaderModule* pShaderModule)
     DestroyObject(mShaderModules, pShaderModule);
 }
 
+Result Device::CreateStagingRing(const grfx::StagingRingCreateInfo* pCreateInfo, grfx::StagingRing** ppStagingRing)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppStagingRing);
+    return CreateObject(pCreateInfo, mStagingRings, ppStagingRing);
+}
+
+void Device::DestroyStagingRing(const grfx::StagingRing* pStagingRing)
+{
+    PPX_ASSERT_NULL_ARG(pStagingRing);
+    if (pStagingRing == mStagingRing.Get()) {
+        mStagingRing.Reset();
+    }
+    DestroyObject(mStagingRings, pStagingRing);
+}
+
 Result Device::CreateStorageImageView(const grfx::StorageImageViewCreateInfo* pCreateInfo, grfx::StorageImageView** ppStorageImageView)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -620,11 +997,25 @@ void Device::DestroyTextureFont(const grfx::TextureFont* pTextureFont)
     DestroyObject(mTextureFonts, pTextureFont);
 }
 
+Result Device::CreateUploadQueue(const grfx::UploadQueueCreateInfo* pCreateInfo, grfx::UploadQueue** ppUploadQueue)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppUploadQueue);
+    return CreateObject(pCreateInfo, mUploadQueues, ppUploadQueue);
+}
+
+void Device::DestroyUploadQueue(const grfx::UploadQueue* pUploadQueue)
+{
+    PPX_ASSERT_NULL_ARG(pUploadQueue);
+    DestroyObject(mUploadQueues, pUploadQueue);
+}
+
 Result Device::AllocateCommandBuffer(
     const grfx::CommandPool* pPool,
     grfx::CommandBuffer**    ppCommandBuffer,
     uint32_t                 resourceDescriptorCount,
-    uint32_t                 samplerDescriptorCount)
+    uint32_t                 samplerDescriptorCount,
+    grfx::CommandBufferLevel level)
 {
     PPX_ASSERT_NULL_ARG(ppCommandBuffer);
 
@@ -632,6 +1023,7 @@ Result Device::AllocateCommandBuffer(
     createInfo.pPool                                   = pPool;
     createInfo.resourceDescriptorCount                 = resourceDescriptorCount;
     createInfo.samplerDescriptorCount                  = samplerDescriptorCount;
+    createInfo.level                                   = level;
 
     return CreateObject(&createInfo, mCommandBuffers, ppCommandBuffer);
 }
@@ -762,6 +1154,30 @@ grfx::QueuePtr Device::GetTransferQueue(uint32_t index) const
     return queue;
 }
 
+Result Device::GetStagingRing(grfx::StagingRing** ppStagingRing)
+{
+    PPX_ASSERT_NULL_ARG(ppStagingRing);
+
+    std::lock_guard<std::mutex> lock(mStagingRingMutex);
+
+    if (!mStagingRing) {
+        grfx::StagingRingCreateInfo createInfo = {};
+        Result                      ppxres     = CreateStagingRing(&createInfo, &mStagingRing);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    *ppStagingRing = mStagingRing;
+    return ppx::SUCCESS;
+}
+
+grfx::StagingRingStats Device::GetStagingRingStats()
+{
+    std::lock_guard<std::mutex> lock(mStagingRingMutex);
+    return mStagingRing ? mStagingRing->GetStats() : grfx::StagingRingStats{};
+}
+
 grfx::QueuePtr Device::GetAnyAvailableQueue() const
 {
     grfx::QueuePtr queue;
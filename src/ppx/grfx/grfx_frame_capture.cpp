@@ -0,0 +1,290 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_frame_capture.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_image.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_sync.h"
+#include "ppx/ppm_export.h"
+#include "ppx/profiler.h"
+#include "ppx/thread_pool.h"
+
+namespace ppx {
+namespace grfx {
+
+static ProfilerEventToken sCaptureEventToken = 0;
+static ProfilerEventToken sWriteEventToken   = 0;
+
+namespace internal {
+
+void RegisterFrameCaptureProfilerEvents()
+{
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("FrameCapture::Capture", &sCaptureEventToken));
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("FrameCapture::Write", &sWriteEventToken));
+}
+
+} // namespace internal
+
+Result FrameCapture::CreateApiObjects(const grfx::FrameCaptureCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(pCreateInfo->pQueue);
+
+    if (pCreateInfo->slotCount == 0) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    // Readback buffers are created on first use since their size depends
+    // on the captured image.
+    mSlots.resize(pCreateInfo->slotCount);
+    for (auto& slot : mSlots) {
+        Result ppxres = pCreateInfo->pQueue->CreateCommandBuffer(&slot.commandBuffer, 0, 0);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating frame capture command buffer");
+            return ppxres;
+        }
+
+        grfx::FenceCreateInfo fenceCreateInfo = {};
+        ppxres                                = GetDevice()->CreateFence(&fenceCreateInfo, &slot.fence);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating frame capture fence");
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void FrameCapture::DestroyApiObjects()
+{
+    // Don't drop captures that haven't been written yet
+    if (!mSlots.empty()) {
+        WaitIdle();
+    }
+
+    for (auto& slot : mSlots) {
+        if (slot.buffer) {
+            slot.buffer->UnmapMemory();
+            GetDevice()->DestroyBuffer(slot.buffer);
+            slot.buffer.Reset();
+        }
+        if (slot.fence) {
+            GetDevice()->DestroyFence(slot.fence);
+            slot.fence.Reset();
+        }
+        if (slot.commandBuffer) {
+            mCreateInfo.pQueue->DestroyCommandBuffer(slot.commandBuffer);
+            slot.commandBuffer.Reset();
+        }
+    }
+    mSlots.clear();
+}
+
+Result FrameCapture::PrepareBuffer(Slot& slot, uint64_t size)
+{
+    if (slot.bufferSize >= size) {
+        return ppx::SUCCESS;
+    }
+
+    if (slot.buffer) {
+        slot.buffer->UnmapMemory();
+        GetDevice()->DestroyBuffer(slot.buffer);
+        slot.buffer.Reset();
+        slot.pMappedAddress = nullptr;
+        slot.bufferSize     = 0;
+    }
+
+    grfx::BufferCreateInfo bufferCreateInfo      = {};
+    bufferCreateInfo.size                        = size;
+    bufferCreateInfo.initialState                = grfx::RESOURCE_STATE_COPY_DST;
+    bufferCreateInfo.usageFlags.bits.transferDst = 1;
+    bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_TO_CPU;
+
+    Result ppxres = GetDevice()->CreateBuffer(&bufferCreateInfo, &slot.buffer);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Readback buffers stay mapped for their whole lifetime
+    ppxres = slot.buffer->MapMemory(0, &slot.pMappedAddress);
+    if (Failed(ppxres)) {
+        GetDevice()->DestroyBuffer(slot.buffer);
+        slot.buffer.Reset();
+        return ppxres;
+    }
+    slot.bufferSize = size;
+
+    return ppx::SUCCESS;
+}
+
+Result FrameCapture::WaitSlot(Slot& slot)
+{
+    // Only this thread moves slots into and out of COPYING, but workers
+    // write state when they finish, so it's still read under the lock
+    bool copying = false;
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        copying = (slot.state == SLOT_STATE_COPYING);
+    }
+    if (copying) {
+        Result ppxres = slot.fence->Wait();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        StartWrite(slot);
+    }
+
+    std::unique_lock<std::mutex> lock(mWriteMutex);
+    mWriteDone.wait(lock, [&slot]() { return slot.state == SLOT_STATE_IDLE; });
+
+    return ppx::SUCCESS;
+}
+
+void FrameCapture::StartWrite(Slot& slot)
+{
+    slot.fence->Reset();
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        slot.state = SLOT_STATE_WRITING;
+    }
+
+    ThreadPool::GetDefault().Submit([this, &slot]() {
+        ProfilerScopedEventSample sample(sWriteEventToken);
+
+        Result ppxres = ExportToFile(slot.path, slot.format, slot.pMappedAddress, slot.width, slot.height, slot.rowPitch);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("Failed writing frame capture to " << slot.path << ": " << ToString(ppxres));
+            ++mFailedCount;
+        }
+        else {
+            PPX_LOG_INFO("Frame capture saved to: " << slot.path);
+            ++mWrittenCount;
+        }
+
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        slot.state = SLOT_STATE_IDLE;
+        mWriteDone.notify_all();
+    });
+}
+
+void FrameCapture::Poll()
+{
+    // Slots are used round robin and complete in submission order, so
+    // stop at the first copy that's still running.
+    for (uint32_t i = 0; i < CountU32(mSlots); ++i) {
+        Slot& slot = mSlots[(mNextSlot + i) % CountU32(mSlots)];
+        {
+            // Workers may be moving other slots from WRITING to IDLE
+            std::lock_guard<std::mutex> lock(mWriteMutex);
+            if (slot.state != SLOT_STATE_COPYING) {
+                continue;
+            }
+        }
+        if (slot.fence->Wait(0) != ppx::SUCCESS) {
+            break;
+        }
+        StartWrite(slot);
+    }
+}
+
+Result FrameCapture::Capture(grfx::Image* pImage, grfx::ResourceState imageState, const std::string& path)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    ProfilerScopedEventSample sample(sCaptureEventToken);
+
+    Poll();
+
+    // Slots are used round robin, so a busy slot holds the oldest capture
+    Slot&  slot   = mSlots[mNextSlot];
+    Result ppxres = WaitSlot(slot);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    const grfx::FormatDesc* formatDesc = grfx::GetFormatDescription(pImage->GetFormat());
+    const uint32_t          width      = pImage->GetWidth();
+    const uint32_t          height     = pImage->GetHeight();
+
+    // Same row pitch the backends write: D3D12 aligns rows to 256 bytes,
+    // Vulkan copies them tightly packed.
+    const uint32_t rowPitchAlignment = grfx::IsDx12(GetDevice()->GetApi()) ? PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT : 1;
+    const uint32_t rowPitch          = RoundUp<uint32_t>(formatDesc->bytesPerTexel * width, rowPitchAlignment);
+
+    ppxres = PrepareBuffer(slot, static_cast<uint64_t>(rowPitch) * height);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::CommandBuffer* pCmd = slot.commandBuffer;
+
+    ppxres = pCmd->Begin();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    pCmd->TransitionImageLayout(pImage, PPX_ALL_SUBRESOURCES, imageState, grfx::RESOURCE_STATE_COPY_SRC);
+
+    grfx::ImageToBufferCopyInfo copyInfo = {};
+    copyInfo.extent                      = {width, height, 0};
+    grfx::ImageToBufferOutputPitch pitch = pCmd->CopyImageToBuffer(&copyInfo, pImage, slot.buffer);
+
+    pCmd->TransitionImageLayout(pImage, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_COPY_SRC, imageState);
+
+    ppxres = pCmd->End();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::SubmitInfo submitInfo   = {};
+    submitInfo.commandBufferCount = 1;
+    submitInfo.ppCommandBuffers   = &pCmd;
+    submitInfo.pFence             = slot.fence;
+
+    ppxres = mCreateInfo.pQueue->Submit(&submitInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        slot.state = SLOT_STATE_COPYING;
+    }
+    slot.format   = pImage->GetFormat();
+    slot.width    = width;
+    slot.height   = height;
+    slot.rowPitch = pitch.rowPitch;
+    slot.path     = path;
+
+    mNextSlot = (mNextSlot + 1) % CountU32(mSlots);
+
+    return ppx::SUCCESS;
+}
+
+Result FrameCapture::WaitIdle()
+{
+    for (uint32_t i = 0; i < CountU32(mSlots); ++i) {
+        Result ppxres = WaitSlot(mSlots[(mNextSlot + i) % CountU32(mSlots)]);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    return ppx::SUCCESS;
+}
+
+} // namespace grfx
+} // namespace ppx
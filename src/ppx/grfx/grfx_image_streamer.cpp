@@ -0,0 +1,341 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_image_streamer.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_image.h"
+#include "ppx/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace ppx {
+namespace grfx {
+
+static ProfilerEventToken sCreateImageEventToken = 0;
+static ProfilerEventToken sUpdateEventToken      = 0;
+
+namespace internal {
+
+void RegisterImageStreamerProfilerEvents()
+{
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("ImageStreamer::CreateImageFromFile", &sCreateImageEventToken));
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("ImageStreamer::Update", &sUpdateEventToken));
+}
+
+} // namespace internal
+
+Result ImageStreamer::CreateApiObjects(const grfx::ImageStreamerCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(pCreateInfo->pUploadQueue);
+
+    if (pCreateInfo->bytesPerUpdate == 0) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    return ppx::SUCCESS;
+}
+
+void ImageStreamer::DestroyApiObjects()
+{
+    // The images belong to the caller, only wait for their copies
+    for (auto& stream : mStreams) {
+        mCreateInfo.pUploadQueue->Wait(stream.lastTicket);
+    }
+    mStreams.clear();
+}
+
+Result ImageStreamer::CreateImageFromFile(
+    const std::filesystem::path& path,
+    grfx::Image**                ppImage,
+    grfx::ImageUsageFlags        additionalUsage)
+{
+    PPX_ASSERT_NULL_ARG(ppImage);
+
+    ProfilerScopedEventSample sample(sCreateImageEventToken);
+
+    Stream stream = {};
+    stream.file   = std::make_unique<TextureFile>();
+
+    Result ppxres = stream.file->Open(path);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    const TextureFile& file = *stream.file;
+    {
+        grfx::ImageCreateInfo ci       = {};
+        ci.type                        = grfx::IMAGE_TYPE_2D;
+        ci.width                       = file.GetWidth();
+        ci.height                      = file.GetHeight();
+        ci.depth                       = 1;
+        ci.format                      = file.GetFormat();
+        ci.sampleCount                 = grfx::SAMPLE_COUNT_1;
+        ci.mipLevelCount               = file.GetLevelCount();
+        ci.arrayLayerCount             = 1;
+        ci.usageFlags.bits.transferDst = true;
+        ci.usageFlags.bits.sampled     = true;
+        ci.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        ci.initialState                = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+        ci.usageFlags.flags |= additionalUsage.flags;
+
+        ppxres = GetDevice()->CreateImage(&ci, &stream.image);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    stream.residentLevel = file.GetLevelCount();
+    stream.flushedLevel  = file.GetLevelCount();
+    stream.recordedLevel = file.GetLevelCount();
+
+    // The smallest level always goes out whole so the image is usable
+    uint64_t budget = std::max<uint64_t>(mCreateInfo.initialBytes, file.GetLevel(file.GetLevelCount() - 1).size);
+    while ((budget > 0) && (stream.recordedLevel > 0)) {
+        uint64_t recordedBytes = 0;
+        ppxres                 = RecordNextLevel(stream, budget, &recordedBytes);
+        if (Failed(ppxres)) {
+            mCreateInfo.pUploadQueue->WaitIdle();
+            GetDevice()->DestroyImage(stream.image);
+            return ppxres;
+        }
+        budget -= std::min(budget, recordedBytes);
+    }
+
+    stream.image->SetOwnership(grfx::OWNERSHIP_REFERENCE);
+
+    *ppImage = stream.image;
+    mStreams.push_back(std::move(stream));
+
+    grfx::UploadTicket ticket = 0;
+    ppxres                    = Flush(&ticket);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Wait for the smallest levels so the image can be sampled as soon as
+    // this returns
+    ppxres = mCreateInfo.pUploadQueue->Wait(ticket);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    UpdateResidentLevels();
+
+    return ppx::SUCCESS;
+}
+
+Result ImageStreamer::RecordNextLevel(Stream& stream, uint64_t budget, uint64_t* pRecordedBytes)
+{
+    const grfx::Device*     pDevice    = GetDevice();
+    const uint32_t          level      = stream.recordedLevel - 1;
+    const TextureFileLevel& fileLevel  = stream.file->GetLevel(level);
+    const grfx::Format      format     = stream.file->GetFormat();
+    const uint32_t          blockWidth = grfx::GetFormatDescription(format)->blockWidth;
+    const uint32_t          rowsLeft   = fileLevel.rowCount - stream.recordedRows;
+    const uint32_t          rowCount   = static_cast<uint32_t>(std::clamp<uint64_t>(budget / fileLevel.rowSize, 1, rowsLeft));
+
+    // Same staging layout requirements as CopyBitmapToImage()
+    const uint32_t rowStrideAlignment = grfx::IsDx12(pDevice->GetApi()) ? PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT : 1;
+    const uint32_t stagingRowStride   = RoundUp<uint32_t>(fileLevel.rowSize, rowStrideAlignment);
+    const uint64_t stagingAlignment   = grfx::IsDx12(pDevice->GetApi())
+                                            ? PPX_D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+                                            : std::lcm<uint64_t>(grfx::GetFormatDescription(format)->bytesPerTexel, 4);
+
+    grfx::StagingAllocation staging = {};
+    Result                  ppxres  = mCreateInfo.pUploadQueue->AllocateStaging(
+        static_cast<uint64_t>(stagingRowStride) * rowCount,
+        stagingAlignment,
+        &staging);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    {
+        const char* pSrc = stream.file->GetLevelData(level) + static_cast<uint64_t>(stream.recordedRows) * fileLevel.rowSize;
+        char*       pDst = static_cast<char*>(staging.pMappedAddress);
+        for (uint32_t row = 0; row < rowCount; ++row) {
+            memcpy(pDst, pSrc, fileLevel.rowSize);
+            pSrc += fileLevel.rowSize;
+            pDst += stagingRowStride;
+        }
+    }
+
+    grfx::BufferToImageCopyInfo copyInfo = {};
+    copyInfo.srcBuffer.imageWidth        = fileLevel.width;
+    copyInfo.srcBuffer.imageHeight       = rowCount * blockWidth;
+    copyInfo.srcBuffer.imageRowStride    = stagingRowStride;
+    copyInfo.srcBuffer.footprintOffset   = staging.offset;
+    copyInfo.srcBuffer.footprintWidth    = fileLevel.width;
+    copyInfo.srcBuffer.footprintHeight   = rowCount * blockWidth;
+    copyInfo.srcBuffer.footprintDepth    = 1;
+    copyInfo.dstImage.mipLevel           = level;
+    copyInfo.dstImage.arrayLayer         = 0;
+    copyInfo.dstImage.arrayLayerCount    = 1;
+    copyInfo.dstImage.x                  = 0;
+    copyInfo.dstImage.y                  = stream.recordedRows * blockWidth;
+    copyInfo.dstImage.z                  = 0;
+    copyInfo.dstImage.width              = fileLevel.width;
+    copyInfo.dstImage.height             = rowCount * blockWidth;
+    copyInfo.dstImage.depth              = 1;
+
+    ppxres = mCreateInfo.pUploadQueue->CopyBufferToImage(
+        std::vector<grfx::BufferToImageCopyInfo>{copyInfo},
+        staging,
+        stream.image,
+        level,
+        1,
+        0,
+        1,
+        grfx::RESOURCE_STATE_SHADER_RESOURCE,
+        grfx::RESOURCE_STATE_SHADER_RESOURCE);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    stream.recordedRows += rowCount;
+    if (stream.recordedRows == fileLevel.rowCount) {
+        stream.recordedLevel -= 1;
+        stream.recordedRows = 0;
+    }
+
+    *pRecordedBytes = static_cast<uint64_t>(rowCount) * fileLevel.rowSize;
+
+    return ppx::SUCCESS;
+}
+
+Result ImageStreamer::Flush(grfx::UploadTicket* pTicket)
+{
+    grfx::UploadTicket ticket = 0;
+    Result             ppxres = mCreateInfo.pUploadQueue->Flush(&ticket);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    for (auto& stream : mStreams) {
+        stream.lastTicket = ticket;
+    }
+    UpdateResidentLevels();
+
+    if (!IsNull(pTicket)) {
+        *pTicket = ticket;
+    }
+
+    return ppx::SUCCESS;
+}
+
+void ImageStreamer::UpdateResidentLevels()
+{
+    grfx::UploadQueue* pUploadQueue = mCreateInfo.pUploadQueue;
+    for (auto& stream : mStreams) {
+        // Batches complete in flush order, so once the last flush is done
+        // every recorded level is resident
+        if (pUploadQueue->IsComplete(stream.lastTicket)) {
+            stream.residentLevel = stream.recordedLevel;
+            stream.flushedLevel  = stream.recordedLevel;
+            stream.flushedTicket = stream.lastTicket;
+        }
+        // Only move on to the levels of a newer flush once the tracked one
+        // is done, tracking the newest flush every frame could keep the
+        // levels from ever becoming resident
+        else if (pUploadQueue->IsComplete(stream.flushedTicket)) {
+            stream.residentLevel = stream.flushedLevel;
+            stream.flushedLevel  = stream.recordedLevel;
+            stream.flushedTicket = stream.lastTicket;
+        }
+    }
+
+    // Fully resident images don't need their file anymore
+    mStreams.erase(
+        std::remove_if(mStreams.begin(), mStreams.end(), [](const Stream& stream) { return stream.residentLevel == 0; }),
+        mStreams.end());
+}
+
+Result ImageStreamer::Update()
+{
+    ProfilerScopedEventSample sample(sUpdateEventToken);
+
+    if (mStreams.empty()) {
+        return ppx::SUCCESS;
+    }
+
+    uint64_t budget = mCreateInfo.bytesPerUpdate;
+    while (budget > 0) {
+        // Smallest pending level first, so every image sharpens at the
+        // same rate instead of one image at a time
+        Stream* pNext = nullptr;
+        for (auto& stream : mStreams) {
+            if (stream.recordedLevel == 0) {
+                continue;
+            }
+            const uint64_t size = stream.file->GetLevel(stream.recordedLevel - 1).size;
+            if (IsNull(pNext) || (size < pNext->file->GetLevel(pNext->recordedLevel - 1).size)) {
+                pNext = &stream;
+            }
+        }
+        if (IsNull(pNext)) {
+            break;
+        }
+
+        uint64_t recordedBytes = 0;
+        Result   ppxres        = RecordNextLevel(*pNext, budget, &recordedBytes);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        budget -= std::min(budget, recordedBytes);
+    }
+
+    return Flush();
+}
+
+uint32_t ImageStreamer::GetResidentMipLevel(const grfx::Image* pImage) const
+{
+    for (const auto& stream : mStreams) {
+        if (stream.image.Get() == pImage) {
+            return stream.residentLevel;
+        }
+    }
+    return 0;
+}
+
+Result ImageStreamer::Remove(const grfx::Image* pImage)
+{
+    auto it = std::find_if(mStreams.begin(), mStreams.end(), [pImage](const Stream& stream) { return stream.image.Get() == pImage; });
+    if (it == mStreams.end()) {
+        return ppx::SUCCESS;
+    }
+
+    const grfx::UploadTicket ticket = it->lastTicket;
+    mStreams.erase(it);
+
+    return mCreateInfo.pUploadQueue->Wait(ticket);
+}
+
+uint64_t ImageStreamer::GetPendingBytes() const
+{
+    uint64_t pendingBytes = 0;
+    for (const auto& stream : mStreams) {
+        for (uint32_t level = 0; level < stream.recordedLevel; ++level) {
+            pendingBytes += stream.file->GetLevel(level).size;
+        }
+        if (stream.recordedRows > 0) {
+            pendingBytes -= static_cast<uint64_t>(stream.recordedRows) * stream.file->GetLevel(stream.recordedLevel - 1).rowSize;
+        }
+    }
+    return pendingBytes;
+}
+
+} // namespace grfx
+} // namespace ppx
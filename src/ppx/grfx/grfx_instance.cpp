@@ -14,7 +14,10 @@
 
 #include "ppx/grfx/grfx_instance.h"
 #include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_frame_capture.h"
 #include "ppx/grfx/grfx_gpu.h"
+#include "ppx/grfx/grfx_image_streamer.h"
+#include "ppx/grfx/grfx_upload_queue.h"
 #if defined(PPX_D3D12)
 #include "ppx/grfx/dx12/dx12_instance.h"
 #endif // defined(PPX_D3D12)
@@ -31,6 +34,11 @@ Result Instance::Create(const grfx::InstanceCreateInfo* pCreateInfo)
 {
     mCreateInfo = *pCreateInfo;
 
+    // Register profiler events before any object that records them exists
+    internal::RegisterFrameCaptureProfilerEvents();
+    internal::RegisterImageStreamerProfilerEvents();
+    internal::RegisterUploadQueueProfilerEvents();
+
     Result ppxres = CreateApiObjects(&mCreateInfo);
     if (Failed(ppxres)) {
         return ppxres;
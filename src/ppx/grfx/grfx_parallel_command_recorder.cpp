@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_parallel_command_recorder.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/thread_pool.h"
+
+#include <algorithm>
+
+namespace ppx {
+namespace grfx {
+
+void GetParallelRecordRange(uint32_t itemCount, uint32_t rangeCount, uint32_t rangeIndex, uint32_t* pBegin, uint32_t* pEnd)
+{
+    PPX_ASSERT_MSG(rangeIndex < rangeCount, "range index out of range");
+
+    // The first (itemCount % rangeCount) ranges get one extra item
+    const uint32_t baseSize  = itemCount / rangeCount;
+    const uint32_t remainder = itemCount % rangeCount;
+    *pBegin                  = rangeIndex * baseSize + std::min(rangeIndex, remainder);
+    *pEnd                    = *pBegin + baseSize + ((rangeIndex < remainder) ? 1 : 0);
+}
+
+Result ParallelCommandRecorder::CreateApiObjects(const grfx::ParallelCommandRecorderCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    if (IsNull(pCreateInfo->pQueue) || (pCreateInfo->frameCount == 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    mThreadPool  = IsNull(pCreateInfo->pThreadPool) ? &ThreadPool::GetDefault() : pCreateInfo->pThreadPool;
+    mWorkerCount = (pCreateInfo->workerCount > 0) ? pCreateInfo->workerCount : (mThreadPool->GetThreadCount() + 1);
+
+    mFrames.resize(pCreateInfo->frameCount);
+    for (auto& workers : mFrames) {
+        workers.resize(mWorkerCount);
+        for (auto& worker : workers) {
+            grfx::CommandPoolCreateInfo ci = {};
+            ci.pQueue                      = pCreateInfo->pQueue;
+
+            Result ppxres = GetDevice()->CreateCommandPool(&ci, &worker.commandPool);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+
+            ppxres = GetDevice()->AllocateCommandBuffer(
+                worker.commandPool,
+                &worker.commandBuffer,
+                pCreateInfo->resourceDescriptorCount,
+                pCreateInfo->samplerDescriptorCount,
+                grfx::COMMAND_BUFFER_LEVEL_SECONDARY);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void ParallelCommandRecorder::DestroyApiObjects()
+{
+    for (auto& workers : mFrames) {
+        for (auto& worker : workers) {
+            if (worker.commandBuffer) {
+                GetDevice()->FreeCommandBuffer(worker.commandBuffer);
+                worker.commandBuffer.Reset();
+            }
+            if (worker.commandPool) {
+                GetDevice()->DestroyCommandPool(worker.commandPool);
+                worker.commandPool.Reset();
+            }
+        }
+    }
+    mFrames.clear();
+}
+
+Result ParallelCommandRecorder::Record(
+    uint32_t                frameIndex,
+    grfx::CommandBuffer*    pPrimary,
+    const grfx::RenderPass* pRenderPass,
+    uint32_t                itemCount,
+    const ParallelRecordFn& fn)
+{
+    PPX_ASSERT_NULL_ARG(pPrimary);
+
+    if (itemCount == 0) {
+        return ppx::SUCCESS;
+    }
+
+    std::vector<Worker>& workers    = mFrames[frameIndex % CountU32(mFrames)];
+    const uint32_t       rangeCount = std::min(itemCount, mWorkerCount);
+
+    std::vector<Result> results(rangeCount, ppx::SUCCESS);
+    mThreadPool->ParallelFor(rangeCount, [&](uint32_t i) {
+        grfx::CommandBuffer* pCommandBuffer = workers[i].commandBuffer.Get();
+
+        results[i] = pCommandBuffer->BeginSecondary(pRenderPass);
+        if (Failed(results[i])) {
+            return;
+        }
+
+        uint32_t begin = 0;
+        uint32_t end   = 0;
+        GetParallelRecordRange(itemCount, rangeCount, i, &begin, &end);
+        fn(pCommandBuffer, begin, end, i);
+
+        results[i] = pCommandBuffer->End();
+    });
+
+    std::vector<const grfx::CommandBuffer*> commandBuffers(rangeCount);
+    for (uint32_t i = 0; i < rangeCount; ++i) {
+        if (Failed(results[i])) {
+            return results[i];
+        }
+        commandBuffers[i] = workers[i].commandBuffer.Get();
+    }
+
+    pPrimary->ExecuteCommands(rangeCount, commandBuffers.data());
+
+    return ppx::SUCCESS;
+}
+
+} // namespace grfx
+} // namespace ppx
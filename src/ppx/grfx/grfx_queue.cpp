@@ -15,6 +15,7 @@
 #include "ppx/grfx/grfx_queue.h"
 #include "ppx/grfx/grfx_device.h"
 #include "ppx/grfx/grfx_scope.h"
+#include "ppx/grfx/grfx_sync.h"
 
 namespace ppx {
 namespace grfx {
@@ -94,6 +95,16 @@ Result Queue::CopyBufferToBuffer(
     }
     SCOPED_DESTROYER.AddObject(this, cmd);
 
+    // Wait on this submission only instead of the whole queue
+    grfx::FenceCreateInfo fenceCreateInfo = {};
+    grfx::FencePtr        fence;
+
+    ppxres = GetDevice()->CreateFence(&fenceCreateInfo, &fence);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    SCOPED_DESTROYER.AddObject(fence);
+
     // Build command buffer
     {
         ppxres = cmd->Begin();
@@ -115,6 +126,7 @@ Result Queue::CopyBufferToBuffer(
     grfx::SubmitInfo submit;
     submit.commandBufferCount = 1;
     submit.ppCommandBuffers   = &cmd;
+    submit.pFence             = fence;
     //
     ppxres = Submit(&submit);
     if (Failed(ppxres)) {
@@ -122,7 +134,7 @@ Result Queue::CopyBufferToBuffer(
     }
 
     // Wait work completion
-    ppxres = WaitIdle();
+    ppxres = fence->Wait();
     if (Failed(ppxres)) {
         return ppxres;
     }
@@ -151,6 +163,16 @@ Result Queue::CopyBufferToImage(
     }
     SCOPED_DESTROYER.AddObject(this, cmd);
 
+    // Wait on this submission only instead of the whole queue
+    grfx::FenceCreateInfo fenceCreateInfo = {};
+    grfx::FencePtr        fence;
+
+    ppxres = GetDevice()->CreateFence(&fenceCreateInfo, &fence);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    SCOPED_DESTROYER.AddObject(fence);
+
     // Build command buffer
     {
         ppxres = cmd->Begin();
@@ -172,6 +194,7 @@ Result Queue::CopyBufferToImage(
     grfx::SubmitInfo submit;
     submit.commandBufferCount = 1;
     submit.ppCommandBuffers   = &cmd;
+    submit.pFence             = fence;
     //
     ppxres = Submit(&submit);
     if (Failed(ppxres)) {
@@ -179,7 +202,7 @@ Result Queue::CopyBufferToImage(
     }
 
     // Wait work completion
-    ppxres = WaitIdle();
+    ppxres = fence->Wait();
     if (Failed(ppxres)) {
         return ppxres;
     }
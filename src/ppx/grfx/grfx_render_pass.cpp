@@ -491,6 +491,15 @@ Result RenderPass::Create(const grfx::internal::RenderPassCreateInfo* pCreateInf
         } break;
     }
 
+    // Destroy() can run after supplied images are gone (e.g. swapchain
+    // images on resize), it checks these before touching the images
+    for (const auto& image : mRenderTargetImages) {
+        mRenderTargetImageHandles.push_back(image->GetRegistryHandle());
+    }
+    if (mDepthStencilImage) {
+        mDepthStencilImageHandle = mDepthStencilImage->GetRegistryHandle();
+    }
+
     Result ppxres = grfx::DeviceObject<grfx::internal::RenderPassCreateInfo>::Create(pCreateInfo);
     if (Failed(ppxres)) {
         return ppxres;
@@ -509,6 +518,9 @@ void RenderPass::Destroy()
         }
 
         grfx::ImagePtr& image = mRenderTargetImages[i];
+        if (image && (i < mRenderTargetImageHandles.size()) && !GetDevice()->HasImage(mRenderTargetImageHandles[i])) {
+            image.Reset();
+        }
         if (image && (image->GetOwnership() != grfx::OWNERSHIP_REFERENCE)) {
             GetDevice()->DestroyImage(image);
             image.Reset();
@@ -516,12 +528,16 @@ void RenderPass::Destroy()
     }
     mRenderTargetViews.clear();
     mRenderTargetImages.clear();
+    mRenderTargetImageHandles.clear();
 
     if (mDepthStencilView && (mDepthStencilView->GetOwnership() != grfx::OWNERSHIP_REFERENCE)) {
         GetDevice()->DestroyDepthStencilView(mDepthStencilView);
         mDepthStencilView.Reset();
     }
 
+    if (mDepthStencilImage && (mDepthStencilImageHandle != 0) && !GetDevice()->HasImage(mDepthStencilImageHandle)) {
+        mDepthStencilImage.Reset();
+    }
     if (mDepthStencilImage && (mDepthStencilImage->GetOwnership() != grfx::OWNERSHIP_REFERENCE)) {
         GetDevice()->DestroyImage(mDepthStencilImage);
         mDepthStencilImage.Reset();
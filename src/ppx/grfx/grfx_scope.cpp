@@ -30,6 +30,14 @@ ScopeDestroyer::ScopeDestroyer(grfx::Device* pDevice)
 
 ScopeDestroyer::~ScopeDestroyer()
 {
+    // Upload queues wait on their batches, which may use other objects in this scope
+    for (auto& object : mUploadQueues) {
+        if (object->GetOwnership() == grfx::OWNERSHIP_EXCLUSIVE) {
+            mDevice->DestroyUploadQueue(object);
+        }
+    }
+    mUploadQueues.clear();
+
     for (auto& object : mImages) {
         if (object->GetOwnership() == grfx::OWNERSHIP_EXCLUSIVE) {
             mDevice->DestroyImage(object);
@@ -72,6 +80,13 @@ ScopeDestroyer::~ScopeDestroyer()
     }
     mSampledImageViews.clear();
 
+    for (auto& object : mFences) {
+        if (object->GetOwnership() == grfx::OWNERSHIP_EXCLUSIVE) {
+            mDevice->DestroyFence(object);
+        }
+    }
+    mFences.clear();
+
     for (auto& object : mTransientCommandBuffers) {
         if (object.second->GetOwnership() == grfx::OWNERSHIP_EXCLUSIVE) {
             object.first->DestroyCommandBuffer(object.second);
@@ -169,6 +184,36 @@ Result ScopeDestroyer::AddObject(grfx::SampledImageView* pObject)
     return ppx::SUCCESS;
 }
 
+Result ScopeDestroyer::AddObject(grfx::Fence* pObject)
+{
+    if (IsNull(pObject)) {
+        PPX_ASSERT_MSG(false, NULL_ARGUMENT_MSG);
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (pObject->GetOwnership() != grfx::OWNERSHIP_REFERENCE) {
+        PPX_ASSERT_MSG(false, WRONG_OWNERSHIP_MSG);
+        return ppx::ERROR_GRFX_INVALID_OWNERSHIP;
+    }
+    pObject->SetOwnership(grfx::OWNERSHIP_EXCLUSIVE);
+    mFences.push_back(pObject);
+    return ppx::SUCCESS;
+}
+
+Result ScopeDestroyer::AddObject(grfx::UploadQueue* pObject)
+{
+    if (IsNull(pObject)) {
+        PPX_ASSERT_MSG(false, NULL_ARGUMENT_MSG);
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (pObject->GetOwnership() != grfx::OWNERSHIP_REFERENCE) {
+        PPX_ASSERT_MSG(false, WRONG_OWNERSHIP_MSG);
+        return ppx::ERROR_GRFX_INVALID_OWNERSHIP;
+    }
+    pObject->SetOwnership(grfx::OWNERSHIP_EXCLUSIVE);
+    mUploadQueues.push_back(pObject);
+    return ppx::SUCCESS;
+}
+
 Result ScopeDestroyer::AddObject(grfx::Queue* pParent, grfx::CommandBuffer* pObject)
 {
     if (IsNull(pParent) || IsNull(pObject)) {
@@ -192,6 +237,8 @@ void ScopeDestroyer::ReleaseAll()
     mTextures.clear();
     mSamplers.clear();
     mSampledImageViews.clear();
+    mFences.clear();
+    mUploadQueues.clear();
     mTransientCommandBuffers.clear();
 }
 
@@ -0,0 +1,359 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_staging_ring.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_sync.h"
+#include "ppx/timer.h"
+
+#include <algorithm>
+
+namespace ppx {
+namespace grfx {
+
+Result StagingRing::CreateApiObjects(const grfx::StagingRingCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    if (pCreateInfo->initialSize == 0) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+    mCreateInfo.maxSize = std::max(pCreateInfo->maxSize, pCreateInfo->initialSize);
+
+    Result ppxres = CreateChunk(pCreateInfo->initialSize, &mChunk);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    mStats.capacity = mChunk.size;
+
+    return ppx::SUCCESS;
+}
+
+void StagingRing::DestroyApiObjects()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto& chunk : mRetiredChunks) {
+        DestroyChunk(chunk);
+    }
+    mRetiredChunks.clear();
+
+    DestroyChunk(mChunk);
+}
+
+Result StagingRing::CreateRingBuffer(uint64_t size, grfx::Buffer** ppBuffer, void** ppMappedAddress)
+{
+    grfx::BufferCreateInfo ci      = {};
+    ci.size                        = size;
+    ci.usageFlags.bits.transferSrc = true;
+    ci.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+    grfx::BufferPtr buffer;
+    Result          ppxres = GetDevice()->CreateBuffer(&ci, &buffer);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating staging ring buffer");
+        return ppxres;
+    }
+
+    ppxres = buffer->MapMemory(0, ppMappedAddress);
+    if (Failed(ppxres)) {
+        GetDevice()->DestroyBuffer(buffer);
+        return ppxres;
+    }
+
+    *ppBuffer = buffer;
+    return ppx::SUCCESS;
+}
+
+void StagingRing::DestroyRingBuffer(grfx::Buffer* pBuffer)
+{
+    pBuffer->UnmapMemory();
+    GetDevice()->DestroyBuffer(pBuffer);
+}
+
+Result StagingRing::CreateChunk(uint64_t size, Chunk* pChunk)
+{
+    grfx::Buffer* pBuffer  = nullptr;
+    void*         pAddress = nullptr;
+    Result        ppxres   = CreateRingBuffer(size, &pBuffer, &pAddress);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pChunk          = Chunk();
+    pChunk->buffer   = pBuffer;
+    pChunk->pAddress = static_cast<char*>(pAddress);
+    pChunk->size     = size;
+
+    return ppx::SUCCESS;
+}
+
+void StagingRing::DestroyChunk(Chunk& chunk)
+{
+    if (chunk.buffer) {
+        DestroyRingBuffer(chunk.buffer);
+        chunk.buffer.Reset();
+    }
+    chunk.pAddress = nullptr;
+    chunk.regions.clear();
+}
+
+Result StagingRing::Grow(uint64_t requiredSize)
+{
+    // Double until maxSize, but always make room for the allocation
+    uint64_t newSize = std::min(2 * mChunk.size, mCreateInfo.maxSize);
+    newSize          = std::max(newSize, requiredSize);
+    if (newSize <= mChunk.size) {
+        newSize = 2 * mChunk.size;
+        PPX_LOG_WARN("staging ring grew past maxSize because nothing could be waited on");
+    }
+
+    Chunk  chunk;
+    Result ppxres = CreateChunk(newSize, &chunk);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    if (mChunk.regions.empty()) {
+        DestroyChunk(mChunk);
+    }
+    else {
+        mRetiredChunks.push_back(std::move(mChunk));
+    }
+    mChunk = std::move(chunk);
+
+    mStats.growCount += 1;
+    mStats.capacity = mChunk.size;
+
+    return ppx::SUCCESS;
+}
+
+bool StagingRing::TryAllocate(Chunk& chunk, uint64_t size, uint64_t alignment, uint64_t* pOffset)
+{
+    uint64_t head    = chunk.head;
+    uint64_t offset  = head % chunk.size;
+    uint64_t aligned = ((offset + alignment - 1) / alignment) * alignment;
+    if ((aligned + size) > chunk.size) {
+        // Skip the tail end of the ring and start over at offset 0. The
+        // skipped bytes are free if nothing is allocated.
+        head += chunk.size - offset;
+        offset  = 0;
+        aligned = 0;
+        if (chunk.tail == chunk.head) {
+            chunk.tail = head;
+        }
+    }
+    head += (aligned - offset) + size;
+
+    if ((head - chunk.tail) > chunk.size) {
+        return false;
+    }
+
+    mStats.bytesStaged += head - chunk.head;
+    chunk.head = head;
+    *pOffset   = aligned;
+    return true;
+}
+
+void StagingRing::ReleaseRegions(Chunk& chunk)
+{
+    while (!chunk.regions.empty()) {
+        const Region& region   = chunk.regions.front();
+        bool          released = false;
+        switch (region.state) {
+            default: break;
+            case REGION_STATE_FREE: released = true; break;
+            case REGION_STATE_FENCE: released = (region.pFence->Wait(0) == ppx::SUCCESS); break;
+            case REGION_STATE_FRAME: released = (region.frameNumber <= mCompletedFrame); break;
+        }
+        if (!released) {
+            break;
+        }
+        chunk.tail = region.end;
+        chunk.regions.pop_front();
+    }
+}
+
+void StagingRing::ReleaseAll()
+{
+    ReleaseRegions(mChunk);
+
+    for (auto& chunk : mRetiredChunks) {
+        ReleaseRegions(chunk);
+        if (chunk.regions.empty()) {
+            DestroyChunk(chunk);
+        }
+    }
+    RemoveElementIf(mRetiredChunks, [](const Chunk& chunk) -> bool { return !chunk.buffer; });
+}
+
+StagingRing::Region* StagingRing::FindRegion(uint64_t id)
+{
+    auto find = [id](std::deque<Region>& regions) -> Region* {
+        auto it = std::lower_bound(
+            regions.begin(),
+            regions.end(),
+            id,
+            [](const Region& region, uint64_t value) -> bool { return region.id < value; });
+        return ((it != regions.end()) && (it->id == id)) ? &(*it) : nullptr;
+    };
+
+    Region* pRegion = find(mChunk.regions);
+    for (size_t i = 0; IsNull(pRegion) && (i < mRetiredChunks.size()); ++i) {
+        pRegion = find(mRetiredChunks[i].regions);
+    }
+    return pRegion;
+}
+
+uint64_t StagingRing::GetBytesInUse() const
+{
+    uint64_t bytesInUse = mChunk.head - mChunk.tail;
+    for (auto& chunk : mRetiredChunks) {
+        bytesInUse += chunk.head - chunk.tail;
+    }
+    return bytesInUse;
+}
+
+Result StagingRing::Allocate(uint64_t size, uint64_t alignment, grfx::StagingAllocation* pAllocation)
+{
+    PPX_ASSERT_NULL_ARG(pAllocation);
+
+    if (size == 0) {
+        return ppx::ERROR_UNEXPECTED_COUNT_VALUE;
+    }
+    alignment = std::max<uint64_t>(alignment, 1);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    uint64_t offset = 0;
+    while (!TryAllocate(mChunk, size, alignment, &offset)) {
+        ReleaseAll();
+        if (TryAllocate(mChunk, size, alignment, &offset)) {
+            break;
+        }
+
+        const uint64_t requiredSize = size + alignment;
+        if ((mChunk.size < mCreateInfo.maxSize) || (requiredSize > mChunk.size)) {
+            Result ppxres = Grow(requiredSize);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            continue;
+        }
+
+        // At maxSize, wait on the oldest allocation if it's fence retired
+        Region* pOldest = mChunk.regions.empty() ? nullptr : &mChunk.regions.front();
+        if (!IsNull(pOldest) && (pOldest->state == REGION_STATE_FENCE)) {
+            Timer timer;
+            timer.Start();
+
+            Result ppxres = pOldest->pFence->Wait();
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            pOldest->state = REGION_STATE_FREE;
+
+            mStats.stallCount += 1;
+            mStats.stallMillis += timer.MillisSinceStart();
+            continue;
+        }
+
+        // The oldest allocation hasn't been retired yet or is waiting on a
+        // frame, so there's nothing to wait on.
+        Result ppxres = Grow(requiredSize);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    Region region = {};
+    region.id     = mNextId++;
+    region.end    = mChunk.head;
+    mChunk.regions.push_back(region);
+
+    mStats.allocationCount += 1;
+    mStats.peakBytesInUse = std::max(mStats.peakBytesInUse, GetBytesInUse());
+
+    pAllocation->pBuffer        = mChunk.buffer;
+    pAllocation->offset         = offset;
+    pAllocation->size           = size;
+    pAllocation->pMappedAddress = mChunk.pAddress + offset;
+    pAllocation->id             = region.id;
+
+    return ppx::SUCCESS;
+}
+
+void StagingRing::Free(const grfx::StagingAllocation& allocation)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Ids are never reused, a missing region was already released by a
+    // fence or frame retire.
+    Region* pRegion = FindRegion(allocation.id);
+    if (IsNull(pRegion)) {
+        return;
+    }
+    pRegion->state = REGION_STATE_FREE;
+
+    ReleaseAll();
+}
+
+void StagingRing::Retire(const grfx::StagingAllocation& allocation, grfx::Fence* pFence)
+{
+    PPX_ASSERT_NULL_ARG(pFence);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Region* pRegion = FindRegion(allocation.id);
+    if (IsNull(pRegion)) {
+        PPX_ASSERT_MSG(false, "staging allocation was already released");
+        return;
+    }
+    pRegion->state  = REGION_STATE_FENCE;
+    pRegion->pFence = pFence;
+}
+
+void StagingRing::Retire(const grfx::StagingAllocation& allocation, uint64_t frameNumber)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Region* pRegion = FindRegion(allocation.id);
+    if (IsNull(pRegion)) {
+        PPX_ASSERT_MSG(false, "staging allocation was already released");
+        return;
+    }
+    pRegion->state       = REGION_STATE_FRAME;
+    pRegion->frameNumber = frameNumber;
+}
+
+void StagingRing::ReleaseFrames(uint64_t completedFrameNumber)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mCompletedFrame = std::max(mCompletedFrame, completedFrameNumber);
+    ReleaseAll();
+}
+
+grfx::StagingRingStats StagingRing::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    grfx::StagingRingStats stats = mStats;
+    stats.bytesInUse             = GetBytesInUse();
+    return stats;
+}
+
+} // namespace grfx
+} // namespace ppx
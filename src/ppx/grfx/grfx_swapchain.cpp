@@ -17,9 +17,95 @@
 #include "ppx/grfx/grfx_render_pass.h"
 #include "ppx/grfx/grfx_instance.h"
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 namespace ppx {
 namespace grfx {
 
+namespace internal {
+
+void HeadlessPresentQueue::Reset(uint32_t imageCount, grfx::PresentMode presentMode, double refreshPeriod, double startTime)
+{
+    mImageStates.assign(imageCount, IMAGE_STATE_FREE);
+    mQueuedImages.clear();
+    mPresentMode         = presentMode;
+    mRefreshPeriod       = refreshPeriod;
+    mStartTime           = startTime;
+    mRefreshCount        = 0;
+    mNextImageIndex      = 0;
+    mDisplayedImageIndex = UINT32_MAX;
+
+    // A single image would stay displayed forever, so it's never paced
+    mPaced = ((presentMode == grfx::PRESENT_MODE_FIFO) || (presentMode == grfx::PRESENT_MODE_MAILBOX)) && (refreshPeriod > 0) && (imageCount > 1);
+}
+
+void HeadlessPresentQueue::Refresh(double now)
+{
+    const double   elapsed      = std::max(now - mStartTime, 0.0);
+    const uint64_t refreshCount = static_cast<uint64_t>(std::floor(elapsed / mRefreshPeriod));
+    while ((mRefreshCount < refreshCount) && !mQueuedImages.empty()) {
+        ++mRefreshCount;
+        if (mDisplayedImageIndex != UINT32_MAX) {
+            mImageStates[mDisplayedImageIndex] = IMAGE_STATE_FREE;
+        }
+        mDisplayedImageIndex = mQueuedImages.front();
+        mQueuedImages.pop_front();
+        mImageStates[mDisplayedImageIndex] = IMAGE_STATE_DISPLAYED;
+    }
+    // Refreshes with nothing queued don't change anything
+    mRefreshCount = std::max(mRefreshCount, refreshCount);
+}
+
+bool HeadlessPresentQueue::Acquire(double now, uint32_t* pImageIndex, double* pRetryTime)
+{
+    const uint32_t imageCount = CountU32(mImageStates);
+    if (!mPaced) {
+        *pImageIndex    = mNextImageIndex;
+        mNextImageIndex = (mNextImageIndex + 1) % imageCount;
+        return true;
+    }
+
+    Refresh(now);
+    for (uint32_t i = 0; i < imageCount; ++i) {
+        const uint32_t imageIndex = (mNextImageIndex + i) % imageCount;
+        if (mImageStates[imageIndex] == IMAGE_STATE_FREE) {
+            mImageStates[imageIndex] = IMAGE_STATE_ACQUIRED;
+            mNextImageIndex          = (imageIndex + 1) % imageCount;
+            *pImageIndex             = imageIndex;
+            return true;
+        }
+    }
+
+    *pRetryTime = mStartTime + static_cast<double>(mRefreshCount + 1) * mRefreshPeriod;
+    return false;
+}
+
+void HeadlessPresentQueue::Present(double now, uint32_t imageIndex)
+{
+    if (!mPaced || !IsIndexInRange(imageIndex, mImageStates) || (mImageStates[imageIndex] != IMAGE_STATE_ACQUIRED)) {
+        return;
+    }
+
+    Refresh(now);
+    if (mPresentMode == grfx::PRESENT_MODE_MAILBOX) {
+        // Images waiting for the refresh are replaced and free right away
+        for (uint32_t queuedImageIndex : mQueuedImages) {
+            mImageStates[queuedImageIndex] = IMAGE_STATE_FREE;
+        }
+        mQueuedImages.clear();
+    }
+    mImageStates[imageIndex] = IMAGE_STATE_QUEUED;
+    mQueuedImages.push_back(imageIndex);
+}
+
+} // namespace internal
+
+// -------------------------------------------------------------------------------------------------
+// Swapchain
+// -------------------------------------------------------------------------------------------------
+
 Result Swapchain::Create(const grfx::SwapchainCreateInfo* pCreateInfo)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo->pQueue);
@@ -92,16 +178,11 @@ Result Swapchain::Create(const grfx::SwapchainCreateInfo* pCreateInfo)
     }
 
     if (IsHeadless()) {
-        // Set mCurrentImageIndex to (imageCount - 1) so that the first
-        // AcquireNextImage call acquires the first image at index 0.
-        mCurrentImageIndex = mCreateInfo.imageCount - 1;
-
-        // Create command buffers to signal and wait semaphores at
-        // AcquireNextImage and Present calls.
-        for (uint32_t i = 0; i < mCreateInfo.imageCount; ++i) {
-            grfx::CommandBufferPtr commandBuffer = nullptr;
-            mCreateInfo.pQueue->CreateCommandBuffer(&commandBuffer, 0, 0);
-            mHeadlessCommandBuffers.push_back(commandBuffer);
+        const double refreshPeriod = (mCreateInfo.headlessRefreshRate > 0) ? (1.0 / mCreateInfo.headlessRefreshRate) : 0.0;
+        mHeadlessStartTime         = std::chrono::steady_clock::now();
+        mHeadlessPresentQueue.Reset(mCreateInfo.imageCount, mCreateInfo.presentMode, refreshPeriod, 0.0);
+        if (mHeadlessPresentQueue.IsPaced()) {
+            PPX_LOG_INFO("Headless swapchain paced at " << mCreateInfo.headlessRefreshRate << " Hz");
         }
     }
 
@@ -133,13 +214,6 @@ void Swapchain::Destroy()
     }
 #endif
 
-    for (auto& elem : mHeadlessCommandBuffers) {
-        if (elem) {
-            mCreateInfo.pQueue->DestroyCommandBuffer(elem);
-        }
-    }
-    mHeadlessCommandBuffers.clear();
-
     grfx::DeviceObject<grfx::SwapchainCreateInfo>::Destroy();
 }
 
@@ -471,41 +545,47 @@ Result Swapchain::Present(
 
 Result Swapchain::AcquireNextImageHeadless(uint64_t timeout, grfx::Semaphore* pSemaphore, grfx::Fence* pFence, uint32_t* pImageIndex)
 {
-    *pImageIndex       = (mCurrentImageIndex + 1u) % CountU32(mColorImages);
-    mCurrentImageIndex = *pImageIndex;
-
-    grfx::CommandBufferPtr commandBuffer = mHeadlessCommandBuffers[mCurrentImageIndex];
+    const double timeoutTime = (timeout == UINT64_MAX) ? std::numeric_limits<double>::infinity() : (GetHeadlessTime() + timeout / 1e9);
 
-    commandBuffer->Begin();
-    commandBuffer->End();
+    uint32_t imageIndex = 0;
+    double   retryTime  = 0;
+    while (!mHeadlessPresentQueue.Acquire(GetHeadlessTime(), &imageIndex, &retryTime)) {
+        if (retryTime > timeoutTime) {
+            return ppx::ERROR_WAIT_TIMED_OUT;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(retryTime - GetHeadlessTime()));
+    }
+    *pImageIndex       = imageIndex;
+    mCurrentImageIndex = imageIndex;
 
-    grfx::SubmitInfo sInfo     = {};
-    sInfo.ppCommandBuffers     = &commandBuffer;
-    sInfo.commandBufferCount   = 1;
-    sInfo.pFence               = pFence;
-    sInfo.ppSignalSemaphores   = &pSemaphore;
-    sInfo.signalSemaphoreCount = 1;
-    mCreateInfo.pQueue->Submit(&sInfo);
+    // Nothing reads the virtual images, they're ready as soon as they're free
+    if (!IsNull(pSemaphore)) {
+        Result ppxres = pSemaphore->SignalOnHost();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    if (!IsNull(pFence)) {
+        Result ppxres = pFence->SignalOnHost();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
 
     return ppx::SUCCESS;
 }
 
 Result Swapchain::PresentHeadless(uint32_t imageIndex, uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores)
 {
-    grfx::CommandBufferPtr commandBuffer = mHeadlessCommandBuffers[mCurrentImageIndex];
-
-    commandBuffer->Begin();
-    commandBuffer->End();
-
-    grfx::SubmitInfo sInfo   = {};
-    sInfo.ppCommandBuffers   = &commandBuffer;
-    sInfo.commandBufferCount = 1;
-    sInfo.ppWaitSemaphores   = ppWaitSemaphores;
-    sInfo.waitSemaphoreCount = waitSemaphoreCount;
-    mCreateInfo.pQueue->Submit(&sInfo);
-
+    mHeadlessPresentQueue.Present(GetHeadlessTime(), imageIndex);
+    mCreateInfo.pQueue->DeferWaitSemaphores(waitSemaphoreCount, ppWaitSemaphores);
     return ppx::SUCCESS;
 }
 
+double Swapchain::GetHeadlessTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mHeadlessStartTime).count();
+}
+
 } // namespace grfx
 } // namespace ppx
@@ -25,6 +25,92 @@
 namespace ppx {
 namespace grfx {
 
+namespace internal {
+
+// -------------------------------------------------------------------------------------------------
+// GlyphLookup
+// -------------------------------------------------------------------------------------------------
+void GlyphLookup::Build(const std::vector<grfx::TextureFontGlyphMetrics>& glyphs)
+{
+    mAsciiIndices.fill(kInvalidIndex);
+    mIndices.clear();
+    for (uint32_t i = 0; i < CountU32(glyphs); ++i) {
+        const uint32_t codepoint = glyphs[i].codepoint;
+        if (codepoint < kAsciiCount) {
+            if (mAsciiIndices[codepoint] == kInvalidIndex) {
+                mAsciiIndices[codepoint] = i;
+            }
+        }
+        else {
+            mIndices.emplace(codepoint, i);
+        }
+    }
+}
+
+uint32_t GlyphLookup::Find(uint32_t codepoint) const
+{
+    if (codepoint < kAsciiCount) {
+        return mAsciiIndices[codepoint];
+    }
+    auto it = mIndices.find(codepoint);
+    return (it != mIndices.end()) ? it->second : kInvalidIndex;
+}
+
+// -------------------------------------------------------------------------------------------------
+// TextLayoutCache
+// -------------------------------------------------------------------------------------------------
+uint64_t TextLayoutCache::Hash(const std::string& string, float tabSpacing, float lineSpacing)
+{
+    uint32_t tabBits  = 0;
+    uint32_t lineBits = 0;
+    std::memcpy(&tabBits, &tabSpacing, sizeof(tabSpacing));
+    std::memcpy(&lineBits, &lineSpacing, sizeof(lineSpacing));
+    const uint64_t seed = (static_cast<uint64_t>(tabBits) << 32) | static_cast<uint64_t>(lineBits);
+    return XXH64(string.data(), string.size(), seed);
+}
+
+TextLayoutCache::Layout* TextLayoutCache::Find(uint64_t hash, const std::string& string, float tabSpacing, float lineSpacing)
+{
+    auto it = mLayouts.find(hash);
+    if (it == mLayouts.end()) {
+        return nullptr;
+    }
+    Layout& layout = it->second;
+    if ((layout.string != string) || (layout.tabSpacing != tabSpacing) || (layout.lineSpacing != lineSpacing)) {
+        return nullptr;
+    }
+    layout.lastUsedFrame = mFrameIndex;
+    return &layout;
+}
+
+TextLayoutCache::Layout* TextLayoutCache::Insert(uint64_t hash, const std::string& string, float tabSpacing, float lineSpacing)
+{
+    if ((mLayouts.size() >= mMaxLayouts) || (mLayouts.find(hash) != mLayouts.end())) {
+        return nullptr;
+    }
+    Layout& layout       = mLayouts[hash];
+    layout.string        = string;
+    layout.tabSpacing    = tabSpacing;
+    layout.lineSpacing   = lineSpacing;
+    layout.lastUsedFrame = mFrameIndex;
+    return &layout;
+}
+
+void TextLayoutCache::NextFrame()
+{
+    mFrameIndex += 1;
+    for (auto it = mLayouts.begin(); it != mLayouts.end();) {
+        if ((it->second.lastUsedFrame + 1) < mFrameIndex) {
+            it = mLayouts.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+} // namespace internal
+
 // -------------------------------------------------------------------------------------------------
 // TextureFont
 // -------------------------------------------------------------------------------------------------
@@ -77,6 +163,8 @@ Result TextureFont::CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateI
         mGlyphMetrics.emplace_back(grfx::TextureFontGlyphMetrics{codepoint, metrics});
     }
 
+    mGlyphLookup.Build(mGlyphMetrics);
+
     // Figure out a squarish somewhat texture size
     const size_t  nc           = characters.size();
     const int32_t sqrtnc       = static_cast<int32_t>(sqrtf(static_cast<float>(nc)) + 0.5f) + 1;
@@ -155,16 +243,8 @@ void TextureFont::DestroyApiObjects()
 
 const grfx::TextureFontGlyphMetrics* TextureFont::GetGlyphMetrics(uint32_t codepoint) const
 {
-    const grfx::TextureFontGlyphMetrics* ptr = nullptr;
-    auto                                 it  = FindIf(
-        mGlyphMetrics,
-        [codepoint](const grfx::TextureFontGlyphMetrics& elem) -> bool {
-            bool match = (elem.codepoint == codepoint);
-            return match; });
-    if (it != std::end(mGlyphMetrics)) {
-        ptr = &(*it);
-    }
-    return ptr;
+    const uint32_t index = mGlyphLookup.Find(codepoint);
+    return (index != internal::GlyphLookup::kInvalidIndex) ? &mGlyphMetrics[index] : nullptr;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -189,6 +269,8 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
         return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
     }
 
+    mLayoutCache.SetMaxLayouts(pCreateInfo->maxCachedLayouts);
+
     // Index buffer
     {
         uint64_t size = pCreateInfo->maxTextLength * kGlyphIndicesSize;
@@ -205,6 +287,27 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
             return ppxres;
         }
 
+        // Indices only depend on the glyph's position in the buffer, so
+        // they're written once here instead of by every AddString()
+        void* mappedAddress = nullptr;
+        ppxres              = mCpuIndexBuffer->MapMemory(0, &mappedAddress);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed mapping CPU index buffer");
+            return ppxres;
+        }
+        uint32_t* pIndices = static_cast<uint32_t*>(mappedAddress);
+        for (uint32_t i = 0; i < pCreateInfo->maxTextLength; ++i) {
+            uint32_t vertexCount = i * 4;
+            pIndices[0]          = vertexCount + 0;
+            pIndices[1]          = vertexCount + 1;
+            pIndices[2]          = vertexCount + 2;
+            pIndices[3]          = vertexCount + 0;
+            pIndices[4]          = vertexCount + 2;
+            pIndices[5]          = vertexCount + 3;
+            pIndices += 6;
+        }
+        mCpuIndexBuffer->UnmapMemory();
+
         createInfo.usageFlags.bits.transferSrc = false;
         createInfo.usageFlags.bits.transferDst = true;
         createInfo.usageFlags.bits.indexBuffer = true;
@@ -403,6 +506,9 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
 
 void TextDraw::DestroyApiObjects()
 {
+    UnmapVertices();
+    mLayoutCache.Clear();
+
     if (mCpuIndexBuffer) {
         GetDevice()->DestroyBuffer(mCpuIndexBuffer);
         mCpuIndexBuffer.Reset();
@@ -462,45 +568,39 @@ void TextDraw::DestroyApiObjects()
 void TextDraw::Clear()
 {
     mTextLength = 0;
+
+    // Keep the layouts of strings that were drawn since the last Clear()
+    mLayoutCache.NextFrame();
 }
 
-void TextDraw::AddString(
-    const float2&      position,
-    const std::string& string,
-    float              tabSpacing,
-    float              lineSpacing,
-    const float3&      color,
-    float              opacity)
+void* TextDraw::MapVertices()
 {
-    if (mTextLength >= mCreateInfo.maxTextLength) {
-        return;
+    if (IsNull(mMappedVertices)) {
+        ppx::Result ppxres = mCpuVertexBuffer->MapMemory(0, &mMappedVertices);
+        if (Failed(ppxres)) {
+            mMappedVertices = nullptr;
+        }
     }
+    return mMappedVertices;
+}
 
-    // Map index buffer
-    void*       mappedAddress = nullptr;
-    ppx::Result ppxres        = mCpuIndexBuffer->MapMemory(0, &mappedAddress);
-    if (Failed(ppxres)) {
-        return;
+void TextDraw::UnmapVertices()
+{
+    if (!IsNull(mMappedVertices)) {
+        mCpuVertexBuffer->UnmapMemory();
+        mMappedVertices = nullptr;
     }
-    uint8_t* pIndicesBaseAddr = static_cast<uint8_t*>(mappedAddress);
+}
 
-    // Map vertex buffer
-    ppxres = mCpuVertexBuffer->MapMemory(0, &mappedAddress);
-    if (Failed(ppxres)) {
-        return;
-    }
-    uint8_t* pVerticesBaseAddr = static_cast<uint8_t*>(mappedAddress);
+void TextDraw::LayoutString(const std::string& string, float tabSpacing, float lineSpacing, Layout* pLayout) const
+{
+    pLayout->quads.clear();
 
-    // Convert to 8 bit color
-    uint32_t r    = std::min<uint32_t>(static_cast<uint32_t>(color.r * 255.0f), 255);
-    uint32_t g    = std::min<uint32_t>(static_cast<uint32_t>(color.g * 255.0f), 255);
-    uint32_t b    = std::min<uint32_t>(static_cast<uint32_t>(color.b * 255.0f), 255);
-    uint32_t a    = std::min<uint32_t>(static_cast<uint32_t>(opacity * 255.0f), 255);
-    uint32_t rgba = (a << 24) | (b << 16) | (g << 8) | (r << 0);
+    const grfx::TextureFontGlyphMetrics* pSpaceMetrics = mCreateInfo.pFont->GetGlyphMetrics(32);
 
     utf8::iterator<std::string::const_iterator> it(string.begin(), string.begin(), string.end());
     utf8::iterator<std::string::const_iterator> it_end(string.end(), string.begin(), string.end());
-    float2                                      baseline = position;
+    float2                                      baseline = float2(0, 0);
     float                                       ascent   = mCreateInfo.pFont->GetAscent();
     float                                       descent  = mCreateInfo.pFont->GetDescent();
     float                                       lineGap  = mCreateInfo.pFont->GetLineGap();
@@ -509,61 +609,101 @@ void TextDraw::AddString(
     while (it != it_end) {
         uint32_t codepoint = utf8::next(it, it_end);
         if (codepoint == '\n') {
-            baseline.x = position.x;
+            baseline.x = 0;
             baseline.y += lineSpacing;
             continue;
         }
         else if (codepoint == '\t') {
-            const grfx::TextureFontGlyphMetrics* pMetrics = mCreateInfo.pFont->GetGlyphMetrics(32);
-            baseline.x += tabSpacing * pMetrics->glyphMetrics.advance;
+            baseline.x += tabSpacing * pSpaceMetrics->glyphMetrics.advance;
             continue;
         }
 
         const grfx::TextureFontGlyphMetrics* pMetrics = mCreateInfo.pFont->GetGlyphMetrics(codepoint);
         if (IsNull(pMetrics)) {
-            pMetrics = mCreateInfo.pFont->GetGlyphMetrics(32);
+            pMetrics = pSpaceMetrics;
         }
 
-        size_t indexBufferOffset    = mTextLength * kGlyphIndicesSize;
-        size_t vertexBufferOffset   = mTextLength * kGlyphVerticesSize;
-        bool   exceededIndexBuffer  = (indexBufferOffset >= mCpuIndexBuffer->GetSize());
-        bool   exceededVertexBuffer = (vertexBufferOffset >= mCpuVertexBuffer->GetSize());
-        if (exceededIndexBuffer || exceededVertexBuffer) {
+        LayoutQuad quad = {};
+        quad.position   = baseline + float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0);
+        quad.size       = pMetrics->size;
+        quad.uvRect     = pMetrics->uvRect;
+        pLayout->quads.push_back(quad);
+
+        baseline.x += pMetrics->glyphMetrics.advance;
+    }
+}
+
+const TextDraw::Layout* TextDraw::GetLayout(const std::string& string, float tabSpacing, float lineSpacing)
+{
+    const uint64_t hash = internal::TextLayoutCache::Hash(string, tabSpacing, lineSpacing);
+
+    Layout* pLayout = mLayoutCache.Find(hash, string, tabSpacing, lineSpacing);
+    if (!IsNull(pLayout)) {
+        return pLayout;
+    }
+
+    // Strings that don't fit in the cache are laid out every time
+    pLayout = mLayoutCache.Insert(hash, string, tabSpacing, lineSpacing);
+    if (IsNull(pLayout)) {
+        pLayout = &mScratchLayout;
+    }
+    LayoutString(string, tabSpacing, lineSpacing, pLayout);
+    return pLayout;
+}
+
+void TextDraw::WriteString(const float2& position, const Layout& layout, const float3& color, float opacity)
+{
+    // Convert to 8 bit color
+    uint32_t r    = std::min<uint32_t>(static_cast<uint32_t>(color.r * 255.0f), 255);
+    uint32_t g    = std::min<uint32_t>(static_cast<uint32_t>(color.g * 255.0f), 255);
+    uint32_t b    = std::min<uint32_t>(static_cast<uint32_t>(color.b * 255.0f), 255);
+    uint32_t a    = std::min<uint32_t>(static_cast<uint32_t>(opacity * 255.0f), 255);
+    uint32_t rgba = (a << 24) | (b << 16) | (g << 8) | (r << 0);
+
+    Vertex* pVertices = static_cast<Vertex*>(mMappedVertices) + (mTextLength * 4);
+    for (const LayoutQuad& quad : layout.quads) {
+        if (mTextLength >= mCreateInfo.maxTextLength) {
             break;
         }
 
-        uint32_t* pIndices  = reinterpret_cast<uint32_t*>(pIndicesBaseAddr + indexBufferOffset);
-        Vertex*   pVertices = reinterpret_cast<Vertex*>(pVerticesBaseAddr + vertexBufferOffset);
-
-        float2 P   = baseline + float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0);
+        float2 P   = position + quad.position;
         float2 P0  = P;
-        float2 P1  = P + float2(0, pMetrics->size.y);
-        float2 P2  = P + pMetrics->size;
-        float2 P3  = P + float2(pMetrics->size.x, 0);
-        float2 uv0 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v0);
-        float2 uv1 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v1);
-        float2 uv2 = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v1);
-        float2 uv3 = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v0);
+        float2 P1  = P + float2(0, quad.size.y);
+        float2 P2  = P + quad.size;
+        float2 P3  = P + float2(quad.size.x, 0);
+        float2 uv0 = float2(quad.uvRect.u0, quad.uvRect.v0);
+        float2 uv1 = float2(quad.uvRect.u0, quad.uvRect.v1);
+        float2 uv2 = float2(quad.uvRect.u1, quad.uvRect.v1);
+        float2 uv3 = float2(quad.uvRect.u1, quad.uvRect.v0);
 
         pVertices[0] = Vertex{P0, uv0, rgba};
         pVertices[1] = Vertex{P1, uv1, rgba};
         pVertices[2] = Vertex{P2, uv2, rgba};
         pVertices[3] = Vertex{P3, uv3, rgba};
 
-        uint32_t vertexCount = mTextLength * 4;
-        pIndices[0]          = vertexCount + 0;
-        pIndices[1]          = vertexCount + 1;
-        pIndices[2]          = vertexCount + 2;
-        pIndices[3]          = vertexCount + 0;
-        pIndices[4]          = vertexCount + 2;
-        pIndices[5]          = vertexCount + 3;
-
         mTextLength += 1;
-        baseline.x += pMetrics->glyphMetrics.advance;
+        pVertices += 4;
+    }
+}
+
+void TextDraw::AddString(
+    const float2&      position,
+    const std::string& string,
+    float              tabSpacing,
+    float              lineSpacing,
+    const float3&      color,
+    float              opacity)
+{
+    if (mTextLength >= mCreateInfo.maxTextLength) {
+        return;
+    }
+
+    if (IsNull(MapVertices())) {
+        return;
     }
 
-    mCpuIndexBuffer->UnmapMemory();
-    mCpuVertexBuffer->UnmapMemory();
+    const Layout* pLayout = GetLayout(string, tabSpacing, lineSpacing);
+    WriteString(position, *pLayout, color, opacity);
 }
 
 void TextDraw::AddString(
@@ -575,8 +715,25 @@ void TextDraw::AddString(
     AddString(position, string, 3.0f, 1.0f, color, opacity);
 }
 
+void TextDraw::AddStrings(const std::vector<grfx::TextDrawString>& strings)
+{
+    if (IsNull(MapVertices())) {
+        return;
+    }
+
+    for (const grfx::TextDrawString& elem : strings) {
+        if (mTextLength >= mCreateInfo.maxTextLength) {
+            break;
+        }
+        const Layout* pLayout = GetLayout(elem.string, elem.tabSpacing, elem.lineSpacing);
+        WriteString(elem.position, *pLayout, elem.color, elem.opacity);
+    }
+}
+
 ppx::Result TextDraw::UploadToGpu(grfx::Queue* pQueue)
 {
+    UnmapVertices();
+
     grfx::BufferToBufferCopyInfo copyInfo = {};
     copyInfo.size                         = mCpuIndexBuffer->GetSize();
     copyInfo.srcBuffer.offset             = 0;
@@ -587,6 +744,8 @@ ppx::Result TextDraw::UploadToGpu(grfx::Queue* pQueue)
         return ppxres;
     }
 
+    mUploadedGlyphCount = mCreateInfo.maxTextLength;
+
     copyInfo.size = mCpuVertexBuffer->GetSize();
     ppxres        = pQueue->CopyBufferToBuffer(&copyInfo, mCpuVertexBuffer, mGpuVertexBuffer, grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_VERTEX_BUFFER);
     if (Failed(ppxres)) {
@@ -598,16 +757,26 @@ ppx::Result TextDraw::UploadToGpu(grfx::Queue* pQueue)
 
 void TextDraw::UploadToGpu(grfx::CommandBuffer* pCommandBuffer)
 {
+    UnmapVertices();
+
     grfx::BufferToBufferCopyInfo copyInfo = {};
-    copyInfo.size                         = mTextLength * kGlyphIndicesSize;
-    copyInfo.srcBuffer.offset             = 0;
-    copyInfo.dstBuffer.offset             = 0;
 
-    pCommandBuffer->BufferResourceBarrier(mGpuIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
-    pCommandBuffer->CopyBufferToBuffer(&copyInfo, mCpuIndexBuffer, mGpuIndexBuffer);
-    pCommandBuffer->BufferResourceBarrier(mGpuIndexBuffer, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_INDEX_BUFFER);
+    // Indices never change, only copy the ones that haven't been copied
+    if (mTextLength > mUploadedGlyphCount) {
+        copyInfo.size             = (mTextLength - mUploadedGlyphCount) * kGlyphIndicesSize;
+        copyInfo.srcBuffer.offset = mUploadedGlyphCount * kGlyphIndicesSize;
+        copyInfo.dstBuffer.offset = mUploadedGlyphCount * kGlyphIndicesSize;
+
+        pCommandBuffer->BufferResourceBarrier(mGpuIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
+        pCommandBuffer->CopyBufferToBuffer(&copyInfo, mCpuIndexBuffer, mGpuIndexBuffer);
+        pCommandBuffer->BufferResourceBarrier(mGpuIndexBuffer, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_INDEX_BUFFER);
+
+        mUploadedGlyphCount = mTextLength;
+    }
 
-    copyInfo.size = mTextLength * kGlyphVerticesSize;
+    copyInfo.size             = mTextLength * kGlyphVerticesSize;
+    copyInfo.srcBuffer.offset = 0;
+    copyInfo.dstBuffer.offset = 0;
     pCommandBuffer->BufferResourceBarrier(mGpuVertexBuffer, grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
     pCommandBuffer->CopyBufferToBuffer(&copyInfo, mCpuVertexBuffer, mGpuVertexBuffer);
     pCommandBuffer->BufferResourceBarrier(mGpuVertexBuffer, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_VERTEX_BUFFER);
@@ -92,6 +92,8 @@ Result Texture::CreateApiObjects(const grfx::TextureCreateInfo* pCreateInfo)
         }
     }
 
+    mImageRegistryHandle = mImage->GetRegistryHandle();
+
     if (pCreateInfo->usageFlags.bits.sampled) {
         grfx::SampledImageViewCreateInfo ci = grfx::SampledImageViewCreateInfo::GuessFromImage(mImage);
         if (pCreateInfo->sampledImageViewType != grfx::IMAGE_VIEW_TYPE_UNDEFINED) {
@@ -169,6 +171,12 @@ void Texture::DestroyApiObjects()
         mStorageImageView.Reset();
     }
 
+    // A supplied image can be destroyed before the texture, e.g. swapchain
+    // images on resize, so don't look at it once the device has let it go.
+    if (mImage && !GetDevice()->HasImage(mImageRegistryHandle)) {
+        mImage.Reset();
+    }
+
     if (mImage && (mImage->GetOwnership() != grfx::OWNERSHIP_REFERENCE)) {
         GetDevice()->DestroyImage(mImage);
         mImage.Reset();
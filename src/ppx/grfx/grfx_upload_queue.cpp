@@ -0,0 +1,405 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_upload_queue.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_sync.h"
+#include "ppx/profiler.h"
+
+#include <cstring>
+
+namespace ppx {
+namespace grfx {
+
+static ProfilerEventToken sUploadToBufferEventToken = 0;
+static ProfilerEventToken sFlushEventToken          = 0;
+static ProfilerEventToken sWaitEventToken           = 0;
+
+namespace internal {
+
+void RegisterUploadQueueProfilerEvents()
+{
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("UploadQueue::UploadToBuffer", &sUploadToBufferEventToken));
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("UploadQueue::Flush", &sFlushEventToken));
+    PPX_CHECKED_CALL(Profiler::RegisterCpuEvent("UploadQueue::Wait", &sWaitEventToken));
+}
+
+} // namespace internal
+
+Result UploadQueue::CreateApiObjects(const grfx::UploadQueueCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(pCreateInfo->pQueue);
+
+    if (pCreateInfo->batchCount == 0) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    mStagingRing = pCreateInfo->pStagingRing;
+    if (IsNull(mStagingRing)) {
+        Result ppxres = GetDevice()->GetStagingRing(&mStagingRing);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    // Batches
+    mBatches.resize(pCreateInfo->batchCount);
+    for (auto& batch : mBatches) {
+        Result ppxres = pCreateInfo->pQueue->CreateCommandBuffer(&batch.commandBuffer, 0, 0);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating upload command buffer");
+            return ppxres;
+        }
+
+        grfx::FenceCreateInfo fenceCreateInfo = {};
+        ppxres                                = GetDevice()->CreateFence(&fenceCreateInfo, &batch.fence);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating upload fence");
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void UploadQueue::DestroyApiObjects()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Don't drop copies that were recorded but never flushed
+    if (!mBatches.empty()) {
+        FlushLocked(nullptr);
+        WaitLocked(mSubmittedTicket);
+    }
+
+    for (auto& batch : mBatches) {
+        if (batch.fence) {
+            GetDevice()->DestroyFence(batch.fence);
+            batch.fence.Reset();
+        }
+        if (batch.commandBuffer) {
+            GetQueue()->DestroyCommandBuffer(batch.commandBuffer);
+            batch.commandBuffer.Reset();
+        }
+    }
+    mBatches.clear();
+}
+
+Result UploadQueue::BeginBatch()
+{
+    Batch& batch = mBatches[mCurrentBatch];
+    if (batch.recording) {
+        return ppx::SUCCESS;
+    }
+
+    // Slots are used round robin, so an in flight batch in this slot is
+    // the oldest one.
+    if (batch.ticket != 0) {
+        Result ppxres = batch.fence->Wait();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        RetireBatch(batch);
+    }
+
+    Result ppxres = batch.commandBuffer->Begin();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    batch.ticket    = mNextTicket++;
+    batch.recording = true;
+
+    return ppx::SUCCESS;
+}
+
+void UploadQueue::RetireBatch(Batch& batch)
+{
+    // No-op for allocations the ring already released on the fence
+    for (auto& allocation : batch.allocations) {
+        mStagingRing->Free(allocation);
+    }
+    batch.allocations.clear();
+
+    batch.fence->Reset();
+
+    mCompletedTicket = batch.ticket;
+    batch.ticket     = 0;
+}
+
+void UploadQueue::RetireCompletedBatches()
+{
+    // Slots are submitted round robin starting at mCurrentBatch and complete
+    // in submission order, so stop at the first one that's still running.
+    for (uint32_t i = 0; i < CountU32(mBatches); ++i) {
+        Batch& batch = mBatches[(mCurrentBatch + i) % CountU32(mBatches)];
+        if ((batch.ticket == 0) || batch.recording) {
+            continue;
+        }
+        if (batch.fence->Wait(0) != ppx::SUCCESS) {
+            break;
+        }
+        RetireBatch(batch);
+    }
+}
+
+Result UploadQueue::WaitOldestBatch()
+{
+    for (uint32_t i = 0; i < CountU32(mBatches); ++i) {
+        Batch& batch = mBatches[(mCurrentBatch + i) % CountU32(mBatches)];
+        if ((batch.ticket == 0) || batch.recording) {
+            continue;
+        }
+        Result ppxres = batch.fence->Wait();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        RetireBatch(batch);
+        return ppx::SUCCESS;
+    }
+    return ppx::ERROR_ELEMENT_NOT_FOUND;
+}
+
+Result UploadQueue::AllocateStaging(uint64_t size, uint64_t alignment, grfx::StagingAllocation* pAllocation)
+{
+    PPX_ASSERT_NULL_ARG(pAllocation);
+
+    // Not tied to a batch yet, see AddAllocation()
+    return mStagingRing->Allocate(size, alignment, pAllocation);
+}
+
+void UploadQueue::FreeStaging(const grfx::StagingAllocation& allocation)
+{
+    mStagingRing->Free(allocation);
+}
+
+void UploadQueue::AddAllocation(const grfx::StagingAllocation& allocation)
+{
+    // Allocations are retired with the fence of the batch they're flushed
+    // with, so every copy from an allocation must be recorded in that batch
+    auto isSame = [&allocation](const grfx::StagingAllocation& elem) -> bool { return elem.id == allocation.id; };
+    for (auto& batch : mBatches) {
+        PPX_ASSERT_MSG(batch.recording || (FindIf(batch.allocations, isSame) == batch.allocations.end()), "staging allocation copied from after its batch was flushed");
+    }
+
+    std::vector<grfx::StagingAllocation>& allocations = mBatches[mCurrentBatch].allocations;
+    if (FindIf(allocations, isSame) == allocations.end()) {
+        allocations.push_back(allocation);
+    }
+}
+
+Result UploadQueue::CopyBufferToBuffer(
+    const grfx::BufferToBufferCopyInfo* pCopyInfo,
+    const grfx::StagingAllocation&      staging,
+    grfx::Buffer*                       pDstBuffer,
+    grfx::ResourceState                 stateBefore,
+    grfx::ResourceState                 stateAfter)
+{
+    PPX_ASSERT_NULL_ARG(pCopyInfo);
+    PPX_ASSERT_NULL_ARG(staging.pBuffer);
+    PPX_ASSERT_NULL_ARG(pDstBuffer);
+
+    // The lock is held from BeginBatch() until the batch owns staging, so
+    // the batch that records the copy is the batch that releases it.
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Result ppxres = BeginBatch();
+    if (Failed(ppxres)) {
+        mStagingRing->Free(staging);
+        return ppxres;
+    }
+
+    grfx::CommandBuffer* pCmd = mBatches[mCurrentBatch].commandBuffer;
+    pCmd->BufferResourceBarrier(pDstBuffer, stateBefore, grfx::RESOURCE_STATE_COPY_DST);
+    pCmd->CopyBufferToBuffer(pCopyInfo, staging.pBuffer, pDstBuffer);
+    pCmd->BufferResourceBarrier(pDstBuffer, grfx::RESOURCE_STATE_COPY_DST, stateAfter);
+    AddAllocation(staging);
+
+    return ppx::SUCCESS;
+}
+
+Result UploadQueue::CopyBufferToImage(
+    const std::vector<grfx::BufferToImageCopyInfo>& copyInfos,
+    const grfx::StagingAllocation&                  staging,
+    grfx::Image*                                    pDstImage,
+    uint32_t                                        mipLevel,
+    uint32_t                                        mipLevelCount,
+    uint32_t                                        arrayLayer,
+    uint32_t                                        arrayLayerCount,
+    grfx::ResourceState                             stateBefore,
+    grfx::ResourceState                             stateAfter)
+{
+    PPX_ASSERT_NULL_ARG(staging.pBuffer);
+    PPX_ASSERT_NULL_ARG(pDstImage);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Result ppxres = BeginBatch();
+    if (Failed(ppxres)) {
+        mStagingRing->Free(staging);
+        return ppxres;
+    }
+
+    // Only the copied subresources are transitioned so that several copies
+    // into the same image can share a batch.
+    grfx::CommandBuffer* pCmd = mBatches[mCurrentBatch].commandBuffer;
+    pCmd->TransitionImageLayout(pDstImage, mipLevel, mipLevelCount, arrayLayer, arrayLayerCount, stateBefore, grfx::RESOURCE_STATE_COPY_DST);
+    pCmd->CopyBufferToImage(copyInfos, staging.pBuffer, pDstImage);
+    pCmd->TransitionImageLayout(pDstImage, mipLevel, mipLevelCount, arrayLayer, arrayLayerCount, grfx::RESOURCE_STATE_COPY_DST, stateAfter);
+    AddAllocation(staging);
+
+    return ppx::SUCCESS;
+}
+
+Result UploadQueue::UploadToBuffer(
+    uint64_t            size,
+    const void*         pData,
+    grfx::Buffer*       pDstBuffer,
+    uint64_t            dstOffset,
+    grfx::ResourceState stateBefore,
+    grfx::ResourceState stateAfter)
+{
+    PPX_ASSERT_NULL_ARG(pData);
+    PPX_ASSERT_NULL_ARG(pDstBuffer);
+
+    ProfilerScopedEventSample sample(sUploadToBufferEventToken);
+
+    if (size == 0) {
+        return ppx::SUCCESS;
+    }
+
+    grfx::StagingAllocation allocation = {};
+    Result                  ppxres     = AllocateStaging(size, 4, &allocation);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    std::memcpy(allocation.pMappedAddress, pData, static_cast<size_t>(size));
+
+    grfx::BufferToBufferCopyInfo copyInfo = {};
+    copyInfo.size                         = size;
+    copyInfo.srcBuffer.offset             = allocation.offset;
+    copyInfo.dstBuffer.offset             = dstOffset;
+
+    return CopyBufferToBuffer(&copyInfo, allocation, pDstBuffer, stateBefore, stateAfter);
+}
+
+Result UploadQueue::FlushLocked(grfx::UploadTicket* pTicket)
+{
+    Batch& batch = mBatches[mCurrentBatch];
+    if (!batch.recording) {
+        if (!IsNull(pTicket)) {
+            *pTicket = mSubmittedTicket;
+        }
+        return ppx::SUCCESS;
+    }
+
+    Result ppxres = batch.commandBuffer->End();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    batch.recording = false;
+
+    grfx::SubmitInfo submit   = {};
+    submit.commandBufferCount = 1;
+    submit.ppCommandBuffers   = &batch.commandBuffer;
+    submit.pFence             = batch.fence;
+
+    ppxres = GetQueue()->Submit(&submit);
+    if (Failed(ppxres)) {
+        // Nothing was submitted so the fence is never signaled. Drop the
+        // batch instead of leaving the slot in flight, otherwise the next
+        // BeginBatch() on it waits forever.
+        for (auto& allocation : batch.allocations) {
+            mStagingRing->Free(allocation);
+        }
+        batch.allocations.clear();
+        batch.ticket = 0;
+        return ppxres;
+    }
+
+    // Lets the ring wait on the batch instead of growing past maxSize.
+    // RetireBatch() still frees the allocations before the fence is reset.
+    for (auto& allocation : batch.allocations) {
+        mStagingRing->Retire(allocation, batch.fence);
+    }
+
+    mSubmittedTicket = batch.ticket;
+    mCurrentBatch    = (mCurrentBatch + 1) % CountU32(mBatches);
+
+    if (!IsNull(pTicket)) {
+        *pTicket = mSubmittedTicket;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result UploadQueue::Flush(grfx::UploadTicket* pTicket)
+{
+    ProfilerScopedEventSample   sample(sFlushEventToken);
+    std::lock_guard<std::mutex> lock(mMutex);
+    return FlushLocked(pTicket);
+}
+
+bool UploadQueue::IsComplete(grfx::UploadTicket ticket)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (ticket > mCompletedTicket) {
+        RetireCompletedBatches();
+    }
+    return (ticket <= mCompletedTicket);
+}
+
+Result UploadQueue::WaitLocked(grfx::UploadTicket ticket)
+{
+    if (ticket > mSubmittedTicket) {
+        Result ppxres = FlushLocked(nullptr);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    while (ticket > mCompletedTicket) {
+        Result ppxres = WaitOldestBatch();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result UploadQueue::Wait(grfx::UploadTicket ticket)
+{
+    ProfilerScopedEventSample   sample(sWaitEventToken);
+    std::lock_guard<std::mutex> lock(mMutex);
+    return WaitLocked(ticket);
+}
+
+Result UploadQueue::WaitIdle()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Result ppxres = FlushLocked(nullptr);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return WaitLocked(mSubmittedTicket);
+}
+
+} // namespace grfx
+} // namespace ppx
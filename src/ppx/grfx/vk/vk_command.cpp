@@ -35,7 +35,7 @@ Result CommandBuffer::CreateApiObjects(const grfx::internal::CommandBufferCreate
 {
     VkCommandBufferAllocateInfo vkai = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
     vkai.commandPool                 = ToApi(pCreateInfo->pPool)->GetVkCommandPool();
-    vkai.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    vkai.level                       = (pCreateInfo->level == grfx::COMMAND_BUFFER_LEVEL_SECONDARY) ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     vkai.commandBufferCount          = 1;
 
     VkResult vkres = vk::AllocateCommandBuffers(
@@ -65,6 +65,11 @@ void CommandBuffer::DestroyApiObjects()
 
 Result CommandBuffer::Begin()
 {
+    // Secondary command buffers always need inheritance info
+    if (IsSecondary()) {
+        return BeginSecondary(nullptr);
+    }
+
     VkCommandBufferBeginInfo vkbi = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
 
     VkResult vkres = vk::BeginCommandBuffer(mCommandBuffer, &vkbi);
@@ -76,6 +81,29 @@ Result CommandBuffer::Begin()
     return ppx::SUCCESS;
 }
 
+Result CommandBuffer::BeginSecondaryImpl(const grfx::RenderPass* pRenderPass)
+{
+    VkCommandBufferInheritanceInfo vkii = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+
+    VkCommandBufferBeginInfo vkbi = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    vkbi.pInheritanceInfo         = &vkii;
+
+    if (!IsNull(pRenderPass)) {
+        vkii.renderPass  = ToApi(pRenderPass)->GetVkRenderPass();
+        vkii.subpass     = 0;
+        vkii.framebuffer = ToApi(pRenderPass)->GetVkFramebuffer();
+        vkbi.flags       = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    }
+
+    VkResult vkres = vk::BeginCommandBuffer(mCommandBuffer, &vkbi);
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkBeginCommandBuffer failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
 Result CommandBuffer::End()
 {
     VkResult vkres = vk::EndCommandBuffer(mCommandBuffer);
@@ -114,7 +142,9 @@ void CommandBuffer::BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginI
     vkbi.clearValueCount       = clearValueCount;
     vkbi.pClearValues          = clearValues;
 
-    vk::CmdBeginRenderPass(mCommandBuffer, &vkbi, VK_SUBPASS_CONTENTS_INLINE);
+    VkSubpassContents contents = (pBeginInfo->contents == grfx::RENDER_PASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+
+    vk::CmdBeginRenderPass(mCommandBuffer, &vkbi, contents);
 }
 
 void CommandBuffer::EndRenderPassImpl()
@@ -122,6 +152,16 @@ void CommandBuffer::EndRenderPassImpl()
     vk::CmdEndRenderPass(mCommandBuffer);
 }
 
+void CommandBuffer::ExecuteCommandsImpl(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers)
+{
+    std::vector<VkCommandBuffer> vkCommandBuffers(commandBufferCount);
+    for (uint32_t i = 0; i < commandBufferCount; ++i) {
+        vkCommandBuffers[i] = ToApi(ppCommandBuffers[i])->GetVkCommandBuffer();
+    }
+
+    vkCmdExecuteCommands(mCommandBuffer, commandBufferCount, vkCommandBuffers.data());
+}
+
 void CommandBuffer::BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo)
 {
     vk::Device* pDevice = ToApi(GetDevice());
@@ -567,6 +607,99 @@ void CommandBuffer::BufferResourceBarrier(
         nullptr);        // pImageMemoryBarriers);
 }
 
+void CommandBuffer::ImageMemoryBarrier(
+    const grfx::Image*  pImage,
+    grfx::ResourceState state)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    VkPipelineStageFlags srcStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkPipelineStageFlags dstStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkAccessFlags        srcAccessMask = InvalidValue<VkAccessFlags>();
+    VkAccessFlags        dstAccessMask = InvalidValue<VkAccessFlags>();
+    VkImageLayout        oldLayout     = InvalidValue<VkImageLayout>();
+    VkImageLayout        newLayout     = InvalidValue<VkImageLayout>();
+
+    vk::Device*       pDevice     = ToApi(GetDevice());
+    grfx::CommandType commandType = GetCommandType();
+
+    Result ppxres = ToVkBarrierSrc(state, commandType, pDevice->GetDeviceFeatures(), srcStageMask, srcAccessMask, oldLayout);
+    PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get src barrier data");
+    ppxres = ToVkBarrierDst(state, commandType, pDevice->GetDeviceFeatures(), dstStageMask, dstAccessMask, newLayout);
+    PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get dst barrier data");
+
+    const vk::Image* pApiImage = ToApi(pImage);
+
+    VkImageMemoryBarrier barrier            = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask                   = srcAccessMask;
+    barrier.dstAccessMask                   = dstAccessMask;
+    barrier.oldLayout                       = oldLayout;
+    barrier.newLayout                       = newLayout;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = pApiImage->GetVkImage();
+    barrier.subresourceRange.aspectMask     = pApiImage->GetVkImageAspectFlags();
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = pImage->GetMipLevelCount();
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = pImage->GetArrayLayerCount();
+
+    vk::CmdPipelineBarrier(
+        mCommandBuffer, // commandBuffer
+        srcStageMask,   // srcStageMask
+        dstStageMask,   // dstStageMask
+        0,              // dependencyFlags
+        0,              // memoryBarrierCount
+        nullptr,        // pMemoryBarriers
+        0,              // bufferMemoryBarrierCount
+        nullptr,        // pBufferMemoryBarriers
+        1,              // imageMemoryBarrierCount
+        &barrier);      // pImageMemoryBarriers
+}
+
+void CommandBuffer::BufferMemoryBarrier(
+    const grfx::Buffer* pBuffer,
+    grfx::ResourceState state)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    VkPipelineStageFlags srcStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkPipelineStageFlags dstStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkAccessFlags        srcAccessMask = InvalidValue<VkAccessFlags>();
+    VkAccessFlags        dstAccessMask = InvalidValue<VkAccessFlags>();
+    VkImageLayout        oldLayout     = InvalidValue<VkImageLayout>();
+    VkImageLayout        newLayout     = InvalidValue<VkImageLayout>();
+
+    vk::Device*       pDevice     = ToApi(GetDevice());
+    grfx::CommandType commandType = GetCommandType();
+
+    Result ppxres = ToVkBarrierSrc(state, commandType, pDevice->GetDeviceFeatures(), srcStageMask, srcAccessMask, oldLayout);
+    PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get src barrier data");
+    ppxres = ToVkBarrierDst(state, commandType, pDevice->GetDeviceFeatures(), dstStageMask, dstAccessMask, newLayout);
+    PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get dst barrier data");
+
+    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.srcAccessMask         = srcAccessMask;
+    barrier.dstAccessMask         = dstAccessMask;
+    barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer                = ToApi(pBuffer)->GetVkBuffer();
+    barrier.offset                = static_cast<VkDeviceSize>(0);
+    barrier.size                  = static_cast<VkDeviceSize>(pBuffer->GetSize());
+
+    vkCmdPipelineBarrier(
+        mCommandBuffer, // commandBuffer
+        srcStageMask,   // srcStageMask
+        dstStageMask,   // dstStageMask
+        0,              // dependencyFlags
+        0,              // memoryBarrierCount
+        nullptr,        // pMemoryBarriers
+        1,              // bufferMemoryBarrierCount
+        &barrier,       // pBufferMemoryBarriers
+        0,              // imageMemoryBarrierCount
+        nullptr);       // pImageMemoryBarriers
+}
+
 void CommandBuffer::SetViewports(uint32_t viewportCount, const grfx::Viewport* pViewports)
 {
     VkViewport viewports[PPX_MAX_VIEWPORTS] = {};
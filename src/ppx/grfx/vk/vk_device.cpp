@@ -28,10 +28,12 @@
 #include "ppx/grfx/vk/vk_swapchain.h"
 #include "ppx/grfx/vk/vk_sync.h"
 #include "ppx/grfx/vk/vk_profiler_fn_wrapper.h"
+#include "ppx/fs.h"
 
 #define VMA_IMPLEMENTATION
 #define VMA_VULKAN_VERSION 1002000 // Vulkan 1.2
 #include "vk_mem_alloc.h"
+#include <fstream>
 #include <unordered_set>
 
 namespace ppx {
@@ -693,6 +695,12 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
         }
     }
 
+    // Pipeline cache
+    ppxres = CreatePipelineCache(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
     // Create queues
     ppxres = CreateQueues(pCreateInfo);
     if (Failed(ppxres)) {
@@ -702,8 +710,88 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
     return ppx::SUCCESS;
 }
 
+Result Device::CreatePipelineCache(const grfx::DeviceCreateInfo* pCreateInfo)
+{
+    std::vector<char> initialData;
+    if (!pCreateInfo->pipelineCachePath.empty() && fs::path_exists(pCreateInfo->pipelineCachePath)) {
+        auto data = fs::load_file(pCreateInfo->pipelineCachePath);
+        if (data.has_value()) {
+            initialData = std::move(data.value());
+        }
+    }
+
+    VkPipelineCacheCreateInfo vkci = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    vkci.initialDataSize           = initialData.size();
+    vkci.pInitialData              = DataPtr(initialData);
+
+    VkResult vkres = vkCreatePipelineCache(mDevice, &vkci, nullptr, &mPipelineCache);
+    if ((vkres != VK_SUCCESS) && !initialData.empty()) {
+        // Drivers should ignore data from another driver or device, but
+        // start over with an empty cache if this one doesn't.
+        PPX_LOG_WARN("ignoring pipeline cache data from " << pCreateInfo->pipelineCachePath);
+        vkci.initialDataSize = 0;
+        vkci.pInitialData    = nullptr;
+        vkres                = vkCreatePipelineCache(mDevice, &vkci, nullptr, &mPipelineCache);
+    }
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkCreatePipelineCache failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    if (!initialData.empty()) {
+        PPX_LOG_INFO("Loaded pipeline cache: " << pCreateInfo->pipelineCachePath << " (" << initialData.size() << " bytes)");
+    }
+
+    return ppx::SUCCESS;
+}
+
+void Device::DestroyPipelineCache()
+{
+    if (!mPipelineCache) {
+        return;
+    }
+
+    const std::filesystem::path& path = mCreateInfo.pipelineCachePath;
+    if (!path.empty()) {
+        size_t   dataSize = 0;
+        VkResult vkres    = vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, nullptr);
+
+        std::vector<char> data(dataSize);
+        if ((vkres == VK_SUCCESS) && (dataSize > 0)) {
+            vkres = vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, DataPtr(data));
+        }
+
+        if ((vkres == VK_SUCCESS) && (dataSize > 0)) {
+            // Write to a temporary file and rename it so an interrupted
+            // write never leaves a truncated cache behind.
+            std::error_code             ec;
+            const std::filesystem::path tmpPath = std::filesystem::path(path).concat(".tmp");
+            if (path.has_parent_path()) {
+                std::filesystem::create_directories(path.parent_path(), ec);
+            }
+
+            std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+            os.write(data.data(), static_cast<std::streamsize>(dataSize));
+            os.close();
+
+            if (os.good()) {
+                std::filesystem::rename(tmpPath, path, ec);
+            }
+            if (!os.good() || ec) {
+                PPX_LOG_WARN("failed writing pipeline cache: " << path);
+                std::filesystem::remove(tmpPath, ec);
+            }
+        }
+    }
+
+    vkDestroyPipelineCache(mDevice, mPipelineCache, nullptr);
+    mPipelineCache.Reset();
+}
+
 void Device::DestroyApiObjects()
 {
+    DestroyPipelineCache();
+
     if (mVmaAllocator) {
         vmaDestroyAllocator(mVmaAllocator);
         mVmaAllocator.Reset();
@@ -952,6 +1040,15 @@ Result Device::AllocateObject(grfx::Swapchain** ppObject)
 
 Result Device::WaitIdle()
 {
+    for (const auto* pQueues : {&mGraphicsQueues, &mComputeQueues, &mTransferQueues}) {
+        for (const auto& queue : *pQueues) {
+            Result ppxres = ToApi(queue)->SubmitDeferredWaits();
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+        }
+    }
+
     VkResult vkres = vkDeviceWaitIdle(mDevice);
     if (vkres != VK_SUCCESS) {
         return ppx::ERROR_API_FAILURE;
@@ -44,7 +44,7 @@ Result ComputePipeline::CreateApiObjects(const grfx::ComputePipelineCreateInfo*
 
     VkResult vkres = vkCreateComputePipelines(
         ToApi(GetDevice())->GetVkDevice(),
-        VK_NULL_HANDLE,
+        ToApi(GetDevice())->GetVkPipelineCache(),
         1,
         &vkci,
         nullptr,
@@ -533,7 +533,7 @@ Result GraphicsPipeline::CreateApiObjects(const grfx::GraphicsPipelineCreateInfo
 
     VkResult vkres = vkCreateGraphicsPipelines(
         ToApi(GetDevice())->GetVkDevice(),
-        VK_NULL_HANDLE,
+        ToApi(GetDevice())->GetVkPipelineCache(),
         1,
         &vkci,
         nullptr,
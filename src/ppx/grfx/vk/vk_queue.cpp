@@ -66,8 +66,40 @@ void Queue::DestroyApiObjects()
     }
 }
 
+Result Queue::SubmitDeferredWaits()
+{
+    std::vector<VkSemaphore> deferredWaitSemaphores;
+    {
+        std::lock_guard<std::mutex> lock(mDeferredWaitMutex);
+        deferredWaitSemaphores.swap(mDeferredWaitSemaphores);
+    }
+    if (!deferredWaitSemaphores.empty()) {
+        std::vector<VkPipelineStageFlags> waitDstStageMasks(deferredWaitSemaphores.size(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        VkSubmitInfo vksi       = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        vksi.waitSemaphoreCount = CountU32(deferredWaitSemaphores);
+        vksi.pWaitSemaphores    = DataPtr(deferredWaitSemaphores);
+        vksi.pWaitDstStageMask  = DataPtr(waitDstStageMasks);
+
+        VkResult vkres = vk::QueueSubmit(mQueue, 1, &vksi, VK_NULL_HANDLE);
+        if (vkres != VK_SUCCESS) {
+            PPX_ASSERT_MSG(false, "vkQueueSubmit failed" << ToString(vkres));
+            return ppx::ERROR_API_FAILURE;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
 Result Queue::WaitIdle()
 {
+    // Leave no semaphore signaled behind, the application may signal it
+    // again or destroy it after waiting for idle
+    Result ppxres = SubmitDeferredWaits();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
     VkResult vkres = vkQueueWaitIdle(mQueue);
     if (vkres != VK_SUCCESS) {
         PPX_ASSERT_MSG(false, "vkQueueWaitIdle failed" << ToString(vkres));
@@ -85,13 +117,19 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
         commandBuffers.push_back(ToApi(pSubmitInfo->ppCommandBuffers[i])->GetVkCommandBuffer());
     }
 
-    // Wait semaphores
-    std::vector<VkSemaphore>          waitSemaphores;
-    std::vector<VkPipelineStageFlags> waitDstStageMasks;
+    // Wait semaphores, semaphores signaled on the host have nothing to wait for
+    std::vector<VkSemaphore> waitSemaphores;
+    {
+        std::lock_guard<std::mutex> lock(mDeferredWaitMutex);
+        waitSemaphores.swap(mDeferredWaitSemaphores);
+    }
     for (uint32_t i = 0; i < pSubmitInfo->waitSemaphoreCount; ++i) {
-        waitSemaphores.push_back(ToApi(pSubmitInfo->ppWaitSemaphores[i])->GetVkSemaphore());
-        waitDstStageMasks.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        const vk::Semaphore* pSemaphore = ToApi(pSubmitInfo->ppWaitSemaphores[i]);
+        if (!pSemaphore->ConsumeHostSignal()) {
+            waitSemaphores.push_back(pSemaphore->GetVkSemaphore());
+        }
     }
+    std::vector<VkPipelineStageFlags> waitDstStageMasks(waitSemaphores.size(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 
     // Signal semaphores
     std::vector<VkSemaphore> signalSemaphores;
@@ -126,6 +164,14 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
     return ppx::SUCCESS;
 }
 
+void Queue::DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores)
+{
+    std::lock_guard<std::mutex> lock(mDeferredWaitMutex);
+    for (uint32_t i = 0; i < waitSemaphoreCount; ++i) {
+        mDeferredWaitSemaphores.push_back(ToApi(ppWaitSemaphores[i])->GetVkSemaphore());
+    }
+}
+
 Result Queue::GetTimestampFrequency(uint64_t* pFrequency) const
 {
     if (IsNull(pFrequency)) {
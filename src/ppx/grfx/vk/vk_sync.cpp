@@ -55,12 +55,19 @@ void Fence::DestroyApiObjects()
 
 Result Fence::Wait(uint64_t timeout)
 {
+    if (mSignaledOnHost) {
+        return ppx::SUCCESS;
+    }
+
     VkResult vkres = vkWaitForFences(
         ToApi(GetDevice())->GetVkDevice(),
         1,
         mFence,
         VK_TRUE,
         timeout);
+    if (vkres == VK_TIMEOUT) {
+        return ppx::ERROR_WAIT_TIMED_OUT;
+    }
     if (vkres != VK_SUCCESS) {
         return ppx::ERROR_API_FAILURE;
     }
@@ -70,6 +77,8 @@ Result Fence::Wait(uint64_t timeout)
 
 Result Fence::Reset()
 {
+    mSignaledOnHost = false;
+
     VkResult vkres = vkResetFences(
         ToApi(GetDevice())->GetVkDevice(),
         1,
@@ -81,6 +90,12 @@ Result Fence::Reset()
     return ppx::SUCCESS;
 }
 
+Result Fence::SignalOnHost()
+{
+    mSignaledOnHost = true;
+    return ppx::SUCCESS;
+}
+
 // -------------------------------------------------------------------------------------------------
 // Semaphore
 // -------------------------------------------------------------------------------------------------
@@ -114,6 +129,19 @@ void Semaphore::DestroyApiObjects()
     }
 }
 
+Result Semaphore::SignalOnHost()
+{
+    mSignaledOnHost = true;
+    return ppx::SUCCESS;
+}
+
+bool Semaphore::ConsumeHostSignal() const
+{
+    bool signaled   = mSignaledOnHost;
+    mSignaledOnHost = false;
+    return signaled;
+}
+
 } // namespace vk
 } // namespace grfx
 } // namespace ppx
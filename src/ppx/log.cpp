@@ -41,10 +41,111 @@
 #include <android/log.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+
 namespace ppx {
 
+// How long the writer thread sleeps between drains unless a queue fills up
+static const std::chrono::milliseconds kWriterInterval = std::chrono::milliseconds(10);
+
+// -------------------------------------------------------------------------------------------------
+// LogRecordQueue
+// -------------------------------------------------------------------------------------------------
+
+// Single producer single consumer ring of preformatted records. The
+// producer is the owning thread, the consumer is whoever holds the log's
+// write mutex. Record strings keep their storage when a slot is reused so
+// steady state logging doesn't allocate in the queue.
+class LogRecordQueue
+{
+public:
+    struct Record
+    {
+        uint64_t    sequence = 0;
+        LogLevel    level    = LOG_LEVEL_DEFAULT;
+        std::string text;
+    };
+
+    LogRecordQueue(uint32_t capacity, uint64_t session)
+        : mSession(session)
+    {
+        uint32_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mRecords.resize(size);
+        mMask = size - 1;
+    }
+
+    uint32_t GetCapacity() const { return mMask + 1; }
+    uint64_t GetSession() const { return mSession; }
+
+    // Producer: returns nullptr if the queue is full
+    Record* BeginPush()
+    {
+        const uint64_t head = mHead.load(std::memory_order_relaxed);
+        const uint64_t tail = mTail.load(std::memory_order_acquire);
+        if ((head - tail) > mMask) {
+            return nullptr;
+        }
+        return &mRecords[head & mMask];
+    }
+
+    // Producer: publishes the record returned by BeginPush() and returns
+    // the number of queued records
+    uint64_t EndPush()
+    {
+        const uint64_t head = mHead.load(std::memory_order_relaxed) + 1;
+        mHead.store(head, std::memory_order_release);
+        return head - mTail.load(std::memory_order_relaxed);
+    }
+
+    // Producer
+    void AddDropped() { mDroppedCount.fetch_add(1, std::memory_order_relaxed); }
+
+    // Consumer: records in [tail, head) can be read until Pop()
+    uint64_t GetHead() const { return mHead.load(std::memory_order_acquire); }
+    uint64_t GetTail() const { return mTail.load(std::memory_order_relaxed); }
+    bool     IsEmpty() const { return GetHead() == GetTail(); }
+
+    const Record& GetRecord(uint64_t index) const { return mRecords[index & mMask]; }
+
+    void Pop(uint64_t newTail) { mTail.store(newTail, std::memory_order_release); }
+
+    // Consumer: number of records dropped since the last call
+    uint64_t TakeDropped()
+    {
+        const uint64_t count  = mDroppedCount.load(std::memory_order_relaxed);
+        const uint64_t delta  = count - mReportedDroppedCount;
+        mReportedDroppedCount = count;
+        return delta;
+    }
+
+private:
+    std::vector<Record>   mRecords;
+    uint32_t              mMask                 = 0;
+    uint64_t              mSession              = 0;
+    std::atomic<uint64_t> mHead                 = 0;
+    std::atomic<uint64_t> mTail                 = 0;
+    std::atomic<uint64_t> mDroppedCount         = 0;
+    uint64_t              mReportedDroppedCount = 0;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Log
+// -------------------------------------------------------------------------------------------------
+
 static Log sLogInstance;
 
+// Messages are formatted into a per-thread stream so that formatting
+// doesn't need to hold the write mutex
+static thread_local std::ostringstream sRecordStream;
+
+// Registered with the log the first time the thread logs in async mode,
+// the log keeps the queue alive until it's drained after the thread exits.
+static thread_local std::shared_ptr<LogRecordQueue> sThreadQueue;
+
 Log::Log()
 {
 }
@@ -62,18 +163,23 @@ bool Log::Initialize(uint32_t mode, const char* filePath, std::ostream* consoleS
     }
 
     // Create internal objects
-    bool result = sLogInstance.CreateObjects(mode, filePath, consoleStream);
+    bool result = sLogInstance.CreateObjects(mode & ~LOG_MODE_ASYNC, filePath, consoleStream);
     if (!result) {
         return false;
     }
 
     sLogInstance.Lock();
     {
+        sLogInstance.mDroppedRecordCount = 0;
         sLogInstance << "Logging started" << std::endl;
         sLogInstance.Flush(LOG_LEVEL_DEFAULT);
     }
     sLogInstance.Unlock();
 
+    if ((mode & LOG_MODE_ASYNC) != 0) {
+        sLogInstance.StartAsync(LogAsyncSettings());
+    }
+
     // Success
     return true;
 }
@@ -85,6 +191,9 @@ void Log::Shutdown()
         return;
     }
 
+    // Writes everything that's still queued
+    sLogInstance.StopAsync();
+
     // Write last line of log
     sLogInstance.Lock();
     {
@@ -129,6 +238,27 @@ bool Log::IsModeActive(LogMode mode)
     return result;
 }
 
+void Log::SetAsync(bool enable, const LogAsyncSettings& settings)
+{
+    if (!IsActive()) {
+        return;
+    }
+
+    if (enable) {
+        sLogInstance.StartAsync(settings);
+    }
+    else {
+        sLogInstance.StopAsync();
+    }
+}
+
+uint64_t Log::GetDroppedRecordCount()
+{
+    std::lock_guard<std::mutex> lock(sLogInstance.mWriteMutex);
+    sLogInstance.DrainLocked();
+    return sLogInstance.mDroppedRecordCount;
+}
+
 bool Log::CreateObjects(uint32_t modes, const char* filePath, std::ostream* consoleStream)
 {
     mModes = modes;
@@ -231,11 +361,25 @@ void Log::Unlock()
 
 void Log::Flush(LogLevel level)
 {
+    // Queued records were submitted before anything in the buffer
+    if (mAsync.load(std::memory_order_acquire)) {
+        DrainLocked();
+    }
+
     // Write anything that's in the buffer
     if (mBuffer.str().size() > 0) {
         Write(mBuffer.str().c_str(), level);
     }
 
+    FlushStreams();
+
+    // Clear buffer
+    mBuffer.str(std::string());
+    mBuffer.clear();
+}
+
+void Log::FlushStreams()
+{
     // Signal flush for console
     if ((mModes & LOG_MODE_CONSOLE) != 0) {
 #if defined(PPX_MSW)
@@ -250,10 +394,203 @@ void Log::Flush(LogLevel level)
     if (((mModes & LOG_MODE_FILE) != 0) && (mFileStream.is_open())) {
         mFileStream.flush();
     }
+}
 
-    // Clear buffer
-    mBuffer.str(std::string());
-    mBuffer.clear();
+void Log::Drain()
+{
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    DrainLocked();
+    FlushStreams();
+}
+
+std::ostream& Log::BeginRecord()
+{
+    sRecordStream.str(std::string());
+    sRecordStream.clear();
+    return sRecordStream;
+}
+
+void Log::EndRecord(LogLevel level)
+{
+    const std::string text = sRecordStream.str();
+
+    if (mAsync.load(std::memory_order_acquire)) {
+        PushRecord(text, level);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    if (!text.empty()) {
+        Write(text.c_str(), level);
+    }
+    FlushStreams();
+}
+
+void Log::StartAsync(const LogAsyncSettings& settings)
+{
+    if (mAsync.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    mAsyncSettings               = settings;
+    mAsyncSettings.queueCapacity = std::max<uint32_t>(mAsyncSettings.queueCapacity, 2);
+    mAsyncSettings.maxRecordSize = std::max<uint32_t>(mAsyncSettings.maxRecordSize, 1);
+
+    mAsyncSession += 1;
+
+    mStopWriter   = false;
+    mWriterThread = std::thread(&Log::WriterThreadFunc, this);
+
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    mModes |= LOG_MODE_ASYNC;
+    mAsync.store(true, std::memory_order_release);
+}
+
+void Log::StopAsync()
+{
+    if (!mAsync.load(std::memory_order_acquire)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        mModes &= ~LOG_MODE_ASYNC;
+        mAsync.store(false, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWriterMutex);
+        mStopWriter = true;
+    }
+    mWriterCondition.notify_one();
+    mWriterThread.join();
+
+    Drain();
+}
+
+void Log::PushRecord(const std::string& text, LogLevel level)
+{
+    // Queues from an earlier async session were drained when it stopped
+    // and may have been created with different settings
+    if (!sThreadQueue || (sThreadQueue->GetSession() != mAsyncSession)) {
+        sThreadQueue = std::make_shared<LogRecordQueue>(mAsyncSettings.queueCapacity, mAsyncSession);
+
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        mQueues.push_back(sThreadQueue);
+    }
+
+    // Errors are never dropped, when blocking help drain instead of
+    // waiting for the writer thread to wake up
+    const bool              mustQueue = (level == LOG_LEVEL_ERROR) || (level == LOG_LEVEL_FATAL);
+    LogRecordQueue::Record* pRecord   = sThreadQueue->BeginPush();
+    while (pRecord == nullptr) {
+        if (!mustQueue && (mAsyncSettings.overflowPolicy == LOG_OVERFLOW_POLICY_DROP)) {
+            sThreadQueue->AddDropped();
+            return;
+        }
+        if (mWriteMutex.try_lock()) {
+            DrainLocked();
+            mWriteMutex.unlock();
+        }
+        else {
+            std::this_thread::yield();
+        }
+        pRecord = sThreadQueue->BeginPush();
+    }
+
+    pRecord->sequence = mNextSequence.fetch_add(1, std::memory_order_relaxed);
+    pRecord->level    = level;
+    if (text.size() > mAsyncSettings.maxRecordSize) {
+        pRecord->text.assign(text, 0, mAsyncSettings.maxRecordSize);
+        pRecord->text.append(" [truncated]\n");
+    }
+    else {
+        pRecord->text.assign(text);
+    }
+    const uint64_t queuedCount = sThreadQueue->EndPush();
+
+    // Fatal records are followed by a crash or exit, write them now
+    if (level == LOG_LEVEL_FATAL) {
+        Drain();
+        return;
+    }
+
+    if ((level == LOG_LEVEL_ERROR) || (queuedCount >= (sThreadQueue->GetCapacity() / 2))) {
+        mWriterCondition.notify_one();
+    }
+
+    // Async mode was turned off while the record was being queued, the
+    // final drain may have missed it
+    if (!mAsync.load(std::memory_order_acquire)) {
+        Drain();
+    }
+}
+
+void Log::DrainLocked()
+{
+    struct PendingRecord
+    {
+        const LogRecordQueue::Record* pRecord;
+        uint64_t                      sequence;
+    };
+
+    std::vector<std::shared_ptr<LogRecordQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+
+        // Queues that only the log references belong to threads that have exited
+        auto it = std::remove_if(
+            mQueues.begin(),
+            mQueues.end(),
+            [](const std::shared_ptr<LogRecordQueue>& queue) -> bool { return (queue.use_count() == 1) && queue->IsEmpty(); });
+        mQueues.erase(it, mQueues.end());
+
+        queues = mQueues;
+    }
+
+    std::vector<PendingRecord> pending;
+    std::vector<uint64_t>      heads(queues.size());
+    uint64_t                   droppedCount = 0;
+    for (size_t i = 0; i < queues.size(); ++i) {
+        heads[i] = queues[i]->GetHead();
+        for (uint64_t index = queues[i]->GetTail(); index < heads[i]; ++index) {
+            const LogRecordQueue::Record& record = queues[i]->GetRecord(index);
+            pending.push_back({&record, record.sequence});
+        }
+        droppedCount += queues[i]->TakeDropped();
+    }
+
+    if (droppedCount > 0) {
+        mDroppedRecordCount += droppedCount;
+
+        std::stringstream ss;
+        ss << droppedCount << " log records dropped, the logging thread's queue was full" << std::endl;
+        Write(ss.str().c_str(), LOG_LEVEL_WARN);
+    }
+
+    // Each queue is in order, merge them into submission order
+    std::sort(
+        pending.begin(),
+        pending.end(),
+        [](const PendingRecord& a, const PendingRecord& b) -> bool { return a.sequence < b.sequence; });
+    for (const PendingRecord& record : pending) {
+        Write(record.pRecord->text.c_str(), record.pRecord->level);
+    }
+
+    for (size_t i = 0; i < queues.size(); ++i) {
+        queues[i]->Pop(heads[i]);
+    }
+}
+
+void Log::WriterThreadFunc()
+{
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    while (!mStopWriter) {
+        mWriterCondition.wait_for(lock, kWriterInterval);
+
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
 }
 
 } // namespace ppx
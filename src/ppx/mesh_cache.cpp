@@ -0,0 +1,373 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/mesh_cache.h"
+#include "ppx/grfx/grfx_util.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "xxhash.h"
+
+namespace ppx {
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool IsRangeInFile(uint64_t offset, uint64_t size, size_t fileSize)
+{
+    return (offset <= fileSize) && (size <= (fileSize - offset));
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------------------------------
+// MeshCacheFile
+// -------------------------------------------------------------------------------------------------
+Result MeshCacheFile::Open(const std::filesystem::path& path, uint64_t sourceHash)
+{
+    if (!mFile.Open(path, fs::FILE_ACCESS_HINT_SEQUENTIAL)) {
+        return ppx::ERROR_MESH_CACHE_OPEN_FAILED;
+    }
+
+    if (mFile.IsMapped()) {
+        mpData = static_cast<const char*>(mFile.GetMappedData());
+    }
+    else {
+        mStorage.resize(mFile.GetLength());
+        if (mFile.Read(mStorage.data(), mStorage.size()) != mStorage.size()) {
+            return ppx::ERROR_MESH_CACHE_OPEN_FAILED;
+        }
+        mpData = mStorage.data();
+    }
+    mDataSize = mFile.GetLength();
+
+    return Parse(sourceHash);
+}
+
+Result MeshCacheFile::OpenFromMemory(const void* pData, size_t size, uint64_t sourceHash)
+{
+    PPX_ASSERT_NULL_ARG(pData);
+
+    mpData    = static_cast<const char*>(pData);
+    mDataSize = size;
+
+    return Parse(sourceHash);
+}
+
+Result MeshCacheFile::Parse(uint64_t sourceHash)
+{
+    if (mDataSize < sizeof(MeshCacheHeader)) {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+
+    MeshCacheHeader header = {};
+    memcpy(&header, mpData, sizeof(header));
+    if ((memcmp(header.magic, kMeshCacheMagic, sizeof(header.magic)) != 0) || (header.version != kMeshCacheVersion)) {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+    if (header.sourceHash != sourceHash) {
+        return ppx::ERROR_MESH_CACHE_SOURCE_MISMATCH;
+    }
+
+    if ((header.bindingCount == 0) || (header.bindingCount > PPX_MAX_VERTEX_BINDINGS) ||
+        (header.primitiveTopology != grfx::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)) {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+    switch (header.vertexAttributeLayout) {
+        default: return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+        case GEOMETRY_VERTEX_ATTRIBUTE_LAYOUT_INTERLEAVED:
+        case GEOMETRY_VERTEX_ATTRIBUTE_LAYOUT_PLANAR:
+        case GEOMETRY_VERTEX_ATTRIBUTE_LAYOUT_POSITION_PLANAR: break;
+    }
+
+    // Index data
+    const grfx::IndexType indexType = static_cast<grfx::IndexType>(header.indexType);
+    if (indexType == grfx::INDEX_TYPE_UNDEFINED) {
+        if ((header.indexCount != 0) || (header.indexDataSize != 0)) {
+            return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+        }
+    }
+    else if ((indexType == grfx::INDEX_TYPE_UINT16) || (indexType == grfx::INDEX_TYPE_UINT32)) {
+        if ((header.indexDataSize != static_cast<uint64_t>(header.indexCount) * grfx::IndexTypeSize(indexType)) ||
+            !IsRangeInFile(header.indexDataOffset, header.indexDataSize, mDataSize)) {
+            return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+        }
+    }
+    else {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+
+    // Bindings and attributes
+    const uint64_t bindingsOffset   = sizeof(MeshCacheHeader);
+    const uint64_t attributesOffset = bindingsOffset + header.bindingCount * sizeof(MeshCacheBinding);
+    if (!IsRangeInFile(attributesOffset, static_cast<uint64_t>(header.attributeCount) * sizeof(MeshCacheAttribute), mDataSize)) {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+
+    mBindings.resize(header.bindingCount);
+    memcpy(mBindings.data(), mpData + bindingsOffset, header.bindingCount * sizeof(MeshCacheBinding));
+
+    GeometryOptions options       = {};
+    options.indexType             = indexType;
+    options.vertexAttributeLayout = static_cast<GeometryVertexAttributeLayout>(header.vertexAttributeLayout);
+    options.primitiveTopology     = static_cast<grfx::PrimitiveTopology>(header.primitiveTopology);
+    options.vertexBindingCount    = header.bindingCount;
+
+    uint32_t attributeIndex = 0;
+    for (uint32_t bindingIndex = 0; bindingIndex < header.bindingCount; ++bindingIndex) {
+        const MeshCacheBinding& binding = mBindings[bindingIndex];
+        if ((binding.attributeCount == 0) || (binding.attributeCount > (header.attributeCount - attributeIndex)) ||
+            !IsRangeInFile(binding.dataOffset, binding.dataSize, mDataSize) || (binding.dataSize > UINT32_MAX)) {
+            return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+        }
+        // Every binding holds one element per vertex, the mesh is created
+        // with vertexCount vertices of this stride
+        if ((binding.stride == 0) || (binding.dataSize != static_cast<uint64_t>(header.vertexCount) * binding.stride)) {
+            return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+        }
+
+        grfx::VertexBinding vertexBinding(binding.binding, static_cast<grfx::VertexInputRate>(binding.inputRate));
+        for (uint32_t i = 0; i < binding.attributeCount; ++i, ++attributeIndex) {
+            MeshCacheAttribute cached = {};
+            memcpy(&cached, mpData + attributesOffset + attributeIndex * sizeof(MeshCacheAttribute), sizeof(cached));
+
+            grfx::VertexAttribute attribute = {};
+            attribute.semantic              = static_cast<grfx::VertexSemantic>(cached.semantic);
+            attribute.semanticName          = grfx::ToString(attribute.semantic);
+            attribute.location              = cached.location;
+            attribute.format                = static_cast<grfx::Format>(cached.format);
+            attribute.binding               = cached.binding;
+            attribute.offset                = cached.offset;
+            attribute.inputRate             = static_cast<grfx::VertexInputRate>(cached.inputRate);
+            vertexBinding.AppendAttribute(attribute);
+        }
+        vertexBinding.SetStride(binding.stride);
+
+        options.vertexBindings[bindingIndex] = vertexBinding;
+    }
+    if (attributeIndex != header.attributeCount) {
+        return ppx::ERROR_MESH_CACHE_INVALID_FORMAT;
+    }
+
+    mOptions         = options;
+    mIndexCount      = header.indexCount;
+    mVertexCount     = header.vertexCount;
+    mBoundingBoxMin  = float3(header.boundingBoxMin[0], header.boundingBoxMin[1], header.boundingBoxMin[2]);
+    mBoundingBoxMax  = float3(header.boundingBoxMax[0], header.boundingBoxMax[1], header.boundingBoxMax[2]);
+    mIndexDataOffset = header.indexDataOffset;
+    mIndexDataSize   = static_cast<uint32_t>(header.indexDataSize);
+
+    return ppx::SUCCESS;
+}
+
+Result MeshCacheFile::CreateGeometry(Geometry* pGeometry) const
+{
+    PPX_ASSERT_NULL_ARG(pGeometry);
+
+    Result ppxres = Geometry::Create(mOptions, pGeometry);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    if (mOptions.indexType != grfx::INDEX_TYPE_UNDEFINED) {
+        Geometry::Buffer indexBuffer = *pGeometry->GetIndexBuffer();
+        indexBuffer.SetSize(mIndexDataSize);
+        memcpy(indexBuffer.GetData(), GetIndexData(), mIndexDataSize);
+        pGeometry->SetIndexBuffer(indexBuffer);
+    }
+
+    for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+        Geometry::Buffer* pBuffer = pGeometry->GetVertexBuffer(i);
+        pBuffer->SetSize(GetVertexDataSize(i));
+        memcpy(pBuffer->GetData(), GetVertexData(i), GetVertexDataSize(i));
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result MeshCacheFile::Write(
+    const std::filesystem::path& path,
+    uint64_t                     sourceHash,
+    const Geometry&              geometry,
+    const float3&                boundingBoxMin,
+    const float3&                boundingBoxMax)
+{
+    const uint32_t bindingCount = geometry.GetVertexBindingCount();
+    if ((bindingCount == 0) || (bindingCount != geometry.GetVertexBufferCount())) {
+        return ppx::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION;
+    }
+
+    std::vector<MeshCacheBinding>   bindings(bindingCount);
+    std::vector<MeshCacheAttribute> attributes;
+    for (uint32_t bindingIndex = 0; bindingIndex < bindingCount; ++bindingIndex) {
+        const grfx::VertexBinding* pBinding = geometry.GetVertexBinding(bindingIndex);
+        MeshCacheBinding&          binding  = bindings[bindingIndex];
+        binding.binding                     = pBinding->GetBinding();
+        binding.stride                      = pBinding->GetStride();
+        binding.inputRate                   = pBinding->GetInputRate();
+        binding.attributeCount              = pBinding->GetAttributeCount();
+        binding.dataSize                    = geometry.GetVertexBuffer(bindingIndex)->GetSize();
+
+        for (uint32_t attrIndex = 0; attrIndex < pBinding->GetAttributeCount(); ++attrIndex) {
+            const grfx::VertexAttribute* pAttribute = nullptr;
+            pBinding->GetAttribute(attrIndex, &pAttribute);
+
+            MeshCacheAttribute attribute = {};
+            attribute.location           = pAttribute->location;
+            attribute.format             = pAttribute->format;
+            attribute.binding            = pAttribute->binding;
+            attribute.offset             = pAttribute->offset;
+            attribute.inputRate          = pAttribute->inputRate;
+            attribute.semantic           = pAttribute->semantic;
+            attributes.push_back(attribute);
+        }
+    }
+
+    MeshCacheHeader header = {};
+    memcpy(header.magic, kMeshCacheMagic, sizeof(header.magic));
+    header.version               = kMeshCacheVersion;
+    header.indexType             = geometry.GetIndexType();
+    header.sourceHash            = sourceHash;
+    header.vertexAttributeLayout = geometry.GetVertexAttributeLayout();
+    header.primitiveTopology     = grfx::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    header.indexCount            = geometry.GetIndexCount();
+    header.vertexCount           = geometry.GetVertexCount();
+    header.bindingCount          = bindingCount;
+    header.attributeCount        = CountU32(attributes);
+    for (int i = 0; i < 3; ++i) {
+        header.boundingBoxMin[i] = boundingBoxMin[i];
+        header.boundingBoxMax[i] = boundingBoxMax[i];
+    }
+    header.indexDataSize = (header.indexType != grfx::INDEX_TYPE_UNDEFINED) ? geometry.GetIndexBuffer()->GetSize() : 0;
+
+    // Data follows the tables
+    uint64_t offset = sizeof(MeshCacheHeader) + bindings.size() * sizeof(MeshCacheBinding) + attributes.size() * sizeof(MeshCacheAttribute);
+    offset                 = AlignUp(offset, kMeshCacheAlignment);
+    header.indexDataOffset = offset;
+    offset                 = AlignUp(offset + header.indexDataSize, kMeshCacheAlignment);
+    for (auto& binding : bindings) {
+        binding.dataOffset = offset;
+        offset             = AlignUp(offset + binding.dataSize, kMeshCacheAlignment);
+    }
+
+    // Write to a temporary file first so a reader never maps a partial cache
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream os(tempPath, std::ios::binary | std::ios::trunc);
+        if (!os.good()) {
+            return ppx::ERROR_MESH_CACHE_WRITE_FAILED;
+        }
+
+        const char padding[kMeshCacheAlignment] = {};
+        uint64_t   written                      = 0;
+        auto       write                        = [&](uint64_t target, const void* pData, uint64_t size) {
+            os.write(padding, static_cast<std::streamsize>(target - written));
+            os.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+            written = target + size;
+        };
+
+        write(0, &header, sizeof(header));
+        write(written, bindings.data(), bindings.size() * sizeof(MeshCacheBinding));
+        write(written, attributes.data(), attributes.size() * sizeof(MeshCacheAttribute));
+        write(header.indexDataOffset, geometry.GetIndexBuffer()->GetData(), header.indexDataSize);
+        for (uint32_t i = 0; i < bindingCount; ++i) {
+            write(bindings[i].dataOffset, geometry.GetVertexBuffer(i)->GetData(), bindings[i].dataSize);
+        }
+
+        if (!os.good()) {
+            return ppx::ERROR_MESH_CACHE_WRITE_FAILED;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return ppx::ERROR_MESH_CACHE_WRITE_FAILED;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result MeshCacheFile::HashSource(const std::filesystem::path& sourcePath, const TriMeshOptions& options, uint64_t* pHash)
+{
+    PPX_ASSERT_NULL_ARG(pHash);
+
+    // Every option that changes the generated geometry
+    struct
+    {
+        uint32_t version;
+        uint32_t flags;
+        float    objectColor[3];
+        float    translate[3];
+        float    scale[3];
+        float    texCoordScale[2];
+    } key = {};
+
+    key.version = kMeshCacheVersion;
+    key.flags   = (options.mEnableIndices ? (1u << 0) : 0) |
+                (options.mEnableVertexColors ? (1u << 1) : 0) |
+                (options.mEnableNormals ? (1u << 2) : 0) |
+                (options.mEnableTexCoords ? (1u << 3) : 0) |
+                (options.mEnableTangents ? (1u << 4) : 0) |
+                (options.mEnableObjectColor ? (1u << 5) : 0) |
+                (options.mInvertTexCoordsV ? (1u << 6) : 0) |
+                (options.mInvertWinding ? (1u << 7) : 0) |
+                (options.mWeldVertices ? (1u << 8) : 0);
+    for (int i = 0; i < 3; ++i) {
+        key.objectColor[i] = options.mObjectColor[i];
+        key.translate[i]   = options.mTranslate[i];
+        key.scale[i]       = options.mScale[i];
+    }
+    key.texCoordScale[0] = options.mTexCoordScale[0];
+    key.texCoordScale[1] = options.mTexCoordScale[1];
+
+    fs::File file;
+    if (!file.Open(sourcePath, fs::FILE_ACCESS_HINT_SEQUENTIAL)) {
+        return ppx::ERROR_GEOMETRY_FILE_LOAD_FAILED;
+    }
+
+    const uint64_t seed = XXH64(&key, sizeof(key), 0);
+    if (file.IsMapped()) {
+        *pHash = XXH64(file.GetMappedData(), file.GetLength(), seed);
+    }
+    else {
+        std::vector<char> content(file.GetLength());
+        if (file.Read(content.data(), content.size()) != content.size()) {
+            return ppx::ERROR_GEOMETRY_FILE_LOAD_FAILED;
+        }
+        *pHash = XXH64(content.data(), content.size(), seed);
+    }
+
+    return ppx::SUCCESS;
+}
+
+std::filesystem::path MeshCacheFile::GetCachePath(const std::filesystem::path& directory, const std::filesystem::path& sourcePath)
+{
+    const std::string sourceName = sourcePath.lexically_normal().generic_string();
+
+    std::stringstream ss;
+    ss << sourcePath.stem().string() << "_" << std::hex << std::setw(16) << std::setfill('0') << XXH64(sourceName.data(), sourceName.size(), 0) << ".ppxmesh";
+
+    return directory / ss.str();
+}
+
+} // namespace ppx
@@ -0,0 +1,663 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/mesh_optimize.h"
+#include "ppx/geometry.h"
+#include "ppx/tri_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace ppx {
+
+// -------------------------------------------------------------------------------------------------
+// Internal helpers
+// -------------------------------------------------------------------------------------------------
+
+// Simulates a FIFO cache using timestamps: a vertex is in the cache if
+// fewer than cacheSize misses happened since it was inserted.
+class FifoCacheSimulator
+{
+public:
+    FifoCacheSimulator(uint32_t vertexCount, uint32_t cacheSize)
+        : mTimestamps(vertexCount, 0), mCacheSize(cacheSize), mTime(cacheSize + 1) {}
+
+    // Returns true on a cache miss
+    bool Access(uint32_t vertex)
+    {
+        if ((mTime - mTimestamps[vertex]) > mCacheSize) {
+            mTimestamps[vertex] = mTime;
+            ++mTime;
+            return true;
+        }
+        return false;
+    }
+
+    // Misses since the vertex was inserted, the vertex is in the cache
+    // while this is at most cacheSize
+    uint32_t GetAge(uint32_t vertex) const { return mTime - mTimestamps[vertex]; }
+
+    // Evicts every vertex
+    void Flush() { mTime += mCacheSize + 1; }
+
+private:
+    std::vector<uint32_t> mTimestamps;
+    uint32_t              mCacheSize = 0;
+    uint32_t              mTime      = 0;
+};
+
+// Triangles adjacent to each vertex in compressed row form
+struct VertexAdjacency
+{
+    std::vector<uint32_t> offsets;   // vertexCount + 1 entries
+    std::vector<uint32_t> triangles; // indexCount entries
+};
+
+static void BuildVertexAdjacency(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, VertexAdjacency* pAdjacency)
+{
+    pAdjacency->offsets.assign(vertexCount + 1, 0);
+    pAdjacency->triangles.resize(indexCount);
+
+    for (uint32_t i = 0; i < indexCount; ++i) {
+        pAdjacency->offsets[pIndices[i] + 1] += 1;
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        pAdjacency->offsets[v + 1] += pAdjacency->offsets[v];
+    }
+
+    std::vector<uint32_t> cursors(pAdjacency->offsets.begin(), pAdjacency->offsets.end() - 1);
+    for (uint32_t i = 0; i < indexCount; ++i) {
+        uint32_t v                          = pIndices[i];
+        pAdjacency->triangles[cursors[v]++] = i / 3;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Analysis
+// -------------------------------------------------------------------------------------------------
+VertexCacheStatistics AnalyzeVertexCache(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    uint32_t        vertexCount,
+    uint32_t        cacheSize)
+{
+    VertexCacheStatistics stats = {};
+    if ((indexCount < 3) || (vertexCount == 0) || IsNull(pIndices)) {
+        return stats;
+    }
+
+    FifoCacheSimulator   cache(vertexCount, cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    uint32_t             referencedCount = 0;
+    for (uint32_t i = 0; i < indexCount; ++i) {
+        uint32_t v = pIndices[i];
+        if (cache.Access(v)) {
+            stats.transformCount += 1;
+        }
+        if (!referenced[v]) {
+            referenced[v] = 1;
+            referencedCount += 1;
+        }
+    }
+
+    stats.acmr = static_cast<float>(stats.transformCount) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(stats.transformCount) / static_cast<float>(referencedCount);
+    return stats;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Vertex cache
+// -------------------------------------------------------------------------------------------------
+void OptimizeVertexCache(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    uint32_t        vertexCount,
+    uint32_t        cacheSize,
+    uint32_t*       pDstIndices)
+{
+    PPX_ASSERT_MSG(pIndices != pDstIndices, "source and destination indices must not alias");
+
+    // Indices past the last whole triangle are copied through unchanged
+    const uint32_t triangleCount = indexCount / 3;
+    std::copy(pIndices + 3 * triangleCount, pIndices + indexCount, pDstIndices + 3 * triangleCount);
+    if ((triangleCount == 0) || (vertexCount == 0)) {
+        std::copy(pIndices, pIndices + 3 * triangleCount, pDstIndices);
+        return;
+    }
+
+    VertexAdjacency adjacency;
+    BuildVertexAdjacency(pIndices, triangleCount * 3, vertexCount, &adjacency);
+
+    // Number of triangles not yet emitted for each vertex
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    FifoCacheSimulator    cache(vertexCount, cacheSize);
+    std::vector<uint8_t>  emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    deadEndStack.reserve(triangleCount * 3);
+
+    uint32_t cursor     = 0;
+    uint32_t outCount   = 0;
+    int64_t  fanningVtx = 0;
+
+    while (fanningVtx >= 0) {
+        const uint32_t f = static_cast<uint32_t>(fanningVtx);
+
+        // Emit all live triangles around the fanning vertex
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[f]; i < adjacency.offsets[f + 1]; ++i) {
+            uint32_t tri = adjacency.triangles[i];
+            if (emitted[tri]) {
+                continue;
+            }
+            for (uint32_t k = 0; k < 3; ++k) {
+                uint32_t v              = pIndices[3 * tri + k];
+                pDstIndices[outCount++] = v;
+                deadEndStack.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v] -= 1;
+                cache.Access(v);
+            }
+            emitted[tri] = 1;
+        }
+
+        // Pick the candidate that will still be in the cache after its
+        // remaining triangles are emitted, preferring the oldest one.
+        int64_t  best         = -1;
+        uint32_t bestPriority = 0;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+            uint32_t priority = 0;
+            if ((cache.GetAge(v) + 2 * liveTriangles[v]) <= cacheSize) {
+                priority = cache.GetAge(v);
+            }
+            if ((best < 0) || (priority > bestPriority)) {
+                best         = v;
+                bestPriority = priority;
+            }
+        }
+
+        // Dead end - go back to recently used vertices, then scan in order
+        if (best < 0) {
+            while (!deadEndStack.empty()) {
+                uint32_t v = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangles[v] > 0) {
+                    best = v;
+                    break;
+                }
+            }
+        }
+        if (best < 0) {
+            while (cursor < vertexCount) {
+                uint32_t v = cursor++;
+                if (liveTriangles[v] > 0) {
+                    best = v;
+                    break;
+                }
+            }
+        }
+
+        fanningVtx = best;
+    }
+
+    PPX_ASSERT_MSG(outCount == (triangleCount * 3), "not all triangles were emitted");
+}
+
+// -------------------------------------------------------------------------------------------------
+// Overdraw
+// -------------------------------------------------------------------------------------------------
+struct OverdrawCluster
+{
+    uint32_t firstTriangle = 0;
+    uint32_t triangleCount = 0;
+    float    sortKey       = 0;
+};
+
+void OptimizeOverdraw(
+    const uint32_t* pIndices,
+    uint32_t        indexCount,
+    const float*    pPositions,
+    uint32_t        vertexCount,
+    uint32_t        positionStride,
+    uint32_t        cacheSize,
+    float           threshold,
+    uint32_t*       pDstIndices)
+{
+    PPX_ASSERT_MSG(pIndices != pDstIndices, "source and destination indices must not alias");
+
+    // Indices past the last whole triangle are copied through unchanged
+    const uint32_t triangleCount = indexCount / 3;
+    std::copy(pIndices + 3 * triangleCount, pIndices + indexCount, pDstIndices + 3 * triangleCount);
+    if ((triangleCount == 0) || (vertexCount == 0)) {
+        std::copy(pIndices, pIndices + 3 * triangleCount, pDstIndices);
+        return;
+    }
+
+    // One simulator is flushed between passes instead of allocating a
+    // vertexCount sized one per cluster
+    FifoCacheSimulator cache(vertexCount, cacheSize);
+
+    // Hard boundaries: triangles where all three vertices miss the cache
+    std::vector<uint32_t> hardBoundaries;
+    for (uint32_t tri = 0; tri < triangleCount; ++tri) {
+        bool miss0 = cache.Access(pIndices[3 * tri + 0]);
+        bool miss1 = cache.Access(pIndices[3 * tri + 1]);
+        bool miss2 = cache.Access(pIndices[3 * tri + 2]);
+        if ((tri == 0) || (miss0 && miss1 && miss2)) {
+            hardBoundaries.push_back(tri);
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // Soft boundaries: split hard clusters wherever the running ACMR is
+    // within threshold of the whole cluster's ACMR.
+    std::vector<OverdrawCluster> clusters;
+    for (size_t i = 0; (i + 1) < hardBoundaries.size(); ++i) {
+        const uint32_t start = hardBoundaries[i];
+        const uint32_t end   = hardBoundaries[i + 1];
+
+        uint32_t clusterMisses = 0;
+        cache.Flush();
+        for (uint32_t tri = start; tri < end; ++tri) {
+            clusterMisses += cache.Access(pIndices[3 * tri + 0]) ? 1 : 0;
+            clusterMisses += cache.Access(pIndices[3 * tri + 1]) ? 1 : 0;
+            clusterMisses += cache.Access(pIndices[3 * tri + 2]) ? 1 : 0;
+        }
+        const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        cache.Flush();
+        uint32_t softStart  = start;
+        uint32_t softMisses = 0;
+        for (uint32_t tri = start; tri < end; ++tri) {
+            softMisses += cache.Access(pIndices[3 * tri + 0]) ? 1 : 0;
+            softMisses += cache.Access(pIndices[3 * tri + 1]) ? 1 : 0;
+            softMisses += cache.Access(pIndices[3 * tri + 2]) ? 1 : 0;
+
+            const uint32_t softCount = tri - softStart + 1;
+            const bool     isLast    = ((tri + 1) == end);
+            if (isLast || ((static_cast<float>(softMisses) / static_cast<float>(softCount)) <= clusterThreshold)) {
+                OverdrawCluster cluster = {};
+                cluster.firstTriangle   = softStart;
+                cluster.triangleCount   = softCount;
+                clusters.push_back(cluster);
+
+                softStart  = tri + 1;
+                softMisses = 0;
+                cache.Flush();
+            }
+        }
+    }
+
+    auto getPosition = [pPositions, positionStride](uint32_t v, float* pOut) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + static_cast<size_t>(v) * positionStride);
+        pOut[0]        = p[0];
+        pOut[1]        = p[1];
+        pOut[2]        = p[2];
+    };
+
+    // Area weighted centroid and normal of each cluster
+    std::vector<float> clusterData(clusters.size() * 7, 0.0f); // centroid xyz, normal xyz, area
+    float              meshCentroid[3] = {0, 0, 0};
+    float              meshArea        = 0;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        float* pData = &clusterData[c * 7];
+        for (uint32_t tri = clusters[c].firstTriangle; tri < (clusters[c].firstTriangle + clusters[c].triangleCount); ++tri) {
+            float p0[3], p1[3], p2[3];
+            getPosition(pIndices[3 * tri + 0], p0);
+            getPosition(pIndices[3 * tri + 1], p1);
+            getPosition(pIndices[3 * tri + 2], p2);
+
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3]  = {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0]};
+            float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (uint32_t k = 0; k < 3; ++k) {
+                pData[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+                pData[3 + k] += n[k];
+            }
+            pData[6] += area;
+        }
+
+        for (uint32_t k = 0; k < 3; ++k) {
+            meshCentroid[k] += pData[k];
+        }
+        meshArea += pData[6];
+
+        if (pData[6] > 0) {
+            pData[0] /= pData[6];
+            pData[1] /= pData[6];
+            pData[2] /= pData[6];
+        }
+    }
+    if (meshArea > 0) {
+        meshCentroid[0] /= meshArea;
+        meshCentroid[1] /= meshArea;
+        meshCentroid[2] /= meshArea;
+    }
+
+    // Clusters facing away from the mesh center and far from it are the
+    // most likely to occlude other parts of the mesh.
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const float* pData   = &clusterData[c * 7];
+        float        nLength = std::sqrt(pData[3] * pData[3] + pData[4] * pData[4] + pData[5] * pData[5]);
+        if (nLength > 0) {
+            float d[3]          = {pData[0] - meshCentroid[0], pData[1] - meshCentroid[1], pData[2] - meshCentroid[2]};
+            clusters[c].sortKey = (d[0] * pData[3] + d[1] * pData[4] + d[2] * pData[5]) / nLength;
+        }
+    }
+
+    std::stable_sort(
+        clusters.begin(),
+        clusters.end(),
+        [](const OverdrawCluster& a, const OverdrawCluster& b) -> bool { return a.sortKey > b.sortKey; });
+
+    uint32_t outCount = 0;
+    for (const auto& cluster : clusters) {
+        const uint32_t* pSrc = pIndices + 3 * cluster.firstTriangle;
+        std::copy(pSrc, pSrc + 3 * cluster.triangleCount, pDstIndices + outCount);
+        outCount += 3 * cluster.triangleCount;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Vertex fetch
+// -------------------------------------------------------------------------------------------------
+uint32_t OptimizeVertexFetch(
+    uint32_t* pIndices,
+    uint32_t  indexCount,
+    uint32_t  vertexCount,
+    uint32_t* pRemap)
+{
+    std::fill(pRemap, pRemap + vertexCount, UINT32_MAX);
+
+    uint32_t nextVertex = 0;
+    for (uint32_t i = 0; i < indexCount; ++i) {
+        uint32_t& index = pIndices[i];
+        if (pRemap[index] == UINT32_MAX) {
+            pRemap[index] = nextVertex++;
+        }
+        index = pRemap[index];
+    }
+    return nextVertex;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Index buffer passes shared by TriMesh and Geometry
+// -------------------------------------------------------------------------------------------------
+static void OptimizeIndices(
+    const MeshOptimizeOptions& options,
+    const float*               pPositions,
+    uint32_t                   positionStride,
+    uint32_t                   vertexCount,
+    std::vector<uint32_t>&     indices)
+{
+    const uint32_t        indexCount = CountU32(indices);
+    std::vector<uint32_t> scratch(indexCount);
+
+    if (options.vertexCache) {
+        OptimizeVertexCache(indices.data(), indexCount, vertexCount, options.cacheSize, scratch.data());
+        std::swap(indices, scratch);
+    }
+
+    if (options.overdraw && !IsNull(pPositions)) {
+        OptimizeOverdraw(indices.data(), indexCount, pPositions, vertexCount, positionStride, options.cacheSize, options.overdrawThreshold, scratch.data());
+        std::swap(indices, scratch);
+    }
+}
+
+// The passes index per-vertex tables with the indices and work on whole
+// triangles, check both once up front
+static Result ValidateIndices(const char* pName, const std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    if ((indices.size() % 3) != 0) {
+        PPX_LOG_ERROR(pName << " has " << indices.size() << " indices, which isn't a whole number of triangles");
+        return ppx::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION;
+    }
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= vertexCount) {
+            PPX_LOG_ERROR(pName << " index " << i << " references vertex " << indices[i] << " but there are only " << vertexCount << " vertices");
+            return ppx::ERROR_OUT_OF_RANGE;
+        }
+    }
+    return ppx::SUCCESS;
+}
+
+static void LogOptimizeResult(const char* pName, const MeshOptimizeResult& result)
+{
+    PPX_LOG_INFO(pName << " optimized: ACMR " << result.before.acmr << " -> " << result.after.acmr << ", ATVR " << result.before.atvr << " -> " << result.after.atvr);
+}
+
+// -------------------------------------------------------------------------------------------------
+// TriMesh
+// -------------------------------------------------------------------------------------------------
+Result OptimizeMesh(
+    TriMesh*                   pMesh,
+    const MeshOptimizeOptions& options,
+    MeshOptimizeResult*        pResult)
+{
+    PPX_ASSERT_NULL_ARG(pMesh);
+
+    const grfx::IndexType indexType = pMesh->GetIndexType();
+    if (indexType == grfx::INDEX_TYPE_UNDEFINED) {
+        return ppx::ERROR_GEOMETRY_NO_INDEX_DATA;
+    }
+
+    const uint32_t vertexCount = pMesh->GetCountPositions();
+    const uint32_t indexCount  = pMesh->GetCountIndices();
+
+    std::vector<uint32_t> indices(indexCount);
+    for (uint32_t i = 0; i < indexCount; ++i) {
+        indices[i] = (indexType == grfx::INDEX_TYPE_UINT16) ? static_cast<uint32_t>(*pMesh->GetDataIndicesU16(i)) : *pMesh->GetDataIndicesU32(i);
+    }
+
+    Result ppxres = ValidateIndices("TriMesh", indices, vertexCount);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    MeshOptimizeResult result = {};
+    result.before             = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, options.cacheSize);
+
+    const float* pPositions = (vertexCount > 0) ? reinterpret_cast<const float*>(pMesh->GetDataPositions()) : nullptr;
+    OptimizeIndices(options, pPositions, sizeof(float3), vertexCount, indices);
+
+    // Old vertex index for each new vertex
+    std::vector<uint32_t> vertexOrder(vertexCount);
+    std::iota(vertexOrder.begin(), vertexOrder.end(), 0);
+    if (options.vertexFetch) {
+        std::vector<uint32_t> remap(vertexCount);
+        uint32_t              usedCount = OptimizeVertexFetch(indices.data(), indexCount, vertexCount, remap.data());
+
+        vertexOrder.resize(usedCount);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            if (remap[v] != UINT32_MAX) {
+                vertexOrder[remap[v]] = v;
+            }
+        }
+    }
+
+    // TriMesh doesn't allow in place edits so rebuild it with the new order
+    TriMesh mesh = TriMesh(indexType, pMesh->GetTexCoordDim());
+    for (uint32_t v : vertexOrder) {
+        mesh.AppendPosition(*pMesh->GetDataPositions(v));
+        if (pMesh->HasColors()) {
+            mesh.AppendColor(*pMesh->GetDataColors(v));
+        }
+        if (pMesh->HasNormals()) {
+            mesh.AppendNormal(*pMesh->GetDataNormalls(v));
+        }
+        if (pMesh->HasTexCoords()) {
+            switch (pMesh->GetTexCoordDim()) {
+                default: break;
+                case TRI_MESH_ATTRIBUTE_DIM_2: mesh.AppendTexCoord(*pMesh->GetDataTexCoords2(v)); break;
+                case TRI_MESH_ATTRIBUTE_DIM_3: mesh.AppendTexCoord(*pMesh->GetDataTexCoords3(v)); break;
+                case TRI_MESH_ATTRIBUTE_DIM_4: mesh.AppendTexCoord(*pMesh->GetDataTexCoords4(v)); break;
+            }
+        }
+        if (pMesh->HasTangents()) {
+            mesh.AppendTangent(*pMesh->GetDataTangents(v));
+        }
+        if (pMesh->HasBitangents()) {
+            mesh.AppendBitangent(*pMesh->GetDataBitangents(v));
+        }
+    }
+    for (uint32_t i = 0; (i + 2) < indexCount; i += 3) {
+        mesh.AppendTriangle(indices[i + 0], indices[i + 1], indices[i + 2]);
+    }
+
+    *pMesh = std::move(mesh);
+
+    result.after = AnalyzeVertexCache(indices.data(), indexCount, CountU32(vertexOrder), options.cacheSize);
+    LogOptimizeResult("TriMesh", result);
+
+    if (!IsNull(pResult)) {
+        *pResult = result;
+    }
+
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Geometry
+// -------------------------------------------------------------------------------------------------
+Result OptimizeMesh(
+    Geometry*                  pGeometry,
+    const MeshOptimizeOptions& options,
+    MeshOptimizeResult*        pResult)
+{
+    PPX_ASSERT_NULL_ARG(pGeometry);
+
+    const grfx::IndexType indexType = pGeometry->GetIndexType();
+    if ((indexType != grfx::INDEX_TYPE_UINT16) && (indexType != grfx::INDEX_TYPE_UINT32)) {
+        return ppx::ERROR_GEOMETRY_NO_INDEX_DATA;
+    }
+
+    const uint32_t vertexCount = pGeometry->GetVertexCount();
+    const uint32_t indexCount  = pGeometry->GetIndexCount();
+
+    // Every vertex buffer is reordered with the same remap
+    if (options.vertexFetch) {
+        for (uint32_t b = 0; b < pGeometry->GetVertexBufferCount(); ++b) {
+            if (pGeometry->GetVertexBuffer(b)->GetElementCount() != vertexCount) {
+                PPX_LOG_ERROR("Geometry vertex buffer " << b << " doesn't have " << vertexCount << " vertices");
+                return ppx::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION;
+            }
+        }
+    }
+
+    std::vector<uint32_t> indices(indexCount);
+    {
+        const char* pIndexData = pGeometry->GetIndexBuffer()->GetData();
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            if (indexType == grfx::INDEX_TYPE_UINT16) {
+                indices[i] = reinterpret_cast<const uint16_t*>(pIndexData)[i];
+            }
+            else {
+                indices[i] = reinterpret_cast<const uint32_t*>(pIndexData)[i];
+            }
+        }
+    }
+
+    Result ppxres = ValidateIndices("Geometry", indices, vertexCount);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    MeshOptimizeResult result = {};
+    result.before             = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, options.cacheSize);
+
+    // Positions are only usable for overdraw ordering if they're 32-bit floats
+    const float* pPositions     = nullptr;
+    uint32_t     positionStride = 0;
+    for (uint32_t b = 0; (b < pGeometry->GetVertexBindingCount()) && (vertexCount > 0); ++b) {
+        const grfx::VertexBinding* pBinding = pGeometry->GetVertexBinding(b);
+        uint32_t                   attrIdx  = pBinding->GetAttributeIndex(grfx::VERTEX_SEMANTIC_POSITION);
+        if (attrIdx == PPX_VALUE_IGNORED) {
+            continue;
+        }
+
+        const grfx::VertexAttribute* pAttribute = nullptr;
+        pBinding->GetAttribute(attrIdx, &pAttribute);
+        if ((pAttribute->format == grfx::FORMAT_R32G32B32_FLOAT) || (pAttribute->format == grfx::FORMAT_R32G32B32A32_FLOAT)) {
+            pPositions     = reinterpret_cast<const float*>(pGeometry->GetVertexBuffer(b)->GetData() + pAttribute->offset);
+            positionStride = pGeometry->GetVertexBuffer(b)->GetElementSize();
+        }
+        break;
+    }
+    if (options.overdraw && IsNull(pPositions)) {
+        PPX_LOG_WARN("Geometry positions aren't 32-bit floats, skipping overdraw optimization");
+    }
+
+    OptimizeIndices(options, pPositions, positionStride, vertexCount, indices);
+
+    uint32_t newVertexCount = vertexCount;
+    if (options.vertexFetch) {
+        std::vector<uint32_t> remap(vertexCount);
+        newVertexCount = OptimizeVertexFetch(indices.data(), indexCount, vertexCount, remap.data());
+
+        // Reorder every vertex buffer
+        std::vector<char> scratch;
+        for (uint32_t b = 0; b < pGeometry->GetVertexBufferCount(); ++b) {
+            Geometry::Buffer* pBuffer     = pGeometry->GetVertexBuffer(b);
+            const uint32_t    elementSize = pBuffer->GetElementSize();
+
+            scratch.assign(pBuffer->GetData(), pBuffer->GetData() + pBuffer->GetSize());
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                if (remap[v] != UINT32_MAX) {
+                    std::memcpy(pBuffer->GetData() + static_cast<size_t>(remap[v]) * elementSize, scratch.data() + static_cast<size_t>(v) * elementSize, elementSize);
+                }
+            }
+            pBuffer->SetSize(newVertexCount * elementSize);
+        }
+    }
+
+    // Write indices back
+    {
+        Geometry::Buffer indexBuffer = *pGeometry->GetIndexBuffer();
+        char*            pIndexData  = indexBuffer.GetData();
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            if (indexType == grfx::INDEX_TYPE_UINT16) {
+                reinterpret_cast<uint16_t*>(pIndexData)[i] = static_cast<uint16_t>(indices[i]);
+            }
+            else {
+                reinterpret_cast<uint32_t*>(pIndexData)[i] = indices[i];
+            }
+        }
+        pGeometry->SetIndexBuffer(indexBuffer);
+    }
+
+    result.after = AnalyzeVertexCache(indices.data(), indexCount, newVertexCount, options.cacheSize);
+    LogOptimizeResult("Geometry", result);
+
+    if (!IsNull(pResult)) {
+        *pResult = result;
+    }
+
+    return ppx::SUCCESS;
+}
+
+} // namespace ppx
@@ -14,6 +14,7 @@
 
 #include "ppx/metrics.h"
 
+#include <cmath>
 #include <regex>
 #include <sstream>
 
@@ -37,6 +38,114 @@ nlohmann::json MetricMetadata::Export() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+TDigest::TDigest(double compression)
+    : mCompression(compression)
+{
+}
+
+void TDigest::Add(double value)
+{
+    mMin = std::min(mMin, value);
+    mMax = std::max(mMax, value);
+    ++mCount;
+
+    mUnmerged.push_back(value);
+    if (mUnmerged.size() >= static_cast<size_t>(5.0 * mCompression)) {
+        Merge();
+    }
+}
+
+size_t TDigest::GetCentroidCount() const
+{
+    Merge();
+    return mCentroids.size();
+}
+
+void TDigest::Merge() const
+{
+    if (mUnmerged.empty()) {
+        return;
+    }
+
+    std::vector<Centroid> all = mCentroids;
+    all.reserve(all.size() + mUnmerged.size());
+    for (double value : mUnmerged) {
+        all.push_back({value, 1.0});
+    }
+    mUnmerged.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid& lhs, const Centroid& rhs) { return lhs.mean < rhs.mean; });
+
+    // Scale function k1: centroids may only span one unit of k, which keeps
+    // them small where the slope of asin is steep (the tails).
+    const double totalWeight = static_cast<double>(mCount);
+    const double kScale      = mCompression / (2.0 * 3.14159265358979323846);
+    auto         k           = [kScale](double q) { return kScale * std::asin(2.0 * std::min(std::max(q, 0.0), 1.0) - 1.0); };
+
+    mCentroids.clear();
+    Centroid current     = all[0];
+    double   weightSoFar = 0.0;
+    double   kLeft       = k(0.0);
+    for (size_t i = 1; i < all.size(); ++i) {
+        const Centroid& next   = all[i];
+        const double    kRight = k((weightSoFar + current.weight + next.weight) / totalWeight);
+        if ((kRight - kLeft) <= 1.0) {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        }
+        else {
+            mCentroids.push_back(current);
+            weightSoFar += current.weight;
+            kLeft   = k(weightSoFar / totalWeight);
+            current = next;
+        }
+    }
+    mCentroids.push_back(current);
+}
+
+double TDigest::Quantile(double q) const
+{
+    if (mCount == 0) {
+        return 0.0;
+    }
+    Merge();
+
+    q = std::min(std::max(q, 0.0), 1.0);
+    if (mCentroids.size() == 1) {
+        return mCentroids[0].mean;
+    }
+
+    // Each centroid's mean is treated as sitting at the center of its
+    // weight, values between centers are linearly interpolated.
+    const double target = q * static_cast<double>(mCount);
+
+    const Centroid& first = mCentroids.front();
+    if (target < (first.weight / 2.0)) {
+        return mMin + (first.mean - mMin) * (target / (first.weight / 2.0));
+    }
+
+    const Centroid& last = mCentroids.back();
+    if (target > (static_cast<double>(mCount) - last.weight / 2.0)) {
+        const double t = (target - (static_cast<double>(mCount) - last.weight / 2.0)) / (last.weight / 2.0);
+        return last.mean + (mMax - last.mean) * t;
+    }
+
+    double weightSoFar = 0.0;
+    for (size_t i = 0; i + 1 < mCentroids.size(); ++i) {
+        const Centroid& lhs       = mCentroids[i];
+        const Centroid& rhs       = mCentroids[i + 1];
+        const double    lhsCenter = weightSoFar + lhs.weight / 2.0;
+        const double    rhsCenter = weightSoFar + lhs.weight + rhs.weight / 2.0;
+        if (target <= rhsCenter) {
+            const double t = (target - lhsCenter) / (rhsCenter - lhsCenter);
+            return lhs.mean + (rhs.mean - lhs.mean) * t;
+        }
+        weightSoFar += lhs.weight;
+    }
+    return mMax;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool MetricGauge::RecordEntry(const MetricData& data)
 {
     if (data.type != MetricType::GAUGE) {
@@ -49,8 +158,8 @@ bool MetricGauge::RecordEntry(const MetricData& data)
         return false;
     }
 
-    auto entryCount = mTimeSeries.size();
-    if (entryCount > 0 && data.gauge.seconds <= mTimeSeries.back().seconds) {
+    auto entryCount = mEntryCount;
+    if (entryCount > 0 && data.gauge.seconds <= mLastSeconds) {
         PPX_LOG_ERROR("Provided gauge metric had old seconds value; ignoring.");
         return false;
     }
@@ -61,6 +170,12 @@ bool MetricGauge::RecordEntry(const MetricData& data)
     // This entry will be added at the end; update the count now for calculations.
     ++entryCount;
 
+    if (entryCount == 1) {
+        mFirstSeconds = entry.seconds;
+    }
+    mLastSeconds = entry.seconds;
+    mEntryCount  = entryCount;
+
     // Update the basic stats.
     mAccumulatedValue += entry.value;
     mBasicStats.min     = std::min(mBasicStats.min, entry.value);
@@ -68,18 +183,92 @@ bool MetricGauge::RecordEntry(const MetricData& data)
     mBasicStats.average = mAccumulatedValue / entryCount;
     // Above checks guarantee the 'seconds' field monotonically increases with each entry.
     mBasicStats.timeRatio = (entryCount > 1)
-                                ? mAccumulatedValue / (entry.seconds - mTimeSeries.front().seconds)
+                                ? mAccumulatedValue / (entry.seconds - mFirstSeconds)
                                 : entry.value;
 
+    if (mMetadata.gaugeMode == GaugeMode::STREAMING) {
+        RecordStreamingEntry(entry);
+        return true;
+    }
+
     mTimeSeries.emplace_back(std::move(entry));
     return true;
 }
 
+void MetricGauge::RecordStreamingEntry(const TimeSeriesEntry& entry)
+{
+    mDigest.Add(entry.value);
+
+    // Welford's algorithm, stable for long runs unlike a running sum of squares
+    const double delta = entry.value - mWelfordMean;
+    mWelfordMean += delta / static_cast<double>(mEntryCount);
+    mWelfordM2 += delta * (entry.value - mWelfordMean);
+
+    const size_t capacity = mMetadata.timeSeriesCapacity;
+    if (capacity == 0) {
+        return;
+    }
+
+    mBucketSum.seconds += entry.seconds;
+    mBucketSum.value += entry.value;
+    ++mBucketCount;
+    if (mBucketCount < mBucketSize) {
+        return;
+    }
+
+    const double count = static_cast<double>(mBucketCount);
+    mTimeSeries.push_back({mBucketSum.seconds / count, mBucketSum.value / count});
+    mBucketSum   = {0.0, 0.0};
+    mBucketCount = 0;
+
+    if (mTimeSeries.size() <= capacity) {
+        return;
+    }
+
+    // Average adjacent pairs and double the bucket size. A leftover entry
+    // becomes the start of the next bucket.
+    const size_t pairCount = mTimeSeries.size() / 2;
+    for (size_t i = 0; i < pairCount; ++i) {
+        const TimeSeriesEntry& lhs = mTimeSeries[2 * i];
+        const TimeSeriesEntry& rhs = mTimeSeries[2 * i + 1];
+        mTimeSeries[i]             = {(lhs.seconds + rhs.seconds) * 0.5, (lhs.value + rhs.value) * 0.5};
+    }
+    if ((mTimeSeries.size() % 2) != 0) {
+        const TimeSeriesEntry& leftover = mTimeSeries.back();
+        mBucketSum                      = {leftover.seconds * mBucketSize, leftover.value * mBucketSize};
+        mBucketCount                    = mBucketSize;
+    }
+    mTimeSeries.resize(pairCount);
+    mBucketSize *= 2;
+}
+
+std::vector<MetricGauge::TimeSeriesEntry> MetricGauge::GetExportedTimeSeries() const
+{
+    std::vector<TimeSeriesEntry> timeSeries = mTimeSeries;
+    if (mBucketCount > 0) {
+        const double count = static_cast<double>(mBucketCount);
+        timeSeries.push_back({mBucketSum.seconds / count, mBucketSum.value / count});
+    }
+    return timeSeries;
+}
+
 ppx::metrics::GaugeComplexStatistics MetricGauge::ComputeComplexStats() const
 {
     GaugeComplexStatistics complex;
     size_t                 entryCount = mTimeSeries.size();
-    if (entryCount == 0) {
+    if (mEntryCount == 0) {
+        return complex;
+    }
+
+    if (mMetadata.gaugeMode == GaugeMode::STREAMING) {
+        complex.median            = mDigest.Quantile(0.50);
+        complex.standardDeviation = std::sqrt(mWelfordM2 / static_cast<double>(mEntryCount));
+        complex.percentile01      = mDigest.Quantile(0.01);
+        complex.percentile05      = mDigest.Quantile(0.05);
+        complex.percentile10      = mDigest.Quantile(0.10);
+        complex.percentile90      = mDigest.Quantile(0.90);
+        complex.percentile95      = mDigest.Quantile(0.95);
+        complex.percentile99      = mDigest.Quantile(0.99);
         return complex;
     }
 
@@ -137,7 +326,7 @@ nlohmann::json MetricGauge::Export() const
     metricObject["statistics"] = statsObject;
 
     metricObject["time_series"] = nlohmann::json::array();
-    for (const auto& entry : mTimeSeries) {
+    for (const auto& entry : GetExportedTimeSeries()) {
         metricObject["time_series"] += nlohmann::json::array({entry.seconds, entry.value});
     }
 
@@ -132,8 +132,8 @@ Mipmap::Mipmap(const Bitmap& bitmap, uint32_t levelCount, bool useStaticPool)
         if ((srcSize > 0) && (srcSize == dstSize) && !IsNull(pSrcData) && !IsNull(pDstData)) {
             memcpy(pDstData, pSrcData, srcSize);
 
-            // Generate mip
-            for (uint32_t level = 1; level < levelCount; ++level) {
+            // Generate mip, each level is split across threads by ScaleTo
+            for (uint32_t level = 1; level < GetLevelCount(); ++level) {
                 uint32_t prevLevel = level - 1;
                 Bitmap*  pPrevMip  = GetMip(prevLevel);
                 Bitmap*  pMip      = GetMip(level);
@@ -248,11 +248,20 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
         return ppx::ERROR_BITMAP_FOOTPRINT_MISMATCH;
     }
 
-    // Load file
-    auto fileBytes = ppx::fs::load_file(path);
-    if (!fileBytes.has_value()) {
+    // Load file, decoding straight from the mapping when possible
+    ppx::fs::File file;
+    if (!file.Open(path)) {
         return ppx::ERROR_IMAGE_FILE_LOAD_FAILED;
     }
+    std::vector<char> fileBytes;
+    if (!file.IsMapped()) {
+        fileBytes.resize(file.GetLength());
+        if (file.Read(fileBytes.data(), fileBytes.size()) != fileBytes.size()) {
+            return ppx::ERROR_IMAGE_FILE_LOAD_FAILED;
+        }
+    }
+    const stbi_uc* pFileData = file.IsMapped() ? static_cast<const stbi_uc*>(file.GetMappedData()) : reinterpret_cast<const stbi_uc*>(fileBytes.data());
+    const int      fileSize  = static_cast<int>(file.GetLength());
 
     // Load bitmap
     void* pStbiData            = nullptr;
@@ -262,8 +271,8 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
     int   stbiRequiredChannels = 4; // Force to 4 chanenls to make things easier for the graphics APIs
     if (Bitmap::ChannelDataType(format) == Bitmap::DATA_TYPE_UINT8) {
         pStbiData = stbi_load_from_memory(
-            reinterpret_cast<const stbi_uc*>(fileBytes.value().data()),
-            static_cast<int>(fileBytes.value().size()),
+            pFileData,
+            fileSize,
             &stbiWidth,
             &stbiHeight,
             &stbiChannels,
@@ -271,8 +280,8 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
     }
     else if (Bitmap::ChannelDataType(format) == Bitmap::DATA_TYPE_FLOAT) {
         pStbiData = stbi_loadf_from_memory(
-            reinterpret_cast<const stbi_uc*>(fileBytes.value().data()),
-            static_cast<int>(fileBytes.value().size()),
+            pFileData,
+            fileSize,
             &stbiWidth,
             &stbiHeight,
             &stbiChannels,
@@ -13,9 +13,23 @@
 // limitations under the License.
 
 #include "ppx/ppm_export.h"
+#include "ppx/thread_pool.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 
+#if defined(__SSSE3__)
+#define PPX_PPM_EXPORT_SSSE3
+#include <tmmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PPX_PPM_EXPORT_NEON
+#include <arm_neon.h>
+#endif
+
 namespace ppx {
 
 unsigned char ConvertToUint(const char* value, grfx::FormatDataType dataType)
@@ -44,45 +58,316 @@ bool IsOptimalFormat(const grfx::FormatDesc* desc, uint32_t width, uint32_t rowS
            (desc->dataType == grfx::FORMAT_DATA_TYPE_UINT || desc->dataType == grfx::FORMAT_DATA_TYPE_UNORM || desc->dataType == grfx::FORMAT_DATA_TYPE_SRGB);
 }
 
-Result ExportToPPM(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+// -------------------------------------------------------------------------------------------------
+// Row conversion to RGB8
+// -------------------------------------------------------------------------------------------------
+namespace {
+
+// Rows per band when splitting conversion and compression across threads
+constexpr uint32_t kRowsPerBand = 64;
+// Below this many pixels threading costs more than it saves
+constexpr uint64_t kMinThreadedPixels = 256 * 256;
+
+using ConvertRowFn = void (*)(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst);
+
+bool IsUnsigned8(const grfx::FormatDesc* desc)
 {
-    std::filesystem::create_directories(std::filesystem::path(outputFilename).parent_path());
-    std::ofstream file(outputFilename, std::ios::out | std::ios::binary | std::ios::trunc);
-    ppx::Result   result = ExportToPPM(file, inputFormat, texels, width, height, rowStride);
-    file.close();
-    return result;
+    return (desc->bytesPerComponent == 1) &&
+           (desc->dataType == grfx::FORMAT_DATA_TYPE_UINT || desc->dataType == grfx::FORMAT_DATA_TYPE_UNORM || desc->dataType == grfx::FORMAT_DATA_TYPE_SRGB);
 }
 
-Result ExportToPPM(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+void ConvertRowRGB8(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst)
 {
-    if (width == 0 || height == 0) {
-        return ERROR_PPM_EXPORT_INVALID_SIZE;
+    std::memcpy(dst, src, 3 * static_cast<size_t>(width));
+}
+
+// RGBA8 and BGRA8, which covers every swapchain format. The alpha byte is
+// dropped and red and blue are swapped when kSwapRB is true.
+template <bool kSwapRB>
+void ConvertRowRGBA8(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst)
+{
+    uint32_t x = 0;
+#if defined(PPX_PPM_EXPORT_SSSE3)
+    // 16 source texels become 48 bytes, written as three 16 byte stores
+    // from four 12 byte shuffles.
+    const __m128i shuffle = kSwapRB ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+                                    : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (; (x + 16) <= width; x += 16) {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x + 0)), shuffle);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x + 16)), shuffle);
+        __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x + 32)), shuffle);
+        __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x + 48)), shuffle);
+        // a = a0..a11, b = b0..b11, c = c0..c11, d = d0..d11
+        __m128i out0 = _mm_or_si128(a, _mm_slli_si128(b, 12));
+        __m128i out1 = _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8));
+        __m128i out2 = _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * x + 0), out0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * x + 16), out1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * x + 32), out2);
     }
+#elif defined(PPX_PPM_EXPORT_NEON)
+    for (; (x + 16) <= width; x += 16) {
+        uint8x16x4_t rgba = vld4q_u8(src + 4 * x);
+        uint8x16x3_t rgb;
+        rgb.val[0] = kSwapRB ? rgba.val[2] : rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = kSwapRB ? rgba.val[0] : rgba.val[2];
+        vst3q_u8(dst + 3 * x, rgb);
+    }
+#endif
+    // Four texels at a time as 32-bit words: three stores instead of twelve
+    for (; (x + 4) <= width; x += 4) {
+        uint32_t t[4];
+        std::memcpy(t, src + 4 * x, sizeof(t));
+        if (kSwapRB) {
+            for (uint32_t i = 0; i < 4; ++i) {
+                t[i] = ((t[i] & 0xFF) << 16) | (t[i] & 0xFF00) | ((t[i] >> 16) & 0xFF);
+            }
+        }
+        // Little endian: drop the high byte of each texel and pack the rest
+        uint32_t w[3];
+        w[0] = (t[0] & 0x00FFFFFF) | (t[1] << 24);
+        w[1] = ((t[1] >> 8) & 0x0000FFFF) | (t[2] << 16);
+        w[2] = ((t[2] >> 16) & 0x000000FF) | (t[3] << 8);
+        std::memcpy(dst + 3 * x, w, sizeof(w));
+    }
+    for (; x < width; ++x) {
+        dst[3 * x + 0] = src[4 * x + (kSwapRB ? 2 : 0)];
+        dst[3 * x + 1] = src[4 * x + 1];
+        dst[3 * x + 2] = src[4 * x + (kSwapRB ? 0 : 2)];
+    }
+}
 
-    const grfx::FormatDesc* desc = grfx::GetFormatDescription(inputFormat);
+// Any other 8-bit color format, one texel at a time
+void ConvertRowGeneric8(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst)
+{
+    const bool hasRed   = (desc->componentBits & grfx::FORMAT_COMPONENT_RED) != 0;
+    const bool hasGreen = (desc->componentBits & grfx::FORMAT_COMPONENT_GREEN) != 0;
+    const bool hasBlue  = (desc->componentBits & grfx::FORMAT_COMPONENT_BLUE) != 0;
+    for (uint32_t x = 0; x < width; ++x) {
+        const char* texel = reinterpret_cast<const char*>(src);
+        dst[0]            = hasRed ? ConvertToUint(texel + desc->componentOffset.red, desc->dataType) : 0;
+        dst[1]            = hasGreen ? ConvertToUint(texel + desc->componentOffset.green, desc->dataType) : 0;
+        dst[2]            = hasBlue ? ConvertToUint(texel + desc->componentOffset.blue, desc->dataType) : 0;
+        src += desc->bytesPerTexel;
+        dst += 3;
+    }
+}
 
-    // We don't support compressed or packed formats.
+// Half float to UNORM8 for every possible half: negative values and NaN
+// become 0, values above 1 become 255.
+const uint8_t* GetHalfToUnorm8Table()
+{
+    static const std::vector<uint8_t> sTable = []() {
+        std::vector<uint8_t> table(65536);
+        for (uint32_t h = 0; h < 65536; ++h) {
+            const uint32_t exponent = (h >> 10) & 0x1F;
+            const uint32_t mantissa = h & 0x3FF;
+            float          value    = 0;
+            if (exponent == 0) {
+                value = std::ldexp(static_cast<float>(mantissa), -24);
+            }
+            else if (exponent < 31) {
+                value = std::ldexp(static_cast<float>(mantissa | 0x400), static_cast<int>(exponent) - 25);
+            }
+            else {
+                value = (mantissa == 0) ? 1.0f : 0.0f;
+            }
+            if ((h & 0x8000) != 0) {
+                value = 0;
+            }
+            table[h] = static_cast<uint8_t>(std::min(value, 1.0f) * 255.0f + 0.5f);
+        }
+        return table;
+    }();
+    return sTable.data();
+}
+
+// 16-bit float color formats, R16_FLOAT to R16G16B16A16_FLOAT
+void ConvertRowHalf(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst)
+{
+    const uint8_t* table  = GetHalfToUnorm8Table();
+    const int32_t  offR   = (desc->componentBits & grfx::FORMAT_COMPONENT_RED) ? desc->componentOffset.red : -1;
+    const int32_t  offG   = (desc->componentBits & grfx::FORMAT_COMPONENT_GREEN) ? desc->componentOffset.green : -1;
+    const int32_t  offB   = (desc->componentBits & grfx::FORMAT_COMPONENT_BLUE) ? desc->componentOffset.blue : -1;
+    auto           lookup = [table](const uint8_t* texel, int32_t offset) -> uint8_t {
+        if (offset < 0) {
+            return 0;
+        }
+        uint16_t h = 0;
+        std::memcpy(&h, texel + offset, sizeof(h));
+        return table[h];
+    };
+    for (uint32_t x = 0; x < width; ++x) {
+        dst[0] = lookup(src, offR);
+        dst[1] = lookup(src, offG);
+        dst[2] = lookup(src, offB);
+        src += desc->bytesPerTexel;
+        dst += 3;
+    }
+}
+
+// R10G10B10A2_UNORM with red in the low bits, which is how grfx and DXGI
+// name it (Vulkan calls the same layout A2B10G10R10).
+void ConvertRowRGB10A2(const grfx::FormatDesc* desc, const uint8_t* src, uint32_t width, uint8_t* dst)
+{
+    static const std::vector<uint8_t> sTable = []() {
+        std::vector<uint8_t> table(1024);
+        for (uint32_t v = 0; v < 1024; ++v) {
+            table[v] = static_cast<uint8_t>((v * 255 + 511) / 1023);
+        }
+        return table;
+    }();
+    const uint8_t* table = sTable.data();
+    for (uint32_t x = 0; x < width; ++x) {
+        uint32_t texel = 0;
+        std::memcpy(&texel, src + 4 * x, sizeof(texel));
+        dst[3 * x + 0] = table[texel & 0x3FF];
+        dst[3 * x + 1] = table[(texel >> 10) & 0x3FF];
+        dst[3 * x + 2] = table[(texel >> 20) & 0x3FF];
+    }
+}
+
+// Returns nullptr if the format can't be converted
+ConvertRowFn SelectRowConverter(grfx::Format format, const grfx::FormatDesc* desc)
+{
+    if (format == grfx::FORMAT_R10G10B10A2_UNORM) {
+        return ConvertRowRGB10A2;
+    }
+    // We don't support compressed or other packed formats.
     if (desc->layout != grfx::FORMAT_LAYOUT_LINEAR) {
-        return ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED;
+        return nullptr;
     }
-    // We don't support FLOAT formats.
+    // We only support color formats.
+    if ((desc->componentBits & grfx::FORMAT_COMPONENT_RED_GREEN_BLUE) == 0) {
+        return nullptr;
+    }
+    // The format table lists 2 bytes per component for the 32-bit float
+    // formats too, so check for the half formats by name.
     if (desc->dataType == grfx::FORMAT_DATA_TYPE_FLOAT) {
-        return ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED;
+        switch (format) {
+            case grfx::FORMAT_R16_FLOAT:
+            case grfx::FORMAT_R16G16_FLOAT:
+            case grfx::FORMAT_R16G16B16_FLOAT:
+            case grfx::FORMAT_R16G16B16A16_FLOAT: return ConvertRowHalf;
+            default: return nullptr;
+        }
+    }
+    if (desc->bytesPerComponent != 1) {
+        return nullptr;
     }
 
-    // We only support color formats for now.
-    // The alpha channel, if present, is ignored, as the PPM file format
-    // does not support transparency.
-    auto rgbMask = grfx::FORMAT_COMPONENT_RED_GREEN_BLUE;
-    if ((desc->componentBits & rgbMask) == 0) {
-        return ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED;
+    if (IsUnsigned8(desc) && (desc->componentBits == grfx::FORMAT_COMPONENT_RED_GREEN_BLUE) && (desc->bytesPerTexel == 3) &&
+        (desc->componentOffset.red == 0) && (desc->componentOffset.green == 1) && (desc->componentOffset.blue == 2)) {
+        return ConvertRowRGB8;
     }
-    // We only support 8-bit formats.
-    if (desc->bytesPerComponent != 1) {
+    if (IsUnsigned8(desc) && (desc->componentBits == grfx::FORMAT_COMPONENT_RED_GREEN_BLUE_ALPHA) && (desc->bytesPerTexel == 4) &&
+        (desc->componentOffset.green == 1) && (desc->componentOffset.alpha == 3)) {
+        if ((desc->componentOffset.red == 0) && (desc->componentOffset.blue == 2)) {
+            return ConvertRowRGBA8<false>;
+        }
+        if ((desc->componentOffset.red == 2) && (desc->componentOffset.blue == 0)) {
+            return ConvertRowRGBA8<true>;
+        }
+    }
+    return ConvertRowGeneric8;
+}
+
+// Calls fn(band, y0, y1) for each band of kRowsPerBand rows, on the
+// default ThreadPool if the image is large enough.
+template <typename Fn>
+void ForEachBand(uint32_t width, uint32_t height, const Fn& fn)
+{
+    auto bandFn = [&fn, height](uint32_t band) {
+        uint32_t y0 = band * kRowsPerBand;
+        uint32_t y1 = std::min(y0 + kRowsPerBand, height);
+        fn(band, y0, y1);
+    };
+
+    const uint32_t bandCount  = (height + kRowsPerBand - 1) / kRowsPerBand;
+    const uint64_t pixelCount = static_cast<uint64_t>(width) * height;
+    if ((bandCount == 1) || (pixelCount < kMinThreadedPixels)) {
+        for (uint32_t band = 0; band < bandCount; ++band) {
+            bandFn(band);
+        }
+        return;
+    }
+    ThreadPool::GetDefault().ParallelFor(bandCount, bandFn);
+}
+
+Result ValidateAndSelect(grfx::Format inputFormat, uint32_t width, uint32_t height, uint32_t rowStride, ConvertRowFn* pConvertRow)
+{
+    if (width == 0 || height == 0) {
+        return ERROR_PPM_EXPORT_INVALID_SIZE;
+    }
+
+    const grfx::FormatDesc* desc = grfx::GetFormatDescription(inputFormat);
+    *pConvertRow                 = SelectRowConverter(inputFormat, desc);
+    if (*pConvertRow == nullptr) {
         return ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED;
     }
 
     PPX_ASSERT_MSG(rowStride >= desc->bytesPerTexel * width, "row stride must be at least equal to texel size * width");
+    return SUCCESS;
+}
+
+void ConvertRows(grfx::Format inputFormat, ConvertRowFn convertRow, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride, std::vector<uint8_t>* pOutput)
+{
+    const grfx::FormatDesc* desc     = grfx::GetFormatDescription(inputFormat);
+    const size_t            dstPitch = 3 * static_cast<size_t>(width);
+    pOutput->resize(dstPitch * height);
+
+    const uint8_t* pSrc = static_cast<const uint8_t*>(texels);
+    uint8_t*       pDst = pOutput->data();
+    ForEachBand(width, height, [=](uint32_t band, uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; ++y) {
+            convertRow(desc, pSrc + static_cast<size_t>(y) * rowStride, width, pDst + y * dstPitch);
+        }
+    });
+}
+
+void WriteBigEndian32(uint32_t value, uint8_t* dst)
+{
+    dst[0] = static_cast<uint8_t>(value >> 24);
+    dst[1] = static_cast<uint8_t>(value >> 16);
+    dst[2] = static_cast<uint8_t>(value >> 8);
+    dst[3] = static_cast<uint8_t>(value);
+}
+
+} // namespace
+
+Result ConvertToRGB8(grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride, std::vector<uint8_t>* pOutput)
+{
+    PPX_ASSERT_NULL_ARG(pOutput);
+
+    ConvertRowFn convertRow = nullptr;
+    Result       ppxres     = ValidateAndSelect(inputFormat, width, height, rowStride, &convertRow);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    ConvertRows(inputFormat, convertRow, texels, width, height, rowStride, pOutput);
+    return SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// PPM
+// -------------------------------------------------------------------------------------------------
+Result ExportToPPM(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::filesystem::create_directories(std::filesystem::path(outputFilename).parent_path());
+    std::ofstream file(outputFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    ppx::Result   result = ExportToPPM(file, inputFormat, texels, width, height, rowStride);
+    file.close();
+    return result;
+}
+
+Result ExportToPPM(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    ConvertRowFn convertRow = nullptr;
+    Result       ppxres     = ValidateAndSelect(inputFormat, width, height, rowStride, &convertRow);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
 
     // PPM format specification: http://netpbm.sourceforge.net/doc/ppm.html.
     outputStream << "P6\n"
@@ -90,50 +375,599 @@ Result ExportToPPM(std::ostream& outputStream, grfx::Format inputFormat, const v
                  << height << "\n"
                  << 255 << "\n";
 
-    // This is a naive implementation, and favors flexibility over performance
-    // with the aim to support as many format variations as possible.
-    // We only optimize for the best possible scenario, and fall back to the
-    // generic implemention in other cases.
-    if (IsOptimalFormat(desc, width, rowStride)) {
+    // Tightly packed RGB8 is written as is, everything else is converted
+    // to RGB8 first so that the stream sees a single write.
+    if (IsOptimalFormat(grfx::GetFormatDescription(inputFormat), width, rowStride)) {
         outputStream.write((const char*)texels, static_cast<std::streamsize>(rowStride) * height);
         return SUCCESS;
     }
 
-    char        zero = 0;
-    const char* data = (const char*)texels;
-    for (uint32_t y = 0; y < height; y++) {
-        const char* row = data;
-        for (uint32_t x = 0; x < width; x++) {
-            if (desc->componentBits & grfx::FORMAT_COMPONENT_RED) {
-                unsigned char red = ConvertToUint(row + desc->componentOffset.red, desc->dataType);
-                outputStream.write((const char*)&red, 1);
+    std::vector<uint8_t> rgb;
+    ConvertRows(inputFormat, convertRow, texels, width, height, rowStride, &rgb);
+    outputStream.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+
+    return SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// QOI
+// -------------------------------------------------------------------------------------------------
+//
+// QOI format specification: https://qoiformat.org/qoi-specification.pdf.
+//
+// A QOI stream can't be split, every chunk depends on the previous pixel
+// and on a 64 entry table of recently seen pixels. To encode bands
+// independently each band starts with a full QOI_OP_RGB, ends any pending
+// run and only emits QOI_OP_INDEX for table entries it wrote itself. Those
+// entries hold the same pixel in the decoder's table no matter what came
+// before the band, so the concatenated bands decode as one stream.
+//
+namespace {
+
+constexpr uint8_t kQoiOpIndex = 0x00;
+constexpr uint8_t kQoiOpDiff  = 0x40;
+constexpr uint8_t kQoiOpLuma  = 0x80;
+constexpr uint8_t kQoiOpRun   = 0xC0;
+constexpr uint8_t kQoiOpRgb   = 0xFE;
+
+constexpr uint32_t kQoiMaxRun = 62;
+
+void EncodeQoiBand(const uint8_t* pixels, size_t pixelCount, std::vector<uint8_t>* pOut)
+{
+    std::vector<uint8_t>& out = *pOut;
+    out.reserve(pixelCount * 2);
+
+    uint32_t table[64]  = {};
+    uint64_t validSlots = 0;
+    uint32_t run        = 0;
+    uint8_t  prev[3]    = {};
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const uint8_t* px = pixels + 3 * i;
+        if ((i > 0) && (px[0] == prev[0]) && (px[1] == prev[1]) && (px[2] == prev[2])) {
+            ++run;
+            if (run == kQoiMaxRun) {
+                out.push_back(kQoiOpRun | static_cast<uint8_t>(run - 1));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(kQoiOpRun | static_cast<uint8_t>(run - 1));
+            run = 0;
+        }
+
+        // Alpha is always 255 for 3 channel images
+        const uint32_t slot  = (px[0] * 3 + px[1] * 5 + px[2] * 7 + 255 * 11) % 64;
+        const uint32_t value = px[0] | (px[1] << 8) | (px[2] << 16);
+        if ((((validSlots >> slot) & 1) != 0) && (table[slot] == value)) {
+            out.push_back(kQoiOpIndex | static_cast<uint8_t>(slot));
+        }
+        else {
+            table[slot] = value;
+            validSlots |= (1ull << slot);
+
+            const int8_t dr   = static_cast<int8_t>(px[0] - prev[0]);
+            const int8_t dg   = static_cast<int8_t>(px[1] - prev[1]);
+            const int8_t db   = static_cast<int8_t>(px[2] - prev[2]);
+            const int8_t drdg = static_cast<int8_t>(dr - dg);
+            const int8_t dbdg = static_cast<int8_t>(db - dg);
+            if ((i > 0) && (dr >= -2) && (dr <= 1) && (dg >= -2) && (dg <= 1) && (db >= -2) && (db <= 1)) {
+                out.push_back(kQoiOpDiff | static_cast<uint8_t>(((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+            }
+            else if ((i > 0) && (dg >= -32) && (dg <= 31) && (drdg >= -8) && (drdg <= 7) && (dbdg >= -8) && (dbdg <= 7)) {
+                out.push_back(kQoiOpLuma | static_cast<uint8_t>(dg + 32));
+                out.push_back(static_cast<uint8_t>(((drdg + 8) << 4) | (dbdg + 8)));
             }
             else {
-                outputStream.write(&zero, 1);
+                out.push_back(kQoiOpRgb);
+                out.push_back(px[0]);
+                out.push_back(px[1]);
+                out.push_back(px[2]);
             }
+        }
+        prev[0] = px[0];
+        prev[1] = px[1];
+        prev[2] = px[2];
+    }
+    if (run > 0) {
+        out.push_back(kQoiOpRun | static_cast<uint8_t>(run - 1));
+    }
+}
+
+} // namespace
 
-            if (desc->componentBits & grfx::FORMAT_COMPONENT_GREEN) {
-                unsigned char green = ConvertToUint(row + desc->componentOffset.green, desc->dataType);
-                outputStream.write((const char*)&green, 1);
+Result ExportToQOI(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::filesystem::create_directories(std::filesystem::path(outputFilename).parent_path());
+    std::ofstream file(outputFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    ppx::Result   result = ExportToQOI(file, inputFormat, texels, width, height, rowStride);
+    file.close();
+    return result;
+}
+
+Result ExportToQOI(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::vector<uint8_t> rgb;
+    Result               ppxres = ConvertToRGB8(inputFormat, texels, width, height, rowStride, &rgb);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    const uint32_t                    bandCount = (height + kRowsPerBand - 1) / kRowsPerBand;
+    std::vector<std::vector<uint8_t>> bands(bandCount);
+    ForEachBand(width, height, [&](uint32_t band, uint32_t y0, uint32_t y1) {
+        const size_t first = static_cast<size_t>(y0) * width;
+        const size_t count = static_cast<size_t>(y1 - y0) * width;
+        EncodeQoiBand(rgb.data() + 3 * first, count, &bands[band]);
+    });
+
+    // Header: magic, width, height, channels and colorspace (sRGB)
+    uint8_t header[14] = {'q', 'o', 'i', 'f'};
+    WriteBigEndian32(width, header + 4);
+    WriteBigEndian32(height, header + 8);
+    header[12] = 3;
+    header[13] = 0;
+    outputStream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    for (const auto& band : bands) {
+        outputStream.write(reinterpret_cast<const char*>(band.data()), static_cast<std::streamsize>(band.size()));
+    }
+
+    const uint8_t endMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    outputStream.write(reinterpret_cast<const char*>(endMarker), sizeof(endMarker));
+
+    return SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// PNG
+// -------------------------------------------------------------------------------------------------
+//
+// PNG format specification: https://www.w3.org/TR/png/.
+// Deflate format specification: https://www.rfc-editor.org/rfc/rfc1951.
+//
+// Each band is filtered and deflated on its own and written as one IDAT
+// chunk. Bands other than the last one end with an empty stored block
+// (a zlib sync flush) so the next band starts on a byte boundary, and
+// matches never reach back into a previous band. The Adler-32 checksums
+// of the bands are combined for the zlib trailer.
+//
+namespace {
+
+constexpr uint32_t kDeflateMinMatch      = 3;
+constexpr uint32_t kDeflateMaxMatch      = 258;
+constexpr uint32_t kDeflateWindowSize    = 32768;
+constexpr uint32_t kDeflateHashBits      = 15;
+constexpr uint32_t kDeflateMaxChainDepth = 16;
+
+constexpr uint32_t kAdlerBase = 65521;
+
+const uint16_t kDeflateLengthBase[29]   = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t  kDeflateLengthExtra[29]  = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDeflateDistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+
+// Fixed Huffman codes from RFC 1951 section 3.2.6, bit reversed since
+// Huffman codes are packed starting with their most significant bit.
+struct FixedCode
+{
+    uint16_t bits   = 0;
+    uint16_t length = 0;
+};
+
+struct FixedCodes
+{
+    FixedCode symbols[288];
+    uint16_t  distances[30];
+};
+
+uint16_t ReverseBits(uint32_t code, uint32_t length)
+{
+    uint32_t reversed = 0;
+    for (uint32_t i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    return static_cast<uint16_t>(reversed);
+}
+
+const FixedCodes& GetFixedCodes()
+{
+    static const FixedCodes sCodes = []() {
+        FixedCodes codes = {};
+        for (uint32_t symbol = 0; symbol < 288; ++symbol) {
+            uint32_t code   = 0;
+            uint32_t length = 0;
+            if (symbol < 144) {
+                code   = 0x30 + symbol;
+                length = 8;
+            }
+            else if (symbol < 256) {
+                code   = 0x190 + symbol - 144;
+                length = 9;
+            }
+            else if (symbol < 280) {
+                code   = symbol - 256;
+                length = 7;
             }
             else {
-                outputStream.write(&zero, 1);
+                code   = 0xC0 + symbol - 280;
+                length = 8;
+            }
+            codes.symbols[symbol].bits   = ReverseBits(code, length);
+            codes.symbols[symbol].length = static_cast<uint16_t>(length);
+        }
+        for (uint32_t i = 0; i < 30; ++i) {
+            codes.distances[i] = ReverseBits(i, 5);
+        }
+        return codes;
+    }();
+    return sCodes;
+}
+
+class DeflateBitWriter
+{
+public:
+    DeflateBitWriter(std::vector<uint8_t>* pOut)
+        : mOut(pOut) {}
+
+    void Write(uint32_t bits, uint32_t count)
+    {
+        mBits |= static_cast<uint64_t>(bits) << mCount;
+        mCount += count;
+        while (mCount >= 8) {
+            mOut->push_back(static_cast<uint8_t>(mBits));
+            mBits >>= 8;
+            mCount -= 8;
+        }
+    }
+
+    // Fixed Huffman code for a literal/length symbol
+    void WriteSymbol(uint32_t symbol)
+    {
+        const FixedCode& code = GetFixedCodes().symbols[symbol];
+        Write(code.bits, code.length);
+    }
+
+    void WriteMatch(uint32_t length, uint32_t distance)
+    {
+        static const std::vector<uint8_t> sLengthCodes = []() {
+            std::vector<uint8_t> codes(kDeflateMaxMatch + 1, 0);
+            for (uint32_t code = 0; code < 29; ++code) {
+                const uint32_t end = (code < 28) ? kDeflateLengthBase[code + 1] : (kDeflateMaxMatch + 1);
+                for (uint32_t i = kDeflateLengthBase[code]; i < end; ++i) {
+                    codes[i] = static_cast<uint8_t>(code);
+                }
             }
+            return codes;
+        }();
+        const uint32_t lengthCode = sLengthCodes[length];
+        WriteSymbol(257 + lengthCode);
+        Write(length - kDeflateLengthBase[lengthCode], kDeflateLengthExtra[lengthCode]);
 
-            if (desc->componentBits & grfx::FORMAT_COMPONENT_BLUE) {
-                unsigned char blue = ConvertToUint(row + desc->componentOffset.blue, desc->dataType);
-                outputStream.write((const char*)&blue, 1);
+        // Distance codes come in pairs per power of two above 4, the second
+        // code of a pair covers the upper half of the range
+        uint32_t distanceCode = distance - 1;
+        if (distanceCode >= 4) {
+            uint32_t log2 = 2;
+            while ((distanceCode >> (log2 + 1)) != 0) {
+                ++log2;
             }
-            else {
-                outputStream.write(&zero, 1);
+            distanceCode = 2 * log2 + ((distanceCode >> (log2 - 1)) & 1);
+        }
+        Write(GetFixedCodes().distances[distanceCode], 5);
+        const uint32_t extra = (distanceCode < 4) ? 0 : (distanceCode / 2 - 1);
+        Write(distance - kDeflateDistanceBase[distanceCode], extra);
+    }
+
+    void AlignToByte()
+    {
+        if (mCount > 0) {
+            Write(0, 8 - mCount);
+        }
+    }
+
+private:
+    std::vector<uint8_t>* mOut   = nullptr;
+    uint64_t              mBits  = 0;
+    uint32_t              mCount = 0;
+};
+
+uint32_t DeflateHash(const uint8_t* p)
+{
+    const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (v * 2654435761u) >> (32 - kDeflateHashBits);
+}
+
+// Greedy LZ77 with hash chains and a single fixed Huffman block
+void DeflateBand(const uint8_t* data, uint32_t size, bool isLast, std::vector<uint8_t>* pOut)
+{
+    DeflateBitWriter writer(pOut);
+    writer.Write(isLast ? 1 : 0, 1);
+    writer.Write(1, 2);
+
+    std::vector<int32_t> head(1u << kDeflateHashBits, -1);
+    std::vector<int32_t> chain(size, -1);
+    auto                 insert = [&](uint32_t pos) {
+        if ((pos + kDeflateMinMatch) <= size) {
+            const uint32_t hash = DeflateHash(data + pos);
+            chain[pos]          = head[hash];
+            head[hash]          = static_cast<int32_t>(pos);
+        }
+    };
+
+    uint32_t pos = 0;
+    while (pos < size) {
+        uint32_t bestLength   = 0;
+        uint32_t bestDistance = 0;
+        if ((pos + kDeflateMinMatch) <= size) {
+            const uint32_t maxLength = std::min(kDeflateMaxMatch, size - pos);
+            int32_t        candidate = head[DeflateHash(data + pos)];
+            for (uint32_t depth = 0; (candidate >= 0) && (depth < kDeflateMaxChainDepth); ++depth) {
+                const uint32_t distance = pos - static_cast<uint32_t>(candidate);
+                if (distance > kDeflateWindowSize) {
+                    break;
+                }
+                // Only a longer match is interesting, check the byte that
+                // would extend the current best match first
+                if (data[candidate + bestLength] == data[pos + bestLength]) {
+                    uint32_t length = 0;
+                    while ((length < maxLength) && (data[candidate + length] == data[pos + length])) {
+                        ++length;
+                    }
+                    if (length > bestLength) {
+                        bestLength   = length;
+                        bestDistance = distance;
+                        if (length == maxLength) {
+                            break;
+                        }
+                    }
+                }
+                candidate = chain[candidate];
+            }
+        }
+
+        if (bestLength >= kDeflateMinMatch) {
+            writer.WriteMatch(bestLength, bestDistance);
+            for (uint32_t i = 0; i < bestLength; ++i) {
+                insert(pos + i);
             }
+            pos += bestLength;
+        }
+        else {
+            writer.WriteSymbol(data[pos]);
+            insert(pos);
+            ++pos;
+        }
+    }
+
+    // End of block
+    writer.WriteSymbol(256);
+    if (isLast) {
+        writer.AlignToByte();
+        return;
+    }
+    // Empty stored block: BFINAL = 0, BTYPE = 00, LEN = 0, NLEN = 0xFFFF
+    writer.Write(0, 3);
+    writer.AlignToByte();
+    pOut->push_back(0x00);
+    pOut->push_back(0x00);
+    pOut->push_back(0xFF);
+    pOut->push_back(0xFF);
+}
+
+uint32_t Adler32(const uint8_t* data, size_t size)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0) {
+        // Largest n such that 255n(n+1)/2 + (n+1)(kAdlerBase-1) fits in 32 bits
+        const size_t count = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < count; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= kAdlerBase;
+        b %= kAdlerBase;
+        data += count;
+        size -= count;
+    }
+    return (b << 16) | a;
+}
+
+// Adler-32 of A followed by B, given the checksums of A and B and the size of B
+uint32_t Adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB)
+{
+    const uint32_t rem  = static_cast<uint32_t>(sizeB % kAdlerBase);
+    uint32_t       sum1 = adlerA & 0xFFFF;
+    uint32_t       sum2 = static_cast<uint32_t>((static_cast<uint64_t>(rem) * sum1) % kAdlerBase);
+    sum1 += (adlerB & 0xFFFF) + kAdlerBase - 1;
+    sum2 += ((adlerA >> 16) & 0xFFFF) + ((adlerB >> 16) & 0xFFFF) + kAdlerBase - rem;
+    if (sum1 >= kAdlerBase) {
+        sum1 -= kAdlerBase;
+    }
+    if (sum1 >= kAdlerBase) {
+        sum1 -= kAdlerBase;
+    }
+    if (sum2 >= (kAdlerBase << 1)) {
+        sum2 -= (kAdlerBase << 1);
+    }
+    if (sum2 >= kAdlerBase) {
+        sum2 -= kAdlerBase;
+    }
+    return sum1 | (sum2 << 16);
+}
+
+uint32_t Crc32Update(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const std::vector<uint32_t> sTable = []() {
+        std::vector<uint32_t> table(256);
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (uint32_t k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+    for (size_t i = 0; i < size; ++i) {
+        crc = sTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+uint8_t PaethPredictor(uint8_t a, uint8_t b, uint8_t c)
+{
+    const int32_t p  = static_cast<int32_t>(a) + b - c;
+    const int32_t pa = std::abs(p - a);
+    const int32_t pb = std::abs(p - b);
+    const int32_t pc = std::abs(p - c);
+    const uint8_t bc = (pb <= pc) ? b : c;
+    return ((pa <= pb) && (pa <= pc)) ? a : bc;
+}
+
+// Filters one row of RGB8 pixels into pDst, which starts with the filter
+// type byte. Picks the filter with the smallest sum of absolute
+// differences, the heuristic the PNG spec recommends. pScratch must hold
+// 5 * rowBytes bytes.
+void FilterRow(const uint8_t* row, const uint8_t* prevRow, uint32_t rowBytes, uint8_t* pScratch, uint8_t* pDst)
+{
+    const uint32_t kBpp     = 3;
+    uint8_t*       rows[5]  = {pScratch, pScratch + rowBytes, pScratch + 2 * rowBytes, pScratch + 3 * rowBytes, pScratch + 4 * rowBytes};
+    uint32_t       sums[5]  = {};
+    auto           filterAt = [&](uint32_t i, uint8_t a, uint8_t b, uint8_t c) {
+        rows[0][i] = row[i];
+        rows[1][i] = static_cast<uint8_t>(row[i] - a);
+        rows[2][i] = static_cast<uint8_t>(row[i] - b);
+        rows[3][i] = static_cast<uint8_t>(row[i] - ((a + b) >> 1));
+        rows[4][i] = static_cast<uint8_t>(row[i] - PaethPredictor(a, b, c));
+        for (uint32_t filter = 0; filter < 5; ++filter) {
+            sums[filter] += std::abs(static_cast<int8_t>(rows[filter][i]));
+        }
+    };
+    // The first pixel has no left neighbor
+    for (uint32_t i = 0; i < std::min(kBpp, rowBytes); ++i) {
+        filterAt(i, 0, prevRow[i], 0);
+    }
+    for (uint32_t i = kBpp; i < rowBytes; ++i) {
+        filterAt(i, row[i - kBpp], prevRow[i], prevRow[i - kBpp]);
+    }
 
-            row += desc->bytesPerTexel;
+    uint32_t best = 0;
+    for (uint32_t filter = 1; filter < 5; ++filter) {
+        if (sums[filter] < sums[best]) {
+            best = filter;
         }
-        data += rowStride;
     }
+    pDst[0] = static_cast<uint8_t>(best);
+    std::memcpy(pDst + 1, rows[best], rowBytes);
+}
+
+void WritePngChunk(std::ostream& outputStream, const char* type, const uint8_t* data, uint32_t size)
+{
+    uint8_t header[8] = {};
+    WriteBigEndian32(size, header);
+    std::memcpy(header + 4, type, 4);
+    uint32_t crc = Crc32Update(0xFFFFFFFF, header + 4, 4);
+    crc          = Crc32Update(crc, data, size);
+
+    uint8_t footer[4] = {};
+    WriteBigEndian32(crc ^ 0xFFFFFFFF, footer);
+
+    outputStream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    outputStream.write(reinterpret_cast<const char*>(data), size);
+    outputStream.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+}
+
+} // namespace
+
+Result ExportToPNG(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::filesystem::create_directories(std::filesystem::path(outputFilename).parent_path());
+    std::ofstream file(outputFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    ppx::Result   result = ExportToPNG(file, inputFormat, texels, width, height, rowStride);
+    file.close();
+    return result;
+}
+
+Result ExportToPNG(std::ostream& outputStream, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::vector<uint8_t> rgb;
+    Result               ppxres = ConvertToRGB8(inputFormat, texels, width, height, rowStride, &rgb);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    struct Band
+    {
+        std::vector<uint8_t> data;
+        uint32_t             adler = 0;
+        size_t               size  = 0; // Filtered size
+    };
+
+    const uint32_t             rowBytes  = 3 * width;
+    const uint32_t             bandCount = (height + kRowsPerBand - 1) / kRowsPerBand;
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+    std::vector<Band>          bands(bandCount);
+    ForEachBand(width, height, [&](uint32_t band, uint32_t y0, uint32_t y1) {
+        std::vector<uint8_t> filtered(static_cast<size_t>(y1 - y0) * (rowBytes + 1));
+        std::vector<uint8_t> scratch(5 * static_cast<size_t>(rowBytes));
+        for (uint32_t y = y0; y < y1; ++y) {
+            const uint8_t* row     = rgb.data() + static_cast<size_t>(y) * rowBytes;
+            const uint8_t* prevRow = (y > 0) ? (row - rowBytes) : zeroRow.data();
+            FilterRow(row, prevRow, rowBytes, scratch.data(), filtered.data() + static_cast<size_t>(y - y0) * (rowBytes + 1));
+        }
+
+        Band& dst = bands[band];
+        dst.adler = Adler32(filtered.data(), filtered.size());
+        dst.size  = filtered.size();
+        dst.data.reserve(filtered.size() / 2);
+        if (band == 0) {
+            // zlib header: deflate with a 32K window, no dictionary
+            dst.data.push_back(0x78);
+            dst.data.push_back(0x01);
+        }
+        DeflateBand(filtered.data(), static_cast<uint32_t>(filtered.size()), (band + 1) == bandCount, &dst.data);
+    });
+
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    outputStream.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    // IHDR: 8-bit RGB, no interlacing
+    uint8_t ihdr[13] = {};
+    WriteBigEndian32(width, ihdr);
+    WriteBigEndian32(height, ihdr + 4);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    WritePngChunk(outputStream, "IHDR", ihdr, sizeof(ihdr));
+
+    uint32_t adler = 1;
+    for (const Band& band : bands) {
+        WritePngChunk(outputStream, "IDAT", band.data.data(), static_cast<uint32_t>(band.data.size()));
+        adler = Adler32Combine(adler, band.adler, band.size);
+    }
+    uint8_t trailer[4] = {};
+    WriteBigEndian32(adler, trailer);
+    WritePngChunk(outputStream, "IDAT", trailer, sizeof(trailer));
+
+    WritePngChunk(outputStream, "IEND", nullptr, 0);
 
     return SUCCESS;
 }
 
+// -------------------------------------------------------------------------------------------------
+// Export by file extension
+// -------------------------------------------------------------------------------------------------
+Result ExportToFile(const std::string& outputFilename, grfx::Format inputFormat, const void* texels, uint32_t width, uint32_t height, uint32_t rowStride)
+{
+    std::string extension = std::filesystem::path(outputFilename).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".png") {
+        return ExportToPNG(outputFilename, inputFormat, texels, width, height, rowStride);
+    }
+    if (extension == ".qoi") {
+        return ExportToQOI(outputFilename, inputFormat, texels, width, height, rowStride);
+    }
+    return ExportToPPM(outputFilename, inputFormat, texels, width, height, rowStride);
+}
+
 } // namespace ppx
@@ -15,23 +15,264 @@
 #include "ppx/profiler.h"
 #include "ppx/timer.h"
 
-#define PPX_MAX_THREAD_PROFILERS 64
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
 
 namespace ppx {
 
-static Profiler           sPerThreadProfilers[PPX_MAX_THREAD_PROFILERS];
-static std::mutex         sThreadIndexMutex;
-static unsigned int       sThreadCount = 0;
-thread_local unsigned int sThreadIndex = UINT32_MAX;
+struct RegisteredEvent
+{
+    ProfilerEventType        type;
+    std::string              name;
+    ProfileEventRecordAction recordAction;
+    ProfilerEventToken       token;
+};
+
+// Profilers aren't destroyed when their thread exits, they go to
+// sFreeProfilers and are reused by the next new thread. That bounds them
+// by the peak number of live threads and lets the trace thread drain a
+// ring after its thread has exited.
+static std::mutex                             sThreadIndexMutex;
+static std::vector<std::unique_ptr<Profiler>> sPerThreadProfilers;
+static std::vector<Profiler*>                 sFreeProfilers;
+static std::vector<RegisteredEvent>           sRegisteredEvents;
 
-static unsigned int GetThreadIndex()
+struct ThreadProfiler
 {
-    if (sThreadIndex == UINT32_MAX) {
-        std::lock_guard<std::mutex> lock(sThreadIndexMutex);
-        sThreadIndex = sThreadCount;
-        sThreadCount = sThreadCount + 1;
-    };
-    return sThreadIndex;
+    Profiler* pProfiler = nullptr;
+
+    ~ThreadProfiler()
+    {
+        if (!IsNull(pProfiler)) {
+            std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+            sFreeProfilers.push_back(pProfiler);
+        }
+    }
+};
+
+thread_local ThreadProfiler sThreadProfiler;
+
+static std::vector<Profiler*> GetAllProfilers()
+{
+    std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+
+    std::vector<Profiler*> profilers;
+    for (auto& profiler : sPerThreadProfilers) {
+        profilers.push_back(profiler.get());
+    }
+    return profilers;
+}
+
+static const RegisteredEvent* FindRegisteredEvent(ProfilerEventToken token)
+{
+    auto it = FindIf(
+        sRegisteredEvents,
+        [token](const RegisteredEvent& elem) -> bool {
+            bool isSame = (elem.token == token);
+            return isSame; });
+    return (it != std::end(sRegisteredEvents)) ? &(*it) : nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+// ProfilerTraceWriter
+// -------------------------------------------------------------------------------------------------
+class ProfilerTraceWriter
+{
+public:
+    ProfilerTraceWriter() {}
+    ~ProfilerTraceWriter() { Stop(); }
+
+    bool IsActive() const { return mActive.load(std::memory_order_relaxed); }
+
+    Result Start(const std::filesystem::path& path)
+    {
+        std::lock_guard<std::mutex> lock(mStartStopMutex);
+        if (mThread.joinable()) {
+            return ppx::ERROR_FAILED;
+        }
+
+        mFile.open(path, std::ios::out | std::ios::trunc);
+        if (!mFile.is_open()) {
+            PPX_LOG_ERROR("failed opening trace file: " << path);
+            return ppx::ERROR_FAILED;
+        }
+        mFile << std::fixed << std::setprecision(3);
+        mFile << "{\"traceEvents\":[";
+
+        // Discard samples pushed after the previous trace's final drain
+        mDroppedAtStart = 0;
+        for (Profiler* pProfiler : GetAllProfilers()) {
+            pProfiler->GetSampleRing().Drain([](const ProfilerSampleRing::Entry&) {});
+            mDroppedAtStart += pProfiler->GetSampleRing().GetDroppedCount();
+        }
+
+        Timer::Timestamp(&mStartTimestamp);
+        mEventCount    = 0;
+        mStopRequested = false;
+        mActive.store(true, std::memory_order_relaxed);
+        mThread = std::thread(&ProfilerTraceWriter::ThreadMain, this);
+
+        PPX_LOG_INFO("Writing profiler trace to " << path);
+
+        return ppx::SUCCESS;
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(mStartStopMutex);
+        if (!mThread.joinable()) {
+            return;
+        }
+
+        mActive.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> waitLock(mWaitMutex);
+            mStopRequested = true;
+        }
+        mWaitCondition.notify_one();
+        mThread.join();
+
+        // The trace thread has exited so this thread is now the only consumer
+        DrainAll();
+
+        uint64_t droppedCount = 0;
+        for (Profiler* pProfiler : GetAllProfilers()) {
+            mFile << (mEventCount > 0 ? ",\n" : "\n");
+            mFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pProfiler->GetThreadIndex() << ",\"args\":{\"name\":\"thread " << pProfiler->GetThreadIndex() << "\"}}";
+            droppedCount += pProfiler->GetSampleRing().GetDroppedCount();
+            ++mEventCount;
+        }
+        droppedCount -= mDroppedAtStart;
+
+        mFile << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedSamples\":" << droppedCount << "}}\n";
+        mFile.close();
+
+        if (droppedCount > 0) {
+            PPX_LOG_WARN("profiler trace dropped " << droppedCount << " samples, the sample rings were full");
+        }
+    }
+
+private:
+    void ThreadMain()
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        while (!mStopRequested) {
+            mWaitCondition.wait_for(lock, std::chrono::milliseconds(10));
+            lock.unlock();
+            DrainAll();
+            lock.lock();
+        }
+    }
+
+    void DrainAll()
+    {
+        for (Profiler* pProfiler : GetAllProfilers()) {
+            const uint32_t tid = pProfiler->GetThreadIndex();
+            pProfiler->GetSampleRing().Drain([this, tid](const ProfilerSampleRing::Entry& entry) {
+                WriteEvent(tid, entry);
+            });
+        }
+        mFile.flush();
+    }
+
+    void WriteEvent(uint32_t tid, const ProfilerSampleRing::Entry& entry)
+    {
+        auto it = mEventNames.find(entry.token);
+        if (it == mEventNames.end()) {
+            std::string name     = "unknown";
+            std::string category = "cpu";
+            {
+                std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+                const RegisteredEvent*      pEvent = FindRegisteredEvent(entry.token);
+                if (!IsNull(pEvent)) {
+                    name     = EscapeJson(pEvent->name);
+                    category = (pEvent->type == PROFILER_EVENT_TYPE_GRFX_API_FN) ? "grfx_api" : "cpu";
+                }
+            }
+            it = mEventNames.emplace(entry.token, std::make_pair(name, category)).first;
+        }
+
+        // Scopes that began before the trace started are clamped to its start
+        const uint64_t start = std::max(entry.sample.startTimestamp, mStartTimestamp);
+        const uint64_t end   = std::max(entry.sample.endTimestamp, start);
+
+        mFile << (mEventCount > 0 ? ",\n" : "\n");
+        mFile << "{\"name\":\"" << it->second.first << "\",\"cat\":\"" << it->second.second << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+              << ",\"ts\":" << Timer::TimestampToMicros(start - mStartTimestamp)
+              << ",\"dur\":" << Timer::TimestampToMicros(end - start) << "}";
+        ++mEventCount;
+    }
+
+    static std::string EscapeJson(const std::string& s)
+    {
+        std::string escaped;
+        for (char c : s) {
+            if ((c == '"') || (c == '\\')) {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(((c >= 0) && (c < 0x20)) ? ' ' : c);
+        }
+        return escaped;
+    }
+
+private:
+    using EventName = std::pair<std::string, std::string>; // Name and category
+
+    std::mutex                                        mStartStopMutex;
+    std::mutex                                        mWaitMutex;
+    std::condition_variable                           mWaitCondition;
+    bool                                              mStopRequested = false;
+    std::atomic<bool>                                 mActive{false};
+    std::thread                                       mThread;
+    std::ofstream                                     mFile;
+    uint64_t                                          mStartTimestamp = 0;
+    uint64_t                                          mEventCount     = 0;
+    uint64_t                                          mDroppedAtStart = 0;
+    std::unordered_map<ProfilerEventToken, EventName> mEventNames;
+};
+
+static ProfilerTraceWriter sTraceWriter;
+
+// -------------------------------------------------------------------------------------------------
+// ProfilerSampleRing
+// -------------------------------------------------------------------------------------------------
+ProfilerSampleRing::ProfilerSampleRing(uint32_t capacity)
+{
+    uint64_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mMask = size - 1;
+}
+
+ProfilerSampleRing::~ProfilerSampleRing()
+{
+}
+
+bool ProfilerSampleRing::Push(const ProfilerEventToken& token, const ProfilerEventSample& sample)
+{
+    // Threads that never record while tracing don't pay for the entries.
+    // The consumer only reads entries below mHead, so it sees the
+    // allocation through the release store below.
+    if (!mEntries) {
+        mEntries.reset(new Entry[static_cast<size_t>(GetCapacity())]);
+    }
+
+    const uint64_t head = mHead.load(std::memory_order_relaxed);
+    if ((head - mTail.load(std::memory_order_acquire)) > mMask) {
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Entry& entry = mEntries[head & mMask];
+    entry.token  = token;
+    entry.sample = sample;
+    mHead.store(head + 1, std::memory_order_release);
+
+    return true;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -68,10 +309,27 @@ ProfilerEvent::~ProfilerEvent()
 {
 }
 
+std::vector<ProfilerEventSample> ProfilerEvent::GetSamples() const
+{
+    // Oldest sample first once the history has wrapped
+    std::vector<ProfilerEventSample> samples;
+    samples.reserve(mSamples.size());
+    samples.insert(samples.end(), mSamples.begin() + mNextSample, mSamples.end());
+    samples.insert(samples.end(), mSamples.begin(), mSamples.begin() + mNextSample);
+    return samples;
+}
+
 void ProfilerEvent::RecordSample(const ProfilerEventSample& sample)
 {
     if (mAction == PROFILER_EVENT_RECORD_ACTION_INSERT) {
-        mSamples.push_back(sample);
+        if (mSamples.size() < kMaxInsertSamples) {
+            mSamples.push_back(sample);
+            mNextSample = 0;
+        }
+        else {
+            mSamples[mNextSample] = sample;
+            mNextSample           = (mNextSample + 1) % kMaxInsertSamples;
+        }
     }
     else if (mAction == PROFILER_EVENT_RECORD_ACTION_AVERAGE) {
         uint64_t diff = (sample.endTimestamp - sample.startTimestamp);
@@ -88,8 +346,11 @@ void ProfilerEvent::RecordSample(const ProfilerEventSample& sample)
 // -------------------------------------------------------------------------------------------------
 // Profiler
 // -------------------------------------------------------------------------------------------------
-Profiler::Profiler()
+Profiler::Profiler(uint32_t threadIndex)
+    : mThreadIndex(threadIndex),
+      mEventSlots(std::make_unique<EventSlot[]>(kEventSlotCount))
 {
+    mEvents.reserve(kMaxEventCount);
 }
 
 Profiler::~Profiler()
@@ -98,25 +359,55 @@ Profiler::~Profiler()
 
 void Profiler::ReinitializeGlobalVariables()
 {
-    for (auto& profiler : sPerThreadProfilers) {
-        profiler.RemoveAllEvents();
+    {
+        std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+        sRegisteredEvents.clear();
+    }
+
+    for (Profiler* pProfiler : GetAllProfilers()) {
+        pProfiler->RemoveAllEvents();
     }
 }
 
 Profiler* Profiler::GetProfilerForThread()
 {
-    unsigned int threadIndex = GetThreadIndex();
-    Profiler*    pProfiler   = nullptr;
-    if (threadIndex < PPX_MAX_THREAD_PROFILERS) {
-        pProfiler = &sPerThreadProfilers[threadIndex];
+    if (IsNull(sThreadProfiler.pProfiler)) {
+        std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+
+        // A reused profiler starts over with empty events. Its ring keeps
+        // the samples of the exited thread, which share the thread index.
+        Profiler* pProfiler = nullptr;
+        if (!sFreeProfilers.empty()) {
+            pProfiler = sFreeProfilers.back();
+            sFreeProfilers.pop_back();
+            pProfiler->RemoveAllEventsLocked();
+        }
+        else {
+            sPerThreadProfilers.push_back(std::make_unique<Profiler>(CountU32(sPerThreadProfilers)));
+            pProfiler = sPerThreadProfilers.back().get();
+        }
+
+        for (auto& event : sRegisteredEvents) {
+            pProfiler->RegisterEventInternal(event.type, event.name, event.recordAction, event.token);
+        }
+
+        sThreadProfiler.pProfiler = pProfiler;
     }
-    return pProfiler;
+    return sThreadProfiler.pProfiler;
 }
 
 void Profiler::RemoveAllEvents()
 {
     std::lock_guard<std::mutex> lock(sThreadIndexMutex);
+    RemoveAllEventsLocked();
+}
+
+void Profiler::RemoveAllEventsLocked()
+{
     mEvents.clear();
+    for (uint32_t i = 0; i < kEventSlotCount; ++i) {
+        mEventSlots[i].token.store(0, std::memory_order_relaxed);
+    }
 }
 
 Result Profiler::RegisterEvent(ProfilerEventType type, const std::string& name, ProfileEventRecordAction recordAction, ProfilerEventToken* pToken)
@@ -130,12 +421,20 @@ Result Profiler::RegisterEvent(ProfilerEventType type, const std::string& name,
 
     ProfilerEventToken token = XXH64(name.c_str(), name.length(), 0xDEADBEEF);
 
-    for (size_t i = 0; i < PPX_MAX_THREAD_PROFILERS; ++i) {
-        Result ppxres = sPerThreadProfilers[i].RegisterEventInternal(type, name, recordAction, token);
+    if (!IsNull(FindRegisteredEvent(token))) {
+        return ppx::ERROR_DUPLICATE_ELEMENT;
+    }
+    if (sRegisteredEvents.size() >= kMaxEventCount) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    for (auto& profiler : sPerThreadProfilers) {
+        Result ppxres = profiler->RegisterEventInternal(type, name, recordAction, token);
         if (Failed(ppxres)) {
             return ppxres;
         }
     }
+    sRegisteredEvents.push_back({type, name, recordAction, token});
 
     *pToken = token;
 
@@ -148,32 +447,85 @@ Result Profiler::RegisterGrfxApiFnEvent(const std::string& name, ProfilerEventTo
     return ppxres;
 }
 
+Result Profiler::RegisterCpuEvent(const std::string& name, ProfilerEventToken* pToken)
+{
+    Result ppxres = RegisterEvent(PROFILER_EVENT_TYPE_CPU, name, PROFILER_EVENT_RECORD_ACTION_AVERAGE, pToken);
+    if (ppxres == ppx::ERROR_DUPLICATE_ELEMENT) {
+        *pToken = XXH64(name.c_str(), name.length(), 0xDEADBEEF);
+        ppxres  = ppx::SUCCESS;
+    }
+    return ppxres;
+}
+
+Result Profiler::StartTrace(const std::filesystem::path& path)
+{
+    return sTraceWriter.Start(path);
+}
+
+void Profiler::StopTrace()
+{
+    sTraceWriter.Stop();
+}
+
+bool Profiler::IsTracing()
+{
+    return sTraceWriter.IsActive();
+}
+
 Result Profiler::RegisterEventInternal(ProfilerEventType type, const std::string& name, ProfileEventRecordAction recordAction, ProfilerEventToken token)
 {
-    auto it = FindIf(
-        mEvents,
-        [token](const ProfilerEvent& elem) -> bool {
-            bool isSame = (elem.mToken == token);
-            return isSame; });
-    if (it != std::end(mEvents)) {
+    // Called with sThreadIndexMutex held, so there's a single writer.
+    // 0 marks empty slots.
+    PPX_ASSERT_MSG(token != 0, "invalid profiler event token");
+    if (!IsNull(FindEvent(token))) {
         return ppx::ERROR_DUPLICATE_ELEMENT;
     }
+    if (mEvents.size() >= kMaxEventCount) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
 
+    // The capacity is reserved, so the owning thread may be recording
+    // into the other events while this one is added
+    const uint32_t index = CountU32(mEvents);
     mEvents.emplace_back(type, name, recordAction, token);
 
+    uint32_t slot = static_cast<uint32_t>(token) & (kEventSlotCount - 1);
+    while (mEventSlots[slot].token.load(std::memory_order_relaxed) != 0) {
+        slot = (slot + 1) & (kEventSlotCount - 1);
+    }
+    mEventSlots[slot].index = index;
+    mEventSlots[slot].token.store(token, std::memory_order_release);
+
     return ppx::SUCCESS;
 }
 
+ProfilerEvent* Profiler::FindEvent(const ProfilerEventToken& token)
+{
+    // The table is never more than half full, so the probe always reaches
+    // an empty slot
+    uint32_t slot = static_cast<uint32_t>(token) & (kEventSlotCount - 1);
+    while (true) {
+        const ProfilerEventToken slotToken = mEventSlots[slot].token.load(std::memory_order_acquire);
+        if (slotToken == token) {
+            return &mEvents.data()[mEventSlots[slot].index];
+        }
+        if (slotToken == 0) {
+            return nullptr;
+        }
+        slot = (slot + 1) & (kEventSlotCount - 1);
+    }
+}
+
 void Profiler::RecordSample(const ProfilerEventToken& token, const ProfilerEventSample& sample)
 {
-    auto it = FindIf(
-        mEvents,
-        [token](const ProfilerEvent& elem) -> bool {
-            bool isSame = (elem.mToken == token);
-            return isSame; });
-    if (it != std::end(mEvents)) {
-        ProfilerEvent& event = *it;
-        event.RecordSample(sample);
+    ProfilerEvent* pEvent = FindEvent(token);
+    if (IsNull(pEvent)) {
+        return;
+    }
+    pEvent->RecordSample(sample);
+
+    if (sTraceWriter.IsActive()) {
+        mSampleRing.Push(token, sample);
     }
 }
 
@@ -0,0 +1,1014 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/render_graph.h"
+#include "ppx/grfx/grfx_device.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ppx {
+
+static const char* ToString(grfx::ResourceState value)
+{
+    // clang-format off
+    switch (value) {
+        default: break;
+        case grfx::RESOURCE_STATE_UNDEFINED                        : return "UNDEFINED";
+        case grfx::RESOURCE_STATE_GENERAL                          : return "GENERAL";
+        case grfx::RESOURCE_STATE_CONSTANT_BUFFER                  : return "CONSTANT_BUFFER";
+        case grfx::RESOURCE_STATE_VERTEX_BUFFER                    : return "VERTEX_BUFFER";
+        case grfx::RESOURCE_STATE_INDEX_BUFFER                     : return "INDEX_BUFFER";
+        case grfx::RESOURCE_STATE_RENDER_TARGET                    : return "RENDER_TARGET";
+        case grfx::RESOURCE_STATE_UNORDERED_ACCESS                 : return "UNORDERED_ACCESS";
+        case grfx::RESOURCE_STATE_DEPTH_STENCIL_READ               : return "DEPTH_STENCIL_READ";
+        case grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE              : return "DEPTH_STENCIL_WRITE";
+        case grfx::RESOURCE_STATE_DEPTH_WRITE_STENCIL_READ         : return "DEPTH_WRITE_STENCIL_READ";
+        case grfx::RESOURCE_STATE_DEPTH_READ_STENCIL_WRITE         : return "DEPTH_READ_STENCIL_WRITE";
+        case grfx::RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE        : return "NON_PIXEL_SHADER_RESOURCE";
+        case grfx::RESOURCE_STATE_PIXEL_SHADER_RESOURCE            : return "PIXEL_SHADER_RESOURCE";
+        case grfx::RESOURCE_STATE_SHADER_RESOURCE                  : return "SHADER_RESOURCE";
+        case grfx::RESOURCE_STATE_STREAM_OUT                       : return "STREAM_OUT";
+        case grfx::RESOURCE_STATE_INDIRECT_ARGUMENT                : return "INDIRECT_ARGUMENT";
+        case grfx::RESOURCE_STATE_COPY_SRC                         : return "COPY_SRC";
+        case grfx::RESOURCE_STATE_COPY_DST                         : return "COPY_DST";
+        case grfx::RESOURCE_STATE_RESOLVE_SRC                      : return "RESOLVE_SRC";
+        case grfx::RESOURCE_STATE_RESOLVE_DST                      : return "RESOLVE_DST";
+        case grfx::RESOURCE_STATE_PRESENT                          : return "PRESENT";
+        case grfx::RESOURCE_STATE_PREDICATION                      : return "PREDICATION";
+        case grfx::RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE: return "RAYTRACING_ACCELERATION_STRUCTURE";
+        case grfx::RESOURCE_STATE_FRAGMENT_DENSITY_MAP_ATTACHMENT  : return "FRAGMENT_DENSITY_MAP_ATTACHMENT";
+        case grfx::RESOURCE_STATE_FRAGMENT_SHADING_RATE_ATTACHMENT : return "FRAGMENT_SHADING_RATE_ATTACHMENT";
+    }
+    // clang-format on
+    return "<unknown resource state>";
+}
+
+static bool IsDepthStencilReadOnly(grfx::ResourceState state)
+{
+    return (state == grfx::RESOURCE_STATE_DEPTH_STENCIL_READ);
+}
+
+// Usage an image needs to be accessed in a state
+static grfx::ImageUsageFlags GetImageUsage(grfx::ResourceState state)
+{
+    grfx::ImageUsageFlags usage;
+    switch (state) {
+        default: break;
+        case grfx::RESOURCE_STATE_RENDER_TARGET: usage.bits.colorAttachment = true; break;
+        case grfx::RESOURCE_STATE_UNORDERED_ACCESS: usage.bits.storage = true; break;
+        case grfx::RESOURCE_STATE_COPY_SRC: usage.bits.transferSrc = true; break;
+        case grfx::RESOURCE_STATE_COPY_DST: usage.bits.transferDst = true; break;
+        case grfx::RESOURCE_STATE_DEPTH_STENCIL_READ:
+        case grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE:
+        case grfx::RESOURCE_STATE_DEPTH_WRITE_STENCIL_READ:
+        case grfx::RESOURCE_STATE_DEPTH_READ_STENCIL_WRITE: usage.bits.depthStencilAttachment = true; break;
+        case grfx::RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE:
+        case grfx::RESOURCE_STATE_PIXEL_SHADER_RESOURCE:
+        case grfx::RESOURCE_STATE_SHADER_RESOURCE: usage.bits.sampled = true; break;
+    }
+    return usage;
+}
+
+static uint64_t EstimateImageSize(const grfx::ImageCreateInfo& createInfo)
+{
+    if (createInfo.format == grfx::FORMAT_UNDEFINED) {
+        return 0;
+    }
+    const grfx::FormatDesc* pDesc = grfx::GetFormatDescription(createInfo.format);
+
+    const uint64_t blockWidth = std::max<uint64_t>(pDesc->blockWidth, 1);
+    uint64_t       width      = std::max<uint32_t>(createInfo.width, 1);
+    uint64_t       height     = std::max<uint32_t>(createInfo.height, 1);
+    uint64_t       depth      = std::max<uint32_t>(createInfo.depth, 1);
+    uint64_t       size       = 0;
+    for (uint32_t mip = 0; mip < std::max<uint32_t>(createInfo.mipLevelCount, 1); ++mip) {
+        const uint64_t blocksX = (width + blockWidth - 1) / blockWidth;
+        const uint64_t blocksY = (height + blockWidth - 1) / blockWidth;
+        size += blocksX * blocksY * depth * pDesc->bytesPerTexel;
+
+        width  = std::max<uint64_t>(width / 2, 1);
+        height = std::max<uint64_t>(height / 2, 1);
+        depth  = std::max<uint64_t>(depth / 2, 1);
+    }
+    return size * std::max<uint32_t>(createInfo.arrayLayerCount, 1) * static_cast<uint64_t>(createInfo.sampleCount);
+}
+
+// Images can share memory if they only differ by usage
+static bool CanAlias(const grfx::ImageCreateInfo& a, const grfx::ImageCreateInfo& b)
+{
+    return (a.type == b.type) &&
+           (a.width == b.width) &&
+           (a.height == b.height) &&
+           (a.depth == b.depth) &&
+           (a.format == b.format) &&
+           (a.sampleCount == b.sampleCount) &&
+           (a.mipLevelCount == b.mipLevelCount) &&
+           (a.arrayLayerCount == b.arrayLayerCount) &&
+           (a.memoryUsage == b.memoryUsage) &&
+           (a.concurrentMultiQueueUsage == b.concurrentMultiQueueUsage) &&
+           (memcmp(&a.RTVClearValue, &b.RTVClearValue, sizeof(a.RTVClearValue)) == 0) &&
+           (memcmp(&a.DSVClearValue, &b.DSVClearValue, sizeof(a.DSVClearValue)) == 0);
+}
+
+static bool CanAlias(const grfx::BufferCreateInfo& a, const grfx::BufferCreateInfo& b)
+{
+    return (a.memoryUsage == b.memoryUsage) &&
+           (a.structuredElementStride == b.structuredElementStride);
+}
+
+// -------------------------------------------------------------------------------------------------
+// RenderGraphContext
+// -------------------------------------------------------------------------------------------------
+grfx::Image* RenderGraphContext::GetImage(RenderGraphResourceID id) const
+{
+    return mGraph->GetImage(id);
+}
+
+grfx::Buffer* RenderGraphContext::GetBuffer(RenderGraphResourceID id) const
+{
+    return mGraph->GetBuffer(id);
+}
+
+// -------------------------------------------------------------------------------------------------
+// RenderGraphPassBuilder
+// -------------------------------------------------------------------------------------------------
+RenderGraphPassBuilder& RenderGraphPassBuilder::Read(RenderGraphResourceID id, grfx::ResourceState state)
+{
+    mGraph->AddAccess(mPassIndex, id, state, false);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::Write(RenderGraphResourceID id, grfx::ResourceState state)
+{
+    mGraph->AddAccess(mPassIndex, id, state, true);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::AddRenderTarget(RenderGraphResourceID id, bool clear)
+{
+    RenderGraph::Pass& pass = mGraph->mPasses[mPassIndex];
+    PPX_ASSERT_MSG(pass.renderTargets.size() < PPX_MAX_RENDER_TARGETS, "too many render targets");
+    pass.renderTargets.push_back(id);
+    if (clear) {
+        pass.clearFlags.bits.clearRenderTargets = true;
+    }
+    mGraph->AddAccess(mPassIndex, id, grfx::RESOURCE_STATE_RENDER_TARGET, true);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::SetDepthStencil(RenderGraphResourceID id, bool clear, grfx::ResourceState state)
+{
+    RenderGraph::Pass& pass = mGraph->mPasses[mPassIndex];
+    PPX_ASSERT_MSG(pass.depthStencil == kInvalidRenderGraphResourceID, "depth stencil already set");
+    pass.depthStencil = id;
+
+    // Read only depth stencil can't be cleared, see DrawPass
+    const bool readOnly = IsDepthStencilReadOnly(state);
+    if (clear && !readOnly) {
+        pass.clearFlags.bits.clearDepth   = true;
+        pass.clearFlags.bits.clearStencil = true;
+    }
+    mGraph->AddAccess(mPassIndex, id, state, !readOnly);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::SetSideEffects()
+{
+    mGraph->mPasses[mPassIndex].hasSideEffects = true;
+    return *this;
+}
+
+// -------------------------------------------------------------------------------------------------
+// RenderGraph
+// -------------------------------------------------------------------------------------------------
+RenderGraph::~RenderGraph()
+{
+    DestroyDeviceObjects();
+}
+
+void RenderGraph::Reset()
+{
+    DestroyDeviceObjects();
+    mResources.clear();
+    mPasses.clear();
+    mPhysicalResources.clear();
+    mFinalBarriers.clear();
+    mCompiled = false;
+    mStats    = {};
+}
+
+RenderGraphResourceID RenderGraph::AddResource(Resource&& resource)
+{
+    mCompiled = false;
+    mResources.push_back(std::move(resource));
+    return static_cast<RenderGraphResourceID>(mResources.size() - 1);
+}
+
+RenderGraphResourceID RenderGraph::CreateImage(const std::string& name, const grfx::ImageCreateInfo& createInfo)
+{
+    Resource resource        = {};
+    resource.name            = name;
+    resource.type            = RENDER_GRAPH_RESOURCE_TYPE_IMAGE;
+    resource.imageCreateInfo = createInfo;
+    resource.size            = EstimateImageSize(createInfo);
+    return AddResource(std::move(resource));
+}
+
+RenderGraphResourceID RenderGraph::CreateBuffer(const std::string& name, const grfx::BufferCreateInfo& createInfo)
+{
+    Resource resource         = {};
+    resource.name             = name;
+    resource.type             = RENDER_GRAPH_RESOURCE_TYPE_BUFFER;
+    resource.bufferCreateInfo = createInfo;
+    resource.size             = createInfo.size;
+    return AddResource(std::move(resource));
+}
+
+RenderGraphResourceID RenderGraph::ImportImage(const std::string& name, grfx::Image* pImage, grfx::ResourceState initialState, grfx::ResourceState finalState)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    Resource resource        = {};
+    resource.name            = name;
+    resource.type            = RENDER_GRAPH_RESOURCE_TYPE_IMAGE;
+    resource.pImportedImage  = pImage;
+    resource.initialState    = initialState;
+    resource.finalState      = finalState;
+
+    // Used for inspection and to check images bound by SetImportedImage()
+    grfx::ImageCreateInfo& createInfo = resource.imageCreateInfo;
+    createInfo.type                   = pImage->GetType();
+    createInfo.width                  = pImage->GetWidth();
+    createInfo.height                 = pImage->GetHeight();
+    createInfo.depth                  = pImage->GetDepth();
+    createInfo.format                 = pImage->GetFormat();
+    createInfo.sampleCount            = pImage->GetSampleCount();
+    createInfo.mipLevelCount          = pImage->GetMipLevelCount();
+    createInfo.arrayLayerCount        = pImage->GetArrayLayerCount();
+    createInfo.usageFlags             = pImage->GetUsageFlags();
+    createInfo.memoryUsage            = pImage->GetMemoryUsage();
+    resource.size                     = EstimateImageSize(createInfo);
+    return AddResource(std::move(resource));
+}
+
+RenderGraphResourceID RenderGraph::ImportBuffer(const std::string& name, grfx::Buffer* pBuffer, grfx::ResourceState initialState, grfx::ResourceState finalState)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    Resource resource         = {};
+    resource.name             = name;
+    resource.type             = RENDER_GRAPH_RESOURCE_TYPE_BUFFER;
+    resource.pImportedBuffer  = pBuffer;
+    resource.initialState     = initialState;
+    resource.finalState       = finalState;
+
+    // Used for inspection and to check buffers bound by SetImportedBuffer()
+    grfx::BufferCreateInfo& createInfo = resource.bufferCreateInfo;
+    createInfo.size                    = pBuffer->GetSize();
+    createInfo.structuredElementStride = pBuffer->GetStructuredElementStride();
+    createInfo.usageFlags              = pBuffer->GetUsageFlags();
+    resource.size                      = createInfo.size;
+    return AddResource(std::move(resource));
+}
+
+Result RenderGraph::SetImportedImage(RenderGraphResourceID id, grfx::Image* pImage)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    if (!IsValidResource(id) || IsNull(mResources[id].pImportedImage)) {
+        PPX_LOG_ERROR("Render graph resource isn't an imported image");
+        return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+    }
+
+    // Barriers, aliasing and draw pass compatibility were computed from
+    // the description of the image imported first
+    Resource&                    resource   = mResources[id];
+    const grfx::ImageCreateInfo& createInfo = resource.imageCreateInfo;
+
+    const bool matches = (pImage->GetType() == createInfo.type) &&
+                         (pImage->GetWidth() == createInfo.width) &&
+                         (pImage->GetHeight() == createInfo.height) &&
+                         (pImage->GetDepth() == createInfo.depth) &&
+                         (pImage->GetFormat() == createInfo.format) &&
+                         (pImage->GetSampleCount() == createInfo.sampleCount) &&
+                         (pImage->GetMipLevelCount() == createInfo.mipLevelCount) &&
+                         (pImage->GetArrayLayerCount() == createInfo.arrayLayerCount);
+    if (!matches) {
+        PPX_LOG_ERROR("Render graph image '" << resource.name << "' can't be rebound to an image with a different description");
+        return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+    }
+
+    resource.pImportedImage = pImage;
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::SetImportedBuffer(RenderGraphResourceID id, grfx::Buffer* pBuffer)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    if (!IsValidResource(id) || IsNull(mResources[id].pImportedBuffer)) {
+        PPX_LOG_ERROR("Render graph resource isn't an imported buffer");
+        return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+    }
+
+    Resource& resource = mResources[id];
+    if (pBuffer->GetSize() != resource.bufferCreateInfo.size) {
+        PPX_LOG_ERROR("Render graph buffer '" << resource.name << "' can't be rebound to a buffer with a different size");
+        return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+    }
+
+    resource.pImportedBuffer = pBuffer;
+    return ppx::SUCCESS;
+}
+
+RenderGraphPassBuilder RenderGraph::AddPass(const std::string& name, RenderGraphExecuteFn fn)
+{
+    Pass pass = {};
+    pass.name = name;
+    pass.fn   = fn;
+    mPasses.push_back(std::move(pass));
+    mCompiled = false;
+    return RenderGraphPassBuilder(this, static_cast<uint32_t>(mPasses.size() - 1));
+}
+
+void RenderGraph::AddAccess(uint32_t passIndex, RenderGraphResourceID id, grfx::ResourceState state, bool write)
+{
+    mCompiled = false;
+
+    // Accessing a resource twice in the same state is one access,
+    // conflicting states are reported by Compile()
+    std::vector<Access>& accesses = mPasses[passIndex].accesses;
+    for (auto& access : accesses) {
+        if ((access.id == id) && (access.state == state)) {
+            access.write = access.write || write;
+            return;
+        }
+    }
+
+    Access access = {};
+    access.id     = id;
+    access.state  = state;
+    access.write  = write;
+    accesses.push_back(access);
+}
+
+Result RenderGraph::Compile(grfx::Device* pDevice)
+{
+    DestroyDeviceObjects();
+    mPhysicalResources.clear();
+    mFinalBarriers.clear();
+    mCompiled = false;
+    mStats    = {};
+
+    for (auto& resource : mResources) {
+        resource.firstPass     = UINT32_MAX;
+        resource.lastPass      = 0;
+        resource.physicalIndex = UINT32_MAX;
+    }
+
+    for (auto& pass : mPasses) {
+        pass.culled = false;
+        pass.barriers.clear();
+
+        for (size_t i = 0; i < pass.accesses.size(); ++i) {
+            const Access& access = pass.accesses[i];
+            if (!IsValidResource(access.id)) {
+                PPX_LOG_ERROR("Render graph pass '" << pass.name << "' accesses an invalid resource");
+                return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+            }
+            for (size_t j = 0; j < i; ++j) {
+                if (pass.accesses[j].id == access.id) {
+                    PPX_LOG_ERROR("Render graph pass '" << pass.name << "' accesses resource '" << mResources[access.id].name << "' in more than one state");
+                    return ppx::ERROR_RENDER_GRAPH_CONFLICTING_ACCESS;
+                }
+            }
+        }
+
+        // Attachments must be images, the access check covered the ids
+        bool attachmentsAreImages = true;
+        for (RenderGraphResourceID id : pass.renderTargets) {
+            attachmentsAreImages = attachmentsAreImages && (mResources[id].type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE);
+        }
+        if (pass.depthStencil != kInvalidRenderGraphResourceID) {
+            attachmentsAreImages = attachmentsAreImages && (mResources[pass.depthStencil].type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE);
+        }
+        if (!attachmentsAreImages) {
+            PPX_LOG_ERROR("Render graph pass '" << pass.name << "' uses a buffer as an attachment");
+            return ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE;
+        }
+    }
+
+    CullPasses();
+    AliasResources();
+    ComputeBarriers();
+
+    mStats.passCount = static_cast<uint32_t>(mPasses.size());
+    for (const auto& pass : mPasses) {
+        if (pass.culled) {
+            ++mStats.culledPassCount;
+        }
+        mStats.barrierCount += static_cast<uint32_t>(pass.barriers.size());
+    }
+    mStats.barrierCount += static_cast<uint32_t>(mFinalBarriers.size());
+    for (const auto& resource : mResources) {
+        if (!resource.IsImported() && resource.IsUsed()) {
+            ++mStats.transientResourceCount;
+            mStats.transientBytes += resource.size;
+        }
+    }
+    mStats.physicalResourceCount = static_cast<uint32_t>(mPhysicalResources.size());
+    for (const auto& physical : mPhysicalResources) {
+        mStats.allocatedBytes += physical.size;
+    }
+
+    if (!IsNull(pDevice)) {
+        Result ppxres = CreateDeviceObjects(pDevice);
+        if (Failed(ppxres)) {
+            DestroyDeviceObjects();
+            return ppxres;
+        }
+    }
+
+    mCompiled = true;
+    return ppx::SUCCESS;
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walk the passes backwards from the imported resources: a pass is
+    // needed if it writes a resource that's needed, what it reads is then
+    // needed by the passes before it. Resources stay needed once they are,
+    // so every earlier write to them is kept.
+    std::vector<bool> needed(mResources.size(), false);
+    for (size_t i = 0; i < mResources.size(); ++i) {
+        needed[i] = mResources[i].IsImported();
+    }
+
+    for (size_t passIndex = mPasses.size(); passIndex > 0; --passIndex) {
+        Pass& pass = mPasses[passIndex - 1];
+
+        bool keep = pass.hasSideEffects;
+        for (const auto& access : pass.accesses) {
+            keep = keep || (access.write && needed[access.id]);
+        }
+        pass.culled = !keep;
+        if (pass.culled) {
+            continue;
+        }
+
+        for (const auto& access : pass.accesses) {
+            needed[access.id] = true;
+        }
+    }
+
+    for (uint32_t passIndex = 0; passIndex < static_cast<uint32_t>(mPasses.size()); ++passIndex) {
+        if (mPasses[passIndex].culled) {
+            continue;
+        }
+        for (const auto& access : mPasses[passIndex].accesses) {
+            Resource& resource = mResources[access.id];
+            resource.firstPass = std::min(resource.firstPass, passIndex);
+            resource.lastPass  = std::max(resource.lastPass, passIndex);
+        }
+    }
+}
+
+void RenderGraph::AliasResources()
+{
+    std::vector<RenderGraphResourceID> transients;
+    for (RenderGraphResourceID id = 0; id < static_cast<RenderGraphResourceID>(mResources.size()); ++id) {
+        if (!mResources[id].IsImported() && mResources[id].IsUsed()) {
+            transients.push_back(id);
+        }
+    }
+
+    // Greedy interval assignment in order of first use: a physical
+    // resource is free once the last pass of its current user is done
+    std::stable_sort(
+        transients.begin(),
+        transients.end(),
+        [this](RenderGraphResourceID a, RenderGraphResourceID b) { return mResources[a].firstPass < mResources[b].firstPass; });
+
+    for (RenderGraphResourceID id : transients) {
+        Resource& resource = mResources[id];
+
+        uint32_t bestIndex = UINT32_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mPhysicalResources.size()); ++i) {
+            const PhysicalResource& physical = mPhysicalResources[i];
+            if ((physical.type != resource.type) || (physical.lastPass >= resource.firstPass)) {
+                continue;
+            }
+            if (resource.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) {
+                if (CanAlias(physical.imageCreateInfo, resource.imageCreateInfo)) {
+                    bestIndex = i;
+                    break;
+                }
+                continue;
+            }
+
+            // Pick the buffer whose size is closest so large buffers
+            // aren't grown further by small ones
+            if (CanAlias(physical.bufferCreateInfo, resource.bufferCreateInfo)) {
+                if (bestIndex == UINT32_MAX) {
+                    bestIndex = i;
+                    continue;
+                }
+                const uint64_t size     = resource.size;
+                const uint64_t bestSize = mPhysicalResources[bestIndex].size;
+                const uint64_t bestDiff = (bestSize > size) ? (bestSize - size) : (size - bestSize);
+                const uint64_t diff     = (physical.size > size) ? (physical.size - size) : (size - physical.size);
+                if (diff < bestDiff) {
+                    bestIndex = i;
+                }
+            }
+        }
+
+        if (bestIndex == UINT32_MAX) {
+            PhysicalResource physical = {};
+            physical.type             = resource.type;
+            physical.imageCreateInfo  = resource.imageCreateInfo;
+            physical.bufferCreateInfo = resource.bufferCreateInfo;
+            mPhysicalResources.push_back(physical);
+            bestIndex = static_cast<uint32_t>(mPhysicalResources.size() - 1);
+        }
+
+        PhysicalResource& physical = mPhysicalResources[bestIndex];
+        physical.lastPass          = resource.lastPass;
+        if (resource.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) {
+            physical.imageCreateInfo.usageFlags |= resource.imageCreateInfo.usageFlags;
+            physical.size = resource.size;
+        }
+        else {
+            physical.bufferCreateInfo.usageFlags = physical.bufferCreateInfo.usageFlags | resource.bufferCreateInfo.usageFlags;
+            physical.bufferCreateInfo.size       = std::max(physical.bufferCreateInfo.size, resource.size);
+            physical.size                        = physical.bufferCreateInfo.size;
+        }
+        resource.physicalIndex = bestIndex;
+    }
+
+    // Images also need the usage of every state they're accessed in
+    for (const auto& pass : mPasses) {
+        if (pass.culled) {
+            continue;
+        }
+        for (const auto& access : pass.accesses) {
+            const Resource& resource = mResources[access.id];
+            if ((resource.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) && !resource.IsImported()) {
+                mPhysicalResources[resource.physicalIndex].imageCreateInfo.usageFlags |= GetImageUsage(access.state);
+            }
+        }
+    }
+}
+
+void RenderGraph::ComputeBarriers()
+{
+    // States are tracked per memory: imported resources have their own,
+    // transient resources share the state of their physical resource.
+    struct StateTracker
+    {
+        grfx::ResourceState   state        = grfx::RESOURCE_STATE_UNDEFINED;
+        bool                  used         = false;
+        bool                  written      = false;
+        bool                  firstWritten = false;
+        RenderGraphResourceID lastId       = kInvalidRenderGraphResourceID;
+    };
+
+    const size_t              importedBase = mPhysicalResources.size();
+    std::vector<StateTracker> trackers(importedBase + mResources.size());
+    auto                      GetTracker = [&](RenderGraphResourceID id) -> StateTracker& {
+        const Resource& resource = mResources[id];
+        return resource.IsImported() ? trackers[importedBase + id] : trackers[resource.physicalIndex];
+    };
+
+    for (RenderGraphResourceID id = 0; id < static_cast<RenderGraphResourceID>(mResources.size()); ++id) {
+        if (mResources[id].IsImported()) {
+            StateTracker& tracker = GetTracker(id);
+            tracker.state         = mResources[id].initialState;
+            tracker.used          = true;
+            tracker.lastId        = id;
+        }
+    }
+
+    for (auto& pass : mPasses) {
+        if (pass.culled) {
+            continue;
+        }
+        for (const auto& access : pass.accesses) {
+            const Resource& resource = mResources[access.id];
+            StateTracker&   tracker  = GetTracker(access.id);
+
+            // Physical resources are created in the state of their first
+            // access, it needs no barrier
+            if (!tracker.used) {
+                mPhysicalResources[resource.physicalIndex].initialState = access.state;
+                tracker.firstWritten                                    = access.write;
+            }
+            else {
+                // Accesses in the same state still need a memory barrier if
+                // either side writes. So does the first access of a
+                // resource that took over aliased memory.
+                const bool writeHazard = tracker.written || access.write;
+                const bool aliasHazard = (tracker.lastId != access.id);
+                if ((tracker.state != access.state) || writeHazard || aliasHazard) {
+                    Barrier barrier     = {};
+                    barrier.id          = access.id;
+                    barrier.beforeState = tracker.state;
+                    barrier.afterState  = access.state;
+                    pass.barriers.push_back(barrier);
+                }
+            }
+
+            tracker.state   = access.state;
+            tracker.used    = true;
+            tracker.written = access.write;
+            tracker.lastId  = access.id;
+        }
+    }
+
+    // Return everything to the state the next Execute() starts from
+    for (size_t i = 0; i < trackers.size(); ++i) {
+        const StateTracker& tracker = trackers[i];
+        if (!tracker.used) {
+            continue;
+        }
+        const grfx::ResourceState afterState = (i < importedBase) ? mPhysicalResources[i].initialState : mResources[i - importedBase].finalState;
+        // The first access of the next Execute() is a same-state access of
+        // a transient too, it needs a memory barrier if either side writes
+        const bool writeHazard = (i < importedBase) && (tracker.written || tracker.firstWritten);
+        if ((tracker.state != afterState) || writeHazard) {
+            Barrier barrier     = {};
+            barrier.id          = tracker.lastId;
+            barrier.beforeState = tracker.state;
+            barrier.afterState  = afterState;
+            mFinalBarriers.push_back(barrier);
+        }
+    }
+}
+
+Result RenderGraph::CreateDeviceObjects(grfx::Device* pDevice)
+{
+    mDevice = pDevice;
+
+    for (auto& physical : mPhysicalResources) {
+        if (physical.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) {
+            grfx::ImageCreateInfo createInfo = physical.imageCreateInfo;
+            createInfo.initialState          = physical.initialState;
+            createInfo.pApiObject            = nullptr;
+            createInfo.ownership             = grfx::OWNERSHIP_REFERENCE;
+
+            Result ppxres = pDevice->CreateImage(&createInfo, &physical.image);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "render graph image create failed");
+                return ppxres;
+            }
+        }
+        else {
+            grfx::BufferCreateInfo createInfo = physical.bufferCreateInfo;
+            createInfo.initialState           = physical.initialState;
+            createInfo.ownership              = grfx::OWNERSHIP_REFERENCE;
+
+            Result ppxres = pDevice->CreateBuffer(&createInfo, &physical.buffer);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "render graph buffer create failed");
+                return ppxres;
+            }
+        }
+    }
+
+    // Draw passes for the imported resources bound now, passes over
+    // rebound imported images are created by Execute()
+    for (auto& pass : mPasses) {
+        if (pass.culled || !HasAttachments(pass)) {
+            continue;
+        }
+
+        grfx::DrawPass* pDrawPass = nullptr;
+        Result          ppxres    = GetDrawPass(pass, &pDrawPass);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::GetDrawPass(Pass& pass, grfx::DrawPass** ppDrawPass)
+{
+    // Addresses can be reused by images created after a resize, registry
+    // handles can't
+    std::vector<ppx::SlotHandle> attachments;
+    for (RenderGraphResourceID id : pass.renderTargets) {
+        attachments.push_back(GetImage(id)->GetRegistryHandle());
+    }
+    if (pass.depthStencil != kInvalidRenderGraphResourceID) {
+        attachments.push_back(GetImage(pass.depthStencil)->GetRegistryHandle());
+    }
+
+    for (const auto& entry : pass.drawPasses) {
+        if (entry.attachments == attachments) {
+            *ppDrawPass = entry.drawPass;
+            return ppx::SUCCESS;
+        }
+    }
+
+    // Drop draw passes over images that have been destroyed since, they
+    // can't be hit again and would otherwise pile up with every resize
+    auto isStale = [this](const DrawPassEntry& entry) {
+        for (ppx::SlotHandle handle : entry.attachments) {
+            if (!mDevice->HasImage(handle)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (auto& entry : pass.drawPasses) {
+        if (isStale(entry)) {
+            mDevice->DestroyDrawPass(entry.drawPass);
+        }
+    }
+    pass.drawPasses.erase(std::remove_if(pass.drawPasses.begin(), pass.drawPasses.end(), isStale), pass.drawPasses.end());
+
+    // Draw passes are created over the physical images, aliased images
+    // are the same grfx::Image so they need nothing special
+    grfx::DrawPassCreateInfo2 createInfo = {};
+    createInfo.renderTargetCount         = static_cast<uint32_t>(pass.renderTargets.size());
+    for (uint32_t i = 0; i < createInfo.renderTargetCount; ++i) {
+        createInfo.pRenderTargetImages[i]     = GetImage(pass.renderTargets[i]);
+        createInfo.renderTargetClearValues[i] = createInfo.pRenderTargetImages[i]->GetRTVClearValue();
+    }
+    if (pass.depthStencil != kInvalidRenderGraphResourceID) {
+        createInfo.pDepthStencilImage     = GetImage(pass.depthStencil);
+        createInfo.depthStencilClearValue = createInfo.pDepthStencilImage->GetDSVClearValue();
+        for (const auto& access : pass.accesses) {
+            if (access.id == pass.depthStencil) {
+                createInfo.depthStencilState = access.state;
+            }
+        }
+    }
+
+    const grfx::Image* pFirstImage = (createInfo.renderTargetCount > 0) ? createInfo.pRenderTargetImages[0] : createInfo.pDepthStencilImage;
+    createInfo.width               = pFirstImage->GetWidth();
+    createInfo.height              = pFirstImage->GetHeight();
+
+    DrawPassEntry entry = {};
+    entry.attachments   = std::move(attachments);
+
+    Result ppxres = mDevice->CreateDrawPass(&createInfo, &entry.drawPass);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "render graph draw pass create failed");
+        return ppxres;
+    }
+
+    *ppDrawPass = entry.drawPass;
+    pass.drawPasses.push_back(std::move(entry));
+    return ppx::SUCCESS;
+}
+
+void RenderGraph::DestroyDeviceObjects()
+{
+    if (IsNull(mDevice)) {
+        return;
+    }
+
+    for (auto& pass : mPasses) {
+        for (auto& entry : pass.drawPasses) {
+            mDevice->DestroyDrawPass(entry.drawPass);
+        }
+        pass.drawPasses.clear();
+    }
+    for (auto& physical : mPhysicalResources) {
+        if (physical.image) {
+            mDevice->DestroyImage(physical.image);
+            physical.image.Reset();
+        }
+        if (physical.buffer) {
+            mDevice->DestroyBuffer(physical.buffer);
+            physical.buffer.Reset();
+        }
+    }
+    mDevice   = nullptr;
+    mCompiled = false;
+}
+
+Result RenderGraph::Execute(grfx::CommandBuffer* pCommandBuffer)
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+
+    if (!mCompiled || IsNull(mDevice)) {
+        PPX_LOG_ERROR("Render graph must be compiled with a device before it's executed");
+        return ppx::ERROR_RENDER_GRAPH_NOT_COMPILED;
+    }
+
+    RenderGraphContext context = {};
+    context.mGraph             = this;
+    context.mCommandBuffer     = pCommandBuffer;
+
+    for (auto& pass : mPasses) {
+        if (pass.culled) {
+            continue;
+        }
+
+        RecordBarriers(pCommandBuffer, pass.barriers);
+
+        context.mDrawPass = nullptr;
+        if (HasAttachments(pass)) {
+            Result ppxres = GetDrawPass(pass, &context.mDrawPass);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+        }
+        if (!IsNull(context.mDrawPass)) {
+            pCommandBuffer->BeginRenderPass(context.mDrawPass, pass.clearFlags);
+        }
+        if (pass.fn) {
+            pass.fn(context);
+        }
+        if (!IsNull(context.mDrawPass)) {
+            pCommandBuffer->EndRenderPass();
+        }
+    }
+
+    RecordBarriers(pCommandBuffer, mFinalBarriers);
+
+    return ppx::SUCCESS;
+}
+
+void RenderGraph::RecordBarriers(grfx::CommandBuffer* pCommandBuffer, const std::vector<Barrier>& barriers) const
+{
+    // Transitions skip barriers whose states match, those need explicit
+    // memory barriers
+    for (const auto& barrier : barriers) {
+        const bool isImage = (mResources[barrier.id].type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE);
+        if (barrier.IsMemoryBarrier()) {
+            if (isImage) {
+                pCommandBuffer->ImageMemoryBarrier(GetImage(barrier.id), barrier.afterState);
+            }
+            else {
+                pCommandBuffer->BufferMemoryBarrier(GetBuffer(barrier.id), barrier.afterState);
+            }
+        }
+        else if (isImage) {
+            pCommandBuffer->TransitionImageLayout(GetImage(barrier.id), PPX_ALL_SUBRESOURCES, barrier.beforeState, barrier.afterState);
+        }
+        else {
+            pCommandBuffer->BufferResourceBarrier(GetBuffer(barrier.id), barrier.beforeState, barrier.afterState);
+        }
+    }
+}
+
+grfx::Image* RenderGraph::GetImage(RenderGraphResourceID id) const
+{
+    if (!IsValidResource(id) || (mResources[id].type != RENDER_GRAPH_RESOURCE_TYPE_IMAGE)) {
+        return nullptr;
+    }
+    const Resource& resource = mResources[id];
+    if (resource.IsImported()) {
+        return resource.pImportedImage;
+    }
+    return (resource.physicalIndex < mPhysicalResources.size()) ? mPhysicalResources[resource.physicalIndex].image.Get() : nullptr;
+}
+
+grfx::Buffer* RenderGraph::GetBuffer(RenderGraphResourceID id) const
+{
+    if (!IsValidResource(id) || (mResources[id].type != RENDER_GRAPH_RESOURCE_TYPE_BUFFER)) {
+        return nullptr;
+    }
+    const Resource& resource = mResources[id];
+    if (resource.IsImported()) {
+        return resource.pImportedBuffer;
+    }
+    return (resource.physicalIndex < mPhysicalResources.size()) ? mPhysicalResources[resource.physicalIndex].buffer.Get() : nullptr;
+}
+
+bool RenderGraph::IsPassCulled(uint32_t passIndex) const
+{
+    return (passIndex < mPasses.size()) ? mPasses[passIndex].culled : false;
+}
+
+uint32_t RenderGraph::GetPhysicalResourceIndex(RenderGraphResourceID id) const
+{
+    return IsValidResource(id) ? mResources[id].physicalIndex : UINT32_MAX;
+}
+
+const std::vector<RenderGraphBarrier>& RenderGraph::GetPassBarriers(uint32_t passIndex) const
+{
+    static const std::vector<RenderGraphBarrier> kNoBarriers;
+    return (passIndex < mPasses.size()) ? mPasses[passIndex].barriers : kNoBarriers;
+}
+
+nlohmann::json RenderGraph::Export() const
+{
+    auto ExportBarriers = [this](const std::vector<Barrier>& barriers) {
+        nlohmann::json array = nlohmann::json::array();
+        for (const auto& barrier : barriers) {
+            nlohmann::json object;
+            object["resource"] = mResources[barrier.id].name;
+            object["before"]   = ToString(barrier.beforeState);
+            object["after"]    = ToString(barrier.afterState);
+            object["memory"]   = barrier.IsMemoryBarrier();
+            array += object;
+        }
+        return array;
+    };
+
+    nlohmann::json graph;
+    graph["compiled"] = mCompiled;
+
+    graph["resources"] = nlohmann::json::array();
+    for (const auto& resource : mResources) {
+        nlohmann::json object;
+        object["name"]     = resource.name;
+        object["type"]     = (resource.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) ? "image" : "buffer";
+        object["imported"] = resource.IsImported();
+        object["size"]     = resource.size;
+        if (resource.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) {
+            object["width"]  = resource.imageCreateInfo.width;
+            object["height"] = resource.imageCreateInfo.height;
+            object["format"] = grfx::ToString(resource.imageCreateInfo.format);
+        }
+        if (resource.IsUsed()) {
+            object["first_pass"] = resource.firstPass;
+            object["last_pass"]  = resource.lastPass;
+        }
+        if (resource.physicalIndex != UINT32_MAX) {
+            object["physical_resource"] = resource.physicalIndex;
+        }
+        graph["resources"] += object;
+    }
+
+    graph["passes"] = nlohmann::json::array();
+    for (const auto& pass : mPasses) {
+        nlohmann::json object;
+        object["name"]         = pass.name;
+        object["culled"]       = pass.culled;
+        object["side_effects"] = pass.hasSideEffects;
+        object["barriers"]     = ExportBarriers(pass.barriers);
+
+        object["accesses"] = nlohmann::json::array();
+        for (const auto& access : pass.accesses) {
+            nlohmann::json accessObject;
+            accessObject["resource"] = mResources[access.id].name;
+            accessObject["state"]    = ToString(access.state);
+            accessObject["write"]    = access.write;
+            object["accesses"] += accessObject;
+        }
+        graph["passes"] += object;
+    }
+    graph["final_barriers"] = ExportBarriers(mFinalBarriers);
+
+    graph["physical_resources"] = nlohmann::json::array();
+    for (const auto& physical : mPhysicalResources) {
+        nlohmann::json object;
+        object["type"]          = (physical.type == RENDER_GRAPH_RESOURCE_TYPE_IMAGE) ? "image" : "buffer";
+        object["size"]          = physical.size;
+        object["initial_state"] = ToString(physical.initialState);
+        graph["physical_resources"] += object;
+    }
+
+    nlohmann::json stats;
+    stats["pass_count"]               = mStats.passCount;
+    stats["culled_pass_count"]        = mStats.culledPassCount;
+    stats["barrier_count"]            = mStats.barrierCount;
+    stats["transient_resource_count"] = mStats.transientResourceCount;
+    stats["physical_resource_count"]  = mStats.physicalResourceCount;
+    stats["transient_bytes"]          = mStats.transientBytes;
+    stats["allocated_bytes"]          = mStats.allocatedBytes;
+    stats["aliased_bytes"]            = mStats.GetAliasedBytes();
+    graph["stats"]                    = stats;
+
+    return graph;
+}
+
+Result RenderGraph::ExportToFile(const std::filesystem::path& path) const
+{
+    if (path.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec) {
+            PPX_LOG_ERROR("Failed to create directory [" << path.parent_path() << "] for render graph file: " << ec.message());
+            return ppx::ERROR_FAILED;
+        }
+    }
+    std::ofstream outputFile(path, std::ofstream::out);
+    if (!outputFile.is_open()) {
+        PPX_LOG_ERROR("Failed to open render graph file at path [" << path << "] for writing!");
+        return ppx::ERROR_FAILED;
+    }
+    outputFile << Export().dump(4) << std::endl;
+    return ppx::SUCCESS;
+}
+
+} // namespace ppx
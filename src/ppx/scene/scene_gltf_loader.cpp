@@ -0,0 +1,1227 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/scene/scene_gltf_loader.h"
+#include "ppx/bitmap.h"
+#include "ppx/camera.h"
+#include "ppx/fs.h"
+#include "ppx/graphics_util.h"
+#include "ppx/mipmap.h"
+#include "ppx/thread_pool.h"
+#include "ppx/timer.h"
+#include "ppx/util.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_scope.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+
+#include "cgltf.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cfloat>
+#include <cstring>
+#include <unordered_set>
+
+namespace ppx {
+namespace scene {
+
+// Object ids for objects that don't have a source cgltf object
+const uint64_t kDefaultSamplerId = UINT64_MAX;
+const uint64_t kErrorMaterialId  = UINT64_MAX;
+
+// Alignment of each region (index, position, attribute) in mesh data buffers
+const uint32_t kMeshDataRegionAlignment = 16;
+
+// Recorded mesh data is submitted once this much is pending, so the staging
+// memory of earlier batches can be reused while the rest is recorded
+const uint64_t kMeshUploadFlushSize = 64 * 1024 * 1024;
+
+// Sizes of the interleaved vertex attributes, see VertexAttributeFlags::GetVertexBinding()
+const uint32_t kTexCoordSize = 2 * sizeof(float);
+const uint32_t kNormalSize   = 3 * sizeof(float);
+const uint32_t kTangentSize  = 4 * sizeof(float);
+const uint32_t kColorSize    = 3 * sizeof(float);
+
+// GL enums used by GLTF samplers
+const int kGltfFilterNearest              = 9728;
+const int kGltfFilterLinear               = 9729;
+const int kGltfFilterNearestMipmapNearest = 9984;
+const int kGltfFilterLinearMipmapNearest  = 9985;
+const int kGltfFilterNearestMipmapLinear  = 9986;
+const int kGltfWrapClampToEdge            = 33071;
+const int kGltfWrapMirroredRepeat         = 33648;
+
+// -------------------------------------------------------------------------------------------------
+// Internal structs
+// -------------------------------------------------------------------------------------------------
+struct GltfLoader::ImageData
+{
+    // Mipmap is heap allocated since its mips point into its own storage
+    std::unique_ptr<ppx::Mipmap> mipmap;
+};
+
+struct GltfLoader::MeshDataBuild
+{
+    struct Batch
+    {
+        const cgltf_material* pGltfMaterial   = nullptr;
+        grfx::IndexType       indexType       = grfx::INDEX_TYPE_UINT16;
+        uint32_t              indexCount      = 0;
+        uint32_t              vertexCount     = 0;
+        uint64_t              indexOffset     = 0;
+        uint64_t              indexSize       = 0;
+        uint64_t              positionOffset  = 0;
+        uint64_t              positionSize    = 0;
+        uint64_t              attributeOffset = 0;
+        uint64_t              attributeSize   = 0;
+        ppx::AABB             boundingBox     = {};
+    };
+
+    scene::VertexAttributeFlags vertexAttributes = scene::VertexAttributeFlags::None();
+    uint32_t                    attributeStride  = 0;
+    std::vector<char>           data;
+    std::vector<Batch>          batches;
+};
+
+struct GltfLoader::LoadContext
+{
+    grfx::Device*                 pDevice           = nullptr;
+    grfx::Queue*                  pQueue            = nullptr;
+    grfx::UploadQueue*            pUploadQueue      = nullptr;
+    uint64_t                      pendingUploadSize = 0; // Mesh data recorded since the last flush
+    scene::ResourceManager*       pResourceManager  = nullptr;
+    const scene::MaterialFactory* pMaterialFactory  = nullptr;
+
+    std::unordered_map<const cgltf_image*, GltfLoader::ImageData*>    images;
+    std::unordered_map<const cgltf_mesh*, GltfLoader::MeshDataBuild*> meshes;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Helper functions
+// -------------------------------------------------------------------------------------------------
+static std::string ToString(const char* pName)
+{
+    return IsNull(pName) ? std::string() : std::string(pName);
+}
+
+// Copies may already be recorded into objects of the scene that's about to
+// be destroyed, so wait for them before returning the error.
+static ppx::Result WaitForUploadsAndFail(grfx::UploadQueue* pUploadQueue, ppx::Result error)
+{
+    ppx::Result ppxres = pUploadQueue->WaitIdle();
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("Failed to wait for GLTF uploads: " << ppx::ToString(ppxres));
+    }
+    return error;
+}
+
+static uint32_t CalculateAttributeStride(const scene::VertexAttributeFlags& vertexAttributes)
+{
+    uint32_t stride = 0;
+    stride += vertexAttributes.bits.texCoords ? kTexCoordSize : 0;
+    stride += vertexAttributes.bits.normals ? kNormalSize : 0;
+    stride += vertexAttributes.bits.tangents ? kTangentSize : 0;
+    stride += vertexAttributes.bits.colors ? kColorSize : 0;
+    return stride;
+}
+
+static void GatherNodes(
+    const cgltf_node*                      pGltfNode,
+    std::unordered_set<const cgltf_node*>& visited,
+    std::vector<const cgltf_node*>&        nodes)
+{
+    if (IsNull(pGltfNode) || (visited.find(pGltfNode) != visited.end())) {
+        return;
+    }
+    visited.insert(pGltfNode);
+    nodes.push_back(pGltfNode);
+
+    for (cgltf_size i = 0; i < pGltfNode->children_count; ++i) {
+        GatherNodes(pGltfNode->children[i], visited, nodes);
+    }
+}
+
+static void GatherTextureView(
+    const cgltf_texture_view&               gltfTextureView,
+    std::unordered_set<const cgltf_image*>& visited,
+    std::vector<const cgltf_image*>&        images)
+{
+    if (IsNull(gltfTextureView.texture) || IsNull(gltfTextureView.texture->image)) {
+        return;
+    }
+    const cgltf_image* pGltfImage = gltfTextureView.texture->image;
+    if (visited.find(pGltfImage) != visited.end()) {
+        return;
+    }
+    visited.insert(pGltfImage);
+    images.push_back(pGltfImage);
+}
+
+static void FindAttributeAccessors(
+    const cgltf_primitive& gltfPrimitive,
+    const cgltf_accessor** ppPositions,
+    const cgltf_accessor** ppTexCoords,
+    const cgltf_accessor** ppNormals,
+    const cgltf_accessor** ppTangents,
+    const cgltf_accessor** ppColors)
+{
+    for (cgltf_size i = 0; i < gltfPrimitive.attributes_count; ++i) {
+        const cgltf_attribute& attribute = gltfPrimitive.attributes[i];
+        switch (attribute.type) {
+            default: break;
+            case cgltf_attribute_type_position: *ppPositions = attribute.data; break;
+            case cgltf_attribute_type_normal: *ppNormals = attribute.data; break;
+            case cgltf_attribute_type_tangent: *ppTangents = attribute.data; break;
+            case cgltf_attribute_type_texcoord: {
+                if (attribute.index == 0) {
+                    *ppTexCoords = attribute.data;
+                }
+            } break;
+            case cgltf_attribute_type_color: {
+                if (attribute.index == 0) {
+                    *ppColors = attribute.data;
+                }
+            } break;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// GltfLoader
+// -------------------------------------------------------------------------------------------------
+GltfLoader::GltfLoader(
+    const std::filesystem::path& filePath,
+    cgltf_data*                  pGltfData)
+    : mFilePath(filePath),
+      mGltfFolder(filePath.parent_path()),
+      mGltfData(pGltfData)
+{
+}
+
+GltfLoader::~GltfLoader()
+{
+    if (!IsNull(mGltfData)) {
+        cgltf_free(mGltfData);
+        mGltfData = nullptr;
+    }
+}
+
+ppx::Result GltfLoader::Create(
+    const std::filesystem::path& filePath,
+    scene::GltfLoader**          ppLoader)
+{
+    PPX_ASSERT_NULL_ARG(ppLoader);
+
+    if (!ppx::fs::path_exists(filePath)) {
+        PPX_LOG_ERROR("GLTF file does not exist: " << filePath);
+        return ppx::ERROR_PATH_DOES_NOT_EXIST;
+    }
+
+    const std::string filePathString = filePath.string();
+
+    cgltf_options options   = {};
+    cgltf_data*   pGltfData = nullptr;
+
+    cgltf_result cgres = cgltf_parse_file(&options, filePathString.c_str(), &pGltfData);
+    if (cgres != cgltf_result_success) {
+        PPX_LOG_ERROR("Failed to parse GLTF file: " << filePath);
+        return ppx::ERROR_SCENE_SOURCE_FILE_LOAD_FAILED;
+    }
+
+    cgres = cgltf_validate(pGltfData);
+    if (cgres != cgltf_result_success) {
+        PPX_LOG_ERROR("Failed to validate GLTF file: " << filePath);
+        cgltf_free(pGltfData);
+        return ppx::ERROR_SCENE_SOURCE_FILE_LOAD_FAILED;
+    }
+
+    cgres = cgltf_load_buffers(&options, pGltfData, filePathString.c_str());
+    if (cgres != cgltf_result_success) {
+        PPX_LOG_ERROR("Failed to load GLTF buffers: " << filePath);
+        cgltf_free(pGltfData);
+        return ppx::ERROR_SCENE_SOURCE_FILE_LOAD_FAILED;
+    }
+
+    scene::GltfLoader* pLoader = new scene::GltfLoader(filePath, pGltfData);
+    if (IsNull(pLoader)) {
+        cgltf_free(pGltfData);
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+
+    *ppLoader = pLoader;
+
+    return ppx::SUCCESS;
+}
+
+uint32_t GltfLoader::GetSceneCount() const
+{
+    return static_cast<uint32_t>(mGltfData->scenes_count);
+}
+
+uint32_t GltfLoader::GetDefaultSceneIndex() const
+{
+    if (IsNull(mGltfData->scene)) {
+        return 0;
+    }
+    return static_cast<uint32_t>(mGltfData->scene - mGltfData->scenes);
+}
+
+uint64_t GltfLoader::GetObjectId(const cgltf_image* pObject) const
+{
+    return static_cast<uint64_t>(pObject - mGltfData->images);
+}
+
+uint64_t GltfLoader::GetObjectId(const cgltf_sampler* pObject) const
+{
+    return static_cast<uint64_t>(pObject - mGltfData->samplers);
+}
+
+uint64_t GltfLoader::GetObjectId(const cgltf_texture* pObject) const
+{
+    return static_cast<uint64_t>(pObject - mGltfData->textures);
+}
+
+uint64_t GltfLoader::GetObjectId(const cgltf_material* pObject) const
+{
+    return static_cast<uint64_t>(pObject - mGltfData->materials);
+}
+
+uint64_t GltfLoader::GetObjectId(const cgltf_mesh* pObject) const
+{
+    return static_cast<uint64_t>(pObject - mGltfData->meshes);
+}
+
+std::string GltfLoader::GetMaterialIdent(const cgltf_material* pGltfMaterial) const
+{
+    if (IsNull(pGltfMaterial)) {
+        return PPX_MATERIAL_IDENT_ERROR;
+    }
+    if (pGltfMaterial->unlit) {
+        return PPX_MATERIAL_IDENT_UNLIT;
+    }
+    if (pGltfMaterial->has_pbr_metallic_roughness) {
+        return PPX_MATERIAL_IDENT_STANDARD;
+    }
+    return PPX_MATERIAL_IDENT_ERROR;
+}
+
+// -------------------------------------------------------------------------------------------------
+// CPU phase
+// -------------------------------------------------------------------------------------------------
+ppx::Result GltfLoader::DecodeImage(
+    const cgltf_image* pGltfImage,
+    uint32_t           mipLevelCount,
+    ImageData*         pImageData) const
+{
+    PPX_ASSERT_NULL_ARG(pGltfImage);
+    PPX_ASSERT_NULL_ARG(pImageData);
+
+    ppx::Bitmap bitmap;
+    if (!IsNull(pGltfImage->buffer_view)) {
+        const cgltf_buffer_view* pBufferView = pGltfImage->buffer_view;
+        if (IsNull(pBufferView->buffer) || IsNull(pBufferView->buffer->data)) {
+            return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+        }
+
+        const char* pData  = static_cast<const char*>(pBufferView->buffer->data) + pBufferView->offset;
+        auto        ppxres = ppx::Bitmap::LoadFromMemory(static_cast<size_t>(pBufferView->size), pData, &bitmap);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("Failed to decode embedded GLTF image: " << ToString(pGltfImage->name));
+            return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+        }
+    }
+    else if (!IsNull(pGltfImage->uri)) {
+        // Data URIs aren't supported
+        if (std::strncmp(pGltfImage->uri, "data:", 5) == 0) {
+            PPX_LOG_ERROR("GLTF image data URIs are not supported: " << ToString(pGltfImage->name));
+            return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+        }
+
+        std::string uri = pGltfImage->uri;
+        cgltf_decode_uri(&uri[0]);
+        uri.resize(std::strlen(uri.c_str()));
+
+        auto ppxres = ppx::Bitmap::LoadFile(mGltfFolder / uri, &bitmap);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("Failed to load GLTF image: " << (mGltfFolder / uri));
+            return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+        }
+    }
+    else {
+        return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+    }
+
+    // Mipmap doesn't clamp the level count
+    uint32_t maxLevelCount = ppx::Mipmap::CalculateLevelCount(bitmap.GetWidth(), bitmap.GetHeight());
+    uint32_t levelCount    = std::min(std::max(mipLevelCount, 1u), maxLevelCount);
+
+    // Don't use the static pool, it isn't safe to share across threads.
+    pImageData->mipmap = std::make_unique<ppx::Mipmap>(bitmap, levelCount, false);
+    if (!pImageData->mipmap->IsOk()) {
+        pImageData->mipmap.reset();
+        return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+    }
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::BuildMeshData(
+    const cgltf_mesh*                  pGltfMesh,
+    const scene::VertexAttributeFlags& vertexAttributes,
+    MeshDataBuild*                     pBuild) const
+{
+    PPX_ASSERT_NULL_ARG(pGltfMesh);
+    PPX_ASSERT_NULL_ARG(pBuild);
+
+    pBuild->vertexAttributes = vertexAttributes;
+    pBuild->attributeStride  = CalculateAttributeStride(vertexAttributes);
+    pBuild->batches.resize(pGltfMesh->primitives_count);
+
+    // Calculate layout
+    uint64_t dataSize = 0;
+    for (cgltf_size primIdx = 0; primIdx < pGltfMesh->primitives_count; ++primIdx) {
+        const cgltf_primitive& gltfPrimitive = pGltfMesh->primitives[primIdx];
+        if (gltfPrimitive.type != cgltf_primitive_type_triangles) {
+            PPX_LOG_ERROR("GLTF mesh primitive is not a triangle list: " << ToString(pGltfMesh->name));
+            return ppx::ERROR_SCENE_UNSUPPORTED_TOPOLOGY_TYPE;
+        }
+
+        const cgltf_accessor* pPositions = nullptr;
+        const cgltf_accessor* pTexCoords = nullptr;
+        const cgltf_accessor* pNormals   = nullptr;
+        const cgltf_accessor* pTangents  = nullptr;
+        const cgltf_accessor* pColors    = nullptr;
+        FindAttributeAccessors(gltfPrimitive, &pPositions, &pTexCoords, &pNormals, &pTangents, &pColors);
+        if (IsNull(pPositions) || (pPositions->count == 0)) {
+            return ppx::ERROR_SCENE_INVALID_SOURCE_GEOMETRY_VERTEX_DATA;
+        }
+
+        auto& batch         = pBuild->batches[primIdx];
+        batch.pGltfMaterial = gltfPrimitive.material;
+        batch.vertexCount   = static_cast<uint32_t>(pPositions->count);
+        batch.indexCount    = IsNull(gltfPrimitive.indices) ? batch.vertexCount : static_cast<uint32_t>(gltfPrimitive.indices->count);
+        batch.indexType     = (batch.vertexCount <= UINT16_MAX) ? grfx::INDEX_TYPE_UINT16 : grfx::INDEX_TYPE_UINT32;
+
+        const uint64_t indexElementSize = (batch.indexType == grfx::INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        batch.indexOffset     = RoundUp<uint64_t>(dataSize, kMeshDataRegionAlignment);
+        batch.indexSize       = batch.indexCount * indexElementSize;
+        batch.positionOffset  = RoundUp<uint64_t>(batch.indexOffset + batch.indexSize, kMeshDataRegionAlignment);
+        batch.positionSize    = batch.vertexCount * 3 * sizeof(float);
+        batch.attributeOffset = RoundUp<uint64_t>(batch.positionOffset + batch.positionSize, kMeshDataRegionAlignment);
+        batch.attributeSize   = batch.vertexCount * pBuild->attributeStride;
+        dataSize              = batch.attributeOffset + batch.attributeSize;
+    }
+
+    pBuild->data.resize(static_cast<size_t>(RoundUp<uint64_t>(dataSize, kMeshDataRegionAlignment)));
+
+    // Fill data
+    for (cgltf_size primIdx = 0; primIdx < pGltfMesh->primitives_count; ++primIdx) {
+        const cgltf_primitive& gltfPrimitive = pGltfMesh->primitives[primIdx];
+        const auto&            batch         = pBuild->batches[primIdx];
+
+        const cgltf_accessor* pPositions = nullptr;
+        const cgltf_accessor* pTexCoords = nullptr;
+        const cgltf_accessor* pNormals   = nullptr;
+        const cgltf_accessor* pTangents  = nullptr;
+        const cgltf_accessor* pColors    = nullptr;
+        FindAttributeAccessors(gltfPrimitive, &pPositions, &pTexCoords, &pNormals, &pTangents, &pColors);
+
+        // Attributes that aren't requested are ignored
+        pTexCoords = vertexAttributes.bits.texCoords ? pTexCoords : nullptr;
+        pNormals   = vertexAttributes.bits.normals ? pNormals : nullptr;
+        pTangents  = vertexAttributes.bits.tangents ? pTangents : nullptr;
+        pColors    = vertexAttributes.bits.colors ? pColors : nullptr;
+
+        for (const cgltf_accessor* pAccessor : {pTexCoords, pNormals, pTangents, pColors}) {
+            if (!IsNull(pAccessor) && (pAccessor->count != batch.vertexCount)) {
+                return ppx::ERROR_SCENE_INVALID_SOURCE_GEOMETRY_VERTEX_DATA;
+            }
+        }
+
+        // Indices
+        char* pIndexData = pBuild->data.data() + batch.indexOffset;
+        for (uint32_t i = 0; i < batch.indexCount; ++i) {
+            cgltf_uint index = i;
+            if (!IsNull(gltfPrimitive.indices)) {
+                if (!cgltf_accessor_read_uint(gltfPrimitive.indices, i, &index, 1)) {
+                    return ppx::ERROR_SCENE_INVALID_SOURCE_GEOMETRY_INDEX_DATA;
+                }
+                if (index >= batch.vertexCount) {
+                    return ppx::ERROR_SCENE_INVALID_SOURCE_GEOMETRY_INDEX_DATA;
+                }
+            }
+
+            if (batch.indexType == grfx::INDEX_TYPE_UINT16) {
+                reinterpret_cast<uint16_t*>(pIndexData)[i] = static_cast<uint16_t>(index);
+            }
+            else {
+                reinterpret_cast<uint32_t*>(pIndexData)[i] = static_cast<uint32_t>(index);
+            }
+        }
+
+        // Positions
+        float* pPositionData = reinterpret_cast<float*>(pBuild->data.data() + batch.positionOffset);
+        for (uint32_t i = 0; i < batch.vertexCount; ++i) {
+            if (!cgltf_accessor_read_float(pPositions, i, pPositionData + (3 * i), 3)) {
+                return ppx::ERROR_SCENE_INVALID_SOURCE_GEOMETRY_VERTEX_DATA;
+            }
+        }
+
+        // Attributes - interleaved in the order of VertexAttributeFlags::GetVertexBinding()
+        char* pAttributeData = pBuild->data.data() + batch.attributeOffset;
+        for (uint32_t i = 0; i < batch.vertexCount; ++i) {
+            float* pVertex = reinterpret_cast<float*>(pAttributeData + (i * pBuild->attributeStride));
+
+            if (vertexAttributes.bits.texCoords) {
+                float value[2] = {0, 0};
+                if (!IsNull(pTexCoords)) {
+                    cgltf_accessor_read_float(pTexCoords, i, value, 2);
+                }
+                std::memcpy(pVertex, value, kTexCoordSize);
+                pVertex += 2;
+            }
+            if (vertexAttributes.bits.normals) {
+                float value[3] = {0, 0, 1};
+                if (!IsNull(pNormals)) {
+                    cgltf_accessor_read_float(pNormals, i, value, 3);
+                }
+                std::memcpy(pVertex, value, kNormalSize);
+                pVertex += 3;
+            }
+            if (vertexAttributes.bits.tangents) {
+                float value[4] = {1, 0, 0, 1};
+                if (!IsNull(pTangents)) {
+                    cgltf_accessor_read_float(pTangents, i, value, 4);
+                }
+                std::memcpy(pVertex, value, kTangentSize);
+                pVertex += 4;
+            }
+            if (vertexAttributes.bits.colors) {
+                // Colors can be RGB or RGBA, alpha is dropped.
+                float value[4] = {1, 1, 1, 1};
+                if (!IsNull(pColors)) {
+                    cgltf_accessor_read_float(pColors, i, value, 4);
+                }
+                std::memcpy(pVertex, value, kColorSize);
+            }
+        }
+
+        // Bounding box
+        if (pPositions->has_min && pPositions->has_max) {
+            pBuild->batches[primIdx].boundingBox = ppx::AABB(
+                float3(pPositions->min[0], pPositions->min[1], pPositions->min[2]),
+                float3(pPositions->max[0], pPositions->max[1], pPositions->max[2]));
+        }
+        else {
+            ppx::AABB boundingBox(float3(pPositionData[0], pPositionData[1], pPositionData[2]));
+            for (uint32_t i = 1; i < batch.vertexCount; ++i) {
+                boundingBox.Expand(float3(pPositionData[3 * i + 0], pPositionData[3 * i + 1], pPositionData[3 * i + 2]));
+            }
+            pBuild->batches[primIdx].boundingBox = boundingBox;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::CreateNode(
+    const cgltf_node* pGltfNode,
+    scene::Scene*     pScene,
+    scene::NodeRef*   pNode) const
+{
+    PPX_ASSERT_NULL_ARG(pGltfNode);
+    PPX_ASSERT_NULL_ARG(pNode);
+
+    scene::NodeRef node = nullptr;
+
+    if (!IsNull(pGltfNode->mesh)) {
+        // Mesh is set during the GPU phase
+        node = scene::MakeRef(new scene::MeshNode(nullptr, pScene));
+    }
+    else if (!IsNull(pGltfNode->camera)) {
+        const cgltf_camera*     pGltfCamera = pGltfNode->camera;
+        std::unique_ptr<Camera> camera;
+        if (pGltfCamera->type == cgltf_camera_type_perspective) {
+            const cgltf_camera_perspective& persp = pGltfCamera->data.perspective;
+
+            float aspect   = (persp.aspect_ratio > 0) ? persp.aspect_ratio : 1.0f;
+            float hfov     = 2.0f * atan(tan(persp.yfov / 2.0f) * aspect);
+            float nearClip = (persp.znear > 0) ? persp.znear : PPX_CAMERA_DEFAULT_NEAR_CLIP;
+            float farClip  = (persp.zfar > 0) ? persp.zfar : PPX_CAMERA_DEFAULT_FAR_CLIP;
+
+            camera = std::make_unique<PerspCamera>(glm::degrees(hfov), aspect, nearClip, farClip);
+        }
+        else if (pGltfCamera->type == cgltf_camera_type_orthographic) {
+            const cgltf_camera_orthographic& ortho = pGltfCamera->data.orthographic;
+
+            camera = std::make_unique<OrthoCamera>(-ortho.xmag, ortho.xmag, -ortho.ymag, ortho.ymag, ortho.znear, ortho.zfar);
+        }
+        else {
+            return ppx::ERROR_SCENE_UNSUPPORTED_CAMERA_TYPE;
+        }
+
+        node = scene::MakeRef(new scene::CameraNode(std::move(camera), pScene));
+    }
+    else if (!IsNull(pGltfNode->light)) {
+        const cgltf_light* pGltfLight = pGltfNode->light;
+
+        scene::LightType lightType = scene::LIGHT_TYPE_UNDEFINED;
+        switch (pGltfLight->type) {
+            default: return ppx::ERROR_SCENE_INVALID_SOURCE_LIGHT;
+            case cgltf_light_type_directional: lightType = scene::LIGHT_TYPE_DIRECTIONAL; break;
+            case cgltf_light_type_point: lightType = scene::LIGHT_TYPE_POINT; break;
+            case cgltf_light_type_spot: lightType = scene::LIGHT_TYPE_SPOT; break;
+        }
+
+        auto lightNode = scene::MakeRef(new scene::LightNode(pScene));
+        lightNode->SetType(lightType);
+        lightNode->SetColor(float3(pGltfLight->color[0], pGltfLight->color[1], pGltfLight->color[2]));
+        lightNode->SetIntensity(pGltfLight->intensity);
+        lightNode->SetDistance(pGltfLight->range);
+        lightNode->SetSpotInnerConeAngle(pGltfLight->spot_inner_cone_angle);
+        lightNode->SetSpotOuterConeAngle(pGltfLight->spot_outer_cone_angle);
+
+        node = lightNode;
+    }
+    else {
+        node = scene::MakeRef(new scene::Node(pScene));
+    }
+
+    node->SetName(ToString(pGltfNode->name));
+
+    // Transform
+    float3    translation = float3(0, 0, 0);
+    glm::quat rotation    = glm::quat(1, 0, 0, 0);
+    float3    scale       = float3(1, 1, 1);
+    if (pGltfNode->has_matrix) {
+        float3 skew        = float3(0, 0, 0);
+        float4 perspective = float4(0, 0, 0, 1);
+        glm::decompose(glm::make_mat4(pGltfNode->matrix), scale, rotation, translation, skew, perspective);
+    }
+    else {
+        if (pGltfNode->has_translation) {
+            translation = float3(pGltfNode->translation[0], pGltfNode->translation[1], pGltfNode->translation[2]);
+        }
+        if (pGltfNode->has_rotation) {
+            // GLTF stores quaternions as XYZW, glm::quat's constructor takes WXYZ
+            rotation = glm::quat(pGltfNode->rotation[3], pGltfNode->rotation[0], pGltfNode->rotation[1], pGltfNode->rotation[2]);
+        }
+        if (pGltfNode->has_scale) {
+            scale = float3(pGltfNode->scale[0], pGltfNode->scale[1], pGltfNode->scale[2]);
+        }
+    }
+
+    // Transform's default rotation order is XYZ
+    float3 euler = float3(0, 0, 0);
+    glm::extractEulerAngleXYZ(glm::mat4_cast(rotation), euler.x, euler.y, euler.z);
+
+    node->SetTranslation(translation);
+    node->SetRotation(euler);
+    node->SetScale(scale);
+
+    *pNode = node;
+
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// GPU phase
+// -------------------------------------------------------------------------------------------------
+ppx::Result GltfLoader::LoadSampler(
+    LoadContext&         context,
+    const cgltf_sampler* pGltfSampler,
+    scene::SamplerRef*   pSampler)
+{
+    PPX_ASSERT_NULL_ARG(pSampler);
+
+    const uint64_t objectId = IsNull(pGltfSampler) ? kDefaultSamplerId : GetObjectId(pGltfSampler);
+    if (context.pResourceManager->Find(objectId, *pSampler)) {
+        return ppx::SUCCESS;
+    }
+
+    grfx::SamplerCreateInfo createInfo = {};
+    createInfo.magFilter               = grfx::FILTER_LINEAR;
+    createInfo.minFilter               = grfx::FILTER_LINEAR;
+    createInfo.mipmapMode              = grfx::SAMPLER_MIPMAP_MODE_LINEAR;
+    createInfo.minLod                  = 0.0f;
+    createInfo.maxLod                  = FLT_MAX;
+
+    if (!IsNull(pGltfSampler)) {
+        const int magFilter = static_cast<int>(pGltfSampler->mag_filter);
+        const int minFilter = static_cast<int>(pGltfSampler->min_filter);
+
+        createInfo.magFilter = (magFilter == kGltfFilterNearest) ? grfx::FILTER_NEAREST : grfx::FILTER_LINEAR;
+
+        switch (minFilter) {
+            default: break;
+            case kGltfFilterNearest: {
+                createInfo.minFilter = grfx::FILTER_NEAREST;
+                createInfo.maxLod    = 0.0f;
+            } break;
+            case kGltfFilterLinear: {
+                createInfo.maxLod = 0.0f;
+            } break;
+            case kGltfFilterNearestMipmapNearest: {
+                createInfo.minFilter  = grfx::FILTER_NEAREST;
+                createInfo.mipmapMode = grfx::SAMPLER_MIPMAP_MODE_NEAREST;
+            } break;
+            case kGltfFilterLinearMipmapNearest: {
+                createInfo.mipmapMode = grfx::SAMPLER_MIPMAP_MODE_NEAREST;
+            } break;
+            case kGltfFilterNearestMipmapLinear: {
+                createInfo.minFilter = grfx::FILTER_NEAREST;
+            } break;
+        }
+
+        auto toAddressMode = [](int wrap) -> grfx::SamplerAddressMode {
+            switch (wrap) {
+                default: break;
+                case kGltfWrapClampToEdge: return grfx::SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+                case kGltfWrapMirroredRepeat: return grfx::SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+            }
+            return grfx::SAMPLER_ADDRESS_MODE_REPEAT;
+        };
+
+        createInfo.addressModeU = toAddressMode(static_cast<int>(pGltfSampler->wrap_s));
+        createInfo.addressModeV = toAddressMode(static_cast<int>(pGltfSampler->wrap_t));
+    }
+
+    grfx::SamplerPtr grfxSampler;
+    auto             ppxres = context.pDevice->CreateSampler(&createInfo, &grfxSampler);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    auto sampler = scene::MakeRef(new scene::Sampler(grfxSampler));
+    if (!IsNull(pGltfSampler)) {
+        sampler->SetName(ToString(pGltfSampler->name));
+    }
+
+    ppxres = context.pResourceManager->Cache(objectId, sampler);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pSampler = sampler;
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::LoadTexture(
+    LoadContext&         context,
+    const cgltf_texture* pGltfTexture,
+    scene::TextureRef*   pTexture)
+{
+    PPX_ASSERT_NULL_ARG(pGltfTexture);
+    PPX_ASSERT_NULL_ARG(pTexture);
+
+    const uint64_t objectId = GetObjectId(pGltfTexture);
+    if (context.pResourceManager->Find(objectId, *pTexture)) {
+        return ppx::SUCCESS;
+    }
+
+    const cgltf_image* pGltfImage = pGltfTexture->image;
+    if (IsNull(pGltfImage)) {
+        PPX_LOG_ERROR("GLTF texture doesn't have an image: " << ToString(pGltfTexture->name));
+        return ppx::ERROR_SCENE_INVALID_SOURCE_TEXTURE;
+    }
+
+    // Image
+    scene::ImageRef image   = nullptr;
+    const uint64_t  imageId = GetObjectId(pGltfImage);
+    if (!context.pResourceManager->Find(imageId, image)) {
+        auto it = context.images.find(pGltfImage);
+        if ((it == context.images.end()) || !it->second->mipmap) {
+            return ppx::ERROR_SCENE_INVALID_SOURCE_IMAGE;
+        }
+
+        grfx::ImagePtr grfxImage;
+        auto           ppxres = grfx_util::CreateImageFromMipmap(context.pQueue, it->second->mipmap.get(), &grfxImage, grfx_util::ImageOptions().UploadQueue(context.pUploadQueue));
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        // Decoded data isn't needed anymore
+        it->second->mipmap.reset();
+
+        grfx::SampledImageViewPtr        grfxImageView;
+        grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(grfxImage);
+
+        ppxres = context.pDevice->CreateSampledImageView(&viewCreateInfo, &grfxImageView);
+        if (Failed(ppxres)) {
+            // The image's copies are recorded, they must finish first
+            if (Failed(context.pUploadQueue->WaitIdle())) {
+                PPX_LOG_ERROR("Failed to wait for GLTF uploads, leaking image");
+                return ppxres;
+            }
+            context.pDevice->DestroyImage(grfxImage);
+            return ppxres;
+        }
+
+        image = scene::MakeRef(new scene::Image(grfxImage, grfxImageView));
+        image->SetName(ToString(pGltfImage->name));
+
+        ppxres = context.pResourceManager->Cache(imageId, image);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    // Sampler
+    scene::SamplerRef sampler = nullptr;
+    auto              ppxres  = LoadSampler(context, pGltfTexture->sampler, &sampler);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    auto texture = scene::MakeRef(new scene::Texture(image, sampler));
+    texture->SetName(ToString(pGltfTexture->name));
+
+    ppxres = context.pResourceManager->Cache(objectId, texture);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pTexture = texture;
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::LoadTextureView(
+    LoadContext&              context,
+    const cgltf_texture_view& gltfTextureView,
+    scene::TextureView*       pTextureView)
+{
+    PPX_ASSERT_NULL_ARG(pTextureView);
+
+    // Nothing to do if there's no texture
+    if (IsNull(gltfTextureView.texture)) {
+        return ppx::SUCCESS;
+    }
+
+    scene::TextureRef texture = nullptr;
+    auto              ppxres  = LoadTexture(context, gltfTextureView.texture, &texture);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    float2 texCoordTranslate = float2(0, 0);
+    float  texCoordRotate    = 0;
+    float2 texCoordScale     = float2(1, 1);
+    if (gltfTextureView.has_transform) {
+        const cgltf_texture_transform& transform = gltfTextureView.transform;
+
+        texCoordTranslate = float2(transform.offset[0], transform.offset[1]);
+        texCoordRotate    = transform.rotation;
+        texCoordScale     = float2(transform.scale[0], transform.scale[1]);
+    }
+
+    *pTextureView = scene::TextureView(texture, texCoordTranslate, texCoordRotate, texCoordScale);
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::LoadMaterial(
+    LoadContext&          context,
+    const cgltf_material* pGltfMaterial,
+    scene::MaterialRef*   pMaterial)
+{
+    PPX_ASSERT_NULL_ARG(pMaterial);
+
+    const uint64_t objectId = IsNull(pGltfMaterial) ? kErrorMaterialId : GetObjectId(pGltfMaterial);
+    if (context.pResourceManager->Find(objectId, *pMaterial)) {
+        return ppx::SUCCESS;
+    }
+
+    const std::string materialIdent = GetMaterialIdent(pGltfMaterial);
+
+    auto material = scene::MakeRef(context.pMaterialFactory->CreateMaterial(materialIdent));
+    if (!material) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+
+    if (!IsNull(pGltfMaterial)) {
+        material->SetName(ToString(pGltfMaterial->name));
+
+        const cgltf_pbr_metallic_roughness& pbr = pGltfMaterial->pbr_metallic_roughness;
+
+        Result ppxres = ppx::SUCCESS;
+        if (material->GetIdentString() == PPX_MATERIAL_IDENT_UNLIT) {
+            auto pUnlitMaterial = static_cast<scene::UnlitMaterial*>(material.get());
+            pUnlitMaterial->SetBaseColorFactor(float4(pbr.base_color_factor[0], pbr.base_color_factor[1], pbr.base_color_factor[2], pbr.base_color_factor[3]));
+
+            ppxres = LoadTextureView(context, pbr.base_color_texture, pUnlitMaterial->GetBaseColorTextureViewPtr());
+        }
+        else if (material->GetIdentString() == PPX_MATERIAL_IDENT_STANDARD) {
+            auto pStandardMaterial = static_cast<scene::StandardMaterial*>(material.get());
+            pStandardMaterial->SetBaseColorFactor(float4(pbr.base_color_factor[0], pbr.base_color_factor[1], pbr.base_color_factor[2], pbr.base_color_factor[3]));
+            pStandardMaterial->SetMetallicFactor(pbr.metallic_factor);
+            pStandardMaterial->SetRoughnessFactor(pbr.roughness_factor);
+            pStandardMaterial->SetOcclusionStrength(pGltfMaterial->occlusion_texture.scale);
+            pStandardMaterial->SetEmissiveFactor(float3(pGltfMaterial->emissive_factor[0], pGltfMaterial->emissive_factor[1], pGltfMaterial->emissive_factor[2]));
+            if (pGltfMaterial->has_emissive_strength) {
+                pStandardMaterial->SetEmissiveStrength(pGltfMaterial->emissive_strength.emissive_strength);
+            }
+
+            const std::vector<std::pair<const cgltf_texture_view*, scene::TextureView*>> textureViews = {
+                {&pbr.base_color_texture, pStandardMaterial->GetBaseColorTextureViewPtr()},
+                {&pbr.metallic_roughness_texture, pStandardMaterial->GetMetallicRoughnessTextureViewPtr()},
+                {&pGltfMaterial->normal_texture, pStandardMaterial->GetNormalTextureViewPtr()},
+                {&pGltfMaterial->occlusion_texture, pStandardMaterial->GetOcclusionTextureViewPtr()},
+                {&pGltfMaterial->emissive_texture, pStandardMaterial->GetEmissiveTextureViewPtr()},
+            };
+            for (const auto& textureView : textureViews) {
+                ppxres = LoadTextureView(context, *textureView.first, textureView.second);
+                if (Failed(ppxres)) {
+                    break;
+                }
+            }
+        }
+
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    auto ppxres = context.pResourceManager->Cache(objectId, material);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pMaterial = material;
+
+    return ppx::SUCCESS;
+}
+
+ppx::Result GltfLoader::LoadMesh(
+    LoadContext&      context,
+    const cgltf_mesh* pGltfMesh,
+    scene::MeshRef*   pMesh)
+{
+    PPX_ASSERT_NULL_ARG(pGltfMesh);
+    PPX_ASSERT_NULL_ARG(pMesh);
+
+    const uint64_t objectId = GetObjectId(pGltfMesh);
+    if (context.pResourceManager->Find(objectId, *pMesh)) {
+        return ppx::SUCCESS;
+    }
+
+    auto it = context.meshes.find(pGltfMesh);
+    if (it == context.meshes.end()) {
+        return ppx::ERROR_SCENE_INVALID_SOURCE_MESH;
+    }
+    const MeshDataBuild* pBuild = it->second;
+
+    // GPU buffer
+    grfx::BufferPtr gpuBuffer;
+    {
+        grfx::BufferCreateInfo createInfo       = {};
+        createInfo.size                         = static_cast<uint64_t>(pBuild->data.size());
+        createInfo.usageFlags.bits.indexBuffer  = true;
+        createInfo.usageFlags.bits.vertexBuffer = true;
+        createInfo.usageFlags.bits.transferDst  = true;
+        createInfo.memoryUsage                  = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                 = grfx::RESOURCE_STATE_GENERAL;
+
+        auto ppxres = context.pDevice->CreateBuffer(&createInfo, &gpuBuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        // The data is copied to staging memory here, the copy itself is
+        // submitted with the other uploads of the scene
+        ppxres = context.pUploadQueue->UploadToBuffer(createInfo.size, pBuild->data.data(), gpuBuffer, 0, grfx::RESOURCE_STATE_GENERAL, grfx::RESOURCE_STATE_GENERAL);
+        if (Failed(ppxres)) {
+            // Nothing was recorded into gpuBuffer
+            context.pDevice->DestroyBuffer(gpuBuffer);
+            return ppxres;
+        }
+
+        context.pendingUploadSize += createInfo.size;
+        if (context.pendingUploadSize >= kMeshUploadFlushSize) {
+            ppxres = context.pUploadQueue->Flush();
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            context.pendingUploadSize = 0;
+        }
+    }
+
+    // Mesh data - scene::MeshData destroys the GPU buffer
+    auto meshData = scene::MakeRef(new scene::MeshData(pBuild->vertexAttributes, gpuBuffer));
+    {
+        auto ppxres = context.pResourceManager->Cache(objectId, meshData);
+        if (Failed(ppxres)) {
+            return WaitForUploadsAndFail(context.pUploadQueue, ppxres);
+        }
+    }
+
+    // Batches
+    std::vector<scene::PrimitiveBatch> batches;
+    for (const auto& batch : pBuild->batches) {
+        scene::MaterialRef material = nullptr;
+        auto               ppxres   = LoadMaterial(context, batch.pGltfMaterial, &material);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        grfx::IndexBufferView  indexBufferView(gpuBuffer, batch.indexType, batch.indexOffset, batch.indexSize);
+        grfx::VertexBufferView positionBufferView(gpuBuffer, 3 * sizeof(float), batch.positionOffset, batch.positionSize);
+        grfx::VertexBufferView attributeBufferView(gpuBuffer, pBuild->attributeStride, batch.attributeOffset, batch.attributeSize);
+
+        batches.push_back(scene::PrimitiveBatch(
+            material,
+            indexBufferView,
+            positionBufferView,
+            attributeBufferView,
+            batch.indexCount,
+            batch.vertexCount,
+            batch.boundingBox));
+    }
+
+    auto mesh = scene::MakeRef(new scene::Mesh(meshData, std::move(batches)));
+    mesh->SetName(ToString(pGltfMesh->name));
+
+    auto ppxres = context.pResourceManager->Cache(objectId, mesh);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pMesh = mesh;
+
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// LoadScene
+// -------------------------------------------------------------------------------------------------
+ppx::Result GltfLoader::LoadScene(
+    grfx::Device*                 pDevice,
+    uint32_t                      sceneIndex,
+    scene::Scene**                ppTargetScene,
+    const scene::GltfLoadOptions& loadOptions)
+{
+    PPX_ASSERT_NULL_ARG(pDevice);
+    PPX_ASSERT_NULL_ARG(ppTargetScene);
+
+    if (sceneIndex >= GetSceneCount()) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+    const cgltf_scene* pGltfScene = &mGltfData->scenes[sceneIndex];
+
+    Timer timer;
+    PPX_ASSERT_MSG(timer.Start() == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
+
+    scene::MaterialFactory defaultMaterialFactory;
+
+    const scene::MaterialFactory* pMaterialFactory = IsNull(loadOptions.pMaterialFactory) ? &defaultMaterialFactory : loadOptions.pMaterialFactory;
+
+    // Gather nodes
+    std::vector<const cgltf_node*> gltfNodes;
+    {
+        std::unordered_set<const cgltf_node*> visited;
+        for (cgltf_size i = 0; i < pGltfScene->nodes_count; ++i) {
+            GatherNodes(pGltfScene->nodes[i], visited, gltfNodes);
+        }
+    }
+
+    // Gather meshes and their required vertex attributes
+    std::vector<const cgltf_mesh*>           gltfMeshes;
+    std::vector<scene::VertexAttributeFlags> meshVertexAttributes;
+    {
+        std::unordered_set<const cgltf_mesh*> visited;
+        for (const cgltf_node* pGltfNode : gltfNodes) {
+            const cgltf_mesh* pGltfMesh = pGltfNode->mesh;
+            if (IsNull(pGltfMesh) || (visited.find(pGltfMesh) != visited.end())) {
+                continue;
+            }
+            visited.insert(pGltfMesh);
+
+            scene::VertexAttributeFlags vertexAttributes = loadOptions.requiredVertexAttributes;
+            for (cgltf_size i = 0; i < pGltfMesh->primitives_count; ++i) {
+                const std::string materialIdent = GetMaterialIdent(pGltfMesh->primitives[i].material);
+                vertexAttributes |= pMaterialFactory->GetRequiredVertexAttributes(materialIdent);
+            }
+
+            gltfMeshes.push_back(pGltfMesh);
+            meshVertexAttributes.push_back(vertexAttributes);
+        }
+    }
+
+    // Gather images referenced by the materials of the meshes
+    std::vector<const cgltf_image*> gltfImages;
+    {
+        std::unordered_set<const cgltf_material*> visitedMaterials;
+        std::unordered_set<const cgltf_image*>    visitedImages;
+        for (const cgltf_mesh* pGltfMesh : gltfMeshes) {
+            for (cgltf_size i = 0; i < pGltfMesh->primitives_count; ++i) {
+                const cgltf_material* pGltfMaterial = pGltfMesh->primitives[i].material;
+                if (IsNull(pGltfMaterial) || (visitedMaterials.find(pGltfMaterial) != visitedMaterials.end())) {
+                    continue;
+                }
+                visitedMaterials.insert(pGltfMaterial);
+
+                GatherTextureView(pGltfMaterial->pbr_metallic_roughness.base_color_texture, visitedImages, gltfImages);
+                if (!pGltfMaterial->unlit) {
+                    GatherTextureView(pGltfMaterial->pbr_metallic_roughness.metallic_roughness_texture, visitedImages, gltfImages);
+                    GatherTextureView(pGltfMaterial->normal_texture, visitedImages, gltfImages);
+                    GatherTextureView(pGltfMaterial->occlusion_texture, visitedImages, gltfImages);
+                    GatherTextureView(pGltfMaterial->emissive_texture, visitedImages, gltfImages);
+                }
+            }
+        }
+    }
+
+    // Target scene - nodes need the scene pointer at creation
+    auto                    resourceManager  = std::make_unique<scene::ResourceManager>();
+    scene::ResourceManager* pResourceManager = resourceManager.get();
+    auto                    targetScene      = std::make_unique<scene::Scene>(std::move(resourceManager));
+
+    // ---------------------------------------------------------------------------------------------
+    // CPU phase
+    //
+    // Images go first since they're the most expensive tasks. Each task
+    // only writes to its own output slot.
+    // ---------------------------------------------------------------------------------------------
+    std::vector<ImageData>      imageData(gltfImages.size());
+    std::vector<MeshDataBuild>  meshBuilds(gltfMeshes.size());
+    std::vector<scene::NodeRef> nodes(gltfNodes.size());
+
+    const uint32_t imageTaskCount = CountU32(gltfImages);
+    const uint32_t meshTaskCount  = CountU32(gltfMeshes);
+    const uint32_t nodeTaskCount  = CountU32(gltfNodes);
+    const uint32_t taskCount      = imageTaskCount + meshTaskCount + nodeTaskCount;
+
+    std::vector<ppx::Result> taskResults(taskCount, ppx::ERROR_FAILED);
+    {
+        ThreadPool threadPool(loadOptions.workerThreadCount);
+        threadPool.ParallelFor(taskCount, [&](uint32_t taskIndex) {
+            if (taskIndex < imageTaskCount) {
+                const uint32_t i       = taskIndex;
+                taskResults[taskIndex] = DecodeImage(gltfImages[i], loadOptions.mipLevelCount, &imageData[i]);
+            }
+            else if (taskIndex < (imageTaskCount + meshTaskCount)) {
+                const uint32_t i       = taskIndex - imageTaskCount;
+                taskResults[taskIndex] = BuildMeshData(gltfMeshes[i], meshVertexAttributes[i], &meshBuilds[i]);
+            }
+            else {
+                const uint32_t i       = taskIndex - imageTaskCount - meshTaskCount;
+                taskResults[taskIndex] = CreateNode(gltfNodes[i], targetScene.get(), &nodes[i]);
+            }
+        });
+    }
+
+    for (ppx::Result taskResult : taskResults) {
+        if (Failed(taskResult)) {
+            return taskResult;
+        }
+    }
+
+    const double cpuPhaseMillis = timer.MillisSinceStart();
+
+    // ---------------------------------------------------------------------------------------------
+    // GPU phase
+    // ---------------------------------------------------------------------------------------------
+
+    // Destroyed before targetScene, destroying the transient upload queue
+    // waits for the copies into the scene's objects
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pDevice);
+
+    LoadContext context      = {};
+    context.pDevice          = pDevice;
+    context.pQueue           = pDevice->GetGraphicsQueue();
+    context.pUploadQueue     = loadOptions.pUploadQueue;
+    context.pResourceManager = pResourceManager;
+    context.pMaterialFactory = pMaterialFactory;
+
+    grfx::UploadQueuePtr transientUploadQueue;
+    if (IsNull(context.pUploadQueue)) {
+        grfx::UploadQueueCreateInfo createInfo = {};
+        createInfo.pQueue                      = context.pQueue;
+
+        auto ppxres = pDevice->CreateUploadQueue(&createInfo, &transientUploadQueue);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(transientUploadQueue);
+
+        context.pUploadQueue = transientUploadQueue;
+    }
+
+    for (size_t i = 0; i < gltfImages.size(); ++i) {
+        context.images[gltfImages[i]] = &imageData[i];
+    }
+    for (size_t i = 0; i < gltfMeshes.size(); ++i) {
+        context.meshes[gltfMeshes[i]] = &meshBuilds[i];
+    }
+
+    std::unordered_map<const cgltf_node*, scene::Node*> nodeMap;
+    for (size_t i = 0; i < gltfNodes.size(); ++i) {
+        const cgltf_node* pGltfNode = gltfNodes[i];
+        nodeMap[pGltfNode]          = nodes[i].get();
+
+        if (IsNull(pGltfNode->mesh)) {
+            continue;
+        }
+
+        scene::MeshRef mesh   = nullptr;
+        auto           ppxres = LoadMesh(context, pGltfNode->mesh, &mesh);
+        if (Failed(ppxres)) {
+            return WaitForUploadsAndFail(context.pUploadQueue, ppxres);
+        }
+        static_cast<scene::MeshNode*>(nodes[i].get())->SetMesh(mesh);
+    }
+
+    // Hierarchy
+    for (size_t i = 0; i < gltfNodes.size(); ++i) {
+        const cgltf_node* pGltfNode = gltfNodes[i];
+        for (cgltf_size j = 0; j < pGltfNode->children_count; ++j) {
+            auto it = nodeMap.find(pGltfNode->children[j]);
+            if (it == nodeMap.end()) {
+                return WaitForUploadsAndFail(context.pUploadQueue, ppx::ERROR_SCENE_INVALID_NODE_HIERARCHY);
+            }
+
+            auto ppxres = nodes[i]->AddChild(it->second);
+            if (Failed(ppxres)) {
+                return WaitForUploadsAndFail(context.pUploadQueue, ppxres);
+            }
+        }
+    }
+
+    for (auto& node : nodes) {
+        auto ppxres = targetScene->AddNode(std::move(node));
+        if (Failed(ppxres)) {
+            return WaitForUploadsAndFail(context.pUploadQueue, ppxres);
+        }
+    }
+
+    // Flush what's left, the scene is ready to use once LoadScene() returns
+    if (transientUploadQueue) {
+        auto ppxres = transientUploadQueue->WaitIdle();
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    PPX_LOG_INFO("Loaded GLTF scene " << sceneIndex << " from " << mFilePath << " in " << timer.MillisSinceStart() << "ms (cpu phase: " << cpuPhaseMillis << "ms)");
+
+    *ppTargetScene = targetScene.release();
+
+    return ppx::SUCCESS;
+}
+
+} // namespace scene
+} // namespace ppx
@@ -0,0 +1,475 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/texture_file.h"
+
+namespace ppx {
+
+namespace {
+
+// clang-format off
+const char kKTXIdentifier[12]  = {'\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n'};
+const char kKTX2Identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '2', '0', '\xBB', '\r', '\n', '\x1A', '\n'};
+// clang-format on
+
+constexpr uint32_t kDDSMagic        = 0x20534444; // "DDS "
+constexpr uint32_t kDDSHeaderSize   = 124;
+constexpr uint32_t kDDSDataOffset   = 4 + kDDSHeaderSize;
+constexpr uint32_t kDDSDX10Size     = 20;
+constexpr uint32_t kDDPFFourCC      = 0x4;
+constexpr uint32_t kDDPFRGB         = 0x40;
+constexpr uint32_t kDDSCaps2Cubemap = 0x200;
+constexpr uint32_t kDDSCaps2Volume  = 0x200000;
+
+constexpr uint32_t kKTXHeaderSize  = 64;
+constexpr uint32_t kKTXEndianness  = 0x04030201;
+constexpr uint32_t kKTX2HeaderSize = 80;
+constexpr uint32_t kKTX2LevelSize  = 24;
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+uint32_t ReadU32(const char* pData, size_t offset)
+{
+    uint32_t value = 0;
+    memcpy(&value, pData + offset, sizeof(value));
+    return value;
+}
+
+uint64_t ReadU64(const char* pData, size_t offset)
+{
+    uint64_t value = 0;
+    memcpy(&value, pData + offset, sizeof(value));
+    return value;
+}
+
+grfx::Format FourCCToGrfxFormat(uint32_t fourCC)
+{
+    // clang-format off
+    switch (fourCC) {
+        case MakeFourCC('D', 'X', 'T', '1') : return grfx::FORMAT_BC1_RGBA_UNORM;
+        case MakeFourCC('D', 'X', 'T', '2') : return grfx::FORMAT_BC2_UNORM;
+        case MakeFourCC('D', 'X', 'T', '3') : return grfx::FORMAT_BC2_UNORM;
+        case MakeFourCC('D', 'X', 'T', '4') : return grfx::FORMAT_BC3_UNORM;
+        case MakeFourCC('D', 'X', 'T', '5') : return grfx::FORMAT_BC3_UNORM;
+        case MakeFourCC('A', 'T', 'I', '1') : return grfx::FORMAT_BC4_UNORM;
+        case MakeFourCC('B', 'C', '4', 'U') : return grfx::FORMAT_BC4_UNORM;
+        case MakeFourCC('B', 'C', '4', 'S') : return grfx::FORMAT_BC4_SNORM;
+        case MakeFourCC('A', 'T', 'I', '2') : return grfx::FORMAT_BC5_UNORM;
+        case MakeFourCC('B', 'C', '5', 'U') : return grfx::FORMAT_BC5_UNORM;
+        case MakeFourCC('B', 'C', '5', 'S') : return grfx::FORMAT_BC5_SNORM;
+        default: break;
+    }
+    // clang-format on
+    return grfx::FORMAT_UNDEFINED;
+}
+
+grfx::Format DXGIFormatToGrfxFormat(uint32_t dxgiFormat)
+{
+    // clang-format off
+    switch (dxgiFormat) {
+        case 28 : return grfx::FORMAT_R8G8B8A8_UNORM;
+        case 29 : return grfx::FORMAT_R8G8B8A8_SRGB;
+        case 71 : return grfx::FORMAT_BC1_RGBA_UNORM;
+        case 72 : return grfx::FORMAT_BC1_RGBA_SRGB;
+        case 74 : return grfx::FORMAT_BC2_UNORM;
+        case 75 : return grfx::FORMAT_BC2_SRGB;
+        case 77 : return grfx::FORMAT_BC3_UNORM;
+        case 78 : return grfx::FORMAT_BC3_SRGB;
+        case 80 : return grfx::FORMAT_BC4_UNORM;
+        case 81 : return grfx::FORMAT_BC4_SNORM;
+        case 83 : return grfx::FORMAT_BC5_UNORM;
+        case 84 : return grfx::FORMAT_BC5_SNORM;
+        case 87 : return grfx::FORMAT_B8G8R8A8_UNORM;
+        case 91 : return grfx::FORMAT_B8G8R8A8_SRGB;
+        case 95 : return grfx::FORMAT_BC6H_UFLOAT;
+        case 96 : return grfx::FORMAT_BC6H_SFLOAT;
+        case 98 : return grfx::FORMAT_BC7_UNORM;
+        case 99 : return grfx::FORMAT_BC7_SRGB;
+        default: break;
+    }
+    // clang-format on
+    return grfx::FORMAT_UNDEFINED;
+}
+
+grfx::Format GLInternalFormatToGrfxFormat(uint32_t glInternalFormat)
+{
+    // clang-format off
+    switch (glInternalFormat) {
+        case 0x8058 : return grfx::FORMAT_R8G8B8A8_UNORM; // GL_RGBA8
+        case 0x8C43 : return grfx::FORMAT_R8G8B8A8_SRGB;  // GL_SRGB8_ALPHA8
+        case 0x83F0 : return grfx::FORMAT_BC1_RGB_UNORM;  // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+        case 0x83F1 : return grfx::FORMAT_BC1_RGBA_UNORM; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+        case 0x83F2 : return grfx::FORMAT_BC2_UNORM;      // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+        case 0x83F3 : return grfx::FORMAT_BC3_UNORM;      // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        case 0x8C4C : return grfx::FORMAT_BC1_RGB_SRGB;   // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+        case 0x8C4D : return grfx::FORMAT_BC1_RGBA_SRGB;  // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+        case 0x8C4E : return grfx::FORMAT_BC2_SRGB;       // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+        case 0x8C4F : return grfx::FORMAT_BC3_SRGB;       // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+        case 0x8DBB : return grfx::FORMAT_BC4_UNORM;      // GL_COMPRESSED_RED_RGTC1
+        case 0x8DBC : return grfx::FORMAT_BC4_SNORM;      // GL_COMPRESSED_SIGNED_RED_RGTC1
+        case 0x8DBD : return grfx::FORMAT_BC5_UNORM;      // GL_COMPRESSED_RG_RGTC2
+        case 0x8DBE : return grfx::FORMAT_BC5_SNORM;      // GL_COMPRESSED_SIGNED_RG_RGTC2
+        case 0x8E8C : return grfx::FORMAT_BC7_UNORM;      // GL_COMPRESSED_RGBA_BPTC_UNORM
+        case 0x8E8D : return grfx::FORMAT_BC7_SRGB;       // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+        case 0x8E8E : return grfx::FORMAT_BC6H_SFLOAT;    // GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT
+        case 0x8E8F : return grfx::FORMAT_BC6H_UFLOAT;    // GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+        default: break;
+    }
+    // clang-format on
+    return grfx::FORMAT_UNDEFINED;
+}
+
+grfx::Format VkFormatToGrfxFormat(uint32_t vkFormat)
+{
+    // clang-format off
+    switch (vkFormat) {
+        case 37  : return grfx::FORMAT_R8G8B8A8_UNORM;
+        case 43  : return grfx::FORMAT_R8G8B8A8_SRGB;
+        case 44  : return grfx::FORMAT_B8G8R8A8_UNORM;
+        case 50  : return grfx::FORMAT_B8G8R8A8_SRGB;
+        case 131 : return grfx::FORMAT_BC1_RGB_UNORM;
+        case 132 : return grfx::FORMAT_BC1_RGB_SRGB;
+        case 133 : return grfx::FORMAT_BC1_RGBA_UNORM;
+        case 134 : return grfx::FORMAT_BC1_RGBA_SRGB;
+        case 135 : return grfx::FORMAT_BC2_UNORM;
+        case 136 : return grfx::FORMAT_BC2_SRGB;
+        case 137 : return grfx::FORMAT_BC3_UNORM;
+        case 138 : return grfx::FORMAT_BC3_SRGB;
+        case 139 : return grfx::FORMAT_BC4_UNORM;
+        case 140 : return grfx::FORMAT_BC4_SNORM;
+        case 141 : return grfx::FORMAT_BC5_UNORM;
+        case 142 : return grfx::FORMAT_BC5_SNORM;
+        case 143 : return grfx::FORMAT_BC6H_UFLOAT;
+        case 144 : return grfx::FORMAT_BC6H_SFLOAT;
+        case 145 : return grfx::FORMAT_BC7_UNORM;
+        case 146 : return grfx::FORMAT_BC7_SRGB;
+        default: break;
+    }
+    // clang-format on
+    return grfx::FORMAT_UNDEFINED;
+}
+
+uint32_t GetBlockWidth(grfx::Format format)
+{
+    return grfx::GetFormatDescription(format)->blockWidth;
+}
+
+// Levels are only kept while both dimensions are a whole number of blocks
+bool IsBlockAligned(grfx::Format format, uint32_t width, uint32_t height)
+{
+    const uint32_t blockWidth = GetBlockWidth(format);
+    return (width >= blockWidth) && (height >= blockWidth) && ((width % blockWidth) == 0) && ((height % blockWidth) == 0);
+}
+
+uint64_t CalculateLevelSize(grfx::Format format, uint32_t width, uint32_t height)
+{
+    const uint32_t blockWidth = GetBlockWidth(format);
+    return static_cast<uint64_t>(width / blockWidth) * (height / blockWidth) * grfx::GetFormatDescription(format)->bytesPerTexel;
+}
+
+// Levels in the full chain down to 1x1, at most 32
+uint32_t CalculateMaxLevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t levelCount = 1;
+    for (uint32_t size = std::max<uint32_t>(width, height); size > 1; size >>= 1) {
+        ++levelCount;
+    }
+    return levelCount;
+}
+
+} // namespace
+
+bool TextureFile::IsTextureFile(const std::filesystem::path& path)
+{
+    const std::filesystem::path extension = path.extension();
+    return (extension == ".dds") || (extension == ".ktx") || (extension == ".ktx2");
+}
+
+Result TextureFile::Open(const std::filesystem::path& path)
+{
+    if (!mFile.Open(path, fs::FILE_ACCESS_HINT_RANDOM)) {
+        return ppx::ERROR_IMAGE_FILE_LOAD_FAILED;
+    }
+
+    if (mFile.IsMapped()) {
+        mpData = static_cast<const char*>(mFile.GetMappedData());
+    }
+    else {
+        mStorage.resize(mFile.GetLength());
+        if (mFile.Read(mStorage.data(), mStorage.size()) != mStorage.size()) {
+            return ppx::ERROR_IMAGE_FILE_LOAD_FAILED;
+        }
+        mpData = mStorage.data();
+    }
+    mDataSize = mFile.GetLength();
+
+    Result ppxres = Parse();
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("Unsupported or invalid texture file: " << path);
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result TextureFile::OpenFromMemory(const void* pData, size_t size)
+{
+    PPX_ASSERT_NULL_ARG(pData);
+
+    mpData    = static_cast<const char*>(pData);
+    mDataSize = size;
+
+    return Parse();
+}
+
+Result TextureFile::Parse()
+{
+    mLevels.clear();
+
+    Result ppxres = ppx::ERROR_IMAGE_INVALID_FORMAT;
+    if ((mDataSize >= kDDSDataOffset) && (ReadU32(mpData, 0) == kDDSMagic)) {
+        mType  = TEXTURE_FILE_TYPE_DDS;
+        ppxres = ParseDDS();
+    }
+    else if ((mDataSize >= kKTXHeaderSize) && (memcmp(mpData, kKTXIdentifier, sizeof(kKTXIdentifier)) == 0)) {
+        mType  = TEXTURE_FILE_TYPE_KTX;
+        ppxres = ParseKTX();
+    }
+    else if ((mDataSize >= kKTX2HeaderSize) && (memcmp(mpData, kKTX2Identifier, sizeof(kKTX2Identifier)) == 0)) {
+        mType  = TEXTURE_FILE_TYPE_KTX2;
+        ppxres = ParseKTX2();
+    }
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    if (mLevels.empty()) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result TextureFile::AddLevel(uint32_t width, uint32_t height, uint64_t offset)
+{
+    const uint32_t blockWidth = GetBlockWidth(mFormat);
+
+    TextureFileLevel level = {};
+    level.width            = width;
+    level.height           = height;
+    level.rowCount         = height / blockWidth;
+    level.rowSize          = (width / blockWidth) * grfx::GetFormatDescription(mFormat)->bytesPerTexel;
+    level.offset           = offset;
+    level.size             = static_cast<uint64_t>(level.rowCount) * level.rowSize;
+
+    if ((level.offset > mDataSize) || (level.size > (mDataSize - level.offset))) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    mLevels.push_back(level);
+    return ppx::SUCCESS;
+}
+
+Result TextureFile::ParseDDS()
+{
+    const uint32_t headerSize  = ReadU32(mpData, 4);
+    const uint32_t height      = ReadU32(mpData, 12);
+    const uint32_t width       = ReadU32(mpData, 16);
+    const uint32_t mipCount    = ReadU32(mpData, 28);
+    const uint32_t pfFlags     = ReadU32(mpData, 80);
+    const uint32_t fourCC      = ReadU32(mpData, 84);
+    const uint32_t rgbBitCount = ReadU32(mpData, 88);
+    const uint32_t redMask     = ReadU32(mpData, 92);
+    const uint32_t blueMask    = ReadU32(mpData, 100);
+    const uint32_t caps2       = ReadU32(mpData, 112);
+    uint64_t       offset      = kDDSDataOffset;
+
+    if ((headerSize != kDDSHeaderSize) || ((caps2 & (kDDSCaps2Cubemap | kDDSCaps2Volume)) != 0)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    if ((pfFlags & kDDPFFourCC) && (fourCC == MakeFourCC('D', 'X', '1', '0'))) {
+        if (mDataSize < kDDSDataOffset + kDDSDX10Size) {
+            return ppx::ERROR_IMAGE_INVALID_FORMAT;
+        }
+        const uint32_t dxgiFormat        = ReadU32(mpData, kDDSDataOffset + 0);
+        const uint32_t resourceDimension = ReadU32(mpData, kDDSDataOffset + 4);
+        const uint32_t miscFlag          = ReadU32(mpData, kDDSDataOffset + 8);
+        const uint32_t arraySize         = ReadU32(mpData, kDDSDataOffset + 12);
+
+        // D3D10_RESOURCE_DIMENSION_TEXTURE2D, D3D10_RESOURCE_MISC_TEXTURECUBE
+        if ((resourceDimension != 3) || ((miscFlag & 0x4) != 0) || (arraySize > 1)) {
+            return ppx::ERROR_IMAGE_INVALID_FORMAT;
+        }
+        mFormat = DXGIFormatToGrfxFormat(dxgiFormat);
+        offset += kDDSDX10Size;
+    }
+    else if (pfFlags & kDDPFFourCC) {
+        mFormat = FourCCToGrfxFormat(fourCC);
+    }
+    else if ((pfFlags & kDDPFRGB) && (rgbBitCount == 32)) {
+        if ((redMask == 0x000000FF) && (blueMask == 0x00FF0000)) {
+            mFormat = grfx::FORMAT_R8G8B8A8_UNORM;
+        }
+        else if ((redMask == 0x00FF0000) && (blueMask == 0x000000FF)) {
+            mFormat = grfx::FORMAT_B8G8R8A8_UNORM;
+        }
+    }
+    if (mFormat == grfx::FORMAT_UNDEFINED) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if (!IsBlockAligned(mFormat, width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    // Levels are stored largest first. More levels than the full chain
+    // would shift the dimensions by 32 bits or more.
+    const uint32_t levelCount = std::max<uint32_t>(mipCount, 1);
+    if (levelCount > CalculateMaxLevelCount(width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const uint32_t levelWidth  = std::max<uint32_t>(width >> i, 1);
+        const uint32_t levelHeight = std::max<uint32_t>(height >> i, 1);
+        if (!IsBlockAligned(mFormat, levelWidth, levelHeight)) {
+            break;
+        }
+
+        Result ppxres = AddLevel(levelWidth, levelHeight, offset);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        offset += mLevels.back().size;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result TextureFile::ParseKTX()
+{
+    const uint32_t endianness       = ReadU32(mpData, 12);
+    const uint32_t glInternalFormat = ReadU32(mpData, 28);
+    const uint32_t width            = ReadU32(mpData, 36);
+    const uint32_t height           = ReadU32(mpData, 40);
+    const uint32_t depth            = ReadU32(mpData, 44);
+    const uint32_t arrayElements    = ReadU32(mpData, 48);
+    const uint32_t faces            = ReadU32(mpData, 52);
+    const uint32_t mipCount         = ReadU32(mpData, 56);
+    const uint32_t keyValueSize     = ReadU32(mpData, 60);
+
+    // Files written on big endian machines aren't supported
+    if ((endianness != kKTXEndianness) || (depth > 1) || (arrayElements > 0) || (faces != 1)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    mFormat = GLInternalFormatToGrfxFormat(glInternalFormat);
+    if (mFormat == grfx::FORMAT_UNDEFINED) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if (!IsBlockAligned(mFormat, width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    // Each level is prefixed with its size and padded to 4 bytes, largest first
+    uint64_t       offset     = static_cast<uint64_t>(kKTXHeaderSize) + keyValueSize;
+    const uint32_t levelCount = std::max<uint32_t>(mipCount, 1);
+    if (levelCount > CalculateMaxLevelCount(width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const uint32_t levelWidth  = std::max<uint32_t>(width >> i, 1);
+        const uint32_t levelHeight = std::max<uint32_t>(height >> i, 1);
+        if (!IsBlockAligned(mFormat, levelWidth, levelHeight)) {
+            break;
+        }
+        if (offset + sizeof(uint32_t) > mDataSize) {
+            return ppx::ERROR_IMAGE_INVALID_FORMAT;
+        }
+
+        const uint32_t imageSize = ReadU32(mpData, static_cast<size_t>(offset));
+        if (imageSize != CalculateLevelSize(mFormat, levelWidth, levelHeight)) {
+            return ppx::ERROR_IMAGE_INVALID_FORMAT;
+        }
+
+        Result ppxres = AddLevel(levelWidth, levelHeight, offset + sizeof(uint32_t));
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        offset += sizeof(uint32_t) + RoundUp<uint64_t>(imageSize, 4);
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result TextureFile::ParseKTX2()
+{
+    const uint32_t vkFormat         = ReadU32(mpData, 12);
+    const uint32_t width            = ReadU32(mpData, 20);
+    const uint32_t height           = ReadU32(mpData, 24);
+    const uint32_t depth            = ReadU32(mpData, 28);
+    const uint32_t layerCount       = ReadU32(mpData, 32);
+    const uint32_t faceCount        = ReadU32(mpData, 36);
+    const uint32_t mipCount         = ReadU32(mpData, 40);
+    const uint32_t supercompression = ReadU32(mpData, 44);
+
+    // Basis Universal files have an undefined vkFormat and need transcoding,
+    // zstd and zlib levels would need to be decompressed first.
+    if ((supercompression != 0) || (depth > 1) || (layerCount > 1) || (faceCount != 1)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    mFormat = VkFormatToGrfxFormat(vkFormat);
+    if (mFormat == grfx::FORMAT_UNDEFINED) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if (!IsBlockAligned(mFormat, width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    // The level index is ordered largest first even though the data is
+    // stored smallest first.
+    const uint32_t levelCount = std::max<uint32_t>(mipCount, 1);
+    if (levelCount > CalculateMaxLevelCount(width, height)) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if (kKTX2HeaderSize + static_cast<uint64_t>(levelCount) * kKTX2LevelSize > mDataSize) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const uint32_t levelWidth  = std::max<uint32_t>(width >> i, 1);
+        const uint32_t levelHeight = std::max<uint32_t>(height >> i, 1);
+        if (!IsBlockAligned(mFormat, levelWidth, levelHeight)) {
+            break;
+        }
+
+        const size_t   entryOffset = kKTX2HeaderSize + static_cast<size_t>(i) * kKTX2LevelSize;
+        const uint64_t byteOffset  = ReadU64(mpData, entryOffset + 0);
+        const uint64_t byteLength  = ReadU64(mpData, entryOffset + 8);
+        if (byteLength != CalculateLevelSize(mFormat, levelWidth, levelHeight)) {
+            return ppx::ERROR_IMAGE_INVALID_FORMAT;
+        }
+
+        Result ppxres = AddLevel(levelWidth, levelHeight, byteOffset);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+} // namespace ppx
@@ -0,0 +1,158 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace ppx {
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max<uint32_t>(1, std::thread::hardware_concurrency());
+    }
+
+    mWorkers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        mWorkers.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mTaskAvailable.notify_all();
+
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()>&& task)
+{
+    // Nothing would ever pick the task up
+    if (mWorkers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push_back(std::move(task));
+        ++mPendingCount;
+    }
+    mTaskAvailable.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdle.wait(lock, [this]() { return mPendingCount == 0; });
+}
+
+void ThreadPool::WorkerMain()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskAvailable.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+            // Drain the queue before stopping so WaitIdle() callers don't hang.
+            if (mTasks.empty()) {
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mPendingCount;
+            if (mPendingCount == 0) {
+                mIdle.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Helper tasks can start after this call has returned if the workers
+    // are busy, so everything they touch is kept alive by the shared state.
+    // A late helper finds no indices left and never calls fn.
+    struct State
+    {
+        std::atomic<uint32_t>                next{0};
+        std::atomic<uint32_t>                finished{0};
+        uint32_t                             count = 0;
+        const std::function<void(uint32_t)>* pFn   = nullptr;
+        std::mutex                           mutex;
+        std::condition_variable              done;
+    };
+
+    auto state   = std::make_shared<State>();
+    state->count = count;
+    state->pFn   = &fn;
+
+    auto work = [state]() {
+        for (;;) {
+            uint32_t index = state->next.fetch_add(1);
+            if (index >= state->count) {
+                break;
+            }
+
+            (*state->pFn)(index);
+
+            if ((state->finished.fetch_add(1) + 1) == state->count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    uint32_t helperCount = std::min<uint32_t>(count - 1, GetThreadCount());
+    for (uint32_t i = 0; i < helperCount; ++i) {
+        Submit(work);
+    }
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->finished.load() == state->count; });
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+    static ThreadPool sDefaultPool;
+    return sDefaultPool;
+}
+
+std::unique_ptr<ThreadPool> ThreadPool::CreateSerial()
+{
+    return std::unique_ptr<ThreadPool>(new ThreadPool(SerialTag{}));
+}
+
+} // namespace ppx
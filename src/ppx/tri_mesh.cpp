@@ -19,6 +19,8 @@
 
 #include "tiny_obj_loader.h"
 
+#include <unordered_map>
+
 namespace ppx {
 
 TriMesh::TriMesh()
@@ -900,6 +902,30 @@ TriMesh TriMesh::CreateSphere(float radius, uint32_t usegs, uint32_t vsegs, cons
     return mesh;
 }
 
+// Key used to weld OBJ vertices: tinyobj::index_t's position, normal and texcoord indices
+struct ObjVertexKey
+{
+    int vertexIndex;
+    int normalIndex;
+    int texCoordIndex;
+
+    bool operator==(const ObjVertexKey& rhs) const
+    {
+        return (vertexIndex == rhs.vertexIndex) && (normalIndex == rhs.normalIndex) && (texCoordIndex == rhs.texCoordIndex);
+    }
+};
+
+struct ObjVertexKeyHasher
+{
+    size_t operator()(const ObjVertexKey& key) const
+    {
+        uint64_t hash = static_cast<uint32_t>(key.vertexIndex);
+        hash          = (hash * 0x9E3779B97F4A7C15ull) ^ static_cast<uint32_t>(key.normalIndex);
+        hash          = (hash * 0x9E3779B97F4A7C15ull) ^ static_cast<uint32_t>(key.texCoordIndex);
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+};
+
 Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOptions& options, TriMesh* pTriMesh)
 {
     if (IsNull(pTriMesh)) {
@@ -910,8 +936,11 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
     PPX_ASSERT_MSG(timer.Start() == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
     double fnStartTime = timer.SecondsSinceStart();
 
+    // Welded meshes pick their index type once the vertex count is known
+    const bool weldVertices = options.mWeldVertices;
+
     // Determine index type and tex coord dim
-    grfx::IndexType     indexType   = options.mEnableIndices ? grfx::INDEX_TYPE_UINT32 : grfx::INDEX_TYPE_UNDEFINED;
+    grfx::IndexType     indexType   = (options.mEnableIndices && !weldVertices) ? grfx::INDEX_TYPE_UINT32 : grfx::INDEX_TYPE_UNDEFINED;
     TriMeshAttributeDim texCoordDim = options.mEnableTexCoords ? TRI_MESH_ATTRIBUTE_DIM_2 : TRI_MESH_ATTRIBUTE_DIM_UNDEFINED;
 
     // Create new mesh
@@ -982,11 +1011,62 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
     for (size_t shapeIdx = 0; shapeIdx < numShapes; ++shapeIdx) {
         totalTriangles += shapes[shapeIdx].mesh.indices.size() / 3;
     }
-    pTriMesh->PreallocateForTriangleCount(totalTriangles,
-                                          /* enableColors= */ (options.mEnableVertexColors || options.mEnableObjectColor),
-                                          options.mEnableNormals,
-                                          options.mEnableTexCoords,
-                                          options.mEnableTangents);
+    if (!weldVertices) {
+        pTriMesh->PreallocateForTriangleCount(totalTriangles,
+                                              /* enableColors= */ (options.mEnableVertexColors || options.mEnableObjectColor),
+                                              options.mEnableNormals,
+                                              options.mEnableTexCoords,
+                                              options.mEnableTangents);
+    }
+
+    // Vertex welding
+    //
+    // Each unique (vertex, normal, texcoord) index triple becomes one vertex.
+    // Colors are taken from the first triangle that references a vertex.
+    // Tangents and bitangents are accumulated over all triangles that
+    // reference a vertex and are orthonormalized once all triangles are in.
+    //
+    std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHasher> weldMap;
+    std::vector<uint32_t>                                          weldIndices;
+    std::vector<float3>                                            weldNormals;
+    std::vector<float3>                                            weldTangents;
+    std::vector<float3>                                            weldBitangents;
+    if (weldVertices) {
+        weldMap.reserve(attrib.vertices.size() / 3);
+        weldIndices.reserve(totalTriangles * 3);
+    }
+
+    auto weldVertex = [&](const tinyobj::index_t& dataIdx, const float3& position, const TriMeshVertexData& vtx, const float3& tangent, const float3& bitangent) -> uint32_t {
+        ObjVertexKey key = {dataIdx.vertex_index, dataIdx.normal_index, dataIdx.texcoord_index};
+
+        auto it = weldMap.find(key);
+        if (it != weldMap.end()) {
+            if (options.mEnableTangents) {
+                weldTangents[it->second] += tangent;
+                weldBitangents[it->second] += bitangent;
+            }
+            return it->second;
+        }
+
+        uint32_t vertexIndex = pTriMesh->AppendPosition(position) - 1;
+        if (options.mEnableVertexColors || options.mEnableObjectColor) {
+            pTriMesh->AppendColor(vtx.color);
+        }
+        if (options.mEnableNormals) {
+            pTriMesh->AppendNormal(vtx.normal);
+        }
+        if (options.mEnableTexCoords) {
+            pTriMesh->AppendTexCoord(vtx.texCoord);
+        }
+        if (options.mEnableTangents) {
+            weldNormals.push_back(vtx.normal);
+            weldTangents.push_back(tangent);
+            weldBitangents.push_back(bitangent);
+        }
+
+        weldMap.emplace(key, vertexIndex);
+        return vertexIndex;
+    };
 
     // Build geometry
     for (size_t shapeIdx = 0; shapeIdx < numShapes; ++shapeIdx) {
@@ -1011,9 +1091,12 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
 
             // Pick a face color
             float3 faceColor = colors[triIdx % colors.size()];
-            vtx0.color       = faceColor;
-            vtx1.color       = faceColor;
-            vtx2.color       = faceColor;
+            if (options.mEnableObjectColor) {
+                faceColor = options.mObjectColor;
+            }
+            vtx0.color = faceColor;
+            vtx1.color = faceColor;
+            vtx2.color = faceColor;
 
             // Vertex positions
             {
@@ -1081,16 +1164,43 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
             float3 pos1 = (vtx1.position * options.mScale) + options.mTranslate;
             float3 pos2 = (vtx2.position * options.mScale) + options.mTranslate;
 
+            // Face tangent and bitangent
+            float3 tangent   = float3(0, 0, 0);
+            float3 bitangent = float3(0, 0, 0);
+            if (options.mEnableTangents) {
+                float3 edge1 = vtx1.position - vtx0.position;
+                float3 edge2 = vtx2.position - vtx0.position;
+                float2 duv1  = vtx1.texCoord - vtx0.texCoord;
+                float2 duv2  = vtx2.texCoord - vtx0.texCoord;
+                float  r     = 1.0f / (duv1.x * duv2.y - duv1.y * duv2.x);
+
+                tangent = float3(
+                    ((edge1.x * duv2.y) - (edge2.x * duv1.y)) * r,
+                    ((edge1.y * duv2.y) - (edge2.y * duv1.y)) * r,
+                    ((edge1.z * duv2.y) - (edge2.z * duv1.y)) * r);
+
+                bitangent = float3(
+                    ((edge1.x * duv2.x) - (edge2.x * duv1.x)) * r,
+                    ((edge1.y * duv2.x) - (edge2.y * duv1.x)) * r,
+                    ((edge1.z * duv2.x) - (edge2.z * duv1.x)) * r);
+            }
+
+            if (weldVertices) {
+                uint32_t triVtx0 = weldVertex(dataIdx0, pos0, vtx0, tangent, bitangent);
+                uint32_t triVtx1 = weldVertex(dataIdx1, pos1, vtx1, tangent, bitangent);
+                uint32_t triVtx2 = weldVertex(dataIdx2, pos2, vtx2, tangent, bitangent);
+
+                weldIndices.push_back(triVtx0);
+                weldIndices.push_back(options.mInvertWinding ? triVtx2 : triVtx1);
+                weldIndices.push_back(options.mInvertWinding ? triVtx1 : triVtx2);
+                continue;
+            }
+
             uint32_t triVtx0 = pTriMesh->AppendPosition(pos0) - 1;
             uint32_t triVtx1 = pTriMesh->AppendPosition(pos1) - 1;
             uint32_t triVtx2 = pTriMesh->AppendPosition(pos2) - 1;
 
             if (options.mEnableVertexColors || options.mEnableObjectColor) {
-                if (options.mEnableObjectColor) {
-                    vtx0.color = options.mObjectColor;
-                    vtx1.color = options.mObjectColor;
-                    vtx2.color = options.mObjectColor;
-                }
                 pTriMesh->AppendColor(vtx0.color);
                 pTriMesh->AppendColor(vtx1.color);
                 pTriMesh->AppendColor(vtx2.color);
@@ -1109,22 +1219,6 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
             }
 
             if (options.mEnableTangents) {
-                float3 edge1 = vtx1.position - vtx0.position;
-                float3 edge2 = vtx2.position - vtx0.position;
-                float2 duv1  = vtx1.texCoord - vtx0.texCoord;
-                float2 duv2  = vtx2.texCoord - vtx0.texCoord;
-                float  r     = 1.0f / (duv1.x * duv2.y - duv1.y * duv2.x);
-
-                float3 tangent = float3(
-                    ((edge1.x * duv2.y) - (edge2.x * duv1.y)) * r,
-                    ((edge1.y * duv2.y) - (edge2.y * duv1.y)) * r,
-                    ((edge1.z * duv2.y) - (edge2.z * duv1.y)) * r);
-
-                float3 bitangent = float3(
-                    ((edge1.x * duv2.x) - (edge2.x * duv1.x)) * r,
-                    ((edge1.y * duv2.x) - (edge2.y * duv1.x)) * r,
-                    ((edge1.z * duv2.x) - (edge2.z * duv1.x)) * r);
-
                 tangent = glm::normalize(tangent - vtx0.normal * glm::dot(vtx0.normal, tangent));
                 float w = 1.0f;
 
@@ -1147,6 +1241,34 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
         }
     }
 
+    if (weldVertices) {
+        // Pick the smallest index type that can address every welded vertex
+        uint32_t vertexCount = pTriMesh->GetCountPositions();
+        pTriMesh->mIndexType = (vertexCount <= UINT16_MAX) ? grfx::INDEX_TYPE_UINT16 : grfx::INDEX_TYPE_UINT32;
+        pTriMesh->mIndices.reserve(weldIndices.size() * grfx::IndexTypeSize(pTriMesh->mIndexType));
+        for (size_t i = 0; (i + 2) < weldIndices.size(); i += 3) {
+            pTriMesh->AppendTriangle(weldIndices[i + 0], weldIndices[i + 1], weldIndices[i + 2]);
+        }
+
+        if (options.mEnableTangents) {
+            for (uint32_t i = 0; i < vertexCount; ++i) {
+                const float3& normal  = weldNormals[i];
+                float3        tangent = weldTangents[i] - normal * glm::dot(normal, weldTangents[i]);
+                if (glm::length(tangent) > 0.0f) {
+                    tangent = glm::normalize(tangent);
+                }
+                float3 bitangent = weldBitangents[i];
+                if (glm::length(bitangent) > 0.0f) {
+                    bitangent = glm::normalize(bitangent);
+                }
+                float w = 1.0f;
+
+                pTriMesh->AppendTangent(float4(-tangent, w));
+                pTriMesh->AppendBitangent(-bitangent);
+            }
+        }
+    }
+
     //if (options.mEnableTangents) {
     //    size_t numPositions  = mesh.mPositions.size();
     //    size_t numNormals    = mesh.mNormals.size();
@@ -1162,7 +1284,7 @@ Result TriMesh::CreateFromOBJ(const std::filesystem::path& path, const TriMeshOp
 
     double fnEndTime = timer.SecondsSinceStart();
     float  fnElapsed = static_cast<float>(fnEndTime - fnStartTime);
-    PPX_LOG_INFO("Created mesh from OBJ file: " << path << " (" << FloatString(fnElapsed) << " seconds, " << numShapes << " shapes, " << totalTriangles << " triangles)");
+    PPX_LOG_INFO("Created mesh from OBJ file: " << path << " (" << FloatString(fnElapsed) << " seconds, " << numShapes << " shapes, " << totalTriangles << " triangles, " << pTriMesh->GetCountPositions() << " vertices)");
 
     return ppx::SUCCESS;
 }
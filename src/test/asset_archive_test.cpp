@@ -0,0 +1,289 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/asset_archive.h"
+#include "ppx/fs.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ppx {
+namespace {
+
+std::vector<char> MakeCompressibleData(size_t size, uint32_t seed)
+{
+    std::mt19937      rng(seed);
+    std::vector<char> data(size);
+    const std::string words[] = {"vertex ", "normal ", "texcoord ", "0.25 ", "-1.0 ", "\n"};
+    size_t            pos     = 0;
+    while (pos < size) {
+        const std::string& word = words[rng() % 6];
+        for (size_t i = 0; (i < word.size()) && (pos < size); ++i) {
+            data[pos++] = word[i];
+        }
+    }
+    return data;
+}
+
+std::vector<char> MakeRandomData(size_t size, uint32_t seed)
+{
+    std::mt19937      rng(seed);
+    std::vector<char> data(size);
+    for (auto& c : data) {
+        c = static_cast<char>(rng());
+    }
+    return data;
+}
+
+class AssetArchiveTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        mArchivePath           = std::filesystem::temp_directory_path() / ("ppx_asset_archive_test_" + name + ".pak");
+    }
+
+    void TearDown() override
+    {
+        fs::UnmountArchive(mArchivePath);
+        std::filesystem::remove(mArchivePath);
+    }
+
+    std::filesystem::path mArchivePath;
+};
+
+} // namespace
+
+TEST(Lz4Test, RoundTrip)
+{
+    const std::vector<std::vector<char>> inputs = {
+        {},
+        {'a'},
+        std::vector<char>(12, 'x'),
+        std::vector<char>(13, 'x'),
+        std::vector<char>(100000, 'z'),
+        MakeCompressibleData(300000, 1),
+        MakeRandomData(70000, 2),
+    };
+
+    for (const auto& input : inputs) {
+        std::vector<char> compressed;
+        Lz4CompressBlock(input.data(), input.size(), &compressed);
+
+        std::vector<char> output(input.size());
+        ASSERT_TRUE(Lz4DecompressBlock(compressed.data(), compressed.size(), output.data(), output.size()));
+        EXPECT_EQ(output, input);
+    }
+}
+
+TEST(Lz4Test, CompressesRepetitiveData)
+{
+    std::vector<char> input = MakeCompressibleData(100000, 3);
+    std::vector<char> compressed;
+    Lz4CompressBlock(input.data(), input.size(), &compressed);
+    EXPECT_LT(compressed.size(), input.size() / 2);
+}
+
+TEST(Lz4Test, RejectsCorruptData)
+{
+    std::vector<char> input = MakeCompressibleData(10000, 4);
+    std::vector<char> compressed;
+    Lz4CompressBlock(input.data(), input.size(), &compressed);
+
+    std::vector<char> output(input.size());
+    EXPECT_FALSE(Lz4DecompressBlock(compressed.data(), compressed.size() / 2, output.data(), output.size()));
+    EXPECT_FALSE(Lz4DecompressBlock(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+
+    // Offset pointing before the start of the output
+    const char badOffset[] = {0x10, 'a', 0x05, 0x00};
+    EXPECT_FALSE(Lz4DecompressBlock(badOffset, sizeof(badOffset), output.data(), 5));
+}
+
+TEST(AssetArchiveNameTest, NormalizeName)
+{
+    EXPECT_EQ(AssetArchive::NormalizeName("a/b.txt"), "a/b.txt");
+    EXPECT_EQ(AssetArchive::NormalizeName("./a//b.txt"), "a/b.txt");
+    EXPECT_EQ(AssetArchive::NormalizeName("a\\c\\..\\b.txt"), "a/b.txt");
+    EXPECT_EQ(AssetArchive::NormalizeName("/a/b/"), "a/b");
+    EXPECT_EQ(AssetArchive::NormalizeName("."), "");
+
+    EXPECT_TRUE(AssetArchive::IsLexicallyNormal("a/b.txt"));
+    EXPECT_TRUE(AssetArchive::IsLexicallyNormal("/a/.b/c..d"));
+    EXPECT_FALSE(AssetArchive::IsLexicallyNormal("a//b.txt"));
+    EXPECT_FALSE(AssetArchive::IsLexicallyNormal("a/./b.txt"));
+    EXPECT_FALSE(AssetArchive::IsLexicallyNormal("../b.txt"));
+    EXPECT_FALSE(AssetArchive::IsLexicallyNormal("a/"));
+    EXPECT_FALSE(AssetArchive::IsLexicallyNormal("a\\b"));
+}
+
+TEST_F(AssetArchiveTest, WriteAndRead)
+{
+    const std::vector<char> text   = MakeCompressibleData(50000, 5);
+    const std::vector<char> binary = MakeRandomData(5000, 6);
+
+    AssetArchiveWriter writer;
+    ASSERT_EQ(writer.AddEntry("shaders/a.spv", binary.data(), binary.size()), ppx::SUCCESS);
+    ASSERT_EQ(writer.AddEntry("models\\mesh.obj", text.data(), text.size(), ASSET_COMPRESSION_LZ4), ppx::SUCCESS);
+    ASSERT_EQ(writer.AddEntry("random.bin", binary.data(), binary.size(), ASSET_COMPRESSION_LZ4), ppx::SUCCESS);
+    ASSERT_EQ(writer.AddEntry("empty", nullptr, 0), ppx::SUCCESS);
+    EXPECT_EQ(writer.AddEntry("./shaders/a.spv", text.data(), text.size()), ppx::ERROR_ASSET_ARCHIVE_DUPLICATE_ENTRY);
+    ASSERT_EQ(writer.Write(mArchivePath), ppx::SUCCESS);
+
+    EXPECT_TRUE(AssetArchive::IsArchive(mArchivePath));
+
+    AssetArchive archive;
+    ASSERT_EQ(archive.Open(mArchivePath), ppx::SUCCESS);
+    EXPECT_EQ(archive.GetEntryCount(), 4u);
+
+    const AssetArchiveEntry* pShader = archive.FindEntry(std::filesystem::path("shaders/a.spv"));
+    ASSERT_NE(pShader, nullptr);
+    EXPECT_EQ(pShader->compression, ASSET_COMPRESSION_NONE);
+    EXPECT_EQ(pShader->dataOffset % kAssetArchiveAlignment, 0u);
+    EXPECT_EQ(archive.GetEntryName(*pShader), "shaders/a.spv");
+    EXPECT_EQ(memcmp(archive.GetStoredData(*pShader), binary.data(), binary.size()), 0);
+
+    const AssetArchiveEntry* pMesh = archive.FindEntry(std::filesystem::path("models/mesh.obj"));
+    ASSERT_NE(pMesh, nullptr);
+    EXPECT_EQ(pMesh->compression, ASSET_COMPRESSION_LZ4);
+    EXPECT_LT(pMesh->storedSize, pMesh->size);
+    std::vector<char> data;
+    ASSERT_EQ(archive.ReadEntry(*pMesh, &data), ppx::SUCCESS);
+    EXPECT_EQ(data, text);
+
+    // Random data doesn't compress so it's stored as is
+    const AssetArchiveEntry* pRandom = archive.FindEntry(std::filesystem::path("random.bin"));
+    ASSERT_NE(pRandom, nullptr);
+    EXPECT_EQ(pRandom->compression, ASSET_COMPRESSION_NONE);
+
+    const AssetArchiveEntry* pEmpty = archive.FindEntry(std::filesystem::path("empty"));
+    ASSERT_NE(pEmpty, nullptr);
+    EXPECT_EQ(pEmpty->size, 0u);
+
+    EXPECT_EQ(archive.FindEntry(std::filesystem::path("shaders")), nullptr);
+    EXPECT_EQ(archive.FindEntry(std::filesystem::path("missing.txt")), nullptr);
+    EXPECT_TRUE(archive.ContainsDirectory("shaders"));
+    EXPECT_FALSE(archive.ContainsDirectory("shader"));
+}
+
+TEST_F(AssetArchiveTest, ManyEntries)
+{
+    AssetArchiveWriter writer;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        const std::string content = "content " + std::to_string(i);
+        ASSERT_EQ(writer.AddEntry("dir" + std::to_string(i % 7) + "/file" + std::to_string(i), content.data(), content.size()), ppx::SUCCESS);
+    }
+    ASSERT_EQ(writer.Write(mArchivePath), ppx::SUCCESS);
+
+    AssetArchive archive;
+    ASSERT_EQ(archive.Open(mArchivePath), ppx::SUCCESS);
+    ASSERT_EQ(archive.GetEntryCount(), 1000u);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        const AssetArchiveEntry* pEntry = archive.FindEntry(std::filesystem::path("dir" + std::to_string(i % 7) + "/file" + std::to_string(i)));
+        ASSERT_NE(pEntry, nullptr);
+        std::vector<char> data;
+        ASSERT_EQ(archive.ReadEntry(*pEntry, &data), ppx::SUCCESS);
+        EXPECT_EQ(std::string(data.begin(), data.end()), "content " + std::to_string(i));
+    }
+}
+
+TEST_F(AssetArchiveTest, OpenInvalidArchiveFails)
+{
+    {
+        std::ofstream os(mArchivePath, std::ios::binary);
+        os << "PPXARCH not really an archive";
+    }
+    EXPECT_FALSE(AssetArchive::IsArchive(mArchivePath));
+
+    AssetArchive archive;
+    EXPECT_EQ(archive.Open(mArchivePath), ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT);
+    EXPECT_FALSE(fs::MountArchive(mArchivePath));
+}
+
+TEST_F(AssetArchiveTest, OpenRejectsImplausibleDecompressedSize)
+{
+    const std::vector<char> text = MakeCompressibleData(50000, 7);
+
+    AssetArchiveWriter writer;
+    ASSERT_EQ(writer.AddEntry("models/mesh.obj", text.data(), text.size(), ASSET_COMPRESSION_LZ4), ppx::SUCCESS);
+    ASSERT_EQ(writer.Write(mArchivePath), ppx::SUCCESS);
+
+    // Patch the entry's decompressed size past what its stored data can
+    // expand to, ReadEntry() would otherwise allocate whatever it says
+    {
+        std::fstream       file(mArchivePath, std::ios::binary | std::ios::in | std::ios::out);
+        AssetArchiveHeader header = {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        AssetArchiveEntry entry = {};
+        file.seekg(static_cast<std::streamoff>(header.indexOffset));
+        file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        ASSERT_EQ(entry.compression, ASSET_COMPRESSION_LZ4);
+        entry.size = entry.storedSize * 255 + 1;
+        file.seekp(static_cast<std::streamoff>(header.indexOffset));
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        ASSERT_TRUE(file.good());
+    }
+
+    AssetArchive archive;
+    EXPECT_EQ(archive.Open(mArchivePath), ppx::ERROR_ASSET_ARCHIVE_INVALID_FORMAT);
+}
+
+TEST_F(AssetArchiveTest, MountedArchiveIsServedByFs)
+{
+    const std::string       shader = "not really spir-v";
+    const std::vector<char> text   = MakeCompressibleData(20000, 7);
+
+    AssetArchiveWriter writer;
+    ASSERT_EQ(writer.AddEntry("shaders/a.spv", shader.data(), shader.size()), ppx::SUCCESS);
+    ASSERT_EQ(writer.AddEntry("models/mesh.obj", text.data(), text.size(), ASSET_COMPRESSION_LZ4), ppx::SUCCESS);
+    ASSERT_EQ(writer.Write(mArchivePath), ppx::SUCCESS);
+
+    EXPECT_FALSE(fs::path_exists(mArchivePath / "shaders/a.spv"));
+    ASSERT_TRUE(fs::MountArchive(mArchivePath));
+
+    EXPECT_TRUE(fs::path_exists(mArchivePath));
+    EXPECT_TRUE(fs::path_exists(mArchivePath / "shaders/a.spv"));
+    EXPECT_TRUE(fs::path_exists(mArchivePath / "shaders"));
+    EXPECT_FALSE(fs::path_exists(mArchivePath / "shaders/b.spv"));
+
+    {
+        fs::File file;
+        ASSERT_TRUE(file.Open(mArchivePath / "shaders/a.spv"));
+        ASSERT_TRUE(file.IsMapped());
+        EXPECT_EQ(std::string(static_cast<const char*>(file.GetMappedData()), file.GetLength()), shader);
+    }
+    {
+        fs::File file;
+        EXPECT_FALSE(file.Open(mArchivePath / "shaders/b.spv"));
+        EXPECT_FALSE(file.IsValid());
+    }
+
+    auto mesh = fs::load_file(mArchivePath / "models/../models/mesh.obj");
+    ASSERT_TRUE(mesh.has_value());
+    EXPECT_EQ(mesh.value(), text);
+
+    // Open files keep the archive alive after it's unmounted
+    fs::File file;
+    ASSERT_TRUE(file.Open(mArchivePath / "models/mesh.obj"));
+    fs::UnmountArchive(mArchivePath);
+    EXPECT_FALSE(fs::path_exists(mArchivePath / "shaders/a.spv"));
+    EXPECT_EQ(std::string(static_cast<const char*>(file.GetMappedData()), 64), std::string(text.data(), 64));
+}
+
+} // namespace ppx
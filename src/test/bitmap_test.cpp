@@ -0,0 +1,155 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/bitmap.h"
+#include "ppx/mipmap.h"
+
+#include <cstring>
+#include <random>
+
+using namespace ppx;
+
+namespace {
+
+void FillRandom(Bitmap& bitmap, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    for (uint32_t y = 0; y < bitmap.GetHeight(); ++y) {
+        char* pRow = bitmap.GetData() + y * bitmap.GetRowStride();
+        if (Bitmap::ChannelDataType(bitmap.GetFormat()) == Bitmap::DATA_TYPE_FLOAT) {
+            std::uniform_real_distribution<float> dist(-1.0f, 4.0f);
+            float*                                pValues = reinterpret_cast<float*>(pRow);
+            for (uint32_t i = 0; i < bitmap.GetWidth() * bitmap.GetChannelCount(); ++i) {
+                pValues[i] = dist(rng);
+            }
+        }
+        else {
+            for (uint32_t i = 0; i < bitmap.GetWidth() * bitmap.GetPixelStride(); ++i) {
+                pRow[i] = static_cast<char>(rng());
+            }
+        }
+    }
+}
+
+// Resizes with stb_image_resize directly, using the same parameters as Bitmap::ScaleTo
+void ReferenceBoxResize(const Bitmap& src, Bitmap* pDst)
+{
+    stbir_datatype datatype = STBIR_TYPE_UINT8;
+    switch (Bitmap::ChannelDataType(src.GetFormat())) {
+        default: break;
+        case Bitmap::DATA_TYPE_UINT16: datatype = STBIR_TYPE_UINT16; break;
+        case Bitmap::DATA_TYPE_FLOAT: datatype = STBIR_TYPE_FLOAT; break;
+    }
+
+    int res = stbir_resize(
+        src.GetData(),
+        static_cast<int>(src.GetWidth()),
+        static_cast<int>(src.GetHeight()),
+        static_cast<int>(src.GetRowStride()),
+        pDst->GetData(),
+        static_cast<int>(pDst->GetWidth()),
+        static_cast<int>(pDst->GetHeight()),
+        static_cast<int>(pDst->GetRowStride()),
+        datatype,
+        static_cast<int>(src.GetChannelCount()),
+        -1,
+        0,
+        STBIR_EDGE_CLAMP,
+        STBIR_EDGE_CLAMP,
+        STBIR_FILTER_BOX,
+        STBIR_FILTER_BOX,
+        STBIR_COLORSPACE_LINEAR,
+        nullptr);
+    ASSERT_NE(res, 0);
+}
+
+void ExpectSamePixels(const Bitmap& a, const Bitmap& b)
+{
+    ASSERT_EQ(a.GetWidth(), b.GetWidth());
+    ASSERT_EQ(a.GetHeight(), b.GetHeight());
+    for (uint32_t y = 0; y < a.GetHeight(); ++y) {
+        const char* pRowA = a.GetData() + y * a.GetRowStride();
+        const char* pRowB = b.GetData() + y * b.GetRowStride();
+        ASSERT_EQ(std::memcmp(pRowA, pRowB, a.GetWidth() * a.GetPixelStride()), 0) << "row " << y;
+    }
+}
+
+} // namespace
+
+const Bitmap::Format kBoxFilterFormats[] = {
+    Bitmap::FORMAT_RGBA_UINT8,
+    Bitmap::FORMAT_RGBA_UINT16,
+    Bitmap::FORMAT_RGBA_FLOAT,
+    Bitmap::FORMAT_RGB_UINT8,
+    Bitmap::FORMAT_R_FLOAT,
+};
+
+TEST(BitmapTest, BoxFilterHalfSizeMatchesStbir)
+{
+    for (Bitmap::Format format : kBoxFilterFormats) {
+        SCOPED_TRACE(format);
+
+        // Large enough to be split across threads
+        Bitmap src = Bitmap::Create(1024, 768, format);
+        ASSERT_TRUE(src.IsOk());
+        FillRandom(src, 42);
+
+        Bitmap dst      = Bitmap::Create(512, 384, format);
+        Bitmap expected = Bitmap::Create(512, 384, format);
+        ASSERT_EQ(src.ScaleTo(&dst, STBIR_FILTER_BOX), ppx::SUCCESS);
+        ReferenceBoxResize(src, &expected);
+
+        ExpectSamePixels(dst, expected);
+    }
+}
+
+TEST(BitmapTest, BoxFilterOddSizeMatchesStbir)
+{
+    for (Bitmap::Format format : kBoxFilterFormats) {
+        SCOPED_TRACE(format);
+
+        Bitmap src = Bitmap::Create(37, 21, format);
+        FillRandom(src, 7);
+
+        Bitmap dst      = Bitmap::Create(18, 10, format);
+        Bitmap expected = Bitmap::Create(18, 10, format);
+        ASSERT_EQ(src.ScaleTo(&dst, STBIR_FILTER_BOX), ppx::SUCCESS);
+        ReferenceBoxResize(src, &expected);
+
+        ExpectSamePixels(dst, expected);
+    }
+}
+
+TEST(BitmapTest, MipmapLevelsMatchStbir)
+{
+    for (Bitmap::Format format : kBoxFilterFormats) {
+        SCOPED_TRACE(format);
+
+        Bitmap src = Bitmap::Create(256, 64, format);
+        FillRandom(src, 3);
+
+        Mipmap mipmap(src, PPX_REMAINING_MIP_LEVELS);
+        ASSERT_TRUE(mipmap.IsOk());
+        ASSERT_EQ(mipmap.GetLevelCount(), 7u);
+
+        for (uint32_t level = 1; level < mipmap.GetLevelCount(); ++level) {
+            const Bitmap* pPrev    = mipmap.GetMip(level - 1);
+            Bitmap        expected = Bitmap::Create(pPrev->GetWidth() / 2, pPrev->GetHeight() / 2, format);
+            ReferenceBoxResize(*pPrev, &expected);
+            ExpectSamePixels(*mipmap.GetMip(level), expected);
+        }
+    }
+}
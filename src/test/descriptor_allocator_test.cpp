@@ -0,0 +1,312 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_descriptor_allocator.h"
+
+#include <memory>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+// Pools and sets live in the allocator instead of a device
+class FakeDescriptorSetAllocator : public grfx::DescriptorSetAllocator
+{
+public:
+    FakeDescriptorSetAllocator(uint32_t frameCount, uint32_t setsPerPool)
+    {
+        grfx::DescriptorSetAllocatorCreateInfo createInfo = {};
+        createInfo.frameCount                             = frameCount;
+        createInfo.setsPerPool                            = setsPerPool;
+        EXPECT_EQ(Create(&createInfo), ppx::SUCCESS);
+    }
+
+    ~FakeDescriptorSetAllocator()
+    {
+        DestroyApiObjects();
+    }
+
+    const FakeDescriptorPool* GetPool(size_t index) const { return mPools[index].get(); }
+
+protected:
+    Result CreatePool(const grfx::DescriptorPoolCreateInfo* pCreateInfo, grfx::DescriptorPool** ppPool) override
+    {
+        mPools.push_back(std::make_unique<FakeDescriptorPool>(pCreateInfo));
+        *ppPool = mPools.back().get();
+        return ppx::SUCCESS;
+    }
+
+    void DestroyPool(grfx::DescriptorPool* pPool) override {}
+
+    Result AllocateSet(grfx::DescriptorPool* pPool, const grfx::DescriptorSetLayout* pLayout, grfx::DescriptorSet** ppSet) override
+    {
+        mSets.push_back(std::make_unique<FakeDescriptorSet>(pPool, pLayout));
+        *ppSet = mSets.back().get();
+        return ppx::SUCCESS;
+    }
+
+    void FreeSet(grfx::DescriptorSet* pSet) override {}
+
+private:
+    std::vector<std::unique_ptr<FakeDescriptorPool>> mPools;
+    std::vector<std::unique_ptr<FakeDescriptorSet>>  mSets;
+};
+
+// Resources come from a device so they have registry handles
+grfx::BufferPtr CreateUniformBuffer(FakeDevice& device)
+{
+    grfx::BufferCreateInfo createInfo        = {};
+    createInfo.size                          = PPX_CONSTANT_BUFFER_ALIGNMENT;
+    createInfo.usageFlags.bits.uniformBuffer = true;
+    createInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+    grfx::BufferPtr buffer;
+    EXPECT_EQ(device.CreateBuffer(&createInfo, &buffer), ppx::SUCCESS);
+    return buffer;
+}
+
+grfx::WriteDescriptor UniformBufferWrite(const grfx::Buffer* pBuffer)
+{
+    grfx::WriteDescriptor write = {};
+    write.binding               = 0;
+    write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.bufferOffset          = 0;
+    write.bufferRange           = PPX_WHOLE_SIZE;
+    write.pBuffer               = pBuffer;
+    return write;
+}
+
+uint32_t GetUpdateCount(const grfx::DescriptorSet* pSet)
+{
+    return static_cast<const FakeDescriptorSet*>(pSet)->GetUpdateCount();
+}
+
+} // namespace
+
+TEST(DescriptorSetAllocatorTest, CacheHitSkipsUpdate)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffer = CreateUniformBuffer(device);
+
+    grfx::WriteDescriptor write = UniformBufferWrite(buffer);
+    grfx::DescriptorSet*  pSetA = nullptr;
+    grfx::DescriptorSet*  pSetB = nullptr;
+
+    allocator.BeginFrame(0);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSetA), ppx::SUCCESS);
+    allocator.BeginFrame(1);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSetB), ppx::SUCCESS);
+    EXPECT_EQ(pSetA, pSetB);
+    EXPECT_EQ(GetUpdateCount(pSetA), 1u);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.requestCount, 2u);
+    EXPECT_EQ(stats.cacheHitCount, 1u);
+    EXPECT_EQ(stats.updateCount, 1u);
+    EXPECT_EQ(stats.allocationCount, 1u);
+    EXPECT_EQ(stats.poolCount, 1u);
+    EXPECT_EQ(stats.poolResetCount, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, FramesKeepSeparateSets)
+{
+    FakeDescriptorSetAllocator allocator(2, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffer = CreateUniformBuffer(device);
+
+    grfx::WriteDescriptor write    = UniformBufferWrite(buffer);
+    grfx::DescriptorSet*  pSets[3] = {};
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        allocator.BeginFrame(i);
+        ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSets[i]), ppx::SUCCESS);
+    }
+    EXPECT_NE(pSets[0], pSets[1]);
+    EXPECT_EQ(pSets[0], pSets[2]);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.cacheHitCount, 1u);
+    EXPECT_EQ(stats.allocationCount, 2u);
+    EXPECT_EQ(stats.poolCount, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, MissKeepsSetsFromLastEpoch)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffers[3] = {CreateUniformBuffer(device), CreateUniformBuffer(device), CreateUniformBuffer(device)};
+
+    grfx::WriteDescriptor writeA = UniformBufferWrite(buffers[0]);
+    grfx::WriteDescriptor writeB = UniformBufferWrite(buffers[1]);
+    grfx::WriteDescriptor writeC = UniformBufferWrite(buffers[2]);
+    grfx::DescriptorSet*  pSetA  = nullptr;
+    grfx::DescriptorSet*  pSetB  = nullptr;
+    grfx::DescriptorSet*  pSet   = nullptr;
+
+    allocator.BeginFrame(0);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeA, &pSetA), ppx::SUCCESS);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeB, &pSetB), ppx::SUCCESS);
+
+    // C is new this frame, it must not take the set of A or B
+    allocator.BeginFrame(1);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeC, &pSet), ppx::SUCCESS);
+    EXPECT_NE(pSet, pSetA);
+    EXPECT_NE(pSet, pSetB);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeA, &pSet), ppx::SUCCESS);
+    EXPECT_EQ(pSet, pSetA);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeB, &pSet), ppx::SUCCESS);
+    EXPECT_EQ(pSet, pSetB);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.cacheHitCount, 2u);
+    EXPECT_EQ(stats.updateCount, 3u);
+    EXPECT_EQ(stats.allocationCount, 3u);
+}
+
+TEST(DescriptorSetAllocatorTest, StaleSetsAreRewritten)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffers[3] = {CreateUniformBuffer(device), CreateUniformBuffer(device), CreateUniformBuffer(device)};
+
+    grfx::WriteDescriptor writeA = UniformBufferWrite(buffers[0]);
+    grfx::WriteDescriptor writeB = UniformBufferWrite(buffers[1]);
+    grfx::WriteDescriptor writeC = UniformBufferWrite(buffers[2]);
+    grfx::DescriptorSet*  pSetA  = nullptr;
+    grfx::DescriptorSet*  pSetB  = nullptr;
+    grfx::DescriptorSet*  pSet   = nullptr;
+
+    allocator.BeginFrame(0);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeA, &pSetA), ppx::SUCCESS);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeB, &pSetB), ppx::SUCCESS);
+
+    // B isn't requested for a whole frame
+    allocator.BeginFrame(1);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeA, &pSet), ppx::SUCCESS);
+
+    allocator.BeginFrame(2);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeC, &pSet), ppx::SUCCESS);
+    EXPECT_EQ(pSet, pSetB);
+    EXPECT_EQ(GetUpdateCount(pSetB), 2u);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &writeA, &pSet), ppx::SUCCESS);
+    EXPECT_EQ(pSet, pSetA);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.cacheHitCount, 2u);
+    EXPECT_EQ(stats.updateCount, 3u);
+    EXPECT_EQ(stats.allocationCount, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, ClearCacheForcesUpdate)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffer = CreateUniformBuffer(device);
+
+    grfx::WriteDescriptor write = UniformBufferWrite(buffer);
+    grfx::DescriptorSet*  pSet  = nullptr;
+
+    allocator.BeginFrame(0);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSet), ppx::SUCCESS);
+    allocator.ClearCache();
+    allocator.BeginFrame(1);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSet), ppx::SUCCESS);
+    EXPECT_EQ(GetUpdateCount(pSet), 1u);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.cacheHitCount, 0u);
+    EXPECT_EQ(stats.updateCount, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, RecreatedViewAtSameAddressForcesUpdate)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+
+    grfx::SampledImageViewCreateInfo viewCreateInfo = {};
+    grfx::SampledImageViewPtr        view;
+    ASSERT_EQ(device.CreateSampledImageView(&viewCreateInfo, &view), ppx::SUCCESS);
+    const grfx::SampledImageView* pOldView = view;
+
+    grfx::WriteDescriptor write = {};
+    write.binding               = 0;
+    write.type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    write.pImageView            = view;
+    grfx::DescriptorSet* pSetA  = nullptr;
+    grfx::DescriptorSet* pSetB  = nullptr;
+
+    allocator.BeginFrame(0);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSetA), ppx::SUCCESS);
+
+    device.DestroySampledImageView(view);
+    ASSERT_EQ(device.CreateSampledImageView(&viewCreateInfo, &view), ppx::SUCCESS);
+    ASSERT_EQ(view.Get(), pOldView);
+
+    // Same address, different view: the set still holds the destroyed one
+    write.pImageView = view;
+    allocator.BeginFrame(1);
+    ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSetB), ppx::SUCCESS);
+    EXPECT_NE(pSetB, pSetA);
+    EXPECT_EQ(GetUpdateCount(pSetB), 1u);
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.cacheHitCount, 0u);
+    EXPECT_EQ(stats.updateCount, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, CreatesPoolsAsNeeded)
+{
+    FakeDescriptorSetAllocator allocator(1, 2);
+    FakeDescriptorSetLayout    layout;
+    FakeDevice                 device;
+    grfx::BufferPtr            buffers[3] = {CreateUniformBuffer(device), CreateUniformBuffer(device), CreateUniformBuffer(device)};
+
+    allocator.BeginFrame(0);
+    for (uint32_t i = 0; i < 3; ++i) {
+        grfx::WriteDescriptor write = UniformBufferWrite(buffers[i]);
+        grfx::DescriptorSet*  pSet  = nullptr;
+        ASSERT_EQ(allocator.Allocate(&layout, 1, &write, &pSet), ppx::SUCCESS);
+    }
+
+    grfx::DescriptorSetAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.allocationCount, 3u);
+    EXPECT_EQ(stats.poolCount, 2u);
+    EXPECT_EQ(allocator.GetPool(0)->GetCreateInfo().uniformBuffer, 2u);
+}
+
+TEST(DescriptorSetAllocatorTest, PushableLayoutsAreRejected)
+{
+    FakeDescriptorSetAllocator allocator(1, 64);
+    FakeDescriptorSetLayout    layout(true);
+    FakeDevice                 device;
+    grfx::BufferPtr            buffer = CreateUniformBuffer(device);
+
+    grfx::WriteDescriptor write = UniformBufferWrite(buffer);
+    grfx::DescriptorSet*  pSet  = nullptr;
+
+    allocator.BeginFrame(0);
+    EXPECT_EQ(allocator.Allocate(&layout, 1, &write, &pSet), ppx::ERROR_GRFX_OPERATION_NOT_PERMITTED);
+    EXPECT_EQ(allocator.GetStats().requestCount, 0u);
+}
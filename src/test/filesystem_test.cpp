@@ -176,6 +176,66 @@ TEST_F(FsTest, GetSizeIgnoresCursor)
     EXPECT_EQ(file.GetLength(), kDefaultFileContent.size());
 }
 
+TEST_F(FsTest, RegularFileIsMapped)
+{
+    fs::File file;
+    EXPECT_TRUE(file.Open(readableFile));
+    ASSERT_TRUE(file.IsMapped());
+    EXPECT_EQ(file.GetLength(), kDefaultFileContent.size());
+
+    std::string_view content(static_cast<const char*>(file.GetMappedData()), file.GetLength());
+    EXPECT_EQ(content, kDefaultFileContent);
+}
+
+TEST_F(FsTest, MappedReadStopsAtEndOfFile)
+{
+    fs::File file;
+    EXPECT_TRUE(file.Open(readableFile, fs::FILE_ACCESS_HINT_RANDOM));
+    ASSERT_TRUE(file.IsMapped());
+
+    std::string buffer(kDefaultFileContent.size() + 4, '\0');
+    EXPECT_EQ(file.Read(buffer.data(), buffer.size()), kDefaultFileContent.size());
+    EXPECT_EQ(file.Read(buffer.data(), buffer.size()), 0u);
+    EXPECT_EQ(buffer.substr(0, kDefaultFileContent.size()), kDefaultFileContent);
+}
+
+TEST_F(FsTest, EmptyFileIsNotMapped)
+{
+    FILE* emptyFileHandle = tmpfile();
+    ASSERT_NE(emptyFileHandle, nullptr);
+    const auto emptyFile = std::filesystem::path("/proc/self/fd/") / std::to_string(fileno(emptyFileHandle));
+
+    {
+        fs::File file;
+        EXPECT_TRUE(file.Open(emptyFile));
+        EXPECT_TRUE(file.IsValid());
+        EXPECT_FALSE(file.IsMapped());
+        EXPECT_EQ(file.GetLength(), 0u);
+    }
+
+    fclose(emptyFileHandle);
+}
+
+TEST_F(FsTest, FileStreamReadsContent)
+{
+    fs::FileStream stream;
+    ASSERT_TRUE(stream.Open(readableFile.c_str()));
+
+    std::istream is(&stream);
+    std::string  word1;
+    std::string  word2;
+    is >> word1 >> word2;
+    EXPECT_EQ(word1, "some");
+    EXPECT_EQ(word2, "content");
+}
+
+TEST_F(FsTest, LoadFileReturnsContent)
+{
+    auto content = fs::load_file(readableFile);
+    ASSERT_TRUE(content.has_value());
+    EXPECT_EQ(std::string_view(content.value().data(), content.value().size()), kDefaultFileContent);
+}
+
 TEST_F(FsTest, CloseFileDescriptorOnScopeEnd)
 {
     const size_t fdCountBefore = getOpenFDCount();
@@ -0,0 +1,160 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/frame_pacer.h"
+
+using namespace ppx;
+
+namespace {
+
+// Simulated clock: sleeping oversleeps by mOversleep, spinning advances
+// the clock by mSpinStep.
+class FakeFramePacer : public FramePacer
+{
+public:
+    void Advance(double seconds) { mNow += seconds; }
+
+    double mNow       = 100.0;
+    double mOversleep = 0.0;
+    double mSpinStep  = 0.0001;
+    double mSlept     = 0.0;
+
+protected:
+    double GetTime() const override { return mNow; }
+    void   Sleep(double seconds) override
+    {
+        mSlept += seconds;
+        mNow += seconds + mOversleep;
+    }
+    void Spin() override { mNow += mSpinStep; }
+};
+
+FramePacerCreateInfo CreateInfo(double frameRate, FramePacerMissPolicy missPolicy = FRAME_PACER_MISS_POLICY_CATCH_UP)
+{
+    FramePacerCreateInfo createInfo = {};
+    createInfo.frameRate            = frameRate;
+    createInfo.missPolicy           = missPolicy;
+    createInfo.spinSeconds          = 0.002;
+    return createInfo;
+}
+
+} // namespace
+
+TEST(FramePacerTest, DisabledNeverWaits)
+{
+    FakeFramePacer pacer;
+    pacer.Reset(CreateInfo(0));
+    EXPECT_FALSE(pacer.IsEnabled());
+
+    for (int i = 0; i < 3; ++i) {
+        FramePacerFrameStats stats = pacer.Wait();
+        EXPECT_FALSE(stats.missed);
+        EXPECT_EQ(stats.GetIdleSeconds(), 0.0);
+    }
+    EXPECT_EQ(pacer.GetFrameCount(), 3u);
+}
+
+TEST(FramePacerTest, SleepsThenSpinsToDeadline)
+{
+    FakeFramePacer pacer;
+    pacer.Reset(CreateInfo(100));
+
+    // The first frame starts the schedule
+    FramePacerFrameStats stats = pacer.Wait();
+    EXPECT_EQ(stats.wakeTime, 100.0);
+
+    pacer.Advance(0.004);
+    stats = pacer.Wait();
+    EXPECT_FALSE(stats.missed);
+    EXPECT_DOUBLE_EQ(stats.deadline, 100.01);
+    EXPECT_NEAR(stats.sleepSeconds, 0.004, 1e-9);
+    EXPECT_NEAR(stats.spinSeconds, 0.002, 0.0002);
+    EXPECT_GE(stats.wakeTime, stats.deadline);
+    EXPECT_LT(stats.GetPacingError(), 0.0002);
+}
+
+TEST(FramePacerTest, OversleepGrowsSpinTime)
+{
+    FakeFramePacer pacer;
+    pacer.mOversleep = 0.003;
+    pacer.Reset(CreateInfo(100));
+    pacer.Wait();
+
+    // Oversleeping past the deadline counts against precision, not as a miss
+    FramePacerFrameStats stats = pacer.Wait();
+    EXPECT_FALSE(stats.missed);
+    EXPECT_NEAR(stats.GetPacingError(), 0.001, 1e-9);
+    EXPECT_NEAR(pacer.GetSpinSeconds(), 0.005, 1e-9);
+
+    // Now the sleep ends in time and the spin lands on the deadline
+    stats = pacer.Wait();
+    EXPECT_LT(stats.GetPacingError(), 0.0002);
+}
+
+TEST(FramePacerTest, OversleepWithinSpinTimeKeepsSpinTime)
+{
+    FakeFramePacer pacer;
+    pacer.mOversleep = 0.0005;
+    pacer.Reset(CreateInfo(100));
+    pacer.Wait();
+
+    // Every sleep wakes up late but still before the deadline
+    for (int i = 0; i < 20; ++i) {
+        FramePacerFrameStats stats = pacer.Wait();
+        EXPECT_FALSE(stats.missed);
+        EXPECT_LT(stats.GetPacingError(), 0.0002);
+    }
+    EXPECT_NEAR(pacer.GetSpinSeconds(), 0.002, 1e-9);
+}
+
+TEST(FramePacerTest, CatchUpKeepsSchedule)
+{
+    FakeFramePacer pacer;
+    pacer.Reset(CreateInfo(100));
+    pacer.Wait();
+
+    pacer.Advance(0.035);
+    FramePacerFrameStats stats = pacer.Wait();
+    EXPECT_TRUE(stats.missed);
+    EXPECT_EQ(stats.GetIdleSeconds(), 0.0);
+    EXPECT_EQ(pacer.GetMissCount(), 1u);
+
+    // The next deadlines are already behind, frames run back to back
+    stats = pacer.Wait();
+    EXPECT_TRUE(stats.missed);
+    EXPECT_DOUBLE_EQ(stats.deadline, 100.02);
+    stats = pacer.Wait();
+    EXPECT_TRUE(stats.missed);
+    stats = pacer.Wait();
+    EXPECT_FALSE(stats.missed);
+    EXPECT_DOUBLE_EQ(stats.deadline, 100.04);
+}
+
+TEST(FramePacerTest, SkipMovesToNextSlot)
+{
+    FakeFramePacer pacer;
+    pacer.Reset(CreateInfo(100, FRAME_PACER_MISS_POLICY_SKIP));
+    pacer.Wait();
+
+    pacer.Advance(0.035);
+    FramePacerFrameStats stats = pacer.Wait();
+    EXPECT_TRUE(stats.missed);
+
+    stats = pacer.Wait();
+    EXPECT_FALSE(stats.missed);
+    EXPECT_DOUBLE_EQ(stats.deadline, 100.04);
+    EXPECT_EQ(pacer.GetMissCount(), 1u);
+}
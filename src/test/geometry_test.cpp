@@ -0,0 +1,193 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/geometry.h"
+
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+// Builds geometry vertex by vertex the way Geometry::Create(createInfo, mesh)
+// did before the bulk path
+void CreatePerVertex(const GeometryOptions& options, const TriMesh& mesh, Geometry* pGeometry)
+{
+    ASSERT_EQ(Geometry::Create(options, pGeometry), ppx::SUCCESS);
+
+    const bool meshIndexed     = (mesh.GetIndexType() != grfx::INDEX_TYPE_UNDEFINED);
+    const bool geometryIndexed = (options.indexType != grfx::INDEX_TYPE_UNDEFINED);
+    if (meshIndexed) {
+        for (uint32_t triIndex = 0; triIndex < mesh.GetCountTriangles(); ++triIndex) {
+            uint32_t v[3] = {};
+            ASSERT_EQ(mesh.GetTriangle(triIndex, v[0], v[1], v[2]), ppx::SUCCESS);
+            if (geometryIndexed) {
+                pGeometry->AppendIndicesTriangle(v[0], v[1], v[2]);
+                continue;
+            }
+            for (uint32_t i = 0; i < 3; ++i) {
+                TriMeshVertexData vertexData = {};
+                ASSERT_EQ(mesh.GetVertexData(v[i], &vertexData), ppx::SUCCESS);
+                pGeometry->AppendVertexData(vertexData);
+            }
+        }
+        if (!geometryIndexed) {
+            return;
+        }
+    }
+
+    if (geometryIndexed && !meshIndexed) {
+        for (uint32_t vertexIndex = 0; (vertexIndex + 2) < mesh.GetCountPositions(); vertexIndex += 3) {
+            TriMeshVertexData vertexData[3] = {};
+            for (uint32_t i = 0; i < 3; ++i) {
+                ASSERT_EQ(mesh.GetVertexData(vertexIndex + i, &vertexData[i]), ppx::SUCCESS);
+            }
+            pGeometry->AppendTriangle(vertexData[0], vertexData[1], vertexData[2]);
+        }
+        return;
+    }
+
+    for (uint32_t vertexIndex = 0; vertexIndex < mesh.GetCountPositions(); ++vertexIndex) {
+        TriMeshVertexData vertexData = {};
+        ASSERT_EQ(mesh.GetVertexData(vertexIndex, &vertexData), ppx::SUCCESS);
+        pGeometry->AppendVertexData(vertexData);
+    }
+}
+
+void ExpectSameBuffers(const Geometry& expected, const Geometry& actual)
+{
+    ASSERT_EQ(actual.GetIndexBuffer()->GetSize(), expected.GetIndexBuffer()->GetSize());
+    EXPECT_EQ(memcmp(actual.GetIndexBuffer()->GetData(), expected.GetIndexBuffer()->GetData(), actual.GetIndexBuffer()->GetSize()), 0);
+
+    ASSERT_EQ(actual.GetVertexBufferCount(), expected.GetVertexBufferCount());
+    for (uint32_t i = 0; i < actual.GetVertexBufferCount(); ++i) {
+        ASSERT_EQ(actual.GetVertexBuffer(i)->GetSize(), expected.GetVertexBuffer(i)->GetSize()) << "vertex buffer " << i;
+        EXPECT_EQ(memcmp(actual.GetVertexBuffer(i)->GetData(), expected.GetVertexBuffer(i)->GetData(), actual.GetVertexBuffer(i)->GetSize()), 0) << "vertex buffer " << i;
+    }
+}
+
+std::vector<GeometryOptions> GetAllLayouts(grfx::IndexType indexType)
+{
+    std::vector<GeometryOptions> layouts = {
+        GeometryOptions::Interleaved(),
+        GeometryOptions::Planar(),
+        GeometryOptions::PositionPlanar(),
+    };
+    for (auto& options : layouts) {
+        options.IndexType(indexType).AddColor().AddNormal().AddTexCoord().AddTangent().AddBitangent();
+    }
+    return layouts;
+}
+
+} // namespace
+
+TEST(GeometryTest, ConvertToHalf)
+{
+    const float    values[]   = {0.0f, -0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 65520.0f, 1e-7f, std::numeric_limits<float>::infinity()};
+    const uint16_t expected[] = {0x0000, 0x8000, 0x3C00, 0xC000, 0x3800, 0x7BFF, 0x7C00, 0x0002, 0x7C00};
+    const uint32_t count      = static_cast<uint32_t>(std::size(values));
+
+    // Odd count to go through the tail
+    std::vector<half> result(count);
+    ConvertToHalf(count, values, result.data());
+    for (uint32_t i = 0; i < count; ++i) {
+        EXPECT_EQ(result[i], expected[i]) << "value " << values[i];
+    }
+
+    float nanValue = std::numeric_limits<float>::quiet_NaN();
+    half  nan      = 0;
+    ConvertToHalf(1, &nanValue, &nan);
+    EXPECT_EQ(nan & 0x7C00, 0x7C00);
+    EXPECT_NE(nan & 0x03FF, 0);
+}
+
+TEST(GeometryTest, ConvertToSnorm8)
+{
+    const float    values[]   = {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f, -0.25f};
+    const int8_t   expected[] = {0, 127, -127, 127, -127, 64, -32};
+    const uint32_t count      = static_cast<uint32_t>(std::size(values));
+
+    std::vector<int8_t> result(count);
+    ConvertToSnorm8(count, values, result.data());
+    for (uint32_t i = 0; i < count; ++i) {
+        EXPECT_EQ(result[i], expected[i]) << "value " << values[i];
+    }
+}
+
+TEST(GeometryTest, CreateFromIndexedMeshMatchesPerVertex)
+{
+    const TriMesh mesh = TriMesh::CreateCube(float3(1, 2, 3), TriMeshOptions().Indices().AllAttributes());
+    for (grfx::IndexType indexType : {grfx::INDEX_TYPE_UNDEFINED, grfx::INDEX_TYPE_UINT16, grfx::INDEX_TYPE_UINT32}) {
+        for (const auto& options : GetAllLayouts(indexType)) {
+            Geometry expected;
+            Geometry actual;
+            CreatePerVertex(options, mesh, &expected);
+            ASSERT_EQ(Geometry::Create(options, mesh, &actual), ppx::SUCCESS);
+            ExpectSameBuffers(expected, actual);
+        }
+    }
+}
+
+TEST(GeometryTest, CreateFromMeshWithoutIndicesMatchesPerVertex)
+{
+    const TriMesh mesh = TriMesh::CreateSphere(1, 8, 6, TriMeshOptions().Normals().TexCoords().Tangents());
+    for (grfx::IndexType indexType : {grfx::INDEX_TYPE_UNDEFINED, grfx::INDEX_TYPE_UINT32}) {
+        for (const auto& options : GetAllLayouts(indexType)) {
+            Geometry expected;
+            Geometry actual;
+            CreatePerVertex(options, mesh, &expected);
+            ASSERT_EQ(Geometry::Create(options, mesh, &actual), ppx::SUCCESS);
+            ExpectSameBuffers(expected, actual);
+        }
+    }
+}
+
+TEST(GeometryTest, CreateConvertsCompressedFormats)
+{
+    const TriMesh mesh = TriMesh::CreateCube(float3(1, 2, 3), TriMeshOptions().Indices().Normals().TexCoords());
+
+    GeometryOptions options = GeometryOptions::InterleavedU16(grfx::FORMAT_R16G16B16A16_FLOAT)
+                                  .AddTexCoord(grfx::FORMAT_R16G16_FLOAT)
+                                  .AddNormal(grfx::FORMAT_R8G8B8A8_SNORM);
+    Geometry geometry;
+    ASSERT_EQ(Geometry::Create(options, mesh, &geometry), ppx::SUCCESS);
+    ASSERT_EQ(geometry.GetVertexCount(), mesh.GetCountPositions());
+    ASSERT_EQ(geometry.GetIndexCount(), mesh.GetCountIndices());
+
+    const uint32_t stride = geometry.GetVertexBinding(0)->GetStride();
+    ASSERT_EQ(stride, 8u + 4u + 4u);
+    for (uint32_t vertexIndex = 0; vertexIndex < mesh.GetCountPositions(); ++vertexIndex) {
+        TriMeshVertexData vertexData = {};
+        ASSERT_EQ(mesh.GetVertexData(vertexIndex, &vertexData), ppx::SUCCESS);
+
+        const float position[4] = {vertexData.position.x, vertexData.position.y, vertexData.position.z, 0.0f};
+        const float normal[4]   = {vertexData.normal.x, vertexData.normal.y, vertexData.normal.z, 0.0f};
+        half        expectedPosition[4];
+        half        expectedTexCoord[2];
+        int8_t      expectedNormal[4];
+        ConvertToHalf(4, position, expectedPosition);
+        ConvertToHalf(2, &vertexData.texCoord.x, expectedTexCoord);
+        ConvertToSnorm8(4, normal, expectedNormal);
+
+        const char* pVertex = geometry.GetVertexBuffer(0)->GetData() + vertexIndex * stride;
+        EXPECT_EQ(memcmp(pVertex + 0, expectedPosition, sizeof(expectedPosition)), 0) << "vertex " << vertexIndex;
+        EXPECT_EQ(memcmp(pVertex + 8, expectedTexCoord, sizeof(expectedTexCoord)), 0) << "vertex " << vertexIndex;
+        EXPECT_EQ(memcmp(pVertex + 12, expectedNormal, sizeof(expectedNormal)), 0) << "vertex " << vertexIndex;
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+#include "ppx/scene/scene_gltf_loader.h"
+#include "ppx/scene/scene_mesh.h"
+#include "ppx/scene/scene_scene.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+// Two meshes sharing one triangle, the buffer holds the positions
+// (0, 0, 0), (1, 0, 0) and (0, 1, 0)
+constexpr const char* kTwoMeshGltf = R"({
+  "asset": {"version": "2.0"},
+  "buffers": [{
+    "byteLength": 36,
+    "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAA"
+  }],
+  "bufferViews": [{"buffer": 0, "byteOffset": 0, "byteLength": 36}],
+  "accessors": [{
+    "bufferView": 0,
+    "componentType": 5126,
+    "count": 3,
+    "type": "VEC3",
+    "min": [0, 0, 0],
+    "max": [1, 1, 0]
+  }],
+  "meshes": [
+    {"name": "a", "primitives": [{"attributes": {"POSITION": 0}}]},
+    {"name": "b", "primitives": [{"attributes": {"POSITION": 0}}]}
+  ],
+  "nodes": [{"mesh": 0}, {"mesh": 1}],
+  "scenes": [{"nodes": [0, 1]}],
+  "scene": 0
+})";
+
+const float kPositions[9] = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+
+// Positions follow the 3 uint16 indices generated for the non-indexed
+// primitive, aligned to 16 bytes
+const uint64_t kPositionOffset = 16;
+
+class GltfLoaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        mGltfPath              = std::filesystem::temp_directory_path() / ("ppx_gltf_loader_test_" + name + ".gltf");
+        {
+            std::ofstream file(mGltfPath);
+            file << kTwoMeshGltf;
+        }
+        ASSERT_EQ(scene::GltfLoader::Create(mGltfPath, &mLoader), ppx::SUCCESS);
+    }
+
+    void TearDown() override
+    {
+        delete mLoader;
+        std::filesystem::remove(mGltfPath);
+    }
+
+    static void ExpectPositions(const scene::Scene* pScene)
+    {
+        ASSERT_EQ(pScene->GetMeshNodeCount(), 2u);
+        for (uint32_t i = 0; i < 2; ++i) {
+            auto pBuffer = static_cast<FakeBuffer*>(pScene->GetMeshNode(i)->GetMesh()->GetMeshData()->GetGpuBuffer());
+            EXPECT_EQ(std::memcmp(pBuffer->GetMemory() + kPositionOffset, kPositions, sizeof(kPositions)), 0);
+        }
+    }
+
+    std::filesystem::path mGltfPath;
+    scene::GltfLoader*    mLoader = nullptr;
+};
+
+} // namespace
+
+TEST_F(GltfLoaderTest, MeshUploadsAreBatched)
+{
+    FakeDevice    device;
+    scene::Scene* pScene = nullptr;
+    ASSERT_EQ(mLoader->LoadScene(&device, 0, &pScene), ppx::SUCCESS);
+
+    // One submit for both meshes, done before LoadScene() returns
+    EXPECT_EQ(device.GetFakeQueue()->GetSubmitCount(), 1u);
+    EXPECT_EQ(device.GetFakeQueue()->GetCopyCount(), 2u);
+    ExpectPositions(pScene);
+
+    delete pScene;
+}
+
+TEST_F(GltfLoaderTest, CallerUploadQueueIsNotFlushed)
+{
+    FakeDevice device;
+
+    grfx::UploadQueueCreateInfo createInfo = {};
+    createInfo.pQueue                      = device.GetGraphicsQueue();
+    grfx::UploadQueuePtr uploadQueue;
+    ASSERT_EQ(device.CreateUploadQueue(&createInfo, &uploadQueue), ppx::SUCCESS);
+
+    scene::GltfLoadOptions loadOptions = {};
+    loadOptions.pUploadQueue           = uploadQueue;
+
+    scene::Scene* pScene = nullptr;
+    ASSERT_EQ(mLoader->LoadScene(&device, 0, &pScene, loadOptions), ppx::SUCCESS);
+    EXPECT_EQ(device.GetFakeQueue()->GetSubmitCount(), 0u);
+
+    ASSERT_EQ(uploadQueue->WaitIdle(), ppx::SUCCESS);
+    EXPECT_EQ(device.GetFakeQueue()->GetSubmitCount(), 1u);
+    EXPECT_EQ(device.GetFakeQueue()->GetCopyCount(), 2u);
+    ExpectPositions(pScene);
+
+    delete pScene;
+}
@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/bitmap.h"
+#include "ppx/graphics_util.h"
+#include "ppx/grfx/grfx_texture.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+#include "ppx/mipmap.h"
+#include "ppx/thread_pool.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+// Widths differ so each output can be matched to its file
+const uint32_t kWidths[4] = {8, 16, 4, 32};
+const uint32_t kHeight    = 4;
+
+class BatchLoadTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mDirectory = std::filesystem::temp_directory_path() / "ppx_graphics_util_test";
+        std::filesystem::create_directories(mDirectory);
+
+        for (uint32_t i = 0; i < 4; ++i) {
+            Result ppxres = ppx::ERROR_FAILED;
+            Bitmap bitmap = Bitmap::Create(kWidths[i], kHeight, Bitmap::FORMAT_RGBA_UINT8, &ppxres);
+            ASSERT_EQ(ppxres, ppx::SUCCESS);
+
+            std::filesystem::path path = mDirectory / ("image" + std::to_string(i) + ".png");
+            ASSERT_EQ(Bitmap::SaveFilePNG(path, &bitmap), ppx::SUCCESS);
+            mPaths.push_back(path);
+        }
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    FakeDevice                         mDevice;
+    ThreadPool                         mThreadPool{2};
+    std::filesystem::path              mDirectory;
+    std::vector<std::filesystem::path> mPaths;
+};
+
+} // namespace
+
+TEST_F(BatchLoadTest, CreateImagesFromFilesKeepsPathOrder)
+{
+    std::vector<grfx::ImagePtr> images;
+    grfx_util::BatchLoadStats   stats = {};
+    ASSERT_EQ(grfx_util::CreateImagesFromFiles(mDevice.GetGraphicsQueue(), mPaths, &images, grfx_util::ImageOptions(), &mThreadPool, &stats), ppx::SUCCESS);
+
+    ASSERT_EQ(images.size(), mPaths.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        EXPECT_EQ(images[i]->GetWidth(), kWidths[i]);
+        EXPECT_EQ(images[i]->GetHeight(), kHeight);
+        EXPECT_EQ(images[i]->GetMipLevelCount(), Mipmap::CalculateLevelCount(kWidths[i], kHeight));
+    }
+
+    // The transient upload queue is waited on before returning
+    EXPECT_EQ(mDevice.GetFakeQueue()->GetSubmitCount(), 1);
+    // Two pool threads and the calling thread
+    EXPECT_EQ(stats.threadCount, 3);
+}
+
+TEST_F(BatchLoadTest, SerialPoolLoadsOnCallingThread)
+{
+    std::unique_ptr<ThreadPool> serialPool = ThreadPool::CreateSerial();
+    std::vector<grfx::ImagePtr> images;
+    grfx_util::BatchLoadStats   stats = {};
+    ASSERT_EQ(grfx_util::CreateImagesFromFiles(mDevice.GetGraphicsQueue(), mPaths, &images, grfx_util::ImageOptions(), serialPool.get(), &stats), ppx::SUCCESS);
+
+    ASSERT_EQ(images.size(), mPaths.size());
+    EXPECT_EQ(images[3]->GetWidth(), kWidths[3]);
+    EXPECT_EQ(stats.threadCount, 1);
+}
+
+TEST_F(BatchLoadTest, CreateTexturesFromFilesKeepsPathOrder)
+{
+    std::vector<grfx::TexturePtr> textures;
+    ASSERT_EQ(grfx_util::CreateTexturesFromFiles(mDevice.GetGraphicsQueue(), mPaths, &textures, grfx_util::TextureOptions(), &mThreadPool), ppx::SUCCESS);
+
+    ASSERT_EQ(textures.size(), mPaths.size());
+    for (size_t i = 0; i < textures.size(); ++i) {
+        EXPECT_EQ(textures[i]->GetWidth(), kWidths[i]);
+        EXPECT_EQ(textures[i]->GetMipLevelCount(), 1);
+    }
+}
+
+TEST_F(BatchLoadTest, FailedImageDestroysEarlierImagesAfterTheirCopies)
+{
+    // One batch that's only submitted when flushed, so the copies into the
+    // first images are still recorded when the third image fails
+    grfx::UploadQueuePtr        uploadQueue;
+    grfx::UploadQueueCreateInfo uploadQueueCreateInfo = {};
+    uploadQueueCreateInfo.pQueue                      = mDevice.GetGraphicsQueue();
+    uploadQueueCreateInfo.batchCount                  = 1;
+    ASSERT_EQ(mDevice.CreateUploadQueue(&uploadQueueCreateInfo, &uploadQueue), ppx::SUCCESS);
+
+    mDevice.SetImageCreateLimit(2);
+
+    std::vector<grfx::ImagePtr> images;
+    EXPECT_EQ(grfx_util::CreateImagesFromFiles(mDevice.GetGraphicsQueue(), mPaths, &images, grfx_util::ImageOptions().UploadQueue(uploadQueue), &mThreadPool), ppx::ERROR_ALLOCATION_FAILED);
+    EXPECT_TRUE(images.empty());
+
+    // The fake queue completes copies when they're submitted
+    const std::vector<uint32_t>& submitCounts = mDevice.GetSubmitCountsAtImageDestroy();
+    ASSERT_EQ(submitCounts.size(), 2);
+    EXPECT_EQ(submitCounts[0], 1);
+    EXPECT_EQ(submitCounts[1], 1);
+}
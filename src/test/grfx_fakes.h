@@ -0,0 +1,661 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_test_grfx_fakes_h
+#define ppx_test_grfx_fakes_h
+
+// grfx objects without an API behind them, for testing the helpers that
+// are built on top of grfx
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_descriptor.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_format.h"
+#include "ppx/grfx/grfx_gpu.h"
+#include "ppx/grfx/grfx_image.h"
+#include "ppx/grfx/grfx_instance.h"
+#include "ppx/grfx/grfx_pipeline.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_shader.h"
+#include "ppx/grfx/grfx_sync.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ppx {
+namespace test {
+
+// Backed by CPU memory once created, so FakeQueue can run copies into it.
+// Buffers that are only constructed can't be mapped.
+class FakeBuffer : public grfx::Buffer
+{
+public:
+    Result MapMemory(uint64_t offset, void** ppMappedAddress) override
+    {
+        if (mMemory.empty()) {
+            return ppx::ERROR_FAILED;
+        }
+        *ppMappedAddress = mMemory.data() + offset;
+        return ppx::SUCCESS;
+    }
+
+    void UnmapMemory() override {}
+
+    char* GetMemory() { return mMemory.data(); }
+
+protected:
+    Result CreateApiObjects(const grfx::BufferCreateInfo* pCreateInfo) override
+    {
+        mMemory.resize(static_cast<size_t>(pCreateInfo->size));
+        return ppx::SUCCESS;
+    }
+
+    void DestroyApiObjects() override { mMemory.clear(); }
+
+private:
+    std::vector<char> mMemory;
+};
+
+// Images created by FakeDevice report when they're destroyed, see
+// FakeDevice::GetSubmitCountsAtImageDestroy()
+class FakeImage : public grfx::Image
+{
+public:
+    FakeImage() {}
+
+    // For tests that need the image's description without a device
+    explicit FakeImage(const grfx::ImageCreateInfo& createInfo)
+    {
+        EXPECT_EQ(Create(&createInfo), ppx::SUCCESS);
+    }
+
+    Result MapMemory(uint64_t offset, void** ppMappedAddress) override { return ppx::ERROR_FAILED; }
+    void   UnmapMemory() override {}
+
+protected:
+    Result CreateApiObjects(const grfx::ImageCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override;
+};
+
+// The last destroyed view's memory is handed to the next view, the way a
+// heap reuses freed addresses, so tests can recreate a view at the address
+// of one they destroyed
+class FakeSampledImageView : public grfx::SampledImageView
+{
+public:
+    static void* operator new(size_t size)
+    {
+        if (!IsNull(sFreeMemory) && (size == sFreeSize)) {
+            void* pMemory = sFreeMemory;
+            sFreeMemory   = nullptr;
+            return pMemory;
+        }
+        return ::operator new(size);
+    }
+
+    static void operator delete(void* pMemory, size_t size)
+    {
+        ::operator delete(sFreeMemory);
+        sFreeMemory = pMemory;
+        sFreeSize   = size;
+    }
+
+protected:
+    Result CreateApiObjects(const grfx::SampledImageViewCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+
+private:
+    inline static void*  sFreeMemory = nullptr;
+    inline static size_t sFreeSize   = 0;
+};
+
+// The GPU finishes the work a fence guards as soon as it's waited on
+class FakeFence : public grfx::Fence
+{
+public:
+    Result Wait(uint64_t timeout) override
+    {
+        if (!mSignaled && (timeout > 0)) {
+            mSignaled = true;
+            mBlockingWaitCount += 1;
+        }
+        return mSignaled ? ppx::SUCCESS : ppx::ERROR_WAIT_TIMED_OUT;
+    }
+
+    Result Reset() override
+    {
+        mSignaled = false;
+        return ppx::SUCCESS;
+    }
+
+    Result SignalOnHost() override
+    {
+        mSignaled = true;
+        return ppx::SUCCESS;
+    }
+
+    uint32_t GetBlockingWaitCount() const { return mBlockingWaitCount; }
+
+protected:
+    Result CreateApiObjects(const grfx::FenceCreateInfo* pCreateInfo) override
+    {
+        mSignaled = pCreateInfo->signaled;
+        return ppx::SUCCESS;
+    }
+    void   DestroyApiObjects() override {}
+
+private:
+    bool     mSignaled          = false;
+    uint32_t mBlockingWaitCount = 0;
+};
+
+class FakeDescriptorPool : public grfx::DescriptorPool
+{
+public:
+    FakeDescriptorPool(const grfx::DescriptorPoolCreateInfo* pCreateInfo)
+    {
+        EXPECT_EQ(Create(pCreateInfo), ppx::SUCCESS);
+    }
+
+    const grfx::DescriptorPoolCreateInfo& GetCreateInfo() const { return mCreateInfo; }
+
+protected:
+    Result CreateApiObjects(const grfx::DescriptorPoolCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+// Counts descriptor updates instead of writing them
+class FakeDescriptorSet : public grfx::DescriptorSet
+{
+public:
+    FakeDescriptorSet(grfx::DescriptorPool* pPool, const grfx::DescriptorSetLayout* pLayout)
+    {
+        grfx::internal::DescriptorSetCreateInfo createInfo = {};
+        createInfo.pPool                                   = pPool;
+        createInfo.pLayout                                 = pLayout;
+        EXPECT_EQ(Create(&createInfo), ppx::SUCCESS);
+    }
+
+    Result UpdateDescriptors(uint32_t writeCount, const grfx::WriteDescriptor* pWrites) override
+    {
+        mUpdateCount += 1;
+        return ppx::SUCCESS;
+    }
+
+    uint32_t GetUpdateCount() const { return mUpdateCount; }
+
+protected:
+    Result CreateApiObjects(const grfx::internal::DescriptorSetCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+
+private:
+    uint32_t mUpdateCount = 0;
+};
+
+class FakeDescriptorSetLayout : public grfx::DescriptorSetLayout
+{
+public:
+    FakeDescriptorSetLayout(bool pushable = false)
+    {
+        grfx::DescriptorSetLayoutCreateInfo createInfo = {};
+        createInfo.flags.bits.pushable                 = pushable;
+        createInfo.bindings.push_back(grfx::DescriptorBinding(0, grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER));
+        EXPECT_EQ(Create(&createInfo), ppx::SUCCESS);
+    }
+
+protected:
+    Result CreateApiObjects(const grfx::DescriptorSetLayoutCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+class FakeCommandPool : public grfx::CommandPool
+{
+protected:
+    Result CreateApiObjects(const grfx::CommandPoolCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+class FakeShaderModule : public grfx::ShaderModule
+{
+protected:
+    Result CreateApiObjects(const grfx::ShaderModuleCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+class FakePipelineInterface : public grfx::PipelineInterface
+{
+protected:
+    Result CreateApiObjects(const grfx::PipelineInterfaceCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+// Pipelines count how many of them are alive, so tests can tell when a
+// shared pipeline is actually destroyed
+class FakeComputePipeline : public grfx::ComputePipeline
+{
+public:
+    static uint32_t GetLiveCount() { return sLiveCount; }
+
+protected:
+    Result CreateApiObjects(const grfx::ComputePipelineCreateInfo* pCreateInfo) override
+    {
+        sLiveCount += 1;
+        return ppx::SUCCESS;
+    }
+
+    void DestroyApiObjects() override { sLiveCount -= 1; }
+
+private:
+    inline static uint32_t sLiveCount = 0;
+};
+
+class FakeGraphicsPipeline : public grfx::GraphicsPipeline
+{
+public:
+    static uint32_t GetLiveCount() { return sLiveCount; }
+
+protected:
+    Result CreateApiObjects(const grfx::GraphicsPipelineCreateInfo* pCreateInfo) override
+    {
+        sLiveCount += 1;
+        return ppx::SUCCESS;
+    }
+
+    void DestroyApiObjects() override { sLiveCount -= 1; }
+
+private:
+    inline static uint32_t sLiveCount = 0;
+};
+
+// Keeps buffer to buffer copies for FakeQueue to run on submit and image
+// to buffer copies for it to report, every other command is dropped
+class FakeCommandBuffer : public grfx::CommandBuffer
+{
+public:
+    struct Copy
+    {
+        grfx::BufferToBufferCopyInfo info       = {};
+        grfx::Buffer*                pSrcBuffer = nullptr;
+        grfx::Buffer*                pDstBuffer = nullptr;
+    };
+
+    struct ImageCopy
+    {
+        grfx::ImageToBufferCopyInfo    info       = {};
+        grfx::Image*                   pSrcImage  = nullptr;
+        grfx::Buffer*                  pDstBuffer = nullptr;
+        grfx::ImageToBufferOutputPitch pitch      = {};
+    };
+
+    const std::vector<Copy>&      GetCopies() const { return mCopies; }
+    const std::vector<ImageCopy>& GetImageCopies() const { return mImageCopies; }
+
+    Result Begin() override
+    {
+        mCopies.clear();
+        mImageCopies.clear();
+        return ppx::SUCCESS;
+    }
+
+    Result End() override { return ppx::SUCCESS; }
+
+    void ClearRenderTarget(grfx::Image* pImage, const grfx::RenderTargetClearValue& clearValue) override {}
+    void ClearDepthStencil(grfx::Image* pImage, const grfx::DepthStencilClearValue& clearValue, uint32_t clearFlags) override {}
+
+    void TransitionImageLayout(
+        const grfx::Image*  pImage,
+        uint32_t            mipLevel,
+        uint32_t            mipLevelCount,
+        uint32_t            arrayLayer,
+        uint32_t            arrayLayerCount,
+        grfx::ResourceState beforeState,
+        grfx::ResourceState afterState,
+        const grfx::Queue*  pSrcQueue = nullptr,
+        const grfx::Queue*  pDstQueue = nullptr) override {}
+
+    void BufferResourceBarrier(
+        const grfx::Buffer* pBuffer,
+        grfx::ResourceState beforeState,
+        grfx::ResourceState afterState,
+        const grfx::Queue*  pSrcQueue = nullptr,
+        const grfx::Queue*  pDstQueue = nullptr) override {}
+
+    void ImageMemoryBarrier(const grfx::Image* pImage, grfx::ResourceState state) override {}
+    void BufferMemoryBarrier(const grfx::Buffer* pBuffer, grfx::ResourceState state) override {}
+
+    void SetViewports(uint32_t viewportCount, const grfx::Viewport* pViewports) override {}
+    void SetScissors(uint32_t scissorCount, const grfx::Rect* pScissors) override {}
+
+    void BindGraphicsDescriptorSets(const grfx::PipelineInterface* pInterface, uint32_t setCount, const grfx::DescriptorSet* const* ppSets) override {}
+    void PushGraphicsConstants(const grfx::PipelineInterface* pInterface, uint32_t count, const void* pValues, uint32_t dstOffset = 0) override {}
+    void BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline) override {}
+
+    void BindComputeDescriptorSets(const grfx::PipelineInterface* pInterface, uint32_t setCount, const grfx::DescriptorSet* const* ppSets) override {}
+    void PushComputeConstants(const grfx::PipelineInterface* pInterface, uint32_t count, const void* pValues, uint32_t dstOffset = 0) override {}
+    void BindComputePipeline(const grfx::ComputePipeline* pPipeline) override {}
+
+    void BindIndexBuffer(const grfx::IndexBufferView* pView) override {}
+    void BindVertexBuffers(uint32_t viewCount, const grfx::VertexBufferView* pViews) override {}
+
+    void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override {}
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override {}
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override {}
+
+    void CopyBufferToBuffer(const grfx::BufferToBufferCopyInfo* pCopyInfo, grfx::Buffer* pSrcBuffer, grfx::Buffer* pDstBuffer) override
+    {
+        mCopies.push_back({*pCopyInfo, pSrcBuffer, pDstBuffer});
+    }
+
+    void CopyBufferToImage(const std::vector<grfx::BufferToImageCopyInfo>& pCopyInfos, grfx::Buffer* pSrcBuffer, grfx::Image* pDstImage) override {}
+    void CopyBufferToImage(const grfx::BufferToImageCopyInfo* pCopyInfo, grfx::Buffer* pSrcBuffer, grfx::Image* pDstImage) override {}
+
+    // Returns the row pitch the backends write: D3D12 aligns rows to 256
+    // bytes, Vulkan packs them tightly
+    grfx::ImageToBufferOutputPitch CopyImageToBuffer(const grfx::ImageToBufferCopyInfo* pCopyInfo, grfx::Image* pSrcImage, grfx::Buffer* pDstBuffer) override
+    {
+        const uint32_t rowSize   = grfx::GetFormatDescription(pSrcImage->GetFormat())->bytesPerTexel * pCopyInfo->extent.x;
+        const uint32_t alignment = grfx::IsDx12(GetDevice()->GetApi()) ? PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT : 1;
+
+        grfx::ImageToBufferOutputPitch pitch = {};
+        pitch.rowPitch                       = RoundUp<uint32_t>(rowSize, alignment);
+        mImageCopies.push_back({*pCopyInfo, pSrcImage, pDstBuffer, pitch});
+        return pitch;
+    }
+
+    void CopyImageToImage(const grfx::ImageToImageCopyInfo* pCopyInfo, grfx::Image* pSrcImage, grfx::Image* pDstImage) override {}
+
+    void BeginQuery(const grfx::Query* pQuery, uint32_t queryIndex) override {}
+    void EndQuery(const grfx::Query* pQuery, uint32_t queryIndex) override {}
+    void WriteTimestamp(const grfx::Query* pQuery, grfx::PipelineStage pipelineStage, uint32_t queryIndex) override {}
+    void ResolveQueryData(grfx::Query* pQuery, uint32_t startIndex, uint32_t numQueries) override {}
+
+protected:
+    Result CreateApiObjects(const grfx::internal::CommandBufferCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+
+private:
+    void BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo) override {}
+    void EndRenderPassImpl() override {}
+
+    void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo) override {}
+    void EndRenderingImpl() override {}
+
+    Result BeginSecondaryImpl(const grfx::RenderPass* pRenderPass) override { return ppx::SUCCESS; }
+    void   ExecuteCommandsImpl(uint32_t commandBufferCount, const grfx::CommandBuffer* const* ppCommandBuffers) override {}
+
+    void PushDescriptorImpl(
+        grfx::CommandType              pipelineBindPoint,
+        const grfx::PipelineInterface* pInterface,
+        grfx::DescriptorType           descriptorType,
+        uint32_t                       binding,
+        uint32_t                       set,
+        uint32_t                       bufferOffset,
+        const grfx::Buffer*            pBuffer,
+        const grfx::SampledImageView*  pSampledImageView,
+        const grfx::StorageImageView*  pStorageImageView,
+        const grfx::Sampler*           pSampler) override {}
+
+private:
+    std::vector<Copy>      mCopies;
+    std::vector<ImageCopy> mImageCopies;
+};
+
+// Runs the copies of submitted command buffers on the CPU and signals the
+// fence right away. Submits fail without running anything while the
+// submit result is set to an error. With signaling turned off the fence
+// is left for the test to signal, as if the GPU were still busy, see
+// FakeFence.
+class FakeQueue : public grfx::Queue
+{
+public:
+    uint32_t     GetSubmitCount() const { return mSubmitCount; }
+    uint32_t     GetCopyCount() const { return mCopyCount; }
+    grfx::Fence* GetLastSubmitFence() const { return mLastSubmitFence; }
+
+    // Image to buffer copies of every successful submit
+    const std::vector<FakeCommandBuffer::ImageCopy>& GetImageCopies() const { return mImageCopies; }
+
+    void SetSubmitResult(Result result) { mSubmitResult = result; }
+    void SetSignalOnSubmit(bool signal) { mSignalOnSubmit = signal; }
+
+    Result WaitIdle() override { return ppx::SUCCESS; }
+
+    Result Submit(const grfx::SubmitInfo* pSubmitInfo) override
+    {
+        mLastSubmitFence = pSubmitInfo->pFence;
+        if (Failed(mSubmitResult)) {
+            return mSubmitResult;
+        }
+
+        for (uint32_t i = 0; i < pSubmitInfo->commandBufferCount; ++i) {
+            auto pCommandBuffer = static_cast<const FakeCommandBuffer*>(pSubmitInfo->ppCommandBuffers[i]);
+            for (const auto& copy : pCommandBuffer->GetCopies()) {
+                char* pSrc = static_cast<FakeBuffer*>(copy.pSrcBuffer)->GetMemory() + copy.info.srcBuffer.offset;
+                char* pDst = static_cast<FakeBuffer*>(copy.pDstBuffer)->GetMemory() + copy.info.dstBuffer.offset;
+                std::memcpy(pDst, pSrc, static_cast<size_t>(copy.info.size));
+                mCopyCount += 1;
+            }
+            const auto& imageCopies = pCommandBuffer->GetImageCopies();
+            mImageCopies.insert(mImageCopies.end(), imageCopies.begin(), imageCopies.end());
+        }
+        mSubmitCount += 1;
+
+        if (!IsNull(pSubmitInfo->pFence) && mSignalOnSubmit) {
+            return pSubmitInfo->pFence->SignalOnHost();
+        }
+        return ppx::SUCCESS;
+    }
+
+    void DeferWaitSemaphores(uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores) override {}
+
+    Result GetTimestampFrequency(uint64_t* pFrequency) const override
+    {
+        *pFrequency = 1;
+        return ppx::SUCCESS;
+    }
+
+protected:
+    Result CreateApiObjects(const grfx::internal::QueueCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+
+private:
+    uint32_t                                  mSubmitCount     = 0;
+    uint32_t                                  mCopyCount       = 0;
+    grfx::Fence*                              mLastSubmitFence = nullptr;
+    Result                                    mSubmitResult    = ppx::SUCCESS;
+    bool                                      mSignalOnSubmit  = true;
+    std::vector<FakeCommandBuffer::ImageCopy> mImageCopies;
+};
+
+class FakeGpu : public grfx::Gpu
+{
+public:
+    FakeGpu() { mDeviceName = "FakeGpu"; }
+
+    uint32_t GetGraphicsQueueCount() const override { return 1; }
+    uint32_t GetComputeQueueCount() const override { return 0; }
+    uint32_t GetTransferQueueCount() const override { return 0; }
+
+protected:
+    Result CreateApiObjects(const grfx::internal::GpuCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+};
+
+// Parent of a FakeDevice, so the device reports an API
+class FakeInstance : public grfx::Instance
+{
+public:
+    explicit FakeInstance(grfx::Api api) { mCreateInfo.api = api; }
+
+    // Creates pDevice, which must not be destroyed by the instance
+    Result CreateFakeDevice(const grfx::DeviceCreateInfo* pCreateInfo, grfx::Device* pDevice)
+    {
+        mPendingDevice        = pDevice;
+        grfx::Device* pResult = nullptr;
+        return CreateDevice(pCreateInfo, &pResult);
+    }
+
+#if defined(PPX_BUILD_XR)
+    const XrBaseInStructure* XrGetGraphicsBinding() const override { return nullptr; }
+    bool                     XrIsGraphicsBindingValid() const override { return false; }
+    void                     XrUpdateDeviceInGraphicsBinding() override {}
+#endif
+
+protected:
+    Result AllocateObject(grfx::Device** ppDevice) override
+    {
+        if (IsNull(mPendingDevice)) {
+            return ppx::ERROR_ALLOCATION_FAILED;
+        }
+        *ppDevice      = mPendingDevice;
+        mPendingDevice = nullptr;
+        return ppx::SUCCESS;
+    }
+
+    Result AllocateObject(grfx::Gpu** ppGpu) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::Surface** ppSurface) override { return ppx::ERROR_ALLOCATION_FAILED; }
+
+    Result CreateApiObjects(const grfx::InstanceCreateInfo* pCreateInfo) override { return ppx::SUCCESS; }
+    void   DestroyApiObjects() override {}
+
+private:
+    grfx::Device* mPendingDevice = nullptr;
+};
+
+// Device with one FakeQueue that can create buffers, command buffers and
+// fences, which is enough for grfx::UploadQueue and grfx::StagingRing,
+// shader modules, pipeline interfaces and pipelines for testing pipeline
+// sharing, and images and sampled image views. Creating any other API
+// object fails.
+class FakeDevice : public grfx::Device
+{
+public:
+    explicit FakeDevice(bool sharePipelines = true, grfx::Api api = grfx::API_VK_1_1)
+        : mInstance(api)
+    {
+        grfx::DeviceCreateInfo createInfo = {};
+        createInfo.pGpu                   = &mGpu;
+        createInfo.graphicsQueueCount     = 1;
+        createInfo.sharePipelines         = sharePipelines;
+        EXPECT_EQ(mInstance.CreateFakeDevice(&createInfo, this), ppx::SUCCESS);
+    }
+
+    ~FakeDevice()
+    {
+        Destroy();
+    }
+
+    FakeQueue* GetFakeQueue() const { return static_cast<FakeQueue*>(GetGraphicsQueue().Get()); }
+
+    // Creating images fails once count more images have been created
+    void SetImageCreateLimit(uint32_t count) { mImageCreateLimit = count; }
+
+    // Submit count of the queue when each image was destroyed, for checking
+    // that copies into an image were submitted before it was destroyed.
+    // Images destroyed with the device aren't included.
+    const std::vector<uint32_t>& GetSubmitCountsAtImageDestroy() const { return mSubmitCountsAtImageDestroy; }
+
+    Result WaitIdle() override { return ppx::SUCCESS; }
+
+    bool PipelineStatsAvailable() const override { return false; }
+    bool DynamicRenderingSupported() const override { return false; }
+    bool IndependentBlendingSupported() const override { return false; }
+    bool FragmentStoresAndAtomicsSupported() const override { return false; }
+
+protected:
+    Result CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo) override
+    {
+        grfx::internal::QueueCreateInfo queueCreateInfo = {};
+        queueCreateInfo.commandType                     = grfx::COMMAND_TYPE_GRAPHICS;
+
+        grfx::QueuePtr queue;
+        return CreateGraphicsQueue(&queueCreateInfo, &queue);
+    }
+
+    void DestroyApiObjects() override {}
+
+    Result AllocateObject(grfx::Buffer** ppObject) override { return Allocate<FakeBuffer>(ppObject); }
+    Result AllocateObject(grfx::CommandBuffer** ppObject) override { return Allocate<FakeCommandBuffer>(ppObject); }
+    Result AllocateObject(grfx::CommandPool** ppObject) override { return Allocate<FakeCommandPool>(ppObject); }
+    Result AllocateObject(grfx::ComputePipeline** ppObject) override { return Allocate<FakeComputePipeline>(ppObject); }
+    Result AllocateObject(grfx::Fence** ppObject) override { return Allocate<FakeFence>(ppObject); }
+    Result AllocateObject(grfx::GraphicsPipeline** ppObject) override { return Allocate<FakeGraphicsPipeline>(ppObject); }
+
+    Result AllocateObject(grfx::Image** ppObject) override
+    {
+        if (mImageCreateLimit == 0) {
+            return ppx::ERROR_ALLOCATION_FAILED;
+        }
+        mImageCreateLimit -= 1;
+        return Allocate<FakeImage>(ppObject);
+    }
+
+    Result AllocateObject(grfx::PipelineInterface** ppObject) override { return Allocate<FakePipelineInterface>(ppObject); }
+    Result AllocateObject(grfx::Queue** ppObject) override { return Allocate<FakeQueue>(ppObject); }
+    Result AllocateObject(grfx::SampledImageView** ppObject) override { return Allocate<FakeSampledImageView>(ppObject); }
+    Result AllocateObject(grfx::ShaderModule** ppObject) override { return Allocate<FakeShaderModule>(ppObject); }
+
+    Result AllocateObject(grfx::DepthStencilView** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::DescriptorPool** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::DescriptorSet** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::DescriptorSetLayout** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::Query** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::RenderPass** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::RenderTargetView** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::Sampler** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::Semaphore** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::ShaderProgram** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::ShadingRatePattern** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::StorageImageView** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+    Result AllocateObject(grfx::Swapchain** ppObject) override { return ppx::ERROR_ALLOCATION_FAILED; }
+
+private:
+    template <typename FakeT, typename ObjectT>
+    Result Allocate(ObjectT** ppObject)
+    {
+        *ppObject = new FakeT();
+        return ppx::SUCCESS;
+    }
+
+private:
+    friend class FakeImage;
+
+    void OnImageDestroyed()
+    {
+        if (GetGraphicsQueueCount() > 0) {
+            mSubmitCountsAtImageDestroy.push_back(GetFakeQueue()->GetSubmitCount());
+        }
+    }
+
+private:
+    FakeGpu               mGpu;
+    FakeInstance          mInstance;
+    uint32_t              mImageCreateLimit = UINT32_MAX;
+    std::vector<uint32_t> mSubmitCountsAtImageDestroy;
+};
+
+inline void FakeImage::DestroyApiObjects()
+{
+    if (!IsNull(GetDevice())) {
+        static_cast<FakeDevice*>(GetDevice())->OnImageDestroyed();
+    }
+}
+
+} // namespace test
+} // namespace ppx
+
+#endif // ppx_test_grfx_fakes_h
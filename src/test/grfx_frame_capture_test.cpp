@@ -0,0 +1,160 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_frame_capture.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+grfx::ImageCreateInfo ColorTarget(uint32_t width, uint32_t height)
+{
+    grfx::ImageCreateInfo createInfo = {};
+    createInfo.width                 = width;
+    createInfo.height                = height;
+    createInfo.depth                 = 1;
+    createInfo.format                = grfx::FORMAT_R8G8B8A8_UNORM;
+    return createInfo;
+}
+
+class FrameCaptureTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mDirectory = std::filesystem::temp_directory_path() / "ppx_frame_capture_test";
+        std::filesystem::create_directories(mDirectory);
+
+        // Copies stay in flight until the test signals their fence or the
+        // capture blocks on it
+        mDevice.GetFakeQueue()->SetSignalOnSubmit(false);
+
+        grfx::FrameCaptureCreateInfo createInfo = {};
+        createInfo.pQueue                       = mDevice.GetGraphicsQueue();
+        createInfo.slotCount                    = 2;
+        ASSERT_EQ(mDevice.CreateFrameCapture(&createInfo, &mFrameCapture), ppx::SUCCESS);
+    }
+
+    void TearDown() override
+    {
+        EXPECT_EQ(mFrameCapture->WaitIdle(), ppx::SUCCESS);
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    // Keeps the fence of the capture's slot in mFences
+    Result Capture(const std::string& name)
+    {
+        Result ppxres = mFrameCapture->Capture(&mImage, grfx::RESOURCE_STATE_RENDER_TARGET, (mDirectory / name).string());
+        mFences.push_back(static_cast<FakeFence*>(mDevice.GetFakeQueue()->GetLastSubmitFence()));
+        return ppxres;
+    }
+
+    FakeDevice              mDevice;
+    FakeImage               mImage{ColorTarget(4, 4)};
+    grfx::FrameCapturePtr   mFrameCapture;
+    std::filesystem::path   mDirectory;
+    std::vector<FakeFence*> mFences;
+};
+
+} // namespace
+
+TEST_F(FrameCaptureTest, ReusesSlotsRoundRobinAndOnlyBlocksWhenAllAreBusy)
+{
+    ASSERT_EQ(Capture("a.ppm"), ppx::SUCCESS);
+    ASSERT_EQ(Capture("b.ppm"), ppx::SUCCESS);
+    EXPECT_NE(mFences[0], mFences[1]);
+    EXPECT_EQ(mFences[0]->GetBlockingWaitCount(), 0);
+    EXPECT_EQ(mFences[1]->GetBlockingWaitCount(), 0);
+
+    // Both slots are copying, so the third capture waits for the oldest
+    ASSERT_EQ(Capture("c.ppm"), ppx::SUCCESS);
+    EXPECT_EQ(mFences[2], mFences[0]);
+    EXPECT_EQ(mFences[0]->GetBlockingWaitCount(), 1);
+    EXPECT_EQ(mFences[1]->GetBlockingWaitCount(), 0);
+}
+
+TEST_F(FrameCaptureTest, PollStopsAtFirstCopyStillRunning)
+{
+    ASSERT_EQ(Capture("a.ppm"), ppx::SUCCESS);
+    ASSERT_EQ(Capture("b.ppm"), ppx::SUCCESS);
+
+    // The second copy finishing first isn't picked up, starting its write
+    // would reset its fence
+    ASSERT_EQ(mFences[1]->SignalOnHost(), ppx::SUCCESS);
+    mFrameCapture->Poll();
+    EXPECT_EQ(mFences[1]->Wait(0), ppx::SUCCESS);
+
+    ASSERT_EQ(mFences[0]->SignalOnHost(), ppx::SUCCESS);
+    mFrameCapture->Poll();
+    EXPECT_EQ(mFences[0]->Wait(0), ppx::ERROR_WAIT_TIMED_OUT);
+    EXPECT_EQ(mFences[1]->Wait(0), ppx::ERROR_WAIT_TIMED_OUT);
+
+    ASSERT_EQ(mFrameCapture->WaitIdle(), ppx::SUCCESS);
+    EXPECT_EQ(mFrameCapture->GetWrittenCount(), 2);
+    EXPECT_EQ(mFences[0]->GetBlockingWaitCount(), 0);
+    EXPECT_EQ(mFences[1]->GetBlockingWaitCount(), 0);
+}
+
+TEST_F(FrameCaptureTest, WaitIdleDrainsEverySlot)
+{
+    ASSERT_EQ(Capture("a.ppm"), ppx::SUCCESS);
+    ASSERT_EQ(Capture("b.ppm"), ppx::SUCCESS);
+
+    ASSERT_EQ(mFrameCapture->WaitIdle(), ppx::SUCCESS);
+    EXPECT_EQ(mFrameCapture->GetWrittenCount(), 2);
+    EXPECT_EQ(mFrameCapture->GetFailedCount(), 0);
+    EXPECT_EQ(mFences[0]->GetBlockingWaitCount(), 1);
+    EXPECT_EQ(mFences[1]->GetBlockingWaitCount(), 1);
+    EXPECT_TRUE(std::filesystem::exists(mDirectory / "a.ppm"));
+    EXPECT_TRUE(std::filesystem::exists(mDirectory / "b.ppm"));
+
+    // Vulkan rows are tightly packed
+    const auto& copies = mDevice.GetFakeQueue()->GetImageCopies();
+    ASSERT_EQ(copies.size(), 2);
+    EXPECT_EQ(copies[0].pitch.rowPitch, 16);
+    EXPECT_EQ(copies[0].pDstBuffer->GetSize(), 16 * 4);
+}
+
+TEST(FrameCaptureD3D12Test, NarrowImageBufferFitsAlignedRows)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ppx_frame_capture_d3d12_test.ppm";
+
+    FakeDevice device(true, grfx::API_DX_12_0);
+    FakeImage  image(ColorTarget(4, 4));
+
+    grfx::FrameCapturePtr        frameCapture;
+    grfx::FrameCaptureCreateInfo createInfo = {};
+    createInfo.pQueue                       = device.GetGraphicsQueue();
+    ASSERT_EQ(device.CreateFrameCapture(&createInfo, &frameCapture), ppx::SUCCESS);
+
+    ASSERT_EQ(frameCapture->Capture(&image, grfx::RESOURCE_STATE_RENDER_TARGET, path.string()), ppx::SUCCESS);
+    ASSERT_EQ(frameCapture->WaitIdle(), ppx::SUCCESS);
+    EXPECT_EQ(frameCapture->GetWrittenCount(), 1);
+
+    // 16 byte rows are copied with a 256 byte pitch
+    const auto& copies = device.GetFakeQueue()->GetImageCopies();
+    ASSERT_EQ(copies.size(), 1);
+    EXPECT_EQ(copies[0].pitch.rowPitch, PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    EXPECT_GE(copies[0].pDstBuffer->GetSize(), PPX_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * 4);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,126 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_swapchain.h"
+
+using namespace ppx;
+using grfx::internal::HeadlessPresentQueue;
+
+namespace {
+
+constexpr double kRefreshPeriod = 1.0 / 60.0;
+
+// Some time within refresh n, away from the boundaries
+double RefreshTime(uint64_t n)
+{
+    return (n + 0.5) * kRefreshPeriod;
+}
+
+} // namespace
+
+TEST(HeadlessPresentQueueTest, ImmediateIsRoundRobin)
+{
+    HeadlessPresentQueue queue;
+    queue.Reset(3, grfx::PRESENT_MODE_IMMEDIATE, kRefreshPeriod, 0);
+    EXPECT_FALSE(queue.IsPaced());
+
+    uint32_t imageIndex = UINT32_MAX;
+    double   retryTime  = 0;
+    for (uint32_t i = 0; i < 7; ++i) {
+        ASSERT_TRUE(queue.Acquire(0, &imageIndex, &retryTime));
+        EXPECT_EQ(imageIndex, i % 3);
+        queue.Present(0, imageIndex);
+    }
+}
+
+TEST(HeadlessPresentQueueTest, SingleImageIsNotPaced)
+{
+    HeadlessPresentQueue queue;
+    queue.Reset(1, grfx::PRESENT_MODE_FIFO, kRefreshPeriod, 0);
+    EXPECT_FALSE(queue.IsPaced());
+
+    queue.Reset(2, grfx::PRESENT_MODE_FIFO, 0, 0);
+    EXPECT_FALSE(queue.IsPaced());
+}
+
+TEST(HeadlessPresentQueueTest, FifoDisplaysOnePerRefresh)
+{
+    HeadlessPresentQueue queue;
+    queue.Reset(2, grfx::PRESENT_MODE_FIFO, kRefreshPeriod, 0);
+    ASSERT_TRUE(queue.IsPaced());
+
+    uint32_t imageIndex = UINT32_MAX;
+    double   retryTime  = 0;
+    ASSERT_TRUE(queue.Acquire(RefreshTime(0), &imageIndex, &retryTime));
+    EXPECT_EQ(imageIndex, 0u);
+    queue.Present(RefreshTime(0), imageIndex);
+    ASSERT_TRUE(queue.Acquire(RefreshTime(0), &imageIndex, &retryTime));
+    EXPECT_EQ(imageIndex, 1u);
+    queue.Present(RefreshTime(0), imageIndex);
+
+    // Both images are queued until the next refresh
+    EXPECT_FALSE(queue.Acquire(RefreshTime(0), &imageIndex, &retryTime));
+    EXPECT_DOUBLE_EQ(retryTime, 1 * kRefreshPeriod);
+
+    // Image 0 is displayed, image 1 is still queued
+    EXPECT_FALSE(queue.Acquire(RefreshTime(1), &imageIndex, &retryTime));
+    EXPECT_EQ(queue.GetDisplayedImageIndex(), 0u);
+    EXPECT_DOUBLE_EQ(retryTime, 2 * kRefreshPeriod);
+
+    // Image 1 replaces image 0 on screen
+    ASSERT_TRUE(queue.Acquire(RefreshTime(2), &imageIndex, &retryTime));
+    EXPECT_EQ(imageIndex, 0u);
+    EXPECT_EQ(queue.GetDisplayedImageIndex(), 1u);
+}
+
+TEST(HeadlessPresentQueueTest, FifoKeepsPresentOrderAcrossRefreshes)
+{
+    HeadlessPresentQueue queue;
+    queue.Reset(3, grfx::PRESENT_MODE_FIFO, kRefreshPeriod, 0);
+
+    uint32_t imageIndex = UINT32_MAX;
+    double   retryTime  = 0;
+    for (uint32_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(queue.Acquire(RefreshTime(0), &imageIndex, &retryTime));
+        queue.Present(RefreshTime(0), imageIndex);
+    }
+
+    // A long stall only displays what was queued, one image per refresh
+    EXPECT_TRUE(queue.Acquire(RefreshTime(100), &imageIndex, &retryTime));
+    EXPECT_EQ(queue.GetDisplayedImageIndex(), 2u);
+    EXPECT_EQ(queue.GetRefreshCount(), 100u);
+}
+
+TEST(HeadlessPresentQueueTest, MailboxReplacesQueuedImage)
+{
+    HeadlessPresentQueue queue;
+    queue.Reset(3, grfx::PRESENT_MODE_MAILBOX, kRefreshPeriod, 0);
+    ASSERT_TRUE(queue.IsPaced());
+
+    uint32_t imageIndex = UINT32_MAX;
+    double   retryTime  = 0;
+
+    // Rendering faster than the refresh never blocks, the newest image wins
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.Acquire(RefreshTime(0), &imageIndex, &retryTime));
+        queue.Present(RefreshTime(0), imageIndex);
+    }
+    const uint32_t lastPresented = imageIndex;
+
+    ASSERT_TRUE(queue.Acquire(RefreshTime(1), &imageIndex, &retryTime));
+    EXPECT_EQ(queue.GetDisplayedImageIndex(), lastPresented);
+    EXPECT_NE(imageIndex, lastPresented);
+}
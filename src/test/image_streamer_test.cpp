@@ -0,0 +1,126 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_image_streamer.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+void WriteU32(std::vector<char>& data, size_t offset, uint32_t value)
+{
+    memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+// 16x16 BC1 with 3 levels of 128, 32 and 8 bytes
+std::vector<char> MakeDDS()
+{
+    std::vector<char> data(128, 0);
+    memcpy(data.data(), "DDS ", 4);
+    WriteU32(data, 4, 124);
+    WriteU32(data, 12, 16);
+    WriteU32(data, 16, 16);
+    WriteU32(data, 28, 3);
+    WriteU32(data, 76, 32);
+    WriteU32(data, 80, 0x4); // DDPF_FOURCC
+    memcpy(data.data() + 84, "DXT1", 4);
+    data.insert(data.end(), 128 + 32 + 8, 'a');
+    return data;
+}
+
+class ImageStreamerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mPath = std::filesystem::temp_directory_path() / "ppx_image_streamer_test.dds";
+        {
+            std::vector<char> data = MakeDDS();
+            std::ofstream     os(mPath, std::ios::binary);
+            os.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        // Copies stay in flight until the test signals their fence or the
+        // upload queue blocks on it
+        mDevice.GetFakeQueue()->SetSignalOnSubmit(false);
+
+        grfx::UploadQueueCreateInfo uploadQueueCreateInfo = {};
+        uploadQueueCreateInfo.pQueue                      = mDevice.GetGraphicsQueue();
+        ASSERT_EQ(mDevice.CreateUploadQueue(&uploadQueueCreateInfo, &mUploadQueue), ppx::SUCCESS);
+
+        // The smallest level on creation, then level 1 or one block row of
+        // level 0 per update
+        grfx::ImageStreamerCreateInfo streamerCreateInfo = {};
+        streamerCreateInfo.pUploadQueue                  = mUploadQueue;
+        streamerCreateInfo.initialBytes                  = 8;
+        streamerCreateInfo.bytesPerUpdate                = 32;
+        ASSERT_EQ(mDevice.CreateImageStreamer(&streamerCreateInfo, &mImageStreamer), ppx::SUCCESS);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(mPath);
+    }
+
+    void CompleteLastSubmit()
+    {
+        ASSERT_EQ(mDevice.GetFakeQueue()->GetLastSubmitFence()->SignalOnHost(), ppx::SUCCESS);
+    }
+
+    FakeDevice             mDevice;
+    grfx::UploadQueuePtr   mUploadQueue;
+    grfx::ImageStreamerPtr mImageStreamer;
+    std::filesystem::path  mPath;
+};
+
+} // namespace
+
+TEST_F(ImageStreamerTest, LevelsBecomeResidentWhenTheirCopiesComplete)
+{
+    // Creation waits for the smallest level
+    grfx::ImagePtr image;
+    ASSERT_EQ(mImageStreamer->CreateImageFromFile(mPath, &image), ppx::SUCCESS);
+    EXPECT_EQ(mImageStreamer->GetResidentMipLevel(image), 2);
+
+    // Level 1 is flushed but still being copied
+    ASSERT_EQ(mImageStreamer->Update(), ppx::SUCCESS);
+    EXPECT_EQ(mImageStreamer->GetResidentMipLevel(image), 2);
+
+    CompleteLastSubmit();
+    ASSERT_EQ(mImageStreamer->Update(), ppx::SUCCESS);
+    EXPECT_EQ(mImageStreamer->GetResidentMipLevel(image), 1);
+
+    // Every row of level 0 is flushed, the last ones are still being copied
+    while (mImageStreamer->GetPendingBytes() > 0) {
+        CompleteLastSubmit();
+        ASSERT_EQ(mImageStreamer->Update(), ppx::SUCCESS);
+    }
+    EXPECT_EQ(mImageStreamer->GetResidentMipLevel(image), 1);
+    EXPECT_EQ(mImageStreamer->GetStreamingImageCount(), 1);
+
+    CompleteLastSubmit();
+    ASSERT_EQ(mImageStreamer->Update(), ppx::SUCCESS);
+    EXPECT_EQ(mImageStreamer->GetResidentMipLevel(image), 0);
+    EXPECT_EQ(mImageStreamer->GetStreamingImageCount(), 0);
+}
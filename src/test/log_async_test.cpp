@@ -0,0 +1,194 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/log.h"
+#include "ppx/config.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ppx {
+
+class LogAsyncTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // See LogTest, logging might already be initialized by other tests.
+        Log::Shutdown();
+        Log::Initialize(LOG_MODE_CONSOLE, nullptr, &mOut);
+    }
+
+    void TearDown() override
+    {
+        Log::Shutdown();
+    }
+
+    // The writer thread may write to mOut at any time in async mode
+    std::string GetOutput()
+    {
+        Log::Get()->Lock();
+        std::string output = mOut.str();
+        Log::Get()->Unlock();
+        return output;
+    }
+
+    std::vector<std::string> GetOutputLines()
+    {
+        std::vector<std::string> lines;
+        std::stringstream        ss(GetOutput());
+        for (std::string line; std::getline(ss, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::stringstream mOut;
+};
+
+TEST_F(LogAsyncTest, InitializeWithAsyncMode)
+{
+    std::stringstream out;
+
+    Log::Shutdown();
+    Log::Initialize(LOG_MODE_CONSOLE | LOG_MODE_ASYNC, nullptr, &out);
+    EXPECT_TRUE(Log::IsModeActive(LOG_MODE_ASYNC));
+
+    PPX_LOG_INFO("test " << 123);
+    Log::Shutdown();
+
+    EXPECT_EQ("Logging started\ntest 123\nLogging stopped\n", out.str());
+}
+
+TEST_F(LogAsyncTest, DrainWritesInOrder)
+{
+    Log::SetAsync(true);
+    for (int i = 0; i < 100; ++i) {
+        PPX_LOG_INFO("record " << i);
+    }
+    PPX_LOG_WARN("last");
+    Log::Get()->Drain();
+
+    std::vector<std::string> lines = GetOutputLines();
+    ASSERT_EQ(lines.size(), 102u);
+    EXPECT_EQ(lines[0], "Logging started");
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(lines[i + 1], "record " + std::to_string(i));
+    }
+    EXPECT_EQ(lines[101], "[WARNING] last");
+}
+
+TEST_F(LogAsyncTest, FatalIsWrittenBeforeReturning)
+{
+    Log::SetAsync(true);
+    PPX_LOG_INFO("info");
+    PPX_LOG_FATAL("fatal");
+
+    EXPECT_EQ("Logging started\ninfo\n[FATAL ERROR] fatal\n", GetOutput());
+}
+
+TEST_F(LogAsyncTest, SetAsyncOffWritesQueuedRecords)
+{
+    Log::SetAsync(true);
+    PPX_LOG_INFO("queued");
+    Log::SetAsync(false);
+    EXPECT_FALSE(Log::IsModeActive(LOG_MODE_ASYNC));
+
+    EXPECT_EQ("Logging started\nqueued\n", GetOutput());
+
+    // Back to synchronous writes
+    PPX_LOG_INFO("sync");
+    EXPECT_EQ("Logging started\nqueued\nsync\n", GetOutput());
+}
+
+TEST_F(LogAsyncTest, DropPolicyReportsDroppedRecords)
+{
+    LogAsyncSettings settings = {};
+    settings.queueCapacity    = 4;
+    settings.overflowPolicy   = LOG_OVERFLOW_POLICY_DROP;
+    Log::SetAsync(true, settings);
+
+    // Holding the write mutex keeps the writer thread from draining
+    Log::Get()->Lock();
+    for (int i = 0; i < 10; ++i) {
+        PPX_LOG_INFO("record " << i);
+    }
+    Log::Get()->Unlock();
+
+    EXPECT_EQ(Log::GetDroppedRecordCount(), 6u);
+
+    std::vector<std::string> lines = GetOutputLines();
+    ASSERT_EQ(lines.size(), 6u);
+    EXPECT_EQ(lines[1], "[WARNING] 6 log records dropped, the logging thread's queue was full");
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(lines[i + 2], "record " + std::to_string(i));
+    }
+}
+
+TEST_F(LogAsyncTest, BlockPolicyKeepsEveryRecord)
+{
+    LogAsyncSettings settings = {};
+    settings.queueCapacity    = 4;
+    settings.overflowPolicy   = LOG_OVERFLOW_POLICY_BLOCK;
+    Log::SetAsync(true, settings);
+
+    const int                kThreadCount = 4;
+    const int                kRecordCount = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreadCount; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < kRecordCount; ++i) {
+                PPX_LOG_INFO(t << " " << i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Log::Get()->Drain();
+
+    EXPECT_EQ(Log::GetDroppedRecordCount(), 0u);
+
+    // Records from each thread are written in the order they were logged
+    std::vector<std::string> lines = GetOutputLines();
+    ASSERT_EQ(lines.size(), static_cast<size_t>(kThreadCount * kRecordCount + 1));
+    std::vector<int> nextRecord(kThreadCount, 0);
+    for (size_t i = 1; i < lines.size(); ++i) {
+        std::stringstream ss(lines[i]);
+        int               t      = -1;
+        int               record = -1;
+        ss >> t >> record;
+        ASSERT_GE(t, 0);
+        ASSERT_LT(t, kThreadCount);
+        EXPECT_EQ(record, nextRecord[t]);
+        nextRecord[t] = record + 1;
+    }
+}
+
+TEST_F(LogAsyncTest, LongRecordsAreTruncated)
+{
+    LogAsyncSettings settings = {};
+    settings.maxRecordSize    = 8;
+    Log::SetAsync(true, settings);
+
+    PPX_LOG_INFO("0123456789abcdef");
+    Log::Get()->Drain();
+
+    EXPECT_EQ("Logging started\n01234567 [truncated]\n", GetOutput());
+}
+
+} // namespace ppx
@@ -0,0 +1,240 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/mesh_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+constexpr const char* kQuadObj = R"(
+v 0 0 0
+v 2 0 0
+v 2 1 0
+v 0 1 0
+vn 0 0 1
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+f 1/1/1 2/2/1 3/3/1
+f 1/1/1 3/3/1 4/4/1
+)";
+
+class MeshCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        mObjPath               = std::filesystem::temp_directory_path() / ("ppx_mesh_cache_test_" + name + ".obj");
+        mCachePath             = std::filesystem::temp_directory_path() / ("ppx_mesh_cache_test_" + name + ".ppxmesh");
+        std::ofstream file(mObjPath);
+        file << kQuadObj;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(mObjPath);
+        std::filesystem::remove(mCachePath);
+    }
+
+    // Builds the geometry the same way grfx_util::CreateMeshFromFile() does
+    void BuildGeometry(const TriMeshOptions& options, Geometry* pGeometry, TriMesh* pMesh)
+    {
+        ASSERT_EQ(TriMesh::CreateFromOBJ(mObjPath, options, pMesh), ppx::SUCCESS);
+        ASSERT_EQ(Geometry::Create(*pMesh, pGeometry), ppx::SUCCESS);
+    }
+
+    std::vector<char> ReadCache() const
+    {
+        std::ifstream is(mCachePath, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+    std::filesystem::path mObjPath;
+    std::filesystem::path mCachePath;
+};
+
+} // namespace
+
+TEST_F(MeshCacheTest, RoundTrip)
+{
+    const TriMeshOptions options = TriMeshOptions().WeldVertices().Normals().TexCoords();
+
+    TriMesh  mesh;
+    Geometry geometry;
+    BuildGeometry(options, &geometry, &mesh);
+
+    uint64_t hash = 0;
+    ASSERT_EQ(MeshCacheFile::HashSource(mObjPath, options, &hash), ppx::SUCCESS);
+    ASSERT_EQ(MeshCacheFile::Write(mCachePath, hash, geometry, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax()), ppx::SUCCESS);
+
+    MeshCacheFile cache;
+    ASSERT_EQ(cache.Open(mCachePath, hash), ppx::SUCCESS);
+    EXPECT_EQ(cache.GetIndexType(), grfx::INDEX_TYPE_UINT16);
+    EXPECT_EQ(cache.GetIndexCount(), 6u);
+    EXPECT_EQ(cache.GetVertexCount(), 4u);
+    EXPECT_EQ(cache.GetBoundingBoxMax().x, 2.0f);
+    EXPECT_EQ(cache.GetBoundingBoxMax().y, 1.0f);
+
+    ASSERT_EQ(cache.GetIndexDataSize(), geometry.GetIndexBuffer()->GetSize());
+    EXPECT_EQ(memcmp(cache.GetIndexData(), geometry.GetIndexBuffer()->GetData(), cache.GetIndexDataSize()), 0);
+
+    ASSERT_EQ(cache.GetVertexBufferCount(), geometry.GetVertexBufferCount());
+    for (uint32_t i = 0; i < cache.GetVertexBufferCount(); ++i) {
+        ASSERT_EQ(cache.GetVertexDataSize(i), geometry.GetVertexBuffer(i)->GetSize());
+        EXPECT_EQ(memcmp(cache.GetVertexData(i), geometry.GetVertexBuffer(i)->GetData(), cache.GetVertexDataSize(i)), 0);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(cache.GetVertexData(i)) % kMeshCacheAlignment, 0u);
+
+        const grfx::VertexBinding& expected = *geometry.GetVertexBinding(i);
+        const grfx::VertexBinding& actual   = cache.GetGeometryOptions().vertexBindings[i];
+        EXPECT_EQ(actual.GetBinding(), expected.GetBinding());
+        EXPECT_EQ(actual.GetStride(), expected.GetStride());
+        ASSERT_EQ(actual.GetAttributeCount(), expected.GetAttributeCount());
+
+        const grfx::VertexAttribute* pExpected = nullptr;
+        const grfx::VertexAttribute* pActual   = nullptr;
+        expected.GetAttribute(0, &pExpected);
+        actual.GetAttribute(0, &pActual);
+        EXPECT_EQ(pActual->semantic, pExpected->semantic);
+        EXPECT_EQ(pActual->semanticName, pExpected->semanticName);
+        EXPECT_EQ(pActual->format, pExpected->format);
+        EXPECT_EQ(pActual->location, pExpected->location);
+    }
+}
+
+TEST_F(MeshCacheTest, CreateGeometryCopiesBuffers)
+{
+    const TriMeshOptions options = TriMeshOptions().Indices().Normals();
+
+    TriMesh  mesh;
+    Geometry geometry;
+    BuildGeometry(options, &geometry, &mesh);
+    ASSERT_EQ(MeshCacheFile::Write(mCachePath, 1, geometry, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax()), ppx::SUCCESS);
+
+    MeshCacheFile cache;
+    ASSERT_EQ(cache.Open(mCachePath, 1), ppx::SUCCESS);
+
+    Geometry copy;
+    ASSERT_EQ(cache.CreateGeometry(&copy), ppx::SUCCESS);
+    EXPECT_EQ(copy.GetIndexCount(), geometry.GetIndexCount());
+    EXPECT_EQ(copy.GetVertexCount(), geometry.GetVertexCount());
+    ASSERT_EQ(copy.GetVertexBufferCount(), geometry.GetVertexBufferCount());
+    for (uint32_t i = 0; i < copy.GetVertexBufferCount(); ++i) {
+        ASSERT_EQ(copy.GetVertexBuffer(i)->GetSize(), geometry.GetVertexBuffer(i)->GetSize());
+        EXPECT_EQ(memcmp(copy.GetVertexBuffer(i)->GetData(), geometry.GetVertexBuffer(i)->GetData(), copy.GetVertexBuffer(i)->GetSize()), 0);
+    }
+}
+
+TEST_F(MeshCacheTest, StaleCacheIsRejected)
+{
+    TriMesh  mesh;
+    Geometry geometry;
+    BuildGeometry(TriMeshOptions(), &geometry, &mesh);
+    ASSERT_EQ(MeshCacheFile::Write(mCachePath, 1, geometry, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax()), ppx::SUCCESS);
+
+    MeshCacheFile cache;
+    EXPECT_EQ(cache.Open(mCachePath, 2), ppx::ERROR_MESH_CACHE_SOURCE_MISMATCH);
+}
+
+TEST_F(MeshCacheTest, TruncatedCacheIsRejected)
+{
+    TriMesh  mesh;
+    Geometry geometry;
+    BuildGeometry(TriMeshOptions().Indices(), &geometry, &mesh);
+    ASSERT_EQ(MeshCacheFile::Write(mCachePath, 1, geometry, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax()), ppx::SUCCESS);
+
+    const std::vector<char> data = ReadCache();
+    ASSERT_GT(data.size(), sizeof(MeshCacheHeader));
+
+    MeshCacheFile full;
+    EXPECT_EQ(full.OpenFromMemory(data.data(), data.size(), 1), ppx::SUCCESS);
+
+    MeshCacheFile truncated;
+    EXPECT_EQ(truncated.OpenFromMemory(data.data(), data.size() - 1, 1), ppx::ERROR_MESH_CACHE_INVALID_FORMAT);
+
+    MeshCacheFile headerOnly;
+    EXPECT_EQ(headerOnly.OpenFromMemory(data.data(), sizeof(MeshCacheHeader) - 1, 1), ppx::ERROR_MESH_CACHE_INVALID_FORMAT);
+}
+
+TEST_F(MeshCacheTest, VertexDataSizeMustMatchVertexCount)
+{
+    TriMesh  mesh;
+    Geometry geometry;
+    BuildGeometry(TriMeshOptions().Indices().Normals(), &geometry, &mesh);
+    ASSERT_EQ(MeshCacheFile::Write(mCachePath, 1, geometry, mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax()), ppx::SUCCESS);
+
+    const std::vector<char> data = ReadCache();
+    ASSERT_GT(data.size(), sizeof(MeshCacheHeader) + sizeof(MeshCacheBinding));
+
+    // The data still fits in the file, but holds fewer vertices than the
+    // header says
+    std::vector<char> vertexCount = data;
+    MeshCacheHeader   header      = {};
+    memcpy(&header, vertexCount.data(), sizeof(header));
+    header.vertexCount += 1;
+    memcpy(vertexCount.data(), &header, sizeof(header));
+
+    MeshCacheFile vertexCountCache;
+    EXPECT_EQ(vertexCountCache.OpenFromMemory(vertexCount.data(), vertexCount.size(), 1), ppx::ERROR_MESH_CACHE_INVALID_FORMAT);
+
+    std::vector<char> stride  = data;
+    MeshCacheBinding  binding = {};
+    memcpy(&binding, stride.data() + sizeof(MeshCacheHeader), sizeof(binding));
+    binding.stride += 4;
+    memcpy(stride.data() + sizeof(MeshCacheHeader), &binding, sizeof(binding));
+
+    MeshCacheFile strideCache;
+    EXPECT_EQ(strideCache.OpenFromMemory(stride.data(), stride.size(), 1), ppx::ERROR_MESH_CACHE_INVALID_FORMAT);
+}
+
+TEST_F(MeshCacheTest, HashDependsOnContentAndOptions)
+{
+    uint64_t hash0 = 0;
+    uint64_t hash1 = 0;
+    uint64_t hash2 = 0;
+    ASSERT_EQ(MeshCacheFile::HashSource(mObjPath, TriMeshOptions(), &hash0), ppx::SUCCESS);
+    ASSERT_EQ(MeshCacheFile::HashSource(mObjPath, TriMeshOptions().Normals(), &hash1), ppx::SUCCESS);
+    EXPECT_NE(hash0, hash1);
+
+    {
+        std::ofstream file(mObjPath, std::ios::app);
+        file << "v 3 3 3\n";
+    }
+    ASSERT_EQ(MeshCacheFile::HashSource(mObjPath, TriMeshOptions(), &hash2), ppx::SUCCESS);
+    EXPECT_NE(hash0, hash2);
+
+    uint64_t hash = 0;
+    EXPECT_EQ(MeshCacheFile::HashSource(mObjPath.string() + ".missing", TriMeshOptions(), &hash), ppx::ERROR_GEOMETRY_FILE_LOAD_FAILED);
+}
+
+TEST(MeshCachePathTest, DependsOnlyOnSourcePath)
+{
+    const std::filesystem::path a = MeshCacheFile::GetCachePath("cache", "models/a/monkey.obj");
+    const std::filesystem::path b = MeshCacheFile::GetCachePath("cache", "models/b/monkey.obj");
+    EXPECT_EQ(a, MeshCacheFile::GetCachePath("cache", "models/a/../a/monkey.obj"));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a.parent_path(), std::filesystem::path("cache"));
+    EXPECT_EQ(a.extension(), ".ppxmesh");
+    EXPECT_EQ(a.filename().string().rfind("monkey_", 0), 0u);
+}
@@ -0,0 +1,309 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/geometry.h"
+#include "ppx/mesh_optimize.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+// Regular grid of (n + 1) x (n + 1) vertices, triangles emitted row by row
+void MakeGrid(uint32_t n, std::vector<uint32_t>& indices, std::vector<float>& positions)
+{
+    for (uint32_t y = 0; y <= n; ++y) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            positions.push_back(static_cast<float>(x));
+            positions.push_back(static_cast<float>(y));
+            positions.push_back(0.0f);
+        }
+    }
+    for (uint32_t y = 0; y < n; ++y) {
+        for (uint32_t x = 0; x < n; ++x) {
+            uint32_t v0 = y * (n + 1) + x;
+            uint32_t v1 = v0 + 1;
+            uint32_t v2 = v0 + (n + 1);
+            uint32_t v3 = v2 + 1;
+            indices.insert(indices.end(), {v0, v1, v2, v2, v1, v3});
+        }
+    }
+}
+
+std::vector<std::array<uint32_t, 3>> SortedTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Position, normal and tex coord of the three corners of a triangle
+using TriangleCorners = std::array<float, 24>;
+
+std::vector<TriangleCorners> SortedTriangleCorners(const TriMesh& mesh)
+{
+    std::vector<TriangleCorners> triangles(mesh.GetCountTriangles());
+    for (uint32_t triIndex = 0; triIndex < mesh.GetCountTriangles(); ++triIndex) {
+        uint32_t v[3] = {};
+        EXPECT_EQ(mesh.GetTriangle(triIndex, v[0], v[1], v[2]), ppx::SUCCESS);
+        float* pDst = triangles[triIndex].data();
+        for (uint32_t k = 0; k < 3; ++k) {
+            std::memcpy(pDst + 8 * k + 0, mesh.GetDataPositions(v[k]), 3 * sizeof(float));
+            std::memcpy(pDst + 8 * k + 3, mesh.GetDataNormalls(v[k]), 3 * sizeof(float));
+            std::memcpy(pDst + 8 * k + 6, mesh.GetDataTexCoords2(v[k]), 2 * sizeof(float));
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Expects planar position, normal and tex coord buffers with 32-bit indices
+std::vector<TriangleCorners> SortedTriangleCorners(const Geometry& geometry)
+{
+    const uint32_t* pIndices   = reinterpret_cast<const uint32_t*>(geometry.GetIndexBuffer()->GetData());
+    const uint32_t  offsets[3] = {0, 3, 6};
+
+    std::vector<TriangleCorners> triangles(geometry.GetIndexCount() / 3);
+    for (size_t triIndex = 0; triIndex < triangles.size(); ++triIndex) {
+        float* pDst = triangles[triIndex].data();
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = pIndices[3 * triIndex + k];
+            for (uint32_t b = 0; b < 3; ++b) {
+                const Geometry::Buffer* pBuffer = geometry.GetVertexBuffer(b);
+                std::memcpy(pDst + 8 * k + offsets[b], pBuffer->GetData() + static_cast<size_t>(v) * pBuffer->GetElementSize(), pBuffer->GetElementSize());
+            }
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST(MeshOptimizeTest, AnalyzeVertexCacheCountsMisses)
+{
+    // Two triangles sharing an edge: 4 unique vertices all miss once
+    const uint32_t        kIndices[6] = {0, 1, 2, 2, 1, 3};
+    VertexCacheStatistics stats       = AnalyzeVertexCache(kIndices, 6, 4, 16);
+    EXPECT_EQ(stats.transformCount, 4u);
+    EXPECT_FLOAT_EQ(stats.acmr, 2.0f);
+    EXPECT_FLOAT_EQ(stats.atvr, 1.0f);
+
+    // With a 1 entry cache only the repeated 2 hits
+    stats = AnalyzeVertexCache(kIndices, 6, 4, 1);
+    EXPECT_EQ(stats.transformCount, 5u);
+}
+
+TEST(MeshOptimizeTest, OptimizeVertexCacheKeepsTrianglesAndImprovesAcmr)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float>    positions;
+    MakeGrid(64, indices, positions);
+    const uint32_t indexCount  = static_cast<uint32_t>(indices.size());
+    const uint32_t vertexCount = static_cast<uint32_t>(positions.size() / 3);
+
+    std::vector<uint32_t> optimized(indexCount);
+    OptimizeVertexCache(indices.data(), indexCount, vertexCount, 16, optimized.data());
+
+    EXPECT_EQ(SortedTriangles(indices), SortedTriangles(optimized));
+
+    VertexCacheStatistics before = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, 16);
+    VertexCacheStatistics after  = AnalyzeVertexCache(optimized.data(), indexCount, vertexCount, 16);
+    EXPECT_LT(after.acmr, before.acmr);
+}
+
+TEST(MeshOptimizeTest, PassesCopyIndicesThatArentWholeTriangles)
+{
+    std::vector<float> positions = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0};
+
+    // Less than a triangle
+    const std::vector<uint32_t> kShort = {2, 1};
+    std::vector<uint32_t>       optimized(kShort.size());
+    OptimizeVertexCache(kShort.data(), 2, 4, 16, optimized.data());
+    EXPECT_EQ(optimized, kShort);
+    OptimizeOverdraw(kShort.data(), 2, positions.data(), 4, 3 * sizeof(float), 16, 1.05f, optimized.data());
+    EXPECT_EQ(optimized, kShort);
+
+    // Two triangles and a trailing index
+    const std::vector<uint32_t> kIndices = {0, 1, 2, 2, 1, 3, 3};
+    optimized.assign(kIndices.size(), 0);
+    OptimizeVertexCache(kIndices.data(), 7, 4, 16, optimized.data());
+    EXPECT_EQ(optimized[6], 3u);
+    optimized.assign(kIndices.size(), 0);
+    OptimizeOverdraw(kIndices.data(), 7, positions.data(), 4, 3 * sizeof(float), 16, 1.05f, optimized.data());
+    EXPECT_EQ(optimized[6], 3u);
+}
+
+TEST(MeshOptimizeTest, OptimizeOverdrawIsTrianglePermutation)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float>    positions;
+    MakeGrid(32, indices, positions);
+    const uint32_t indexCount  = static_cast<uint32_t>(indices.size());
+    const uint32_t vertexCount = static_cast<uint32_t>(positions.size() / 3);
+
+    std::vector<uint32_t> cacheOptimized(indexCount);
+    OptimizeVertexCache(indices.data(), indexCount, vertexCount, 16, cacheOptimized.data());
+
+    std::vector<uint32_t> optimized(indexCount);
+    OptimizeOverdraw(cacheOptimized.data(), indexCount, positions.data(), vertexCount, 3 * sizeof(float), 16, 1.05f, optimized.data());
+
+    // Triangles are moved as whole clusters so winding is preserved
+    EXPECT_EQ(SortedTriangles(cacheOptimized), SortedTriangles(optimized));
+}
+
+TEST(MeshOptimizeTest, OptimizeVertexFetchOrdersByFirstUse)
+{
+    // Vertex 1 is unused
+    std::vector<uint32_t> indices = {3, 0, 2, 2, 0, 4};
+    std::vector<uint32_t> remap(5);
+
+    uint32_t usedCount = OptimizeVertexFetch(indices.data(), 6, 5, remap.data());
+    EXPECT_EQ(usedCount, 4u);
+
+    const std::vector<uint32_t> kExpectedIndices = {0, 1, 2, 2, 1, 3};
+    EXPECT_EQ(indices, kExpectedIndices);
+
+    EXPECT_EQ(remap[0], 1u);
+    EXPECT_EQ(remap[1], UINT32_MAX);
+    EXPECT_EQ(remap[2], 2u);
+    EXPECT_EQ(remap[3], 0u);
+    EXPECT_EQ(remap[4], 3u);
+}
+
+TEST(MeshOptimizeTest, OptimizeGeometryRejectsShortVertexBuffers)
+{
+    Geometry geometry;
+    ASSERT_EQ(Geometry::Create(GeometryOptions::PlanarU32().AddNormal(), &geometry), ppx::SUCCESS);
+    for (uint32_t i = 0; i < 3; ++i) {
+        TriMeshVertexData vtx = {};
+        vtx.position          = float3(static_cast<float>(i), static_cast<float>(i % 2), 0.0f);
+        vtx.normal            = float3(0.0f, 0.0f, 1.0f);
+        geometry.AppendVertexData(vtx);
+    }
+    geometry.AppendIndicesTriangle(2, 1, 0);
+
+    // Normals no longer cover every vertex
+    Geometry::Buffer* pNormals = geometry.GetVertexBuffer(1);
+    pNormals->SetSize(2 * pNormals->GetElementSize());
+
+    EXPECT_EQ(OptimizeMesh(&geometry), ppx::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION);
+
+    // Nothing was reordered
+    const uint32_t* pIndices = reinterpret_cast<const uint32_t*>(geometry.GetIndexBuffer()->GetData());
+    EXPECT_EQ(pIndices[0], 2u);
+    EXPECT_EQ(pIndices[2], 0u);
+}
+
+TEST(MeshOptimizeTest, OptimizeTriMeshRejectsOutOfRangeIndices)
+{
+    TriMesh mesh = TriMesh(grfx::INDEX_TYPE_UINT32);
+    mesh.AppendPosition(float3(0.0f, 0.0f, 0.0f));
+    mesh.AppendPosition(float3(1.0f, 0.0f, 0.0f));
+    mesh.AppendPosition(float3(0.0f, 1.0f, 0.0f));
+    mesh.AppendTriangle(0, 1, 2);
+    mesh.AppendTriangle(2, 1, 7);
+
+    EXPECT_EQ(OptimizeMesh(&mesh), ppx::ERROR_OUT_OF_RANGE);
+
+    // Nothing was reordered
+    EXPECT_EQ(mesh.GetCountPositions(), 3u);
+    EXPECT_EQ(*mesh.GetDataIndicesU32(5), 7u);
+}
+
+TEST(MeshOptimizeTest, OptimizeGeometryRejectsOutOfRangeIndices)
+{
+    Geometry geometry;
+    ASSERT_EQ(Geometry::Create(GeometryOptions::PlanarU16(), &geometry), ppx::SUCCESS);
+    for (uint32_t i = 0; i < 3; ++i) {
+        TriMeshVertexData vtx = {};
+        vtx.position          = float3(static_cast<float>(i), static_cast<float>(i % 2), 0.0f);
+        geometry.AppendVertexData(vtx);
+    }
+    geometry.AppendIndicesTriangle(2, 1, 0);
+    geometry.AppendIndicesTriangle(0, 3, 1);
+
+    EXPECT_EQ(OptimizeMesh(&geometry), ppx::ERROR_OUT_OF_RANGE);
+
+    // Nothing was reordered
+    const uint16_t* pIndices = reinterpret_cast<const uint16_t*>(geometry.GetIndexBuffer()->GetData());
+    EXPECT_EQ(pIndices[0], 2u);
+    EXPECT_EQ(pIndices[4], 3u);
+}
+
+TEST(MeshOptimizeTest, OptimizeGeometryRejectsPartialTriangles)
+{
+    Geometry geometry;
+    ASSERT_EQ(Geometry::Create(GeometryOptions::PlanarU32(), &geometry), ppx::SUCCESS);
+    for (uint32_t i = 0; i < 3; ++i) {
+        TriMeshVertexData vtx = {};
+        vtx.position          = float3(static_cast<float>(i), static_cast<float>(i % 2), 0.0f);
+        geometry.AppendVertexData(vtx);
+    }
+    geometry.AppendIndicesTriangle(2, 1, 0);
+    geometry.AppendIndex(1);
+
+    EXPECT_EQ(OptimizeMesh(&geometry), ppx::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION);
+
+    // Nothing was reordered
+    const uint32_t* pIndices = reinterpret_cast<const uint32_t*>(geometry.GetIndexBuffer()->GetData());
+    EXPECT_EQ(geometry.GetIndexCount(), 4u);
+    EXPECT_EQ(pIndices[0], 2u);
+    EXPECT_EQ(pIndices[3], 1u);
+}
+
+TEST(MeshOptimizeTest, OptimizeTriMeshKeepsCornerAttributes)
+{
+    TriMesh mesh = TriMesh::CreateSphere(1, 16, 12, TriMeshOptions().Indices().Normals().TexCoords());
+    // An unreferenced vertex for vertexFetch to drop
+    mesh.AppendPosition(float3(5.0f, 5.0f, 5.0f));
+    mesh.AppendNormal(float3(0.0f, 0.0f, 1.0f));
+    mesh.AppendTexCoord(float2(0.5f, 0.5f));
+
+    const uint32_t                     vertexCount = mesh.GetCountPositions();
+    const std::vector<TriangleCorners> expected    = SortedTriangleCorners(mesh);
+
+    ASSERT_EQ(OptimizeMesh(&mesh), ppx::SUCCESS);
+
+    // Corners keep their order within a triangle so winding is preserved
+    EXPECT_EQ(SortedTriangleCorners(mesh), expected);
+    EXPECT_EQ(mesh.GetCountNormals(), mesh.GetCountPositions());
+    EXPECT_EQ(mesh.GetCountTexCoords(), mesh.GetCountPositions());
+    EXPECT_LT(mesh.GetCountPositions(), vertexCount);
+}
+
+TEST(MeshOptimizeTest, OptimizeGeometryKeepsCornerAttributes)
+{
+    const TriMesh mesh = TriMesh::CreateSphere(1, 16, 12, TriMeshOptions().Indices().Normals().TexCoords());
+
+    Geometry geometry;
+    ASSERT_EQ(Geometry::Create(GeometryOptions::PlanarU32().AddNormal().AddTexCoord(), mesh, &geometry), ppx::SUCCESS);
+    const std::vector<TriangleCorners> expected = SortedTriangleCorners(geometry);
+
+    ASSERT_EQ(OptimizeMesh(&geometry), ppx::SUCCESS);
+
+    EXPECT_EQ(SortedTriangleCorners(geometry), expected);
+    for (uint32_t b = 0; b < geometry.GetVertexBufferCount(); ++b) {
+        EXPECT_EQ(geometry.GetVertexBuffer(b)->GetElementCount(), geometry.GetVertexCount());
+    }
+}
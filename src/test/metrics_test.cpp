@@ -18,8 +18,10 @@
 
 #include "nlohmann/json.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <limits>
+#include <random>
 #include <regex>
 
 #if !defined(NDEBUG)
@@ -522,4 +524,145 @@ TEST_F(MetricsTestFixture, MetricsGaugeIgnoresSameSeconds)
     EXPECT_EQ(gauge["time_series"][1][1], 11.0);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Streaming Gauge Tests
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(MetricsTest, TDigestEmptyReturnsZero)
+{
+    metrics::TDigest digest;
+    EXPECT_EQ(digest.GetCount(), 0u);
+    EXPECT_EQ(digest.Quantile(0.5), 0.0);
+}
+
+TEST(MetricsTest, TDigestSingleValue)
+{
+    metrics::TDigest digest;
+    digest.Add(42.0);
+    EXPECT_EQ(digest.Quantile(0.0), 42.0);
+    EXPECT_EQ(digest.Quantile(0.5), 42.0);
+    EXPECT_EQ(digest.Quantile(1.0), 42.0);
+}
+
+TEST(MetricsTest, TDigestQuantilesMatchSortedValues)
+{
+    std::mt19937                        rng(1234);
+    std::lognormal_distribution<double> distribution(2.8, 0.25); // Frame time like
+    std::vector<double>                 values;
+    metrics::TDigest                    digest;
+    for (int i = 0; i < 200000; ++i) {
+        double value = distribution(rng);
+        values.push_back(value);
+        digest.Add(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    // Compare ranks rather than values, t-digest bounds the rank error
+    for (double q : {0.01, 0.05, 0.10, 0.50, 0.90, 0.95, 0.99}) {
+        double estimate = digest.Quantile(q);
+        double rank     = static_cast<double>(std::lower_bound(values.begin(), values.end(), estimate) - values.begin()) / values.size();
+        EXPECT_NEAR(rank, q, 0.005) << "q = " << q;
+    }
+    EXPECT_EQ(digest.Quantile(0.0), values.front());
+    EXPECT_EQ(digest.Quantile(1.0), values.back());
+
+    // Memory is bounded by the compression, not the value count
+    EXPECT_LT(digest.GetCentroidCount(), 500u);
+}
+
+TEST_F(MetricsTestFixture, MetricsStreamingGaugeMatchesExactGauge)
+{
+    metrics::MetricMetadata exactMetadata;
+    exactMetadata.type = metrics::MetricType::GAUGE;
+    exactMetadata.name = "exact";
+    auto exactId       = pManager->AddMetric(exactMetadata);
+    ASSERT_NE(exactId, metrics::kInvalidMetricID);
+
+    metrics::MetricMetadata streamingMetadata;
+    streamingMetadata.type      = metrics::MetricType::GAUGE;
+    streamingMetadata.name      = "streaming";
+    streamingMetadata.gaugeMode = metrics::GaugeMode::STREAMING;
+    auto streamingId            = pManager->AddMetric(streamingMetadata);
+    ASSERT_NE(streamingId, metrics::kInvalidMetricID);
+
+    std::mt19937                     rng(5678);
+    std::normal_distribution<double> distribution(16.6, 2.0);
+    metrics::MetricData              data = {metrics::MetricType::GAUGE};
+    for (int i = 0; i < 20000; ++i) {
+        data.gauge.seconds = 0.016 * i;
+        data.gauge.value   = distribution(rng);
+        EXPECT_TRUE(pManager->RecordMetricData(exactId, data));
+        EXPECT_TRUE(pManager->RecordMetricData(streamingId, data));
+    }
+
+    auto result    = pManager->CreateReport("report").GetContentString();
+    auto parsed    = nlohmann::json::parse(result);
+    auto exact     = parsed["runs"][0]["gauges"][0]["statistics"];
+    auto streaming = parsed["runs"][0]["gauges"][1]["statistics"];
+
+    EXPECT_EQ(streaming["min"], exact["min"]);
+    EXPECT_EQ(streaming["max"], exact["max"]);
+    EXPECT_EQ(streaming["average"], exact["average"]);
+    EXPECT_EQ(streaming["time_ratio"], exact["time_ratio"]);
+    EXPECT_NEAR(streaming["standard_deviation"].get<double>(), exact["standard_deviation"].get<double>(), 1e-9);
+    for (const char* key : {"median", "percentile_01", "percentile_05", "percentile_10", "percentile_90", "percentile_95", "percentile_99"}) {
+        EXPECT_NEAR(streaming[key].get<double>(), exact[key].get<double>(), 0.05) << key;
+    }
+}
+
+TEST_F(MetricsTestFixture, MetricsStreamingGaugeDownsamplesTimeSeries)
+{
+    metrics::MetricMetadata metadata;
+    metadata.type               = metrics::MetricType::GAUGE;
+    metadata.name               = "gauge";
+    metadata.gaugeMode          = metrics::GaugeMode::STREAMING;
+    metadata.timeSeriesCapacity = 100;
+    auto metricId               = pManager->AddMetric(metadata);
+    ASSERT_NE(metricId, metrics::kInvalidMetricID);
+
+    metrics::MetricData data = {metrics::MetricType::GAUGE};
+    for (int i = 0; i < 10000; ++i) {
+        data.gauge.seconds = 1.0 + i;
+        data.gauge.value   = 5.0;
+        EXPECT_TRUE(pManager->RecordMetricData(metricId, data));
+    }
+
+    auto result     = pManager->CreateReport("report").GetContentString();
+    auto parsed     = nlohmann::json::parse(result);
+    auto timeSeries = parsed["runs"][0]["gauges"][0]["time_series"];
+    EXPECT_LE(timeSeries.size(), 101u);
+    EXPECT_GE(timeSeries.size(), 50u);
+
+    double previousSeconds = 0.0;
+    for (const auto& entry : timeSeries) {
+        EXPECT_GT(entry[0].get<double>(), previousSeconds);
+        EXPECT_EQ(entry[1].get<double>(), 5.0);
+        previousSeconds = entry[0].get<double>();
+    }
+}
+
+TEST_F(MetricsTestFixture, MetricsStreamingGaugeWithoutTimeSeries)
+{
+    metrics::MetricMetadata metadata;
+    metadata.type               = metrics::MetricType::GAUGE;
+    metadata.name               = "gauge";
+    metadata.gaugeMode          = metrics::GaugeMode::STREAMING;
+    metadata.timeSeriesCapacity = 0;
+    auto metricId               = pManager->AddMetric(metadata);
+    ASSERT_NE(metricId, metrics::kInvalidMetricID);
+
+    metrics::MetricData data = {metrics::MetricType::GAUGE};
+    data.gauge.seconds       = 1.0;
+    data.gauge.value         = 3.0;
+    EXPECT_TRUE(pManager->RecordMetricData(metricId, data));
+    data.gauge.seconds = 0.5;
+    EXPECT_FALSE(pManager->RecordMetricData(metricId, data));
+
+    auto result = pManager->CreateReport("report").GetContentString();
+    auto parsed = nlohmann::json::parse(result);
+    auto gauge  = parsed["runs"][0]["gauges"][0];
+    EXPECT_EQ(gauge["time_series"].size(), 0u);
+    EXPECT_EQ(gauge["statistics"]["median"], 3.0);
+}
+
 } // namespace ppx
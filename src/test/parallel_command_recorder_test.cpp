@@ -0,0 +1,95 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_parallel_command_recorder.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+struct Range
+{
+    uint32_t begin;
+    uint32_t end;
+};
+
+std::vector<Range> GetRanges(uint32_t itemCount, uint32_t rangeCount)
+{
+    std::vector<Range> ranges(rangeCount);
+    for (uint32_t i = 0; i < rangeCount; ++i) {
+        grfx::GetParallelRecordRange(itemCount, rangeCount, i, &ranges[i].begin, &ranges[i].end);
+    }
+    return ranges;
+}
+
+} // namespace
+
+TEST(ParallelCommandRecorderTest, RangesSplitEvenly)
+{
+    std::vector<Range> ranges = GetRanges(12, 4);
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(ranges[i].begin, 3 * i);
+        EXPECT_EQ(ranges[i].end, 3 * i + 3);
+    }
+}
+
+TEST(ParallelCommandRecorderTest, RemainderGoesToFirstRanges)
+{
+    // 10 = 3 + 3 + 2 + 2
+    std::vector<Range> ranges = GetRanges(10, 4);
+    EXPECT_EQ(ranges[0].end - ranges[0].begin, 3u);
+    EXPECT_EQ(ranges[1].end - ranges[1].begin, 3u);
+    EXPECT_EQ(ranges[2].end - ranges[2].begin, 2u);
+    EXPECT_EQ(ranges[3].end - ranges[3].begin, 2u);
+}
+
+TEST(ParallelCommandRecorderTest, FewerItemsThanRanges)
+{
+    std::vector<Range> ranges = GetRanges(2, 5);
+    EXPECT_EQ(ranges[0].begin, 0u);
+    EXPECT_EQ(ranges[0].end, 1u);
+    EXPECT_EQ(ranges[1].begin, 1u);
+    EXPECT_EQ(ranges[1].end, 2u);
+    for (uint32_t i = 2; i < 5; ++i) {
+        EXPECT_EQ(ranges[i].begin, 2u);
+        EXPECT_EQ(ranges[i].end, 2u);
+    }
+}
+
+TEST(ParallelCommandRecorderTest, RangesAreContiguousAndCoverAllItems)
+{
+    for (uint32_t itemCount = 0; itemCount < 40; ++itemCount) {
+        for (uint32_t rangeCount = 1; rangeCount < 10; ++rangeCount) {
+            std::vector<Range> ranges = GetRanges(itemCount, rangeCount);
+
+            uint32_t minSize = UINT32_MAX;
+            uint32_t maxSize = 0;
+            uint32_t next    = 0;
+            for (const Range& range : ranges) {
+                EXPECT_EQ(range.begin, next);
+                EXPECT_LE(range.begin, range.end);
+                minSize = std::min(minSize, range.end - range.begin);
+                maxSize = std::max(maxSize, range.end - range.begin);
+                next    = range.end;
+            }
+            EXPECT_EQ(next, itemCount);
+            EXPECT_LE(maxSize - minSize, 1u);
+        }
+    }
+}
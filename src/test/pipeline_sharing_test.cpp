@@ -0,0 +1,194 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+class PipelineSharingTest : public ::testing::TestWithParam<bool>
+{
+protected:
+    PipelineSharingTest()
+        : mDevice(GetParam()) {}
+
+    void SetUp() override
+    {
+        grfx::PipelineInterfaceCreateInfo interfaceCreateInfo = {};
+        ASSERT_EQ(mDevice.CreatePipelineInterface(&interfaceCreateInfo, &mInterface), ppx::SUCCESS);
+
+        grfx::ShaderModuleCreateInfo moduleCreateInfo = {};
+        ASSERT_EQ(mDevice.CreateShaderModule(&moduleCreateInfo, &mVS), ppx::SUCCESS);
+        ASSERT_EQ(mDevice.CreateShaderModule(&moduleCreateInfo, &mPS), ppx::SUCCESS);
+        ASSERT_EQ(mDevice.CreateShaderModule(&moduleCreateInfo, &mCS), ppx::SUCCESS);
+    }
+
+    grfx::GraphicsPipelineCreateInfo GetGraphicsCreateInfo() const
+    {
+        grfx::GraphicsPipelineCreateInfo createInfo   = {};
+        createInfo.VS                                 = {mVS, "vsmain"};
+        createInfo.PS                                 = {mPS, "psmain"};
+        createInfo.rasterState.cullMode               = grfx::CULL_MODE_BACK;
+        createInfo.outputState.renderTargetCount      = 1;
+        createInfo.outputState.renderTargetFormats[0] = grfx::FORMAT_R8G8B8A8_UNORM;
+        createInfo.pPipelineInterface                 = mInterface;
+        return createInfo;
+    }
+
+    grfx::ComputePipelineCreateInfo GetComputeCreateInfo() const
+    {
+        grfx::ComputePipelineCreateInfo createInfo = {};
+        createInfo.CS                              = {mCS, "csmain"};
+        createInfo.pPipelineInterface              = mInterface;
+        return createInfo;
+    }
+
+    bool SharingEnabled() const { return GetParam(); }
+
+    FakeDevice                 mDevice;
+    grfx::PipelineInterfacePtr mInterface;
+    grfx::ShaderModulePtr      mVS;
+    grfx::ShaderModulePtr      mPS;
+    grfx::ShaderModulePtr      mCS;
+};
+
+} // namespace
+
+TEST_P(PipelineSharingTest, EqualCreateInfosShareAPipeline)
+{
+    const grfx::GraphicsPipelineCreateInfo createInfo = GetGraphicsCreateInfo();
+
+    grfx::GraphicsPipelinePtr first;
+    grfx::GraphicsPipelinePtr second;
+    ASSERT_EQ(mDevice.CreateGraphicsPipeline(&createInfo, &first), ppx::SUCCESS);
+    ASSERT_EQ(mDevice.CreateGraphicsPipeline(&createInfo, &second), ppx::SUCCESS);
+
+    const grfx::PipelineCacheStats stats = mDevice.GetPipelineCacheStats();
+    if (SharingEnabled()) {
+        EXPECT_EQ(first.Get(), second.Get());
+        EXPECT_EQ(FakeGraphicsPipeline::GetLiveCount(), 1u);
+        EXPECT_EQ(stats.hitCount, 1u);
+        EXPECT_EQ(stats.missCount, 1u);
+    }
+    else {
+        EXPECT_NE(first.Get(), second.Get());
+        EXPECT_EQ(FakeGraphicsPipeline::GetLiveCount(), 2u);
+        EXPECT_EQ(stats.hitCount, 0u);
+        EXPECT_EQ(stats.missCount, 0u);
+    }
+
+    mDevice.DestroyGraphicsPipeline(first);
+    mDevice.DestroyGraphicsPipeline(second);
+    EXPECT_EQ(FakeGraphicsPipeline::GetLiveCount(), 0u);
+}
+
+TEST_P(PipelineSharingTest, UnequalCreateInfosDontShare)
+{
+    const grfx::GraphicsPipelineCreateInfo createInfo = GetGraphicsCreateInfo();
+
+    grfx::GraphicsPipelineCreateInfo otherState = createInfo;
+    otherState.rasterState.cullMode             = grfx::CULL_MODE_FRONT;
+
+    grfx::GraphicsPipelineCreateInfo otherEntryPoint = createInfo;
+    otherEntryPoint.PS.entryPoint                    = "psmain2";
+
+    grfx::GraphicsPipelineCreateInfo otherFormat    = createInfo;
+    otherFormat.outputState.renderTargetFormats[0] = grfx::FORMAT_B8G8R8A8_UNORM;
+
+    grfx::GraphicsPipelinePtr pipeline;
+    ASSERT_EQ(mDevice.CreateGraphicsPipeline(&createInfo, &pipeline), ppx::SUCCESS);
+    for (const grfx::GraphicsPipelineCreateInfo* pOther : {&otherState, &otherEntryPoint, &otherFormat}) {
+        grfx::GraphicsPipelinePtr other;
+        ASSERT_EQ(mDevice.CreateGraphicsPipeline(pOther, &other), ppx::SUCCESS);
+        EXPECT_NE(pipeline.Get(), other.Get());
+        mDevice.DestroyGraphicsPipeline(other);
+    }
+    EXPECT_EQ(mDevice.GetPipelineCacheStats().hitCount, 0u);
+
+    mDevice.DestroyGraphicsPipeline(pipeline);
+    EXPECT_EQ(FakeGraphicsPipeline::GetLiveCount(), 0u);
+}
+
+TEST_P(PipelineSharingTest, RecreatedShaderModuleDoesntMatch)
+{
+    grfx::GraphicsPipelineCreateInfo createInfo = GetGraphicsCreateInfo();
+
+    grfx::GraphicsPipelinePtr pipeline;
+    ASSERT_EQ(mDevice.CreateGraphicsPipeline(&createInfo, &pipeline), ppx::SUCCESS);
+
+    // The new module can land at the old one's address, the key must still
+    // tell them apart
+    mDevice.DestroyShaderModule(mPS);
+    grfx::ShaderModuleCreateInfo moduleCreateInfo = {};
+    ASSERT_EQ(mDevice.CreateShaderModule(&moduleCreateInfo, &mPS), ppx::SUCCESS);
+    createInfo.PS.pModule = mPS;
+
+    grfx::GraphicsPipelinePtr other;
+    ASSERT_EQ(mDevice.CreateGraphicsPipeline(&createInfo, &other), ppx::SUCCESS);
+    EXPECT_NE(pipeline.Get(), other.Get());
+    EXPECT_EQ(mDevice.GetPipelineCacheStats().hitCount, 0u);
+
+    mDevice.DestroyGraphicsPipeline(pipeline);
+    mDevice.DestroyGraphicsPipeline(other);
+}
+
+TEST_P(PipelineSharingTest, DestroyReleasesOneReference)
+{
+    const grfx::ComputePipelineCreateInfo createInfo = GetComputeCreateInfo();
+
+    grfx::ComputePipelinePtr first;
+    grfx::ComputePipelinePtr second;
+    ASSERT_EQ(mDevice.CreateComputePipeline(&createInfo, &first), ppx::SUCCESS);
+    ASSERT_EQ(mDevice.CreateComputePipeline(&createInfo, &second), ppx::SUCCESS);
+
+    // A shared pipeline stays alive, and stays shared, until every
+    // creation has been matched by a destroy
+    mDevice.DestroyComputePipeline(first);
+    EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 1u);
+
+    grfx::ComputePipelinePtr third;
+    ASSERT_EQ(mDevice.CreateComputePipeline(&createInfo, &third), ppx::SUCCESS);
+    if (SharingEnabled()) {
+        EXPECT_EQ(third.Get(), second.Get());
+        EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 1u);
+    }
+    else {
+        EXPECT_NE(third.Get(), second.Get());
+        EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 2u);
+    }
+
+    mDevice.DestroyComputePipeline(second);
+    EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 1u);
+    mDevice.DestroyComputePipeline(third);
+    EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 0u);
+
+    // Once the last reference is gone the next creation starts over
+    grfx::ComputePipelinePtr fourth;
+    ASSERT_EQ(mDevice.CreateComputePipeline(&createInfo, &fourth), ppx::SUCCESS);
+    EXPECT_EQ(FakeComputePipeline::GetLiveCount(), 1u);
+    if (SharingEnabled()) {
+        EXPECT_EQ(mDevice.GetPipelineCacheStats().missCount, 2u);
+    }
+    mDevice.DestroyComputePipeline(fourth);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SharePipelines,
+    PipelineSharingTest,
+    ::testing::Bool(),
+    [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "Shared" : "NotShared"; });
@@ -15,8 +15,11 @@
 #include "gtest/gtest.h"
 
 #include "ppx/ppm_export.h"
+#include "ppx/bitmap.h"
 
+#include <cstring>
 #include <optional>
+#include <random>
 #include <sstream>
 
 class PPMData
@@ -58,6 +61,135 @@ private:
     }
 };
 
+// Minimal QOI decoder, enough to check what ExportToQOI writes.
+class QOIData
+{
+public:
+    static std::optional<QOIData> FromString(const std::string& bytes)
+    {
+        const uint8_t* p    = reinterpret_cast<const uint8_t*>(bytes.data());
+        const size_t   size = bytes.size();
+        if (size < 22 || std::memcmp(p, "qoif", 4) != 0) {
+            return std::nullopt;
+        }
+        const uint32_t width    = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+        const uint32_t height   = (p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11];
+        const uint32_t channels = p[12];
+
+        std::vector<unsigned char> texels;
+        uint8_t                    index[64][4] = {};
+        uint8_t                    px[4]        = {0, 0, 0, 255};
+        size_t                     pos          = 14;
+        uint32_t                   run          = 0;
+        const size_t               end          = size - 8;
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+            if (run > 0) {
+                --run;
+            }
+            else {
+                if (pos >= end) {
+                    return std::nullopt;
+                }
+                const uint8_t b1 = p[pos++];
+                if (b1 == 0xFE) {
+                    px[0] = p[pos++];
+                    px[1] = p[pos++];
+                    px[2] = p[pos++];
+                }
+                else if (b1 == 0xFF) {
+                    px[0] = p[pos++];
+                    px[1] = p[pos++];
+                    px[2] = p[pos++];
+                    px[3] = p[pos++];
+                }
+                else if ((b1 & 0xC0) == 0x00) {
+                    std::memcpy(px, index[b1], 4);
+                }
+                else if ((b1 & 0xC0) == 0x40) {
+                    px[0] += ((b1 >> 4) & 3) - 2;
+                    px[1] += ((b1 >> 2) & 3) - 2;
+                    px[2] += (b1 & 3) - 2;
+                }
+                else if ((b1 & 0xC0) == 0x80) {
+                    const uint8_t b2 = p[pos++];
+                    const int     dg = (b1 & 0x3F) - 32;
+                    px[0] += dg - 8 + ((b2 >> 4) & 0x0F);
+                    px[1] += dg;
+                    px[2] += dg - 8 + (b2 & 0x0F);
+                }
+                else {
+                    run = b1 & 0x3F;
+                }
+                std::memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+            }
+            texels.insert(texels.end(), px, px + 3);
+        }
+
+        const uint8_t endMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        if (pos != end || std::memcmp(p + end, endMarker, 8) != 0) {
+            return std::nullopt;
+        }
+        return QOIData(width, height, channels, texels);
+    }
+
+    const uint32_t                   width    = 0;
+    const uint32_t                   height   = 0;
+    const uint32_t                   channels = 0;
+    const std::vector<unsigned char> texels;
+
+private:
+    QOIData(uint32_t width, uint32_t height, uint32_t channels, const std::vector<unsigned char>& texels)
+        : width(width), height(height), channels(channels), texels(texels)
+    {
+    }
+};
+
+// BGRA8 image large enough to be converted and encoded in parallel bands,
+// with flat areas, gradients and noise so every QOI op and deflate
+// matches get used. Rows are padded to rowStride.
+struct TestImage
+{
+    static constexpr uint32_t kWidth     = 301;
+    static constexpr uint32_t kHeight    = 259;
+    static constexpr uint32_t kRowStride = kWidth * 4 + 12;
+
+    TestImage()
+        : bgra(kRowStride * kHeight, 0xCD), rgb(kWidth * kHeight * 3)
+    {
+        std::mt19937 rng(1234);
+        for (uint32_t y = 0; y < kHeight; ++y) {
+            for (uint32_t x = 0; x < kWidth; ++x) {
+                uint8_t r = 10;
+                uint8_t g = 200;
+                uint8_t b = 30;
+                if (y >= 2 * kHeight / 3) {
+                    r = static_cast<uint8_t>(rng());
+                    g = static_cast<uint8_t>(rng());
+                    b = static_cast<uint8_t>(rng());
+                }
+                else if (y >= kHeight / 3) {
+                    r = static_cast<uint8_t>(x);
+                    g = static_cast<uint8_t>(y);
+                    b = static_cast<uint8_t>(x + y);
+                }
+                uint8_t* dst = &bgra[y * kRowStride + x * 4];
+                dst[0]       = b;
+                dst[1]       = g;
+                dst[2]       = r;
+                dst[3]       = 255;
+
+                uint8_t* expected = &rgb[(y * kWidth + x) * 3];
+                expected[0]       = r;
+                expected[1]       = g;
+                expected[2]       = b;
+            }
+        }
+    }
+
+    std::vector<unsigned char> bgra;
+    std::vector<unsigned char> rgb;
+};
+
 namespace ppx {
 
 TEST(PPMExport, ExportRGB_UINT)
@@ -234,6 +366,170 @@ TEST(PPMExport, RowStrideLargerThanRowBytes)
     EXPECT_EQ(data->texels, wantTexels);
 }
 
+TEST(PPMExport, ExportBGRA_UNORM)
+{
+    // Wide enough to go through the vector, word and single texel loops
+    const uint32_t             width = 23;
+    std::vector<unsigned char> texels;
+    std::vector<unsigned char> wantTexels;
+    for (uint32_t y = 0; y < 2; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            unsigned char b = static_cast<unsigned char>(x * 3 + y);
+            unsigned char g = static_cast<unsigned char>(x * 5 + 100);
+            unsigned char r = static_cast<unsigned char>(255 - x);
+            texels.insert(texels.end(), {b, g, r, 7});
+            wantTexels.insert(wantTexels.end(), {r, g, b});
+        }
+    }
+
+    std::stringstream buffer(std::stringstream::out | std::stringstream::in | std::ios::binary);
+    Result            res = ExportToPPM(buffer, grfx::FORMAT_B8G8R8A8_UNORM, texels.data(), width, 2, width * 4);
+    EXPECT_EQ(res, 0);
+
+    auto data = PPMData::FromStream(std::move(buffer));
+    ASSERT_TRUE(data.has_value());
+
+    EXPECT_EQ(data->width, width);
+    EXPECT_EQ(data->height, 2);
+    EXPECT_EQ(data->texels, wantTexels);
+}
+
+TEST(PPMExport, ExportRGB10A2_UNORM)
+{
+    // Red in the low bits, alpha in the top two bits
+    auto pack = [](uint32_t r, uint32_t g, uint32_t b, uint32_t a) { return r | (g << 10) | (b << 20) | (a << 30); };
+
+    std::stringstream     buffer(std::stringstream::out | std::stringstream::in | std::ios::binary);
+    std::vector<uint32_t> texels = {pack(0, 1023, 512, 3), pack(1023, 0, 2, 0), pack(4, 511, 1020, 1), 0x000003FF};
+    Result                res    = ExportToPPM(buffer, grfx::FORMAT_R10G10B10A2_UNORM, texels.data(), 4, 1, 16);
+    EXPECT_EQ(res, 0);
+
+    auto data = PPMData::FromStream(std::move(buffer));
+    ASSERT_TRUE(data.has_value());
+
+    // The last texel only sets bits 0..9 and must come out pure red
+    std::vector<unsigned char> wantTexels = {0, 255, 128, 255, 0, 0, 1, 127, 254, 255, 0, 0};
+    EXPECT_EQ(data->texels, wantTexels);
+}
+
+TEST(PPMExport, ExportRGBA16_FLOAT)
+{
+    // 0, 0.5, 1, 2, -1, NaN, 0.25, +inf and a tiny denormal
+    std::stringstream     buffer(std::stringstream::out | std::stringstream::in | std::ios::binary);
+    std::vector<uint16_t> texels = {0x0000, 0x3800, 0x3C00, 0x3C00, 0x4000, 0xBC00, 0x7E00, 0x0000, 0x3400, 0x7C00, 0x0001, 0x3C00};
+    Result                res    = ExportToPPM(buffer, grfx::FORMAT_R16G16B16A16_FLOAT, texels.data(), 3, 1, 24);
+    EXPECT_EQ(res, 0);
+
+    auto data = PPMData::FromStream(std::move(buffer));
+    ASSERT_TRUE(data.has_value());
+
+    std::vector<unsigned char> wantTexels = {0, 128, 255, 255, 0, 0, 64, 255, 0};
+    EXPECT_EQ(data->texels, wantTexels);
+}
+
+TEST(PPMExport, ExportRG16_FLOAT)
+{
+    std::stringstream     buffer(std::stringstream::out | std::stringstream::in | std::ios::binary);
+    std::vector<uint16_t> texels = {0x3C00, 0x3800};
+    Result                res    = ExportToPPM(buffer, grfx::FORMAT_R16G16_FLOAT, texels.data(), 1, 1, 4);
+    EXPECT_EQ(res, 0);
+
+    auto data = PPMData::FromStream(std::move(buffer));
+    ASSERT_TRUE(data.has_value());
+
+    std::vector<unsigned char> wantTexels = {255, 128, 0};
+    EXPECT_EQ(data->texels, wantTexels);
+}
+
+TEST(PPMExport, ExportLargeImage)
+{
+    TestImage         image;
+    std::stringstream buffer(std::stringstream::out | std::stringstream::in | std::ios::binary);
+    Result            res = ExportToPPM(buffer, grfx::FORMAT_B8G8R8A8_UNORM, image.bgra.data(), TestImage::kWidth, TestImage::kHeight, TestImage::kRowStride);
+    EXPECT_EQ(res, 0);
+
+    auto data = PPMData::FromStream(std::move(buffer));
+    ASSERT_TRUE(data.has_value());
+
+    EXPECT_EQ(data->width, TestImage::kWidth);
+    EXPECT_EQ(data->height, TestImage::kHeight);
+    EXPECT_EQ(data->texels, image.rgb);
+}
+
+TEST(PPMExport, ConvertToRGB8)
+{
+    TestImage            image;
+    std::vector<uint8_t> rgb;
+    Result               res = ConvertToRGB8(grfx::FORMAT_B8G8R8A8_UNORM, image.bgra.data(), TestImage::kWidth, TestImage::kHeight, TestImage::kRowStride, &rgb);
+    EXPECT_EQ(res, 0);
+    EXPECT_EQ(rgb, image.rgb);
+}
+
+TEST(QOIExport, SmallImage)
+{
+    // Runs, repeats that hit the index, small and large differences
+    std::vector<unsigned char> texels = {
+        0, 0, 0, 0, 0, 0, 10, 20, 30, 11, 19, 30, 20, 30, 40,
+        10, 20, 30, 10, 20, 30, 200, 100, 0, 0, 0, 0, 1, 2, 3};
+    std::stringstream buffer(std::ios::out | std::ios::binary);
+    Result            res = ExportToQOI(buffer, grfx::FORMAT_R8G8B8_UNORM, texels.data(), 5, 2, 15);
+    EXPECT_EQ(res, 0);
+
+    auto data = QOIData::FromString(buffer.str());
+    ASSERT_TRUE(data.has_value());
+
+    EXPECT_EQ(data->width, 5);
+    EXPECT_EQ(data->height, 2);
+    EXPECT_EQ(data->channels, 3);
+    EXPECT_EQ(data->texels, texels);
+}
+
+TEST(QOIExport, LargeImage)
+{
+    TestImage         image;
+    std::stringstream buffer(std::ios::out | std::ios::binary);
+    Result            res = ExportToQOI(buffer, grfx::FORMAT_B8G8R8A8_UNORM, image.bgra.data(), TestImage::kWidth, TestImage::kHeight, TestImage::kRowStride);
+    EXPECT_EQ(res, 0);
+
+    auto data = QOIData::FromString(buffer.str());
+    ASSERT_TRUE(data.has_value());
+
+    EXPECT_EQ(data->width, TestImage::kWidth);
+    EXPECT_EQ(data->height, TestImage::kHeight);
+    EXPECT_EQ(data->texels, image.rgb);
+}
+
+TEST(QOIExport, UnsupportedFormat)
+{
+    std::stringstream buffer(std::ios::out | std::ios::binary);
+    const float       texels[] = {0, 1, 2, 3};
+    Result            res      = ExportToQOI(buffer, grfx::FORMAT_R32G32B32A32_FLOAT, texels, 1, 1, 16);
+    EXPECT_EQ(res, ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED);
+}
+
+TEST(PNGExport, LargeImage)
+{
+    TestImage         image;
+    std::stringstream buffer(std::ios::out | std::ios::binary);
+    Result            res = ExportToPNG(buffer, grfx::FORMAT_B8G8R8A8_UNORM, image.bgra.data(), TestImage::kWidth, TestImage::kHeight, TestImage::kRowStride);
+    EXPECT_EQ(res, 0);
+
+    const std::string png = buffer.str();
+    Bitmap            bitmap;
+    ASSERT_EQ(Bitmap::LoadFromMemory(png.size(), png.data(), &bitmap), SUCCESS);
+    ASSERT_EQ(bitmap.GetWidth(), TestImage::kWidth);
+    ASSERT_EQ(bitmap.GetHeight(), TestImage::kHeight);
+
+    std::vector<unsigned char> texels;
+    for (uint32_t y = 0; y < bitmap.GetHeight(); ++y) {
+        for (uint32_t x = 0; x < bitmap.GetWidth(); ++x) {
+            const uint8_t* px = bitmap.GetPixel8u(x, y);
+            texels.insert(texels.end(), px, px + 3);
+        }
+    }
+    EXPECT_EQ(texels, image.rgb);
+}
+
 // Errors and unsupported formats.
 TEST(PPMExport, InvalidSize)
 {
@@ -274,7 +570,7 @@ TEST(PPMExport, PackedFormatsNotSupported)
 {
     std::stringstream buffer(std::ios::binary);
     const int16_t     texels[] = {0, 1, 2, 3};
-    Result            res      = ExportToPPM(buffer, grfx::FORMAT_R10G10B10A2_UNORM, texels, 1, 1, 4);
+    Result            res      = ExportToPPM(buffer, grfx::FORMAT_R11G11B10_FLOAT, texels, 1, 1, 4);
     EXPECT_EQ(res, ERROR_PPM_EXPORT_FORMAT_NOT_SUPPORTED);
 }
 
@@ -0,0 +1,294 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/profiler.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace ppx;
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream     is(path);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+}
+
+size_t CountOccurrences(const std::string& haystack, const std::string& needle)
+{
+    size_t count = 0;
+    for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(ProfilerSampleRingTest, CapacityIsRoundedUpToPowerOfTwo)
+{
+    ProfilerSampleRing ring(100);
+    EXPECT_EQ(ring.GetCapacity(), 128u);
+}
+
+TEST(ProfilerSampleRingTest, DrainReturnsPushedEntriesInOrder)
+{
+    ProfilerSampleRing ring(8);
+    for (uint64_t i = 0; i < 5; ++i) {
+        EXPECT_TRUE(ring.Push(i, {i, i + 1}));
+    }
+
+    std::vector<ProfilerEventToken> tokens;
+    size_t                          count = ring.Drain([&tokens](const ProfilerSampleRing::Entry& entry) { tokens.push_back(entry.token); });
+    EXPECT_EQ(count, 5u);
+    EXPECT_EQ(tokens, (std::vector<ProfilerEventToken>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(ring.Drain([](const ProfilerSampleRing::Entry&) {}), 0u);
+}
+
+TEST(ProfilerSampleRingTest, FullRingDropsSamples)
+{
+    ProfilerSampleRing ring(4);
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.Push(i, {0, 0}));
+    }
+    EXPECT_FALSE(ring.Push(4, {0, 0}));
+    EXPECT_EQ(ring.GetDroppedCount(), 1u);
+
+    ring.Drain([](const ProfilerSampleRing::Entry&) {});
+    EXPECT_TRUE(ring.Push(5, {0, 0}));
+}
+
+TEST(ProfilerSampleRingTest, ConcurrentProducerAndConsumer)
+{
+    const uint64_t     kCount = 20000;
+    ProfilerSampleRing ring(256);
+
+    std::thread producer([&ring, kCount]() {
+        for (uint64_t i = 0; i < kCount; ++i) {
+            while (!ring.Push(i, {i, i})) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    bool     ordered  = true;
+    while (expected < kCount) {
+        ring.Drain([&expected, &ordered](const ProfilerSampleRing::Entry& entry) {
+            ordered = ordered && (entry.token == expected) && (entry.sample.startTimestamp == expected);
+            ++expected;
+        });
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(expected, kCount);
+}
+
+TEST(ProfilerTest, RecordSampleUpdatesRegisteredEvent)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Record", &token), ppx::SUCCESS);
+
+    Profiler* pProfiler = Profiler::GetProfilerForThread();
+    ASSERT_NE(pProfiler, nullptr);
+    pProfiler->RecordSample(token, {10, 15});
+    pProfiler->RecordSample(token, {20, 40});
+    pProfiler->RecordSample(token + 1, {0, 100}); // Unregistered tokens are ignored
+
+    ASSERT_EQ(pProfiler->GetEvents().size(), 1u);
+    const ProfilerEvent& event = pProfiler->GetEvents()[0];
+    EXPECT_EQ(event.GetSampleCount(), 2u);
+    EXPECT_EQ(event.GetSampleTotal(), 25u);
+    EXPECT_EQ(event.GetSampleMin(), 5u);
+    EXPECT_EQ(event.GetSampleMax(), 20u);
+}
+
+TEST(ProfilerTest, RegisterCpuEventReturnsExistingToken)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken first  = 0;
+    ProfilerEventToken second = 0;
+    EXPECT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Twice", &first), ppx::SUCCESS);
+    EXPECT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Twice", &second), ppx::SUCCESS);
+    EXPECT_EQ(first, second);
+
+    ProfilerEventToken third = 0;
+    EXPECT_EQ(Profiler::RegisterEvent(PROFILER_EVENT_TYPE_CPU, "ProfilerTest::Twice", PROFILER_EVENT_RECORD_ACTION_AVERAGE, &third), ppx::ERROR_DUPLICATE_ELEMENT);
+}
+
+TEST(ProfilerTest, EventsAreRegisteredForNewThreads)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Thread", &token), ppx::SUCCESS);
+
+    uint64_t sampleCount = 0;
+    std::thread([token, &sampleCount]() {
+        Profiler* pProfiler = Profiler::GetProfilerForThread();
+        pProfiler->RecordSample(token, {0, 1});
+        sampleCount = pProfiler->GetEvents()[0].GetSampleCount();
+    }).join();
+
+    EXPECT_EQ(sampleCount, 1u);
+}
+
+TEST(ProfilerTest, ExitedThreadProfilersAreReused)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Reuse", &token), ppx::SUCCESS);
+
+    Profiler* pFirst = nullptr;
+    std::thread([token, &pFirst]() {
+        pFirst = Profiler::GetProfilerForThread();
+        pFirst->RecordSample(token, {0, 1});
+    }).join();
+
+    Profiler* pSecond     = nullptr;
+    uint64_t  sampleCount = 1;
+    std::thread([&pSecond, &sampleCount]() {
+        pSecond     = Profiler::GetProfilerForThread();
+        sampleCount = pSecond->GetEvents()[0].GetSampleCount();
+    }).join();
+
+    EXPECT_EQ(pFirst, pSecond);
+    EXPECT_EQ(sampleCount, 0u);
+}
+
+TEST(ProfilerTest, EventsCanBeRegisteredWhileRecording)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Concurrent", &token), ppx::SUCCESS);
+
+    std::atomic<bool> started{false};
+    std::atomic<bool> done{false};
+    uint64_t          recordCount = 0;
+    uint64_t          sampleCount = 0;
+    std::thread       recorder([token, &started, &done, &recordCount, &sampleCount]() {
+        Profiler* pProfiler = Profiler::GetProfilerForThread();
+        started.store(true);
+        while (!done.load()) {
+            pProfiler->RecordSample(token, {0, 1});
+            ++recordCount;
+        }
+        sampleCount = pProfiler->GetEvents()[0].GetSampleCount();
+    });
+    while (!started.load()) {
+        std::this_thread::yield();
+    }
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        ProfilerEventToken other = 0;
+        ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Concurrent" + std::to_string(i), &other), ppx::SUCCESS);
+    }
+    done.store(true);
+    recorder.join();
+
+    EXPECT_EQ(sampleCount, recordCount);
+}
+
+TEST(ProfilerTest, RegisteringTooManyEventsFails)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    for (uint32_t i = 0; i < Profiler::kMaxEventCount; ++i) {
+        ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Limit" + std::to_string(i), &token), ppx::SUCCESS);
+    }
+    EXPECT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Limit", &token), ppx::ERROR_LIMIT_EXCEEDED);
+    EXPECT_EQ(Profiler::GetProfilerForThread()->GetEvents().size(), Profiler::kMaxEventCount);
+
+    Profiler::ReinitializeGlobalVariables();
+}
+
+TEST(ProfilerTest, InsertSamplesAreBounded)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterEvent(PROFILER_EVENT_TYPE_CPU, "ProfilerTest::Insert", PROFILER_EVENT_RECORD_ACTION_INSERT, &token), ppx::SUCCESS);
+
+    Profiler* pProfiler = Profiler::GetProfilerForThread();
+    for (uint64_t i = 0; i < ProfilerEvent::kMaxInsertSamples + 10; ++i) {
+        pProfiler->RecordSample(token, {i, i + 1});
+    }
+
+    std::vector<ProfilerEventSample> samples = pProfiler->GetEvents()[0].GetSamples();
+    ASSERT_EQ(samples.size(), ProfilerEvent::kMaxInsertSamples);
+    EXPECT_EQ(samples.front().startTimestamp, 10u);
+    EXPECT_EQ(samples.back().startTimestamp, ProfilerEvent::kMaxInsertSamples + 9);
+}
+
+TEST(ProfilerTest, TraceWritesChromeTraceEvents)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::Trace", &token), ppx::SUCCESS);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ppx_profiler_test_trace.json";
+    ASSERT_EQ(Profiler::StartTrace(path), ppx::SUCCESS);
+    EXPECT_TRUE(Profiler::IsTracing());
+    for (int i = 0; i < 3; ++i) {
+        ProfilerScopedEventSample sample(token);
+    }
+    Profiler::StopTrace();
+    EXPECT_FALSE(Profiler::IsTracing());
+
+    std::string trace = ReadFile(path);
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(CountOccurrences(trace, "\"name\":\"ProfilerTest::Trace\""), 3u);
+    EXPECT_NE(trace.find("\"droppedSamples\":0"), std::string::npos);
+
+    std::filesystem::remove(path);
+}
+
+TEST(ProfilerTest, TraceKeepsSamplesOfExitedThreads)
+{
+    Profiler::ReinitializeGlobalVariables();
+
+    ProfilerEventToken token = 0;
+    ASSERT_EQ(Profiler::RegisterCpuEvent("ProfilerTest::ExitedThread", &token), ppx::SUCCESS);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ppx_profiler_test_exited_thread.json";
+    ASSERT_EQ(Profiler::StartTrace(path), ppx::SUCCESS);
+    for (int i = 0; i < 2; ++i) {
+        std::thread([token]() {
+            ProfilerScopedEventSample sample(token);
+        }).join();
+    }
+    Profiler::StopTrace();
+
+    std::string trace = ReadFile(path);
+    EXPECT_EQ(CountOccurrences(trace, "\"name\":\"ProfilerTest::ExitedThread\""), 2u);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,295 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/render_graph.h"
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+grfx::ImageCreateInfo ColorTarget(uint32_t width, uint32_t height)
+{
+    grfx::ImageCreateInfo createInfo = {};
+    createInfo.width                 = width;
+    createInfo.height                = height;
+    createInfo.depth                 = 1;
+    createInfo.format                = grfx::FORMAT_R8G8B8A8_UNORM;
+    return createInfo;
+}
+
+grfx::BufferCreateInfo StorageBuffer(uint64_t size)
+{
+    grfx::BufferCreateInfo createInfo           = {};
+    createInfo.size                             = size;
+    createInfo.usageFlags.bits.rawStorageBuffer = true;
+    return createInfo;
+}
+
+// Barriers of a pass as "resource:before>after" from the exported graph
+std::vector<std::string> GetBarriers(const nlohmann::json& barriers)
+{
+    std::vector<std::string> result;
+    for (const auto& barrier : barriers) {
+        result.push_back(barrier["resource"].get<std::string>() + ":" + barrier["before"].get<std::string>() + ">" + barrier["after"].get<std::string>());
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(RenderGraphTest, CullsPassesThatDontReachAnOutput)
+{
+    RenderGraph           graph;
+    RenderGraphResourceID output = graph.CreateBuffer("output", StorageBuffer(256));
+    RenderGraphResourceID unused = graph.CreateImage("unused", ColorTarget(64, 64));
+    RenderGraphResourceID used   = graph.CreateImage("used", ColorTarget(64, 64));
+
+    graph.AddPass("unused", nullptr).AddRenderTarget(unused, true);
+    graph.AddPass("producer", nullptr).AddRenderTarget(used, true);
+    graph.AddPass("consumer", nullptr).Read(used).Write(output).SetSideEffects();
+    graph.AddPass("dead", nullptr).Read(used).Write(output);
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    EXPECT_TRUE(graph.IsPassCulled(0));
+    EXPECT_FALSE(graph.IsPassCulled(1));
+    EXPECT_FALSE(graph.IsPassCulled(2));
+    EXPECT_TRUE(graph.IsPassCulled(3));
+    EXPECT_EQ(graph.GetStats().culledPassCount, 2u);
+
+    // Culled passes don't keep their resources alive
+    EXPECT_EQ(graph.GetPhysicalResourceIndex(unused), UINT32_MAX);
+    EXPECT_NE(graph.GetPhysicalResourceIndex(used), UINT32_MAX);
+}
+
+TEST(RenderGraphTest, ImportedResourcesAreOutputs)
+{
+    RenderGraph           graph;
+    FakeImage             backBuffer;
+    RenderGraphResourceID scene   = graph.CreateImage("scene", ColorTarget(64, 64));
+    RenderGraphResourceID present = graph.ImportImage("back_buffer", &backBuffer, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_PRESENT);
+
+    graph.AddPass("scene", nullptr).AddRenderTarget(scene, true);
+    graph.AddPass("composite", nullptr).Read(scene, grfx::RESOURCE_STATE_PIXEL_SHADER_RESOURCE).AddRenderTarget(present);
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    EXPECT_EQ(graph.GetStats().culledPassCount, 0u);
+
+    // Imported images are handed back in their final state, transient
+    // ones in the state they're created in
+    const nlohmann::json exported = graph.Export();
+    EXPECT_TRUE(exported["passes"][0]["barriers"].empty());
+    EXPECT_EQ(
+        GetBarriers(exported["passes"][1]["barriers"]),
+        (std::vector<std::string>{"scene:RENDER_TARGET>PIXEL_SHADER_RESOURCE", "back_buffer:PRESENT>RENDER_TARGET"}));
+    EXPECT_EQ(
+        GetBarriers(exported["final_barriers"]),
+        (std::vector<std::string>{"scene:PIXEL_SHADER_RESOURCE>RENDER_TARGET", "back_buffer:RENDER_TARGET>PRESENT"}));
+    EXPECT_EQ(graph.GetStats().barrierCount, 4u);
+}
+
+TEST(RenderGraphTest, ImportedResourcesCanBeRebound)
+{
+    RenderGraph           graph;
+    FakeImage             backBuffer0(ColorTarget(64, 64));
+    FakeImage             backBuffer1(ColorTarget(64, 64));
+    RenderGraphResourceID scene   = graph.CreateImage("scene", ColorTarget(64, 64));
+    RenderGraphResourceID present = graph.ImportImage("back_buffer", &backBuffer0, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_PRESENT);
+
+    graph.AddPass("scene", nullptr).AddRenderTarget(scene, true);
+    graph.AddPass("composite", nullptr).Read(scene, grfx::RESOURCE_STATE_PIXEL_SHADER_RESOURCE).AddRenderTarget(present);
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+
+    // Rebinding keeps the compiled graph
+    ASSERT_EQ(graph.SetImportedImage(present, &backBuffer1), ppx::SUCCESS);
+    EXPECT_TRUE(graph.IsCompiled());
+    EXPECT_EQ(graph.GetImage(present), &backBuffer1);
+
+    // The description must match the image it was imported with
+    FakeImage smallBackBuffer(ColorTarget(32, 32));
+    EXPECT_EQ(graph.SetImportedImage(present, &smallBackBuffer), ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE);
+    EXPECT_EQ(graph.GetImage(present), &backBuffer1);
+
+    // Only imported resources can be rebound
+    EXPECT_EQ(graph.SetImportedImage(scene, &backBuffer0), ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE);
+    FakeBuffer buffer;
+    EXPECT_EQ(graph.SetImportedBuffer(present, &buffer), ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE);
+}
+
+TEST(RenderGraphTest, UnorderedAccessWritesNeedBarriers)
+{
+    RenderGraph           graph;
+    RenderGraphResourceID buffer = graph.CreateBuffer("particles", StorageBuffer(1024));
+
+    graph.AddPass("simulate", nullptr).Write(buffer);
+    graph.AddPass("sort", nullptr).Write(buffer);
+    graph.AddPass("count", nullptr).Read(buffer, grfx::RESOURCE_STATE_UNORDERED_ACCESS).SetSideEffects();
+    graph.AddPass("count_again", nullptr).Read(buffer, grfx::RESOURCE_STATE_UNORDERED_ACCESS).SetSideEffects();
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    const nlohmann::json exported = graph.Export();
+    EXPECT_TRUE(exported["passes"][0]["barriers"].empty());
+    EXPECT_EQ(exported["passes"][1]["barriers"].size(), 1u);
+    EXPECT_TRUE(exported["passes"][1]["barriers"][0]["memory"].get<bool>());
+    EXPECT_EQ(exported["passes"][2]["barriers"].size(), 1u);
+    EXPECT_TRUE(exported["passes"][3]["barriers"].empty());
+
+    // The next execution's first write must wait for this one's last read
+    ASSERT_EQ(exported["final_barriers"].size(), 1u);
+    EXPECT_TRUE(exported["final_barriers"][0]["memory"].get<bool>());
+}
+
+TEST(RenderGraphTest, SameStateBarriersAreMemoryBarriers)
+{
+    RenderGraph           graph;
+    RenderGraphResourceID buffer = graph.CreateBuffer("particles", StorageBuffer(1024));
+    RenderGraphResourceID image  = graph.CreateImage("accumulation", ColorTarget(256, 256));
+
+    graph.AddPass("simulate", nullptr).Write(buffer);
+    graph.AddPass("sort", nullptr).Write(buffer);
+    graph.AddPass("upload", nullptr).Read(buffer).Write(image, grfx::RESOURCE_STATE_COPY_DST);
+    graph.AddPass("patch", nullptr).Write(image, grfx::RESOURCE_STATE_COPY_DST);
+    graph.AddPass("draw", nullptr).AddRenderTarget(image);
+    graph.AddPass("draw_again", nullptr).AddRenderTarget(image).SetSideEffects();
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+
+    // Execute() records these barriers: memory barriers where the states
+    // match, transitions otherwise
+    const std::vector<RenderGraphBarrier>& sort = graph.GetPassBarriers(1);
+    ASSERT_EQ(sort.size(), 1u);
+    EXPECT_EQ(sort[0].id, buffer);
+    EXPECT_TRUE(sort[0].IsMemoryBarrier());
+    EXPECT_EQ(sort[0].afterState, grfx::RESOURCE_STATE_UNORDERED_ACCESS);
+
+    const std::vector<RenderGraphBarrier>& upload = graph.GetPassBarriers(2);
+    ASSERT_EQ(upload.size(), 1u);
+    EXPECT_EQ(upload[0].id, buffer);
+    EXPECT_FALSE(upload[0].IsMemoryBarrier());
+
+    const std::vector<RenderGraphBarrier>& patch = graph.GetPassBarriers(3);
+    ASSERT_EQ(patch.size(), 1u);
+    EXPECT_EQ(patch[0].id, image);
+    EXPECT_TRUE(patch[0].IsMemoryBarrier());
+    EXPECT_EQ(patch[0].afterState, grfx::RESOURCE_STATE_COPY_DST);
+
+    const std::vector<RenderGraphBarrier>& draw = graph.GetPassBarriers(4);
+    ASSERT_EQ(draw.size(), 1u);
+    EXPECT_FALSE(draw[0].IsMemoryBarrier());
+    EXPECT_EQ(draw[0].afterState, grfx::RESOURCE_STATE_RENDER_TARGET);
+
+    const std::vector<RenderGraphBarrier>& drawAgain = graph.GetPassBarriers(5);
+    ASSERT_EQ(drawAgain.size(), 1u);
+    EXPECT_TRUE(drawAgain[0].IsMemoryBarrier());
+    EXPECT_EQ(drawAgain[0].afterState, grfx::RESOURCE_STATE_RENDER_TARGET);
+
+    EXPECT_TRUE(graph.GetPassBarriers(6).empty());
+}
+
+TEST(RenderGraphTest, AliasesResourcesWithDisjointLifetimes)
+{
+    RenderGraph           graph;
+    FakeImage             backBuffer;
+    RenderGraphResourceID present = graph.ImportImage("back_buffer", &backBuffer, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_PRESENT);
+    RenderGraphResourceID a       = graph.CreateImage("a", ColorTarget(256, 256));
+    RenderGraphResourceID b       = graph.CreateImage("b", ColorTarget(256, 256));
+    RenderGraphResourceID c       = graph.CreateImage("c", ColorTarget(256, 256));
+    RenderGraphResourceID quarter = graph.CreateImage("quarter", ColorTarget(128, 128));
+
+    // a -> b -> c ping pong: a and c never live at the same time
+    graph.AddPass("0", nullptr).AddRenderTarget(a, true);
+    graph.AddPass("1", nullptr).Read(a).AddRenderTarget(b, true);
+    graph.AddPass("2", nullptr).Read(b).AddRenderTarget(c, true);
+    graph.AddPass("3", nullptr).Read(c).AddRenderTarget(quarter, true);
+    graph.AddPass("4", nullptr).Read(quarter).AddRenderTarget(present);
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    EXPECT_EQ(graph.GetPhysicalResourceIndex(a), graph.GetPhysicalResourceIndex(c));
+    EXPECT_NE(graph.GetPhysicalResourceIndex(a), graph.GetPhysicalResourceIndex(b));
+    EXPECT_NE(graph.GetPhysicalResourceIndex(quarter), graph.GetPhysicalResourceIndex(a));
+    EXPECT_NE(graph.GetPhysicalResourceIndex(quarter), graph.GetPhysicalResourceIndex(b));
+    EXPECT_EQ(graph.GetPhysicalResourceIndex(present), UINT32_MAX);
+
+    const RenderGraphStats& stats = graph.GetStats();
+    EXPECT_EQ(stats.transientResourceCount, 4u);
+    EXPECT_EQ(stats.physicalResourceCount, 3u);
+    EXPECT_EQ(stats.transientBytes, 3u * 256 * 256 * 4 + 128 * 128 * 4);
+    EXPECT_EQ(stats.GetAliasedBytes(), 256u * 256 * 4);
+
+    // c takes over a's memory in a different state than a was left in
+    const nlohmann::json exported = graph.Export();
+    EXPECT_EQ(GetBarriers(exported["passes"][2]["barriers"]), (std::vector<std::string>{"b:RENDER_TARGET>SHADER_RESOURCE", "c:SHADER_RESOURCE>RENDER_TARGET"}));
+}
+
+TEST(RenderGraphTest, BuffersAliasToTheLargestSize)
+{
+    RenderGraph           graph;
+    FakeBuffer            result;
+    RenderGraphResourceID output = graph.ImportBuffer("result", &result, grfx::RESOURCE_STATE_UNORDERED_ACCESS, grfx::RESOURCE_STATE_UNORDERED_ACCESS);
+    RenderGraphResourceID a      = graph.CreateBuffer("a", StorageBuffer(1000));
+    RenderGraphResourceID b      = graph.CreateBuffer("b", StorageBuffer(500));
+    RenderGraphResourceID c      = graph.CreateBuffer("c", StorageBuffer(4000));
+
+    graph.AddPass("0", nullptr).Write(a);
+    graph.AddPass("1", nullptr).Read(a).Write(b);
+    graph.AddPass("2", nullptr).Read(b).Write(c);
+    graph.AddPass("3", nullptr).Read(c).Write(output);
+
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    EXPECT_EQ(graph.GetPhysicalResourceIndex(a), graph.GetPhysicalResourceIndex(c));
+    EXPECT_EQ(graph.GetStats().transientBytes, 5500u);
+    EXPECT_EQ(graph.GetStats().allocatedBytes, 4500u);
+    EXPECT_EQ(graph.GetStats().GetAliasedBytes(), 1000u);
+}
+
+TEST(RenderGraphTest, RejectsInvalidDeclarations)
+{
+    {
+        RenderGraph graph;
+        graph.AddPass("invalid", nullptr).Read(42).SetSideEffects();
+        EXPECT_EQ(graph.Compile(nullptr), ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE);
+        EXPECT_FALSE(graph.IsCompiled());
+    }
+    {
+        RenderGraph           graph;
+        RenderGraphResourceID buffer = graph.CreateBuffer("buffer", StorageBuffer(64));
+        graph.AddPass("attachment", nullptr).AddRenderTarget(buffer).SetSideEffects();
+        EXPECT_EQ(graph.Compile(nullptr), ppx::ERROR_RENDER_GRAPH_INVALID_RESOURCE);
+    }
+    {
+        RenderGraph           graph;
+        RenderGraphResourceID image = graph.CreateImage("image", ColorTarget(64, 64));
+        graph.AddPass("conflict", nullptr).Read(image).AddRenderTarget(image).SetSideEffects();
+        EXPECT_EQ(graph.Compile(nullptr), ppx::ERROR_RENDER_GRAPH_CONFLICTING_ACCESS);
+    }
+}
+
+TEST(RenderGraphTest, CompilesWithoutDeviceForInspection)
+{
+    RenderGraph           graph;
+    RenderGraphResourceID image = graph.CreateImage("image", ColorTarget(64, 64));
+    graph.AddPass("pass", nullptr).AddRenderTarget(image).SetSideEffects();
+    ASSERT_EQ(graph.Compile(nullptr), ppx::SUCCESS);
+    EXPECT_TRUE(graph.IsCompiled());
+    EXPECT_EQ(graph.GetImage(image), nullptr);
+
+    const nlohmann::json exported = graph.Export();
+    EXPECT_TRUE(exported["compiled"].get<bool>());
+    EXPECT_EQ(exported["resources"][0]["name"], "image");
+    EXPECT_EQ(exported["resources"][0]["physical_resource"], 0);
+    EXPECT_EQ(exported["stats"]["pass_count"], 1);
+}
@@ -0,0 +1,137 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/slot_map.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace ppx;
+
+TEST(SlotMapTest, InsertAndGet)
+{
+    SlotMap<int> map;
+    SlotHandle   a = map.Insert(10);
+    SlotHandle   b = map.Insert(20);
+    EXPECT_NE(a, 0u);
+    EXPECT_NE(b, 0u);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(map.size(), 2u);
+    ASSERT_NE(map.Get(a), nullptr);
+    ASSERT_NE(map.Get(b), nullptr);
+    EXPECT_EQ(*map.Get(a), 10);
+    EXPECT_EQ(*map.Get(b), 20);
+}
+
+TEST(SlotMapTest, ZeroHandleIsNeverValid)
+{
+    SlotMap<int> map;
+    map.Insert(1);
+    EXPECT_FALSE(map.Contains(0));
+    EXPECT_EQ(map.Get(0), nullptr);
+    EXPECT_FALSE(map.Erase(0));
+}
+
+TEST(SlotMapTest, EraseKeepsOtherHandlesValid)
+{
+    SlotMap<int> map;
+    SlotHandle   a = map.Insert(1);
+    SlotHandle   b = map.Insert(2);
+    SlotHandle   c = map.Insert(3);
+
+    EXPECT_TRUE(map.Erase(a));
+    EXPECT_FALSE(map.Contains(a));
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(*map.Get(b), 2);
+    EXPECT_EQ(*map.Get(c), 3);
+}
+
+TEST(SlotMapTest, StaleHandleDoesNotMatchReusedSlot)
+{
+    SlotMap<int> map;
+    SlotHandle   a = map.Insert(1);
+    EXPECT_TRUE(map.Erase(a));
+    EXPECT_FALSE(map.Erase(a));
+
+    SlotHandle b = map.Insert(2);
+    EXPECT_NE(a, b);
+    EXPECT_FALSE(map.Contains(a));
+    EXPECT_EQ(map.Get(a), nullptr);
+    EXPECT_EQ(*map.Get(b), 2);
+}
+
+TEST(SlotMapTest, ClearInvalidatesHandles)
+{
+    SlotMap<int> map;
+    SlotHandle   a = map.Insert(1);
+    SlotHandle   b = map.Insert(2);
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.Contains(a));
+    EXPECT_FALSE(map.Contains(b));
+}
+
+TEST(SlotMapTest, GetHandleMatchesIterationOrder)
+{
+    SlotMap<int> map;
+    for (int i = 0; i < 16; ++i) {
+        map.Insert(i);
+    }
+    map.Erase(map.GetHandle(3));
+    map.Erase(map.GetHandle(0));
+    for (size_t i = 0; i < map.size(); ++i) {
+        EXPECT_EQ(*map.Get(map.GetHandle(i)), map[i]);
+    }
+}
+
+TEST(SlotMapTest, RandomChurnMatchesReference)
+{
+    std::mt19937                                 rng(1234);
+    SlotMap<uint32_t>                            map;
+    std::vector<std::pair<SlotHandle, uint32_t>> live;
+    std::vector<SlotHandle>                      dead;
+
+    for (uint32_t i = 0; i < 20000; ++i) {
+        if (live.empty() || (rng() % 3 != 0)) {
+            live.push_back({map.Insert(i), i});
+        }
+        else {
+            size_t index = rng() % live.size();
+            EXPECT_TRUE(map.Erase(live[index].first));
+            dead.push_back(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    EXPECT_EQ(map.size(), live.size());
+    for (auto& elem : live) {
+        ASSERT_NE(map.Get(elem.first), nullptr);
+        EXPECT_EQ(*map.Get(elem.first), elem.second);
+    }
+    for (SlotHandle handle : dead) {
+        EXPECT_FALSE(map.Contains(handle));
+    }
+
+    std::vector<uint32_t> values(map.begin(), map.end());
+    std::sort(values.begin(), values.end());
+    std::vector<uint32_t> expected;
+    for (auto& elem : live) {
+        expected.push_back(elem.second);
+    }
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(values, expected);
+}
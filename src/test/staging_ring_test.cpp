@@ -0,0 +1,204 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_staging_ring.h"
+
+#include <memory>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+// Ring buffers backed by CPU memory instead of device buffers
+class FakeStagingRing : public grfx::StagingRing
+{
+public:
+    FakeStagingRing(uint64_t initialSize, uint64_t maxSize)
+    {
+        grfx::StagingRingCreateInfo createInfo = {};
+        createInfo.initialSize                 = initialSize;
+        createInfo.maxSize                     = maxSize;
+        EXPECT_EQ(Create(&createInfo), ppx::SUCCESS);
+    }
+
+    ~FakeStagingRing()
+    {
+        DestroyApiObjects();
+    }
+
+    uint32_t GetLiveBufferCount() const { return mLiveBufferCount; }
+
+protected:
+    Result CreateRingBuffer(uint64_t size, grfx::Buffer** ppBuffer, void** ppMappedAddress) override
+    {
+        mBuffers.push_back(std::make_unique<FakeBuffer>());
+        mMemory.push_back(std::make_unique<char[]>(static_cast<size_t>(size)));
+        *ppBuffer        = mBuffers.back().get();
+        *ppMappedAddress = mMemory.back().get();
+        mLiveBufferCount += 1;
+        return ppx::SUCCESS;
+    }
+
+    void DestroyRingBuffer(grfx::Buffer* pBuffer) override
+    {
+        mLiveBufferCount -= 1;
+    }
+
+private:
+    std::vector<std::unique_ptr<FakeBuffer>> mBuffers;
+    std::vector<std::unique_ptr<char[]>>     mMemory;
+    uint32_t                                 mLiveBufferCount = 0;
+};
+
+} // namespace
+
+TEST(StagingRingTest, AlignsToNonPowerOfTwo)
+{
+    FakeStagingRing ring(1024, 1024);
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    ASSERT_EQ(ring.Allocate(10, 1, &a), ppx::SUCCESS);
+    ASSERT_EQ(ring.Allocate(24, 12, &b), ppx::SUCCESS);
+    EXPECT_EQ(a.offset, 0u);
+    EXPECT_EQ(b.offset, 12u);
+    EXPECT_EQ(static_cast<char*>(b.pMappedAddress) - static_cast<char*>(a.pMappedAddress), 12);
+    EXPECT_EQ(ring.GetStats().bytesStaged, 36u);
+}
+
+TEST(StagingRingTest, WrapsAroundOnceTheOldestIsFreed)
+{
+    FakeStagingRing ring(1024, 1024);
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    grfx::StagingAllocation c = {};
+    ASSERT_EQ(ring.Allocate(400, 1, &a), ppx::SUCCESS);
+    ASSERT_EQ(ring.Allocate(400, 1, &b), ppx::SUCCESS);
+    EXPECT_EQ(b.offset, 400u);
+
+    // c doesn't fit at the end, it goes where a was and the 224 bytes at
+    // the end are skipped
+    ring.Free(a);
+    ASSERT_EQ(ring.Allocate(400, 1, &c), ppx::SUCCESS);
+    EXPECT_EQ(c.offset, 0u);
+    EXPECT_EQ(c.pBuffer, a.pBuffer);
+
+    grfx::StagingRingStats stats = ring.GetStats();
+    EXPECT_EQ(stats.growCount, 0u);
+    EXPECT_EQ(stats.capacity, 1024u);
+    EXPECT_EQ(stats.bytesInUse, 1024u);
+
+    ring.Free(b);
+    ring.Free(c);
+    ring.Free(c); // Already released
+    EXPECT_EQ(ring.GetStats().bytesInUse, 0u);
+}
+
+TEST(StagingRingTest, GrowsUntilMaxSize)
+{
+    FakeStagingRing ring(256, 1024);
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    grfx::StagingAllocation c = {};
+    ASSERT_EQ(ring.Allocate(200, 1, &a), ppx::SUCCESS);
+    ASSERT_EQ(ring.Allocate(200, 1, &b), ppx::SUCCESS);
+    EXPECT_EQ(ring.GetStats().capacity, 512u);
+    ASSERT_EQ(ring.Allocate(400, 1, &c), ppx::SUCCESS);
+    EXPECT_EQ(ring.GetStats().capacity, 1024u);
+    EXPECT_EQ(ring.GetStats().growCount, 2u);
+
+    // Replaced buffers are destroyed once everything in them is released
+    EXPECT_EQ(ring.GetLiveBufferCount(), 3u);
+    ring.Free(a);
+    EXPECT_EQ(ring.GetLiveBufferCount(), 2u);
+    ring.Free(b);
+    EXPECT_EQ(ring.GetLiveBufferCount(), 1u);
+}
+
+TEST(StagingRingTest, WaitsOnFenceAtMaxSize)
+{
+    FakeStagingRing ring(1024, 1024);
+    FakeFence       fence;
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    ASSERT_EQ(ring.Allocate(600, 1, &a), ppx::SUCCESS);
+    ring.Retire(a, &fence);
+
+    ASSERT_EQ(ring.Allocate(600, 1, &b), ppx::SUCCESS);
+    EXPECT_EQ(b.offset, 0u);
+    EXPECT_EQ(fence.GetBlockingWaitCount(), 1u);
+
+    grfx::StagingRingStats stats = ring.GetStats();
+    EXPECT_EQ(stats.stallCount, 1u);
+    EXPECT_EQ(stats.growCount, 0u);
+    EXPECT_EQ(stats.capacity, 1024u);
+    EXPECT_EQ(ring.GetLiveBufferCount(), 1u);
+}
+
+TEST(StagingRingTest, SignaledFencesAreReleasedWithoutWaiting)
+{
+    FakeStagingRing ring(1024, 1024);
+    FakeFence       fence;
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    ASSERT_EQ(ring.Allocate(600, 1, &a), ppx::SUCCESS);
+    ring.Retire(a, &fence);
+    fence.SignalOnHost();
+
+    ASSERT_EQ(ring.Allocate(600, 1, &b), ppx::SUCCESS);
+    EXPECT_EQ(fence.GetBlockingWaitCount(), 0u);
+    EXPECT_EQ(ring.GetStats().stallCount, 0u);
+}
+
+TEST(StagingRingTest, GrowsPastMaxSizeWithNothingToWaitOn)
+{
+    // The oldest allocation is still owned by its caller
+    FakeStagingRing ring(256, 256);
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    ASSERT_EQ(ring.Allocate(200, 1, &a), ppx::SUCCESS);
+    ASSERT_EQ(ring.Allocate(200, 1, &b), ppx::SUCCESS);
+
+    grfx::StagingRingStats stats = ring.GetStats();
+    EXPECT_EQ(stats.growCount, 1u);
+    EXPECT_EQ(stats.capacity, 512u);
+    EXPECT_EQ(stats.stallCount, 0u);
+}
+
+TEST(StagingRingTest, FrameRetiredAllocationsAreReleasedInOrder)
+{
+    FakeStagingRing ring(1024, 1024);
+
+    grfx::StagingAllocation a = {};
+    grfx::StagingAllocation b = {};
+    ASSERT_EQ(ring.Allocate(100, 1, &a), ppx::SUCCESS);
+    ASSERT_EQ(ring.Allocate(100, 1, &b), ppx::SUCCESS);
+    ring.Retire(a, 5);
+    ring.Retire(b, 4);
+
+    ring.ReleaseFrames(4);
+    EXPECT_EQ(ring.GetStats().bytesInUse, 200u); // b waits for a
+    ring.ReleaseFrames(5);
+    EXPECT_EQ(ring.GetStats().bytesInUse, 0u);
+    EXPECT_EQ(ring.GetStats().peakBytesInUse, 200u);
+}
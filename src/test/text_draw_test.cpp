@@ -0,0 +1,173 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_text_draw.h"
+
+#include <vector>
+
+using namespace ppx;
+using grfx::internal::GlyphLookup;
+using grfx::internal::TextLayoutCache;
+
+namespace {
+
+std::vector<grfx::TextureFontGlyphMetrics> MakeGlyphs(const std::vector<uint32_t>& codepoints)
+{
+    std::vector<grfx::TextureFontGlyphMetrics> glyphs;
+    for (uint32_t codepoint : codepoints) {
+        grfx::TextureFontGlyphMetrics glyph = {};
+        glyph.codepoint                     = codepoint;
+        glyphs.push_back(glyph);
+    }
+    return glyphs;
+}
+
+} // namespace
+
+TEST(GlyphLookupTest, FindsAsciiAndNonAsciiGlyphs)
+{
+    // 'A', e acute, a CJK ideograph and an emoji outside the BMP
+    GlyphLookup lookup;
+    lookup.Build(MakeGlyphs({'A', 0xE9, 0x4E2D, ' ', 0x1F600}));
+
+    EXPECT_EQ(lookup.Find('A'), 0u);
+    EXPECT_EQ(lookup.Find(0xE9), 1u);
+    EXPECT_EQ(lookup.Find(0x4E2D), 2u);
+    EXPECT_EQ(lookup.Find(' '), 3u);
+    EXPECT_EQ(lookup.Find(0x1F600), 4u);
+
+    // Only the codepoints past ASCII go to the map
+    EXPECT_EQ(lookup.GetMappedCount(), 3u);
+}
+
+TEST(GlyphLookupTest, MissingCodepointsAreInvalid)
+{
+    GlyphLookup lookup;
+    EXPECT_EQ(lookup.Find('A'), GlyphLookup::kInvalidIndex);
+    EXPECT_EQ(lookup.Find(0xE9), GlyphLookup::kInvalidIndex);
+
+    lookup.Build(MakeGlyphs({'A', 0xE9}));
+    EXPECT_EQ(lookup.Find('B'), GlyphLookup::kInvalidIndex);
+    EXPECT_EQ(lookup.Find(127), GlyphLookup::kInvalidIndex);
+    EXPECT_EQ(lookup.Find(128), GlyphLookup::kInvalidIndex);
+    EXPECT_EQ(lookup.Find(0xEA), GlyphLookup::kInvalidIndex);
+}
+
+TEST(GlyphLookupTest, FirstRepeatedGlyphWins)
+{
+    GlyphLookup lookup;
+    lookup.Build(MakeGlyphs({'A', 0xE9, 'A', 0xE9}));
+    EXPECT_EQ(lookup.Find('A'), 0u);
+    EXPECT_EQ(lookup.Find(0xE9), 1u);
+    EXPECT_EQ(lookup.GetMappedCount(), 1u);
+
+    // Building again starts over
+    lookup.Build(MakeGlyphs({0xE9}));
+    EXPECT_EQ(lookup.Find('A'), GlyphLookup::kInvalidIndex);
+    EXPECT_EQ(lookup.Find(0xE9), 0u);
+}
+
+TEST(TextLayoutCacheTest, HashCoversStringAndSpacing)
+{
+    const uint64_t hash = TextLayoutCache::Hash("FPS: 60", 3.0f, 1.0f);
+    EXPECT_EQ(TextLayoutCache::Hash("FPS: 60", 3.0f, 1.0f), hash);
+    EXPECT_NE(TextLayoutCache::Hash("FPS: 61", 3.0f, 1.0f), hash);
+    EXPECT_NE(TextLayoutCache::Hash("FPS: 60", 2.0f, 1.0f), hash);
+    EXPECT_NE(TextLayoutCache::Hash("FPS: 60", 3.0f, 1.5f), hash);
+}
+
+TEST(TextLayoutCacheTest, MissThenHit)
+{
+    TextLayoutCache cache;
+    cache.SetMaxLayouts(16);
+
+    const std::string string = "FPS: 60";
+    const uint64_t    hash   = TextLayoutCache::Hash(string, 3.0f, 1.0f);
+    EXPECT_EQ(cache.Find(hash, string, 3.0f, 1.0f), nullptr);
+
+    TextLayoutCache::Layout* pLayout = cache.Insert(hash, string, 3.0f, 1.0f);
+    ASSERT_NE(pLayout, nullptr);
+    pLayout->quads.resize(7);
+    EXPECT_EQ(cache.GetCount(), 1u);
+
+    TextLayoutCache::Layout* pHit = cache.Find(hash, string, 3.0f, 1.0f);
+    EXPECT_EQ(pHit, pLayout);
+    EXPECT_EQ(pHit->quads.size(), 7u);
+
+    // Different spacing is a different layout
+    EXPECT_EQ(cache.Find(TextLayoutCache::Hash(string, 2.0f, 1.0f), string, 2.0f, 1.0f), nullptr);
+}
+
+TEST(TextLayoutCacheTest, CollisionComparesWholeKey)
+{
+    TextLayoutCache cache;
+    cache.SetMaxLayouts(16);
+
+    // Pretend both strings hash to the same value
+    const uint64_t hash = 42;
+    ASSERT_NE(cache.Insert(hash, "first", 3.0f, 1.0f), nullptr);
+
+    EXPECT_EQ(cache.Find(hash, "second", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.Find(hash, "first", 2.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.Find(hash, "first", 3.0f, 2.0f), nullptr);
+
+    // The colliding string isn't cached and doesn't replace the first one
+    EXPECT_EQ(cache.Insert(hash, "second", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.GetCount(), 1u);
+    EXPECT_NE(cache.Find(hash, "first", 3.0f, 1.0f), nullptr);
+}
+
+TEST(TextLayoutCacheTest, ZeroMaxLayoutsDisablesCache)
+{
+    TextLayoutCache cache;
+    cache.SetMaxLayouts(0);
+
+    const uint64_t hash = TextLayoutCache::Hash("FPS: 60", 3.0f, 1.0f);
+    EXPECT_EQ(cache.Insert(hash, "FPS: 60", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.Find(hash, "FPS: 60", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.GetCount(), 0u);
+}
+
+TEST(TextLayoutCacheTest, FullCacheRejectsNewLayouts)
+{
+    TextLayoutCache cache;
+    cache.SetMaxLayouts(2);
+
+    ASSERT_NE(cache.Insert(1, "a", 3.0f, 1.0f), nullptr);
+    ASSERT_NE(cache.Insert(2, "b", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.Insert(3, "c", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.GetCount(), 2u);
+}
+
+TEST(TextLayoutCacheTest, UnusedLayoutsAreEvicted)
+{
+    TextLayoutCache cache;
+    cache.SetMaxLayouts(16);
+
+    ASSERT_NE(cache.Insert(1, "static", 3.0f, 1.0f), nullptr);
+    ASSERT_NE(cache.Insert(2, "once", 3.0f, 1.0f), nullptr);
+
+    // Both were used during the frame that just ended
+    cache.NextFrame();
+    EXPECT_EQ(cache.GetCount(), 2u);
+
+    // Only "static" is drawn again
+    EXPECT_NE(cache.Find(1, "static", 3.0f, 1.0f), nullptr);
+    cache.NextFrame();
+    EXPECT_EQ(cache.GetCount(), 1u);
+    EXPECT_NE(cache.Find(1, "static", 3.0f, 1.0f), nullptr);
+    EXPECT_EQ(cache.Find(2, "once", 3.0f, 1.0f), nullptr);
+}
@@ -0,0 +1,297 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/texture_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace ppx {
+namespace {
+
+void WriteU32(std::vector<char>& data, size_t offset, uint32_t value)
+{
+    if (data.size() < offset + sizeof(value)) {
+        data.resize(offset + sizeof(value));
+    }
+    memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+void WriteU64(std::vector<char>& data, size_t offset, uint64_t value)
+{
+    if (data.size() < offset + sizeof(value)) {
+        data.resize(offset + sizeof(value));
+    }
+    memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+// Appends size bytes set to fill
+void AppendLevel(std::vector<char>& data, size_t size, char fill)
+{
+    data.insert(data.end(), size, fill);
+}
+
+std::vector<char> MakeDDSHeader(uint32_t width, uint32_t height, uint32_t mipCount, const char* fourCC)
+{
+    std::vector<char> data(128, 0);
+    memcpy(data.data(), "DDS ", 4);
+    WriteU32(data, 4, 124);
+    WriteU32(data, 12, height);
+    WriteU32(data, 16, width);
+    WriteU32(data, 28, mipCount);
+    WriteU32(data, 76, 32);
+    WriteU32(data, 80, 0x4); // DDPF_FOURCC
+    memcpy(data.data() + 84, fourCC, 4);
+    return data;
+}
+
+std::vector<char> MakeKTXHeader(uint32_t glInternalFormat, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t keyValueSize)
+{
+    const char        identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n'};
+    std::vector<char> data(64 + keyValueSize, 0);
+    memcpy(data.data(), identifier, sizeof(identifier));
+    WriteU32(data, 12, 0x04030201);
+    WriteU32(data, 28, glInternalFormat);
+    WriteU32(data, 36, width);
+    WriteU32(data, 40, height);
+    WriteU32(data, 52, 1);
+    WriteU32(data, 56, mipCount);
+    WriteU32(data, 60, keyValueSize);
+    return data;
+}
+
+std::vector<char> MakeKTX2Header(uint32_t vkFormat, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t supercompression)
+{
+    const char        identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '2', '0', '\xBB', '\r', '\n', '\x1A', '\n'};
+    std::vector<char> data(80 + 24 * mipCount, 0);
+    memcpy(data.data(), identifier, sizeof(identifier));
+    WriteU32(data, 12, vkFormat);
+    WriteU32(data, 20, width);
+    WriteU32(data, 24, height);
+    WriteU32(data, 36, 1);
+    WriteU32(data, 40, mipCount);
+    WriteU32(data, 44, supercompression);
+    return data;
+}
+
+} // namespace
+
+TEST(TextureFileTest, IsTextureFile)
+{
+    EXPECT_TRUE(TextureFile::IsTextureFile("a/b.dds"));
+    EXPECT_TRUE(TextureFile::IsTextureFile("b.ktx"));
+    EXPECT_TRUE(TextureFile::IsTextureFile("b.ktx2"));
+    EXPECT_FALSE(TextureFile::IsTextureFile("b.png"));
+    EXPECT_FALSE(TextureFile::IsTextureFile("dds"));
+}
+
+TEST(TextureFileTest, DDSLegacyLevels)
+{
+    // BC1 is 8 bytes per 4x4 block, the 2x2 and 1x1 levels are dropped
+    std::vector<char> data = MakeDDSHeader(16, 8, 5, "DXT1");
+    AppendLevel(data, 4 * 2 * 8, 'a');
+    AppendLevel(data, 2 * 1 * 8, 'b');
+    AppendLevel(data, 1 * 1 * 8, 'c');
+    AppendLevel(data, 8, 'd');
+    AppendLevel(data, 8, 'e');
+
+    TextureFile file;
+    ASSERT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::SUCCESS);
+    EXPECT_EQ(file.GetType(), TEXTURE_FILE_TYPE_DDS);
+    EXPECT_EQ(file.GetFormat(), grfx::FORMAT_BC1_RGBA_UNORM);
+    EXPECT_EQ(file.GetWidth(), 16u);
+    EXPECT_EQ(file.GetHeight(), 8u);
+    ASSERT_EQ(file.GetLevelCount(), 2u);
+
+    const TextureFileLevel& level0 = file.GetLevel(0);
+    EXPECT_EQ(level0.offset, 128u);
+    EXPECT_EQ(level0.rowCount, 2u);
+    EXPECT_EQ(level0.rowSize, 32u);
+    EXPECT_EQ(level0.size, 64u);
+    EXPECT_EQ(file.GetLevelData(0)[0], 'a');
+
+    const TextureFileLevel& level1 = file.GetLevel(1);
+    EXPECT_EQ(level1.width, 8u);
+    EXPECT_EQ(level1.height, 4u);
+    EXPECT_EQ(level1.offset, 192u);
+    EXPECT_EQ(level1.size, 16u);
+    EXPECT_EQ(file.GetLevelData(1)[0], 'b');
+}
+
+TEST(TextureFileTest, DDSExtendedHeader)
+{
+    std::vector<char> data = MakeDDSHeader(8, 8, 1, "DX10");
+    WriteU32(data, 128, 98); // DXGI_FORMAT_BC7_UNORM
+    WriteU32(data, 132, 3);  // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    WriteU32(data, 136, 0);
+    WriteU32(data, 140, 1);
+    WriteU32(data, 144, 0);
+    AppendLevel(data, 2 * 2 * 16, 'x');
+
+    TextureFile file;
+    ASSERT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::SUCCESS);
+    EXPECT_EQ(file.GetFormat(), grfx::FORMAT_BC7_UNORM);
+    ASSERT_EQ(file.GetLevelCount(), 1u);
+    EXPECT_EQ(file.GetLevel(0).offset, 148u);
+    EXPECT_EQ(file.GetLevel(0).size, 64u);
+
+    // Cube maps aren't supported
+    WriteU32(data, 136, 0x4);
+    EXPECT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, DDSUncompressed)
+{
+    std::vector<char> data = MakeDDSHeader(4, 2, 2, "\0\0\0\0");
+    WriteU32(data, 80, 0x41); // DDPF_RGB | DDPF_ALPHAPIXELS
+    WriteU32(data, 88, 32);
+    WriteU32(data, 92, 0x00FF0000);
+    WriteU32(data, 96, 0x0000FF00);
+    WriteU32(data, 100, 0x000000FF);
+    WriteU32(data, 104, 0xFF000000);
+    AppendLevel(data, 4 * 2 * 4, 'a');
+    AppendLevel(data, 2 * 1 * 4, 'b');
+
+    TextureFile file;
+    ASSERT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::SUCCESS);
+    EXPECT_EQ(file.GetFormat(), grfx::FORMAT_B8G8R8A8_UNORM);
+    ASSERT_EQ(file.GetLevelCount(), 2u);
+    EXPECT_EQ(file.GetLevel(0).rowCount, 2u);
+    EXPECT_EQ(file.GetLevel(0).rowSize, 16u);
+    EXPECT_EQ(file.GetLevel(1).offset, 160u);
+}
+
+TEST(TextureFileTest, DDSTruncatedFails)
+{
+    std::vector<char> data = MakeDDSHeader(16, 16, 1, "DXT5");
+    AppendLevel(data, 4 * 4 * 16 - 1, 'a');
+
+    TextureFile file;
+    EXPECT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+    EXPECT_EQ(file.OpenFromMemory(data.data(), 64), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, TooManyLevelsFails)
+{
+    // 40 levels is more than the 5 of a full 16x16 chain
+    std::vector<char> dds = MakeDDSHeader(16, 16, 40, "\0\0\0\0");
+    WriteU32(dds, 80, 0x41); // DDPF_RGB | DDPF_ALPHAPIXELS
+    WriteU32(dds, 88, 32);
+    WriteU32(dds, 92, 0x000000FF);
+    WriteU32(dds, 100, 0x00FF0000);
+    AppendLevel(dds, 16 * 16 * 4, 'a');
+
+    // GL_RGBA8 and VK_FORMAT_R8G8B8A8_UNORM
+    std::vector<char> ktx  = MakeKTXHeader(0x8058, 16, 16, 40, 0);
+    std::vector<char> ktx2 = MakeKTX2Header(37, 16, 16, 40, 0);
+
+    TextureFile file;
+    EXPECT_EQ(file.OpenFromMemory(dds.data(), dds.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+    EXPECT_EQ(file.OpenFromMemory(ktx.data(), ktx.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+    EXPECT_EQ(file.OpenFromMemory(ktx2.data(), ktx2.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, KTXLevels)
+{
+    // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16 bytes per block
+    std::vector<char> data = MakeKTXHeader(0x83F3, 8, 8, 2, 8);
+    WriteU32(data, data.size(), 64);
+    AppendLevel(data, 64, 'a');
+    WriteU32(data, data.size(), 16);
+    AppendLevel(data, 16, 'b');
+
+    TextureFile file;
+    ASSERT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::SUCCESS);
+    EXPECT_EQ(file.GetType(), TEXTURE_FILE_TYPE_KTX);
+    EXPECT_EQ(file.GetFormat(), grfx::FORMAT_BC3_UNORM);
+    ASSERT_EQ(file.GetLevelCount(), 2u);
+    EXPECT_EQ(file.GetLevel(0).offset, 76u);
+    EXPECT_EQ(file.GetLevel(1).offset, 144u);
+    EXPECT_EQ(file.GetLevelData(1)[0], 'b');
+
+    // Level size that doesn't match the format
+    WriteU32(data, 72, 60);
+    EXPECT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, KTX2Levels)
+{
+    // VK_FORMAT_BC7_UNORM_BLOCK, levels stored smallest first
+    std::vector<char> data = MakeKTX2Header(145, 8, 8, 2, 0);
+    const size_t      tail = data.size();
+    AppendLevel(data, 16, 'b');
+    const size_t base = data.size();
+    AppendLevel(data, 64, 'a');
+    WriteU64(data, 80, base);
+    WriteU64(data, 88, 64);
+    WriteU64(data, 96, 64);
+    WriteU64(data, 104, tail);
+    WriteU64(data, 112, 16);
+    WriteU64(data, 120, 16);
+
+    TextureFile file;
+    ASSERT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::SUCCESS);
+    EXPECT_EQ(file.GetType(), TEXTURE_FILE_TYPE_KTX2);
+    EXPECT_EQ(file.GetFormat(), grfx::FORMAT_BC7_UNORM);
+    ASSERT_EQ(file.GetLevelCount(), 2u);
+    EXPECT_EQ(file.GetLevel(0).offset, base);
+    EXPECT_EQ(file.GetLevel(1).offset, tail);
+    EXPECT_EQ(file.GetLevelData(0)[0], 'a');
+    EXPECT_EQ(file.GetLevelData(1)[0], 'b');
+
+    // Offset past the end of the file
+    WriteU64(data, 80, data.size());
+    EXPECT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, KTX2SupercompressionRejected)
+{
+    // Basis Universal: undefined format and BasisLZ supercompression
+    std::vector<char> data = MakeKTX2Header(0, 8, 8, 1, 1);
+    AppendLevel(data, 64, 'a');
+
+    TextureFile file;
+    EXPECT_EQ(file.OpenFromMemory(data.data(), data.size()), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST(TextureFileTest, OpenFile)
+{
+    std::vector<char> data = MakeDDSHeader(4, 4, 1, "ATI2");
+    AppendLevel(data, 16, 'z');
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ppx_texture_file_test.dds";
+    {
+        std::ofstream os(path, std::ios::binary);
+        os.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    {
+        TextureFile file;
+        ASSERT_EQ(file.Open(path), ppx::SUCCESS);
+        EXPECT_EQ(file.GetFormat(), grfx::FORMAT_BC5_UNORM);
+        ASSERT_EQ(file.GetLevelCount(), 1u);
+        EXPECT_EQ(file.GetLevelData(0)[15], 'z');
+    }
+
+    TextureFile missing;
+    EXPECT_EQ(missing.Open(path.string() + ".missing"), ppx::ERROR_IMAGE_FILE_LOAD_FAILED);
+
+    std::filesystem::remove(path);
+}
+
+} // namespace ppx
@@ -0,0 +1,88 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/thread_pool.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace ppx;
+
+TEST(ThreadPoolTest, DefaultThreadCountIsNonZero)
+{
+    ThreadPool pool;
+    EXPECT_GT(pool.GetThreadCount(), 0u);
+}
+
+TEST(ThreadPoolTest, SubmitAndWaitIdleRunsAllTasks)
+{
+    ThreadPool            pool(4);
+    std::atomic<uint32_t> counter{0};
+    for (uint32_t i = 0; i < 1000; ++i) {
+        pool.Submit([&counter]() { counter.fetch_add(1); });
+    }
+    pool.WaitIdle();
+    EXPECT_EQ(counter.load(), 1000u);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce)
+{
+    ThreadPool            pool(4);
+    std::vector<uint32_t> hits(4096, 0);
+    pool.ParallelFor(static_cast<uint32_t>(hits.size()), [&hits](uint32_t i) { hits[i] += 1; });
+    for (uint32_t value : hits) {
+        EXPECT_EQ(value, 1u);
+    }
+}
+
+TEST(ThreadPoolTest, ParallelForZeroCountIsNoOp)
+{
+    ThreadPool pool(2);
+    bool       called = false;
+    pool.ParallelFor(0, [&called](uint32_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(ThreadPoolTest, NestedParallelForDoesNotDeadlock)
+{
+    ThreadPool            pool(2);
+    std::atomic<uint32_t> counter{0};
+    pool.ParallelFor(8, [&](uint32_t) {
+        pool.ParallelFor(8, [&](uint32_t) { counter.fetch_add(1); });
+    });
+    EXPECT_EQ(counter.load(), 64u);
+}
+
+TEST(ThreadPoolTest, SerialPoolRunsOnCallingThread)
+{
+    std::unique_ptr<ThreadPool> pool = ThreadPool::CreateSerial();
+    EXPECT_EQ(pool->GetThreadCount(), 0u);
+
+    const std::thread::id callingThread = std::this_thread::get_id();
+    std::atomic<uint32_t> counter{0};
+    pool->Submit([&]() {
+        EXPECT_EQ(std::this_thread::get_id(), callingThread);
+        counter.fetch_add(1);
+    });
+    EXPECT_EQ(counter.load(), 1u);
+
+    pool->ParallelFor(8, [&](uint32_t) {
+        EXPECT_EQ(std::this_thread::get_id(), callingThread);
+        counter.fetch_add(1);
+    });
+    pool->WaitIdle();
+    EXPECT_EQ(counter.load(), 9u);
+}
@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/tri_mesh.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace ppx;
+
+// Quad made of two triangles sharing an edge. Every corner uses the same
+// position, normal and texcoord index so the two shared corners weld.
+constexpr const char* kQuadObj = R"(
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+vn 0 0 1
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+f 1/1/1 2/2/1 3/3/1
+f 1/1/1 3/3/1 4/4/1
+)";
+
+class TriMeshObjTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = std::filesystem::temp_directory_path() / "ppx_tri_mesh_test_quad.obj";
+        std::ofstream file(path);
+        file << kQuadObj;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+TEST_F(TriMeshObjTest, WithoutWeldingVerticesAreNotShared)
+{
+    TriMesh mesh;
+    ASSERT_EQ(TriMesh::CreateFromOBJ(path, TriMeshOptions().Indices(), &mesh), ppx::SUCCESS);
+    EXPECT_EQ(mesh.GetCountTriangles(), 2u);
+    EXPECT_EQ(mesh.GetCountPositions(), 6u);
+    EXPECT_EQ(mesh.GetIndexType(), grfx::INDEX_TYPE_UINT32);
+}
+
+TEST_F(TriMeshObjTest, WeldingSharesIdenticalVertices)
+{
+    TriMesh mesh;
+    ASSERT_EQ(TriMesh::CreateFromOBJ(path, TriMeshOptions().WeldVertices().Normals().TexCoords(), &mesh), ppx::SUCCESS);
+    EXPECT_EQ(mesh.GetCountTriangles(), 2u);
+    EXPECT_EQ(mesh.GetCountPositions(), 4u);
+    EXPECT_EQ(mesh.GetCountNormals(), 4u);
+    EXPECT_EQ(mesh.GetCountTexCoords(), 4u);
+    EXPECT_EQ(mesh.GetIndexType(), grfx::INDEX_TYPE_UINT16);
+
+    const uint16_t* pIndices = mesh.GetDataIndicesU16();
+    ASSERT_NE(pIndices, nullptr);
+    const uint16_t kExpectedIndices[6] = {0, 1, 2, 0, 2, 3};
+    for (uint32_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(pIndices[i], kExpectedIndices[i]);
+    }
+}
+
+TEST_F(TriMeshObjTest, WeldingRespectsInvertWinding)
+{
+    TriMesh mesh;
+    ASSERT_EQ(TriMesh::CreateFromOBJ(path, TriMeshOptions().WeldVertices().InvertWinding(), &mesh), ppx::SUCCESS);
+
+    const uint16_t* pIndices = mesh.GetDataIndicesU16();
+    ASSERT_NE(pIndices, nullptr);
+    const uint16_t kExpectedIndices[6] = {0, 2, 1, 0, 3, 2};
+    for (uint32_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(pIndices[i], kExpectedIndices[i]);
+    }
+}
+
+TEST_F(TriMeshObjTest, WeldingNormalizesTangentFrames)
+{
+    // Scaled tex coords make the face tangent and bitangent half length,
+    // both faces of the quad have the same tangent frame
+    const TriMeshOptions options = TriMeshOptions().Normals().TexCoords().Tangents().TexCoordScale(float2(2, 2));
+
+    TriMesh mesh;
+    TriMesh welded;
+    ASSERT_EQ(TriMesh::CreateFromOBJ(path, TriMeshOptions(options).Indices(), &mesh), ppx::SUCCESS);
+    ASSERT_EQ(TriMesh::CreateFromOBJ(path, TriMeshOptions(options).WeldVertices(), &welded), ppx::SUCCESS);
+    ASSERT_EQ(mesh.GetCountBitangents(), 6u);
+    ASSERT_EQ(welded.GetCountBitangents(), 4u);
+
+    for (uint32_t triIndex = 0; triIndex < 2; ++triIndex) {
+        uint32_t v[3]       = {};
+        uint32_t welded3[3] = {};
+        ASSERT_EQ(mesh.GetTriangle(triIndex, v[0], v[1], v[2]), ppx::SUCCESS);
+        ASSERT_EQ(welded.GetTriangle(triIndex, welded3[0], welded3[1], welded3[2]), ppx::SUCCESS);
+        for (uint32_t i = 0; i < 3; ++i) {
+            const float4 tangent         = *mesh.GetDataTangents(v[i]);
+            const float3 bitangent       = *mesh.GetDataBitangents(v[i]);
+            const float4 weldedTangent   = *welded.GetDataTangents(welded3[i]);
+            const float3 weldedBitangent = *welded.GetDataBitangents(welded3[i]);
+
+            // The per-face path keeps the bitangent length from the tex coord
+            // derivatives, only the welded path normalizes it
+            EXPECT_NEAR(glm::length(bitangent), 0.5f, 1e-5f);
+            EXPECT_FLOAT_EQ(glm::length(float3(weldedTangent)), 1.0f);
+            EXPECT_FLOAT_EQ(glm::length(weldedBitangent), 1.0f);
+
+            const float3 expectedBitangent = glm::normalize(bitangent);
+            for (uint32_t c = 0; c < 3; ++c) {
+                EXPECT_FLOAT_EQ(weldedTangent[c], tangent[c]) << "triangle " << triIndex << " corner " << i;
+                EXPECT_FLOAT_EQ(weldedBitangent[c], expectedBitangent[c]) << "triangle " << triIndex << " corner " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "grfx_fakes.h"
+#include "ppx/grfx/grfx_upload_queue.h"
+
+#include <cstring>
+
+using namespace ppx;
+using namespace ppx::test;
+
+namespace {
+
+const uint32_t kData[4] = {1, 2, 3, 4};
+
+class UploadQueueTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // One batch so every batch reuses the same slot and fence
+        grfx::UploadQueueCreateInfo uploadQueueCreateInfo = {};
+        uploadQueueCreateInfo.pQueue                      = mDevice.GetGraphicsQueue();
+        uploadQueueCreateInfo.batchCount                  = 1;
+        ASSERT_EQ(mDevice.CreateUploadQueue(&uploadQueueCreateInfo, &mUploadQueue), ppx::SUCCESS);
+
+        grfx::BufferCreateInfo bufferCreateInfo      = {};
+        bufferCreateInfo.size                        = sizeof(kData);
+        bufferCreateInfo.usageFlags.bits.transferDst = true;
+        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        ASSERT_EQ(mDevice.CreateBuffer(&bufferCreateInfo, &mBuffer), ppx::SUCCESS);
+    }
+
+    Result Upload()
+    {
+        return mUploadQueue->UploadToBuffer(sizeof(kData), kData, mBuffer, 0, grfx::RESOURCE_STATE_GENERAL, grfx::RESOURCE_STATE_GENERAL);
+    }
+
+    FakeDevice           mDevice;
+    grfx::UploadQueuePtr mUploadQueue;
+    grfx::BufferPtr      mBuffer;
+};
+
+} // namespace
+
+TEST_F(UploadQueueTest, FlushSubmitsRecordedCopies)
+{
+    grfx::UploadTicket ticket = 0;
+    ASSERT_EQ(Upload(), ppx::SUCCESS);
+    ASSERT_EQ(mUploadQueue->Flush(&ticket), ppx::SUCCESS);
+    EXPECT_TRUE(mUploadQueue->IsComplete(ticket));
+    EXPECT_EQ(mDevice.GetFakeQueue()->GetSubmitCount(), 1u);
+    EXPECT_EQ(std::memcmp(static_cast<FakeBuffer*>(mBuffer.Get())->GetMemory(), kData, sizeof(kData)), 0);
+    EXPECT_EQ(mUploadQueue->GetStagingRing()->GetStats().bytesInUse, 0u);
+}
+
+TEST_F(UploadQueueTest, FailedSubmitReleasesBatch)
+{
+    FakeQueue* pQueue = mDevice.GetFakeQueue();
+    pQueue->SetSubmitResult(ppx::ERROR_FAILED);
+
+    ASSERT_EQ(Upload(), ppx::SUCCESS);
+    EXPECT_EQ(mUploadQueue->Flush(), ppx::ERROR_FAILED);
+    EXPECT_EQ(pQueue->GetSubmitCount(), 0u);
+    EXPECT_EQ(mUploadQueue->GetStagingRing()->GetStats().bytesInUse, 0u);
+
+    // The slot is recorded again without waiting on the fence of the failed
+    // batch, which is never signaled
+    auto pFence = static_cast<FakeFence*>(pQueue->GetLastSubmitFence());
+    ASSERT_NE(pFence, nullptr);
+    pQueue->SetSubmitResult(ppx::SUCCESS);
+
+    grfx::UploadTicket ticket = 0;
+    ASSERT_EQ(Upload(), ppx::SUCCESS);
+    ASSERT_EQ(mUploadQueue->Flush(&ticket), ppx::SUCCESS);
+    EXPECT_EQ(pFence->GetBlockingWaitCount(), 0u);
+    EXPECT_TRUE(mUploadQueue->IsComplete(ticket));
+    EXPECT_EQ(pQueue->GetSubmitCount(), 1u);
+    EXPECT_EQ(std::memcmp(static_cast<FakeBuffer*>(mBuffer.Get())->GetMemory(), kData, sizeof(kData)), 0);
+}
@@ -0,0 +1,216 @@
+# Copyright 2023 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Packs a directory into an asset archive.
+
+The archive format is described in include/ppx/asset_archive.h. Archives can
+be passed to BaseApplication::AddAssetDir() instead of a directory, e.g.
+
+    python tools/pack_assets.py assets build/assets.pak --compress '*.obj' '*.gltf'
+"""
+
+import argparse
+import fnmatch
+import logging
+import struct
+import sys
+from pathlib import Path
+from typing import Optional
+
+MAGIC = b'PPXARCH\0'
+VERSION = 1
+ALIGNMENT = 4096
+
+COMPRESSION_NONE = 0
+COMPRESSION_LZ4 = 1
+
+HEADER_FORMAT = '<8sIIQQQII'
+ENTRY_FORMAT = '<QQQQIIII'
+
+_MASK64 = 0xFFFFFFFFFFFFFFFF
+_PRIME64_1 = 0x9E3779B185EBCA87
+_PRIME64_2 = 0xC2B2AE3D27D4EB4F
+_PRIME64_3 = 0x165667B19E3779F9
+_PRIME64_4 = 0x85EBCA77C2B2AE63
+_PRIME64_5 = 0x27D4EB2F165667C5
+
+
+def _rotl64(x: int, r: int) -> int:
+    return ((x << r) | (x >> (64 - r))) & _MASK64
+
+
+def _xxh64_round(acc: int, lane: int) -> int:
+    acc = (acc + lane * _PRIME64_2) & _MASK64
+    return (_rotl64(acc, 31) * _PRIME64_1) & _MASK64
+
+
+def _xxh64_merge_round(acc: int, val: int) -> int:
+    acc ^= _xxh64_round(0, val)
+    return (acc * _PRIME64_1 + _PRIME64_4) & _MASK64
+
+
+def xxh64(data: bytes, seed: int = 0) -> int:
+    """XXH64, matches XXH64() from third_party/xxHash."""
+    length = len(data)
+    pos = 0
+    if length >= 32:
+        v1 = (seed + _PRIME64_1 + _PRIME64_2) & _MASK64
+        v2 = (seed + _PRIME64_2) & _MASK64
+        v3 = seed
+        v4 = (seed - _PRIME64_1) & _MASK64
+        while pos + 32 <= length:
+            l1, l2, l3, l4 = struct.unpack_from('<QQQQ', data, pos)
+            v1 = _xxh64_round(v1, l1)
+            v2 = _xxh64_round(v2, l2)
+            v3 = _xxh64_round(v3, l3)
+            v4 = _xxh64_round(v4, l4)
+            pos += 32
+        acc = (_rotl64(v1, 1) + _rotl64(v2, 7) + _rotl64(v3, 12) +
+               _rotl64(v4, 18)) & _MASK64
+        for v in (v1, v2, v3, v4):
+            acc = _xxh64_merge_round(acc, v)
+    else:
+        acc = (seed + _PRIME64_5) & _MASK64
+
+    acc = (acc + length) & _MASK64
+    while pos + 8 <= length:
+        (lane,) = struct.unpack_from('<Q', data, pos)
+        acc ^= _xxh64_round(0, lane)
+        acc = (_rotl64(acc, 27) * _PRIME64_1 + _PRIME64_4) & _MASK64
+        pos += 8
+    if pos + 4 <= length:
+        (lane,) = struct.unpack_from('<I', data, pos)
+        acc ^= (lane * _PRIME64_1) & _MASK64
+        acc = (_rotl64(acc, 23) * _PRIME64_2 + _PRIME64_3) & _MASK64
+        pos += 4
+    while pos < length:
+        acc ^= (data[pos] * _PRIME64_5) & _MASK64
+        acc = (_rotl64(acc, 11) * _PRIME64_1) & _MASK64
+        pos += 1
+
+    acc ^= acc >> 33
+    acc = (acc * _PRIME64_2) & _MASK64
+    acc ^= acc >> 29
+    acc = (acc * _PRIME64_3) & _MASK64
+    acc ^= acc >> 32
+    return acc
+
+
+def _lz4_compress(data: bytes) -> Optional[bytes]:
+    """Returns an LZ4 block without a size prefix, or None if the lz4 module isn't available."""
+    try:
+        import lz4.block  # type: ignore
+    except ImportError:
+        return None
+    return lz4.block.compress(data, mode='high_compression', store_size=False)
+
+
+def _align(value: int) -> int:
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+class Entry:
+
+    def __init__(self, name: str, data: bytes, compress: bool) -> None:
+        self.name = name.encode('utf-8')
+        self.name_hash = xxh64(self.name)
+        self.size = len(data)
+        self.compression = COMPRESSION_NONE
+        self.data = data
+        if compress and data:
+            compressed = _lz4_compress(data)
+            # Only keep compressed data that's actually smaller
+            if compressed is not None and len(compressed) < len(data):
+                self.compression = COMPRESSION_LZ4
+                self.data = compressed
+
+
+def write_archive(entries: list[Entry], path: Path) -> None:
+    # The index is sorted by hash, ties by name, so lookups can binary search
+    entries = sorted(entries, key=lambda e: (e.name_hash, e.name))
+
+    offset = _align(struct.calcsize(HEADER_FORMAT))
+    index = bytearray()
+    names = bytearray()
+    offsets = []
+    for entry in entries:
+        offsets.append(offset)
+        index += struct.pack(ENTRY_FORMAT, entry.name_hash, offset,
+                             len(entry.data), entry.size, len(names),
+                             len(entry.name), entry.compression, 0)
+        names += entry.name
+        offset = _align(offset + len(entry.data))
+
+    index_offset = offset
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(entries),
+                         index_offset, index_offset + len(index), len(names),
+                         ALIGNMENT, 0)
+
+    with open(path, 'wb') as f:
+        f.write(header)
+        for entry, entry_offset in zip(entries, offsets):
+            f.write(b'\0' * (entry_offset - f.tell()))
+            f.write(entry.data)
+        f.write(b'\0' * (index_offset - f.tell()))
+        f.write(index)
+        f.write(names)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input_dir', type=Path, help='Directory to pack.')
+    parser.add_argument('output', type=Path, help='Archive to write.')
+    parser.add_argument(
+        '--compress',
+        nargs='*',
+        default=[],
+        metavar='PATTERN',
+        help='Compress entries matching these glob patterns with LZ4. '
+        'Requires the lz4 module.')
+    parser.add_argument('--verbose', action='store_true')
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format='%(message)s')
+
+    if not args.input_dir.is_dir():
+        logging.error('%s is not a directory', args.input_dir)
+        return 1
+    if args.compress and _lz4_compress(b'') is None:
+        logging.error('--compress requires the lz4 module (pip install lz4)')
+        return 1
+
+    entries = []
+    total_size = 0
+    stored_size = 0
+    for path in sorted(args.input_dir.rglob('*')):
+        if not path.is_file():
+            continue
+        name = path.relative_to(args.input_dir).as_posix()
+        compress = any(fnmatch.fnmatch(name, pattern) for pattern in args.compress)
+        entry = Entry(name, path.read_bytes(), compress)
+        logging.debug('%s: %d -> %d bytes', name, entry.size, len(entry.data))
+        entries.append(entry)
+        total_size += entry.size
+        stored_size += len(entry.data)
+
+    write_archive(entries, args.output)
+    logging.info('Packed %d files, %d bytes (%d stored) into %s', len(entries),
+                 total_size, stored_size, args.output)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())